@@ -52,6 +52,9 @@ option(OPENEXR_USE_DEFAULT_VISIBILITY "Makes the compile use default visibility
 # object (if you enable this) that contains member to avoid double allocations
 option(OPENEXR_ENABLE_LARGE_STACK "Enables code to take advantage of large stack support"     OFF)
 
+# Static tracepoints for perf / bpftrace / systemtap, requires <sys/sdt.h>
+option(OPENEXR_ENABLE_SDT "Enables USDT static probes in the libraries (requires sys/sdt.h)" OFF)
+
 ########################
 ## Build related options
 
@@ -243,6 +246,44 @@ if(OPENEXR_FORCE_INTERNAL_ZLIB OR NOT TARGET ZLIB::ZLIB)
   endif()
 endif()
 
+#######################################
+# Find zstd
+#######################################
+
+# zstd is optional, without it ZSTD_COMPRESSION is not available
+# and files using it can neither be written nor read
+option(OPENEXR_ENABLE_ZSTD "Enables ZSTD_COMPRESSION (requires libzstd)" ON)
+if(OPENEXR_ENABLE_ZSTD)
+  find_path(ZSTD_INCLUDE_DIR zstd.h)
+  find_library(ZSTD_LIBRARY NAMES zstd zstd_static)
+  mark_as_advanced(ZSTD_INCLUDE_DIR ZSTD_LIBRARY)
+  if(ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)
+    message(STATUS "Using zstd from ${ZSTD_LIBRARY}")
+    set(OPENEXR_HAVE_ZSTD ON)
+  else()
+    message(STATUS "zstd library not found, ZSTD_COMPRESSION disabled")
+  endif()
+endif()
+
+#######################################
+# Find lz4
+#######################################
+
+# lz4 is optional, without it LZ4_COMPRESSION is not available
+# and files using it can neither be written nor read
+option(OPENEXR_ENABLE_LZ4 "Enables LZ4_COMPRESSION (requires liblz4)" ON)
+if(OPENEXR_ENABLE_LZ4)
+  find_path(LZ4_INCLUDE_DIR lz4.h)
+  find_library(LZ4_LIBRARY NAMES lz4 lz4_static)
+  mark_as_advanced(LZ4_INCLUDE_DIR LZ4_LIBRARY)
+  if(LZ4_INCLUDE_DIR AND LZ4_LIBRARY)
+    message(STATUS "Using lz4 from ${LZ4_LIBRARY}")
+    set(OPENEXR_HAVE_LZ4 ON)
+  else()
+    message(STATUS "lz4 library not found, LZ4_COMPRESSION disabled")
+  endif()
+endif()
+
 #######################################
 # Find or install Imath
 #######################################
@@ -0,0 +1,982 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+//-----------------------------------------------------------------------------
+//
+//	exrcodecsweep -- samples chunks from each part of an OpenEXR
+//	file, trial compresses them with every compression method and
+//	level, reports the ratio and speed of each, and recommends a
+//	method per part.
+//
+//-----------------------------------------------------------------------------
+
+#include <IlmThreadPool.h>
+#include <ImathBox.h>
+#include <ImfChannelList.h>
+#include <ImfCompressor.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfIO.h>
+#include <ImfInputPart.h>
+#include <ImfMultiPartInputFile.h>
+#include <ImfPartType.h>
+#include <ImfThreading.h>
+#include <ImfTileDescription.h>
+#include <ImfXdr.h>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <math.h>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace ILMTHREAD_NAMESPACE;
+using IMATH_NAMESPACE::Box2i;
+using namespace std;
+
+namespace
+{
+
+void
+usageMessage (const char argv0[], bool verbose = false)
+{
+    cerr << "usage: " << argv0 << " [options] infile" << endl;
+
+    if (verbose)
+    {
+        cerr << "\n"
+                "Reads sample chunks from each part of an OpenEXR image,\n"
+                "compresses and decompresses them with every compression\n"
+                "method and level, and prints the compression ratio and\n"
+                "the encode and decode throughput of each (in MB of\n"
+                "uncompressed pixel data per second), followed by the\n"
+                "method recommended for the part.\n"
+                "\n"
+                "The recommendation maximizes the weighted geometric mean\n"
+                "of the size, encode and read speed, each relative to the\n"
+                "best of the candidates, e.g. -s 50 -w 0,0,1 picks the\n"
+                "fastest method to read that stores the part in at most\n"
+                "half its uncompressed size.\n"
+                "\n"
+                "Options:\n"
+                "\n"
+                "-n x      number of sample regions per part (default 4),\n"
+                "          each is 256 scanlines, or a row of tiles\n"
+                "\n"
+                "-m x      only try method x (none/rle/zips/zip/piz/pxr24/\n"
+                "          b44/b44a/dwaa/dwab/zstd/lz4), may be repeated\n"
+                "\n"
+                "-a        try every level of zip and zstd, and more DWA\n"
+                "          levels, instead of a representative few\n"
+                "\n"
+                "-s x      only recommend methods storing the part in at\n"
+                "          most x percent of its uncompressed size\n"
+                "\n"
+                "-w s,e,d  weights of size, encode speed and read speed\n"
+                "          in the recommendation (default 1,0,1)\n"
+                "\n"
+                "-b x      bandwidth of the storage in MB/s (default\n"
+                "          1000), the read speed is that of reading the\n"
+                "          compressed data at this rate, then decoding it\n"
+                "\n"
+                "-l        allow lossy methods to be recommended\n"
+                "\n"
+                "-r x      time the best of x runs (default 3)\n"
+                "\n"
+                "-t x      run x trials concurrently (default 1). Trials\n"
+                "          share the machine, so speeds are only\n"
+                "          comparable when run one at a time\n"
+                "\n"
+                "-h        prints this message\n";
+
+        cerr << endl;
+    }
+
+    exit (1);
+}
+
+struct Method
+{
+    Compression compression;
+    const char* name;
+};
+
+const Method methods[] = {
+    {NO_COMPRESSION, "none"},
+    {RLE_COMPRESSION, "rle"},
+    {ZIPS_COMPRESSION, "zips"},
+    {ZIP_COMPRESSION, "zip"},
+    {PIZ_COMPRESSION, "piz"},
+    {PXR24_COMPRESSION, "pxr24"},
+    {B44_COMPRESSION, "b44"},
+    {B44A_COMPRESSION, "b44a"},
+    {DWAA_COMPRESSION, "dwaa"},
+    {DWAB_COMPRESSION, "dwab"},
+    {ZSTD_COMPRESSION, "zstd"},
+    {LZ4_COMPRESSION, "lz4"}};
+
+const char*
+methodName (Compression c)
+{
+    for (const Method& m: methods)
+        if (m.compression == c) return m.name;
+    return "unknown";
+}
+
+Compression
+getCompression (const string& str)
+{
+    for (const Method& m: methods)
+    {
+        string upper (m.name);
+        transform (upper.begin (), upper.end (), upper.begin (), ::toupper);
+        if (str == m.name || str == upper) return m.compression;
+    }
+
+    cerr << "Unknown compression method \"" << str << "\"." << endl;
+    exit (1);
+}
+
+//
+// One method and level to try on a part, along with the results.
+//
+
+struct Trial
+{
+    Compression compression;
+    float       level; // zip / zstd level or DWA quality, < 0 if none
+
+    bool     failed;
+    string   error;
+    uint64_t rawBytes;
+    uint64_t packedBytes;
+    double   encodeSeconds;
+    double   decodeSeconds;
+
+    Trial (Compression c, float l)
+        : compression (c)
+        , level (l)
+        , failed (false)
+        , rawBytes (0)
+        , packedBytes (0)
+        , encodeSeconds (0)
+        , decodeSeconds (0)
+    {}
+
+    double ratio () const
+    {
+        return packedBytes ? double (rawBytes) / double (packedBytes) : 0;
+    }
+
+    double encodeSpeed () const
+    {
+        return encodeSeconds > 0 ? rawBytes / encodeSeconds / 1e6 : 0;
+    }
+
+    double decodeSpeed () const
+    {
+        return decodeSeconds > 0 ? rawBytes / decodeSeconds / 1e6 : 0;
+    }
+
+    //
+    // Throughput of loading the pixels from storage that reads
+    // bandwidth MB/s, i.e. reading the compressed data, then
+    // decompressing it
+    //
+
+    double readSpeed (double bandwidth) const
+    {
+        double seconds = packedBytes / (bandwidth * 1e6) + decodeSeconds;
+        return seconds > 0 ? rawBytes / seconds / 1e6 : 0;
+    }
+};
+
+void
+addTrials (vector<Trial>& trials, Compression c, bool allLevels)
+{
+    switch (c)
+    {
+        case ZIPS_COMPRESSION:
+        case ZIP_COMPRESSION:
+            if (allLevels)
+                for (int l = 1; l <= 9; ++l)
+                    trials.push_back (Trial (c, l));
+            else
+                for (int l: {1, 4, 9})
+                    trials.push_back (Trial (c, l));
+            break;
+
+        case ZSTD_COMPRESSION:
+            if (allLevels)
+                for (int l = 1; l <= 19; ++l)
+                    trials.push_back (Trial (c, l));
+            else
+                for (int l: {1, 3, 9, 19})
+                    trials.push_back (Trial (c, l));
+            break;
+
+        case DWAA_COMPRESSION:
+        case DWAB_COMPRESSION:
+            if (allLevels)
+                for (float l: {5.f, 15.f, 45.f, 100.f, 200.f})
+                    trials.push_back (Trial (c, l));
+            else
+                for (float l: {45.f, 100.f})
+                    trials.push_back (Trial (c, l));
+            break;
+
+        default: trials.push_back (Trial (c, -1)); break;
+    }
+}
+
+//
+// A rectangle of pixels in the uncompressed layout that is passed to
+// the compressors: per scanline, each channel in turn, sampled
+// channels only on the scanlines they have samples on.
+//
+
+struct Block
+{
+    Box2i  range;
+    size_t offset; // into Layout::xdr / native
+    size_t size;
+};
+
+//
+// The sample regions cut into blocks of one height, in both the xdr
+// and the native representation, shared by the methods with the
+// same number of scanlines per chunk.
+//
+
+struct Layout
+{
+    vector<char>  xdr;
+    vector<char>  native;
+    vector<Block> blocks;
+};
+
+struct PartSamples
+{
+    Header           header;
+    bool             tiled;
+    size_t           maxLineSize; // bytes of the widest block scanline
+    map<int, Layout> layouts;     // by block height
+
+    int blockHeight (Compression c) const
+    {
+        return tiled ? int (header.tileDescription ().ySize)
+                     : numLinesInBuffer (c);
+    }
+};
+
+//
+// PXR24 rounds 32-bit floats to 24 bits, so is lossy for parts with
+// float channels
+//
+
+bool
+isLossy (Compression c, const Header& hdr)
+{
+    if (isLossyCompression (c)) return true;
+
+    if (c == PXR24_COMPRESSION)
+    {
+        for (ChannelList::ConstIterator i = hdr.channels ().begin ();
+             i != hdr.channels ().end ();
+             ++i)
+            if (i.channel ().type == FLOAT) return true;
+    }
+
+    return false;
+}
+
+inline size_t
+sampleSize (PixelType type)
+{
+    return type == HALF ? sizeof (half) : sizeof (float);
+}
+
+inline bool
+hasSamples (int y, int ySampling)
+{
+    return ((y % ySampling) + ySampling) % ySampling == 0;
+}
+
+inline int
+numSamples (int s, int a, int b)
+{
+    int a1 = (a / s) * s + ((a % s > 0) ? s : 0);
+    int b1 = (b / s) * s - ((b % s < 0) ? s : 0);
+    return a1 > b1 ? 0 : (b1 - a1) / s + 1;
+}
+
+//
+// Reads the pixels of a region into per channel buffers, and appends
+// the region, cut into blocks of each method's chunk size, to the
+// sample buffers.
+//
+
+void
+addRegion (InputPart& in, PartSamples& ps, const Box2i& region)
+{
+    const ChannelList& channels = ps.header.channels ();
+
+    struct ChannelData
+    {
+        PixelType    type;
+        int          xs, ys;
+        int          firstY;
+        size_t       rowBytes;
+        vector<char> data;
+    };
+
+    vector<ChannelData> cdata;
+    FrameBuffer         fb;
+
+    for (ChannelList::ConstIterator i = channels.begin ();
+         i != channels.end ();
+         ++i)
+    {
+        ChannelData cd;
+        cd.type   = i.channel ().type;
+        cd.xs     = i.channel ().xSampling;
+        cd.ys     = i.channel ().ySampling;
+        cd.firstY = region.min.y;
+        while (!hasSamples (cd.firstY, cd.ys))
+            ++cd.firstY;
+
+        size_t px   = sampleSize (cd.type);
+        int    cols = numSamples (cd.xs, region.min.x, region.max.x);
+        int    rows = numSamples (cd.ys, region.min.y, region.max.y);
+        cd.rowBytes = px * cols;
+        cd.data.resize (cd.rowBytes * rows + 1);
+        cdata.push_back (cd);
+    }
+
+    int c = 0;
+    for (ChannelList::ConstIterator i = channels.begin ();
+         i != channels.end ();
+         ++i, ++c)
+    {
+        ChannelData& cd = cdata[c];
+        size_t       px = sampleSize (cd.type);
+        int          x0 = region.min.x;
+        while (!hasSamples (x0, cd.xs))
+            ++x0;
+
+        char* base = cd.data.data () - (intptr_t) (x0 / cd.xs) * px -
+                     (intptr_t) (cd.firstY / cd.ys) * cd.rowBytes;
+        fb.insert (
+            i.name (),
+            Slice (cd.type, base, px, cd.rowBytes, cd.xs, cd.ys));
+    }
+
+    in.setFrameBuffer (fb);
+    in.readPixels (region.min.y, region.max.y);
+
+    //
+    // Lay the region out one block after another for each block
+    // height, in both the native and the xdr representation
+    //
+
+    for (auto& hl: ps.layouts)
+    {
+        Layout& lay = hl.second;
+        int     bh  = hl.first;
+        int     bw  = ps.tiled ? int (ps.header.tileDescription ().xSize)
+                               : region.max.x - region.min.x + 1;
+
+        for (int by = region.min.y; by <= region.max.y; by += bh)
+        {
+            for (int bx = region.min.x; bx <= region.max.x; bx += bw)
+            {
+                Block b;
+                b.range.min = IMATH_NAMESPACE::V2i (bx, by);
+                b.range.max = IMATH_NAMESPACE::V2i (
+                    min (bx + bw - 1, region.max.x),
+                    min (by + bh - 1, region.max.y));
+                b.offset = lay.xdr.size ();
+
+                for (int y = b.range.min.y; y <= b.range.max.y; ++y)
+                {
+                    for (ChannelData& cd: cdata)
+                    {
+                        if (!hasSamples (y, cd.ys)) continue;
+
+                        size_t px    = sampleSize (cd.type);
+                        int    skip  = numSamples (
+                            cd.xs, region.min.x, b.range.min.x - 1);
+                        int    count = numSamples (
+                            cd.xs, b.range.min.x, b.range.max.x);
+                        const char* src = cd.data.data () +
+                                          (y - cd.firstY) / cd.ys *
+                                              cd.rowBytes +
+                                          skip * px;
+
+                        lay.native.insert (
+                            lay.native.end (), src, src + count * px);
+
+                        size_t at = lay.xdr.size ();
+                        lay.xdr.resize (at + count * px);
+                        char* out = lay.xdr.data () + at;
+
+                        for (int x = 0; x < count; ++x, src += px)
+                        {
+                            switch (cd.type)
+                            {
+                                case UINT:
+                                    Xdr::write<CharPtrIO> (
+                                        out,
+                                        *reinterpret_cast<const unsigned*> (
+                                            src));
+                                    break;
+                                case HALF:
+                                    Xdr::write<CharPtrIO> (
+                                        out,
+                                        *reinterpret_cast<const half*> (src));
+                                    break;
+                                case FLOAT:
+                                    Xdr::write<CharPtrIO> (
+                                        out,
+                                        *reinterpret_cast<const float*> (src));
+                                    break;
+                                default: break;
+                            }
+                        }
+                    }
+                }
+
+                b.size = lay.xdr.size () - b.offset;
+                lay.blocks.push_back (b);
+            }
+        }
+    }
+}
+
+//
+// Compresses, decompresses and verifies every block of a part with
+// one method and level, best of the given number of runs.
+//
+
+class TrialTask : public Task
+{
+public:
+    TrialTask (TaskGroup* g, const PartSamples& ps, Trial& t, int runs)
+        : Task (g), _ps (ps), _trial (t), _runs (runs)
+    {}
+
+    void execute () override
+    {
+        try
+        {
+            run ();
+        }
+        catch (const exception& e)
+        {
+            _trial.failed = true;
+            _trial.error  = e.what ();
+        }
+    }
+
+private:
+    typedef chrono::steady_clock Clock;
+
+    void run ()
+    {
+        const Layout& lay =
+            _ps.layouts.at (_ps.blockHeight (_trial.compression));
+        const vector<Block>& blocks = lay.blocks;
+
+        for (const Block& b: blocks)
+            _trial.rawBytes += b.size;
+
+        if (_trial.compression == NO_COMPRESSION)
+        {
+            _trial.packedBytes = _trial.rawBytes;
+            return;
+        }
+
+        Header hdr           = _ps.header;
+        hdr.compression ()   = _trial.compression;
+        if (_trial.compression == ZIP_COMPRESSION ||
+            _trial.compression == ZIPS_COMPRESSION)
+            hdr.zipCompressionLevel () = int (_trial.level);
+        else if (_trial.compression == ZSTD_COMPRESSION)
+            hdr.zstdCompressionLevel () = int (_trial.level);
+        else if (_trial.level >= 0)
+            hdr.dwaCompressionLevel () = _trial.level;
+
+        unique_ptr<Compressor> comp (
+            _ps.tiled ? newTileCompressor (
+                            _trial.compression,
+                            _ps.maxLineSize,
+                            _ps.header.tileDescription ().ySize,
+                            hdr)
+                      : newCompressor (
+                            _trial.compression, _ps.maxLineSize, hdr));
+
+        const vector<char>& raw =
+            comp->format () == Compressor::XDR ? lay.xdr : lay.native;
+
+        //
+        // A chunk that does not get smaller is stored as is in a
+        // file, and not decompressed when read, count it that way.
+        //
+
+        vector<vector<char>> packed (blocks.size ());
+        double               best = numeric_limits<double>::max ();
+
+        for (int r = 0; r < _runs; ++r)
+        {
+            Clock::time_point start = Clock::now ();
+
+            for (size_t i = 0; i < blocks.size (); ++i)
+            {
+                const Block& b = blocks[i];
+                const char*  out;
+                int          n;
+
+                if (_ps.tiled)
+                    n = comp->compressTile (
+                        raw.data () + b.offset, int (b.size), b.range, out);
+                else
+                    n = comp->compress (
+                        raw.data () + b.offset,
+                        int (b.size),
+                        b.range.min.y,
+                        out);
+
+                if (r == 0 && n < int (b.size)) packed[i].assign (out, out + n);
+            }
+
+            best = min (
+                best, chrono::duration<double> (Clock::now () - start).count ());
+        }
+
+        _trial.encodeSeconds = best;
+
+        bool stored = true;
+        for (size_t i = 0; i < blocks.size (); ++i)
+        {
+            _trial.packedBytes +=
+                packed[i].empty () ? blocks[i].size : packed[i].size ();
+            stored = stored && packed[i].empty ();
+        }
+
+        if (stored) return;
+
+        best = numeric_limits<double>::max ();
+
+        for (int r = 0; r < _runs; ++r)
+        {
+            Clock::time_point start = Clock::now ();
+
+            for (size_t i = 0; i < blocks.size (); ++i)
+            {
+                const Block& b = blocks[i];
+                const char*  out;
+                int          n;
+
+                if (packed[i].empty ()) continue;
+
+                if (_ps.tiled)
+                    n = comp->uncompressTile (
+                        packed[i].data (), int (packed[i].size ()), b.range, out);
+                else
+                    n = comp->uncompress (
+                        packed[i].data (),
+                        int (packed[i].size ()),
+                        b.range.min.y,
+                        out);
+
+                if (r == 0 && !isLossy (_trial.compression, _ps.header) &&
+                    (n != int (b.size) ||
+                     memcmp (out, raw.data () + b.offset, b.size)))
+                {
+                    throw runtime_error ("decompressed data does not match");
+                }
+            }
+
+            best = min (
+                best, chrono::duration<double> (Clock::now () - start).count ());
+        }
+
+        _trial.decodeSeconds = best;
+    }
+
+    const PartSamples& _ps;
+    Trial&             _trial;
+    int                _runs;
+};
+
+struct Options
+{
+    int                 regions    = 4;
+    bool                allLevels  = false;
+    vector<Compression> only;
+    double              maxSize    = 100;
+    double              bandwidth  = 1000;
+    double              weights[3] = {1, 0, 1};
+    bool                lossy      = false;
+    int                 runs       = 3;
+    int                 threads    = 1;
+};
+
+bool
+sweepPart (MultiPartInputFile& file, int part, const Options& opt)
+{
+    const Header& h = file.header (part);
+
+    cout << "part " << part;
+    if (h.hasName ()) cout << " \"" << h.name () << "\"";
+
+    if (h.hasType () && isDeepData (h.type ()))
+    {
+        cout << ": deep data, skipped" << endl;
+        return true;
+    }
+
+    PartSamples ps;
+    ps.header      = h;
+    ps.tiled       = h.hasTileDescription ();
+    ps.maxLineSize = 0;
+
+    const Box2i& dw    = h.dataWindow ();
+    int          width = dw.max.x - dw.min.x + 1;
+    int          rows  = ps.tiled ? int (h.tileDescription ().ySize) : 256;
+    int          nrows = (dw.max.y - dw.min.y + rows) / rows;
+    int          nreg  = min (opt.regions, nrows);
+
+    vector<Trial> trials;
+    for (const Method& m: methods)
+    {
+        if (!isSupportedCompression (m.compression)) continue;
+        if (!opt.only.empty () &&
+            find (opt.only.begin (), opt.only.end (), m.compression) ==
+                opt.only.end ())
+            continue;
+        addTrials (trials, m.compression, opt.allLevels);
+        ps.layouts[ps.blockHeight (m.compression)];
+    }
+
+    if (trials.empty ())
+    {
+        cout << ": no methods to try" << endl;
+        return true;
+    }
+
+    try
+    {
+        InputPart in (file, part);
+
+        for (int r = 0; r < nreg; ++r)
+        {
+            int   row = int ((long long) r * nrows / nreg);
+            Box2i region (
+                IMATH_NAMESPACE::V2i (dw.min.x, dw.min.y + row * rows),
+                IMATH_NAMESPACE::V2i (
+                    dw.max.x,
+                    min (dw.max.y, dw.min.y + row * rows + rows - 1)));
+            addRegion (in, ps, region);
+        }
+    }
+    catch (const exception& e)
+    {
+        cout << endl;
+        cerr << "  " << e.what () << endl;
+        return false;
+    }
+
+    int lineWidth = ps.tiled ? int (h.tileDescription ().xSize) : width;
+    for (ChannelList::ConstIterator i = h.channels ().begin ();
+         i != h.channels ().end ();
+         ++i)
+    {
+        ps.maxLineSize += sampleSize (i.channel ().type) *
+                          (lineWidth / i.channel ().xSampling + 1);
+    }
+
+    cout << " (" << (ps.tiled ? "tiled" : "scanline") << ", " << width
+         << " x " << (dw.max.y - dw.min.y + 1) << "), " << nreg
+         << " sample" << (nreg == 1 ? "" : "s") << " of ";
+    if (ps.tiled)
+        cout << "a row of " << h.tileDescription ().xSize << " x " << rows
+             << " tiles, ";
+    else
+        cout << rows << " scanlines, ";
+    cout << fixed << setprecision (1)
+         << ps.layouts.begin ()->second.xdr.size () / 1e6 << " MB" << endl;
+
+    {
+        ThreadPool pool (opt.threads > 1 ? opt.threads : 0);
+        TaskGroup  group;
+
+        //
+        // with no threads, the pool runs each task as it is added
+        //
+
+        for (Trial& t: trials)
+            pool.addTask (new TrialTask (&group, ps, t, opt.runs));
+    }
+
+    //
+    // Print the table, and collect the methods that may be recommended
+    //
+
+    cout << "  method  level    ratio   size%   enc MB/s   dec MB/s  read MB/s"
+         << endl;
+
+    vector<const Trial*> candidates;
+
+    for (const Trial& t: trials)
+    {
+        cout << "  " << left << setw (6) << methodName (t.compression)
+             << right << setw (7);
+        if (t.level < 0)
+            cout << "-";
+        else
+            cout << setprecision (0) << t.level;
+
+        if (t.failed)
+        {
+            cout << "  failed: " << t.error << endl;
+            continue;
+        }
+
+        double sizePct = 100.0 * t.packedBytes / max<uint64_t> (t.rawBytes, 1);
+
+        cout << setprecision (2) << setw (9) << t.ratio () << setprecision (1)
+             << setw (7) << sizePct << "%";
+
+        if (t.compression == NO_COMPRESSION)
+            cout << setw (11) << "-";
+        else
+            cout << setw (11) << t.encodeSpeed ();
+
+        //
+        // nothing to decode if no chunk got smaller
+        //
+
+        if (t.decodeSeconds == 0)
+            cout << setw (11) << "-";
+        else
+            cout << setw (11) << t.decodeSpeed ();
+        cout << setw (11) << t.readSpeed (opt.bandwidth) << endl;
+
+        if (sizePct > opt.maxSize) continue;
+        if (!opt.lossy && isLossy (t.compression, h)) continue;
+
+        candidates.push_back (&t);
+    }
+
+    if (candidates.empty ())
+    {
+        cout << "  recommended: no method meets the size limit" << endl;
+        return true;
+    }
+
+    //
+    // Score each candidate by the weighted geometric mean of its
+    // size, encode and read speed relative to the best candidate,
+    // so being twice as slow costs as much as being twice as big.
+    // Not compressing has no encode cost, it counts as the fastest.
+    //
+
+    double minSize = 0, maxEnc = 0, maxRead = 0;
+    for (const Trial* t: candidates)
+    {
+        if (minSize == 0 || t->packedBytes < minSize) minSize = t->packedBytes;
+        maxEnc  = max (maxEnc, t->encodeSpeed ());
+        maxRead = max (maxRead, t->readSpeed (opt.bandwidth));
+    }
+
+    const Trial* best      = 0;
+    double       bestScore = 0;
+    double       wsum = opt.weights[0] + opt.weights[1] + opt.weights[2];
+
+    for (const Trial* t: candidates)
+    {
+        double enc = t->compression == NO_COMPRESSION ? maxEnc
+                                                      : t->encodeSpeed ();
+        double rel[3] = {
+            t->packedBytes > 0 ? minSize / t->packedBytes : 1,
+            maxEnc > 0 ? enc / maxEnc : 1,
+            maxRead > 0 ? t->readSpeed (opt.bandwidth) / maxRead : 1};
+
+        double logScore = 0;
+        for (int k = 0; k < 3; ++k)
+            logScore += opt.weights[k] * log (max (rel[k], 1e-9));
+
+        double score = wsum > 0 ? exp (logScore / wsum) : 1;
+
+        if (!best || score > bestScore)
+        {
+            best      = t;
+            bestScore = score;
+        }
+    }
+
+    cout << "  recommended: " << methodName (best->compression);
+    if (best->level >= 0) cout << " level " << setprecision (0) << best->level;
+    cout << " (score " << setprecision (2) << bestScore << ")" << endl;
+    return true;
+}
+
+} // namespace
+
+int
+main (int argc, char** argv)
+{
+    const char* inFile = 0;
+    Options     opt;
+
+    //
+    // Parse the command line.
+    //
+
+    if (argc < 2) usageMessage (argv[0], true);
+
+    int i = 1;
+
+    while (i < argc)
+    {
+        if (!strcmp (argv[i], "-n"))
+        {
+            if (i > argc - 2) usageMessage (argv[0]);
+
+            opt.regions = strtol (argv[i + 1], 0, 0);
+
+            if (opt.regions <= 0)
+            {
+                cerr << "Number of samples must be greater than zero."
+                     << endl;
+                return 1;
+            }
+
+            i += 2;
+        }
+        else if (!strcmp (argv[i], "-m"))
+        {
+            if (i > argc - 2) usageMessage (argv[0]);
+
+            opt.only.push_back (getCompression (argv[i + 1]));
+            i += 2;
+        }
+        else if (!strcmp (argv[i], "-a"))
+        {
+            opt.allLevels = true;
+            i += 1;
+        }
+        else if (!strcmp (argv[i], "-s"))
+        {
+            if (i > argc - 2) usageMessage (argv[0]);
+
+            opt.maxSize = strtod (argv[i + 1], 0);
+            i += 2;
+        }
+        else if (!strcmp (argv[i], "-w"))
+        {
+            if (i > argc - 2) usageMessage (argv[0]);
+
+            if (sscanf (
+                    argv[i + 1],
+                    "%lf,%lf,%lf",
+                    &opt.weights[0],
+                    &opt.weights[1],
+                    &opt.weights[2]) != 3 ||
+                opt.weights[0] < 0 || opt.weights[1] < 0 ||
+                opt.weights[2] < 0)
+            {
+                cerr << "Weights must be three non-negative numbers, "
+                        "e.g. 1,0,1."
+                     << endl;
+                return 1;
+            }
+
+            i += 2;
+        }
+        else if (!strcmp (argv[i], "-b"))
+        {
+            if (i > argc - 2) usageMessage (argv[0]);
+
+            opt.bandwidth = strtod (argv[i + 1], 0);
+
+            if (opt.bandwidth <= 0)
+            {
+                cerr << "Bandwidth must be greater than zero." << endl;
+                return 1;
+            }
+
+            i += 2;
+        }
+        else if (!strcmp (argv[i], "-l"))
+        {
+            opt.lossy = true;
+            i += 1;
+        }
+        else if (!strcmp (argv[i], "-r"))
+        {
+            if (i > argc - 2) usageMessage (argv[0]);
+
+            opt.runs = max (1, int (strtol (argv[i + 1], 0, 0)));
+            i += 2;
+        }
+        else if (!strcmp (argv[i], "-t"))
+        {
+            if (i > argc - 2) usageMessage (argv[0]);
+
+            opt.threads = max (1, int (strtol (argv[i + 1], 0, 0)));
+            i += 2;
+        }
+        else if (!strcmp (argv[i], "-h"))
+        {
+            usageMessage (argv[0], true);
+        }
+        else
+        {
+            if (inFile) usageMessage (argv[0]);
+
+            inFile = argv[i];
+            i += 1;
+        }
+    }
+
+    if (inFile == 0) usageMessage (argv[0]);
+
+    int exitStatus = 0;
+
+    try
+    {
+        //
+        // The codecs are timed on one thread each, the DWA
+        // compressors would otherwise spread a chunk over the
+        // global thread pool
+        //
+
+        setGlobalThreadCount (0);
+
+        MultiPartInputFile file (inFile);
+
+        for (int p = 0; p < file.parts (); ++p)
+            if (!sweepPart (file, p, opt)) exitStatus = 1;
+    }
+    catch (const exception& e)
+    {
+        cerr << e.what () << endl;
+        exitStatus = 1;
+    }
+
+    return exitStatus;
+}
@@ -63,6 +63,10 @@ printCompression (Compression c)
 
         case DWAB_COMPRESSION: cout << "dwa, medium scanline blocks"; break;
 
+        case ZSTD_COMPRESSION: cout << "zstd, blocks of 32 scanlines"; break;
+
+        case LZ4_COMPRESSION: cout << "lz4, blocks of 16 scanlines"; break;
+
         default: cout << int (c); break;
     }
 }
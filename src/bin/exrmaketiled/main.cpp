@@ -68,7 +68,7 @@ usageMessage (const char argv0[], bool verbose = false)
                 "-u        sets level size rounding to ROUND_UP\n"
                 "\n"
                 "-z x      sets the data compression method to x\n"
-                "          (none/rle/zip/piz/pxr24/b44/b44a/dwaa/dwab,\n"
+                "          (none/rle/zip/piz/pxr24/b44/b44a/dwaa/dwab/zstd/lz4,\n"
                 "          default is zip)\n"
                 "\n"
                 "-v        verbose mode\n"
@@ -126,6 +126,14 @@ getCompression (const string& str)
     {
         c = DWAB_COMPRESSION;
     }
+    else if (str == "zstd" || str == "ZSTD")
+    {
+        c = ZSTD_COMPRESSION;
+    }
+    else if (str == "lz4" || str == "LZ4")
+    {
+        c = LZ4_COMPRESSION;
+    }
     else
     {
         cerr << "Unknown compression method \"" << str << "\"." << endl;
@@ -54,7 +54,7 @@ usageMessage (const char argv0[], bool verbose = false)
                 "Options:\n"
                 "\n"
                 "-z x      sets the data compression method to x\n"
-                "          (none/rle/zip/piz/pxr24/b44/b44a/dwaa/dwab,\n"
+                "          (none/rle/zip/piz/pxr24/b44/b44a/dwaa/dwab/zstd/lz4,\n"
                 "          default is piz)\n"
                 "\n"
                 "-v        verbose mode\n"
@@ -108,6 +108,14 @@ getCompression (const string& str)
     {
         c = DWAB_COMPRESSION;
     }
+    else if (str == "zstd" || str == "ZSTD")
+    {
+        c = ZSTD_COMPRESSION;
+    }
+    else if (str == "lz4" || str == "LZ4")
+    {
+        c = LZ4_COMPRESSION;
+    }
     else
     {
         cerr << "Unknown compression method \"" << str << "\"." << endl;
@@ -30,9 +30,12 @@
 #include <ImfTiledOutputPart.h>
 #include <ImfVecAttribute.h>
 
+#include <openexr.h>
+
 #include <exception>
 #include <iostream>
 #include <map>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <string>
@@ -51,9 +54,11 @@ usageMessage (const char argv0[], bool verbose = false)
         cerr << "\n"
                 "Reads OpenEXR image file infile, sets the values of one\n"
                 "or more attributes in the headers of the file, and saves\n"
-                "the result in outfile.  Infile and outfile must not refer\n"
-                "to the same file (the program cannot edit an image file "
-                "\"in place\").\n"
+                "the result in outfile.  If infile and outfile refer to\n"
+                "the same file, the headers are rewritten in place when\n"
+                "they still fit in front of the image data, without\n"
+                "touching the pixels.  Otherwise, the whole file is\n"
+                "rewritten.\n"
                 "\n"
                 "Command for selecting headers:\n"
                 "\n"
@@ -584,6 +589,209 @@ getPart (const char attrName[], int argc, char** argv, int& i, int& part)
     i += 2;
 }
 
+static void
+quietErrors (exr_const_context_t, exr_result_t, const char*)
+{
+    // failures fall back to rewriting the file, which reports them
+}
+
+bool
+updateInPlace (const char fileName[], const SetAttrVector& attrs)
+{
+    exr_context_t             ctxt;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &quietErrors;
+
+    if (EXR_ERR_SUCCESS !=
+        exr_start_inplace_header_update (&ctxt, fileName, &cinit))
+        return false;
+
+    int          numParts = 0;
+    exr_result_t rv       = exr_get_count (ctxt, &numParts);
+
+    for (size_t i = 0; rv == EXR_ERR_SUCCESS && i < attrs.size (); ++i)
+    {
+        const SetAttr& attr = attrs[i];
+
+        if (attr.part < -1 || attr.part >= numParts)
+        {
+            rv = EXR_ERR_ARGUMENT_OUT_OF_RANGE;
+            break;
+        }
+
+        for (int p = 0; rv == EXR_ERR_SUCCESS && p < numParts; ++p)
+        {
+            if (attr.part != -1 && attr.part != p) continue;
+
+            const char*      name = attr.name.c_str ();
+            const Attribute* a    = attr.attr;
+
+            if (const FloatAttribute* fa =
+                    dynamic_cast<const FloatAttribute*> (a))
+            {
+                rv = exr_attr_set_float (ctxt, p, name, fa->value ());
+            }
+            else if (const IntAttribute* ia =
+                         dynamic_cast<const IntAttribute*> (a))
+            {
+                rv = exr_attr_set_int (ctxt, p, name, ia->value ());
+            }
+            else if (const StringAttribute* sa =
+                         dynamic_cast<const StringAttribute*> (a))
+            {
+                rv = exr_attr_set_string (ctxt, p, name, sa->value ().c_str ());
+            }
+            else if (const V2fAttribute* va =
+                         dynamic_cast<const V2fAttribute*> (a))
+            {
+                exr_attr_v2f_t v = {va->value ().x, va->value ().y};
+                rv               = exr_attr_set_v2f (ctxt, p, name, &v);
+            }
+            else if (const RationalAttribute* ra =
+                         dynamic_cast<const RationalAttribute*> (a))
+            {
+                exr_attr_rational_t r = {ra->value ().n, ra->value ().d};
+                rv = exr_attr_set_rational (ctxt, p, name, &r);
+            }
+            else if (const ChromaticitiesAttribute* ca =
+                         dynamic_cast<const ChromaticitiesAttribute*> (a))
+            {
+                const Chromaticities&     c  = ca->value ();
+                exr_attr_chromaticities_t cc = {
+                    c.red.x,
+                    c.red.y,
+                    c.green.x,
+                    c.green.y,
+                    c.blue.x,
+                    c.blue.y,
+                    c.white.x,
+                    c.white.y};
+                rv = exr_attr_set_chromaticities (ctxt, p, name, &cc);
+            }
+            else if (const EnvmapAttribute* ea =
+                         dynamic_cast<const EnvmapAttribute*> (a))
+            {
+                rv = exr_attr_set_envmap (
+                    ctxt, p, name, (exr_envmap_t) ea->value ());
+            }
+            else if (const KeyCodeAttribute* ka =
+                         dynamic_cast<const KeyCodeAttribute*> (a))
+            {
+                const KeyCode&     k  = ka->value ();
+                exr_attr_keycode_t kc = {
+                    k.filmMfcCode (),
+                    k.filmType (),
+                    k.prefix (),
+                    k.count (),
+                    k.perfOffset (),
+                    k.perfsPerFrame (),
+                    k.perfsPerCount ()};
+                rv = exr_attr_set_keycode (ctxt, p, name, &kc);
+            }
+            else if (const TimeCodeAttribute* ta =
+                         dynamic_cast<const TimeCodeAttribute*> (a))
+            {
+                exr_attr_timecode_t tc = {
+                    ta->value ().timeAndFlags (), ta->value ().userData ()};
+                rv = exr_attr_set_timecode (ctxt, p, name, &tc);
+            }
+            else
+            {
+                rv = EXR_ERR_INVALID_ATTR;
+            }
+        }
+    }
+
+    if (rv == EXR_ERR_SUCCESS) rv = exr_write_header (ctxt);
+
+    exr_finish (&ctxt);
+    return rv == EXR_ERR_SUCCESS;
+}
+
+int
+rewriteFile (
+    const char inFileName[], const char outFileName[], const SetAttrVector& attrs)
+{
+    //
+    // Load the headers from the input file
+    // and add attributes to the headers.
+    //
+
+    MultiPartInputFile in (inFileName);
+    int                numParts = in.parts ();
+    vector<Header>     headers;
+
+    for (int part = 0; part < numParts; ++part)
+    {
+        Header h = in.header (part);
+
+        for (size_t i = 0; i < attrs.size (); ++i)
+        {
+            const SetAttr& attr = attrs[i];
+
+            if (attr.part == -1 || attr.part == part)
+            {
+                h.insert (attr.name, *attr.attr);
+            }
+            else if (attr.part < 0 || attr.part >= numParts)
+            {
+                cerr << "Invalid part number " << attr.part
+                     << ". "
+                        "Part numbers in file "
+                     << inFileName
+                     << " "
+                        "go from 0 to "
+                     << numParts - 1 << "." << endl;
+
+                return 1;
+            }
+        }
+
+        headers.push_back (h);
+    }
+
+    //
+    // Crete an output file with the modified headers,
+    // and copy the pixels from the input file to the
+    // output file.
+    //
+
+    MultiPartOutputFile out (outFileName, &headers[0], numParts);
+
+    for (int p = 0; p < numParts; ++p)
+    {
+        const Header& h    = in.header (p);
+        const string& type = h.type ();
+
+        if (type == SCANLINEIMAGE)
+        {
+            InputPart  inPart (in, p);
+            OutputPart outPart (out, p);
+            outPart.copyPixels (inPart);
+        }
+        else if (type == TILEDIMAGE)
+        {
+            TiledInputPart  inPart (in, p);
+            TiledOutputPart outPart (out, p);
+            outPart.copyPixels (inPart);
+        }
+        else if (type == DEEPSCANLINE)
+        {
+            DeepScanLineInputPart  inPart (in, p);
+            DeepScanLineOutputPart outPart (out, p);
+            outPart.copyPixels (inPart);
+        }
+        else if (type == DEEPTILE)
+        {
+            DeepTiledInputPart  inPart (in, p);
+            DeepTiledOutputPart outPart (out, p);
+            outPart.copyPixels (inPart);
+        }
+    }
+
+    return 0;
+}
+
 int
 main (int argc, char** argv)
 {
@@ -743,85 +951,44 @@ main (int argc, char** argv)
 
         if (!strcmp (inFileName, outFileName))
         {
-            cerr << "Input and output cannot be the same file." << endl;
-            return 1;
-        }
+            //
+            // Try to just rewrite the headers, if they don't fit,
+            // go through a temporary file and replace the original.
+            //
 
-        //
-        // Load the headers from the input file
-        // and add attributes to the headers.
-        //
+            if (updateInPlace (inFileName, attrs)) return 0;
 
-        MultiPartInputFile in (inFileName);
-        int                numParts = in.parts ();
-        vector<Header>     headers;
+            string tmpFileName = string (outFileName) + ".tmp";
 
-        for (int part = 0; part < numParts; ++part)
-        {
-            Header h = in.header (part);
-
-            for (size_t i = 0; i < attrs.size (); ++i)
+            try
             {
-                const SetAttr& attr = attrs[i];
+                exitStatus =
+                    rewriteFile (inFileName, tmpFileName.c_str (), attrs);
+            }
+            catch (...)
+            {
+                remove (tmpFileName.c_str ());
+                throw;
+            }
 
-                if (attr.part == -1 || attr.part == part)
-                {
-                    h.insert (attr.name, *attr.attr);
-                }
-                else if (attr.part < 0 || attr.part >= numParts)
+            if (exitStatus == 0 &&
+                rename (tmpFileName.c_str (), outFileName) != 0)
+            {
+                // windows does not replace existing files on rename
+                remove (outFileName);
+                if (rename (tmpFileName.c_str (), outFileName) != 0)
                 {
-                    cerr << "Invalid part number " << attr.part
-                         << ". "
-                            "Part numbers in file "
-                         << inFileName
-                         << " "
-                            "go from 0 to "
-                         << numParts - 1 << "." << endl;
-
-                    return 1;
+                    cerr << "Unable to replace " << outFileName << " with "
+                         << tmpFileName << "." << endl;
+                    exitStatus = 1;
                 }
             }
-
-            headers.push_back (h);
+            else if (exitStatus != 0)
+                remove (tmpFileName.c_str ());
         }
-
-        //
-        // Crete an output file with the modified headers,
-        // and copy the pixels from the input file to the
-        // output file.
-        //
-
-        MultiPartOutputFile out (outFileName, &headers[0], numParts);
-
-        for (int p = 0; p < numParts; ++p)
+        else
         {
-            const Header& h    = in.header (p);
-            const string& type = h.type ();
-
-            if (type == SCANLINEIMAGE)
-            {
-                InputPart  inPart (in, p);
-                OutputPart outPart (out, p);
-                outPart.copyPixels (inPart);
-            }
-            else if (type == TILEDIMAGE)
-            {
-                TiledInputPart  inPart (in, p);
-                TiledOutputPart outPart (out, p);
-                outPart.copyPixels (inPart);
-            }
-            else if (type == DEEPSCANLINE)
-            {
-                DeepScanLineInputPart  inPart (in, p);
-                DeepScanLineOutputPart outPart (out, p);
-                outPart.copyPixels (inPart);
-            }
-            else if (type == DEEPTILE)
-            {
-                DeepTiledInputPart  inPart (in, p);
-                DeepTiledOutputPart outPart (out, p);
-                outPart.copyPixels (inPart);
-            }
+            exitStatus = rewriteFile (inFileName, outFileName, attrs);
         }
     }
     catch (const exception& e)
@@ -13,11 +13,17 @@
 #include "Iex.h"
 #include "IlmThread.h"
 #include "IlmThreadSemaphore.h"
+#include "OpenEXRConfigInternal.h"
 
+#include <algorithm>
 #include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 using namespace std;
@@ -28,11 +34,37 @@ ILMTHREAD_INTERNAL_NAMESPACE_SOURCE_ENTER
 #    define ENABLE_THREADING
 #endif
 
+//
+// static (USDT) probes, only compiled in when configured with
+// OPENEXR_ENABLE_SDT
+//
+
+#ifdef OPENEXR_HAVE_SYS_SDT_H
+#    include <sys/sdt.h>
+#    define ILMTHREAD_PROBE(name, ...)                                         \
+        STAP_PROBEV (ilmthread, name, __VA_ARGS__)
+#else
+#    define ILMTHREAD_PROBE(name, ...)
+#endif
+
 #if defined(__GNU_LIBRARY__) &&                                                \
     (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 21))
 #    define ENABLE_SEM_DTOR_WORKAROUND
 #endif
 
+namespace
+{
+
+//
+// The priority and weight of the TaskGroups created by this
+// thread, set by TaskPriorityScope
+//
+
+thread_local int threadTaskPriority = 0;
+thread_local int threadTaskWeight   = 1;
+
+} // namespace
+
 #ifdef ENABLE_THREADING
 
 struct TaskGroup::Data
@@ -43,6 +75,13 @@ struct TaskGroup::Data
     void             addTask ();
     void             removeTask ();
     std::atomic<int> numPending;
+
+    // the pool the group's tasks were last added to
+    std::atomic<ThreadPool*> pool;
+
+    int priority;
+    int weight;
+
     Semaphore        isEmpty; // used to signal that the taskgroup is empty
 #    if defined(ENABLE_SEM_DTOR_WORKAROUND)
     // this mutex is also used to lock numPending in the legacy c++ mode...
@@ -117,13 +156,68 @@ struct ThreadPool::Data
 namespace
 {
 
+inline void
+runTask (Task* task)
+{
+    TaskGroup* taskGroup = task->group ();
+
+    {
+        //
+        // Groups created by the task get the priority of its own
+        // group, so work it hands out keeps its place in the queue
+        //
+
+        TaskPriorityScope scope (taskGroup->priority (), taskGroup->weight ());
+
+        ILMTHREAD_PROBE (task__begin, task);
+        task->execute ();
+        ILMTHREAD_PROBE (task__end, task);
+
+        delete task;
+    }
+
+    taskGroup->_data->removeTask ();
+}
+
 class DefaultWorkerThread;
 
 struct DefaultWorkData
 {
     Semaphore          taskSemaphore; // threads wait on this for ready tasks
-    mutable std::mutex taskMutex;     // mutual exclusion for the tasks list
-    vector<Task*>      tasks;         // the list of tasks to execute
+    mutable std::mutex taskMutex;     // mutual exclusion for the lists below
+
+    //
+    // The tasks that have not started yet, kept per group so that a
+    // thread waiting on a group finds the group's tasks without
+    // searching the tasks of every other group.  order holds the
+    // group of every task in the order they were added, and tells
+    // the workers which group to take their next task from.  An
+    // entry whose task was already taken by a waiting thread is
+    // skipped.
+    //
+
+    unordered_map<TaskGroup*, vector<Task*>> groupTasks;
+    vector<TaskGroup*>                       order;
+
+    // with taskMutex locked
+    inline void pushTask (Task* task)
+    {
+        groupTasks[task->group ()].push_back (task);
+        order.push_back (task->group ());
+    }
+
+    // with taskMutex locked; the most recently added task of group,
+    // or nullptr
+    inline Task* popGroupTask (TaskGroup* group)
+    {
+        auto i = groupTasks.find (group);
+        if (i == groupTasks.end ()) return nullptr;
+
+        Task* task = i->second.back ();
+        i->second.pop_back ();
+        if (i->second.empty ()) groupTasks.erase (i);
+        return task;
+    }
 
     Semaphore threadSemaphore;      // signaled when a thread starts executing
     mutable std::mutex threadMutex; // mutual exclusion for threads list
@@ -183,19 +277,23 @@ DefaultWorkerThread::run ()
             // If there is a task pending, pop off the next task in the FIFO
             //
 
-            if (!_data->tasks.empty ())
+            if (!_data->order.empty ())
             {
-                Task* task = _data->tasks.back ();
-                _data->tasks.pop_back ();
-                // release the mutex while we process
-                taskLock.unlock ();
+                TaskGroup* group = _data->order.back ();
+                _data->order.pop_back ();
+
+                //
+                // A thread waiting on the group may have run its task
+                // already, see DefaultThreadPoolProvider::runPendingTask
+                //
 
-                TaskGroup* taskGroup = task->group ();
-                task->execute ();
+                Task* task = _data->popGroupTask (group);
+                if (!task) continue;
 
-                delete task;
+                // release the mutex while we process
+                taskLock.unlock ();
 
-                taskGroup->_data->removeTask ();
+                runTask (task);
             }
             else if (_data->stopped ())
             {
@@ -208,7 +306,9 @@ DefaultWorkerThread::run ()
 //
 // class DefaultThreadPoolProvider
 //
-class DefaultThreadPoolProvider : public ThreadPoolProvider
+class DefaultThreadPoolProvider
+    : public ThreadPoolProvider
+    , public ThreadPoolProviderExtension
 {
 public:
     DefaultThreadPoolProvider (int count);
@@ -217,9 +317,12 @@ public:
     virtual int  numThreads () const;
     virtual void setNumThreads (int count);
     virtual void addTask (Task* task);
+    virtual void addTasks (Task* const* tasks, int count);
 
     virtual void finish ();
 
+    virtual bool runPendingTask (TaskGroup* group);
+
 private:
     DefaultWorkData _data;
 };
@@ -299,7 +402,7 @@ DefaultThreadPoolProvider::addTask (Task* task)
             //
             // Push the new task into the FIFO
             //
-            _data.tasks.push_back (task);
+            _data.pushTask (task);
         }
 
         //
@@ -317,6 +420,26 @@ DefaultThreadPoolProvider::addTask (Task* task)
     }
 }
 
+void
+DefaultThreadPoolProvider::addTasks (Task* const* tasks, int count)
+{
+    if (!_data.hasThreads.load (std::memory_order_relaxed))
+    {
+        for (int i = 0; i < count; ++i)
+            addTask (tasks[i]);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> taskLock (_data.taskMutex);
+        for (int i = 0; i < count; ++i)
+            _data.pushTask (tasks[i]);
+    }
+
+    for (int i = 0; i < count; ++i)
+        _data.taskSemaphore.post ();
+}
+
 void
 DefaultThreadPoolProvider::finish ()
 {
@@ -356,11 +479,33 @@ DefaultThreadPoolProvider::finish ()
     std::lock_guard<std::mutex> lk (_data.taskMutex);
 
     _data.threads.clear ();
-    _data.tasks.clear ();
+    _data.groupTasks.clear ();
+    _data.order.clear ();
 
     _data.stopping = false;
 }
 
+bool
+DefaultThreadPoolProvider::runPendingTask (TaskGroup* group)
+{
+    Task* task = nullptr;
+
+    {
+        //
+        // The entry for the task in the order list is left in place;
+        // the worker that wakes up for it skips it
+        //
+
+        std::lock_guard<std::mutex> taskLock (_data.taskMutex);
+        task = _data.popGroupTask (group);
+    }
+
+    if (!task) return false;
+
+    runTask (task);
+    return true;
+}
+
 class NullThreadPoolProvider : public ThreadPoolProvider
 {
     virtual ~NullThreadPoolProvider () {}
@@ -375,184 +520,1147 @@ class NullThreadPoolProvider : public ThreadPoolProvider
     virtual void finish () {}
 };
 
-} //namespace
-
 //
-// struct TaskGroup::Data
+// class WorkDeque -- the work-stealing deque of Chase and Lev
+// ("Dynamic Circular Work-Stealing Deque", SPAA 2005), with the
+// memory orderings of Le et al. ("Correct and Efficient
+// Work-Stealing for Weak Memory Models", PPoPP 2013).  The worker
+// that owns the deque pushes and takes tasks at the bottom,
+// any other thread steals from the top.
 //
-
-TaskGroup::Data::Data () : numPending (0), isEmpty (1)
+class WorkDeque
 {
-    // empty
-}
+public:
+    WorkDeque () : _top (0), _bottom (0), _ring (new Ring (64)) {}
 
-TaskGroup::Data::~Data ()
-{
-    //
-    // A TaskGroup acts like an "inverted" semaphore: if the count
-    // is above 0 then waiting on the taskgroup will block.  This
-    // destructor waits until the taskgroup is empty before returning.
-    //
+    ~WorkDeque ()
+    {
+        delete _ring.load (std::memory_order_relaxed);
+        for (Ring* r: _retired)
+            delete r;
+    }
 
-    isEmpty.wait ();
+    WorkDeque (const WorkDeque&)            = delete;
+    WorkDeque& operator= (const WorkDeque&) = delete;
 
-#    ifdef ENABLE_SEM_DTOR_WORKAROUND
-    // Update: this was fixed in v. 2.2.21, so this ifdef checks for that
-    //
-    // Alas, given the current bug in glibc we need a secondary
-    // syncronisation primitive here to account for the fact that
-    // destructing the isEmpty Semaphore in this thread can cause
-    // an error for a separate thread that is issuing the post() call.
-    // We are entitled to destruct the semaphore at this point, however,
-    // that post() call attempts to access data out of the associated
-    // memory *after* it has woken the waiting threads, including this one,
-    // potentially leading to invalid memory reads.
-    // http://sources.redhat.com/bugzilla/show_bug.cgi?id=12674
+    // owner only
+    void push (Task* task)
+    {
+        int64_t b = _bottom.load (std::memory_order_relaxed);
+        int64_t t = _top.load (std::memory_order_acquire);
+        Ring*   r = _ring.load (std::memory_order_relaxed);
 
-    std::lock_guard<std::mutex> lock (dtorMutex);
-#    endif
-}
+        if (b - t > r->mask)
+        {
+            //
+            // Thieves may still be reading the old ring, so it
+            // is only deleted with the deque.
+            //
 
-void
-TaskGroup::Data::addTask ()
-{
-    //
-    // in c++11, we use an atomic to protect numPending to avoid the
-    // extra lock but for c++98, to add the ability for custom thread
-    // pool we add the lock here
-    //
-    if (numPending++ == 0) isEmpty.wait ();
-}
+            _retired.push_back (r);
+            r = r->grow (t, b);
+            _ring.store (r, std::memory_order_release);
+        }
 
-void
-TaskGroup::Data::removeTask ()
-{
-    // Alas, given the current bug in glibc we need a secondary
-    // syncronisation primitive here to account for the fact that
-    // destructing the isEmpty Semaphore in a separate thread can
-    // cause an error. Issuing the post call here the current libc
-    // implementation attempts to access memory *after* it has woken
-    // waiting threads.
-    // Since other threads are entitled to delete the semaphore the
-    // access to the memory location can be invalid.
-    // http://sources.redhat.com/bugzilla/show_bug.cgi?id=12674
-    // Update: this bug has been fixed, but how do we know which
-    // glibc version we're in?
+        r->put (b, task);
+        std::atomic_thread_fence (std::memory_order_release);
+        _bottom.store (b + 1, std::memory_order_relaxed);
+    }
 
-    // Further update:
-    //
-    // we could remove this if it is a new enough glibc, however
-    // we've changed the API to enable a custom override of a
-    // thread pool. In order to provide safe access to the numPending,
-    // we need the lock anyway, except for c++11 or newer
-    if (--numPending == 0)
+    // owner only
+    Task* take ()
     {
-#    ifdef ENABLE_SEM_DTOR_WORKAROUND
-        std::lock_guard<std::mutex> lk (dtorMutex);
-#    endif
-        isEmpty.post ();
-    }
-}
+        int64_t b = _bottom.load (std::memory_order_relaxed) - 1;
+        Ring*   r = _ring.load (std::memory_order_relaxed);
+        _bottom.store (b, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        int64_t t = _top.load (std::memory_order_relaxed);
 
-//
-// struct ThreadPool::Data
-//
+        Task* task = nullptr;
 
-ThreadPool::Data::Data () : provUsers (0), provider (NULL)
-{
-    // empty
-}
+        if (t <= b)
+        {
+            task = r->get (b);
 
-ThreadPool::Data::~Data ()
-{
-    ThreadPoolProvider* p = provider.load (std::memory_order_relaxed);
-    p->finish ();
-    delete p;
-}
+            if (t == b)
+            {
+                //
+                // Last task in the deque, race the thieves for it
+                //
+
+                if (!_top.compare_exchange_strong (
+                        t,
+                        t + 1,
+                        std::memory_order_seq_cst,
+                        std::memory_order_relaxed))
+                    task = nullptr;
+
+                _bottom.store (b + 1, std::memory_order_relaxed);
+            }
+        }
+        else
+        {
+            _bottom.store (b + 1, std::memory_order_relaxed);
+        }
 
-inline ThreadPool::Data::SafeProvider
-ThreadPool::Data::getProvider ()
-{
-    provUsers.fetch_add (1, std::memory_order_relaxed);
-    return SafeProvider (this, provider.load (std::memory_order_relaxed));
-}
+        return task;
+    }
 
-inline void
-ThreadPool::Data::coalesceProviderUse ()
-{
-    int ov = provUsers.fetch_sub (1, std::memory_order_relaxed);
-    // ov is the previous value, so one means that now it might be 0
-    if (ov == 1)
+    // any thread
+    Task* steal ()
     {
-        // do we have anything to do here?
-    }
-}
+        int64_t t = _top.load (std::memory_order_acquire);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        int64_t b = _bottom.load (std::memory_order_acquire);
 
-inline void
-ThreadPool::Data::bumpProviderUse ()
-{
-    provUsers.fetch_add (1, std::memory_order_relaxed);
-}
+        if (t >= b) return nullptr;
 
-inline void
-ThreadPool::Data::setProvider (ThreadPoolProvider* p)
-{
-    ThreadPoolProvider* old = provider.load (std::memory_order_relaxed);
-    // work around older gcc bug just in case
-    do
-    {
-        if (!provider.compare_exchange_weak (
-                old, p, std::memory_order_release, std::memory_order_relaxed))
-            continue;
-    } while (false); // NOSONAR - suppress SonarCloud bug report.
+        Ring* r    = _ring.load (std::memory_order_acquire);
+        Task* task = r->get (t);
 
-    // wait for any other users to finish prior to deleting, given
-    // that these are just mostly to query the thread count or push a
-    // task to the queue (so fast), just spin...
-    //
-    // (well, and normally, people don't do this mid stream anyway, so
-    // this will be 0 99.999% of the time, but just to be safe)
-    //
-    while (provUsers.load (std::memory_order_relaxed) > 0)
-        std::this_thread::yield ();
+        if (!_top.compare_exchange_strong (
+                t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
 
-    if (old)
-    {
-        old->finish ();
-        delete old;
+        return task;
     }
 
-    // NB: the shared_ptr mechanism is safer and means we don't have
-    // to have the provUsers counter since the shared_ptr keeps that
-    // for us. However, gcc 4.8/9 compilers which many people are
-    // still using even though it is 2018 forgot to add the shared_ptr
-    // functions... once that compiler is fully deprecated, switch to
-    // using the below, change provider to a std::shared_ptr and remove
-    // provUsers...
-    //
-    //    std::shared_ptr<ThreadPoolProvider> newp( p );
-    //    std::shared_ptr<ThreadPoolProvider> curp = std::atomic_load_explicit( &provider, std::memory_order_relaxed );
-    //    do
-    //    {
-    //        if ( ! std::atomic_compare_exchange_weak_explicit( &provider, &curp, newp, std::memory_order_release, std::memory_order_relaxed ) )
-    //            continue;
-    //    } while ( false );
-    //    if ( curp )
-    //        curp->finish();
-}
+private:
+    struct Ring
+    {
+        explicit Ring (int64_t size)
+            : mask (size - 1), slots (new std::atomic<Task*>[size])
+        {}
 
-#endif // ENABLE_THREADING
+        ~Ring () { delete[] slots; }
+
+        //
+        // The fences in push() and steal() already order these;
+        // release and acquire also make the hand-off visible to
+        // race detectors, which do not model fences.
+        //
+
+        Task* get (int64_t i) const
+        {
+            return slots[i & mask].load (std::memory_order_acquire);
+        }
+
+        void put (int64_t i, Task* task)
+        {
+            slots[i & mask].store (task, std::memory_order_release);
+        }
+
+        Ring* grow (int64_t t, int64_t b) const
+        {
+            Ring* r = new Ring (2 * (mask + 1));
+            for (int64_t i = t; i < b; ++i)
+                r->put (i, get (i));
+            return r;
+        }
+
+        const int64_t       mask;
+        std::atomic<Task*>* slots;
+    };
+
+    // top and bottom are on separate cache lines
+    std::atomic<int64_t> _top;
+    char                 _pad[64];
+    std::atomic<int64_t> _bottom;
+    std::atomic<Ring*>   _ring;
+    std::vector<Ring*>   _retired;
+};
 
 //
-// class Task
+// class Inbox -- a bounded queue that any number of threads
+// push to and pop from without a lock (Vyukov's bounded MPMC
+// queue).  Tasks added from outside a WorkerSet go here.
 //
-
-Task::Task (TaskGroup* g) : _group (g)
+class Inbox
 {
-#ifdef ENABLE_THREADING
-    if (g) g->_data->addTask ();
-#endif
-}
+public:
+    static const size_t capacity = 1024;
+
+    Inbox () : _cells (new Cell[capacity]), _enqueuePos (0), _dequeuePos (0)
+    {
+        for (size_t i = 0; i < capacity; ++i)
+            _cells[i].sequence.store (i, std::memory_order_relaxed);
+    }
+
+    Inbox (const Inbox&)            = delete;
+    Inbox& operator= (const Inbox&) = delete;
+
+    // returns false if the inbox is full
+    bool push (Task* task)
+    {
+        size_t pos = _enqueuePos.load (std::memory_order_relaxed);
+        Cell*  cell;
+
+        while (true)
+        {
+            cell        = &_cells[pos & (capacity - 1)];
+            size_t seq  = cell->sequence.load (std::memory_order_acquire);
+            intptr_t df = (intptr_t) seq - (intptr_t) pos;
+
+            if (df == 0)
+            {
+                if (_enqueuePos.compare_exchange_weak (
+                        pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (df < 0)
+                return false;
+            else
+                pos = _enqueuePos.load (std::memory_order_relaxed);
+        }
+
+        cell->task = task;
+        cell->sequence.store (pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // returns nullptr if the inbox is empty
+    Task* pop ()
+    {
+        size_t pos = _dequeuePos.load (std::memory_order_relaxed);
+        Cell*  cell;
+
+        while (true)
+        {
+            cell        = &_cells[pos & (capacity - 1)];
+            size_t seq  = cell->sequence.load (std::memory_order_acquire);
+            intptr_t df = (intptr_t) seq - (intptr_t) (pos + 1);
+
+            if (df == 0)
+            {
+                if (_dequeuePos.compare_exchange_weak (
+                        pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (df < 0)
+                return nullptr;
+            else
+                pos = _dequeuePos.load (std::memory_order_relaxed);
+        }
+
+        Task* task = cell->task;
+        cell->sequence.store (pos + capacity, std::memory_order_release);
+        return task;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        Task*               task;
+    };
+
+    std::unique_ptr<Cell[]> _cells;
+    char                    _pad0[64];
+    std::atomic<size_t>     _enqueuePos;
+    char                    _pad1[64];
+    std::atomic<size_t>     _dequeuePos;
+};
+
+struct WorkerQueues
+{
+    WorkDeque deque;
+    Inbox     inbox;
+};
+
+class WorkerSet;
+
+//
+// The worker of a WorkerSet running on this thread, if any
+//
+
+struct CurrentWorker
+{
+    const WorkerSet* set;
+    int              index;
+};
+
+thread_local CurrentWorker currentWorker = {nullptr, -1};
+
+//
+// class WorkerSet -- the worker threads of a
+// WorkStealingThreadPoolProvider and their queues.
+//
+class WorkerSet
+{
+public:
+    explicit WorkerSet (int count);
+    ~WorkerSet ();
+
+    WorkerSet (const WorkerSet&)            = delete;
+    WorkerSet& operator= (const WorkerSet&) = delete;
+
+    int size () const { return _count; }
+
+    void push (Task* task);
+    void push (Task* const* tasks, int count);
+    void run (int self);
+
+    //
+    // When called by one of our workers, removes and returns the
+    // task of group nearest the bottom of its deque, if any
+    //
+
+    Task* takePending (TaskGroup* group);
+
+    //
+    // Waits for the threads to run all queued tasks, then joins them
+    //
+
+    void stop ();
+
+private:
+    Task* findTask (int self);
+    Task* popOverflow ();
+    void  queue (Task* task);
+    void  wake (int count);
+    void  cancelSleep ();
+
+    class WorkerThread : public Thread
+    {
+    public:
+        WorkerThread (WorkerSet* set, int index) : _set (set), _index (index)
+        {
+            start ();
+        }
+
+        virtual void run () { _set->run (_index); }
+
+    private:
+        WorkerSet* _set;
+        int        _index;
+    };
+
+    const int                       _count;
+    std::unique_ptr<WorkerQueues[]> _queues;
+    vector<WorkerThread*>           _threads;
+
+    //
+    // Used when all inboxes are full
+    //
+
+    std::mutex        _overflowMutex;
+    std::deque<Task*> _overflow;
+    std::atomic<int>  _overflowCount;
+
+    //
+    // Idle workers wait on _wakeSemaphore.  _sleepers counts the
+    // workers that are about to wait or are waiting, less the
+    // number of times _wakeSemaphore has been posted for them.
+    //
+
+    Semaphore         _wakeSemaphore;
+    std::atomic<int>  _sleepers;
+    std::atomic<bool> _stopping;
+};
+
+WorkerSet::WorkerSet (int count)
+    : _count (count)
+    , _queues (new WorkerQueues[count])
+    , _overflowCount (0)
+    , _wakeSemaphore (0)
+    , _sleepers (0)
+    , _stopping (false)
+{
+    for (int i = 0; i < count; ++i)
+        _threads.push_back (new WorkerThread (this, i));
+}
+
+WorkerSet::~WorkerSet ()
+{
+    stop ();
+}
+
+void
+WorkerSet::push (Task* task)
+{
+    queue (task);
+    wake (1);
+}
+
+void
+WorkerSet::push (Task* const* tasks, int count)
+{
+    for (int i = 0; i < count; ++i)
+        queue (tasks[i]);
+
+    wake (count);
+}
+
+void
+WorkerSet::queue (Task* task)
+{
+    if (currentWorker.set == this)
+    {
+        //
+        // Added by a task running on one of our workers, which
+        // will most likely run it next
+        //
+
+        _queues[currentWorker.index].deque.push (task);
+    }
+    else
+    {
+        //
+        // Spread the tasks of each thread over all inboxes
+        //
+
+        thread_local unsigned nextInbox = static_cast<unsigned> (
+            std::hash<std::thread::id> () (std::this_thread::get_id ()));
+
+        unsigned first  = nextInbox++;
+        bool     queued = false;
+
+        for (int i = 0; i < _count && !queued; ++i)
+            queued = _queues[(first + i) % _count].inbox.push (task);
+
+        if (!queued)
+        {
+            std::lock_guard<std::mutex> lock (_overflowMutex);
+            _overflow.push_back (task);
+            _overflowCount.fetch_add (1, std::memory_order_release);
+        }
+    }
+}
+
+Task*
+WorkerSet::takePending (TaskGroup* group)
+{
+    if (currentWorker.set != this) return nullptr;
+
+    WorkDeque& deque = _queues[currentWorker.index].deque;
+
+    //
+    // Tasks of other groups, such as the ones a task of ours added
+    // to a pool of its own, may be on top of ours.  Set them aside
+    // and put them back in the order they were in.
+    //
+
+    vector<Task*> others;
+    Task*         task;
+
+    while ((task = deque.take ()) && task->group () != group)
+        others.push_back (task);
+
+    for (size_t i = others.size (); i-- > 0;)
+        deque.push (others[i]);
+
+    return task;
+}
+
+Task*
+WorkerSet::popOverflow ()
+{
+    if (_overflowCount.load (std::memory_order_acquire) == 0) return nullptr;
+
+    std::lock_guard<std::mutex> lock (_overflowMutex);
+    if (_overflow.empty ()) return nullptr;
+
+    Task* task = _overflow.front ();
+    _overflow.pop_front ();
+    _overflowCount.fetch_sub (1, std::memory_order_relaxed);
+    return task;
+}
+
+Task*
+WorkerSet::findTask (int self)
+{
+    WorkerQueues& own = _queues[self];
+
+    Task* task = own.deque.take ();
+    if (!task) task = own.inbox.pop ();
+    if (!task) task = popOverflow ();
+
+    for (int i = 1; i < _count && !task; ++i)
+    {
+        WorkerQueues& victim = _queues[(self + i) % _count];
+
+        task = victim.deque.steal ();
+        if (!task) task = victim.inbox.pop ();
+    }
+
+    return task;
+}
+
+void
+WorkerSet::wake (int count)
+{
+    //
+    // Pairs with the fence in run(): either a worker that is
+    // about to wait sees the task we just queued, or we see
+    // that it is about to wait.
+    //
+
+    std::atomic_thread_fence (std::memory_order_seq_cst);
+
+    int sleepers = _sleepers.load (std::memory_order_relaxed);
+    while (count > 0 && sleepers > 0)
+    {
+        if (_sleepers.compare_exchange_weak (
+                sleepers, sleepers - 1, std::memory_order_relaxed))
+        {
+            _wakeSemaphore.post ();
+            --count;
+        }
+    }
+}
+
+void
+WorkerSet::cancelSleep ()
+{
+    int sleepers = _sleepers.load (std::memory_order_relaxed);
+    while (sleepers > 0)
+    {
+        if (_sleepers.compare_exchange_weak (
+                sleepers, sleepers - 1, std::memory_order_relaxed))
+            return;
+    }
+
+    //
+    // Someone already posted on our behalf; take that post
+    // so it does not wake another worker for nothing.
+    //
+
+    _wakeSemaphore.wait ();
+}
+
+void
+WorkerSet::run (int self)
+{
+    currentWorker = {this, self};
+
+    while (true)
+    {
+        Task* task = findTask (self);
+
+        if (!task)
+        {
+            _sleepers.fetch_add (1, std::memory_order_relaxed);
+            std::atomic_thread_fence (std::memory_order_seq_cst);
+
+            task = findTask (self);
+
+            if (!task && !_stopping.load (std::memory_order_relaxed))
+            {
+                _wakeSemaphore.wait ();
+                continue;
+            }
+
+            if (!task) break;
+
+            cancelSleep ();
+        }
+
+        runTask (task);
+    }
+
+    currentWorker = {nullptr, -1};
+}
+
+void
+WorkerSet::stop ()
+{
+    if (_threads.empty ()) return;
+
+    _stopping = true;
+
+    //
+    // Wake every worker; each one exits once it finds no more tasks
+    //
+
+    for (int i = 0; i < _count; ++i)
+        _wakeSemaphore.post ();
+
+    for (WorkerThread* t: _threads)
+    {
+        if (t->joinable ()) t->join ();
+        delete t;
+    }
+
+    _threads.clear ();
+}
+
+} //namespace
+
+//
+// struct WorkStealingThreadPoolProvider::Data
+//
+
+struct WorkStealingThreadPoolProvider::Data
+{
+    Data () : active (nullptr), pushers (0), count (0) {}
+    ~Data () { stop (); }
+
+    void stop ();
+
+    mutable std::mutex      threadMutex; // serializes changes to the workers
+    std::atomic<WorkerSet*> active;      // nullptr when there are no threads
+    std::atomic<int>        pushers;     // calls using active
+    int                     count;
+};
+
+void
+WorkStealingThreadPoolProvider::Data::stop ()
+{
+    WorkerSet* set = active.exchange (nullptr);
+    if (!set) return;
+
+    //
+    // Wait for tasks that are being added to reach the queues;
+    // later calls to addTask() run their task right away.
+    //
+
+    while (pushers.load () > 0)
+        std::this_thread::yield ();
+
+    delete set;
+}
+
+//
+// struct PriorityThreadPoolProvider::Data
+//
+
+struct PriorityThreadPoolProvider::Data
+{
+    explicit Data (int fairnessInterval);
+    ~Data ();
+
+    //
+    // The queued tasks of one TaskGroup.  Stride scheduling shares
+    // the workers between the groups of a priority level: each task
+    // run adds stride, which is inversely proportional to the group's
+    // weight, to its pass, and the group with the lowest pass is next.
+    //
+
+    struct GroupQueue
+    {
+        TaskGroup*                             group;
+        int                                    priority;
+        uint64_t                               stride;
+        uint64_t                               pass;
+        std::deque<std::pair<uint64_t, Task*>> tasks; // sequence, task
+    };
+
+    static const uint64_t strideUnit = 1 << 20;
+
+    void  push (Task* task);
+    Task* pop ();
+    Task* popFrom (GroupQueue* queue);
+
+    void startThreads (int count);
+    void stopThreads ();
+    void run ();
+
+    class WorkerThread : public Thread
+    {
+    public:
+        WorkerThread (Data* data) : _data (data) { start (); }
+
+        virtual void run () { _data->run (); }
+
+    private:
+        Data* _data;
+    };
+
+    mutable std::mutex    threadMutex; // serializes changes to threads
+    vector<WorkerThread*> threads;
+
+    std::mutex                                  taskMutex; // for all below
+    std::map<int, vector<GroupQueue*>>          levels;    // by priority
+    std::unordered_map<TaskGroup*, GroupQueue*> groups;
+    uint64_t                                    nextSequence;
+    int                                         untilOldestTask;
+    const int                                   fairnessInterval;
+    bool                                        hasThreads;
+    bool                                        stopping;
+
+    Semaphore taskSemaphore; // posted once for every task added
+};
+
+PriorityThreadPoolProvider::Data::Data (int fairnessInterval)
+    : nextSequence (0)
+    , untilOldestTask (fairnessInterval)
+    , fairnessInterval (fairnessInterval)
+    , hasThreads (false)
+    , stopping (false)
+    , taskSemaphore (0)
+{}
+
+PriorityThreadPoolProvider::Data::~Data ()
+{
+    stopThreads ();
+}
+
+void
+PriorityThreadPoolProvider::Data::push (Task* task)
+{
+    TaskGroup*   group = task->group ();
+    GroupQueue*& queue = groups[group];
+
+    if (!queue)
+    {
+        queue           = new GroupQueue;
+        queue->group    = group;
+        queue->priority = group->priority ();
+        queue->stride   = strideUnit / std::max (1, group->weight ());
+
+        //
+        // Start level with the group that has run the fewest tasks,
+        // so a new group neither waits for nor overtakes the others
+        //
+
+        vector<GroupQueue*>& level = levels[queue->priority];
+
+        queue->pass = 0;
+        for (size_t i = 0; i < level.size (); ++i)
+        {
+            if (i == 0 || level[i]->pass < queue->pass)
+                queue->pass = level[i]->pass;
+        }
+
+        level.push_back (queue);
+    }
+
+    queue->tasks.emplace_back (nextSequence++, task);
+}
+
+Task*
+PriorityThreadPoolProvider::Data::pop ()
+{
+    if (levels.empty ()) return nullptr;
+
+    GroupQueue* next = nullptr;
+
+    if (--untilOldestTask <= 0)
+    {
+        //
+        // Run the task that has waited the longest, so that
+        // groups with a lower priority are not starved
+        //
+
+        untilOldestTask = fairnessInterval;
+
+        for (auto& level: levels)
+        {
+            for (GroupQueue* queue: level.second)
+            {
+                if (!next ||
+                    queue->tasks.front ().first < next->tasks.front ().first)
+                    next = queue;
+            }
+        }
+    }
+    else
+    {
+        for (GroupQueue* queue: levels.rbegin ()->second)
+        {
+            if (!next || queue->pass < next->pass) next = queue;
+        }
+    }
+
+    return popFrom (next);
+}
+
+Task*
+PriorityThreadPoolProvider::Data::popFrom (GroupQueue* queue)
+{
+    Task* task = queue->tasks.front ().second;
+    queue->tasks.pop_front ();
+    queue->pass += queue->stride;
+
+    if (queue->tasks.empty ())
+    {
+        vector<GroupQueue*>& level = levels[queue->priority];
+        level.erase (std::find (level.begin (), level.end (), queue));
+        if (level.empty ()) levels.erase (queue->priority);
+
+        groups.erase (queue->group);
+        delete queue;
+    }
+
+    return task;
+}
+
+void
+PriorityThreadPoolProvider::Data::startThreads (int count)
+{
+    for (int i = 0; i < count; ++i)
+        threads.push_back (new WorkerThread (this));
+
+    std::lock_guard<std::mutex> lock (taskMutex);
+    hasThreads = !threads.empty ();
+}
+
+void
+PriorityThreadPoolProvider::Data::stopThreads ()
+{
+    if (threads.empty ()) return;
+
+    {
+        std::lock_guard<std::mutex> lock (taskMutex);
+        stopping = true;
+    }
+
+    //
+    // Each thread exits once it finds no more tasks
+    //
+
+    for (size_t i = 0; i < threads.size (); ++i)
+        taskSemaphore.post ();
+
+    for (WorkerThread* t: threads)
+    {
+        if (t->joinable ()) t->join ();
+        delete t;
+    }
+
+    threads.clear ();
+
+    std::lock_guard<std::mutex> lock (taskMutex);
+    hasThreads = false;
+    stopping   = false;
+}
+
+void
+PriorityThreadPoolProvider::Data::run ()
+{
+    while (true)
+    {
+        taskSemaphore.wait ();
+
+        Task* task;
+
+        {
+            std::lock_guard<std::mutex> lock (taskMutex);
+            task = pop ();
+            if (!task && stopping) break;
+        }
+
+        //
+        // The task may have been run by a thread waiting for
+        // its group, see PriorityThreadPoolProvider::runPendingTask
+        //
+
+        if (task) runTask (task);
+    }
+}
+
+//
+// struct TaskGroup::Data
+//
+
+TaskGroup::Data::Data ()
+    : numPending (0)
+    , pool (nullptr)
+    , priority (threadTaskPriority)
+    , weight (threadTaskWeight)
+    , isEmpty (1)
+{
+    // empty
+}
+
+TaskGroup::Data::~Data ()
+{
+    //
+    // A TaskGroup acts like an "inverted" semaphore: if the count
+    // is above 0 then waiting on the taskgroup will block.  This
+    // destructor waits until the taskgroup is empty before returning.
+    //
+
+    isEmpty.wait ();
+
+#    ifdef ENABLE_SEM_DTOR_WORKAROUND
+    // Update: this was fixed in v. 2.2.21, so this ifdef checks for that
+    //
+    // Alas, given the current bug in glibc we need a secondary
+    // syncronisation primitive here to account for the fact that
+    // destructing the isEmpty Semaphore in this thread can cause
+    // an error for a separate thread that is issuing the post() call.
+    // We are entitled to destruct the semaphore at this point, however,
+    // that post() call attempts to access data out of the associated
+    // memory *after* it has woken the waiting threads, including this one,
+    // potentially leading to invalid memory reads.
+    // http://sources.redhat.com/bugzilla/show_bug.cgi?id=12674
+
+    std::lock_guard<std::mutex> lock (dtorMutex);
+#    endif
+}
+
+void
+TaskGroup::Data::addTask ()
+{
+    //
+    // in c++11, we use an atomic to protect numPending to avoid the
+    // extra lock but for c++98, to add the ability for custom thread
+    // pool we add the lock here
+    //
+    if (numPending++ == 0) isEmpty.wait ();
+}
+
+void
+TaskGroup::Data::removeTask ()
+{
+    // Alas, given the current bug in glibc we need a secondary
+    // syncronisation primitive here to account for the fact that
+    // destructing the isEmpty Semaphore in a separate thread can
+    // cause an error. Issuing the post call here the current libc
+    // implementation attempts to access memory *after* it has woken
+    // waiting threads.
+    // Since other threads are entitled to delete the semaphore the
+    // access to the memory location can be invalid.
+    // http://sources.redhat.com/bugzilla/show_bug.cgi?id=12674
+    // Update: this bug has been fixed, but how do we know which
+    // glibc version we're in?
+
+    // Further update:
+    //
+    // we could remove this if it is a new enough glibc, however
+    // we've changed the API to enable a custom override of a
+    // thread pool. In order to provide safe access to the numPending,
+    // we need the lock anyway, except for c++11 or newer
+    if (--numPending == 0)
+    {
+#    ifdef ENABLE_SEM_DTOR_WORKAROUND
+        std::lock_guard<std::mutex> lk (dtorMutex);
+#    endif
+        isEmpty.post ();
+    }
+}
+
+//
+// struct ThreadPool::Data
+//
+
+ThreadPool::Data::Data () : provUsers (0), provider (NULL)
+{
+    // empty
+}
+
+ThreadPool::Data::~Data ()
+{
+    ThreadPoolProvider* p = provider.load (std::memory_order_relaxed);
+    p->finish ();
+    delete p;
+}
+
+inline ThreadPool::Data::SafeProvider
+ThreadPool::Data::getProvider ()
+{
+    provUsers.fetch_add (1, std::memory_order_relaxed);
+    return SafeProvider (this, provider.load (std::memory_order_relaxed));
+}
+
+inline void
+ThreadPool::Data::coalesceProviderUse ()
+{
+    int ov = provUsers.fetch_sub (1, std::memory_order_relaxed);
+    // ov is the previous value, so one means that now it might be 0
+    if (ov == 1)
+    {
+        // do we have anything to do here?
+    }
+}
+
+inline void
+ThreadPool::Data::bumpProviderUse ()
+{
+    provUsers.fetch_add (1, std::memory_order_relaxed);
+}
+
+inline void
+ThreadPool::Data::setProvider (ThreadPoolProvider* p)
+{
+    ThreadPoolProvider* old = provider.load (std::memory_order_relaxed);
+    // work around older gcc bug just in case
+    do
+    {
+        if (!provider.compare_exchange_weak (
+                old, p, std::memory_order_release, std::memory_order_relaxed))
+            continue;
+    } while (false); // NOSONAR - suppress SonarCloud bug report.
+
+    // wait for any other users to finish prior to deleting, given
+    // that these are just mostly to query the thread count or push a
+    // task to the queue (so fast), just spin...
+    //
+    // (well, and normally, people don't do this mid stream anyway, so
+    // this will be 0 99.999% of the time, but just to be safe)
+    //
+    while (provUsers.load (std::memory_order_relaxed) > 0)
+        std::this_thread::yield ();
+
+    if (old)
+    {
+        old->finish ();
+        delete old;
+    }
+
+    // NB: the shared_ptr mechanism is safer and means we don't have
+    // to have the provUsers counter since the shared_ptr keeps that
+    // for us. However, gcc 4.8/9 compilers which many people are
+    // still using even though it is 2018 forgot to add the shared_ptr
+    // functions... once that compiler is fully deprecated, switch to
+    // using the below, change provider to a std::shared_ptr and remove
+    // provUsers...
+    //
+    //    std::shared_ptr<ThreadPoolProvider> newp( p );
+    //    std::shared_ptr<ThreadPoolProvider> curp = std::atomic_load_explicit( &provider, std::memory_order_relaxed );
+    //    do
+    //    {
+    //        if ( ! std::atomic_compare_exchange_weak_explicit( &provider, &curp, newp, std::memory_order_release, std::memory_order_relaxed ) )
+    //            continue;
+    //    } while ( false );
+    //    if ( curp )
+    //        curp->finish();
+}
+
+#endif // ENABLE_THREADING
+
+namespace
+{
+
+//
+// The free blocks of RecycledTasks, in size classes of
+// recycledBlockSize bytes.  Each thread caches up to
+// 2 * recycledBatch blocks of each class, and moves
+// recycledBatch blocks at a time to or from the shared
+// lists.  Blocks beyond recycledSharedLimit per class
+// go back to the heap.
+//
+
+const size_t recycledBlockSize   = 64;
+const size_t recycledClasses     = 16;
+const size_t recycledBatch       = 16;
+const size_t recycledSharedLimit = 1024;
+
+//
+// The size class of a block of size bytes; recycledClasses
+// or more for blocks that use the heap, including size 0
+//
+
+inline size_t
+recycledClass (size_t size)
+{
+    return (size + recycledBlockSize - 1) / recycledBlockSize - 1;
+}
+
+struct SharedTaskBlocks
+{
+    std::mutex    mutex;
+    vector<void*> blocks[recycledClasses];
+};
+
+SharedTaskBlocks&
+sharedTaskBlocks ()
+{
+    //
+    // Never destroyed: threads may return their blocks
+    // while static objects are being destroyed
+    //
+
+    static SharedTaskBlocks* shared = new SharedTaskBlocks;
+    return *shared;
+}
+
+//
+// Trivially destructible, so that it can still be used
+// after the thread's ThreadTaskBlocksOwner is destroyed
+//
+
+struct ThreadTaskBlocks
+{
+    void*  blocks[recycledClasses][2 * recycledBatch];
+    size_t count[recycledClasses];
+    bool   exited;
+};
+
+thread_local ThreadTaskBlocks threadTaskBlocks;
+
+//
+// Moves count blocks of class c from the calling
+// thread's cache to the shared lists
+//
+
+void
+releaseTaskBlocks (size_t c, size_t count)
+{
+    ThreadTaskBlocks& local  = threadTaskBlocks;
+    SharedTaskBlocks& shared = sharedTaskBlocks ();
+
+    std::lock_guard<std::mutex> lock (shared.mutex);
+
+    for (; count > 0; --count)
+    {
+        void* block = local.blocks[c][--local.count[c]];
+
+        if (shared.blocks[c].size () < recycledSharedLimit)
+            shared.blocks[c].push_back (block);
+        else
+            ::operator delete (block);
+    }
+}
+
+//
+// Returns the thread's cached blocks to the shared
+// lists when the thread exits
+//
+
+struct ThreadTaskBlocksOwner
+{
+    ~ThreadTaskBlocksOwner ()
+    {
+        for (size_t c = 0; c < recycledClasses; ++c)
+            releaseTaskBlocks (c, threadTaskBlocks.count[c]);
+
+        threadTaskBlocks.exited = true;
+    }
+};
+
+void
+ownThreadTaskBlocks ()
+{
+    static thread_local ThreadTaskBlocksOwner owner;
+    (void) owner;
+}
+
+//
+// Refills the calling thread's cache of
+// class c from the shared lists
+//
+
+void
+acquireTaskBlocks (size_t c)
+{
+    ThreadTaskBlocks& local  = threadTaskBlocks;
+    SharedTaskBlocks& shared = sharedTaskBlocks ();
+
+    ownThreadTaskBlocks ();
+
+    std::lock_guard<std::mutex> lock (shared.mutex);
+
+    while (local.count[c] < recycledBatch && !shared.blocks[c].empty ())
+    {
+        local.blocks[c][local.count[c]++] = shared.blocks[c].back ();
+        shared.blocks[c].pop_back ();
+    }
+}
+
+} // namespace
+
+//
+// class Task
+//
+
+Task::Task (TaskGroup* g) : _group (g)
+{
+#ifdef ENABLE_THREADING
+    if (g) g->_data->addTask ();
+#endif
+}
 
 Task::~Task ()
 {
@@ -565,6 +1673,55 @@ Task::group ()
     return _group;
 }
 
+//
+// class RecycledTask
+//
+
+RecycledTask::RecycledTask (TaskGroup* g) : Task (g)
+{
+    // empty
+}
+
+RecycledTask::~RecycledTask ()
+{
+    // empty
+}
+
+void*
+RecycledTask::operator new (size_t size)
+{
+    size_t c = recycledClass (size);
+    if (c >= recycledClasses) return ::operator new (size);
+
+    ThreadTaskBlocks& local = threadTaskBlocks;
+
+    if (local.count[c] == 0 && !local.exited) acquireTaskBlocks (c);
+
+    if (local.count[c] > 0) return local.blocks[c][--local.count[c]];
+
+    return ::operator new ((c + 1) * recycledBlockSize);
+}
+
+void
+RecycledTask::operator delete (void* ptr, size_t size)
+{
+    size_t c = recycledClass (size);
+    ThreadTaskBlocks& local = threadTaskBlocks;
+
+    if (c >= recycledClasses || local.exited)
+    {
+        ::operator delete (ptr);
+        return;
+    }
+
+    ownThreadTaskBlocks ();
+
+    if (local.count[c] == 2 * recycledBatch)
+        releaseTaskBlocks (c, recycledBatch);
+
+    local.blocks[c][local.count[c]++] = ptr;
+}
+
 TaskGroup::TaskGroup ()
     :
 #ifdef ENABLE_THREADING
@@ -579,6 +1736,16 @@ TaskGroup::TaskGroup ()
 TaskGroup::~TaskGroup ()
 {
 #ifdef ENABLE_THREADING
+    //
+    // Rather than leave this thread idle while the workers finish
+    // our tasks, run the ones they have not started yet.  This also
+    // keeps a worker whose task waits on a group of its own from
+    // deadlocking a pool that has no other free thread.
+    //
+
+    while (_data->numPending.load () > 0 && runPendingTask ())
+        ;
+
     delete _data;
 #endif
 }
@@ -591,6 +1758,88 @@ TaskGroup::finishOneTask ()
 #endif
 }
 
+void
+TaskGroup::waitFor (Semaphore& sem)
+{
+#ifdef ENABLE_THREADING
+    while (!sem.tryWait ())
+    {
+        if (!runPendingTask ())
+        {
+            sem.wait ();
+            break;
+        }
+    }
+#else
+    sem.wait ();
+#endif
+}
+
+void
+TaskGroup::setPriority (int priority, int weight)
+{
+#ifdef ENABLE_THREADING
+    _data->priority = priority;
+    _data->weight   = weight;
+#else
+    (void) priority;
+    (void) weight;
+#endif
+}
+
+int
+TaskGroup::priority () const
+{
+#ifdef ENABLE_THREADING
+    return _data->priority;
+#else
+    return 0;
+#endif
+}
+
+int
+TaskGroup::weight () const
+{
+#ifdef ENABLE_THREADING
+    return _data->weight;
+#else
+    return 1;
+#endif
+}
+
+bool
+TaskGroup::runPendingTask ()
+{
+#ifdef ENABLE_THREADING
+    ThreadPool* pool = _data->pool.load (std::memory_order_relaxed);
+    if (!pool) return false;
+
+    ThreadPool::Data::SafeProvider sp  = pool->_data->getProvider ();
+    ThreadPoolProviderExtension*   ext =
+        dynamic_cast<ThreadPoolProviderExtension*> (sp.get ());
+    return ext && ext->runPendingTask (this);
+#else
+    return false;
+#endif
+}
+
+//
+// class TaskPriorityScope
+//
+
+TaskPriorityScope::TaskPriorityScope (int priority, int weight)
+    : _oldPriority (threadTaskPriority), _oldWeight (threadTaskWeight)
+{
+    threadTaskPriority = priority;
+    threadTaskWeight   = weight;
+}
+
+TaskPriorityScope::~TaskPriorityScope ()
+{
+    threadTaskPriority = _oldPriority;
+    threadTaskWeight   = _oldWeight;
+}
+
 //
 // class ThreadPoolProvider
 //
@@ -601,6 +1850,293 @@ ThreadPoolProvider::ThreadPoolProvider ()
 ThreadPoolProvider::~ThreadPoolProvider ()
 {}
 
+//
+// class ThreadPoolProviderExtension
+//
+
+ThreadPoolProviderExtension::~ThreadPoolProviderExtension ()
+{}
+
+//
+// class WorkStealingThreadPoolProvider
+//
+
+WorkStealingThreadPoolProvider::WorkStealingThreadPoolProvider (int count)
+    :
+#ifdef ENABLE_THREADING
+    _data (new Data)
+#else
+    _data (nullptr)
+#endif
+{
+    setNumThreads (count);
+}
+
+WorkStealingThreadPoolProvider::~WorkStealingThreadPoolProvider ()
+{
+#ifdef ENABLE_THREADING
+    delete _data;
+#endif
+}
+
+int
+WorkStealingThreadPoolProvider::numThreads () const
+{
+#ifdef ENABLE_THREADING
+    std::lock_guard<std::mutex> lock (_data->threadMutex);
+    return _data->count;
+#else
+    return 0;
+#endif
+}
+
+void
+WorkStealingThreadPoolProvider::setNumThreads (int count)
+{
+#ifdef ENABLE_THREADING
+    std::lock_guard<std::mutex> lock (_data->threadMutex);
+    if (count == _data->count) return;
+
+    //
+    // The queues belong to the workers, so finish all tasks
+    // and start a new set of workers
+    //
+
+    _data->stop ();
+    if (count > 0)
+        _data->active.store (new WorkerSet (count), std::memory_order_release);
+    _data->count = count > 0 ? count : 0;
+#else
+    (void) count;
+#endif
+}
+
+void
+WorkStealingThreadPoolProvider::addTask (Task* task)
+{
+#ifdef ENABLE_THREADING
+    _data->pushers.fetch_add (1, std::memory_order_acquire);
+
+    WorkerSet* set = _data->active.load (std::memory_order_acquire);
+    if (set) set->push (task);
+
+    _data->pushers.fetch_sub (1, std::memory_order_release);
+
+    if (!set) runTask (task);
+#else
+    task->execute ();
+    delete task;
+#endif
+}
+
+void
+WorkStealingThreadPoolProvider::addTasks (Task* const* tasks, int count)
+{
+#ifdef ENABLE_THREADING
+    _data->pushers.fetch_add (1, std::memory_order_acquire);
+
+    WorkerSet* set = _data->active.load (std::memory_order_acquire);
+    if (set) set->push (tasks, count);
+
+    _data->pushers.fetch_sub (1, std::memory_order_release);
+
+    if (!set)
+    {
+        for (int i = 0; i < count; ++i)
+            runTask (tasks[i]);
+    }
+#else
+    for (int i = 0; i < count; ++i)
+        addTask (tasks[i]);
+#endif
+}
+
+void
+WorkStealingThreadPoolProvider::finish ()
+{
+#ifdef ENABLE_THREADING
+    std::lock_guard<std::mutex> lock (_data->threadMutex);
+    _data->stop ();
+    _data->count = 0;
+#endif
+}
+
+bool
+WorkStealingThreadPoolProvider::runPendingTask (TaskGroup* group)
+{
+#ifdef ENABLE_THREADING
+    //
+    // Only a worker can take tasks back from its own deque, which
+    // is where the tasks added by a running task go.  Other threads
+    // wait, and the workers pick up the group's tasks from their
+    // inboxes.
+    //
+
+    _data->pushers.fetch_add (1, std::memory_order_acquire);
+
+    WorkerSet* set  = _data->active.load (std::memory_order_acquire);
+    Task*      task = set ? set->takePending (group) : nullptr;
+
+    _data->pushers.fetch_sub (1, std::memory_order_release);
+
+    if (!task) return false;
+
+    runTask (task);
+    return true;
+#else
+    (void) group;
+    return false;
+#endif
+}
+
+//
+// class PriorityThreadPoolProvider
+//
+
+PriorityThreadPoolProvider::PriorityThreadPoolProvider (
+    int count, int fairnessInterval)
+    :
+#ifdef ENABLE_THREADING
+    _data (new Data (std::max (1, fairnessInterval)))
+#else
+    _data (nullptr)
+#endif
+{
+    setNumThreads (count);
+}
+
+PriorityThreadPoolProvider::~PriorityThreadPoolProvider ()
+{
+#ifdef ENABLE_THREADING
+    delete _data;
+#endif
+}
+
+int
+PriorityThreadPoolProvider::numThreads () const
+{
+#ifdef ENABLE_THREADING
+    std::lock_guard<std::mutex> lock (_data->threadMutex);
+    return static_cast<int> (_data->threads.size ());
+#else
+    return 0;
+#endif
+}
+
+void
+PriorityThreadPoolProvider::setNumThreads (int count)
+{
+#ifdef ENABLE_THREADING
+    std::lock_guard<std::mutex> lock (_data->threadMutex);
+
+    int current = static_cast<int> (_data->threads.size ());
+    if (count == current) return;
+
+    if (count < current)
+    {
+        //
+        // Finish all tasks, then start over with fewer threads
+        //
+
+        _data->stopThreads ();
+        current = 0;
+    }
+
+    _data->startThreads (count - current);
+#else
+    (void) count;
+#endif
+}
+
+void
+PriorityThreadPoolProvider::addTask (Task* task)
+{
+#ifdef ENABLE_THREADING
+    bool queued = false;
+
+    {
+        std::lock_guard<std::mutex> lock (_data->taskMutex);
+
+        if (_data->hasThreads)
+        {
+            _data->push (task);
+            queued = true;
+        }
+    }
+
+    if (queued)
+        _data->taskSemaphore.post ();
+    else
+        runTask (task);
+#else
+    task->execute ();
+    delete task;
+#endif
+}
+
+void
+PriorityThreadPoolProvider::addTasks (Task* const* tasks, int count)
+{
+#ifdef ENABLE_THREADING
+    bool queued = false;
+
+    {
+        std::lock_guard<std::mutex> lock (_data->taskMutex);
+
+        if (_data->hasThreads)
+        {
+            for (int i = 0; i < count; ++i)
+                _data->push (tasks[i]);
+
+            queued = true;
+        }
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (queued)
+            _data->taskSemaphore.post ();
+        else
+            runTask (tasks[i]);
+    }
+#else
+    for (int i = 0; i < count; ++i)
+        addTask (tasks[i]);
+#endif
+}
+
+void
+PriorityThreadPoolProvider::finish ()
+{
+#ifdef ENABLE_THREADING
+    std::lock_guard<std::mutex> lock (_data->threadMutex);
+    _data->stopThreads ();
+#endif
+}
+
+bool
+PriorityThreadPoolProvider::runPendingTask (TaskGroup* group)
+{
+#ifdef ENABLE_THREADING
+    Task* task = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock (_data->taskMutex);
+
+        auto i = _data->groups.find (group);
+        if (i != _data->groups.end ()) task = _data->popFrom (i->second);
+    }
+
+    if (!task) return false;
+
+    runTask (task);
+    return true;
+#else
+    (void) group;
+    return false;
+#endif
+}
+
 //
 // class ThreadPool
 //
@@ -663,7 +2199,11 @@ ThreadPool::setNumThreads (int count)
         {
             DefaultThreadPoolProvider* dpp =
                 dynamic_cast<DefaultThreadPoolProvider*> (sp.get ());
-            if (dpp) doReset = true;
+            WorkStealingThreadPoolProvider* wpp =
+                dynamic_cast<WorkStealingThreadPoolProvider*> (sp.get ());
+            PriorityThreadPoolProvider* ppp =
+                dynamic_cast<PriorityThreadPoolProvider*> (sp.get ());
+            if (dpp || wpp || ppp) doReset = true;
         }
         if (!doReset) sp->setNumThreads (count);
     }
@@ -696,7 +2236,11 @@ ThreadPool::setThreadProvider (ThreadPoolProvider* provider)
 void
 ThreadPool::addTask (Task* task)
 {
+    ILMTHREAD_PROBE (task__add, task);
 #ifdef ENABLE_THREADING
+    TaskGroup* group = task->group ();
+    if (group) group->_data->pool.store (this, std::memory_order_relaxed);
+
     _data->getProvider ()->addTask (task);
 #else
     task->execute ();
@@ -704,6 +2248,36 @@ ThreadPool::addTask (Task* task)
 #endif
 }
 
+void
+ThreadPool::addTasks (Task* const* tasks, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        ILMTHREAD_PROBE (task__add, tasks[i]);
+#ifdef ENABLE_THREADING
+        TaskGroup* group = tasks[i]->group ();
+        if (group) group->_data->pool.store (this, std::memory_order_relaxed);
+#else
+        tasks[i]->execute ();
+        delete tasks[i];
+#endif
+    }
+
+#ifdef ENABLE_THREADING
+    Data::SafeProvider           sp = _data->getProvider ();
+    ThreadPoolProviderExtension* ext =
+        dynamic_cast<ThreadPoolProviderExtension*> (sp.get ());
+
+    if (ext)
+        ext->addTasks (tasks, count);
+    else
+    {
+        for (int i = 0; i < count; ++i)
+            sp->addTask (tasks[i]);
+    }
+#endif
+}
+
 ThreadPool&
 ThreadPool::globalThreadPool ()
 {
@@ -722,6 +2296,12 @@ ThreadPool::addGlobalTask (Task* task)
     globalThreadPool ().addTask (task);
 }
 
+void
+ThreadPool::addGlobalTasks (Task* const* tasks, int count)
+{
+    globalThreadPool ().addTasks (tasks, count);
+}
+
 unsigned
 ThreadPool::estimateThreadCountForFileIO ()
 {
@@ -21,13 +21,20 @@
 //	Class TaskGroup allows synchronization on the completion of a set
 //	of tasks.  Every task that is added to a ThreadPool belongs to a
 //	single TaskGroup.  The destructor of the TaskGroup waits for all
-//	tasks in the group to finish.
+//	tasks in the group to finish.  While it waits, it runs tasks of
+//	the group that no worker thread has started yet, and so does
+//	TaskGroup::waitFor().
 //
 //	Note: if you plan to use the ThreadPool interface in your own
 //	applications note that the implementation of the ThreadPool calls
 //	operator delete on tasks as they complete.  If you define a custom
 //	operator new for your tasks, for instance to use a custom heap,
 //	then you must also write an appropriate operator delete.
+//	Class RecycledTask does this to reuse the memory of tasks
+//	that are created in large numbers.
+//
+//	Class TaskBatch collects tasks and adds them to a ThreadPool
+//	all at once.
 //
 //-----------------------------------------------------------------------------
 
@@ -35,10 +42,14 @@
 #include "IlmThreadExport.h"
 #include "IlmThreadNamespace.h"
 
+#include <cstddef>
+#include <vector>
+
 ILMTHREAD_INTERNAL_NAMESPACE_HEADER_ENTER
 
 class TaskGroup;
 class Task;
+class Semaphore;
 
 //-------------------------------------------------------
 // ThreadPoolProvider -- this is a pure virtual interface
@@ -70,6 +81,119 @@ public:
     ThreadPoolProvider& operator= (ThreadPoolProvider&&) = delete;
 };
 
+//-------------------------------------------------------
+// ThreadPoolProviderExtension -- an interface that a
+// ThreadPoolProvider can implement in addition to
+// ThreadPoolProvider, which keeps the layout it has
+// always had.  ThreadPool and TaskGroup look for it with
+// dynamic_cast.  A provider without it gets one addTask()
+// call per task, and the threads that wait on a TaskGroup
+// block rather than run the group's tasks.
+//-------------------------------------------------------
+class ILMTHREAD_EXPORT_TYPE ThreadPoolProviderExtension
+{
+public:
+    ILMTHREAD_EXPORT virtual ~ThreadPoolProviderExtension ();
+
+    // Remove one task of group that has been added but has
+    // not started yet, run it on the calling thread and return
+    // true; return false if there is no such task.  TaskGroup
+    // calls this while it waits for its tasks, so that a thread
+    // waiting on a group, including a worker running a task
+    // that reads a file, helps instead of blocking.
+    virtual bool runPendingTask (TaskGroup* group) = 0;
+
+    // as in ThreadPool below
+    virtual void addTasks (Task* const* tasks, int count) = 0;
+};
+
+//-------------------------------------------------------
+// WorkStealingThreadPoolProvider -- a ThreadPoolProvider
+// for many small tasks added from many threads at once,
+// for instance when several files are read concurrently.
+//
+// Every worker thread has its own queues, so adding a
+// task does not take a lock shared by all threads: tasks
+// added from outside the pool go to a worker's inbox, and
+// tasks added by a running task go to the front of that
+// worker's own deque.  A worker that runs out of tasks
+// steals from the other workers.  Tasks are not executed
+// in a strict FIFO order.
+//
+// A worker waiting on a TaskGroup runs the group's tasks
+// that are still in its own deque.  A thread outside the
+// pool, for instance one blocked in readPixels(), cannot
+// look for the group's tasks without taking the other
+// tasks out of the inboxes, so it does not help: it waits
+// while the workers run the tasks.
+//
+// To use it, hand one to ThreadPool::setThreadProvider():
+//
+//     ThreadPool::globalThreadPool ().setThreadProvider (
+//         new WorkStealingThreadPoolProvider (n));
+//-------------------------------------------------------
+class ILMTHREAD_EXPORT_TYPE WorkStealingThreadPoolProvider
+    : public ThreadPoolProvider
+    , public ThreadPoolProviderExtension
+{
+public:
+    ILMTHREAD_EXPORT WorkStealingThreadPoolProvider (int count);
+    ILMTHREAD_EXPORT virtual ~WorkStealingThreadPoolProvider ();
+
+    ILMTHREAD_EXPORT virtual int  numThreads () const;
+    ILMTHREAD_EXPORT virtual void setNumThreads (int count);
+    ILMTHREAD_EXPORT virtual void addTask (Task* task);
+    ILMTHREAD_EXPORT virtual void addTasks (Task* const* tasks, int count);
+
+    ILMTHREAD_EXPORT virtual void finish ();
+
+    ILMTHREAD_EXPORT virtual bool runPendingTask (TaskGroup* group);
+
+    struct ILMTHREAD_HIDDEN Data;
+
+private:
+    Data* _data;
+};
+
+//-------------------------------------------------------
+// PriorityThreadPoolProvider -- a ThreadPoolProvider that
+// schedules tasks by the priority and weight of their
+// TaskGroup (see TaskGroup::setPriority), for instance so
+// that the frame a viewer shows is read ahead of frames
+// that are prefetched in the background.
+//
+// Tasks of groups with a higher priority run first.
+// Groups with the same priority get a share of the
+// workers proportional to their weight, and each group's
+// tasks run in the order they were added.  So that lower
+// priority groups still make progress, one task in every
+// fairnessInterval is instead the one that has waited the
+// longest, whatever its priority.
+//-------------------------------------------------------
+class ILMTHREAD_EXPORT_TYPE PriorityThreadPoolProvider
+    : public ThreadPoolProvider
+    , public ThreadPoolProviderExtension
+{
+public:
+    ILMTHREAD_EXPORT
+    PriorityThreadPoolProvider (int count, int fairnessInterval = 8);
+    ILMTHREAD_EXPORT virtual ~PriorityThreadPoolProvider ();
+
+    ILMTHREAD_EXPORT virtual int  numThreads () const;
+    ILMTHREAD_EXPORT virtual void setNumThreads (int count);
+    ILMTHREAD_EXPORT virtual void addTask (Task* task);
+    ILMTHREAD_EXPORT virtual void addTasks (Task* const* tasks, int count);
+
+    ILMTHREAD_EXPORT virtual void finish ();
+
+    ILMTHREAD_EXPORT virtual bool runPendingTask (TaskGroup* group);
+
+    struct ILMTHREAD_HIDDEN Data;
+
+private:
+    Data* _data;
+};
+
 class ILMTHREAD_EXPORT_TYPE ThreadPool
 {
 public:
@@ -139,17 +263,28 @@ public:
 
     ILMTHREAD_EXPORT void addTask (Task* task);
 
+    //------------------------------------------------------------
+    // Add count tasks for processing, as if by calling addTask()
+    // for each of them in order.  The provider can queue them
+    // all with one lock instead of one lock per task.
+    //------------------------------------------------------------
+
+    ILMTHREAD_EXPORT void addTasks (Task* const* tasks, int count);
+
     //-------------------------------------------
     // Access functions for the global threadpool
     //-------------------------------------------
 
     ILMTHREAD_EXPORT static ThreadPool& globalThreadPool ();
     ILMTHREAD_EXPORT static void        addGlobalTask (Task* task);
+    ILMTHREAD_EXPORT static void addGlobalTasks (Task* const* tasks, int count);
 
     struct ILMTHREAD_HIDDEN Data;
 
 protected:
     Data* _data;
+
+    friend class TaskGroup;
 };
 
 class ILMTHREAD_EXPORT_TYPE Task
@@ -170,6 +305,30 @@ protected:
     TaskGroup* _group;
 };
 
+//-------------------------------------------------------
+// RecycledTask -- a Task whose memory is kept for the
+// next RecycledTask of a similar size when it is deleted,
+// instead of being returned to the heap.  Derive from it
+// instead of from Task for tasks that are created in
+// large numbers, such as one for every line buffer or
+// tile of a file.
+//
+// Every thread keeps a few free blocks of each size and
+// exchanges them in batches with a list shared by all
+// threads, so most tasks are created and deleted without
+// taking a lock.  Tasks larger than 1024 bytes use the
+// heap.
+//-------------------------------------------------------
+class ILMTHREAD_EXPORT_TYPE RecycledTask : public Task
+{
+public:
+    ILMTHREAD_EXPORT RecycledTask (TaskGroup* g);
+    ILMTHREAD_EXPORT virtual ~RecycledTask ();
+
+    ILMTHREAD_EXPORT static void* operator new (size_t size);
+    ILMTHREAD_EXPORT static void  operator delete (void* ptr, size_t size);
+};
+
 class ILMTHREAD_EXPORT_TYPE TaskGroup
 {
 public:
@@ -186,8 +345,102 @@ public:
     // as it finishes tasks
     ILMTHREAD_EXPORT void finishOneTask ();
 
+    // waits until sem can be decremented, like sem.wait (),
+    // but runs tasks of this group that have not started yet
+    // on the calling thread in the meantime; use it to wait
+    // for a semaphore that one of the group's tasks posts
+    ILMTHREAD_EXPORT void waitFor (Semaphore& sem);
+
+    // the priority and fairness weight of the group's tasks,
+    // used by providers that support them, such as
+    // PriorityThreadPoolProvider; higher priorities run first.
+    // A new group gets the values of the calling thread's
+    // innermost TaskPriorityScope, or priority 0 and weight 1;
+    // the tasks run by the pool count as a scope with the values
+    // of their own group. Set them before adding tasks to the
+    // group.
+    ILMTHREAD_EXPORT void setPriority (int priority, int weight = 1);
+    ILMTHREAD_EXPORT int  priority () const;
+    ILMTHREAD_EXPORT int  weight () const;
+
     struct ILMTHREAD_HIDDEN Data;
     Data* const             _data;
+
+private:
+    bool runPendingTask ();
+};
+
+//-------------------------------------------------------
+// TaskPriorityScope -- while one exists, the TaskGroups
+// created by the thread that created it get its priority
+// and weight.  Use it to set the priority of the tasks of
+// the files read or written by that thread:
+//
+//     {
+//         TaskPriorityScope foreground (10);
+//         file.readPixels (y1, y2);
+//     }
+//-------------------------------------------------------
+class ILMTHREAD_EXPORT_TYPE TaskPriorityScope
+{
+public:
+    ILMTHREAD_EXPORT TaskPriorityScope (int priority, int weight = 1);
+    ILMTHREAD_EXPORT ~TaskPriorityScope ();
+
+    TaskPriorityScope (const TaskPriorityScope&)            = delete;
+    TaskPriorityScope& operator= (const TaskPriorityScope&) = delete;
+    TaskPriorityScope (TaskPriorityScope&&)                 = delete;
+    TaskPriorityScope& operator= (TaskPriorityScope&&)      = delete;
+
+private:
+    int _oldPriority;
+    int _oldWeight;
+};
+
+//-------------------------------------------------------
+// TaskBatch -- collects tasks and adds them to a pool
+// with ThreadPool::addTasks() when flush() is called,
+// when maxSize tasks have been collected, and when the
+// batch is destroyed, also by an exception.
+//
+// A task is not started before its batch is flushed, so
+// if creating a task waits for an earlier one to finish,
+// for instance to reuse its line buffer, maxSize must
+// not be larger than the number of buffers.
+//-------------------------------------------------------
+class TaskBatch
+{
+public:
+    TaskBatch (ThreadPool& pool, size_t maxSize)
+        : _pool (pool), _maxSize (maxSize > 0 ? maxSize : 1)
+    {
+        _tasks.reserve (_maxSize);
+    }
+
+    ~TaskBatch () { flush (); }
+
+    TaskBatch (const TaskBatch&)            = delete;
+    TaskBatch& operator= (const TaskBatch&) = delete;
+    TaskBatch (TaskBatch&&)                 = delete;
+    TaskBatch& operator= (TaskBatch&&)      = delete;
+
+    void add (Task* task)
+    {
+        _tasks.push_back (task);
+        if (_tasks.size () >= _maxSize) flush ();
+    }
+
+    void flush ()
+    {
+        if (_tasks.empty ()) return;
+        _pool.addTasks (_tasks.data (), static_cast<int> (_tasks.size ()));
+        _tasks.clear ();
+    }
+
+private:
+    ThreadPool&        _pool;
+    size_t             _maxSize;
+    std::vector<Task*> _tasks;
 };
 
 ILMTHREAD_INTERNAL_NAMESPACE_HEADER_EXIT
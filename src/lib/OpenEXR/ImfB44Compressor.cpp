@@ -73,6 +73,8 @@
 #include "ImfHeader.h"
 #include "ImfMisc.h"
 #include "ImfNamespace.h"
+#include "ImfProbe.h"
+#include "ImfSimd.h"
 #include <Iex.h>
 #include <ImathBox.h>
 #include <ImathFun.h>
@@ -407,6 +409,617 @@ tooMuchData ()
                                    "(input data are longer than expected).");
 }
 
+#ifdef IMF_HAVE_SSE2
+
+//
+// The vector code processes 8 blocks side by side: the 16 pixels of
+// the blocks are held in 16 vectors, with lane j of vector i being
+// s[i] of block j, so that the arithmetic in pack() and unpack14()
+// is done for 8 blocks at once. Only the (variable length) input or
+// output of each block, and the log / exp table lookups, which have
+// no gather instruction in SSE2, are done a block or a value at a
+// time. The results are bit exact with the scalar code.
+//
+
+const int SIMD_BLOCKS = 8;
+
+//
+// 4 values from each of 8 blocks in a row to s[0] ... s[3].
+//
+
+inline void
+loadRowSse2 (const unsigned short* p, __m128i* s)
+{
+    __m128i v0 = _mm_loadu_si128 ((const __m128i*) p);
+    __m128i v1 = _mm_loadu_si128 ((const __m128i*) (p + 8));
+    __m128i v2 = _mm_loadu_si128 ((const __m128i*) (p + 16));
+    __m128i v3 = _mm_loadu_si128 ((const __m128i*) (p + 24));
+    __m128i a0 = _mm_unpacklo_epi16 (v0, v1);
+    __m128i a1 = _mm_unpackhi_epi16 (v0, v1);
+    __m128i a2 = _mm_unpacklo_epi16 (v2, v3);
+    __m128i a3 = _mm_unpackhi_epi16 (v2, v3);
+    __m128i b0 = _mm_unpacklo_epi16 (a0, a1);
+    __m128i b1 = _mm_unpackhi_epi16 (a0, a1);
+    __m128i b2 = _mm_unpacklo_epi16 (a2, a3);
+    __m128i b3 = _mm_unpackhi_epi16 (a2, a3);
+
+    s[0] = _mm_unpacklo_epi64 (b0, b2);
+    s[1] = _mm_unpackhi_epi64 (b0, b2);
+    s[2] = _mm_unpacklo_epi64 (b1, b3);
+    s[3] = _mm_unpackhi_epi64 (b1, b3);
+}
+
+//
+// Inverse of loadRowSse2().
+//
+
+inline void
+storeRowSse2 (unsigned short* p, const __m128i* s)
+{
+    __m128i a0 = _mm_unpacklo_epi16 (s[0], s[1]);
+    __m128i a1 = _mm_unpacklo_epi16 (s[2], s[3]);
+    __m128i a2 = _mm_unpackhi_epi16 (s[0], s[1]);
+    __m128i a3 = _mm_unpackhi_epi16 (s[2], s[3]);
+
+    _mm_storeu_si128 ((__m128i*) p, _mm_unpacklo_epi32 (a0, a1));
+    _mm_storeu_si128 ((__m128i*) (p + 8), _mm_unpackhi_epi32 (a0, a1));
+    _mm_storeu_si128 ((__m128i*) (p + 16), _mm_unpacklo_epi32 (a2, a3));
+    _mm_storeu_si128 ((__m128i*) (p + 24), _mm_unpackhi_epi32 (a2, a3));
+}
+
+//
+// Lane j of w[k] holds bytes 2k and 2k+1 of block j;
+// returns the bytes of block j in o[j].
+//
+
+inline void
+transpose8Sse2 (const __m128i* w, __m128i* o)
+{
+    __m128i a0 = _mm_unpacklo_epi16 (w[0], w[1]);
+    __m128i a1 = _mm_unpackhi_epi16 (w[0], w[1]);
+    __m128i a2 = _mm_unpacklo_epi16 (w[2], w[3]);
+    __m128i a3 = _mm_unpackhi_epi16 (w[2], w[3]);
+    __m128i a4 = _mm_unpacklo_epi16 (w[4], w[5]);
+    __m128i a5 = _mm_unpackhi_epi16 (w[4], w[5]);
+    __m128i a6 = _mm_unpacklo_epi16 (w[6], w[7]);
+    __m128i a7 = _mm_unpackhi_epi16 (w[6], w[7]);
+    __m128i b0 = _mm_unpacklo_epi32 (a0, a2);
+    __m128i b1 = _mm_unpackhi_epi32 (a0, a2);
+    __m128i b2 = _mm_unpacklo_epi32 (a1, a3);
+    __m128i b3 = _mm_unpackhi_epi32 (a1, a3);
+    __m128i b4 = _mm_unpacklo_epi32 (a4, a6);
+    __m128i b5 = _mm_unpackhi_epi32 (a4, a6);
+    __m128i b6 = _mm_unpacklo_epi32 (a5, a7);
+    __m128i b7 = _mm_unpackhi_epi32 (a5, a7);
+
+    o[0] = _mm_unpacklo_epi64 (b0, b4);
+    o[1] = _mm_unpackhi_epi64 (b0, b4);
+    o[2] = _mm_unpacklo_epi64 (b1, b5);
+    o[3] = _mm_unpackhi_epi64 (b1, b5);
+    o[4] = _mm_unpacklo_epi64 (b2, b6);
+    o[5] = _mm_unpackhi_epi64 (b2, b6);
+    o[6] = _mm_unpacklo_epi64 (b3, b7);
+    o[7] = _mm_unpackhi_epi64 (b3, b7);
+}
+
+inline __m128i
+selectSse2 (__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128 (_mm_and_si128 (mask, a), _mm_andnot_si128 (mask, b));
+}
+
+//
+// ((hi << lshift) | (lo >> rshift)) & mask
+//
+
+inline __m128i
+fieldSse2 (__m128i hi, int lshift, __m128i lo, int rshift, __m128i mask)
+{
+    return _mm_and_si128 (
+        _mm_or_si128 (_mm_slli_epi16 (hi, lshift), _mm_srli_epi16 (lo, rshift)),
+        mask);
+}
+
+//
+// Pack 8 blocks, as pack() does each; returns the number of bytes
+// written to b.
+//
+
+int
+pack8Sse2 (
+    const unsigned short* const rows[4],
+    unsigned char*              b,
+    bool                        optFlatFields,
+    bool                        pLinear)
+{
+    const __m128i  zero  = _mm_setzero_si128 ();
+    const __m128i  one   = _mm_set1_epi16 (1);
+    const __m128i  sign  = _mm_set1_epi16 ((short) 0x8000);
+    const __m128i  exp   = _mm_set1_epi16 (0x7c00);
+    const __m128i  bias  = _mm_set1_epi16 (0x20);
+    const __m128i  range = _mm_set1_epi16 ((short) 0xffc0);
+    const __m128i  mask8 = _mm_set1_epi16 (0xff);
+    __m128i        t[16], x[16], d[16], r[15], rs[15], w[8], o[8];
+    unsigned short lin[4][4 * SIMD_BLOCKS];
+    unsigned char  blk[SIMD_BLOCKS][16];
+    unsigned char* start = b;
+
+    if (pLinear)
+    {
+        for (int y = 0; y < 4; ++y)
+        {
+            for (int i = 0; i < 4 * SIMD_BLOCKS; ++i)
+                lin[y][i] = expTable[rows[y][i]];
+
+            loadRowSse2 (lin[y], t + 4 * y);
+        }
+    }
+    else
+    {
+        for (int y = 0; y < 4; ++y)
+            loadRowSse2 (rows[y], t + 4 * y);
+    }
+
+    //
+    // Convert s[i] into t[i] and find tMax, as in pack(). SSE2 has
+    // no unsigned 16-bit max, so the sign bit is flipped to use the
+    // signed one.
+    //
+
+    __m128i tMax = sign;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        __m128i s      = t[i];
+        __m128i infNan = _mm_cmpeq_epi16 (_mm_and_si128 (s, exp), exp);
+
+        s    = _mm_xor_si128 (s, _mm_or_si128 (_mm_srai_epi16 (s, 15), sign));
+        t[i] = selectSse2 (infNan, sign, s);
+        tMax = _mm_max_epi16 (tMax, _mm_xor_si128 (t[i], sign));
+    }
+
+    tMax = _mm_xor_si128 (tMax, sign);
+
+    for (int i = 0; i < 16; ++i)
+        x[i] = _mm_sub_epi16 (tMax, t[i]);
+
+    //
+    // Search for the shift of all 8 blocks together, and record the
+    // differences of each block at the first shift where they fit.
+    // All blocks fit by a shift of 11, as the absolute differences
+    // are at most 0xf7ff. The running differences are computed
+    // modulo 2^16, and as they are between -0xf7ff and 0xf7ff, an
+    // out of range difference can't alias one in range.
+    //
+
+    __m128i done   = zero;
+    __m128i d0     = zero;
+    __m128i shifts = zero;
+    __m128i muls   = zero;
+
+    for (int i = 0; i < 15; ++i)
+        rs[i] = zero;
+
+    for (int shift = 0;; ++shift)
+    {
+        if (shift == 0)
+        {
+            for (int i = 0; i < 16; ++i)
+                d[i] = x[i];
+        }
+        else
+        {
+            //
+            // shiftAndRound(), rearranged to fit in 16 bits:
+            //
+            //     (x + 2^(shift-1) - 1 + ((x >> shift) & 1)) >> shift
+            //
+
+            __m128i cnt  = _mm_cvtsi32_si128 (shift);
+            __m128i mask = _mm_set1_epi16 ((short) ((1 << shift) - 1));
+            __m128i half = _mm_set1_epi16 ((short) ((1 << (shift - 1)) - 1));
+
+            for (int i = 0; i < 16; ++i)
+            {
+                __m128i q   = _mm_srl_epi16 (x[i], cnt);
+                __m128i rem = _mm_add_epi16 (
+                    _mm_add_epi16 (_mm_and_si128 (x[i], mask), half),
+                    _mm_and_si128 (q, one));
+
+                d[i] = _mm_add_epi16 (q, _mm_srl_epi16 (rem, cnt));
+            }
+        }
+
+        r[0] = _mm_add_epi16 (_mm_sub_epi16 (d[0], d[4]), bias);
+        r[1] = _mm_add_epi16 (_mm_sub_epi16 (d[4], d[8]), bias);
+        r[2] = _mm_add_epi16 (_mm_sub_epi16 (d[8], d[12]), bias);
+
+        r[3] = _mm_add_epi16 (_mm_sub_epi16 (d[0], d[1]), bias);
+        r[4] = _mm_add_epi16 (_mm_sub_epi16 (d[4], d[5]), bias);
+        r[5] = _mm_add_epi16 (_mm_sub_epi16 (d[8], d[9]), bias);
+        r[6] = _mm_add_epi16 (_mm_sub_epi16 (d[12], d[13]), bias);
+
+        r[7]  = _mm_add_epi16 (_mm_sub_epi16 (d[1], d[2]), bias);
+        r[8]  = _mm_add_epi16 (_mm_sub_epi16 (d[5], d[6]), bias);
+        r[9]  = _mm_add_epi16 (_mm_sub_epi16 (d[9], d[10]), bias);
+        r[10] = _mm_add_epi16 (_mm_sub_epi16 (d[13], d[14]), bias);
+
+        r[11] = _mm_add_epi16 (_mm_sub_epi16 (d[2], d[3]), bias);
+        r[12] = _mm_add_epi16 (_mm_sub_epi16 (d[6], d[7]), bias);
+        r[13] = _mm_add_epi16 (_mm_sub_epi16 (d[10], d[11]), bias);
+        r[14] = _mm_add_epi16 (_mm_sub_epi16 (d[14], d[15]), bias);
+
+        __m128i ok = r[0];
+
+        for (int i = 1; i < 15; ++i)
+            ok = _mm_or_si128 (ok, r[i]);
+
+        ok = _mm_cmpeq_epi16 (_mm_and_si128 (ok, range), zero);
+
+        __m128i fits = _mm_andnot_si128 (done, ok);
+
+        if (_mm_movemask_epi8 (fits))
+        {
+            for (int i = 0; i < 15; ++i)
+                rs[i] = selectSse2 (fits, r[i], rs[i]);
+
+            d0     = selectSse2 (fits, d[0], d0);
+            shifts = selectSse2 (fits, _mm_set1_epi16 ((short) shift), shifts);
+            muls   = selectSse2 (
+                fits, _mm_set1_epi16 ((short) (1 << shift)), muls);
+            done = _mm_or_si128 (done, fits);
+        }
+
+        if (_mm_movemask_epi8 (done) == 0xffff) break;
+    }
+
+    //
+    // Flat blocks keep the original t[0], the others may adjust it,
+    // as in pack().
+    //
+
+    __m128i flat = zero;
+
+    if (optFlatFields)
+    {
+        flat = _mm_cmpeq_epi16 (rs[0], bias);
+
+        for (int i = 1; i < 15; ++i)
+            flat = _mm_and_si128 (flat, _mm_cmpeq_epi16 (rs[i], bias));
+    }
+
+    __m128i t0 = t[0];
+
+    if (!pLinear)
+    {
+        t0 = selectSse2 (
+            flat, t0, _mm_sub_epi16 (tMax, _mm_mullo_epi16 (d0, muls)));
+    }
+
+    //
+    // Pack into bytes, two per 16-bit lane, then transpose so each
+    // vector holds the (up to) 14 bytes of one block.
+    //
+
+    w[0] = _mm_or_si128 (_mm_srli_epi16 (t0, 8), _mm_slli_epi16 (t0, 8));
+
+    w[1] = _mm_or_si128 (
+        selectSse2 (
+            flat,
+            _mm_set1_epi16 (0xfc),
+            _mm_or_si128 (
+                _mm_slli_epi16 (shifts, 2), _mm_srli_epi16 (rs[0], 4))),
+        _mm_slli_epi16 (fieldSse2 (rs[0], 4, rs[1], 2, mask8), 8));
+
+    w[2] = _mm_or_si128 (
+        fieldSse2 (rs[1], 6, rs[2], 0, mask8),
+        _mm_slli_epi16 (fieldSse2 (rs[3], 2, rs[4], 4, mask8), 8));
+
+    w[3] = _mm_or_si128 (
+        fieldSse2 (rs[4], 4, rs[5], 2, mask8),
+        _mm_slli_epi16 (fieldSse2 (rs[5], 6, rs[6], 0, mask8), 8));
+
+    w[4] = _mm_or_si128 (
+        fieldSse2 (rs[7], 2, rs[8], 4, mask8),
+        _mm_slli_epi16 (fieldSse2 (rs[8], 4, rs[9], 2, mask8), 8));
+
+    w[5] = _mm_or_si128 (
+        fieldSse2 (rs[9], 6, rs[10], 0, mask8),
+        _mm_slli_epi16 (fieldSse2 (rs[11], 2, rs[12], 4, mask8), 8));
+
+    w[6] = _mm_or_si128 (
+        fieldSse2 (rs[12], 4, rs[13], 2, mask8),
+        _mm_slli_epi16 (fieldSse2 (rs[13], 6, rs[14], 0, mask8), 8));
+
+    w[7] = zero;
+
+    transpose8Sse2 (w, o);
+
+    int flatMask = _mm_movemask_epi8 (flat);
+
+    for (int j = 0; j < SIMD_BLOCKS; ++j)
+    {
+        int n = (flatMask & (1 << (2 * j))) ? 3 : 14;
+
+        _mm_storeu_si128 ((__m128i*) blk[j], o[j]);
+        memcpy (b, blk[j], n);
+        b += n;
+    }
+
+    return static_cast<int> (b - start);
+}
+
+//
+// Unpack 8 blocks, as unpack14() and unpack3() do each, into the
+// rows; returns the number of bytes read from b, or 0 if there
+// are fewer than needed in inSize.
+//
+
+int
+unpack8Sse2 (
+    const unsigned char* b,
+    int                  inSize,
+    unsigned short* const rows[4],
+    bool                 pLinear)
+{
+    //
+    // Flat (3-byte) blocks are expanded to the equivalent 14-byte
+    // block, with a shift of 0 and all differences 0, so they take
+    // the same path. Bytes 14 and 15 of each block hold 1 << shift.
+    //
+
+    static const unsigned char flatBlock[14] = {
+        0x02, 0x08, 0x20, 0x82, 0x08, 0x20, 0x82,
+        0x08, 0x20, 0x82, 0x08, 0x20, 0x00, 0x01};
+
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128i m6   = _mm_set1_epi16 (0x3f);
+    unsigned char blk[SIMD_BLOCKS][16];
+    __m128i       a[8], c[8], e[8], bt[16], s[16];
+    int           n = 0;
+
+    for (int j = 0; j < SIMD_BLOCKS; ++j)
+    {
+        const unsigned char* in = b + n;
+
+        if (inSize - n < 3) return 0;
+
+        blk[j][0] = in[0];
+        blk[j][1] = in[1];
+
+        if (in[2] >= (13 << 2))
+        {
+            memcpy (blk[j] + 2, flatBlock, sizeof (flatBlock));
+            n += 3;
+        }
+        else
+        {
+            if (inSize - n < 14) return 0;
+
+            unsigned int m = 1u << (in[2] >> 2);
+
+            memcpy (blk[j] + 2, in + 2, 12);
+            blk[j][14] = (unsigned char) (m >> 8);
+            blk[j][15] = (unsigned char) m;
+            n += 14;
+        }
+    }
+
+    //
+    // Transpose the 8 x 16 bytes so bt[k] holds byte k of each block.
+    //
+
+    for (int j = 0; j < 8; j += 2)
+    {
+        __m128i r0 = _mm_loadu_si128 ((const __m128i*) blk[j]);
+        __m128i r1 = _mm_loadu_si128 ((const __m128i*) blk[j + 1]);
+
+        a[j]     = _mm_unpacklo_epi8 (r0, r1);
+        a[j + 1] = _mm_unpackhi_epi8 (r0, r1);
+    }
+
+    for (int j = 0; j < 8; j += 4)
+    {
+        c[j]     = _mm_unpacklo_epi16 (a[j], a[j + 2]);
+        c[j + 1] = _mm_unpackhi_epi16 (a[j], a[j + 2]);
+        c[j + 2] = _mm_unpacklo_epi16 (a[j + 1], a[j + 3]);
+        c[j + 3] = _mm_unpackhi_epi16 (a[j + 1], a[j + 3]);
+    }
+
+    for (int j = 0; j < 4; ++j)
+    {
+        e[2 * j]     = _mm_unpacklo_epi32 (c[j], c[j + 4]);
+        e[2 * j + 1] = _mm_unpackhi_epi32 (c[j], c[j + 4]);
+    }
+
+    for (int j = 0; j < 8; ++j)
+    {
+        bt[2 * j]     = _mm_unpacklo_epi8 (e[j], zero);
+        bt[2 * j + 1] = _mm_unpackhi_epi8 (e[j], zero);
+    }
+
+    __m128i mul  = _mm_or_si128 (_mm_slli_epi16 (bt[14], 8), bt[15]);
+    __m128i bias = _mm_slli_epi16 (mul, 5);
+
+    //
+    // The 6-bit differences, indexed like s, then shifted by
+    // multiplying with 1 << shift, as SSE2 has no per lane shifts.
+    //
+
+    __m128i f[16];
+
+    f[4]  = fieldSse2 (bt[2], 4, bt[3], 4, m6);
+    f[8]  = fieldSse2 (bt[3], 2, bt[4], 6, m6);
+    f[12] = _mm_and_si128 (bt[4], m6);
+
+    f[1]  = _mm_srli_epi16 (bt[5], 2);
+    f[5]  = fieldSse2 (bt[5], 4, bt[6], 4, m6);
+    f[9]  = fieldSse2 (bt[6], 2, bt[7], 6, m6);
+    f[13] = _mm_and_si128 (bt[7], m6);
+
+    f[2]  = _mm_srli_epi16 (bt[8], 2);
+    f[6]  = fieldSse2 (bt[8], 4, bt[9], 4, m6);
+    f[10] = fieldSse2 (bt[9], 2, bt[10], 6, m6);
+    f[14] = _mm_and_si128 (bt[10], m6);
+
+    f[3]  = _mm_srli_epi16 (bt[11], 2);
+    f[7]  = fieldSse2 (bt[11], 4, bt[12], 4, m6);
+    f[11] = fieldSse2 (bt[12], 2, bt[13], 6, m6);
+    f[15] = _mm_and_si128 (bt[13], m6);
+
+    for (int i = 1; i < 16; ++i)
+        f[i] = _mm_sub_epi16 (_mm_mullo_epi16 (f[i], mul), bias);
+
+    //
+    // Accumulate as in unpack14(): down the first column, then
+    // along the rows.
+    //
+
+    s[0]  = _mm_or_si128 (_mm_slli_epi16 (bt[0], 8), bt[1]);
+    s[4]  = _mm_add_epi16 (s[0], f[4]);
+    s[8]  = _mm_add_epi16 (s[4], f[8]);
+    s[12] = _mm_add_epi16 (s[8], f[12]);
+
+    for (int i = 1; i < 4; ++i)
+    {
+        s[i]      = _mm_add_epi16 (s[i - 1], f[i]);
+        s[i + 4]  = _mm_add_epi16 (s[i + 3], f[i + 4]);
+        s[i + 8]  = _mm_add_epi16 (s[i + 7], f[i + 8]);
+        s[i + 12] = _mm_add_epi16 (s[i + 11], f[i + 12]);
+    }
+
+    //
+    // if (s & 0x8000) s &= 0x7fff; else s = ~s;
+    //
+
+    for (int i = 0; i < 16; ++i)
+    {
+        __m128i pos = _mm_cmpgt_epi16 (s[i], _mm_set1_epi16 (-1));
+
+        s[i] = _mm_xor_si128 (
+            s[i], _mm_or_si128 (pos, _mm_set1_epi16 ((short) 0x8000)));
+    }
+
+    for (int y = 0; y < 4; ++y)
+    {
+        storeRowSse2 (rows[y], s + 4 * y);
+
+        if (pLinear)
+        {
+            for (int i = 0; i < 4 * SIMD_BLOCKS; ++i)
+                rows[y][i] = logTable[rows[y][i]];
+        }
+    }
+
+    return n;
+}
+
+#endif // IMF_HAVE_SSE2
+
+//
+// Pack a horizontal run of n complete blocks, the rows of which
+// start at rows[0] ... rows[3]; returns the number of bytes written.
+//
+
+int
+packBlocks (
+    const unsigned short* const rows[4],
+    int                         n,
+    unsigned char*              b,
+    bool                        optFlatFields,
+    bool                        pLinear)
+{
+    unsigned char* start = b;
+    int            i     = 0;
+
+#ifdef IMF_HAVE_SSE2
+    for (; i + SIMD_BLOCKS <= n; i += SIMD_BLOCKS)
+    {
+        const unsigned short* cur[4] = {
+            rows[0] + 4 * i, rows[1] + 4 * i, rows[2] + 4 * i, rows[3] + 4 * i};
+
+        b += pack8Sse2 (cur, b, optFlatFields, pLinear);
+    }
+#endif
+
+    for (; i < n; ++i)
+    {
+        unsigned short s[16];
+
+        memcpy (&s[0], rows[0] + 4 * i, 4 * sizeof (unsigned short));
+        memcpy (&s[4], rows[1] + 4 * i, 4 * sizeof (unsigned short));
+        memcpy (&s[8], rows[2] + 4 * i, 4 * sizeof (unsigned short));
+        memcpy (&s[12], rows[3] + 4 * i, 4 * sizeof (unsigned short));
+
+        if (pLinear) convertFromLinear (s);
+
+        b += pack (s, b, optFlatFields, !pLinear);
+    }
+
+    return static_cast<int> (b - start);
+}
+
+//
+// Unpack a horizontal run of n complete blocks into the rows,
+// advancing inPtr and decrementing inSize.
+//
+
+void
+unpackBlocks (
+    const char*&          inPtr,
+    int&                  inSize,
+    int                   n,
+    unsigned short* const rows[4],
+    bool                  pLinear)
+{
+    int i = 0;
+
+#ifdef IMF_HAVE_SSE2
+    for (; i + SIMD_BLOCKS <= n; i += SIMD_BLOCKS)
+    {
+        unsigned short* cur[4] = {
+            rows[0] + 4 * i, rows[1] + 4 * i, rows[2] + 4 * i, rows[3] + 4 * i};
+
+        int used = unpack8Sse2 (
+            (const unsigned char*) inPtr, inSize, cur, pLinear);
+
+        if (used == 0) notEnoughData ();
+
+        inPtr += used;
+        inSize -= used;
+    }
+#endif
+
+    for (; i < n; ++i)
+    {
+        unsigned short s[16];
+
+        if (inSize < 3) notEnoughData ();
+
+        if (((const unsigned char*) inPtr)[2] >= (13 << 2))
+        {
+            unpack3 ((const unsigned char*) inPtr, s);
+            inPtr += 3;
+            inSize -= 3;
+        }
+        else
+        {
+            if (inSize < 14) notEnoughData ();
+
+            unpack14 ((const unsigned char*) inPtr, s);
+            inPtr += 14;
+            inSize -= 14;
+        }
+
+        if (pLinear) convertToLinear (s);
+
+        memcpy (rows[0] + 4 * i, &s[0], 4 * sizeof (unsigned short));
+        memcpy (rows[1] + 4 * i, &s[4], 4 * sizeof (unsigned short));
+        memcpy (rows[2] + 4 * i, &s[8], 4 * sizeof (unsigned short));
+        memcpy (rows[3] + 4 * i, &s[12], 4 * sizeof (unsigned short));
+    }
+}
+
 } // namespace
 
 struct B44Compressor::ChannelData
@@ -567,6 +1180,12 @@ B44Compressor::compress (
     IMATH_NAMESPACE::Box2i range,
     const char*&           outPtr)
 {
+    IMF_PROBE_SCOPE (
+        compressor_compress,
+        _optFlatFields ? B44A_COMPRESSION : B44_COMPRESSION,
+        inSize,
+        range.min.y);
+
     //
     // Compress a block of pixel data:  First copy the input pixels
     // from the input buffer into _tmpBuffer, rearranging them such
@@ -729,7 +1348,7 @@ B44Compressor::compress (
         for (int y = 0; y < cd.ny; y += 4)
         {
             //
-            // Copy the next 4x4 pixel block into array s.
+            // Compress the next row of 4x4 pixel blocks.
             // If the width, cd.nx, or the height, cd.ny, of
             // the pixel data in _tmpBuffer is not divisible
             // by 4, then pad the data by repeating the
@@ -750,41 +1369,36 @@ B44Compressor::compress (
                 row3 = row2;
             }
 
-            for (int x = 0; x < cd.nx; x += 4)
+            //
+            // Compress the complete blocks, then the padded last
+            // one, and append the results to the output buffer.
+            //
+
+            const unsigned short* rows[4] = {row0, row1, row2, row3};
+
+            outEnd += packBlocks (
+                rows,
+                cd.nx / 4,
+                (unsigned char*) outEnd,
+                _optFlatFields,
+                cd.pLinear);
+
+            if (cd.nx % 4)
             {
                 unsigned short s[16];
 
-                if (x + 3 >= cd.nx)
-                {
-                    int n = cd.nx - x;
-
-                    for (int i = 0; i < 4; ++i)
-                    {
-                        int j = min (i, n - 1);
+                int x = cd.nx - cd.nx % 4;
+                int n = cd.nx - x;
 
-                        s[i + 0]  = row0[j];
-                        s[i + 4]  = row1[j];
-                        s[i + 8]  = row2[j];
-                        s[i + 12] = row3[j];
-                    }
-                }
-                else
+                for (int i = 0; i < 4; ++i)
                 {
-                    memcpy (&s[0], row0, 4 * sizeof (unsigned short));
-                    memcpy (&s[4], row1, 4 * sizeof (unsigned short));
-                    memcpy (&s[8], row2, 4 * sizeof (unsigned short));
-                    memcpy (&s[12], row3, 4 * sizeof (unsigned short));
-                }
+                    int j = x + min (i, n - 1);
 
-                row0 += 4;
-                row1 += 4;
-                row2 += 4;
-                row3 += 4;
-
-                //
-                // Compress the contents of array s and append the
-                // results to the output buffer.
-                //
+                    s[i + 0]  = row0[j];
+                    s[i + 4]  = row1[j];
+                    s[i + 8]  = row2[j];
+                    s[i + 12] = row3[j];
+                }
 
                 if (cd.pLinear) convertFromLinear (s);
 
@@ -804,6 +1418,12 @@ B44Compressor::uncompress (
     IMATH_NAMESPACE::Box2i range,
     const char*&           outPtr)
 {
+    IMF_PROBE_SCOPE (
+        compressor_uncompress,
+        _optFlatFields ? B44A_COMPRESSION : B44_COMPRESSION,
+        inSize,
+        range.min.y);
+
     //
     // This function is the reverse of the compress() function,
     // above.  First all pixels are moved from the input buffer
@@ -873,7 +1493,26 @@ B44Compressor::uncompress (
             unsigned short* row2 = row1 + cd.nx;
             unsigned short* row3 = row2 + cd.nx;
 
-            for (int x = 0; x < cd.nx; x += 4)
+            //
+            // Uncompress complete blocks directly into the rows,
+            // and the ones on the right or bottom edge via s.
+            //
+
+            int nFull = (y + 3 < cd.ny) ? cd.nx / 4 : 0;
+
+            if (nFull > 0)
+            {
+                unsigned short* const rows[4] = {row0, row1, row2, row3};
+
+                unpackBlocks (inPtr, inSize, nFull, rows, cd.pLinear);
+
+                row0 += 4 * nFull;
+                row1 += 4 * nFull;
+                row2 += 4 * nFull;
+                row3 += 4 * nFull;
+            }
+
+            for (int x = 4 * nFull; x < cd.nx; x += 4)
             {
                 unsigned short s[16];
 
@@ -18,7 +18,9 @@
 #include <vector>
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
+using ILMTHREAD_NAMESPACE::RecycledTask;
 using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskBatch;
 using ILMTHREAD_NAMESPACE::TaskGroup;
 using ILMTHREAD_NAMESPACE::ThreadPool;
 using IMATH_NAMESPACE::Box2i;
@@ -297,7 +299,7 @@ CompositeDeepScanLine::setFrameBuffer (const FrameBuffer& fr)
 namespace
 {
 
-class LineCompositeTask : public Task
+class LineCompositeTask : public RecycledTask
 {
 public:
     LineCompositeTask (
@@ -309,7 +311,7 @@ public:
         vector<vector<vector<float*>>>* pointers,
         vector<unsigned int>*           total_sizes,
         vector<unsigned int>*           num_sources)
-        : Task (group)
+        : RecycledTask (group)
         , _Data (data)
         , _y (y)
         , _start (start)
@@ -605,9 +607,11 @@ CompositeDeepScanLine::readPixels (int start, int end)
         names[1] = names[0]; // no zback channel, so make it point to z
 
     TaskGroup g;
+    TaskBatch batch (
+        ThreadPool::globalThreadPool (), end >= start ? end - start + 1 : 1);
     for (int y = start; y <= end; y++)
     {
-        ThreadPool::addGlobalTask (new LineCompositeTask (
+        batch.add (new LineCompositeTask (
             &g,
             _Data,
             y,
@@ -45,6 +45,16 @@ enum IMF_EXPORT_ENUM Compression
                           // wise and faster to decode full frames
                           // than DWAA_COMPRESSION.
 
+    ZSTD_COMPRESSION = 10, // zstd compression, in blocks of 32 scan
+                           // lines. Same pre-pass as zip, much faster
+                           // to decode. Optional, see
+                           // isSupportedCompression().
+
+    LZ4_COMPRESSION = 11, // lz4 compression, in blocks of 16 scan
+                          // lines. Same pre-pass as zip, trades size
+                          // for very fast coding. Optional, see
+                          // isSupportedCompression().
+
     NUM_COMPRESSION_METHODS // number of different compression methods
 };
 
@@ -55,6 +65,10 @@ IMF_EXPORT void setDefaultZipCompressionLevel (int level);
 /// Controls the default quality level for the DWA lossy compression
 IMF_EXPORT void setDefaultDwaCompressionLevel (float level);
 
+/// Controls the default zstd compression level used, from 1 (fastest)
+/// to 22 (smallest).
+IMF_EXPORT void setDefaultZstdCompressionLevel (int level);
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
 
 #endif
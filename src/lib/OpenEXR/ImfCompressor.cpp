@@ -18,6 +18,10 @@
 #include "ImfPxr24Compressor.h"
 #include "ImfRleCompressor.h"
 #include "ImfZipCompressor.h"
+#include "ImfLz4Compressor.h"
+#include "ImfZstdCompressor.h"
+
+#include "OpenEXRConfigInternal.h"
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
@@ -63,12 +67,30 @@ isValidCompression (Compression c)
         case B44_COMPRESSION:
         case B44A_COMPRESSION:
         case DWAA_COMPRESSION:
-        case DWAB_COMPRESSION: return true;
+        case DWAB_COMPRESSION:
+        case ZSTD_COMPRESSION:
+        case LZ4_COMPRESSION: return true;
 
         default: return false;
     }
 }
 
+bool
+isSupportedCompression (Compression c)
+{
+    switch (c)
+    {
+#ifndef OPENEXR_HAVE_ZSTD
+        case ZSTD_COMPRESSION: return false;
+#endif
+#ifndef OPENEXR_HAVE_LZ4
+        case LZ4_COMPRESSION: return false;
+#endif
+
+        default: return isValidCompression (c);
+    }
+}
+
 bool
 isLossyCompression (Compression c)
 {
@@ -141,6 +163,14 @@ newCompressor (Compression c, size_t maxScanLineSize, const Header& hdr)
                 256,
                 DwaCompressor::STATIC_HUFFMAN);
 
+        case ZSTD_COMPRESSION:
+
+            return new ZstdCompressor (hdr, maxScanLineSize, 32);
+
+        case LZ4_COMPRESSION:
+
+            return new Lz4Compressor (hdr, maxScanLineSize, 16);
+
         default: return 0;
     }
 }
@@ -156,12 +186,14 @@ numLinesInBuffer (Compression comp)
         case NO_COMPRESSION:
         case RLE_COMPRESSION:
         case ZIPS_COMPRESSION: return 1;
-        case ZIP_COMPRESSION: return 16;
+        case ZIP_COMPRESSION:
+        case LZ4_COMPRESSION: return 16;
         case PIZ_COMPRESSION: return 32;
         case PXR24_COMPRESSION: return 16;
         case B44_COMPRESSION:
         case B44A_COMPRESSION:
-        case DWAA_COMPRESSION: return 32;
+        case DWAA_COMPRESSION:
+        case ZSTD_COMPRESSION: return 32;
         case DWAB_COMPRESSION: return 256;
 
         default: throw IEX_NAMESPACE::ArgExc ("Unknown compression type");
@@ -215,6 +247,14 @@ newTileCompressor (
                 static_cast<int> (numTileLines),
                 DwaCompressor::STATIC_HUFFMAN);
 
+        case ZSTD_COMPRESSION:
+
+            return new ZstdCompressor (hdr, tileLineSize, numTileLines);
+
+        case LZ4_COMPRESSION:
+
+            return new Lz4Compressor (hdr, tileLineSize, numTileLines);
+
         default: return 0;
     }
 }
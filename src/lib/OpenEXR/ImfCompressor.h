@@ -185,6 +185,16 @@ bool isValidDeepCompression (Compression c);
 IMF_EXPORT
 bool isLossyCompression (Compression c);
 
+//-----------------------------------------------------------------
+// Test if this build of the library can compress and uncompress
+// data with compression type c. ZSTD_COMPRESSION and
+// LZ4_COMPRESSION depend on optional libraries, and are valid
+// but unsupported without them.
+//-----------------------------------------------------------------
+
+IMF_EXPORT
+bool isSupportedCompression (Compression c);
+
 //-----------------------------------------------------------------
 // Construct a Compressor for compression type c:
 //
@@ -41,8 +41,10 @@
 #include "ImfNamespace.h"
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
+using ILMTHREAD_NAMESPACE::RecycledTask;
 using ILMTHREAD_NAMESPACE::Semaphore;
 using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskBatch;
 using ILMTHREAD_NAMESPACE::TaskGroup;
 using ILMTHREAD_NAMESPACE::ThreadPool;
 using IMATH_NAMESPACE::Box2i;
@@ -130,7 +132,7 @@ struct LineBuffer
     LineBuffer ();
     ~LineBuffer ();
 
-    inline void wait () { _sem.wait (); }
+    inline void wait (TaskGroup* group) { group->waitFor (_sem); }
     inline void post () { _sem.post (); }
 
 private:
@@ -297,6 +299,8 @@ reconstructLineOffsets (
 
     try
     {
+        skipHeaderPadding (is, false, vector<string> (1, DEEPSCANLINE));
+
         for (unsigned int i = 0; i < lineOffsets.size (); i++)
         {
             uint64_t lineOffset = is.tellg ();
@@ -738,7 +742,7 @@ fillSampleCountFromCache (int y, DeepScanLineInputFile::Data* data)
 // scanlines (line buffer) and copying them into the frame buffer.
 //
 
-class LineBufferTask : public Task
+class LineBufferTask : public RecycledTask
 {
 public:
     LineBufferTask (
@@ -765,7 +769,7 @@ LineBufferTask::LineBufferTask (
     LineBuffer*                  lineBuffer,
     int                          scanLineMin,
     int                          scanLineMax)
-    : Task (group)
+    : RecycledTask (group)
     , _ifd (ifd)
     , _lineBuffer (lineBuffer)
     , _scanLineMin (scanLineMin)
@@ -1018,7 +1022,7 @@ newLineBufferTask (
 
     try
     {
-        lineBuffer->wait ();
+        lineBuffer->wait (group);
 
         if (lineBuffer->number != number)
         {
@@ -1278,7 +1282,7 @@ DeepScanLineInputFile::DeepScanLineInputFile (
 
     try
     {
-        is = new StdIFStream (fileName);
+        is = new StdStatelessIFStream (fileName);
         readMagicNumberAndVersionField (*is, _data->version);
         //
         // Backward compatibility to read multpart file.
@@ -1749,12 +1753,18 @@ DeepScanLineInputFile::readPixels (int scanLine1, int scanLine2)
             // because we lock the line buffers during construction and the
             // constructors are called by the main thread.  Hence, in order
             // for a successive task to execute the previous task which
-            // used that line buffer must have completed already.
+            // used that line buffer must have completed already.  The
+            // tasks are added to the pool in batches of at most one task
+            // per line buffer, so that no task waits for a buffer used
+            // by a task of its own batch.
             //
 
+            TaskBatch batch (
+                ThreadPool::globalThreadPool (), _data->lineBuffers.size ());
+
             for (int l = start; l != stop; l += dl)
             {
-                ThreadPool::addGlobalTask (newLineBufferTask (
+                batch.add (newLineBufferTask (
                     &taskGroup, _data, l, scanLineMin, scanLineMax));
             }
 
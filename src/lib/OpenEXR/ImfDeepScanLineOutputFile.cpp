@@ -40,8 +40,10 @@
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
+using ILMTHREAD_NAMESPACE::RecycledTask;
 using ILMTHREAD_NAMESPACE::Semaphore;
 using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskBatch;
 using ILMTHREAD_NAMESPACE::TaskGroup;
 using ILMTHREAD_NAMESPACE::ThreadPool;
 using IMATH_NAMESPACE::Box2i;
@@ -121,7 +123,7 @@ struct LineBuffer
     LineBuffer (int linesInBuffer);
     ~LineBuffer ();
 
-    void wait () { _sem.wait (); }
+    void wait (TaskGroup* group) { group->waitFor (_sem); }
     void post () { _sem.post (); }
 
 private:
@@ -466,7 +468,7 @@ convertToXdr (
 // the data if necessary.
 //
 
-class LineBufferTask : public Task
+class LineBufferTask : public RecycledTask
 {
 public:
     LineBufferTask (
@@ -491,13 +493,15 @@ LineBufferTask::LineBufferTask (
     int                           number,
     int                           scanLineMin,
     int                           scanLineMax)
-    : Task (group), _ofd (ofd), _lineBuffer (_ofd->getLineBuffer (number))
+    : RecycledTask (group)
+    , _ofd (ofd)
+    , _lineBuffer (_ofd->getLineBuffer (number))
 {
     //
     // Wait for the lineBuffer to become available
     //
 
-    _lineBuffer->wait ();
+    _lineBuffer->wait (group);
 
     //
     // Initialize the lineBuffer data if necessary
@@ -1205,8 +1209,9 @@ DeepScanLineOutputFile::writePixels (int numScanLines)
             //
             // Determine the range of lineBuffers that intersect the scan
             // line range.  Then add the initial compression tasks to the
-            // thread pool.  We always add in at least one task but the
-            // individual task might not do anything if numScanLines == 0.
+            // thread pool, all at once.  We always add in at least one
+            // task but the individual task might not do anything if
+            // numScanLines == 0.
             //
 
             if (_data->lineOrder == INCREASING_Y)
@@ -1222,9 +1227,11 @@ DeepScanLineOutputFile::writePixels (int numScanLines)
                     min ((int) _data->lineBuffers.size (), last - first + 1),
                     1);
 
+                TaskBatch batch (ThreadPool::globalThreadPool (), numTasks);
+
                 for (int i = 0; i < numTasks; i++)
                 {
-                    ThreadPool::addGlobalTask (new LineBufferTask (
+                    batch.add (new LineBufferTask (
                         &taskGroup,
                         _data,
                         first + i,
@@ -1249,9 +1256,11 @@ DeepScanLineOutputFile::writePixels (int numScanLines)
                     min ((int) _data->lineBuffers.size (), first - last + 1),
                     1);
 
+                TaskBatch batch (ThreadPool::globalThreadPool (), numTasks);
+
                 for (int i = 0; i < numTasks; i++)
                 {
-                    ThreadPool::addGlobalTask (new LineBufferTask (
+                    batch.add (new LineBufferTask (
                         &taskGroup,
                         _data,
                         first - i,
@@ -1280,7 +1289,7 @@ DeepScanLineOutputFile::writePixels (int numScanLines)
                 LineBuffer* writeBuffer =
                     _data->getLineBuffer (nextWriteBuffer);
 
-                writeBuffer->wait ();
+                writeBuffer->wait (&taskGroup);
 
                 int numLines =
                     writeBuffer->scanLineMax - writeBuffer->scanLineMin + 1;
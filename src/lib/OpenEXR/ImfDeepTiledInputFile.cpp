@@ -41,8 +41,10 @@
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
+using ILMTHREAD_NAMESPACE::RecycledTask;
 using ILMTHREAD_NAMESPACE::Semaphore;
 using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskBatch;
 using ILMTHREAD_NAMESPACE::TaskGroup;
 using ILMTHREAD_NAMESPACE::ThreadPool;
 using IMATH_NAMESPACE::Box2i;
@@ -129,7 +131,7 @@ struct TileBuffer
     TileBuffer ();
     ~TileBuffer ();
 
-    inline void wait () { _sem.wait (); }
+    inline void wait (TaskGroup* group) { group->waitFor (_sem); }
     inline void post () { _sem.post (); }
 
 protected:
@@ -479,7 +481,7 @@ readTileData (
 // a single tile and copying it into the frame buffer.
 //
 
-class TileBufferTask : public Task
+class TileBufferTask : public RecycledTask
 {
 public:
     TileBufferTask (
@@ -498,7 +500,7 @@ private:
 
 TileBufferTask::TileBufferTask (
     TaskGroup* group, DeepTiledInputFile::Data* ifd, TileBuffer* tileBuffer)
-    : Task (group), _ifd (ifd), _tileBuffer (tileBuffer)
+    : RecycledTask (group), _ifd (ifd), _tileBuffer (tileBuffer)
 {
     // empty
 }
@@ -745,7 +747,7 @@ newTileBufferTask (
 
     try
     {
-        tileBuffer->wait ();
+        tileBuffer->wait (group);
 
         tileBuffer->dx = dx;
         tileBuffer->dy = dy;
@@ -794,7 +796,7 @@ DeepTiledInputFile::DeepTiledInputFile (const char fileName[], int numThreads)
     IStream* is = 0;
     try
     {
-        is = new StdIFStream (fileName);
+        is = new StdStatelessIFStream (fileName);
         readMagicNumberAndVersionField (*is, _data->version);
 
         //
@@ -1365,6 +1367,14 @@ DeepTiledInputFile::readTiles (
             TaskGroup taskGroup;
             int       tileNumber = 0;
 
+            //
+            // Add the tasks in batches of at most one task per tile
+            // buffer, as creating a task waits for the buffer to be free
+            //
+
+            TaskBatch batch (
+                ThreadPool::globalThreadPool (), _data->tileBuffers.size ());
+
             for (int dy = dyStart; dy != dyStop; dy += dY)
             {
                 for (int dx = dx1; dx <= dx2; dx++)
@@ -1375,7 +1385,7 @@ DeepTiledInputFile::readTiles (
                             "Tile (" << dx << ", " << dy << ", " << lx << ","
                                      << ly << ") is not a valid tile.");
 
-                    ThreadPool::addGlobalTask (newTileBufferTask (
+                    batch.add (newTileBufferTask (
                         &taskGroup, _data, tileNumber++, dx, dy, lx, ly));
                 }
             }
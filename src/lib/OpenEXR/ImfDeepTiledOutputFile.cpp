@@ -50,8 +50,10 @@
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
+using ILMTHREAD_NAMESPACE::RecycledTask;
 using ILMTHREAD_NAMESPACE::Semaphore;
 using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskBatch;
 using ILMTHREAD_NAMESPACE::TaskGroup;
 using ILMTHREAD_NAMESPACE::ThreadPool;
 using IMATH_NAMESPACE::Box2i;
@@ -192,7 +194,7 @@ struct TileBuffer
     TileBuffer ();
     ~TileBuffer ();
 
-    inline void wait () { _sem.wait (); }
+    inline void wait (TaskGroup* group) { group->waitFor (_sem); }
     inline void post () { _sem.post (); }
 
 protected:
@@ -744,7 +746,7 @@ convertToXdr (
 // if necessary.
 //
 
-class TileBufferTask : public Task
+class TileBufferTask : public RecycledTask
 {
 public:
     TileBufferTask (
@@ -773,13 +775,15 @@ TileBufferTask::TileBufferTask (
     int                        dy,
     int                        lx,
     int                        ly)
-    : Task (group), _ofd (ofd), _tileBuffer (_ofd->getTileBuffer (number))
+    : RecycledTask (group)
+    , _ofd (ofd)
+    , _tileBuffer (_ofd->getTileBuffer (number))
 {
     //
     // Wait for the tileBuffer to become available
     //
 
-    _tileBuffer->wait ();
+    _tileBuffer->wait (group);
     _tileBuffer->tileCoord = TileCoord (dx, dy, lx, ly);
 }
 
@@ -1514,16 +1518,18 @@ DeepTiledOutputFile::writeTiles (
             TaskGroup taskGroup;
 
             //
-            // Add in the initial compression tasks to the thread pool
+            // Add in the initial compression tasks to the thread pool,
+            // all at once
             //
 
-            int nextCompBuffer = 0;
-            int dxComp         = dx1;
-            int dyComp         = dyStart;
+            int       nextCompBuffer = 0;
+            int       dxComp         = dx1;
+            int       dyComp         = dyStart;
+            TaskBatch batch (ThreadPool::globalThreadPool (), numTasks);
 
             while (nextCompBuffer < numTasks)
             {
-                ThreadPool::addGlobalTask (new TileBufferTask (
+                batch.add (new TileBufferTask (
                     &taskGroup,
                     _data,
                     nextCompBuffer++,
@@ -1540,6 +1546,8 @@ DeepTiledOutputFile::writeTiles (
                 }
             }
 
+            batch.flush ();
+
             //
             // Write the compressed buffers and add in more compression
             // tasks until done
@@ -1558,7 +1566,7 @@ DeepTiledOutputFile::writeTiles (
                 TileBuffer* writeBuffer =
                     _data->getTileBuffer (nextWriteBuffer);
 
-                writeBuffer->wait ();
+                writeBuffer->wait (&taskGroup);
 
                 //
                 // Write the tilebuffer
@@ -108,6 +108,7 @@
 #include "ImfIntAttribute.h"
 #include "ImfMisc.h"
 #include "ImfNamespace.h"
+#include "ImfProbe.h"
 #include "ImfRle.h"
 #include "ImfSimd.h"
 #include "ImfStandardAttributes.h"
@@ -120,13 +121,22 @@
 #include "ImathVec.h"
 #include "half.h"
 
+#include "IlmThreadPool.h"
+
 #include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <functional>
 #include <limits>
 #include <string>
 #include <vector>
 
+#if ILMTHREAD_THREADING_ENABLED
+#    include <atomic>
+#    include <exception>
+#    include <mutex>
+#endif
+
 #include <cstddef>
 
 #include <cstdint>
@@ -142,6 +152,10 @@
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
+using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskGroup;
+using ILMTHREAD_NAMESPACE::ThreadPool;
+
 #include "dwaLookups.h"
 
 namespace
@@ -175,6 +189,239 @@ void (*dctInverse8x8_5) (float*) = dctInverse8x8_scalar<5>;
 void (*dctInverse8x8_6) (float*) = dctInverse8x8_scalar<6>;
 void (*dctInverse8x8_7) (float*) = dctInverse8x8_scalar<7>;
 
+//
+// Dispatch the forward DCT on an 8x8 block. All the
+// implementations, other than the non-SSE2 scalar code,
+// produce identical results.
+//
+void (*dctForward8x8) (float*) = dctForward8x8_sse2;
+
+//
+// Index of the lowest set bit, v must not be 0
+//
+inline int
+lowestSetBit (uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll (v);
+#else
+    int n = 0;
+    while (!(v & 1))
+    {
+        v >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+//
+// Search the quantization candidates closest[0 .. n-1] for the first
+// that is within errorTolerance of srcFloat. Returns its index, or
+// n if there are none.
+//
+int
+searchCandidates_scalar (
+    const unsigned short* closest, int n, float srcFloat, float errorTolerance)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        half tmp;
+
+        tmp.setBits (closest[i]);
+
+        if (fabs ((float) tmp - srcFloat) < errorTolerance) return i;
+    }
+
+    return n;
+}
+
+//
+// F16C search, converting and testing 8 candidates at a time. This
+// may read up to 16 entries from closest, regardless of n.
+//
+#ifdef IMF_DWA_DISPATCH_AVX
+__attribute__ ((target ("avx,f16c"))) int
+searchCandidates_f16c (
+    const unsigned short* closest, int n, float srcFloat, float errorTolerance)
+{
+    const __m256 src     = _mm256_set1_ps (srcFloat);
+    const __m256 tol     = _mm256_set1_ps (errorTolerance);
+    const __m256 absMask = _mm256_castsi256_ps (_mm256_set1_epi32 (0x7fffffff));
+
+    for (int i = 0; i < n; i += 8)
+    {
+        __m256 tmp = _mm256_cvtph_ps (
+            _mm_loadu_si128 ((const __m128i*) (closest + i)));
+        __m256 err = _mm256_and_ps (_mm256_sub_ps (tmp, src), absMask);
+        int    hit = _mm256_movemask_ps (_mm256_cmp_ps (err, tol, _CMP_LT_OQ));
+
+        if (n - i < 8) hit &= (1 << (n - i)) - 1;
+
+        if (hit) return i + lowestSetBit (hit);
+    }
+
+    return n;
+}
+#endif /* IMF_DWA_DISPATCH_AVX */
+
+//
+// Dispatch the quantization candidate search
+//
+int (*searchCandidates) (const unsigned short*, int, float, float) =
+    searchCandidates_scalar;
+
+//
+// The smallest magnitude, as half bits, that is not within
+// errorTolerance of 0. half -> float is monotonic over the
+// non-NaN magnitudes, so any value with fewer bits (masking off
+// the sign) is within the tolerance, and quantizes to 0.
+//
+unsigned short
+zeroThreshold (float errorTolerance)
+{
+    unsigned short lo = 0;
+    unsigned short hi = 0x7c00;
+
+    if (!(errorTolerance > 0.f)) return 0;
+
+    while (lo < hi)
+    {
+        unsigned short mid = (lo + hi) / 2;
+        half           h;
+
+        h.setBits (mid);
+
+        if ((float) h >= errorTolerance)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return lo;
+}
+
+//
+// Smallest number of 8x8 blocks worth handing to another thread
+//
+const int MIN_BLOCKS_PER_PIECE = 32;
+
+//
+// The number of pieces to split numBlocksY rows of numBlocksX
+// blocks into, to spread them over the global thread pool
+//
+int
+numBlockRowPieces (int numBlocksX, int numBlocksY)
+{
+    int numThreads = ThreadPool::globalThreadPool ().numThreads ();
+
+    if (numThreads < 1) return 1;
+
+    int numPieces = std::min (numThreads + 1, numBlocksY);
+
+    numPieces =
+        std::min (numPieces, numBlocksX * numBlocksY / MIN_BLOCKS_PER_PIECE);
+
+    return std::max (numPieces, 1);
+}
+
+#if ILMTHREAD_THREADING_ENABLED
+
+//
+// Shared between the caller of parallelFor() and the tasks it
+// submits. Calls are claimed one at a time from next, so tasks
+// which only start after all of them are claimed do nothing.
+//
+struct ParallelWork
+{
+    const std::function<void (int)>& work;
+    int                              count;
+    std::atomic<int>                 next;
+
+    std::mutex         mutex;
+    std::exception_ptr error;
+
+    ParallelWork (const std::function<void (int)>& w, int n)
+        : work (w), count (n), next (0)
+    {}
+
+    void run ()
+    {
+        for (int i = next++; i < count; i = next++)
+        {
+            try
+            {
+                work (i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+
+                if (!error) error = std::current_exception ();
+            }
+        }
+    }
+};
+
+class ParallelWorkTask : public Task
+{
+public:
+    ParallelWorkTask (TaskGroup* group, ParallelWork* work)
+        : Task (group), _work (work)
+    {}
+
+    void execute () override { _work->run (); }
+
+private:
+    ParallelWork* _work;
+};
+
+#endif /* ILMTHREAD_THREADING_ENABLED */
+
+//
+// Call work (i) for i in [0, count), spread over the global thread
+// pool, with the calling thread taking part. Returns once all the
+// calls have finished, rethrowing the first exception any of them
+// threw.
+//
+void
+parallelFor (int count, const std::function<void (int)>& work)
+{
+#if ILMTHREAD_THREADING_ENABLED
+    ThreadPool& pool       = ThreadPool::globalThreadPool ();
+    int         numThreads = std::min (count - 1, pool.numThreads ());
+
+    if (numThreads > 0)
+    {
+        ParallelWork shared (work, count);
+
+        {
+            //
+            // The group takes the priority of the calling thread,
+            // which is that of the file's own tasks when this runs
+            // on a worker. Destroying it runs the tasks that have
+            // not started yet on this thread, rather than waiting
+            // for a worker to pick them up.
+            //
+
+            TaskGroup group;
+
+            for (int i = 0; i < numThreads; ++i)
+                pool.addTask (new ParallelWorkTask (&group, &shared));
+
+            shared.run ();
+        }
+
+        if (shared.error) std::rethrow_exception (shared.error);
+
+        return;
+    }
+#endif /* ILMTHREAD_THREADING_ENABLED */
+
+    for (int i = 0; i < count; ++i)
+        work (i);
+}
+
 } // namespace
 
 struct DwaCompressor::ChannelData
@@ -365,6 +612,16 @@ protected:
         unsigned short*  acBufferEnd,
         unsigned short*  halfZigBlock);
 
+    //
+    // Decode the block rows [blockyBegin, blockyEnd), whose AC
+    // components start at currAcComp. Returns the end of the AC
+    // components read. Pieces of block rows can be decoded in
+    // parallel.
+    //
+
+    unsigned short* decodeBlockRows (
+        int blockyBegin, int blockyEnd, unsigned short* currAcComp);
+
     //
     // if NATIVE and XDR are really the same values, we can
     // skip some processing and speed things along
@@ -413,8 +670,7 @@ protected:
     // is in the same order as _rowPtrs[].
     //
 
-    std::vector<PixelType>            _type;
-    std::vector<SimdAlignedBuffer64f> _dctData;
+    std::vector<PixelType> _type;
 };
 
 //
@@ -518,10 +774,24 @@ public:
     int numDcValuesEncoded () const { return _numDcComp; }
 
 protected:
-    void toZigZag (half* dst, half* src);
+    void toZigZag (unsigned short* dst, const unsigned short* src);
     int  countSetBits (unsigned short src);
     half quantize (half src, float errorTolerance);
-    void rleAc (half* block, unsigned short*& acPtr);
+    void quantize64 (
+        unsigned short*       block,
+        const float*          errorTolerance,
+        const unsigned short* zeroBelow);
+    void rleAc (const unsigned short* block, unsigned short*& acPtr);
+
+    //
+    // Encode the block rows [blockyBegin, blockyEnd), writing their
+    // AC components to currAcComp onwards. Returns the end of the
+    // AC components written. Pieces of block rows can be encoded
+    // in parallel.
+    //
+
+    unsigned short* encodeBlockRows (
+        int blockyBegin, int blockyEnd, unsigned short* currAcComp);
 
     float _quantBaseError;
 
@@ -532,7 +802,6 @@ protected:
 
     std::vector<std::vector<const char*>> _rowPtrs;
     std::vector<PixelType>                _type;
-    std::vector<SimdAlignedBuffer64f>     _dctData;
 
     //
     // Pointers to the buffers where AC and DC
@@ -552,6 +821,17 @@ protected:
 
     float _quantTableY[64];
     float _quantTableCbCr[64];
+
+    //
+    // The acceptable error for each component, _quantBaseError
+    // scaled by the tables above, and the magnitude (as half bits)
+    // below which a component is within that error of 0.
+    //
+
+    float          _toleranceY[64];
+    float          _toleranceCbCr[64];
+    unsigned short _zeroBelowY[64];
+    unsigned short _zeroBelowCbCr[64];
 };
 
 //
@@ -648,6 +928,76 @@ DwaCompressor::LossyDctDecoderBase::~LossyDctDecoderBase ()
 
 void
 DwaCompressor::LossyDctDecoderBase::execute ()
+{
+    size_t numComp    = _rowPtrs.size ();
+    int    numBlocksX = (int) ceil ((float) _width / 8.0f);
+    int    numBlocksY = (int) ceil ((float) _height / 8.0f);
+
+    unsigned short* packedAc = reinterpret_cast<unsigned short*> (_packedAc);
+    unsigned short* acCompEnd =
+        reinterpret_cast<unsigned short*> (_packedAcEnd);
+
+    if (_type.size () != _rowPtrs.size ())
+        throw IEX_NAMESPACE::BaseExc (
+            "Row pointers and types mismatch in count");
+
+    if ((_rowPtrs.size () != 3) && (_rowPtrs.size () != 1))
+        throw IEX_NAMESPACE::NoImplExc (
+            "Only 1 and 3 channel encoding is supported");
+
+    int             numPieces  = numBlockRowPieces (numBlocksX, numBlocksY);
+    unsigned short* currAcComp = packedAc;
+
+    if (numPieces == 1)
+    {
+        currAcComp = decodeBlockRows (0, numBlocksY, currAcComp);
+    }
+    else
+    {
+        //
+        // The AC components are variable length, so find where
+        // each piece of block rows starts by un-RLE'ing everything
+        // into a scratch block first. Then the pieces can be
+        // decoded in parallel.
+        //
+
+        std::vector<unsigned short*> pieceAcComp (numPieces);
+        SimdAlignedBuffer64us        scratchBlock;
+
+        for (int piece = 0; piece < numPieces; ++piece)
+        {
+            int blockyBegin = piece * numBlocksY / numPieces;
+            int blockyEnd   = (piece + 1) * numBlocksY / numPieces;
+            int numBlocks =
+                (blockyEnd - blockyBegin) * numBlocksX * (int) numComp;
+
+            pieceAcComp[piece] = currAcComp;
+
+            for (int block = 0; block < numBlocks; ++block)
+                unRleAc (currAcComp, acCompEnd, scratchBlock._buffer);
+        }
+
+        parallelFor (numPieces, [&] (int piece) {
+            decodeBlockRows (
+                piece * numBlocksY / numPieces,
+                (piece + 1) * numBlocksY / numPieces,
+                pieceAcComp[piece]);
+        });
+    }
+
+    _packedAcCount = static_cast<int> (currAcComp - packedAc);
+    _packedDcCount = static_cast<int> (numComp) * numBlocksX * numBlocksY;
+}
+
+//
+// Decode the blocks in rows [blockyBegin, blockyEnd) into _rowPtrs,
+// un-RLE'ing their AC components from currAcComp onwards. Returns
+// the end of the AC components read.
+//
+
+unsigned short*
+DwaCompressor::LossyDctDecoderBase::decodeBlockRows (
+    int blockyBegin, int blockyEnd, unsigned short* currAcComp)
 {
     size_t numComp     = _rowPtrs.size ();
     int    lastNonZero = 0;
@@ -662,22 +1012,12 @@ DwaCompressor::LossyDctDecoderBase::execute ()
     unsigned short tmpShortXdr     = 0;
     const char*    tmpConstCharPtr = 0;
 
-    unsigned short* currAcComp = reinterpret_cast<unsigned short*> (_packedAc);
     unsigned short* acCompEnd =
         reinterpret_cast<unsigned short*> (_packedAcEnd);
 
-    std::vector<unsigned short*>       currDcComp (_rowPtrs.size ());
-    std::vector<SimdAlignedBuffer64us> halfZigBlock (_rowPtrs.size ());
-
-    if (_type.size () != _rowPtrs.size ())
-        throw IEX_NAMESPACE::BaseExc (
-            "Row pointers and types mismatch in count");
-
-    if ((_rowPtrs.size () != 3) && (_rowPtrs.size () != 1))
-        throw IEX_NAMESPACE::NoImplExc (
-            "Only 1 and 3 channel encoding is supported");
-
-    _dctData.resize (numComp);
+    std::vector<unsigned short*>       currDcComp (numComp);
+    std::vector<SimdAlignedBuffer64us> halfZigBlock (numComp);
+    std::vector<SimdAlignedBuffer64f>  dctData (numComp);
 
     //
     // Allocate a temp aligned buffer to hold a rows worth of full
@@ -707,12 +1047,12 @@ DwaCompressor::LossyDctDecoderBase::execute ()
     // one component per block, so we can computed offsets.
     //
 
-    currDcComp[0] = (unsigned short*) _packedDc;
+    currDcComp[0] = (unsigned short*) _packedDc + blockyBegin * numBlocksX;
 
     for (size_t comp = 1; comp < numComp; ++comp)
         currDcComp[comp] = currDcComp[comp - 1] + numBlocksX * numBlocksY;
 
-    for (int blocky = 0; blocky < numBlocksY; ++blocky)
+    for (int blocky = blockyBegin; blocky < blockyEnd; ++blocky)
     {
         int maxY = 8;
 
@@ -764,8 +1104,6 @@ DwaCompressor::LossyDctDecoderBase::execute ()
 
 #endif /* IMF_HAVE_SSE2 */
 
-                _packedDcCount++;
-
                 //
                 // UnRLE the AC. This will modify currAcComp
                 //
@@ -807,9 +1145,9 @@ DwaCompressor::LossyDctDecoderBase::execute ()
                     half h;
 
                     h.setBits (halfZigBlock[comp]._buffer[0]);
-                    _dctData[comp]._buffer[0] = (float) h;
+                    dctData[comp]._buffer[0] = (float) h;
 
-                    dctInverse8x8DcOnly (_dctData[comp]._buffer);
+                    dctInverse8x8DcOnly (dctData[comp]._buffer);
                 }
                 else
                 {
@@ -825,7 +1163,7 @@ DwaCompressor::LossyDctDecoderBase::execute ()
                     //
 
                     (*fromHalfZigZag) (
-                        halfZigBlock[comp]._buffer, _dctData[comp]._buffer);
+                        halfZigBlock[comp]._buffer, dctData[comp]._buffer);
 
                     //
                     // Zig-Zag indices in normal layout are as follows:
@@ -856,21 +1194,21 @@ DwaCompressor::LossyDctDecoderBase::execute ()
                     //
 
                     if (lastNonZero < 2)
-                        dctInverse8x8_7 (_dctData[comp]._buffer);
+                        dctInverse8x8_7 (dctData[comp]._buffer);
                     else if (lastNonZero < 3)
-                        dctInverse8x8_6 (_dctData[comp]._buffer);
+                        dctInverse8x8_6 (dctData[comp]._buffer);
                     else if (lastNonZero < 9)
-                        dctInverse8x8_5 (_dctData[comp]._buffer);
+                        dctInverse8x8_5 (dctData[comp]._buffer);
                     else if (lastNonZero < 10)
-                        dctInverse8x8_4 (_dctData[comp]._buffer);
+                        dctInverse8x8_4 (dctData[comp]._buffer);
                     else if (lastNonZero < 20)
-                        dctInverse8x8_3 (_dctData[comp]._buffer);
+                        dctInverse8x8_3 (dctData[comp]._buffer);
                     else if (lastNonZero < 21)
-                        dctInverse8x8_2 (_dctData[comp]._buffer);
+                        dctInverse8x8_2 (dctData[comp]._buffer);
                     else if (lastNonZero < 35)
-                        dctInverse8x8_1 (_dctData[comp]._buffer);
+                        dctInverse8x8_1 (dctData[comp]._buffer);
                     else
-                        dctInverse8x8_0 (_dctData[comp]._buffer);
+                        dctInverse8x8_0 (dctData[comp]._buffer);
                 }
             }
 
@@ -883,16 +1221,16 @@ DwaCompressor::LossyDctDecoderBase::execute ()
                 if (!blockIsConstant)
                 {
                     csc709Inverse64 (
-                        _dctData[0]._buffer,
-                        _dctData[1]._buffer,
-                        _dctData[2]._buffer);
+                        dctData[0]._buffer,
+                        dctData[1]._buffer,
+                        dctData[2]._buffer);
                 }
                 else
                 {
                     csc709Inverse (
-                        _dctData[0]._buffer[0],
-                        _dctData[1]._buffer[0],
-                        _dctData[2]._buffer[0]);
+                        dctData[0]._buffer[0],
+                        dctData[1]._buffer[0],
+                        dctData[2]._buffer[0]);
                 }
             }
 
@@ -907,7 +1245,7 @@ DwaCompressor::LossyDctDecoderBase::execute ()
                 if (!blockIsConstant)
                 {
                     (*convertFloatToHalf64) (
-                        &rowBlock[comp][blockx * 64], _dctData[comp]._buffer);
+                        &rowBlock[comp][blockx * 64], dctData[comp]._buffer);
                 }
                 else
                 {
@@ -916,7 +1254,7 @@ DwaCompressor::LossyDctDecoderBase::execute ()
                     __m128i* dst = (__m128i*) &rowBlock[comp][blockx * 64];
 
                     dst[0] = _mm_set1_epi16 (
-                        ((half) _dctData[comp]._buffer[0]).bits ());
+                        ((half) dctData[comp]._buffer[0]).bits ());
 
                     dst[1] = dst[0];
                     dst[2] = dst[0];
@@ -930,7 +1268,7 @@ DwaCompressor::LossyDctDecoderBase::execute ()
 
                     unsigned short* dst = &rowBlock[comp][blockx * 64];
 
-                    dst[0] = ((half) _dctData[comp]._buffer[0]).bits ();
+                    dst[0] = ((half) dctData[comp]._buffer[0]).bits ();
 
                     for (int i = 1; i < 64; ++i)
                     {
@@ -1108,7 +1446,8 @@ DwaCompressor::LossyDctDecoderBase::execute ()
 
         std::vector<unsigned short> halfXdr (_width);
 
-        for (int y = 0; y < _height; ++y)
+        for (int y = 8 * blockyBegin; y < std::min (8 * blockyEnd, _height);
+             ++y)
         {
             char* floatXdrPtr = _rowPtrs[chan][y];
 
@@ -1131,6 +1470,8 @@ DwaCompressor::LossyDctDecoderBase::execute ()
     }
 
     delete[] rowBlockHandle;
+
+    return currAcComp;
 }
 
 //
@@ -1208,7 +1549,6 @@ DwaCompressor::LossyDctDecoderBase::unRleAc (
             dctComp++;
         }
 
-        _packedAcCount++;
         currAcComp++;
     }
 
@@ -1286,6 +1626,15 @@ DwaCompressor::LossyDctEncoderBase::LossyDctEncoderBase (
     }
 
     if (_quantBaseError < 0) quantBaseError = 0;
+
+    for (int idx = 0; idx < 64; ++idx)
+    {
+        _toleranceY[idx]    = _quantBaseError * _quantTableY[idx];
+        _toleranceCbCr[idx] = _quantBaseError * _quantTableCbCr[idx];
+
+        _zeroBelowY[idx]    = zeroThreshold (_toleranceY[idx]);
+        _zeroBelowCbCr[idx] = zeroThreshold (_toleranceCbCr[idx]);
+    }
 }
 
 DwaCompressor::LossyDctEncoderBase::~LossyDctEncoderBase ()
@@ -1306,15 +1655,7 @@ DwaCompressor::LossyDctEncoderBase::execute ()
     int numBlocksX = (int) ceil ((float) _width / 8.0f);
     int numBlocksY = (int) ceil ((float) _height / 8.0f);
 
-    half halfZigCoef[64];
-    half halfCoef[64];
-
-    std::vector<unsigned short*> currDcComp (_rowPtrs.size ());
-    unsigned short*              currAcComp = (unsigned short*) _packedAc;
-
-    _dctData.resize (_rowPtrs.size ());
-    _numAcComp = 0;
-    _numDcComp = 0;
+    size_t numComp    = _rowPtrs.size ();
 
     assert (_type.size () == _rowPtrs.size ());
     assert ((_rowPtrs.size () == 3) || (_rowPtrs.size () == 1));
@@ -1376,32 +1717,129 @@ DwaCompressor::LossyDctEncoderBase::execute ()
         }
     }
 
+    //
+    // Encode the block rows, in pieces spread over the thread pool
+    // if there are enough of them.
+    //
+
+    int             numPieces  = numBlockRowPieces (numBlocksX, numBlocksY);
+    unsigned short* packedAc   = (unsigned short*) _packedAc;
+    unsigned short* currAcComp = packedAc;
+
+    if (numPieces == 1)
+    {
+        currAcComp = encodeBlockRows (0, numBlocksY, currAcComp);
+    }
+    else
+    {
+        //
+        // The RLE'd AC components are variable length, so all but
+        // the first piece are encoded into buffers of their own (big
+        // enough for 63 AC components per block), and then appended
+        // in order.
+        //
+
+        std::vector<std::vector<unsigned short>> pieceAc (numPieces);
+        std::vector<unsigned short*>             pieceAcEnd (numPieces);
+
+        parallelFor (numPieces, [&] (int piece) {
+            int blockyBegin = piece * numBlocksY / numPieces;
+            int blockyEnd   = (piece + 1) * numBlocksY / numPieces;
+
+            unsigned short* acPtr = currAcComp;
+
+            if (piece > 0)
+            {
+                pieceAc[piece].resize (
+                    (blockyEnd - blockyBegin) * numBlocksX * numComp * 63);
+                acPtr = &pieceAc[piece][0];
+            }
+
+            pieceAcEnd[piece] = encodeBlockRows (blockyBegin, blockyEnd, acPtr);
+        });
+
+        currAcComp = pieceAcEnd[0];
+
+        for (int piece = 1; piece < numPieces; ++piece)
+        {
+            size_t count = pieceAcEnd[piece] - &pieceAc[piece][0];
+
+            memcpy (
+                currAcComp, &pieceAc[piece][0], count * sizeof (unsigned short));
+
+            currAcComp += count;
+        }
+    }
+
+    _numAcComp = static_cast<int> (currAcComp - packedAc);
+    _numDcComp = static_cast<int> (numComp) * numBlocksX * numBlocksY;
+}
+
+//
+// Encode the blocks in rows [blockyBegin, blockyEnd), RLE'ing their
+// AC components to acPtr onwards. Returns the end of the AC
+// components written.
+//
+
+unsigned short*
+DwaCompressor::LossyDctEncoderBase::encodeBlockRows (
+    int blockyBegin, int blockyEnd, unsigned short* currAcComp)
+{
+    int numBlocksX = (int) ceil ((float) _width / 8.0f);
+    int numBlocksY = (int) ceil ((float) _height / 8.0f);
+
+    SimdAlignedBuffer64us halfCoef;
+    SimdAlignedBuffer64us halfZigCoef;
+
+    std::vector<unsigned short*>      currDcComp (_rowPtrs.size ());
+    std::vector<SimdAlignedBuffer64f> dctData (_rowPtrs.size ());
+
     //
     // Pack DC components together by common plane, so we can get
     // a little more out of differencing them. We'll always have
     // one component per block, so we can computed offsets.
     //
 
-    currDcComp[0] = (unsigned short*) _packedDc;
+    currDcComp[0] = (unsigned short*) _packedDc + blockyBegin * numBlocksX;
 
     for (unsigned int chan = 1; chan < _rowPtrs.size (); ++chan)
         currDcComp[chan] = currDcComp[chan - 1] + numBlocksX * numBlocksY;
 
-    for (int blocky = 0; blocky < numBlocksY; ++blocky)
+    for (int blocky = blockyBegin; blocky < blockyEnd; ++blocky)
     {
+        //
+        // Break the source into 8x8 blocks. If we don't
+        // fit at the edges, mirror.
+        //
+
+        int vy[8];
+
+        for (int y = 0; y < 8; ++y)
+        {
+            vy[y] = 8 * blocky + y;
+
+            if (vy[y] >= _height) vy[y] = _height - (vy[y] - (_height - 1));
+
+            if (vy[y] < 0) vy[y] = _height - 1;
+        }
+
         for (int blockx = 0; blockx < numBlocksX; ++blockx)
         {
-            half           h;
-            unsigned short tmpShortXdr, tmpShortNative;
-            char*          tmpCharPtr;
+            int vx[8];
+
+            for (int x = 0; x < 8; ++x)
+            {
+                vx[x] = 8 * blockx + x;
+
+                if (vx[x] >= _width) vx[x] = _width - (vx[x] - (_width - 1));
+
+                if (vx[x] < 0) vx[x] = _width - 1;
+            }
 
             for (unsigned int chan = 0; chan < _rowPtrs.size (); ++chan)
             {
                 //
-                // Break the source into 8x8 blocks. If we don't
-                // fit at the edges, mirror.
-                //
-                // Also, convert from linear to nonlinear representation.
+                // Convert from linear to nonlinear representation.
                 // Our source is assumed to be XDR, and we need to convert
                 // to NATIVE prior to converting to float.
                 //
@@ -1412,41 +1850,36 @@ DwaCompressor::LossyDctEncoderBase::execute ()
 
                 for (int y = 0; y < 8; ++y)
                 {
-                    for (int x = 0; x < 8; ++x)
-                    {
-                        int vx = 8 * blockx + x;
-                        int vy = 8 * blocky + y;
-
-                        if (vx >= _width) vx = _width - (vx - (_width - 1));
-
-                        if (vx < 0) vx = _width - 1;
-
-                        if (vy >= _height) vy = _height - (vy - (_height - 1));
-
-                        if (vy < 0) vy = _height - 1;
+                    const unsigned short* srcRow =
+                        (const unsigned short*) (_rowPtrs[chan])[vy[y]];
+                    float* dst = dctData[chan]._buffer + y * 8;
+                    half   h;
 
-                        tmpShortXdr =
-                            ((const unsigned short*) (_rowPtrs[chan])[vy])[vx];
-
-                        if (_toNonlinear)
+                    if (_toNonlinear)
+                    {
+                        for (int x = 0; x < 8; ++x)
                         {
-                            h.setBits (_toNonlinear[tmpShortXdr]);
+                            h.setBits (_toNonlinear[srcRow[vx[x]]]);
+                            dst[x] = (float) h;
                         }
-                        else
+                    }
+                    else
+                    {
+                        for (int x = 0; x < 8; ++x)
                         {
-                            const char* tmpConstCharPtr =
-                                (const char*) (&tmpShortXdr);
+                            unsigned short tmpShortNative;
+                            const char*    tmpConstCharPtr =
+                                (const char*) (srcRow + vx[x]);
 
                             Xdr::read<CharPtrIO> (
                                 tmpConstCharPtr, tmpShortNative);
 
                             h.setBits (tmpShortNative);
+                            dst[x] = (float) h;
                         }
-
-                        _dctData[chan]._buffer[y * 8 + x] = (float) h;
-                    } // x
-                }     // y
-            }         // chan
+                    }
+                } // y
+            }     // chan
 
             //
             // Color space conversion
@@ -1455,9 +1888,9 @@ DwaCompressor::LossyDctEncoderBase::execute ()
             if (_rowPtrs.size () == 3)
             {
                 csc709Forward64 (
-                    _dctData[0]._buffer,
-                    _dctData[1]._buffer,
-                    _dctData[2]._buffer);
+                    dctData[0]._buffer,
+                    dctData[1]._buffer,
+                    dctData[2]._buffer);
             }
 
             for (unsigned int chan = 0; chan < _rowPtrs.size (); ++chan)
@@ -1466,78 +1899,62 @@ DwaCompressor::LossyDctEncoderBase::execute ()
                 // Forward DCT
                 //
 
-                dctForward8x8 (_dctData[chan]._buffer);
+                dctForward8x8 (dctData[chan]._buffer);
 
                 //
-                // Quantize to half, and zigzag
+                // Quantize to half, and zigzag, converting from
+                // NATIVE back to XDR before we write out
                 //
 
+                convertFloatToHalf64 (halfCoef._buffer, dctData[chan]._buffer);
+
                 if (chan == 0)
-                {
-                    for (int i = 0; i < 64; ++i)
-                    {
-                        halfCoef[i] = quantize (
-                            (half) _dctData[chan]._buffer[i],
-                            _quantBaseError * _quantTableY[i]);
-                    }
-                }
+                    quantize64 (halfCoef._buffer, _toleranceY, _zeroBelowY);
                 else
-                {
-                    for (int i = 0; i < 64; ++i)
-                    {
-                        halfCoef[i] = quantize (
-                            (half) _dctData[chan]._buffer[i],
-                            _quantBaseError * _quantTableCbCr[i]);
-                    }
-                }
+                    quantize64 (
+                        halfCoef._buffer, _toleranceCbCr, _zeroBelowCbCr);
 
-                toZigZag (halfZigCoef, halfCoef);
+                toZigZag (halfZigCoef._buffer, halfCoef._buffer);
 
                 //
-                // Convert from NATIVE back to XDR, before we write out
+                // Save the DC component separately, to be compressed on
+                // its own.
                 //
 
-                for (int i = 0; i < 64; ++i)
-                {
-                    tmpCharPtr = (char*) &tmpShortXdr;
-                    Xdr::write<CharPtrIO> (tmpCharPtr, halfZigCoef[i].bits ());
-                    halfZigCoef[i].setBits (tmpShortXdr);
-                }
-
-                //
-                // Save the DC component separately, to be compressed on
-                // its own.
-                //
-
-                *currDcComp[chan]++ = halfZigCoef[0].bits ();
-                _numDcComp++;
+                *currDcComp[chan]++ = halfZigCoef._buffer[0];
 
                 //
                 // Then RLE the AC components (which will record the count
                 // of the resulting number of items)
                 //
 
-                rleAc (halfZigCoef, currAcComp);
+                rleAc (halfZigCoef._buffer, currAcComp);
             } // chan
         }     // blockx
     }         // blocky
+
+    return currAcComp;
 }
 
 //
-// Reorder from zig-zag order to normal ordering
+// Reorder from normal ordering to zig-zag order, and
+// convert from NATIVE to XDR
 //
 
 void
-DwaCompressor::LossyDctEncoderBase::toZigZag (half* dst, half* src)
+DwaCompressor::LossyDctEncoderBase::toZigZag (
+    unsigned short* dst, const unsigned short* src)
 {
-    const int remap[] = {0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18,
-                         11, 4,  5,  12, 19, 26, 33, 40, 48, 41, 34, 27, 20,
-                         13, 6,  7,  14, 21, 28, 35, 42, 49, 56, 57, 50, 43,
-                         36, 29, 22, 15, 23, 30, 37, 44, 51, 58, 59, 52, 45,
-                         38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+    static const int remap[] = {
+        0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,
+        12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6,  7,  14, 21, 28,
+        35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+        58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+    char* dstXdr = (char*) dst;
 
     for (int i = 0; i < 64; ++i)
-        dst[i] = src[remap[i]];
+        Xdr::write<CharPtrIO> (dstXdr, src[remap[i]]);
 }
 
 //
@@ -1582,22 +1999,81 @@ half
 DwaCompressor::LossyDctEncoderBase::quantize (half src, float errorTolerance)
 {
     half                  tmp;
-    float                 srcFloat   = (float) src;
-    int                   numSetBits = countSetBits (src.bits ());
+    float                 srcFloat      = (float) src;
+    int                   numCandidates = countSetBits (src.bits ());
     const unsigned short* closest =
         closestData + closestDataOffset[src.bits ()];
+    int idx;
 
-    for (int targetNumSetBits = numSetBits - 1; targetNumSetBits >= 0;
-         --targetNumSetBits)
+    //
+    // There is one candidate for each smaller number of bits set.
+    // The vectorized search reads 16 entries, which is always
+    // enough, but may run off the end of the table for the
+    // last few values.
+    //
+
+    if (closest + 16 <= closestData + sizeof (closestData) / sizeof (*closest))
+        idx = searchCandidates (
+            closest, numCandidates, srcFloat, errorTolerance);
+    else
+        idx = searchCandidates_scalar (
+            closest, numCandidates, srcFloat, errorTolerance);
+
+    if (idx == numCandidates) return src;
+
+    tmp.setBits (closest[idx]);
+    return tmp;
+}
+
+//
+// Quantize a block of 64 coefficients in place, given as half bits.
+//
+// Most components are typically within the error tolerance of 0,
+// which is always the first candidate tried by quantize(). So, first
+// compare the magnitudes against the precomputed zeroBelow thresholds,
+// 8 components at a time, and only search for the remaining ones.
+//
+
+void
+DwaCompressor::LossyDctEncoderBase::quantize64 (
+    unsigned short*       block,
+    const float*          errorTolerance,
+    const unsigned short* zeroBelow)
+{
+    for (int i = 0; i < 64; i += 8)
     {
-        tmp.setBits (*closest);
+        int nonZero = 0;
 
-        if (fabs ((float) tmp - srcFloat) < errorTolerance) return tmp;
+#ifdef IMF_HAVE_SSE2
+        __m128i src = _mm_load_si128 ((const __m128i*) (block + i));
+        __m128i mag = _mm_and_si128 (src, _mm_set1_epi16 (0x7fff));
+        __m128i zero = _mm_cmplt_epi16 (
+            mag, _mm_loadu_si128 ((const __m128i*) (zeroBelow + i)));
 
-        closest++;
-    }
+        _mm_store_si128 ((__m128i*) (block + i), _mm_andnot_si128 (zero, src));
 
-    return src;
+        nonZero = ~_mm_movemask_epi8 (_mm_packs_epi16 (zero, zero)) & 0xff;
+#else
+        for (int j = 0; j < 8; ++j)
+        {
+            if ((block[i + j] & 0x7fff) < zeroBelow[i + j])
+                block[i + j] = 0;
+            else
+                nonZero |= 1 << j;
+        }
+#endif /* IMF_HAVE_SSE2 */
+
+        for (int j = 0; nonZero; ++j, nonZero >>= 1)
+        {
+            if (nonZero & 1)
+            {
+                half h;
+
+                h.setBits (block[i + j]);
+                block[i + j] = quantize (h, errorTolerance[i + j]).bits ();
+            }
+        }
+    }
 }
 
 //
@@ -1617,29 +2093,53 @@ DwaCompressor::LossyDctEncoderBase::quantize (half src, float errorTolerance)
 // block is our block of 64 coefficients
 // acPtr a pointer to back the RLE'd values into.
 //
-// This will advance the counter, _numAcComp.
+// This will advance acPtr past the values written.
 //
 
 void
-DwaCompressor::LossyDctEncoderBase::rleAc (half* block, unsigned short*& acPtr)
+DwaCompressor::LossyDctEncoderBase::rleAc (
+    const unsigned short* block, unsigned short*& acPtr)
 {
-    int            dctComp   = 1;
-    unsigned short rleSymbol = 0x0;
+    //
+    // Find the non-zero components up front, as a bit mask, so
+    // the runs of 0's can be measured without walking them.
+    //
 
-    while (dctComp < 64)
+    uint64_t nonZero = 0;
+
+#ifdef IMF_HAVE_SSE2
+    for (int i = 0; i < 64; i += 16)
     {
-        int runLen = 1;
+        __m128i lo = _mm_cmpeq_epi16 (
+            _mm_load_si128 ((const __m128i*) (block + i)),
+            _mm_setzero_si128 ());
+        __m128i hi = _mm_cmpeq_epi16 (
+            _mm_load_si128 ((const __m128i*) (block + i + 8)),
+            _mm_setzero_si128 ());
+
+        uint64_t zero =
+            (unsigned) _mm_movemask_epi8 (_mm_packs_epi16 (lo, hi));
+
+        nonZero |= (~zero & 0xffff) << i;
+    }
+#else
+    for (int i = 0; i < 64; ++i)
+        if (block[i] != 0) nonZero |= uint64_t (1) << i;
+#endif /* IMF_HAVE_SSE2 */
+
+    int dctComp = 1;
 
+    while (dctComp < 64)
+    {
         //
         // If we don't have a 0, output verbatim
         //
 
-        if (block[dctComp].bits () != rleSymbol)
+        if ((nonZero >> dctComp) & 1)
         {
-            *acPtr++ = block[dctComp].bits ();
-            _numAcComp++;
+            *acPtr++ = block[dctComp];
 
-            dctComp += runLen;
+            dctComp++;
             continue;
         }
 
@@ -1647,11 +2147,8 @@ DwaCompressor::LossyDctEncoderBase::rleAc (half* block, unsigned short*& acPtr)
         // We're sitting on a 0, so see how big the run is.
         //
 
-        while ((dctComp + runLen < 64) &&
-               (block[dctComp + runLen].bits () == rleSymbol))
-        {
-            runLen++;
-        }
+        uint64_t rest   = nonZero >> dctComp;
+        int      runLen = rest ? lowestSetBit (rest) : 64 - dctComp;
 
         //
         // If the run len is too small, just output verbatim
@@ -1665,13 +2162,7 @@ DwaCompressor::LossyDctEncoderBase::rleAc (half* block, unsigned short*& acPtr)
 
         if (runLen == 1)
         {
-            runLen   = 1;
-            *acPtr++ = block[dctComp].bits ();
-            _numAcComp++;
-
-            //
-            // Using 0xff00 for "end of block"
-            //
+            *acPtr++ = block[dctComp];
         }
         else if (runLen + dctComp == 64)
         {
@@ -1680,7 +2171,6 @@ DwaCompressor::LossyDctEncoderBase::rleAc (half* block, unsigned short*& acPtr)
             //
 
             *acPtr++ = 0xff00;
-            _numAcComp++;
         }
         else
         {
@@ -1689,7 +2179,6 @@ DwaCompressor::LossyDctEncoderBase::rleAc (half* block, unsigned short*& acPtr)
             //
 
             *acPtr++ = 0xff00 | runLen;
-            _numAcComp++;
         }
 
         //
@@ -1801,6 +2290,12 @@ DwaCompressor::compress (
     IMATH_NAMESPACE::Box2i range,
     const char*&           outPtr)
 {
+    IMF_PROBE_SCOPE (
+        compressor_compress,
+        _numScanLines == 32 ? DWAA_COMPRESSION : DWAB_COMPRESSION,
+        inSize,
+        range.min.y);
+
     const char* inDataPtr   = inPtr;
     char*       packedAcEnd = 0;
     char*       packedDcEnd = 0;
@@ -2066,6 +2561,38 @@ DwaCompressor::compress (
         encodedChannels[chan] = true;
     }
 
+    //
+    // The UNKNOWN, AC, DC and RLE data are compressed independently,
+    // so they can be spread over the thread pool. Each is compressed
+    // into its own region of the output buffer, big enough for the
+    // worst case, and they are moved together afterwards.
+    //
+
+    uint64_t acUncompressedSize =
+        *totalAcUncompressedCount * sizeof (unsigned short);
+
+    char* unknownOut = outDataPtr;
+    char* acOut      = unknownOut;
+    char* dcOut      = acOut;
+    char* rleOut     = dcOut;
+
+    if (*unknownUncompressedSize > 0)
+        acOut += compressBound (static_cast<uLong> (*unknownUncompressedSize));
+
+    dcOut = acOut;
+
+    if (*totalAcUncompressedCount > 0)
+        dcOut += std::max (
+            2 * acUncompressedSize + 65536,
+            static_cast<uint64_t> (
+                compressBound (static_cast<uLong> (acUncompressedSize))));
+
+    rleOut = dcOut;
+
+    if (*totalDcUncompressedCount > 0) rleOut += _zip->maxCompressedSize ();
+
+    std::vector<std::function<void ()>> sections;
+
     //
     // Pack the Unknown data into the output buffer first. Instead of
     // just copying it uncompressed, try zlib compression at least.
@@ -2073,21 +2600,24 @@ DwaCompressor::compress (
 
     if (*unknownUncompressedSize > 0)
     {
-        uLong inSize  = static_cast<uLong> (*unknownUncompressedSize);
-        uLong outSize = compressBound (inSize);
-
-        if (Z_OK != ::compress2 (
-                        reinterpret_cast<Bytef*> (outDataPtr),
-                        &outSize,
-                        reinterpret_cast<const Bytef*> (_planarUncBuffer[UNKNOWN]),
-                        inSize,
-                        9))
-        {
-            throw IEX_NAMESPACE::BaseExc ("Data compression (zlib) failed.");
-        }
+        sections.push_back ([&] {
+            uLong inSize  = static_cast<uLong> (*unknownUncompressedSize);
+            uLong outSize = compressBound (inSize);
+
+            if (Z_OK !=
+                ::compress2 (
+                    reinterpret_cast<Bytef*> (unknownOut),
+                    &outSize,
+                    reinterpret_cast<const Bytef*> (_planarUncBuffer[UNKNOWN]),
+                    inSize,
+                    9))
+            {
+                throw IEX_NAMESPACE::BaseExc (
+                    "Data compression (zlib) failed.");
+            }
 
-        outDataPtr += outSize;
-        *unknownCompressedSize = outSize;
+            *unknownCompressedSize = outSize;
+        });
     }
 
     //
@@ -2100,43 +2630,42 @@ DwaCompressor::compress (
 
     if (*totalAcUncompressedCount > 0)
     {
-        switch (_acCompression)
-        {
-            case STATIC_HUFFMAN:
+        sections.push_back ([&] {
+            switch (_acCompression)
+            {
+                case STATIC_HUFFMAN:
 
-                *acCompressedSize = (int) hufCompress (
-                    (unsigned short*) _packedAcBuffer,
-                    (int) *totalAcUncompressedCount,
-                    outDataPtr);
-                break;
+                    *acCompressedSize = (int) hufCompress (
+                        (unsigned short*) _packedAcBuffer,
+                        (int) *totalAcUncompressedCount,
+                        acOut);
+                    break;
 
-            case DEFLATE:
+                case DEFLATE:
 
-            {
-                uLong sourceLen = static_cast<uLong> (*totalAcUncompressedCount * sizeof (unsigned short));
-                uLong destLen = compressBound (sourceLen);
-
-                if (Z_OK !=
-                    ::compress2 (
-                        reinterpret_cast<Bytef*> (outDataPtr),
-                        &destLen,
-                        reinterpret_cast<Bytef*> (_packedAcBuffer),
-                        sourceLen,
-                        9))
                 {
-                    throw IEX_NAMESPACE::InputExc (
-                        "Data compression (zlib) failed.");
-                }
-
-                *acCompressedSize = destLen;
-            }
+                    uLong sourceLen = static_cast<uLong> (acUncompressedSize);
+                    uLong destLen   = compressBound (sourceLen);
+
+                    if (Z_OK != ::compress2 (
+                                    reinterpret_cast<Bytef*> (acOut),
+                                    &destLen,
+                                    reinterpret_cast<Bytef*> (_packedAcBuffer),
+                                    sourceLen,
+                                    9))
+                    {
+                        throw IEX_NAMESPACE::InputExc (
+                            "Data compression (zlib) failed.");
+                    }
 
-            break;
+                    *acCompressedSize = destLen;
+                }
 
-            default: assert (false);
-        }
+                break;
 
-        outDataPtr += *acCompressedSize;
+                default: assert (false);
+            }
+        });
     }
 
     //
@@ -2145,12 +2674,12 @@ DwaCompressor::compress (
 
     if (*totalDcUncompressedCount > 0)
     {
-        *dcCompressedSize = _zip->compress (
-            _packedDcBuffer,
-            (int) (*totalDcUncompressedCount) * sizeof (unsigned short),
-            outDataPtr);
-
-        outDataPtr += *dcCompressedSize;
+        sections.push_back ([&] {
+            *dcCompressedSize = _zip->compress (
+                _packedDcBuffer,
+                (int) (*totalDcUncompressedCount) * sizeof (unsigned short),
+                dcOut);
+        });
     }
 
     //
@@ -2160,27 +2689,46 @@ DwaCompressor::compress (
 
     if (*rleRawSize > 0)
     {
-        *rleUncompressedSize = rleCompress (
-            (int) (*rleRawSize),
-            _planarUncBuffer[RLE],
-            (signed char*) _rleBuffer);
+        sections.push_back ([&] {
+            *rleUncompressedSize = rleCompress (
+                (int) (*rleRawSize),
+                _planarUncBuffer[RLE],
+                (signed char*) _rleBuffer);
+
+            uLong srcLen = static_cast<uLong> (*rleUncompressedSize);
+            uLong dstLen = compressBound (srcLen);
+
+            if (Z_OK != ::compress2 (
+                            reinterpret_cast<Bytef*> (rleOut),
+                            &dstLen,
+                            reinterpret_cast<const Bytef*> (_rleBuffer),
+                            srcLen,
+                            9))
+            {
+                throw IEX_NAMESPACE::BaseExc ("Error compressing RLE'd data.");
+            }
 
-        uLong srcLen = static_cast<uLong> (*rleUncompressedSize);
-        uLong dstLen = compressBound (srcLen);
+            *rleCompressedSize = dstLen;
+        });
+    }
 
-        if (Z_OK != ::compress2 (
-                        reinterpret_cast<Bytef*> (outDataPtr),
-                        &dstLen,
-                        reinterpret_cast<const Bytef*> (_rleBuffer),
-                        srcLen,
-                        9))
-        {
-            throw IEX_NAMESPACE::BaseExc ("Error compressing RLE'd data.");
-        }
+    parallelFor ((int) sections.size (), [&] (int i) { sections[i](); });
 
-        *rleCompressedSize = dstLen;
-        outDataPtr += *rleCompressedSize;
-    }
+    //
+    // Pack the sections together, in order
+    //
+
+    memmove (outDataPtr, unknownOut, *unknownCompressedSize);
+    outDataPtr += *unknownCompressedSize;
+
+    memmove (outDataPtr, acOut, *acCompressedSize);
+    outDataPtr += *acCompressedSize;
+
+    memmove (outDataPtr, dcOut, *dcCompressedSize);
+    outDataPtr += *dcCompressedSize;
+
+    memmove (outDataPtr, rleOut, *rleCompressedSize);
+    outDataPtr += *rleCompressedSize;
 
     //
     // Flip the counters to XDR format
@@ -2226,13 +2774,34 @@ DwaCompressor::uncompressTile (
     return uncompress (inPtr, inSize, range, outPtr);
 }
 
+int
+DwaCompressor::uncompressProxy (
+    const char* inPtr, int inSize, int minY, const char*& outPtr)
+{
+    return uncompress (
+        inPtr,
+        inSize,
+        IMATH_NAMESPACE::Box2i (
+            IMATH_NAMESPACE::V2i (_min[0], minY),
+            IMATH_NAMESPACE::V2i (_max[0], minY + numScanLines () - 1)),
+        outPtr,
+        true);
+}
+
 int
 DwaCompressor::uncompress (
     const char*            inPtr,
     int                    inSize,
     IMATH_NAMESPACE::Box2i range,
-    const char*&           outPtr)
+    const char*&           outPtr,
+    bool                   dcOnly)
 {
+    IMF_PROBE_SCOPE (
+        compressor_uncompress,
+        _numScanLines == 32 ? DWAA_COMPRESSION : DWAB_COMPRESSION,
+        inSize,
+        range.min.y);
+
     int minX = range.min.x;
     int maxX = std::min (range.max.x, _max[0]);
     int minY = range.min.y;
@@ -2390,88 +2959,100 @@ DwaCompressor::uncompress (
 
     setupChannelData (minX, minY, maxX, maxY);
 
+    //
+    // The UNKNOWN, AC, DC and RLE data are compressed independently,
+    // so can be uncompressed in parallel.
+    //
+
+    std::vector<std::function<void ()>> sections;
+
     //
     // Uncompress the UNKNOWN data into _planarUncBuffer[UNKNOWN]
     //
 
     if (unknownCompressedSize > 0)
     {
-        if (unknownUncompressedSize > _planarUncBufferSize[UNKNOWN])
-        {
-            throw IEX_NAMESPACE::InputExc ("Error uncompressing DWA data"
-                                           "(corrupt header).");
-        }
+        sections.push_back ([&] {
+            if (unknownUncompressedSize > _planarUncBufferSize[UNKNOWN])
+            {
+                throw IEX_NAMESPACE::InputExc ("Error uncompressing DWA data"
+                                               "(corrupt header).");
+            }
 
-        uLong inSize = static_cast<uLong> (unknownCompressedSize);
-        uLong outSize = static_cast<uLong> (unknownUncompressedSize);
+            uLong inSize = static_cast<uLong> (unknownCompressedSize);
+            uLong outSize = static_cast<uLong> (unknownUncompressedSize);
 
-        if (Z_OK != ::uncompress (
-                        reinterpret_cast<Bytef*> (_planarUncBuffer[UNKNOWN]),
-                        &outSize,
-                        reinterpret_cast<const Bytef*> (compressedUnknownBuf),
-                        inSize))
-        {
-            throw IEX_NAMESPACE::BaseExc ("Error uncompressing UNKNOWN data.");
-        }
+            if (Z_OK != ::uncompress (
+                            reinterpret_cast<Bytef*> (_planarUncBuffer[UNKNOWN]),
+                            &outSize,
+                            reinterpret_cast<const Bytef*> (compressedUnknownBuf),
+                            inSize))
+            {
+                throw IEX_NAMESPACE::BaseExc ("Error uncompressing UNKNOWN data.");
+            }
+        });
     }
 
     //
-    // Uncompress the AC data into _packedAcBuffer
+    // Uncompress the AC data into _packedAcBuffer, unless we
+    // only want the DC components
     //
 
-    if (acCompressedSize > 0)
+    if (acCompressedSize > 0 && !dcOnly)
     {
-        if (!_packedAcBuffer ||
-            totalAcUncompressedCount * sizeof (unsigned short) >
-                _packedAcBufferSize)
-        {
-            throw IEX_NAMESPACE::InputExc ("Error uncompressing DWA data"
-                                           "(corrupt header).");
-        }
+        sections.push_back ([&] {
+            if (!_packedAcBuffer ||
+                totalAcUncompressedCount * sizeof (unsigned short) >
+                    _packedAcBufferSize)
+            {
+                throw IEX_NAMESPACE::InputExc ("Error uncompressing DWA data"
+                                               "(corrupt header).");
+            }
 
-        //
-        // Don't trust the user to get it right, look in the file.
-        //
+            //
+            // Don't trust the user to get it right, look in the file.
+            //
 
-        switch (acCompression)
-        {
-            case STATIC_HUFFMAN:
+            switch (acCompression)
+            {
+                case STATIC_HUFFMAN:
 
-                hufUncompress (
-                    compressedAcBuf,
-                    (int) acCompressedSize,
-                    (unsigned short*) _packedAcBuffer,
-                    (int) totalAcUncompressedCount);
+                    hufUncompress (
+                        compressedAcBuf,
+                        (int) acCompressedSize,
+                        (unsigned short*) _packedAcBuffer,
+                        (int) totalAcUncompressedCount);
 
-                break;
+                    break;
 
-            case DEFLATE: {
-                uLong destLen = static_cast<uLong> (totalAcUncompressedCount * sizeof (unsigned short));
-                uLong sourceLen = static_cast<uLong> (acCompressedSize);
+                case DEFLATE: {
+                    uLong destLen = static_cast<uLong> (totalAcUncompressedCount * sizeof (unsigned short));
+                    uLong sourceLen = static_cast<uLong> (acCompressedSize);
 
-                if (Z_OK != ::uncompress (
-                                reinterpret_cast<Bytef*> (_packedAcBuffer),
-                                &destLen,
-                                reinterpret_cast<const Bytef*> (compressedAcBuf),
-                                sourceLen))
-                {
-                    throw IEX_NAMESPACE::InputExc (
-                        "Data decompression (zlib) failed.");
-                }
+                    if (Z_OK != ::uncompress (
+                                    reinterpret_cast<Bytef*> (_packedAcBuffer),
+                                    &destLen,
+                                    reinterpret_cast<const Bytef*> (compressedAcBuf),
+                                    sourceLen))
+                    {
+                        throw IEX_NAMESPACE::InputExc (
+                            "Data decompression (zlib) failed.");
+                    }
 
-                if (totalAcUncompressedCount * sizeof (unsigned short) !=
-                    destLen)
-                {
-                    throw IEX_NAMESPACE::InputExc ("AC data corrupt.");
+                    if (totalAcUncompressedCount * sizeof (unsigned short) !=
+                        destLen)
+                    {
+                        throw IEX_NAMESPACE::InputExc ("AC data corrupt.");
+                    }
                 }
-            }
-            break;
+                break;
 
-            default:
+                default:
 
-                throw IEX_NAMESPACE::NoImplExc ("Unknown AC Compression");
-                break;
-        }
+                    throw IEX_NAMESPACE::NoImplExc ("Unknown AC Compression");
+                    break;
+            }
+        });
     }
 
     //
@@ -2480,19 +3061,21 @@ DwaCompressor::uncompress (
 
     if (dcCompressedSize > 0)
     {
-        if (totalDcUncompressedCount * sizeof (unsigned short) >
-            _packedDcBufferSize)
-        {
-            throw IEX_NAMESPACE::InputExc ("Error uncompressing DWA data"
-                                           "(corrupt header).");
-        }
+        sections.push_back ([&] {
+            if (totalDcUncompressedCount * sizeof (unsigned short) >
+                _packedDcBufferSize)
+            {
+                throw IEX_NAMESPACE::InputExc ("Error uncompressing DWA data"
+                                               "(corrupt header).");
+            }
 
-        if (static_cast<uint64_t> (_zip->uncompress (
-                compressedDcBuf, (int) dcCompressedSize, _packedDcBuffer)) !=
-            totalDcUncompressedCount * sizeof (unsigned short))
-        {
-            throw IEX_NAMESPACE::BaseExc ("DC data corrupt.");
-        }
+            if (static_cast<uint64_t> (_zip->uncompress (
+                    compressedDcBuf, (int) dcCompressedSize, _packedDcBuffer)) !=
+                totalDcUncompressedCount * sizeof (unsigned short))
+            {
+                throw IEX_NAMESPACE::BaseExc ("DC data corrupt.");
+            }
+        });
     }
     else
     {
@@ -2510,36 +3093,46 @@ DwaCompressor::uncompress (
 
     if (rleRawSize > 0)
     {
-        if (rleUncompressedSize > _rleBufferSize ||
-            rleRawSize > _planarUncBufferSize[RLE])
-        {
-            throw IEX_NAMESPACE::InputExc ("Error uncompressing DWA data"
-                                           "(corrupt header).");
-        }
+        sections.push_back ([&] {
+            if (rleUncompressedSize > _rleBufferSize ||
+                rleRawSize > _planarUncBufferSize[RLE])
+            {
+                throw IEX_NAMESPACE::InputExc ("Error uncompressing DWA data"
+                                               "(corrupt header).");
+            }
 
-        uLong dstLen = static_cast<uLong> (rleUncompressedSize);
-        uLong srcLen = static_cast<uLong> (rleCompressedSize);
+            uLong dstLen = static_cast<uLong> (rleUncompressedSize);
+            uLong srcLen = static_cast<uLong> (rleCompressedSize);
 
-        if (Z_OK != ::uncompress (
-                        reinterpret_cast<Bytef*> (_rleBuffer),
-                        &dstLen,
-                        reinterpret_cast<const Bytef*> (compressedRleBuf),
-                        srcLen))
-        {
-            throw IEX_NAMESPACE::BaseExc ("Error uncompressing RLE data.");
-        }
+            if (Z_OK != ::uncompress (
+                            reinterpret_cast<Bytef*> (_rleBuffer),
+                            &dstLen,
+                            reinterpret_cast<const Bytef*> (compressedRleBuf),
+                            srcLen))
+            {
+                throw IEX_NAMESPACE::BaseExc ("Error uncompressing RLE data.");
+            }
 
-        if (dstLen != rleUncompressedSize)
-            throw IEX_NAMESPACE::BaseExc ("RLE data corrupted");
+            if (dstLen != rleUncompressedSize)
+                throw IEX_NAMESPACE::BaseExc ("RLE data corrupted");
 
-        if (static_cast<uint64_t> (rleUncompress (
-                (int) rleUncompressedSize,
-                (int) rleRawSize,
-                (signed char*) _rleBuffer,
-                _planarUncBuffer[RLE])) != rleRawSize)
-        {
-            throw IEX_NAMESPACE::BaseExc ("RLE data corrupted");
-        }
+            if (static_cast<uint64_t> (rleUncompress (
+                    (int) rleUncompressedSize,
+                    (int) rleRawSize,
+                    (signed char*) _rleBuffer,
+                    _planarUncBuffer[RLE])) != rleRawSize)
+            {
+                throw IEX_NAMESPACE::BaseExc ("RLE data corrupted");
+            }
+        });
+    }
+
+    parallelFor ((int) sections.size (), [&] (int i) { sections[i](); });
+
+    if (dcOnly)
+    {
+        outPtr = _outBuffer;
+        return uncompressDcOnly (totalDcUncompressedCount);
     }
 
     //
@@ -2767,6 +3360,253 @@ DwaCompressor::uncompress (
     return (int) (outBufferEnd - _outBuffer);
 }
 
+namespace
+{
+
+//
+// Write one pixel of a proxy image, given as half bits, converting
+// to FLOAT if needed
+//
+
+void
+writeProxyPixel (char*& dst, PixelType type, unsigned short bits)
+{
+    if (type == FLOAT)
+    {
+        half h;
+
+        h.setBits (bits);
+        Xdr::write<CharPtrIO> (dst, (float) h);
+    }
+    else
+    {
+        Xdr::write<CharPtrIO> (dst, bits);
+    }
+}
+
+} // namespace
+
+int
+DwaCompressor::uncompressDcOnly (uint64_t totalDcUncompressedCount)
+{
+    size_t                             numChans = _channelData.size ();
+    std::vector<char*>                 planes (numChans);
+    std::vector<const unsigned short*> dcComp (numChans);
+    std::vector<int>                   proxyWidth (numChans);
+    std::vector<int>                   proxyHeight (numChans);
+    std::vector<bool>                  inCscSet (numChans, false);
+
+    char* outBufferEnd = _outBuffer;
+
+    for (size_t chan = 0; chan < numChans; ++chan)
+    {
+        ChannelData* cd = &_channelData[chan];
+
+        proxyWidth[chan]  = (cd->width + 7) / 8;
+        proxyHeight[chan] = (cd->height + 7) / 8;
+
+        planes[chan] = outBufferEnd;
+        outBufferEnd += proxyWidth[chan] * proxyHeight[chan] *
+                        OPENEXR_IMF_NAMESPACE::pixelTypeSize (cd->type);
+    }
+
+    //
+    // Find the DC components of each LOSSY_DCT channel. They are
+    // packed in the order they're decoded by uncompress (): all
+    // the CSC sets, then the remaining channels.
+    //
+
+    const unsigned short* packedDcBegin =
+        reinterpret_cast<const unsigned short*> (_packedDcBuffer);
+    const unsigned short* packedDcEnd = packedDcBegin;
+
+    for (unsigned int csc = 0; csc < _cscSets.size (); ++csc)
+    {
+        int rChan = _cscSets[csc].idx[0];
+
+        for (int comp = 0; comp < 3; ++comp)
+        {
+            int chan = _cscSets[csc].idx[comp];
+
+            if (_channelData[chan].compression != LOSSY_DCT)
+                throw IEX_NAMESPACE::BaseExc (
+                    "Bad DWA compression type detected");
+
+            dcComp[chan]   = packedDcEnd;
+            inCscSet[chan] = true;
+            packedDcEnd += proxyWidth[rChan] * proxyHeight[rChan];
+        }
+    }
+
+    for (size_t chan = 0; chan < numChans; ++chan)
+    {
+        if (_channelData[chan].compression != LOSSY_DCT || inCscSet[chan])
+            continue;
+
+        dcComp[chan] = packedDcEnd;
+        packedDcEnd += proxyWidth[chan] * proxyHeight[chan];
+    }
+
+    if (static_cast<uint64_t> (packedDcEnd - packedDcBegin) >
+        totalDcUncompressedCount)
+    {
+        throw IEX_NAMESPACE::InputExc ("DC data corrupt.");
+    }
+
+    //
+    // A block with only a DC component decodes to a constant, which
+    // we compute just as LossyDctDecoderBase does.
+    //
+
+    for (unsigned int csc = 0; csc < _cscSets.size (); ++csc)
+    {
+        int   rChan     = _cscSets[csc].idx[0];
+        int   numBlocks = proxyWidth[rChan] * proxyHeight[rChan];
+        char* dst[3];
+
+        for (int comp = 0; comp < 3; ++comp)
+            dst[comp] = planes[_cscSets[csc].idx[comp]];
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            float value[3];
+
+            for (int comp = 0; comp < 3; ++comp)
+            {
+                int            chan  = _cscSets[csc].idx[comp];
+                const char*    dcXdr = (const char*) (dcComp[chan] + block);
+                unsigned short dc;
+                half           h;
+
+                Xdr::read<CharPtrIO> (dcXdr, dc);
+                h.setBits (dc);
+
+                value[comp] = (float) h * 3.535536e-01f * 3.535536e-01f;
+            }
+
+            csc709Inverse (value[0], value[1], value[2]);
+
+            for (int comp = 0; comp < 3; ++comp)
+            {
+                int chan = _cscSets[csc].idx[comp];
+
+                writeProxyPixel (
+                    dst[comp],
+                    _channelData[chan].type,
+                    dwaCompressorToLinear[((half) value[comp]).bits ()]);
+            }
+        }
+    }
+
+    for (size_t chan = 0; chan < numChans; ++chan)
+    {
+        ChannelData* cd  = &_channelData[chan];
+        char*        dst = planes[chan];
+        int pixelSize    = OPENEXR_IMF_NAMESPACE::pixelTypeSize (cd->type);
+
+        switch (cd->compression)
+        {
+            case LOSSY_DCT:
+
+                //
+                // Channels in a CSC set are done above
+                //
+
+                if (!inCscSet[chan])
+                {
+                    const unsigned short* toLinear = 0;
+
+                    if (!cd->pLinear) toLinear = dwaCompressorToLinear;
+
+                    int numBlocks = proxyWidth[chan] * proxyHeight[chan];
+
+                    for (int block = 0; block < numBlocks; ++block)
+                    {
+                        const char* dcXdr =
+                            (const char*) (dcComp[chan] + block);
+                        unsigned short dc;
+                        half           h;
+
+                        Xdr::read<CharPtrIO> (dcXdr, dc);
+                        h.setBits (dc);
+
+                        unsigned short bits =
+                            ((half) ((float) h * 3.535536e-01f * 3.535536e-01f))
+                                .bits ();
+
+                        if (toLinear) bits = toLinear[bits];
+
+                        writeProxyPixel (dst, cd->type, bits);
+                    }
+                }
+
+                break;
+
+            case RLE:
+
+                //
+                // Point sample the bytes, which have been un-RLE'd
+                // into planarUncRle[]
+                //
+
+                for (int y = 0; y < cd->height; y += 8)
+                {
+                    for (int x = 0; x < cd->width; x += 8)
+                    {
+                        size_t offset =
+                            static_cast<size_t> (y) * cd->width + x;
+
+                        for (int byte = 0; byte < pixelSize; ++byte)
+                            *dst++ = cd->planarUncRle[byte][offset];
+                    }
+                }
+
+                break;
+
+            case UNKNOWN:
+
+                //
+                // Point sample the data in planarUncBuffer
+                //
+
+                {
+                    int scanlineSize = cd->width * pixelSize;
+
+                    if (cd->planarUncBuffer +
+                            static_cast<size_t> (cd->height) * scanlineSize >
+                        _planarUncBuffer[UNKNOWN] +
+                            _planarUncBufferSize[UNKNOWN])
+                    {
+                        throw IEX_NAMESPACE::InputExc ("DWA data corrupt");
+                    }
+
+                    for (int y = 0; y < cd->height; y += 8)
+                    {
+                        const char* src =
+                            cd->planarUncBuffer +
+                            static_cast<size_t> (y) * scanlineSize;
+
+                        for (int x = 0; x < cd->width; x += 8)
+                        {
+                            memcpy (dst, src + x * pixelSize, pixelSize);
+                            dst += pixelSize;
+                        }
+                    }
+                }
+
+                break;
+
+            default:
+
+                throw IEX_NAMESPACE::NoImplExc (
+                    "Unhandled compression scheme case");
+                break;
+        }
+    }
+
+    return (int) (outBufferEnd - _outBuffer);
+}
+
 // static
 void
 DwaCompressor::initializeFuncs ()
@@ -2786,6 +3626,16 @@ DwaCompressor::initializeFuncs ()
         fromHalfZigZag       = fromHalfZigZag_f16c;
     }
 
+    //
+    // Setup the search for quantized values
+    //
+
+    searchCandidates = searchCandidates_scalar;
+
+#ifdef IMF_DWA_DISPATCH_AVX
+    if (cpuId.avx && cpuId.f16c) searchCandidates = searchCandidates_f16c;
+#endif
+
     //
     // Setup inverse DCT implementations
     //
@@ -2821,6 +3671,17 @@ DwaCompressor::initializeFuncs ()
         dctInverse8x8_6 = dctInverse8x8_sse2<6>;
         dctInverse8x8_7 = dctInverse8x8_sse2<7>;
     }
+
+    //
+    // Setup forward DCT implementations
+    //
+
+    dctForward8x8 = dctForward8x8_scalar;
+
+    if (cpuId.avx)
+        dctForward8x8 = dctForward8x8_avx;
+    else if (cpuId.sse2)
+        dctForward8x8 = dctForward8x8_sse2;
 }
 
 //
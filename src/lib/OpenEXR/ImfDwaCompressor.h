@@ -68,6 +68,23 @@ public:
         IMATH_NAMESPACE::Box2i range,
         const char*&           outPtr);
 
+    //
+    // Proxy decoding: uncompress only the DC components of the lossy
+    // channels, skipping the AC components and the inverse DCT. This
+    // gives an image with 1/8 of the resolution in x and y, for fast
+    // thumbnails, see InputFile::readProxyPixels ().
+    //
+    // Each channel is returned as a separate plane, in channel list
+    // order, of ceil (h / 8) rows of ceil (w / 8) pixels, where w and
+    // h are the number of samples of the channel in the chunk, in Xdr
+    // format. Pixel (x, y) of a lossy channel is the mean of the 8x8
+    // block starting at sample (8x, 8y), other channels are point
+    // sampled at (8x, 8y).
+    //
+
+    int uncompressProxy (
+        const char* inPtr, int inSize, int minY, const char*& outPtr);
+
     static void initializeFuncs ();
 
 private:
@@ -154,7 +171,15 @@ private:
         const char*            inPtr,
         int                    inSize,
         IMATH_NAMESPACE::Box2i range,
-        const char*&           outPtr);
+        const char*&           outPtr,
+        bool                   dcOnly = false);
+
+    //
+    // Write the 1/8 resolution image for uncompressProxy () to
+    // _outBuffer, from the uncompressed DC and lossless data
+    //
+
+    int uncompressDcOnly (uint64_t totalDcUncompressedCount);
 
     void initializeBuffers (size_t&);
     void initializeDefaultChannelRules ();
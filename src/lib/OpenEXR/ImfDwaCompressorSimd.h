@@ -26,6 +26,17 @@
 
 #include <algorithm>
 
+//
+// On x86-64 with GCC / clang, AVX and F16C code can be compiled with
+// function attributes, and selected at runtime.
+//
+
+#if defined(IMF_HAVE_SSE2) && (defined(__x86_64__) || defined(_M_X64)) &&     \
+    (defined(__GNUC__) || defined(__clang__))
+#    define IMF_DWA_DISPATCH_AVX 1
+#    include <immintrin.h>
+#endif
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
 
 #define _SSE_ALIGNMENT 32
@@ -206,6 +217,10 @@ csc709Inverse64 (float* comp0, float* comp1, float* comp2)
 
 //
 // Color space conversion, Forward 709 CSC, R'G'B' -> Y'CbCr
+//
+
+#ifndef IMF_HAVE_SSE2
+
 //
 // Simple FPU color space conversion. Based on the 709
 // primary chromaticies, with no scaling or offsets.
@@ -228,6 +243,52 @@ csc709Forward64 (float* comp0, float* comp1, float* comp2)
     }
 }
 
+#else /* IMF_HAVE_SSE2 */
+
+//
+// SSE2 color space conversion. The products are summed in the
+// same order as the FPU version, so the results are identical.
+//
+
+void
+csc709Forward64 (float* comp0, float* comp1, float* comp2)
+{
+    const __m128 c00 = _mm_set1_ps (0.2126f);
+    const __m128 c01 = _mm_set1_ps (0.7152f);
+    const __m128 c02 = _mm_set1_ps (0.0722f);
+    const __m128 c10 = _mm_set1_ps (-0.1146f);
+    const __m128 c11 = _mm_set1_ps (0.3854f);
+    const __m128 c12 = _mm_set1_ps (0.5000f);
+    const __m128 c20 = _mm_set1_ps (0.5000f);
+    const __m128 c21 = _mm_set1_ps (0.4542f);
+    const __m128 c22 = _mm_set1_ps (0.0458f);
+
+    __m128* r = (__m128*) comp0;
+    __m128* g = (__m128*) comp1;
+    __m128* b = (__m128*) comp2;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        __m128 src0 = r[i];
+        __m128 src1 = g[i];
+        __m128 src2 = b[i];
+
+        r[i] = _mm_add_ps (
+            _mm_add_ps (_mm_mul_ps (c00, src0), _mm_mul_ps (c01, src1)),
+            _mm_mul_ps (c02, src2));
+
+        g[i] = _mm_add_ps (
+            _mm_sub_ps (_mm_mul_ps (c10, src0), _mm_mul_ps (c11, src1)),
+            _mm_mul_ps (c12, src2));
+
+        b[i] = _mm_sub_ps (
+            _mm_sub_ps (_mm_mul_ps (c20, src0), _mm_mul_ps (c21, src1)),
+            _mm_mul_ps (c22, src2));
+    }
+}
+
+#endif /* IMF_HAVE_SSE2 */
+
 //
 // Byte interleaving of 2 byte arrays:
 //    src0 = AAAA
@@ -1756,14 +1817,12 @@ dctInverse8x8_avx (float* data)
 // and be done with it.
 //
 
-#ifndef IMF_HAVE_SSE2
-
 //
 // Default implementation
 //
 
 void
-dctForward8x8 (float* data)
+dctForward8x8_scalar (float* data)
 {
     float A0, A1, A2, A3, A4, A5, A6, A7;
     float K0, K1, rot_x, rot_y;
@@ -1934,8 +1993,6 @@ dctForward8x8 (float* data)
     }
 }
 
-#else /* IMF_HAVE_SSE2 */
-
 //
 // SSE2 implementation
 //
@@ -1945,8 +2002,9 @@ dctForward8x8 (float* data)
 //
 
 void
-dctForward8x8 (float* data)
+dctForward8x8_sse2 (float* data)
 {
+#ifdef IMF_HAVE_SSE2
     __m128* srcVec = (__m128*) data;
     __m128  a0Vec, a1Vec, a2Vec, a3Vec, a4Vec, a5Vec, a6Vec, a7Vec;
     __m128  k0Vec, k1Vec, rotXVec, rotYVec;
@@ -2142,9 +2200,151 @@ dctForward8x8 (float* data)
         srcVec[3] = _mm_shuffle_ps (transTmp2[0], transTmp2[1], 0xDD);
         srcVec[7] = _mm_shuffle_ps (transTmp2[2], transTmp2[3], 0xDD);
     }
+#else  /* IMF_HAVE_SSE2 */
+    dctForward8x8_scalar (data);
+#endif /* IMF_HAVE_SSE2 */
 }
 
-#endif /* IMF_HAVE_SSE2 */
+//
+// AVX implementation
+//
+// The same column-wise passes as the SSE2 version, but on all 8
+// columns at once, followed by a full 8x8 transpose. Each lane
+// sees exactly the same sequence of operations as with SSE2 (in
+// particular, no FMA), so the results are bit identical, which
+// keeps the encoded output independent of the cpu.
+//
+// On x86-64 with GCC / clang, this is compiled for AVX with a
+// function attribute and selected at runtime. Otherwise, it falls
+// back to the SSE2 version.
+//
+
+#ifdef IMF_DWA_DISPATCH_AVX
+
+__attribute__ ((target ("avx"))) void
+dctForward8x8_avx (float* data)
+{
+    __m256 row[8];
+    __m256 a0, a1, a2, a3, a4, a5, a6, a7;
+    __m256 k0, k1, rotX, rotY;
+    __m256 t[8], tt[8];
+
+    const __m256 c4    = _mm256_set1_ps (.70710678f);
+    const __m256 c4Neg = _mm256_set1_ps (-.70710678f);
+
+    const __m256 c1Half = _mm256_set1_ps (.490392640f);
+    const __m256 c2Half = _mm256_set1_ps (.461939770f);
+    const __m256 c3Half = _mm256_set1_ps (.415734810f);
+    const __m256 c5Half = _mm256_set1_ps (.277785120f);
+    const __m256 c6Half = _mm256_set1_ps (.191341720f);
+    const __m256 c7Half = _mm256_set1_ps (.097545161f);
+
+    const __m256 half = _mm256_set1_ps (.5f);
+
+    for (int i = 0; i < 8; ++i)
+        row[i] = _mm256_load_ps (data + 8 * i);
+
+    for (int iter = 0; iter < 2; ++iter)
+    {
+        a0 = _mm256_add_ps (row[0], row[7]);
+        a1 = _mm256_add_ps (row[1], row[2]);
+        a3 = _mm256_add_ps (row[3], row[4]);
+        a5 = _mm256_add_ps (row[5], row[6]);
+
+        a7 = _mm256_sub_ps (row[0], row[7]);
+        a2 = _mm256_sub_ps (row[1], row[2]);
+        a4 = _mm256_sub_ps (row[3], row[4]);
+        a6 = _mm256_sub_ps (row[5], row[6]);
+
+        //
+        // out_0 and out_4
+        //
+
+        k0 = _mm256_mul_ps (c4, _mm256_add_ps (a0, a3));
+        k1 = _mm256_mul_ps (c4, _mm256_add_ps (a1, a5));
+
+        row[0] = _mm256_mul_ps (_mm256_add_ps (k0, k1), half);
+        row[4] = _mm256_mul_ps (_mm256_sub_ps (k0, k1), half);
+
+        //
+        // out_2 and out_6
+        //
+
+        k0 = _mm256_sub_ps (a2, a6);
+        k1 = _mm256_sub_ps (a0, a3);
+
+        row[2] = _mm256_add_ps (
+            _mm256_mul_ps (c6Half, k0), _mm256_mul_ps (c2Half, k1));
+        row[6] = _mm256_sub_ps (
+            _mm256_mul_ps (c6Half, k1), _mm256_mul_ps (c2Half, k0));
+
+        //
+        // out_3 and out_5
+        //
+
+        k0 = _mm256_mul_ps (_mm256_sub_ps (a1, a5), c4);
+        k1 = _mm256_mul_ps (_mm256_add_ps (a2, a6), c4Neg);
+
+        rotX = _mm256_sub_ps (a7, k0);
+        rotY = _mm256_add_ps (a4, k1);
+
+        row[3] = _mm256_sub_ps (
+            _mm256_mul_ps (c3Half, rotX), _mm256_mul_ps (c5Half, rotY));
+        row[5] = _mm256_add_ps (
+            _mm256_mul_ps (c5Half, rotX), _mm256_mul_ps (c3Half, rotY));
+
+        //
+        // out_1 and out_7
+        //
+
+        rotX = _mm256_add_ps (a7, k0);
+        rotY = _mm256_sub_ps (k1, a4);
+
+        row[1] = _mm256_sub_ps (
+            _mm256_mul_ps (c1Half, rotX), _mm256_mul_ps (c7Half, rotY));
+        row[7] = _mm256_add_ps (
+            _mm256_mul_ps (c7Half, rotX), _mm256_mul_ps (c1Half, rotY));
+
+        //
+        // Transpose. After interleaving pairs of rows, then pairs
+        // of those, tt[i] holds the top 4 entries of columns i and
+        // i + 4 in its two halves, and tt[i + 4] the bottom 4.
+        //
+
+        for (int i = 0; i < 8; i += 2)
+        {
+            t[i]     = _mm256_unpacklo_ps (row[i], row[i + 1]);
+            t[i + 1] = _mm256_unpackhi_ps (row[i], row[i + 1]);
+        }
+
+        for (int i = 0; i < 8; i += 4)
+        {
+            tt[i]     = _mm256_shuffle_ps (t[i], t[i + 2], 0x44);
+            tt[i + 1] = _mm256_shuffle_ps (t[i], t[i + 2], 0xEE);
+            tt[i + 2] = _mm256_shuffle_ps (t[i + 1], t[i + 3], 0x44);
+            tt[i + 3] = _mm256_shuffle_ps (t[i + 1], t[i + 3], 0xEE);
+        }
+
+        for (int i = 0; i < 4; ++i)
+        {
+            row[i]     = _mm256_permute2f128_ps (tt[i], tt[i + 4], 0x20);
+            row[i + 4] = _mm256_permute2f128_ps (tt[i], tt[i + 4], 0x31);
+        }
+    }
+
+    for (int i = 0; i < 8; ++i)
+        _mm256_store_ps (data + 8 * i, row[i]);
+}
+
+#else /* IMF_DWA_DISPATCH_AVX */
+
+void
+dctForward8x8_avx (float* data)
+{
+    dctForward8x8_sse2 (data);
+}
+
+#endif /* IMF_DWA_DISPATCH_AVX */
 
 } // namespace
 
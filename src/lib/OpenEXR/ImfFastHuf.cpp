@@ -4,6 +4,7 @@
 //
 
 #include "ImfFastHuf.h"
+#include "ImfSystemSpecific.h"
 #include <Iex.h>
 
 #include <assert.h>
@@ -419,6 +420,45 @@ FastHufDecoder::buildTables (uint64_t* base, uint64_t* offset)
     }
 }
 
+//
+// Build the multi-symbol table from the single symbol one: decode as
+// many codes as fit entirely in the top MULTI_LOOKUP_BITS. The bits
+// following a code are shifted up, and the (unknown) bits shifted in
+// are zero, so a code is only accepted if it is completely contained
+// in the known bits, in which case the unknown bits can't change its
+// decoding.
+//
+
+void
+FastHufDecoder::buildMultiTable ()
+{
+    for (int i = 0; i < 1 << MULTI_LOOKUP_BITS; ++i)
+    {
+        uint64_t symbols = 0;
+        int      count   = 0;
+        int      len     = 0;
+
+        while (count < MULTI_LOOKUP_SYMBOLS)
+        {
+            int idx = (i << (len + TABLE_LOOKUP_BITS - MULTI_LOOKUP_BITS)) &
+                      ((1 << TABLE_LOOKUP_BITS) - 1);
+            int codeLen = _tableCodeLen[idx];
+            int symbol  = _tableSymbol[idx];
+
+            if (codeLen == 0 || codeLen > MULTI_LOOKUP_BITS - len ||
+                symbol == _rleSymbol || symbol > 0xffff)
+                break;
+
+            symbols |= static_cast<uint64_t> (symbol) << (16 * count);
+            len += codeLen;
+            ++count;
+        }
+
+        _tableMulti[i] = (static_cast<uint64_t> (count) << 56) |
+                         (static_cast<uint64_t> (len) << 48) | symbols;
+    }
+}
+
 //
 // For decoding, we're holding onto 2 uint64_t's.
 //
@@ -541,6 +581,62 @@ FastHufDecoder::readBits (
     return (buffer >> bufferNumBits) & ((1 << numBits) - 1);
 }
 
+//
+// On x86-64 with GCC / clang, the decoder is also compiled for BMI2,
+// which provides flag-less variable shifts (shlx / shrx) and bzhi,
+// used throughout the bit buffer handling, and selected at runtime.
+//
+
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(__BMI2__) &&         \
+    (defined(__GNUC__) || defined(__clang__))
+#    define IMF_FASTHUF_DISPATCH_BMI2 1
+#    define IMF_FASTHUF_DECODE_INLINE inline __attribute__ ((always_inline))
+#else
+#    define IMF_FASTHUF_DECODE_INLINE inline
+#endif
+
+void
+FastHufDecoder::decode (
+    const unsigned char* src,
+    int                  numSrcBits,
+    unsigned short*      dst,
+    int                  numDstElems)
+{
+#ifdef IMF_FASTHUF_DISPATCH_BMI2
+    static const bool bmi2 = CpuId ().bmi2;
+
+    if (bmi2)
+    {
+        decodeBmi2 (src, numSrcBits, dst, numDstElems);
+        return;
+    }
+#endif
+
+    decodeGeneric (src, numSrcBits, dst, numDstElems);
+}
+
+void
+FastHufDecoder::decodeGeneric (
+    const unsigned char* src,
+    int                  numSrcBits,
+    unsigned short*      dst,
+    int                  numDstElems)
+{
+    decodeImpl (src, numSrcBits, dst, numDstElems);
+}
+
+#ifdef IMF_FASTHUF_DISPATCH_BMI2
+__attribute__ ((target ("bmi2"))) void
+FastHufDecoder::decodeBmi2 (
+    const unsigned char* src,
+    int                  numSrcBits,
+    unsigned short*      dst,
+    int                  numDstElems)
+{
+    decodeImpl (src, numSrcBits, dst, numDstElems);
+}
+#endif
+
 //
 // Decode using a the 'One-Shift' strategy for decoding, with a
 // small-ish table to accelerate decoding of short codes.
@@ -550,9 +646,12 @@ FastHufDecoder::readBits (
 // need an additional lookup to map id to symbol; we don't need
 // a full 64-bits (so less refilling).
 //
+// For long enough outputs, where the codes are short, first try
+// the multi-symbol table, which outputs several symbols per lookup.
+//
 
-void
-FastHufDecoder::decode (
+IMF_FASTHUF_DECODE_INLINE void
+FastHufDecoder::decodeImpl (
     const unsigned char* src,
     int                  numSrcBits,
     unsigned short*      dst,
@@ -588,11 +687,64 @@ FastHufDecoder::decode (
 
     int dstIdx = 0;
 
+    //
+    // The multi-symbol table only pays for itself with enough output,
+    // and when at least two codes fit in its bits (which is not the
+    // case for noisy data).
+    //
+
+    bool useMulti = numDstElems >= MULTI_MIN_ELEMS &&
+                    2 * _minCodeLength <= MULTI_LOOKUP_BITS;
+
+    if (useMulti) buildMultiTable ();
+
     while (dstIdx < numDstElems)
     {
         int codeLen;
         int symbol;
 
+        if (useMulti)
+        {
+            //
+            // The bits below the valid ones are zero, so comparing
+            // against _tableMin is conservative.
+            //
+
+            while (bufferNumBits >= MULTI_LOOKUP_BITS && _tableMin <= buffer &&
+                   dstIdx + MULTI_LOOKUP_SYMBOLS <= numDstElems)
+            {
+                uint64_t multi =
+                    _tableMulti[buffer >> (64 - MULTI_LOOKUP_BITS)];
+                int      count = static_cast<int> (multi >> 56);
+
+                if (count == 0) break;
+
+                dst[dstIdx]     = static_cast<unsigned short> (multi);
+                dst[dstIdx + 1] = static_cast<unsigned short> (multi >> 16);
+                dst[dstIdx + 2] = static_cast<unsigned short> (multi >> 32);
+                dstIdx += count;
+
+                codeLen = static_cast<int> (multi >> 48) & 0xff;
+                buffer  = buffer << codeLen;
+                bufferNumBits -= codeLen;
+            }
+
+            if (bufferNumBits < TABLE_LOOKUP_BITS)
+            {
+                refill (
+                    buffer,
+                    64 - bufferNumBits,
+                    bufferBack,
+                    bufferBackNumBits,
+                    currByte,
+                    numSrcBits);
+
+                bufferNumBits = 64;
+            }
+
+            if (dstIdx >= numDstElems) break;
+        }
+
         //
         // Test if we can be table accelerated. If so, directly
         // lookup the output symbol. Otherwise, we need to fall
@@ -53,6 +53,16 @@ public:
 
     static const int TABLE_LOOKUP_BITS = 12;
 
+    //
+    // Number of bits in the multi-symbol table, and the maximum number
+    // of symbols decoded by one lookup in it. It is only built when
+    // decoding at least MULTI_MIN_ELEMS values.
+    //
+
+    static const int MULTI_LOOKUP_BITS    = 11;
+    static const int MULTI_LOOKUP_SYMBOLS = 3;
+    static const int MULTI_MIN_ELEMS      = 16384;
+
     FastHufDecoder (
         const char*& table,
         int          numBytes,
@@ -77,6 +87,10 @@ public:
 
 private:
     void buildTables (uint64_t*, uint64_t*);
+    void buildMultiTable ();
+    void decodeImpl (const unsigned char*, int, unsigned short*, int);
+    void decodeGeneric (const unsigned char*, int, unsigned short*, int);
+    void decodeBmi2 (const unsigned char*, int, unsigned short*, int);
     void refill (uint64_t&, int, uint64_t&, int&, const unsigned char*&, int&);
     uint64_t readBits (int, uint64_t&, int&, const char*&);
 
@@ -119,6 +133,21 @@ private:
     int           _tableSymbol[1 << TABLE_LOOKUP_BITS];
     unsigned char _tableCodeLen[1 << TABLE_LOOKUP_BITS];
     uint64_t      _tableMin;
+
+    //
+    // For the common case of short codes, the top MULTI_LOOKUP_BITS
+    // often hold several complete codes. This table holds, for each
+    // value of those bits, up to MULTI_LOOKUP_SYMBOLS symbols decoded
+    // from them, so they can be output with a single lookup:
+    //
+    //     (count << 56) | (total code length << 48) | symbols
+    //
+    // with 16 bits per symbol, the first in the low bits. The RLE
+    // symbol is never included, and a count of 0 means the first
+    // code is not short (or is the RLE symbol).
+    //
+
+    uint64_t _tableMulti[1 << MULTI_LOOKUP_BITS];
 };
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
@@ -85,6 +85,7 @@ struct IMF_EXPORT_TYPE PreviewRgba;
 // streams
 class IMF_EXPORT_TYPE OStream;
 class IMF_EXPORT_TYPE IStream;
+class IMF_EXPORT_TYPE StatelessIStream;
 
 class IMF_EXPORT_TYPE IDManifest;
 class IMF_EXPORT_TYPE CompressedIDManifest;
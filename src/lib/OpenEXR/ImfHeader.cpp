@@ -64,17 +64,20 @@ using IMATH_NAMESPACE::V2i;
 namespace
 {
 
-static int   s_DefaultZipCompressionLevel = 4;
-static float s_DefaultDwaCompressionLevel = 45.f;
+static int   s_DefaultZipCompressionLevel  = 4;
+static float s_DefaultDwaCompressionLevel  = 45.f;
+static int   s_DefaultZstdCompressionLevel = 3;
 
 struct CompressionRecord
 {
     CompressionRecord ()
         : zip_level (s_DefaultZipCompressionLevel)
         , dwa_level (s_DefaultDwaCompressionLevel)
+        , zstd_level (s_DefaultZstdCompressionLevel)
     {}
     int   zip_level;
     float dwa_level;
+    int   zstd_level;
 };
 // NB: This is extra complicated than one would normally write to
 // handle scenario that seems to happen on MacOS/Windows (probably
@@ -268,6 +271,12 @@ setDefaultDwaCompressionLevel (float level)
     s_DefaultDwaCompressionLevel = level;
 }
 
+void
+setDefaultZstdCompressionLevel (int level)
+{
+    s_DefaultZstdCompressionLevel = level;
+}
+
 Header::Header (
     int         width,
     int         height,
@@ -707,6 +716,18 @@ Header::dwaCompressionLevel () const
     return retrieveCompressionRecord (this).dwa_level;
 }
 
+int&
+Header::zstdCompressionLevel ()
+{
+    return retrieveCompressionRecord (this).zstd_level;
+}
+
+int
+Header::zstdCompressionLevel () const
+{
+    return retrieveCompressionRecord (this).zstd_level;
+}
+
 void
 Header::setName (const string& name)
 {
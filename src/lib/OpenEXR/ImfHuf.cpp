@@ -38,6 +38,8 @@ const int HUF_ENCSIZE = (1 << HUF_ENCBITS) + 1; // encoding table size
 const int HUF_DECSIZE = 1 << HUF_DECBITS;       // decoding table size
 const int HUF_DECMASK = HUF_DECSIZE - 1;
 
+const int HUF_SUBTABLE_MIN_COUNT = 16384; // see countFrequencies()
+
 struct HufDec
 { // short code		long code
     //-------------------------------
@@ -179,7 +181,14 @@ hufCanonicalCodeTable (uint64_t hcode[HUF_ENCSIZE])
         n[i] = 0;
 
     for (int i = 0; i < HUF_ENCSIZE; ++i)
-        n[hcode[i]] += 1;
+    {
+        //
+        // Most symbols are usually unused, skip rather than count
+        // them, so the increments of n[0] don't serialize the loop.
+        //
+
+        if (hcode[i] > 0) n[hcode[i]] += 1;
+    }
 
     //
     // For each i from 58 through 1, compute the
@@ -219,25 +228,39 @@ hufCanonicalCodeTable (uint64_t hcode[HUF_ENCSIZE])
 //	- original frequencies are destroyed;
 //	- encoding tables are used by hufEncode() and hufBuildDecTable();
 //
-// NB: The following code "(*a == *b) && (a > b))" was added to ensure
-//     elements in the heap with the same value are sorted by index.
-//     This is to ensure, the STL make_heap()/pop_heap()/push_heap() methods
-//     produced a resultant sorted heap that is identical across OSes.
+// NB: The heap orders equal frequencies by symbol index, so that the
+//     resulting code is identical across OSes (and identical to the
+//     STL make_heap()/pop_heap()/push_heap() of pointers into frq this
+//     replaced).  To make that a single integer comparison, the heap
+//     holds keys of the form (frequency << HUF_KEY_SHIFT) | index,
+//     which leaves 47 bits for the frequency: far more than the number
+//     of values in any chunk.
 //
 
-struct FHeapCompare
+const int      HUF_KEY_SHIFT = 17;
+const uint64_t HUF_KEY_MASK  = (uint64_t (1) << HUF_KEY_SHIFT) - 1;
+
+inline void
+hufHeapSiftDown (uint64_t* heap, int n, int i, uint64_t key)
 {
-    bool operator() (uint64_t* a, uint64_t* b)
+    for (;;)
     {
-        return ((*a > *b) || ((*a == *b) && (a > b)));
+        int c = 2 * i + 1;
+        if (c >= n) break;
+        if (c + 1 < n && heap[c + 1] < heap[c]) ++c;
+        if (key <= heap[c]) break;
+        heap[i] = heap[c];
+        i       = c;
     }
-};
+    heap[i] = key;
+}
 
 void
 hufBuildEncTable (
-    uint64_t* frq, // io: input frequencies [HUF_ENCSIZE], output table
-    int*      im,  //  o: min frq index
-    int*      iM)       //  o: max frq index
+    uint64_t* frq,     // io: input frequencies [HUF_ENCSIZE], output table
+    int*      im,      //  o: min frq index
+    int*      iM,      //  o: max frq index
+    uint32_t* scratch) //  t: scratch space [4 * HUF_ENCSIZE]
 {
     //
     // This function assumes that when it is called, array frq
@@ -245,23 +268,18 @@ hufBuildEncTable (
     // that are to be Huffman-encoded.  (frq[i] contains the number
     // of occurrences of symbol i in the data.)
     //
-    // The loop below does three things:
-    //
-    // 1) Finds the minimum and maximum indices that point
-    //    to non-zero entries in frq:
+    // The loop below finds the minimum and maximum indices that point
+    // to non-zero entries in frq:
     //
     //     frq[im] != 0, and frq[i] == 0 for all i < im
     //     frq[iM] != 0, and frq[i] == 0 for all i > iM
     //
-    // 2) Fills array fHeap with pointers to all non-zero
-    //    entries in frq.
-    //
-    // 3) Initializes array hlink such that hlink[i] == i
-    //    for all array entries.
+    // and fills the heap with the keys of all non-zero entries in
+    // frq.  The heap is built in place at the start of frq, each key
+    // is written at or before the entry it is computed from.
     //
 
-    AutoArray<int, HUF_ENCSIZE>       hlink;
-    AutoArray<uint64_t*, HUF_ENCSIZE> fHeap;
+    uint64_t* heap = frq;
 
     *im = 0;
 
@@ -272,32 +290,26 @@ hufBuildEncTable (
 
     for (int i = *im; i < HUF_ENCSIZE; i++)
     {
-        hlink[i] = i;
-
         if (frq[i])
         {
-            fHeap[nf] = &frq[i];
-            nf++;
-            *iM = i;
+            heap[nf++] = (frq[i] << HUF_KEY_SHIFT) | uint64_t (i);
+            *iM        = i;
         }
     }
 
     //
-    // Add a pseudo-symbol, with a frequency count of 1, to frq;
-    // adjust the fHeap and hlink array accordingly.  Function
-    // hufEncode() uses the pseudo-symbol for run-length encoding.
+    // Add a pseudo-symbol, with a frequency count of 1, to the heap.
+    // Function hufEncode() uses the pseudo-symbol for run-length
+    // encoding.
     //
 
     (*iM)++;
-    frq[*iM]  = 1;
-    fHeap[nf] = &frq[*iM];
-    nf++;
+    heap[nf++] = (uint64_t (1) << HUF_KEY_SHIFT) | uint64_t (*iM);
 
     //
-    // Build an array, scode, such that scode[i] contains the number
-    // of bits assigned to symbol i.  Conceptually this is done by
-    // constructing a tree whose leaves are the symbols with non-zero
-    // frequency:
+    // Compute the number of bits assigned to each symbol.
+    // Conceptually this is done by constructing a tree whose leaves
+    // are the symbols with non-zero frequency:
     //
     //     Make a heap that contains all symbols with a non-zero frequency,
     //     with the least frequent symbol on top.
@@ -313,95 +325,99 @@ hufBuildEncTable (
     // leaf node, the distance between the root and the leaf is the length
     // of the code for the corresponding symbol.
     //
-    // The loop below doesn't actually build the tree; instead we compute
-    // the distances of the leaves from the root on the fly.  When a new
-    // node is added to the heap, then that node's descendants are linked
-    // into a single linear list that starts at the new node, and the code
-    // lengths of the descendants (that is, their distance from the root
-    // of the tree) are incremented by one.
+    // The new node takes the heap slot (index) of the second smallest
+    // entry, so the heap keys stay unique.  Rather than incrementing
+    // the lengths of all the descendants of each new node, the tree
+    // is recorded as parent links, and the depths are computed in a
+    // single pass at the end:
+    //
+    //     node[i]   - the tree node currently stored in heap slot i
+    //                 (i for a leaf, HUF_ENCSIZE + k for the k-th
+    //                 internal node)
+    //     lparent   - the internal node parent of each leaf
+    //     iparent   - the internal node parent of each internal node
     //
 
-    make_heap (&fHeap[0], &fHeap[nf], FHeapCompare ());
+    uint32_t* node    = scratch;
+    uint32_t* iparent = node + HUF_ENCSIZE;
+    uint32_t* lparent = iparent + HUF_ENCSIZE;
+    uint32_t* leaves  = lparent + HUF_ENCSIZE;
+    int       nleaves = nf;
+    uint32_t  nint    = 0;
+
+    for (int i = 0; i < nf; ++i)
+    {
+        uint32_t s = uint32_t (heap[i] & HUF_KEY_MASK);
+        leaves[i]  = s;
+        node[s]    = s;
+    }
 
-    AutoArray<uint64_t, HUF_ENCSIZE> scode;
-    memset (scode, 0, sizeof (uint64_t) * HUF_ENCSIZE);
+    for (int i = nf / 2; i-- > 0;)
+        hufHeapSiftDown (heap, nf, i, heap[i]);
 
     while (nf > 1)
     {
         //
-        // Find the indices, mm and m, of the two smallest non-zero frq
-        // values in fHeap, add the smallest frq to the second-smallest
-        // frq, and remove the smallest frq value from fHeap.
+        // Find the keys of the two smallest frequencies, remove the
+        // smallest, and replace the second smallest with the new node
+        // holding their sum.
         //
 
-        int mm = fHeap[0] - frq;
-        pop_heap (&fHeap[0], &fHeap[nf], FHeapCompare ());
+        uint64_t mm = heap[0];
         --nf;
+        hufHeapSiftDown (heap, nf, 0, heap[nf]);
 
-        int m = fHeap[0] - frq;
-        pop_heap (&fHeap[0], &fHeap[nf], FHeapCompare ());
-
-        frq[m] += frq[mm];
-        push_heap (&fHeap[0], &fHeap[nf], FHeapCompare ());
-
-        //
-        // The entries in scode are linked into lists with the
-        // entries in hlink serving as "next" pointers and with
-        // the end of a list marked by hlink[j] == j.
-        //
-        // Traverse the lists that start at scode[m] and scode[mm].
-        // For each element visited, increment the length of the
-        // corresponding code by one bit. (If we visit scode[j]
-        // during the traversal, then the code for symbol j becomes
-        // one bit longer.)
-        //
-        // Merge the lists that start at scode[m] and scode[mm]
-        // into a single list that starts at scode[m].
-        //
+        uint64_t m = heap[0];
+        uint32_t a = node[mm & HUF_KEY_MASK];
+        uint32_t b = node[m & HUF_KEY_MASK];
 
-        //
-        // Add a bit to all codes in the first list.
-        //
+        if (a < uint32_t (HUF_ENCSIZE))
+            lparent[a] = nint;
+        else
+            iparent[a - HUF_ENCSIZE] = nint;
 
-        for (int j = m; true; j = hlink[j])
-        {
-            scode[j]++;
+        if (b < uint32_t (HUF_ENCSIZE))
+            lparent[b] = nint;
+        else
+            iparent[b - HUF_ENCSIZE] = nint;
 
-            assert (scode[j] <= 58);
+        node[m & HUF_KEY_MASK] = HUF_ENCSIZE + nint++;
 
-            if (hlink[j] == j)
-            {
-                //
-                // Merge the two lists.
-                //
+        hufHeapSiftDown (
+            heap,
+            nf,
+            0,
+            (((m >> HUF_KEY_SHIFT) + (mm >> HUF_KEY_SHIFT)) << HUF_KEY_SHIFT) |
+                (m & HUF_KEY_MASK));
+    }
 
-                hlink[j] = mm;
-                break;
-            }
-        }
+    //
+    // Internal nodes are created after their children, so walking
+    // them from the root down, a node's parent has its depth computed
+    // before the node itself: replace the parent links with depths in
+    // place.  The length of the code for a symbol is then one more
+    // than the depth of its parent.
+    //
 
-        //
-        // Add a bit to all codes in the second list
-        //
+    iparent[nint - 1] = 0;
+    for (uint32_t k = nint - 1; k-- > 0;)
+        iparent[k] = iparent[iparent[k]] + 1;
 
-        for (int j = mm; true; j = hlink[j])
-        {
-            scode[j]++;
+    memset (frq, 0, sizeof (uint64_t) * HUF_ENCSIZE);
 
-            assert (scode[j] <= 58);
+    for (int i = 0; i < nleaves; ++i)
+    {
+        frq[leaves[i]] = iparent[lparent[leaves[i]]] + 1;
 
-            if (hlink[j] == j) break;
-        }
+        assert (frq[leaves[i]] <= 58);
     }
 
     //
     // Build a canonical Huffman code table, replacing the code
-    // lengths in scode with (code, code length) pairs.  Copy the
-    // code table from scode into frq.
+    // lengths in frq with (code, code length) pairs.
     //
 
-    hufCanonicalCodeTable (scode);
-    memcpy (frq, scode, sizeof (uint64_t) * HUF_ENCSIZE);
+    hufCanonicalCodeTable (frq);
 }
 
 //
@@ -665,20 +681,56 @@ hufFreeDecTable (HufDec* hdecod) // io: Decoding table
 // ENCODING
 //
 
-inline void
-outputCode (uint64_t code, uint64_t& c, int& lc, char*& out)
+//
+// The encoder buffers the output bits in a 64-bit word, most
+// significant bit first, and stores a whole word at a time
+// (big-endian).  This produces the same byte stream as outputBits()
+// but avoids a shift and a test per output byte.
+//
+
+struct HufBitWriter
 {
-    outputBits (hufLength (code), hufCode (code), c, lc, out);
-}
+    uint64_t buf;   // pending bits, left aligned
+    int      avail; // unused (low) bits in buf
+    char*    out;
+
+    HufBitWriter (char* o) : buf (0), avail (64), out (o) {}
+
+    //
+    // Append the low nBits (<= 58) of bits, which must be zero above
+    // that, to the output.
+    //
+
+    inline void write (int nBits, uint64_t bits)
+    {
+        if (nBits < avail)
+        {
+            avail -= nBits;
+            buf |= bits << avail;
+        }
+        else
+        {
+            int      rem = nBits - avail;
+            uint64_t v   = buf | (bits >> rem);
+
+            for (int i = 0; i < 8; ++i)
+                out[i] = char (v >> (56 - 8 * i));
+
+            out += 8;
+            // shift in two steps, rem may be 0
+            avail = 64 - rem;
+            buf   = (bits << 1) << (avail - 1);
+        }
+    }
+
+    inline void writeCode (uint64_t code)
+    {
+        write (hufLength (code), hufCode (code));
+    }
+};
 
 inline void
-sendCode (
-    uint64_t  sCode,
-    int       runCount,
-    uint64_t  runCode,
-    uint64_t& c,
-    int&      lc,
-    char*&    out)
+sendCode (HufBitWriter& w, uint64_t sCode, int runCount, uint64_t runCode)
 {
     //
     // Output a run of runCount instances of the symbol sCount.
@@ -690,14 +742,14 @@ sendCode (
     if (hufLength (sCode) + hufLength (runCode) + 8 <
         hufLength (sCode) * runCount)
     {
-        outputCode (sCode, c, lc, out);
-        outputCode (runCode, c, lc, out);
-        outputBits (8, runCount, c, lc, out);
+        w.writeCode (sCode);
+        w.writeCode (runCode);
+        w.write (8, runCount);
     }
     else
     {
         while (runCount-- >= 0)
-            outputCode (sCode, c, lc, out);
+            w.writeCode (sCode);
     }
 }
 
@@ -712,11 +764,10 @@ int hufEncode                     // return: output size (in bits)
      int                   rlc,   // i : rl code
      char*                 out)                   //  o: compressed output buffer
 {
-    char*    outStart = out;
-    uint64_t c        = 0; // bits not yet written to out
-    int      lc       = 0; // number of valid bits in c (LSB)
-    int      s        = in[0];
-    int      cs       = 0;
+    HufBitWriter w (out);
+    uint64_t     runCode = hcode[rlc];
+    int          s       = in[0];
+    int          cs      = 0;
 
     //
     // Loop on input values
@@ -731,7 +782,7 @@ int hufEncode                     // return: output size (in bits)
         if (s == in[i] && cs < 255) { cs++; }
         else
         {
-            sendCode (hcode[s], cs, hcode[rlc], c, lc, out);
+            sendCode (w, hcode[s], cs, runCode);
             cs = 0;
         }
 
@@ -739,14 +790,24 @@ int hufEncode                     // return: output size (in bits)
     }
 
     //
-    // Send remaining code
+    // Send remaining code, and flush the whole bytes left in the
+    // buffer, the final partial byte (if any) is zero padded
     //
 
-    sendCode (hcode[s], cs, hcode[rlc], c, lc, out);
+    sendCode (w, hcode[s], cs, runCode);
+
+    int lc = 64 - w.avail;
+
+    while (lc >= 8)
+    {
+        *w.out++ = char (w.buf >> 56);
+        w.buf <<= 8;
+        lc -= 8;
+    }
 
-    if (lc) *out = (c << (8 - lc)) & 0xff;
+    if (lc) *w.out = char (w.buf >> 56);
 
-    return (out - outStart) * 8 + lc;
+    return (w.out - out) * 8 + lc;
 }
 
 //
@@ -915,18 +976,59 @@ hufDecode (
 
 #if !defined(OPENEXR_IMF_HAVE_LARGE_STACK)
 void
-countFrequencies (uint64_t* freq, const unsigned short data[/*n*/], int n)
+countFrequencies (
+    uint64_t*            freq,
+    uint32_t*            scratch,
+    const unsigned short data[/*n*/],
+    int                  n)
 #else
 void
 countFrequencies (
-    uint64_t freq[HUF_ENCSIZE], const unsigned short data[/*n*/], int n)
+    uint64_t             freq[HUF_ENCSIZE],
+    uint32_t             scratch[4 * HUF_ENCSIZE],
+    const unsigned short data[/*n*/],
+    int                  n)
 #endif
 {
     for (int i = 0; i < HUF_ENCSIZE; ++i)
         freq[i] = 0;
 
-    for (int i = 0; i < n; ++i)
-        ++freq[data[i]];
+    if (n < HUF_SUBTABLE_MIN_COUNT)
+    {
+        for (int i = 0; i < n; ++i)
+            ++freq[data[i]];
+        return;
+    }
+
+    //
+    // Incrementing a single table, a run of equal values (which is
+    // common after the wavelet transform) makes each increment wait
+    // for the previous one to store, so for larger inputs, count in
+    // four interleaved 32-bit sub-tables (in the scratch space,
+    // which is reused by hufBuildEncTable()) and sum them at the end.
+    //
+
+    memset (scratch, 0, 4 * 65536 * sizeof (uint32_t));
+
+    uint32_t* c0 = scratch;
+    uint32_t* c1 = c0 + 65536;
+    uint32_t* c2 = c1 + 65536;
+    uint32_t* c3 = c2 + 65536;
+    int       i  = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        ++c0[data[i]];
+        ++c1[data[i + 1]];
+        ++c2[data[i + 2]];
+        ++c3[data[i + 3]];
+    }
+
+    for (; i < n; ++i)
+        ++c0[data[i]];
+
+    for (int v = 0; v < 65536; ++v)
+        freq[v] = uint64_t (c0[v]) + c1[v] + c2[v] + c3[v];
 }
 
 void
@@ -960,13 +1062,14 @@ hufCompress (const unsigned short raw[], int nRaw, char compressed[])
 {
     if (nRaw == 0) return 0;
 
-    AutoArray<uint64_t, HUF_ENCSIZE> freq;
+    AutoArray<uint64_t, HUF_ENCSIZE>     freq;
+    AutoArray<uint32_t, 4 * HUF_ENCSIZE> scratch;
 
-    countFrequencies (freq, raw, nRaw);
+    countFrequencies (freq, scratch, raw, nRaw);
 
     int im = 0;
     int iM = 0;
-    hufBuildEncTable (freq, &im, &iM);
+    hufBuildEncTable (freq, &im, &iM, scratch);
 
     char* tableStart = compressed + 20;
     char* tableEnd   = tableStart;
@@ -50,6 +50,23 @@ IStream::fileName () const
     return _fileName.c_str ();
 }
 
+StatelessIStream::StatelessIStream ()
+{
+    // empty
+}
+
+StatelessIStream::~StatelessIStream ()
+{
+    // empty
+}
+
+char*
+StatelessIStream::readMemoryMapped (uint64_t, uint64_t)
+{
+    throw IEX_NAMESPACE::InputExc ("Attempt to perform a memory-mapped read "
+                                   "on a file that is not memory mapped.");
+}
+
 OStream::OStream (const char fileName[]) : _fileName (fileName)
 {
     // empty
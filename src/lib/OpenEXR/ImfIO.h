@@ -107,6 +107,75 @@ private:
     std::string _fileName;
 };
 
+//-----------------------------------------------------------
+// class StatelessIStream -- an interface that an IStream can
+// implement in addition to IStream to support stateless reads.
+//
+// Stateless reads take an explicit file offset and do not
+// depend on or change the current reading position, so several
+// threads may issue them at the same time.  The input files
+// look for this interface with dynamic_cast, and if the stream
+// has it, they fetch pixel data without holding the stream's
+// mutex.
+//-----------------------------------------------------------
+
+class IMF_EXPORT_TYPE StatelessIStream
+{
+public:
+    //-----------
+    // Destructor
+    //-----------
+
+    IMF_EXPORT virtual ~StatelessIStream ();
+
+    //-----------------------------------------------------
+    // Does this input stream support stateless reads?  A
+    // stream may implement the interface but not be able
+    // to read statelessly, for instance if it could not
+    // open the file a second time.
+    //-----------------------------------------------------
+
+    virtual bool isStatelessRead () const = 0;
+
+    //-----------------------------------------------------
+    // Stateless read:
+    //
+    // read(buf,sz,offset) reads up to sz bytes, starting
+    // offset bytes from the beginning of the file, and
+    // stores them in buf.  It returns the number of bytes
+    // read, which is less than sz only if the end of the
+    // file was reached.  tellg() is not affected.  If an
+    // I/O error occurs, read(buf,sz,offset) throws an
+    // exception.
+    //-----------------------------------------------------
+
+    virtual int64_t read (void* buf, uint64_t sz, uint64_t offset) = 0;
+
+    //-----------------------------------------------------
+    // Stateless read from a memory-mapped stream:
+    //
+    // readMemoryMapped(sz,offset) returns a pointer to the
+    // sz bytes starting offset bytes from the beginning of
+    // the file, like IStream::readMemoryMapped(), but it
+    // does not use or change the reading position.  A
+    // stream that is memory mapped must implement it.  If
+    // there are less than sz bytes at offset, or if the
+    // stream is not memory-mapped, readMemoryMapped(sz,
+    // offset) throws an exception.
+    //-----------------------------------------------------
+
+    IMF_EXPORT virtual char* readMemoryMapped (uint64_t sz, uint64_t offset);
+
+protected:
+    IMF_EXPORT StatelessIStream ();
+
+private:
+    StatelessIStream (const StatelessIStream&) = delete;
+    StatelessIStream& operator= (const StatelessIStream&) = delete;
+    StatelessIStream (StatelessIStream&&)                 = delete;
+    StatelessIStream& operator= (StatelessIStream&&) = delete;
+};
+
 //-----------------------------------------------------------
 // class OStream -- an abstract base class for output streams
 //-----------------------------------------------------------
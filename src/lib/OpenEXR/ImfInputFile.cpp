@@ -14,6 +14,8 @@
 #include "ImfCheckedArithmetic.h"
 
 #include "ImfChannelList.h"
+#include "ImfDwaCompressor.h"
+#include "ImfFrameBuffer.h"
 #include "ImfInputPartData.h"
 #include "ImfInputStreamMutex.h"
 #include "ImfMisc.h"
@@ -28,14 +30,18 @@
 #include "ImfDeepScanLineInputFile.h"
 
 #include "Iex.h"
+#include "IlmThreadPool.h"
 #include <ImathFun.h>
 #include <half.h>
 
 #include <algorithm>
 #include <fstream>
+#include <memory>
+#include <vector>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
+using ILMTHREAD_NAMESPACE::TaskPriorityScope;
 using IMATH_NAMESPACE::Box2i;
 using IMATH_NAMESPACE::divp;
 using IMATH_NAMESPACE::modp;
@@ -79,6 +85,10 @@ struct InputFile::Data
     InputStreamMutex*   _streamData;
     bool                _deleteStream;
 
+    bool hasTaskPriority; // set by setTaskPriority()
+    int  taskPriority;
+    int  taskWeight;
+
     Data (int numThreads);
     ~Data ();
 
@@ -105,6 +115,9 @@ InputFile::Data::Data (int numThreads)
     , multiPartFile (0)
     , _streamData (0)
     , _deleteStream (false)
+    , hasTaskPriority (false)
+    , taskPriority (0)
+    , taskWeight (1)
 
 {
     // empty
@@ -388,7 +401,7 @@ InputFile::InputFile (const char fileName[], int numThreads)
     OPENEXR_IMF_INTERNAL_NAMESPACE::IStream* is = 0;
     try
     {
-        is = new StdIFStream (fileName);
+        is = new StdStatelessIFStream (fileName);
         readMagicNumberAndVersionField (*is, _data->version);
 
         //
@@ -673,14 +686,23 @@ InputFile::initialize ()
 #include <iostream>
 InputFile::~InputFile ()
 {
-    if (_data->_deleteStream) delete _data->_streamData->is;
+    //
+    // The scan line and tiled readers decode through the stream's
+    // OpenEXRCore context, so they go before the stream.
+    //
+
+    InputStreamMutex* streamData = _data->_streamData;
+    IStream* is = _data->_deleteStream && streamData ? streamData->is : 0;
 
     // unless this file was opened via the multipart API,
     // delete the streamData object too
-    if (_data->partNumber == -1 && _data->_streamData)
-        delete _data->_streamData;
+    bool ownsStreamData = _data->partNumber == -1;
 
-    if (_data) delete _data;
+    delete _data;
+
+    if (ownsStreamData) delete streamData;
+
+    delete is;
 }
 
 const char*
@@ -882,20 +904,36 @@ InputFile::isOptimizationEnabled () const
 void
 InputFile::readPixels (int scanLine1, int scanLine2)
 {
-    if (_data->compositor)
-    {
-        _data->compositor->readPixels (scanLine1, scanLine2);
-    }
-    else if (_data->isTiled)
-    {
+    auto read = [&] () {
+        if (_data->compositor)
+        {
+            _data->compositor->readPixels (scanLine1, scanLine2);
+        }
+        else if (_data->isTiled)
+        {
 #if ILMTHREAD_THREADING_ENABLED
-        std::lock_guard<std::mutex> lock (*_data);
+            std::lock_guard<std::mutex> lock (*_data);
 #endif
-        bufferedReadPixels (_data, scanLine1, scanLine2);
+            bufferedReadPixels (_data, scanLine1, scanLine2);
+        }
+        else
+        {
+            _data->sFile->readPixels (scanLine1, scanLine2);
+        }
+    };
+
+    if (_data->hasTaskPriority)
+    {
+        //
+        // The task groups of the readers pick up the priority
+        //
+
+        TaskPriorityScope scope (_data->taskPriority, _data->taskWeight);
+        read ();
     }
     else
     {
-        _data->sFile->readPixels (scanLine1, scanLine2);
+        read ();
     }
 }
 
@@ -905,6 +943,188 @@ InputFile::readPixels (int scanLine)
     readPixels (scanLine, scanLine);
 }
 
+void
+InputFile::setTaskPriority (int priority, int weight)
+{
+    _data->hasTaskPriority = true;
+    _data->taskPriority    = priority;
+    _data->taskWeight      = weight;
+}
+
+void
+InputFile::readProxyPixels (const FrameBuffer& frameBuffer)
+{
+    try
+    {
+        Compression comp = _data->header.compression ();
+
+        if (_data->dsFile || _data->isTiled ||
+            (comp != DWAA_COMPRESSION && comp != DWAB_COMPRESSION))
+        {
+            throw IEX_NAMESPACE::ArgExc (
+                "Proxy images can only be read from DWAA or DWAB "
+                "compressed scan line images.");
+        }
+
+        const ChannelList& channels = _data->header.channels ();
+        const Box2i&       dw       = _data->header.dataWindow ();
+        int                width    = dw.max.x - dw.min.x + 1;
+        int                proxyW   = (width + 7) / 8;
+
+        //
+        // Offset of each channel in an uncompressed scan line,
+        // and of its plane in a proxy row of pixels
+        //
+
+        std::vector<size_t> lineOffset;
+        std::vector<size_t> proxyOffset;
+        size_t              lineSize      = 0;
+        size_t              proxyLineSize = 0;
+
+        for (ChannelList::ConstIterator i = channels.begin ();
+             i != channels.end ();
+             ++i)
+        {
+            if (i.channel ().xSampling != 1 || i.channel ().ySampling != 1)
+            {
+                throw IEX_NAMESPACE::ArgExc (
+                    "Proxy images cannot be read from images with "
+                    "subsampled channels.");
+            }
+
+            int pixelSize = pixelTypeSize (i.channel ().type);
+
+            lineOffset.push_back (lineSize);
+            proxyOffset.push_back (proxyLineSize);
+            lineSize += width * pixelSize;
+            proxyLineSize += proxyW * pixelSize;
+        }
+
+        int linesInChunk = numLinesInBuffer (comp);
+
+        std::unique_ptr<Compressor> compressor (
+            newCompressor (comp, lineSize, _data->header));
+
+        DwaCompressor*    dwa = static_cast<DwaCompressor*> (compressor.get ());
+        std::vector<char> packed;
+        std::vector<char> sampled;
+
+        for (int y = dw.min.y; y <= dw.max.y; y += linesInChunk)
+        {
+            int numLines   = std::min (linesInChunk, dw.max.y - y + 1);
+            int proxyLines = (numLines + 7) / 8;
+            int proxyY     = (y - dw.min.y) / 8;
+
+            const char* pixelData;
+            int         pixelDataSize;
+
+            _data->sFile->rawPixelData (y, pixelData, pixelDataSize);
+
+            //
+            // The proxy holds one plane per channel, of proxyLines
+            // rows of proxyW pixels
+            //
+
+            const char* proxy;
+
+            if (static_cast<size_t> (pixelDataSize) < lineSize * numLines)
+            {
+                //
+                // The compressor rewrites the chunk's header in place,
+                // and the raw data may be a read-only memory mapping
+                //
+
+                packed.assign (pixelData, pixelData + pixelDataSize);
+                dwa->uncompressProxy (
+                    packed.data (), pixelDataSize, y, proxy);
+            }
+            else
+            {
+                //
+                // The chunk is stored uncompressed, sample it
+                //
+
+                sampled.resize (proxyLineSize * proxyLines);
+
+                char* out = sampled.data ();
+                int   c   = 0;
+
+                for (ChannelList::ConstIterator i = channels.begin ();
+                     i != channels.end ();
+                     ++i, ++c)
+                {
+                    int pixelSize = pixelTypeSize (i.channel ().type);
+
+                    for (int py = 0; py < proxyLines; ++py)
+                    {
+                        const char* in =
+                            pixelData + 8 * py * lineSize + lineOffset[c];
+
+                        for (int px = 0; px < proxyW; ++px)
+                        {
+                            memcpy (out, in + 8 * px * pixelSize, pixelSize);
+                            out += pixelSize;
+                        }
+                    }
+                }
+
+                proxy = sampled.data ();
+            }
+
+            for (FrameBuffer::ConstIterator j = frameBuffer.begin ();
+                 j != frameBuffer.end ();
+                 ++j)
+            {
+                const Slice&                 slice = j.slice ();
+                ChannelList::ConstIterator   i     = channels.begin ();
+                size_t                       plane = 0;
+                int                          c     = 0;
+
+                for (; i != channels.end (); ++i, ++c)
+                {
+                    if (!strcmp (i.name (), j.name ()))
+                    {
+                        plane = proxyOffset[c] * proxyLines;
+                        break;
+                    }
+                }
+
+                bool      fill   = (i == channels.end ());
+                PixelType inType = fill ? slice.type : i.channel ().type;
+
+                for (int py = 0; py < proxyLines; ++py)
+                {
+                    const char* readPtr = proxy + plane +
+                                          py * proxyW * pixelTypeSize (inType);
+                    char* writePtr =
+                        slice.base + (proxyY + py) * slice.yStride;
+                    char* endPtr = writePtr + (proxyW - 1) * slice.xStride;
+
+                    copyIntoFrameBuffer (
+                        readPtr,
+                        writePtr,
+                        endPtr,
+                        slice.xStride,
+                        fill,
+                        slice.fillValue,
+                        Compressor::XDR,
+                        slice.type,
+                        inType);
+                }
+            }
+        }
+    }
+    catch (IEX_NAMESPACE::BaseExc& e)
+    {
+        REPLACE_EXC (
+            e,
+            "Error reading proxy pixel data from image "
+            "file \""
+                << fileName () << "\". " << e.what ());
+        throw;
+    }
+}
+
 void
 InputFile::rawPixelData (
     int firstScanLine, const char*& pixelData, int& pixelDataSize)
@@ -154,6 +154,43 @@ public:
     IMF_EXPORT
     void readPixels (int scanLine);
 
+    //---------------------------------------------------------------
+    // Set the priority and fairness weight of the tasks that
+    // readPixels() adds to the global thread pool, overriding
+    // those of the calling thread (see IlmThread::TaskGroup::
+    // setPriority() and IlmThread::TaskPriorityScope).  They only
+    // matter with a thread pool provider that schedules by
+    // priority, such as IlmThread::PriorityThreadPoolProvider.
+    //---------------------------------------------------------------
+
+    IMF_EXPORT
+    void setTaskPriority (int priority, int weight = 1);
+
+    //---------------------------------------------------------------
+    // Read a proxy image, for instance for a thumbnail:
+    //
+    // readProxyPixels(frameBuffer) reads the whole data window of a
+    // DWAA or DWAB compressed scan line file at 1/8 of its resolution
+    // in x and y, and stores it in frameBuffer.  Only the DC
+    // components of the lossy channels are uncompressed, which is
+    // much faster than readPixels().
+    //
+    // For a data window of w by h pixels, the slices of frameBuffer
+    // are addressed with proxy coordinates from (0, 0) to
+    // ((w + 7) / 8 - 1, (h + 7) / 8 - 1).  Proxy pixel (x, y) of a
+    // lossy channel is the mean of the 8 by 8 pixels starting at
+    // (8 * x, 8 * y) relative to the corner of the data window;
+    // other channels, and chunks the file stores uncompressed, give
+    // the pixel at that position.
+    //
+    // Other compression methods, tiled and deep files and channels
+    // with x or y sampling other than 1 are not supported, and
+    // throw an ArgExc.  The current frame buffer is not changed.
+    //---------------------------------------------------------------
+
+    IMF_EXPORT
+    void readProxyPixels (const FrameBuffer& frameBuffer);
+
     //----------------------------------------------
     // Read a block of raw pixel data from the file,
     // without uncompressing it (this function is
@@ -70,6 +70,18 @@ InputPart::readPixels (int scanLine)
     file->readPixels (scanLine);
 }
 
+void
+InputPart::setTaskPriority (int priority, int weight)
+{
+    file->setTaskPriority (priority, weight);
+}
+
+void
+InputPart::readProxyPixels (const FrameBuffer& frameBuffer)
+{
+    file->readProxyPixels (frameBuffer);
+}
+
 void
 InputPart::rawPixelData (
     int firstScanLine, const char*& pixelData, int& pixelDataSize)
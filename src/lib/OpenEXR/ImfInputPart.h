@@ -41,6 +41,10 @@ public:
     IMF_EXPORT
     void readPixels (int scanLine);
     IMF_EXPORT
+    void setTaskPriority (int priority, int weight = 1);
+    IMF_EXPORT
+    void readProxyPixels (const FrameBuffer& frameBuffer);
+    IMF_EXPORT
     void rawPixelData (
         int firstScanLine, const char*& pixelData, int& pixelDataSize);
 
@@ -0,0 +1,224 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#include "ImfInputStreamMutex.h"
+#include "Iex.h"
+#include "ImfIO.h"
+#include "ImfNamespace.h"
+
+#include "openexr.h"
+
+#include <climits>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+namespace
+{
+
+int64_t
+istreamRead (
+    exr_const_context_t         ctxt,
+    void*                       userdata,
+    void*                       buffer,
+    uint64_t                    sz,
+    uint64_t                    offset,
+    exr_stream_error_func_ptr_t error_cb)
+{
+    InputStreamMutex* streamData = static_cast<InputStreamMutex*> (userdata);
+    IStream*          is         = streamData->is;
+
+    //
+    // Exceptions must not escape into OpenEXRCore, so every
+    // failure is reported through error_cb.
+    //
+
+    try
+    {
+        StatelessIStream* sis = streamData->statelessStream ();
+        if (sis) return sis->read (buffer, sz, offset);
+
+        if (sz > static_cast<uint64_t> (INT_MAX))
+        {
+            error_cb (
+                ctxt, EXR_ERR_READ_IO, "Read request too large for stream");
+            return -1;
+        }
+
+#if ILMTHREAD_THREADING_ENABLED
+        std::lock_guard<std::mutex> lock (*streamData);
+#endif
+        if (is->tellg () != offset) is->seekg (offset);
+
+        try
+        {
+            is->read (static_cast<char*> (buffer), static_cast<int> (sz));
+        }
+        catch (...)
+        {
+            //
+            // IStream::read() throws when the stream holds fewer
+            // than sz bytes.  OpenEXRCore asks for more than is left
+            // while reading the header, so report a short read if
+            // the stream can tell how far it got.
+            //
+
+            is->clear ();
+
+            uint64_t pos = is->tellg ();
+            if (pos < offset || pos >= offset + sz) throw;
+
+            return static_cast<int64_t> (pos - offset);
+        }
+
+        return static_cast<int64_t> (sz);
+    }
+    catch (std::exception& e)
+    {
+        error_cb (ctxt, EXR_ERR_READ_IO, "%s", e.what ());
+    }
+    catch (...)
+    {
+        error_cb (ctxt, EXR_ERR_READ_IO, "unrecognized exception");
+    }
+
+    return -1;
+}
+
+exr_result_t
+readMemoryMappedChunk (exr_decode_pipeline_t* decode)
+{
+    void* userdata = nullptr;
+    if (exr_get_user_data (decode->context, &userdata) != EXR_ERR_SUCCESS)
+        return EXR_ERR_INVALID_ARGUMENT;
+
+    InputStreamMutex* streamData = static_cast<InputStreamMutex*> (userdata);
+    IStream*          is         = streamData->is;
+    StatelessIStream* sis        = streamData->statelessStream ();
+
+    const exr_chunk_info_t& chunk = decode->chunk;
+
+    if (chunk.packed_size > static_cast<uint64_t> (INT_MAX))
+        return EXR_ERR_READ_IO;
+
+    //
+    // The packed buffer points into the mapping; a zero
+    // allocation size keeps OpenEXRCore from freeing it.
+    // If the previous chunk was stored uncompressed, the
+    // unpacked buffer points there too.
+    //
+
+    if (decode->unpacked_buffer == decode->packed_buffer &&
+        decode->unpacked_alloc_size == 0)
+        decode->unpacked_buffer = nullptr;
+
+    try
+    {
+        if (sis)
+        {
+            //
+            // Getting a pointer into the mapping does not touch
+            // the reading position, so no lock is needed.
+            //
+
+            decode->packed_buffer =
+                sis->readMemoryMapped (chunk.packed_size, chunk.data_offset);
+        }
+        else
+        {
+#if ILMTHREAD_THREADING_ENABLED
+            std::lock_guard<std::mutex> lock (*streamData);
+#endif
+            is->seekg (chunk.data_offset);
+            decode->packed_buffer =
+                is->readMemoryMapped (static_cast<int> (chunk.packed_size));
+        }
+        decode->packed_alloc_size = 0;
+    }
+    catch (...)
+    {
+        decode->packed_buffer     = nullptr;
+        decode->packed_alloc_size = 0;
+        return EXR_ERR_READ_IO;
+    }
+
+    return EXR_ERR_SUCCESS;
+}
+
+void
+silentErrorHandler (exr_const_context_t, exr_result_t, const char*)
+{
+    //
+    // The C++ readers turn error codes into exceptions;
+    // OpenEXRCore should not print anything itself.
+    //
+}
+
+} // namespace
+
+InputStreamMutex::~InputStreamMutex ()
+{
+    if (_coreContext) exr_finish (&_coreContext);
+}
+
+exr_const_context_t
+InputStreamMutex::coreContext ()
+{
+#if ILMTHREAD_THREADING_ENABLED
+    std::call_once (_coreContextOnce, [this] () { openCoreContext (); });
+#else
+    if (!_coreContext) openCoreContext ();
+#endif
+    return _coreContext;
+}
+
+StatelessIStream*
+InputStreamMutex::statelessStream () const
+{
+    StatelessIStream* sis = dynamic_cast<StatelessIStream*> (is);
+    return (sis && sis->isStatelessRead ()) ? sis : nullptr;
+}
+
+void
+InputStreamMutex::useMemoryMappedChunks (exr_decode_pipeline_t& decoder)
+{
+    void* userdata = nullptr;
+    if (exr_get_user_data (decoder.context, &userdata) != EXR_ERR_SUCCESS)
+        return;
+
+    InputStreamMutex* streamData = static_cast<InputStreamMutex*> (userdata);
+    if (!streamData->is->isMemoryMapped ()) return;
+
+    decoder.read_fn = &readMemoryMappedChunk;
+}
+
+void
+InputStreamMutex::openCoreContext ()
+{
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+
+    cinit.user_data        = this;
+    cinit.read_fn          = &istreamRead;
+    cinit.error_handler_fn = &silentErrorHandler;
+    cinit.flags            = EXR_CONTEXT_FLAG_SILENT_HEADER_PARSE;
+
+    const char* fileName = is->fileName ();
+    if (!fileName || fileName[0] == '\0') fileName = "(stream)";
+
+    exr_context_t ctxt = nullptr;
+    exr_result_t  rv   = exr_start_read (&ctxt, fileName, &cinit);
+
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        THROW (
+            IEX_NAMESPACE::InputExc,
+            "Cannot read the image file \""
+                << fileName << "\" with OpenEXRCore: "
+                << exr_get_default_error_message (rv));
+    }
+
+    _coreContext = ctxt;
+}
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
@@ -10,6 +10,9 @@
 
 #include "IlmThreadConfig.h"
 
+#include "openexr_context.h"
+#include "openexr_decode.h"
+
 #if ILMTHREAD_THREADING_ENABLED
 #    include <mutex>
 #endif
@@ -26,6 +29,52 @@ struct InputStreamMutex
 {
     OPENEXR_IMF_INTERNAL_NAMESPACE::IStream* is              = nullptr;
     uint64_t                                 currentPosition = 0;
+
+    InputStreamMutex () = default;
+    ~InputStreamMutex ();
+
+    InputStreamMutex (const InputStreamMutex& other)            = delete;
+    InputStreamMutex& operator= (const InputStreamMutex& other) = delete;
+    InputStreamMutex (InputStreamMutex&& other)                 = delete;
+    InputStreamMutex& operator= (InputStreamMutex&& other)      = delete;
+
+    //
+    // An OpenEXRCore context that reads from is, opened the
+    // first time it is asked for.  The context reads chunks at
+    // explicit offsets: with stateless reads if the stream
+    // supports them, and otherwise by seeking and reading with
+    // this mutex held, so the caller must not hold the mutex.
+    // Throws if the stream cannot be opened as an OpenEXR file.
+    //
+
+    exr_const_context_t coreContext ();
+
+    //
+    // is as a StatelessIStream, if it implements that interface
+    // and supports stateless reads, otherwise nullptr.
+    //
+
+    OPENEXR_IMF_INTERNAL_NAMESPACE::StatelessIStream* statelessStream () const;
+
+    //
+    // Called right after initializing decoder on a context
+    // returned by coreContext().  If the context's stream is
+    // memory mapped, makes decoder uncompress its chunks
+    // straight from the mapping instead of copying them into
+    // the pipeline's own buffer first.  If the stream also
+    // supports stateless reads, the chunks are found in the
+    // mapping without holding this mutex.
+    //
+
+    static void useMemoryMappedChunks (exr_decode_pipeline_t& decoder);
+
+private:
+    void openCoreContext ();
+
+    exr_context_t _coreContext = nullptr;
+#if ILMTHREAD_THREADING_ENABLED
+    std::once_flag _coreContextOnce;
+#endif
 };
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
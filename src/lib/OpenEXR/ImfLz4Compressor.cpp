@@ -0,0 +1,132 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+//-----------------------------------------------------------------------------
+//
+//	class Lz4Compressor
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfLz4Compressor.h"
+#include "Iex.h"
+#include "ImfCheckedArithmetic.h"
+#include "ImfNamespace.h"
+#include "ImfProbe.h"
+#include "ImfZip.h"
+
+#include "OpenEXRConfigInternal.h"
+
+#ifdef OPENEXR_HAVE_LZ4
+#    include <lz4.h>
+#endif
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+Lz4Compressor::Lz4Compressor (
+    const Header& hdr, size_t maxScanLineSize, size_t numScanLines)
+    : Compressor (hdr)
+    , _numScanLines (numScanLines)
+    , _maxRawSize (uiMult (maxScanLineSize, numScanLines))
+    , _maxCompressedSize (0)
+    , _tmpBuffer (0)
+    , _outBuffer (0)
+{
+#ifdef OPENEXR_HAVE_LZ4
+    if (_maxRawSize > static_cast<size_t> (LZ4_MAX_INPUT_SIZE))
+        throw IEX_NAMESPACE::ArgExc ("Chunk too large for lz4 compression.");
+
+    _maxCompressedSize = LZ4_compressBound (static_cast<int> (_maxRawSize));
+    _tmpBuffer         = new char[_maxRawSize];
+    _outBuffer         = new char[_maxCompressedSize];
+#else
+    throw IEX_NAMESPACE::ArgExc (
+        "LZ4 compression is not supported by this build of the library.");
+#endif
+}
+
+Lz4Compressor::~Lz4Compressor ()
+{
+    delete[] _tmpBuffer;
+    delete[] _outBuffer;
+}
+
+int
+Lz4Compressor::numScanLines () const
+{
+    return _numScanLines;
+}
+
+int
+Lz4Compressor::compress (
+    const char* inPtr, int inSize, int minY, const char*& outPtr)
+{
+    IMF_PROBE_SCOPE (compressor_compress, LZ4_COMPRESSION, inSize, minY);
+
+    //
+    // Special case - empty input buffer
+    //
+
+    if (inSize == 0)
+    {
+        outPtr = _outBuffer;
+        return 0;
+    }
+
+#ifdef OPENEXR_HAVE_LZ4
+    Zip::predict (inPtr, inSize, _tmpBuffer);
+
+    int outSize = LZ4_compress_default (
+        _tmpBuffer,
+        _outBuffer,
+        inSize,
+        static_cast<int> (_maxCompressedSize));
+
+    if (outSize <= 0)
+        throw IEX_NAMESPACE::BaseExc ("Data compression (lz4) failed.");
+
+    outPtr = _outBuffer;
+    return outSize;
+#else
+    (void) inPtr;
+    throw IEX_NAMESPACE::ArgExc (
+        "LZ4 compression is not supported by this build of the library.");
+#endif
+}
+
+int
+Lz4Compressor::uncompress (
+    const char* inPtr, int inSize, int minY, const char*& outPtr)
+{
+    IMF_PROBE_SCOPE (compressor_uncompress, LZ4_COMPRESSION, inSize, minY);
+
+    //
+    // Special case - empty input buffer
+    //
+
+    if (inSize == 0)
+    {
+        outPtr = _outBuffer;
+        return 0;
+    }
+
+#ifdef OPENEXR_HAVE_LZ4
+    int outSize = LZ4_decompress_safe (
+        inPtr, _tmpBuffer, inSize, static_cast<int> (_maxRawSize));
+
+    if (outSize < 0)
+        throw IEX_NAMESPACE::InputExc ("Data decompression (lz4) failed.");
+
+    if (outSize > 0) Zip::unpredict (_tmpBuffer, outSize, _outBuffer);
+
+    outPtr = _outBuffer;
+    return outSize;
+#else
+    (void) inPtr;
+    throw IEX_NAMESPACE::ArgExc (
+        "LZ4 compression is not supported by this build of the library.");
+#endif
+}
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
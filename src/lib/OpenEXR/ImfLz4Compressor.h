@@ -0,0 +1,56 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_LZ4_COMPRESSOR_H
+#define INCLUDED_IMF_LZ4_COMPRESSOR_H
+
+//-----------------------------------------------------------------------------
+//
+//	class Lz4Compressor -- applies the same byte reordering and
+//	predictor as ZipCompressor, then compresses with lz4
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfNamespace.h"
+
+#include "ImfCompressor.h"
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+class Lz4Compressor : public Compressor
+{
+public:
+    //
+    // Throws an ArgExc if the library was built without lz4
+    //
+    Lz4Compressor (
+        const Header& hdr, size_t maxScanLineSize, size_t numScanLines);
+
+    virtual ~Lz4Compressor ();
+
+    Lz4Compressor (const Lz4Compressor& other)            = delete;
+    Lz4Compressor& operator= (const Lz4Compressor& other) = delete;
+    Lz4Compressor (Lz4Compressor&& other)                 = delete;
+    Lz4Compressor& operator= (Lz4Compressor&& other)      = delete;
+
+    virtual int numScanLines () const;
+
+    virtual int
+    compress (const char* inPtr, int inSize, int minY, const char*& outPtr);
+
+    virtual int
+    uncompress (const char* inPtr, int inSize, int minY, const char*& outPtr);
+
+private:
+    int    _numScanLines;
+    size_t _maxRawSize;
+    size_t _maxCompressedSize;
+    char*  _tmpBuffer;
+    char*  _outBuffer;
+};
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
@@ -257,6 +257,18 @@ numLinesInBuffer (Compressor* compressor)
     return compressor ? compressor->numScanLines () : 1;
 }
 
+bool
+coreCanUncompress (Compression comp)
+{
+    switch (comp)
+    {
+        case DWAA_COMPRESSION:
+        case DWAB_COMPRESSION: return false;
+
+        default: return true;
+    }
+}
+
 void
 copyIntoFrameBuffer (
     const char*&       readPtr,
@@ -1981,4 +1993,231 @@ getChunkOffsetTableSize (const Header& header)
         return getTiledChunkOffsetTableSize (header);
 }
 
+namespace
+{
+
+//
+// The longest chunk leader: part number, tile coordinates and
+// levels, and the three sizes of a deep chunk
+//
+
+const uint64_t maxChunkLeaderSize = 44;
+
+//
+// How many chunks in a row to read before trusting
+// that the first one was found
+//
+
+const int chunkChainLength = 8;
+
+//
+// Read the leader of the chunk at position pos of stream is.  If it
+// looks like a chunk leader, return true and the position of the
+// chunk after it.
+//
+
+bool
+readChunkLeader (
+    OPENEXR_IMF_INTERNAL_NAMESPACE::IStream& is,
+    uint64_t                                 pos,
+    bool                                     isMultiPart,
+    const vector<std::string>&               partTypes,
+    uint64_t&                                next)
+{
+    try
+    {
+        is.seekg (pos);
+
+        int partNumber = 0;
+
+        if (isMultiPart) Xdr::read<StreamIO> (is, partNumber);
+
+        if (partNumber < 0 || partNumber >= int (partTypes.size ()))
+            return false;
+
+        const std::string& type = partTypes[partNumber];
+
+        if (isTiled (type))
+        {
+            int coordinates[4];
+
+            for (int i = 0; i < 4; ++i)
+            {
+                Xdr::read<StreamIO> (is, coordinates[i]);
+                if (coordinates[i] < 0) return false;
+            }
+
+            if (coordinates[2] >= 32 || coordinates[3] >= 32) return false;
+        }
+        else
+        {
+            int y;
+            Xdr::read<StreamIO> (is, y);
+        }
+
+        uint64_t dataSize;
+
+        if (isDeepData (type))
+        {
+            uint64_t tableSize, packedSize, unpackedSize;
+            Xdr::read<StreamIO> (is, tableSize);
+            Xdr::read<StreamIO> (is, packedSize);
+            Xdr::read<StreamIO> (is, unpackedSize);
+
+            if (tableSize == 0 || tableSize > uint64_t (INT64_MAX) ||
+                packedSize > uint64_t (INT64_MAX) - tableSize)
+                return false;
+
+            dataSize = tableSize + packedSize;
+        }
+        else
+        {
+            int size;
+            Xdr::read<StreamIO> (is, size);
+
+            if (size <= 0) return false;
+
+            dataSize = size;
+        }
+
+        next = is.tellg () + dataSize;
+        return true;
+    }
+    catch (...) //NOSONAR - suppress vulnerability reports from SonarCloud.
+    {
+        is.clear ();
+        return false;
+    }
+}
+
+//
+// Return true if pos is the end of the file.
+//
+
+bool
+isEndOfFile (OPENEXR_IMF_INTERNAL_NAMESPACE::IStream& is, uint64_t pos)
+{
+    char c;
+
+    try
+    {
+        is.seekg (pos - 1);
+        is.read (&c, 1);
+    }
+    catch (...) //NOSONAR - suppress vulnerability reports from SonarCloud.
+    {
+        is.clear ();
+        return false;
+    }
+
+    try
+    {
+        is.read (&c, 1);
+    }
+    catch (...) //NOSONAR - suppress vulnerability reports from SonarCloud.
+    {
+        is.clear ();
+        return true;
+    }
+
+    return false;
+}
+
+//
+// Count the chunks in a row that start at position pos, up to
+// chunkChainLength, which also counts for reaching the end of the file.
+//
+
+int
+countChunkChain (
+    OPENEXR_IMF_INTERNAL_NAMESPACE::IStream& is,
+    uint64_t                                 pos,
+    bool                                     isMultiPart,
+    const vector<std::string>&               partTypes)
+{
+    int n = 0;
+
+    while (n < chunkChainLength)
+    {
+        uint64_t next;
+
+        if (!readChunkLeader (is, pos, isMultiPart, partTypes, next)) break;
+
+        ++n;
+
+        if (isEndOfFile (is, next)) return chunkChainLength;
+
+        pos = next;
+    }
+
+    return n;
+}
+
+} // namespace
+
+void
+skipHeaderPadding (
+    OPENEXR_IMF_INTERNAL_NAMESPACE::IStream& is,
+    bool                                     isMultiPart,
+    const vector<std::string>&               partTypes)
+{
+    uint64_t start   = is.tellg ();
+    uint64_t nonZero = start;
+
+    try
+    {
+        char c;
+
+        for (;;)
+        {
+            is.read (&c, 1);
+            if (c != 0) break;
+            ++nonZero;
+        }
+    }
+    catch (...) //NOSONAR - suppress vulnerability reports from SonarCloud.
+    {
+        //
+        // Nothing but zeros up to the end of the file.
+        //
+
+        is.clear ();
+        is.seekg (start);
+        return;
+    }
+
+    //
+    // The first chunk starts at most a chunk leader before the first
+    // non-zero byte.  Of the places where a chunk leader could start,
+    // take the one followed by the longest run of chunks.
+    //
+
+    uint64_t best      = start;
+    int      bestChain = 0;
+
+    if (nonZero > start)
+    {
+        uint64_t first = start;
+
+        if (nonZero - start > maxChunkLeaderSize - 1)
+            first = nonZero - (maxChunkLeaderSize - 1);
+
+        for (uint64_t pos = first; pos <= nonZero; ++pos)
+        {
+            int chain = countChunkChain (is, pos, isMultiPart, partTypes);
+
+            if (chain > bestChain)
+            {
+                best      = pos;
+                bestChain = chain;
+
+                if (chain == chunkChainLength) break;
+            }
+        }
+    }
+
+    is.clear ();
+    is.seekg (best);
+}
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
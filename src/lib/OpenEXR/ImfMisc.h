@@ -19,6 +19,7 @@
 #include "ImfPixelType.h"
 
 #include <cstddef>
+#include <string>
 #include <vector>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
@@ -160,6 +161,15 @@ Compressor::Format defaultFormat (Compressor* compressor);
 IMF_EXPORT
 int numLinesInBuffer (Compressor* compressor);
 
+//
+// Return true if OpenEXRCore can uncompress data compressed with
+// the given method.  The scan line and tiled input files read
+// chunks with OpenEXRCore, but uncompress the ones it cannot
+// with a Compressor.
+//
+
+bool coreCanUncompress (Compression comp);
+
 //
 // Copy a single channel of a horizontal row of pixels from an
 // input file's internal line buffer or tile buffer into a
@@ -434,6 +444,24 @@ bool usesLongNames (const Header& header);
 IMF_EXPORT
 int getChunkOffsetTableSize (const Header& header);
 
+//
+// Writers may leave zeros between the chunk offset tables and the
+// first chunk, so that the header can grow later without moving the
+// pixel data (see exr_set_header_padding()).  When a damaged offset
+// table has to be reconstructed by reading the chunks one after the
+// other, skipHeaderPadding() moves a stream that is positioned right
+// after the offset tables to the first chunk.  partTypes lists the
+// type of each part (SCANLINEIMAGE, TILEDIMAGE, DEEPSCANLINE or
+// DEEPTILE), to know what the chunk leaders look like.  The stream
+// stays where it is if there are no zeros, or no chunk after them.
+//
+
+IMF_EXPORT
+void skipHeaderPadding (
+    OPENEXR_IMF_INTERNAL_NAMESPACE::IStream& is,
+    bool                                     isMultiPart,
+    const std::vector<std::string>&          partTypes);
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
 
 #endif
@@ -100,7 +100,7 @@ MultiPartInputFile::MultiPartInputFile (
 {
     try
     {
-        _data->is = new StdIFStream (fileName);
+        _data->is = new StdStatelessIFStream (fileName);
         initialize ();
     }
     catch (IEX_NAMESPACE::BaseExc& e)
@@ -551,9 +551,11 @@ MultiPartInputFile::Data::chunkOffsetReconstruction (
                 case PIZ_COMPRESSION:
                 case B44_COMPRESSION:
                 case B44A_COMPRESSION:
-                case DWAA_COMPRESSION: rowsizes[i] = 32; break;
+                case DWAA_COMPRESSION:
+                case ZSTD_COMPRESSION: rowsizes[i] = 32; break;
                 case ZIP_COMPRESSION:
-                case PXR24_COMPRESSION: rowsizes[i] = 16; break;
+                case PXR24_COMPRESSION:
+                case LZ4_COMPRESSION: rowsizes[i] = 16; break;
                 case ZIPS_COMPRESSION:
                 case RLE_COMPRESSION:
                 case NO_COMPRESSION: rowsizes[i] = 1; break;
@@ -571,7 +573,13 @@ MultiPartInputFile::Data::chunkOffsetReconstruction (
         //
         //
 
-        uint64_t chunk_start = position;
+        vector<string> partTypes (parts.size ());
+        for (size_t i = 0; i < parts.size (); i++)
+            partTypes[i] = parts[i]->header.type ();
+
+        skipHeaderPadding (is, isMultiPart (version), partTypes);
+
+        uint64_t chunk_start = is.tellg ();
         for (size_t i = 0; i < total_chunks; i++)
         {
             //
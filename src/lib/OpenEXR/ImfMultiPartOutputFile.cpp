@@ -470,6 +470,8 @@ MultiPartOutputFile::Data::writeHeadersToFile (const vector<Header>& headers)
     for (size_t i = 0; i < headers.size (); i++)
     {
 
+        parts[i]->headerPosition = os->tellp ();
+
         // (TODO) consider deep files' preview images here.
         if (headers[i].type () == TILEDIMAGE)
             parts[i]->previewPosition = headers[i].writeTo (*os, true);
@@ -40,8 +40,10 @@
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
+using ILMTHREAD_NAMESPACE::RecycledTask;
 using ILMTHREAD_NAMESPACE::Semaphore;
 using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskBatch;
 using ILMTHREAD_NAMESPACE::TaskGroup;
 using ILMTHREAD_NAMESPACE::ThreadPool;
 using IMATH_NAMESPACE::Box2i;
@@ -106,7 +108,7 @@ struct LineBuffer
     LineBuffer (Compressor* comp);
     ~LineBuffer ();
 
-    void wait () { _sem.wait (); }
+    void wait (TaskGroup* group) { group->waitFor (_sem); }
     void post () { _sem.post (); }
 
 private:
@@ -364,7 +366,7 @@ convertToXdr (
 // the data if necessary.
 //
 
-class LineBufferTask : public Task
+class LineBufferTask : public RecycledTask
 {
 public:
     LineBufferTask (
@@ -389,13 +391,15 @@ LineBufferTask::LineBufferTask (
     int               number,
     int               scanLineMin,
     int               scanLineMax)
-    : Task (group), _ofd (ofd), _lineBuffer (_ofd->getLineBuffer (number))
+    : RecycledTask (group)
+    , _ofd (ofd)
+    , _lineBuffer (_ofd->getLineBuffer (number))
 {
     //
     // Wait for the lineBuffer to become available
     //
 
-    _lineBuffer->wait ();
+    _lineBuffer->wait (group);
 
     //
     // Initialize the lineBuffer data if necessary
@@ -1023,8 +1027,9 @@ OutputFile::writePixels (int numScanLines)
             //
             // Determine the range of lineBuffers that intersect the scan
             // line range.  Then add the initial compression tasks to the
-            // thread pool.  We always add in at least one task but the
-            // individual task might not do anything if numScanLines == 0.
+            // thread pool, all at once.  We always add in at least one
+            // task but the individual task might not do anything if
+            // numScanLines == 0.
             //
 
             if (_data->lineOrder == INCREASING_Y)
@@ -1040,9 +1045,11 @@ OutputFile::writePixels (int numScanLines)
                     min ((int) _data->lineBuffers.size (), last - first + 1),
                     1);
 
+                TaskBatch batch (ThreadPool::globalThreadPool (), numTasks);
+
                 for (int i = 0; i < numTasks; i++)
                 {
-                    ThreadPool::addGlobalTask (new LineBufferTask (
+                    batch.add (new LineBufferTask (
                         &taskGroup,
                         _data,
                         first + i,
@@ -1067,9 +1074,11 @@ OutputFile::writePixels (int numScanLines)
                     min ((int) _data->lineBuffers.size (), first - last + 1),
                     1);
 
+                TaskBatch batch (ThreadPool::globalThreadPool (), numTasks);
+
                 for (int i = 0; i < numTasks; i++)
                 {
-                    ThreadPool::addGlobalTask (new LineBufferTask (
+                    batch.add (new LineBufferTask (
                         &taskGroup,
                         _data,
                         first - i,
@@ -1098,7 +1107,7 @@ OutputFile::writePixels (int numScanLines)
                 LineBuffer* writeBuffer =
                     _data->getLineBuffer (nextWriteBuffer);
 
-                writeBuffer->wait ();
+                writeBuffer->wait (&taskGroup);
 
                 int numLines =
                     writeBuffer->scanLineMax - writeBuffer->scanLineMin + 1;
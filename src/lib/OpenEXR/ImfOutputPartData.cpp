@@ -15,6 +15,7 @@ OutputPartData::OutputPartData (
     int                numThreads,
     bool               multipart)
     : header (header)
+    , headerPosition (0)
     , numThreads (numThreads)
     , partNumber (partNumber)
     , multipart (multipart)
@@ -18,6 +18,7 @@
 #include "ImfIO.h"
 #include "ImfMisc.h"
 #include "ImfNamespace.h"
+#include "ImfProbe.h"
 #include "ImfWav.h"
 #include "ImfXdr.h"
 #include <Iex.h>
@@ -255,6 +256,8 @@ PizCompressor::compress (
     IMATH_NAMESPACE::Box2i range,
     const char*&           outPtr)
 {
+    IMF_PROBE_SCOPE (compressor_compress, PIZ_COMPRESSION, inSize, range.min.y);
+
     //
     // This is the compress function which is used by both the tiled and
     // scanline compression routines.
@@ -429,6 +432,12 @@ PizCompressor::uncompress (
     IMATH_NAMESPACE::Box2i range,
     const char*&           outPtr)
 {
+    IMF_PROBE_SCOPE (
+        compressor_uncompress,
+        PIZ_COMPRESSION,
+        inSize,
+        range.min.y);
+
     //
     // This is the cunompress function which is used by both the tiled and
     // scanline decompression routines.
@@ -0,0 +1,46 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_PROBE_H
+#define INCLUDED_IMF_PROBE_H
+
+//-----------------------------------------------------------------------------
+//
+//	Static (USDT) tracepoints for perf, bpftrace, systemtap, ...
+//
+//	Only compiled in when configured with OPENEXR_ENABLE_SDT and
+//	<sys/sdt.h> is available, otherwise these expand to nothing.
+//	When compiled in but not attached to, each probe is a single
+//	nop instruction.
+//
+//	IMF_PROBE (name, args...)
+//	    fires openexr:name
+//
+//	IMF_PROBE_SCOPE (name, compression, inSize, minY)
+//	    fires openexr:name__begin now, and openexr:name__end
+//	    (with the compression) when the enclosing scope exits
+//
+//-----------------------------------------------------------------------------
+
+#include "OpenEXRConfigInternal.h"
+
+#ifdef OPENEXR_HAVE_SYS_SDT_H
+#    include <sys/sdt.h>
+
+#    define IMF_PROBE(name, ...) STAP_PROBEV (openexr, name, __VA_ARGS__)
+
+#    define IMF_PROBE_SCOPE(name, compression, inSize, minY)                   \
+        IMF_PROBE (name##__begin, (int) (compression), inSize, minY);          \
+        struct ImfProbeScope_##name                                            \
+        {                                                                      \
+            int c;                                                             \
+            ~ImfProbeScope_##name () { IMF_PROBE (name##__end, c); }           \
+        } imfProbeScope_##name = {(int) (compression)}
+#else
+#    define IMF_PROBE(name, ...)
+#    define IMF_PROBE_SCOPE(name, compression, inSize, minY)
+#endif
+
+#endif
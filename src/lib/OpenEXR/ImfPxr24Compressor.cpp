@@ -41,6 +41,8 @@
 #include "ImfHeader.h"
 #include "ImfMisc.h"
 #include "ImfNamespace.h"
+#include "ImfProbe.h"
+#include "ImfSimd.h"
 
 #include <Iex.h>
 #include <ImathFun.h>
@@ -147,6 +149,310 @@ tooMuchData ()
                                    "(input data are longer than expected).");
 }
 
+#ifdef IMF_HAVE_SSE2
+
+//
+// SSE2 versions of the per-channel loops below, coding 16 values per
+// iteration.  They are bit exact with the scalar loops, which finish
+// off the last n % 16 values of a row.
+//
+
+inline __m128i
+floatToFloat24Sse2 (__m128i v)
+{
+    const __m128i eMask = _mm_set1_epi32 (0x7f800000);
+    const __m128i mMask = _mm_set1_epi32 (0x007fffff);
+
+    __m128i a = _mm_and_si128 (v, _mm_set1_epi32 (0x7fffffff));
+    __m128i s = _mm_srli_epi32 (_mm_andnot_si128 (a, v), 8);
+
+    //
+    // Finite, round the significand to 15 bits.  Rounding up only
+    // overflows the exponent from 0x7f7fff80 on, where truncating
+    // instead gives one less.
+    //
+
+    __m128i i = _mm_srli_epi32 (
+        _mm_add_epi32 (a, _mm_and_si128 (v, _mm_set1_epi32 (0x80))), 8);
+    i = _mm_add_epi32 (i, _mm_cmpgt_epi32 (i, _mm_set1_epi32 (0x7f7fff)));
+
+    __m128i isSpecial = _mm_cmpeq_epi32 (_mm_and_si128 (v, eMask), eMask);
+
+    if (_mm_movemask_epi8 (isSpecial))
+    {
+        //
+        // NAN or infinity, see floatToFloat24 ()
+        //
+
+        const __m128i zero = _mm_setzero_si128 ();
+        __m128i       m    = _mm_and_si128 (v, mMask);
+        __m128i       m8   = _mm_srli_epi32 (m, 8);
+        __m128i       nan0 = _mm_andnot_si128 (
+            _mm_cmpeq_epi32 (m, zero), _mm_cmpeq_epi32 (m8, zero));
+        __m128i special = _mm_or_si128 (
+            _mm_or_si128 (_mm_srli_epi32 (eMask, 8), m8),
+            _mm_and_si128 (nan0, _mm_set1_epi32 (1)));
+
+        i = _mm_or_si128 (
+            _mm_and_si128 (isSpecial, special),
+            _mm_andnot_si128 (isSpecial, i));
+    }
+
+    return _mm_or_si128 (s, i);
+}
+
+inline void
+storePlanes32Sse2 (
+    __m128i d0, __m128i d1, __m128i d2, __m128i d3, unsigned char** ptr)
+{
+    const __m128i lo = _mm_set1_epi16 (0xff);
+
+    //
+    // Split into 16-bit halves first, sign extended
+    // so that the saturating packs are exact
+    //
+
+    __m128i h01 = _mm_packs_epi32 (
+        _mm_srai_epi32 (d0, 16), _mm_srai_epi32 (d1, 16));
+    __m128i h23 = _mm_packs_epi32 (
+        _mm_srai_epi32 (d2, 16), _mm_srai_epi32 (d3, 16));
+    __m128i l01 = _mm_packs_epi32 (
+        _mm_srai_epi32 (_mm_slli_epi32 (d0, 16), 16),
+        _mm_srai_epi32 (_mm_slli_epi32 (d1, 16), 16));
+    __m128i l23 = _mm_packs_epi32 (
+        _mm_srai_epi32 (_mm_slli_epi32 (d2, 16), 16),
+        _mm_srai_epi32 (_mm_slli_epi32 (d3, 16), 16));
+
+    if (ptr[0])
+    {
+        _mm_storeu_si128 (
+            (__m128i*) ptr[0],
+            _mm_packus_epi16 (
+                _mm_srli_epi16 (h01, 8), _mm_srli_epi16 (h23, 8)));
+    }
+
+    _mm_storeu_si128 (
+        (__m128i*) ptr[1],
+        _mm_packus_epi16 (_mm_and_si128 (h01, lo), _mm_and_si128 (h23, lo)));
+    _mm_storeu_si128 (
+        (__m128i*) ptr[2],
+        _mm_packus_epi16 (_mm_srli_epi16 (l01, 8), _mm_srli_epi16 (l23, 8)));
+    _mm_storeu_si128 (
+        (__m128i*) ptr[3],
+        _mm_packus_epi16 (_mm_and_si128 (l01, lo), _mm_and_si128 (l23, lo)));
+}
+
+//
+// Splits the first n & ~15 values at inPtr into the byte planes,
+// advancing inPtr and ptr[], and leaving the last value coded in
+// previousPixel.  Returns the number of values coded.
+//
+
+int
+splitRowSse2 (
+    PixelType      type,
+    const char*&   inPtr,
+    int            n,
+    unsigned char* ptr[4],
+    unsigned int&  previousPixel)
+{
+    int     nVec = n & ~15;
+    __m128i prev = _mm_setzero_si128 ();
+
+    if (nVec == 0) return 0;
+
+    if (type == OPENEXR_IMF_INTERNAL_NAMESPACE::HALF)
+    {
+        const __m128i lo = _mm_set1_epi16 (0xff);
+
+        for (int j = 0; j < nVec; j += 16)
+        {
+            __m128i v0 = _mm_loadu_si128 ((const __m128i*) inPtr);
+            __m128i v1 = _mm_loadu_si128 ((const __m128i*) (inPtr + 16));
+            __m128i d0 = _mm_sub_epi16 (
+                v0,
+                _mm_or_si128 (
+                    _mm_slli_si128 (v0, 2), _mm_srli_si128 (prev, 14)));
+            __m128i d1 = _mm_sub_epi16 (
+                v1,
+                _mm_or_si128 (
+                    _mm_slli_si128 (v1, 2), _mm_srli_si128 (v0, 14)));
+            prev = v1;
+
+            _mm_storeu_si128 (
+                (__m128i*) ptr[0],
+                _mm_packus_epi16 (
+                    _mm_srli_epi16 (d0, 8), _mm_srli_epi16 (d1, 8)));
+            _mm_storeu_si128 (
+                (__m128i*) ptr[1],
+                _mm_packus_epi16 (
+                    _mm_and_si128 (d0, lo), _mm_and_si128 (d1, lo)));
+
+            inPtr += 32;
+            ptr[0] += 16;
+            ptr[1] += 16;
+        }
+
+        previousPixel = _mm_extract_epi16 (prev, 7);
+        return nVec;
+    }
+
+    //
+    // Float rows have only the three low byte planes
+    //
+
+    unsigned char* planes[4] = {ptr[0], ptr[1], ptr[2], ptr[3]};
+
+    if (type == OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT)
+    {
+        planes[0] = 0;
+        planes[1] = ptr[0];
+        planes[2] = ptr[1];
+        planes[3] = ptr[2];
+    }
+
+    for (int j = 0; j < nVec; j += 16)
+    {
+        __m128i v0 = _mm_loadu_si128 ((const __m128i*) inPtr);
+        __m128i v1 = _mm_loadu_si128 ((const __m128i*) (inPtr + 16));
+        __m128i v2 = _mm_loadu_si128 ((const __m128i*) (inPtr + 32));
+        __m128i v3 = _mm_loadu_si128 ((const __m128i*) (inPtr + 48));
+
+        if (type == OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT)
+        {
+            v0 = floatToFloat24Sse2 (v0);
+            v1 = floatToFloat24Sse2 (v1);
+            v2 = floatToFloat24Sse2 (v2);
+            v3 = floatToFloat24Sse2 (v3);
+        }
+
+        __m128i p0 =
+            _mm_or_si128 (_mm_slli_si128 (v0, 4), _mm_srli_si128 (prev, 12));
+        __m128i p1 =
+            _mm_or_si128 (_mm_slli_si128 (v1, 4), _mm_srli_si128 (v0, 12));
+        __m128i p2 =
+            _mm_or_si128 (_mm_slli_si128 (v2, 4), _mm_srli_si128 (v1, 12));
+        __m128i p3 =
+            _mm_or_si128 (_mm_slli_si128 (v3, 4), _mm_srli_si128 (v2, 12));
+        prev = v3;
+
+        storePlanes32Sse2 (
+            _mm_sub_epi32 (v0, p0),
+            _mm_sub_epi32 (v1, p1),
+            _mm_sub_epi32 (v2, p2),
+            _mm_sub_epi32 (v3, p3),
+            planes);
+
+        inPtr += 64;
+        for (int k = 0; k < 4; ++k)
+            if (planes[k]) planes[k] += 16;
+    }
+
+    for (int k = 0; k < 4; ++k)
+        ptr[k] += nVec;
+
+    previousPixel = _mm_cvtsi128_si32 (_mm_shuffle_epi32 (prev, 0xff));
+    return nVec;
+}
+
+inline __m128i
+prefixSum32Sse2 (__m128i v, __m128i prev)
+{
+    v = _mm_add_epi32 (v, _mm_slli_si128 (v, 4));
+    v = _mm_add_epi32 (v, _mm_slli_si128 (v, 8));
+    return _mm_add_epi32 (v, _mm_shuffle_epi32 (prev, 0xff));
+}
+
+inline __m128i
+prefixSum16Sse2 (__m128i v, __m128i prev)
+{
+    v    = _mm_add_epi16 (v, _mm_slli_si128 (v, 2));
+    v    = _mm_add_epi16 (v, _mm_slli_si128 (v, 4));
+    v    = _mm_add_epi16 (v, _mm_slli_si128 (v, 8));
+    prev = _mm_shufflehi_epi16 (prev, 0xff);
+    return _mm_add_epi16 (v, _mm_unpackhi_epi64 (prev, prev));
+}
+
+//
+// Merges the first n & ~15 values from the byte planes, advancing
+// ptr[] and writePtr, and leaving the last value in pixel.  Returns
+// the number of values decoded.
+//
+
+int
+mergeRowSse2 (
+    PixelType            type,
+    const unsigned char* ptr[4],
+    int                  n,
+    char*&               writePtr,
+    unsigned int&        pixel)
+{
+    int     nVec = n & ~15;
+    __m128i prev = _mm_setzero_si128 ();
+
+    if (nVec == 0) return 0;
+
+    if (type == OPENEXR_IMF_INTERNAL_NAMESPACE::HALF)
+    {
+        for (int j = 0; j < nVec; j += 16)
+        {
+            __m128i b0 = _mm_loadu_si128 ((const __m128i*) (ptr[0] + j));
+            __m128i b1 = _mm_loadu_si128 ((const __m128i*) (ptr[1] + j));
+            __m128i v0 = prefixSum16Sse2 (_mm_unpacklo_epi8 (b1, b0), prev);
+            __m128i v1 = prefixSum16Sse2 (_mm_unpackhi_epi8 (b1, b0), v0);
+            prev       = v1;
+
+            _mm_storeu_si128 ((__m128i*) writePtr, v0);
+            _mm_storeu_si128 ((__m128i*) (writePtr + 16), v1);
+            writePtr += 32;
+        }
+
+        ptr[0] += nVec;
+        ptr[1] += nVec;
+        pixel = _mm_extract_epi16 (prev, 7);
+        return nVec;
+    }
+
+    bool isUint = (type == OPENEXR_IMF_INTERNAL_NAMESPACE::UINT);
+
+    for (int j = 0; j < nVec; j += 16)
+    {
+        __m128i b0 = _mm_loadu_si128 ((const __m128i*) (ptr[0] + j));
+        __m128i b1 = _mm_loadu_si128 ((const __m128i*) (ptr[1] + j));
+        __m128i b2 = _mm_loadu_si128 ((const __m128i*) (ptr[2] + j));
+        __m128i b3 = isUint ? _mm_loadu_si128 ((const __m128i*) (ptr[3] + j))
+                            : _mm_setzero_si128 ();
+
+        //
+        // Interleave to the values b0 << 24 | b1 << 16 | b2 << 8 | b3
+        //
+
+        __m128i lo = _mm_unpacklo_epi8 (b3, b2);
+        __m128i hi = _mm_unpacklo_epi8 (b1, b0);
+        __m128i v0 = prefixSum32Sse2 (_mm_unpacklo_epi16 (lo, hi), prev);
+        __m128i v1 = prefixSum32Sse2 (_mm_unpackhi_epi16 (lo, hi), v0);
+        lo         = _mm_unpackhi_epi8 (b3, b2);
+        hi         = _mm_unpackhi_epi8 (b1, b0);
+        __m128i v2 = prefixSum32Sse2 (_mm_unpacklo_epi16 (lo, hi), v1);
+        __m128i v3 = prefixSum32Sse2 (_mm_unpackhi_epi16 (lo, hi), v2);
+        prev       = v3;
+
+        _mm_storeu_si128 ((__m128i*) writePtr, v0);
+        _mm_storeu_si128 ((__m128i*) (writePtr + 16), v1);
+        _mm_storeu_si128 ((__m128i*) (writePtr + 32), v2);
+        _mm_storeu_si128 ((__m128i*) (writePtr + 48), v3);
+        writePtr += 64;
+    }
+
+    for (int k = 0; k < (isUint ? 4 : 3); ++k)
+        ptr[k] += nVec;
+
+    pixel = _mm_cvtsi128_si32 (_mm_shuffle_epi32 (prev, 0xff));
+    return nVec;
+}
+
+#endif // IMF_HAVE_SSE2
+
 } // namespace
 
 Pxr24Compressor::Pxr24Compressor (
@@ -231,6 +537,12 @@ int
 Pxr24Compressor::compress (
     const char* inPtr, int inSize, Box2i range, const char*& outPtr)
 {
+    IMF_PROBE_SCOPE (
+        compressor_compress,
+        PXR24_COMPRESSION,
+        inSize,
+        range.min.y);
+
     if (inSize == 0)
     {
         outPtr = _outBuffer;
@@ -258,6 +570,7 @@ Pxr24Compressor::compress (
 
             unsigned char* ptr[4];
             unsigned int   previousPixel = 0;
+            int            j;
 
             switch (c.type)
             {
@@ -269,7 +582,12 @@ Pxr24Compressor::compress (
                     ptr[3]       = ptr[2] + n;
                     tmpBufferEnd = ptr[3] + n;
 
-                    for (int j = 0; j < n; ++j)
+                    j = 0;
+#ifdef IMF_HAVE_SSE2
+                    j = splitRowSse2 (c.type, inPtr, n, ptr, previousPixel);
+#endif
+
+                    for (; j < n; ++j)
                     {
                         unsigned int pixel;
                         char*        pPtr = (char*) &pixel;
@@ -294,7 +612,12 @@ Pxr24Compressor::compress (
                     ptr[1]       = ptr[0] + n;
                     tmpBufferEnd = ptr[1] + n;
 
-                    for (int j = 0; j < n; ++j)
+                    j = 0;
+#ifdef IMF_HAVE_SSE2
+                    j = splitRowSse2 (c.type, inPtr, n, ptr, previousPixel);
+#endif
+
+                    for (; j < n; ++j)
                     {
                         half pixel;
 
@@ -317,7 +640,12 @@ Pxr24Compressor::compress (
                     ptr[2]       = ptr[1] + n;
                     tmpBufferEnd = ptr[2] + n;
 
-                    for (int j = 0; j < n; ++j)
+                    j = 0;
+#ifdef IMF_HAVE_SSE2
+                    j = splitRowSse2 (c.type, inPtr, n, ptr, previousPixel);
+#endif
+
+                    for (; j < n; ++j)
                     {
                         float pixel;
                         char* pPtr = (char*) &pixel;
@@ -361,6 +689,12 @@ int
 Pxr24Compressor::uncompress (
     const char* inPtr, int inSize, Box2i range, const char*& outPtr)
 {
+    IMF_PROBE_SCOPE (
+        compressor_uncompress,
+        PXR24_COMPRESSION,
+        inSize,
+        range.min.y);
+
     if (inSize == 0)
     {
         outPtr = _outBuffer;
@@ -401,6 +735,7 @@ Pxr24Compressor::uncompress (
 
             const unsigned char* ptr[4];
             unsigned int         pixel = 0;
+            int                  j;
 
             switch (c.type)
             {
@@ -415,7 +750,12 @@ Pxr24Compressor::uncompress (
                     if (static_cast<uLong> (tmpBufferEnd - _tmpBuffer) > tmpSize)
                         notEnoughData ();
 
-                    for (int j = 0; j < n; ++j)
+                    j = 0;
+#ifdef IMF_HAVE_SSE2
+                    j = mergeRowSse2 (c.type, ptr, n, writePtr, pixel);
+#endif
+
+                    for (; j < n; ++j)
                     {
                         unsigned int diff = (*(ptr[0]++) << 24) |
                                             (*(ptr[1]++) << 16) |
@@ -440,7 +780,12 @@ Pxr24Compressor::uncompress (
                     if (static_cast<uLong> (tmpBufferEnd - _tmpBuffer) > tmpSize)
                         notEnoughData ();
 
-                    for (int j = 0; j < n; ++j)
+                    j = 0;
+#ifdef IMF_HAVE_SSE2
+                    j = mergeRowSse2 (c.type, ptr, n, writePtr, pixel);
+#endif
+
+                    for (; j < n; ++j)
                     {
                         unsigned int diff = (*(ptr[0]++) << 8) | *(ptr[1]++);
 
@@ -463,7 +808,12 @@ Pxr24Compressor::uncompress (
                     if (static_cast<uLong> (tmpBufferEnd - _tmpBuffer) > tmpSize)
                         notEnoughData ();
 
-                    for (int j = 0; j < n; ++j)
+                    j = 0;
+#ifdef IMF_HAVE_SSE2
+                    j = mergeRowSse2 (c.type, ptr, n, writePtr, pixel);
+#endif
+
+                    for (; j < n; ++j)
                     {
                         unsigned int diff = (*(ptr[0]++) << 24) |
                                             (*(ptr[1]++) << 16) |
@@ -13,6 +13,7 @@
 #include "Iex.h"
 #include "ImfCheckedArithmetic.h"
 #include "ImfNamespace.h"
+#include "ImfProbe.h"
 #include "ImfRle.h"
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
@@ -52,6 +53,8 @@ int
 RleCompressor::compress (
     const char* inPtr, int inSize, int minY, const char*& outPtr)
 {
+    IMF_PROBE_SCOPE (compressor_compress, RLE_COMPRESSION, inSize, minY);
+
     //
     // Special case �- empty input buffer
     //
@@ -115,6 +118,8 @@ int
 RleCompressor::uncompress (
     const char* inPtr, int inSize, int minY, const char*& outPtr)
 {
+    IMF_PROBE_SCOPE (compressor_uncompress, RLE_COMPRESSION, inSize, minY);
+
     //
     // Special case �- empty input buffer
     //
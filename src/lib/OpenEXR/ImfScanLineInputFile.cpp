@@ -29,6 +29,8 @@
 #include <ImathBox.h>
 #include <ImathFun.h>
 
+#include "openexr.h"
+
 #include <algorithm>
 #include <assert.h>
 #include <cstring>
@@ -37,8 +39,10 @@
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
+using ILMTHREAD_NAMESPACE::RecycledTask;
 using ILMTHREAD_NAMESPACE::Semaphore;
 using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskBatch;
 using ILMTHREAD_NAMESPACE::TaskGroup;
 using ILMTHREAD_NAMESPACE::ThreadPool;
 using IMATH_NAMESPACE::Box2i;
@@ -104,18 +108,24 @@ InSliceInfo::InSliceInfo (
     // empty
 }
 
+//
+// A line buffer holds the OpenEXRCore decode pipeline for one
+// chunk of scan lines.  The pipeline keeps its packed and
+// unpacked buffers from chunk to chunk, and grows them only
+// as far as the chunks actually read require.  For compression
+// methods that OpenEXRCore cannot uncompress, the line buffer
+// also has a Compressor.
+//
+
 struct LineBuffer
 {
-    const char*        uncompressedData;
-    char*              buffer;
-    int                dataSize;
-    int                minY;
-    int                maxY;
-    Compressor*        compressor;
-    Compressor::Format format;
-    int                number;
-    bool               hasException;
-    string             exception;
+    const char*           uncompressedData;
+    Compressor::Format    format;
+    int                   minY;
+    int                   maxY;
+    exr_decode_pipeline_t decoder;
+    Compressor*           compressor;
+    int                   number;
 
     LineBuffer (Compressor* const comp);
     ~LineBuffer ();
@@ -125,7 +135,7 @@ struct LineBuffer
     LineBuffer (LineBuffer&& other)                 = delete;
     LineBuffer& operator= (LineBuffer&& other) = delete;
 
-    inline void wait () { _sem.wait (); }
+    inline void wait (TaskGroup* group) { group->waitFor (_sem); }
     inline void post () { _sem.post (); }
 
 private:
@@ -134,13 +144,10 @@ private:
 
 LineBuffer::LineBuffer (Compressor* comp)
     : uncompressedData (0)
-    , buffer (0)
-    , dataSize (0)
+    , format (Compressor::XDR)
+    , decoder ()
     , compressor (comp)
-    , format (defaultFormat (compressor))
     , number (-1)
-    , hasException (false)
-    , exception ()
     , _sem (1)
 {
     // empty
@@ -148,9 +155,41 @@ LineBuffer::LineBuffer (Compressor* comp)
 
 LineBuffer::~LineBuffer ()
 {
+    if (decoder.context) exr_decoding_destroy (decoder.context, &decoder);
     delete compressor;
 }
 
+//
+// The first exception raised by the tasks of one readPixels()
+// call.  The line buffers are shared between concurrent calls,
+// so each call collects its errors here instead.
+//
+
+struct LineBufferErrors
+{
+    bool   hasException;
+    string exception;
+
+    LineBufferErrors () : hasException (false) {}
+
+    void set (const char* what)
+    {
+#if ILMTHREAD_THREADING_ENABLED
+        std::lock_guard<std::mutex> lock (_mutex);
+#endif
+        if (!hasException)
+        {
+            exception    = what;
+            hasException = true;
+        }
+    }
+
+private:
+#if ILMTHREAD_THREADING_ENABLED
+    std::mutex _mutex;
+#endif
+};
+
 /// helper struct used to detect the order that the channels are stored
 
 struct sliceOptimizationData
@@ -194,7 +233,6 @@ struct ScanLineInputFile::Data
                                        // each line
     bool fileIsComplete;               // True if no scanlines are missing
                                        // in the file
-    int            nextLineBufferMinY; // minimum y of the next linebuffer
     vector<size_t> bytesPerLine;       // combined size of a line over all
                                        // channels
     vector<size_t> offsetInLineBuffer; // offset for each scanline in its
@@ -204,10 +242,14 @@ struct ScanLineInputFile::Data
     vector<LineBuffer*> lineBuffers;   // each holds one line buffer
     int                 linesInBuffer; // number of scanlines each buffer
                                        // holds
-    size_t lineBufferSize;             // size of the line buffer
-    int    partNumber;                 // part number
-
-    bool             memoryMapped;     // if the stream is memory mapped
+    size_t       lineBufferSize;       // size of the line buffer
+    vector<char> rawPixelDataBuffer;   // holds the chunk returned
+                                       // by rawPixelData()
+    int          partNumber;           // part number
+
+    bool              memoryMapped;    // if the stream is memory mapped
+    StatelessIStream* statelessStream; // if pixel data is read with
+                                       // stateless reads, else nullptr
     OptimizationMode optimizationMode; // optimizibility of the input file
     vector<sliceOptimizationData>
         optimizationData; ///< channel ordering for optimized reading
@@ -226,7 +268,7 @@ struct ScanLineInputFile::Data
 };
 
 ScanLineInputFile::Data::Data (int numThreads)
-    : partNumber (-1), memoryMapped (false)
+    : partNumber (-1), memoryMapped (false), statelessStream (nullptr)
 {
     //
     // We need at least one lineBuffer, but if threading is used,
@@ -261,6 +303,8 @@ reconstructLineOffsets (
 
     try
     {
+        skipHeaderPadding (is, false, vector<string> (1, SCANLINEIMAGE));
+
         for (unsigned int i = 0; i < lineOffsets.size (); i++)
         {
             uint64_t lineOffset = is.tellg ();
@@ -339,6 +383,29 @@ readLineOffsets (
     }
 }
 
+void
+checkPixelDataHeader (
+    const ScanLineInputFile::Data* ifd,
+    int                            minY,
+    int                            partNumber,
+    int                            yInFile,
+    int                            dataSize)
+{
+    if (partNumber != ifd->partNumber)
+    {
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Unexpected part number " << partNumber << ", should be "
+                                      << ifd->partNumber << ".");
+    }
+
+    if (yInFile != minY)
+        throw IEX_NAMESPACE::InputExc ("Unexpected data block y coordinate.");
+
+    if (dataSize < 0 || dataSize > static_cast<int> (ifd->lineBufferSize))
+        throw IEX_NAMESPACE::InputExc ("Unexpected data block length.");
+}
+
 void
 readPixelData (
     InputStreamMutex*        streamData,
@@ -369,46 +436,76 @@ readPixelData (
         THROW (IEX_NAMESPACE::InputExc, "Scan line " << minY << " is missing.");
 
     //
-    // Seek to the start of the scan line in the file,
-    // if necessary.
+    // Read the data block's header.
     //
 
-    if (!isMultiPart (ifd->version))
-    {
-        if (ifd->nextLineBufferMinY != minY) streamData->is->seekg (lineOffset);
-    }
-    else
+    int partNumber = ifd->partNumber;
+    int yInFile;
+
+    if (ifd->statelessStream)
     {
         //
-        // In a multi-part file, the file pointer may have been moved by
-        // other parts, so we have to ask tellg() where we are.
+        // Read the header and the pixel data at their offsets
+        // in the file.  This leaves the stream's reading position
+        // alone, so it does not need the stream's mutex.
         //
-        if (streamData->is->tellg () != ifd->lineOffsets[lineBufferNumber])
-            streamData->is->seekg (lineOffset);
+
+        char header[12]; // [part number,] y, data size
+        int  headerSize = isMultiPart (ifd->version) ? 12 : 8;
+
+        if (ifd->statelessStream->read (header, headerSize, lineOffset) !=
+            headerSize)
+            throw IEX_NAMESPACE::InputExc ("Unexpected end of file.");
+
+        const char* readPtr = header;
+
+        if (isMultiPart (ifd->version))
+        {
+            OPENEXR_IMF_INTERNAL_NAMESPACE::Xdr::read<
+                OPENEXR_IMF_INTERNAL_NAMESPACE::CharPtrIO> (
+                readPtr, partNumber);
+        }
+
+        OPENEXR_IMF_INTERNAL_NAMESPACE::Xdr::read<
+            OPENEXR_IMF_INTERNAL_NAMESPACE::CharPtrIO> (readPtr, yInFile);
+        OPENEXR_IMF_INTERNAL_NAMESPACE::Xdr::read<
+            OPENEXR_IMF_INTERNAL_NAMESPACE::CharPtrIO> (readPtr, dataSize);
+
+        checkPixelDataHeader (ifd, minY, partNumber, yInFile, dataSize);
+
+        if (ifd->memoryMapped)
+        {
+            buffer = ifd->statelessStream->readMemoryMapped (
+                dataSize, lineOffset + headerSize);
+        }
+        else if (
+            ifd->statelessStream->read (
+                buffer, dataSize, lineOffset + headerSize) != dataSize)
+        {
+            throw IEX_NAMESPACE::InputExc ("Unexpected end of file.");
+        }
+
+        return;
     }
 
     //
-    // Read the data block's header.
+    // Seek to the start of the scan line in the file, if necessary.
+    // The file pointer may have been moved by other parts of a
+    // multi-part file, or by the OpenEXRCore context reading from
+    // the same stream, so we have to ask tellg() where we are.
     //
 
-    int yInFile;
+    if (streamData->is->tellg () != lineOffset)
+        streamData->is->seekg (lineOffset);
 
     //
     // Read the part number when we are dealing with a multi-part file.
     //
     if (isMultiPart (ifd->version))
     {
-        int partNumber;
         OPENEXR_IMF_INTERNAL_NAMESPACE::Xdr::read<
             OPENEXR_IMF_INTERNAL_NAMESPACE::StreamIO> (
             *streamData->is, partNumber);
-        if (partNumber != ifd->partNumber)
-        {
-            THROW (
-                IEX_NAMESPACE::ArgExc,
-                "Unexpected part number " << partNumber << ", should be "
-                                          << ifd->partNumber << ".");
-        }
     }
 
     OPENEXR_IMF_INTERNAL_NAMESPACE::Xdr::read<
@@ -416,11 +513,7 @@ readPixelData (
     OPENEXR_IMF_INTERNAL_NAMESPACE::Xdr::read<
         OPENEXR_IMF_INTERNAL_NAMESPACE::StreamIO> (*streamData->is, dataSize);
 
-    if (yInFile != minY)
-        throw IEX_NAMESPACE::InputExc ("Unexpected data block y coordinate.");
-
-    if (dataSize < 0 || dataSize > static_cast<int> (ifd->lineBufferSize))
-        throw IEX_NAMESPACE::InputExc ("Unexpected data block length.");
+    checkPixelDataHeader (ifd, minY, partNumber, yInFile, dataSize);
 
     //
     // Read the pixel data.
@@ -430,17 +523,81 @@ readPixelData (
         buffer = streamData->is->readMemoryMapped (dataSize);
     else
         streamData->is->read (buffer, dataSize);
+}
 
-    //
-    // Keep track of which scan line is the next one in
-    // the file, so that we can avoid redundant seekg()
-    // operations (seekg() can be fairly expensive).
-    //
+//
+// Read and uncompress the chunk of a line buffer through the
+// line buffer's OpenEXRCore decode pipeline, unless the line
+// buffer already holds the uncompressed data.  The uncompressed
+// data are in XDR format.
+//
+
+void
+decodeLineBuffer (
+    exr_const_context_t            ctxt,
+    const ScanLineInputFile::Data* ifd,
+    LineBuffer*                    lineBuffer)
+{
+    if (lineBuffer->uncompressedData != 0) return;
+
+    int              partIndex = max (0, ifd->partNumber);
+    exr_chunk_info_t cinfo;
+
+    exr_result_t rv =
+        exr_read_scanline_chunk_info (ctxt, partIndex, lineBuffer->minY, &cinfo);
 
-    if (ifd->lineOrder == INCREASING_Y)
-        ifd->nextLineBufferMinY = minY + ifd->linesInBuffer;
+    if (rv == EXR_ERR_SUCCESS)
+    {
+        if (lineBuffer->decoder.context)
+            rv = exr_decoding_update (
+                ctxt, partIndex, &cinfo, &lineBuffer->decoder);
+        else
+        {
+            rv = exr_decoding_initialize (
+                ctxt, partIndex, &cinfo, &lineBuffer->decoder);
+
+            if (rv == EXR_ERR_SUCCESS)
+                InputStreamMutex::useMemoryMappedChunks (lineBuffer->decoder);
+
+            if (lineBuffer->compressor)
+                lineBuffer->decoder.decompress_fn = nullptr;
+        }
+    }
+
+    if (rv == EXR_ERR_SUCCESS)
+        rv = exr_decoding_run (ctxt, partIndex, &lineBuffer->decoder);
+
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        THROW (
+            IEX_NAMESPACE::InputExc,
+            "Cannot read scan line " << lineBuffer->minY << ": "
+                                     << exr_get_default_error_message (rv)
+                                     << ".");
+    }
+
+    const exr_chunk_info_t& chunk = lineBuffer->decoder.chunk;
+
+    if (lineBuffer->compressor && chunk.packed_size < chunk.unpacked_size)
+    {
+        //
+        // OpenEXRCore has only read the chunk.
+        //
+
+        lineBuffer->format = lineBuffer->compressor->format ();
+
+        lineBuffer->compressor->uncompress (
+            static_cast<const char*> (lineBuffer->decoder.packed_buffer),
+            static_cast<int> (chunk.packed_size),
+            lineBuffer->minY,
+            lineBuffer->uncompressedData);
+    }
     else
-        ifd->nextLineBufferMinY = minY - ifd->linesInBuffer;
+    {
+        lineBuffer->format = Compressor::XDR;
+        lineBuffer->uncompressedData =
+            static_cast<const char*> (lineBuffer->decoder.unpacked_buffer);
+    }
 }
 
 //
@@ -448,13 +605,15 @@ readPixelData (
 // scanlines (line buffer) and copying them into the frame buffer.
 //
 
-class LineBufferTask : public Task
+class LineBufferTask : public RecycledTask
 {
 public:
     LineBufferTask (
         TaskGroup*               group,
+        exr_const_context_t      ctxt,
         ScanLineInputFile::Data* ifd,
         LineBuffer*              lineBuffer,
+        LineBufferErrors*        errors,
         int                      scanLineMin,
         int                      scanLineMax,
         OptimizationMode         optimizationMode);
@@ -464,8 +623,10 @@ public:
     virtual void execute ();
 
 private:
+    exr_const_context_t      _ctxt;
     ScanLineInputFile::Data* _ifd;
     LineBuffer*              _lineBuffer;
+    LineBufferErrors*        _errors;
     int                      _scanLineMin;
     int                      _scanLineMax;
     OptimizationMode         _optimizationMode;
@@ -473,14 +634,18 @@ private:
 
 LineBufferTask::LineBufferTask (
     TaskGroup*               group,
+    exr_const_context_t      ctxt,
     ScanLineInputFile::Data* ifd,
     LineBuffer*              lineBuffer,
+    LineBufferErrors*        errors,
     int                      scanLineMin,
     int                      scanLineMax,
     OptimizationMode         optimizationMode)
-    : Task (group)
+    : RecycledTask (group)
+    , _ctxt (ctxt)
     , _ifd (ifd)
     , _lineBuffer (lineBuffer)
+    , _errors (errors)
     , _scanLineMin (scanLineMin)
     , _scanLineMax (scanLineMax)
     , _optimizationMode (optimizationMode)
@@ -503,42 +668,10 @@ LineBufferTask::execute ()
     try
     {
         //
-        // Uncompress the data, if necessary
+        // Read and uncompress the data, if necessary
         //
 
-        if (_lineBuffer->uncompressedData == 0)
-        {
-            size_t uncompressedSize = 0;
-            int    maxY             = min (_lineBuffer->maxY, _ifd->maxY);
-
-            for (int i = _lineBuffer->minY - _ifd->minY; i <= maxY - _ifd->minY;
-                 ++i)
-            {
-                uncompressedSize += _ifd->bytesPerLine[i];
-            }
-
-            if (_lineBuffer->compressor &&
-                static_cast<size_t> (_lineBuffer->dataSize) < uncompressedSize)
-            {
-                _lineBuffer->format = _lineBuffer->compressor->format ();
-
-                _lineBuffer->dataSize = _lineBuffer->compressor->uncompress (
-                    _lineBuffer->buffer,
-                    _lineBuffer->dataSize,
-                    _lineBuffer->minY,
-                    _lineBuffer->uncompressedData);
-            }
-            else
-            {
-                //
-                // If the line is uncompressed, it's in XDR format,
-                // regardless of the compressor's output format.
-                //
-
-                _lineBuffer->format           = Compressor::XDR;
-                _lineBuffer->uncompressedData = _lineBuffer->buffer;
-            }
-        }
+        decodeLineBuffer (_ctxt, _ifd, _lineBuffer);
 
         int yStart, yStop, dy;
 
@@ -636,19 +769,11 @@ LineBufferTask::execute ()
     }
     catch (std::exception& e)
     {
-        if (!_lineBuffer->hasException)
-        {
-            _lineBuffer->exception    = e.what ();
-            _lineBuffer->hasException = true;
-        }
+        _errors->set (e.what ());
     }
     catch (...)
     {
-        if (!_lineBuffer->hasException)
-        {
-            _lineBuffer->exception    = "unrecognized exception";
-            _lineBuffer->hasException = true;
-        }
+        _errors->set ("unrecognized exception");
     }
 }
 
@@ -657,13 +782,15 @@ LineBufferTask::execute ()
 // IIF format is more restricted than a perfectly generic one,
 // so it is possible to perform some optimizations.
 //
-class LineBufferTaskIIF : public Task
+class LineBufferTaskIIF : public RecycledTask
 {
 public:
     LineBufferTaskIIF (
         TaskGroup*               group,
+        exr_const_context_t      ctxt,
         ScanLineInputFile::Data* ifd,
         LineBuffer*              lineBuffer,
+        LineBufferErrors*        errors,
         int                      scanLineMin,
         int                      scanLineMax,
         OptimizationMode         optimizationMode);
@@ -689,8 +816,10 @@ public:
         size_t&          outPixelsToCopyNormal) const;
 
 private:
+    exr_const_context_t      _ctxt;
     ScanLineInputFile::Data* _ifd;
     LineBuffer*              _lineBuffer;
+    LineBufferErrors*        _errors;
     int                      _scanLineMin;
     int                      _scanLineMax;
     OptimizationMode         _optimizationMode;
@@ -698,14 +827,18 @@ private:
 
 LineBufferTaskIIF::LineBufferTaskIIF (
     TaskGroup*               group,
+    exr_const_context_t      ctxt,
     ScanLineInputFile::Data* ifd,
     LineBuffer*              lineBuffer,
+    LineBufferErrors*        errors,
     int                      scanLineMin,
     int                      scanLineMax,
     OptimizationMode         optimizationMode)
-    : Task (group)
+    : RecycledTask (group)
+    , _ctxt (ctxt)
     , _ifd (ifd)
     , _lineBuffer (lineBuffer)
+    , _errors (errors)
     , _scanLineMin (scanLineMin)
     , _scanLineMax (scanLineMax)
     , _optimizationMode (optimizationMode)
@@ -822,42 +955,10 @@ LineBufferTaskIIF::execute ()
     try
     {
         //
-        // Uncompress the data, if necessary
+        // Read and uncompress the data, if necessary
         //
 
-        if (_lineBuffer->uncompressedData == 0)
-        {
-            size_t uncompressedSize = 0;
-            int    maxY             = min (_lineBuffer->maxY, _ifd->maxY);
-
-            for (int i = _lineBuffer->minY - _ifd->minY; i <= maxY - _ifd->minY;
-                 ++i)
-            {
-                uncompressedSize += _ifd->bytesPerLine[i];
-            }
-
-            if (_lineBuffer->compressor &&
-                static_cast<size_t> (_lineBuffer->dataSize) < uncompressedSize)
-            {
-                _lineBuffer->format = _lineBuffer->compressor->format ();
-
-                _lineBuffer->dataSize = _lineBuffer->compressor->uncompress (
-                    _lineBuffer->buffer,
-                    _lineBuffer->dataSize,
-                    _lineBuffer->minY,
-                    _lineBuffer->uncompressedData);
-            }
-            else
-            {
-                //
-                // If the line is uncompressed, it's in XDR format,
-                // regardless of the compressor's output format.
-                //
-
-                _lineBuffer->format           = Compressor::XDR;
-                _lineBuffer->uncompressedData = _lineBuffer->buffer;
-            }
-        }
+        decodeLineBuffer (_ctxt, _ifd, _lineBuffer);
 
         int yStart, yStop, dy;
 
@@ -1024,19 +1125,11 @@ LineBufferTaskIIF::execute ()
     }
     catch (std::exception& e)
     {
-        if (!_lineBuffer->hasException)
-        {
-            _lineBuffer->exception    = e.what ();
-            _lineBuffer->hasException = true;
-        }
+        _errors->set (e.what ());
     }
     catch (...)
     {
-        if (!_lineBuffer->hasException)
-        {
-            _lineBuffer->exception    = "unrecognized exception";
-            _lineBuffer->hasException = true;
-        }
+        _errors->set ("unrecognized exception");
     }
 }
 #endif
@@ -1046,65 +1139,41 @@ newLineBufferTask (
     TaskGroup*               group,
     InputStreamMutex*        streamData,
     ScanLineInputFile::Data* ifd,
+    LineBufferErrors*        errors,
     int                      number,
     int                      scanLineMin,
     int                      scanLineMax,
     OptimizationMode         optimizationMode)
 {
     //
-    // Wait for a line buffer to become available, fill the line
-    // buffer with raw data from the file if necessary, and create
-    // a new LineBufferTask whose execute() method will uncompress
-    // the contents of the buffer and copy the pixels into the
-    // frame buffer.
+    // Wait for a line buffer to become available and create a new
+    // LineBufferTask whose execute() method will read and uncompress
+    // the line buffer's chunk, if the line buffer does not hold it
+    // yet, and copy the pixels into the frame buffer.  Reading the
+    // chunk in the task lets several tasks read at the same time.
     //
 
+    if (ifd->lineOffsets[number] == 0)
+    {
+        THROW (
+            IEX_NAMESPACE::InputExc,
+            "Scan line " << ifd->minY + number * ifd->linesInBuffer
+                         << " is missing.");
+    }
+
+    exr_const_context_t ctxt = streamData->coreContext ();
+
     LineBuffer* lineBuffer = ifd->getLineBuffer (number);
 
-    try
-    {
-        lineBuffer->wait ();
+    lineBuffer->wait (group);
 
-        if (lineBuffer->number != number)
-        {
-            lineBuffer->minY = ifd->minY + number * ifd->linesInBuffer;
-            lineBuffer->maxY = lineBuffer->minY + ifd->linesInBuffer - 1;
-
-            lineBuffer->number           = number;
-            lineBuffer->uncompressedData = 0;
-
-            readPixelData (
-                streamData,
-                ifd,
-                lineBuffer->minY,
-                lineBuffer->buffer,
-                lineBuffer->dataSize);
-        }
-    }
-    catch (std::exception& e)
-    {
-        if (!lineBuffer->hasException)
-        {
-            lineBuffer->exception    = e.what ();
-            lineBuffer->hasException = true;
-        }
-        lineBuffer->number = -1;
-        lineBuffer->post ();
-        throw;
-    }
-    catch (...)
+    if (lineBuffer->number != number)
     {
-        //
-        // Reading from the file caused an exception.
-        // Signal that the line buffer is free, and
-        // re-throw the exception.
-        //
+        lineBuffer->minY = ifd->minY + number * ifd->linesInBuffer;
+        lineBuffer->maxY = lineBuffer->minY + ifd->linesInBuffer - 1;
 
-        lineBuffer->exception    = "unrecognized exception";
-        lineBuffer->hasException = true;
-        lineBuffer->number       = -1;
-        lineBuffer->post ();
-        throw;
+        lineBuffer->number           = number;
+        lineBuffer->uncompressedData = 0;
     }
 
     scanLineMin = max (lineBuffer->minY, scanLineMin);
@@ -1117,13 +1186,27 @@ newLineBufferTask (
     {
 
         retTask = new LineBufferTaskIIF (
-            group, ifd, lineBuffer, scanLineMin, scanLineMax, optimizationMode);
+            group,
+            ctxt,
+            ifd,
+            lineBuffer,
+            errors,
+            scanLineMin,
+            scanLineMax,
+            optimizationMode);
     }
     else
 #endif
     {
         retTask = new LineBufferTask (
-            group, ifd, lineBuffer, scanLineMin, scanLineMax, optimizationMode);
+            group,
+            ctxt,
+            ifd,
+            lineBuffer,
+            errors,
+            scanLineMin,
+            scanLineMax,
+            optimizationMode);
     }
 
     return retTask;
@@ -1183,32 +1266,16 @@ ScanLineInputFile::initialize (const Header& header)
             "maximum bytes per scanline exceeds maximum permissible size");
     }
 
-    //
-    // allocate compressor objects
-    //
     for (size_t i = 0; i < _data->lineBuffers.size (); i++)
     {
         _data->lineBuffers[i] = new LineBuffer (
-            newCompressor (comp, maxBytesPerLine, _data->header));
+            coreCanUncompress (comp)
+                ? 0
+                : newCompressor (comp, maxBytesPerLine, _data->header));
     }
 
     _data->lineBufferSize = maxBytesPerLine * _data->linesInBuffer;
 
-    if (!_streamData->is->isMemoryMapped ())
-    {
-        for (size_t i = 0; i < _data->lineBuffers.size (); i++)
-        {
-            _data->lineBuffers[i]->buffer = (char*) EXRAllocAligned (
-                _data->lineBufferSize * sizeof (char), 16);
-            if (!_data->lineBuffers[i]->buffer)
-            {
-                throw IEX_NAMESPACE::LogicExc (
-                    "Failed to allocate memory for scanline buffers");
-            }
-        }
-    }
-    _data->nextLineBufferMinY = _data->minY - 1;
-
     offsetInLineBufferTable (
         _data->bytesPerLine, _data->linesInBuffer, _data->offsetInLineBuffer);
 
@@ -1221,9 +1288,10 @@ ScanLineInputFile::ScanLineInputFile (InputPartData* part)
         throw IEX_NAMESPACE::ArgExc (
             "Can't build a ScanLineInputFile from a type-mismatched part.");
 
-    _data               = new Data (part->numThreads);
-    _streamData         = part->mutex;
-    _data->memoryMapped = _streamData->is->isMemoryMapped ();
+    _data                = new Data (part->numThreads);
+    _streamData          = part->mutex;
+    _data->memoryMapped  = _streamData->is->isMemoryMapped ();
+    _data->statelessStream = _streamData->statelessStream ();
 
     _data->version = part->version;
 
@@ -1233,18 +1301,6 @@ ScanLineInputFile::ScanLineInputFile (InputPartData* part)
     }
     catch (...)
     {
-        if (!_data->memoryMapped)
-        {
-            for (size_t i = 0; i < _data->lineBuffers.size (); i++)
-            {
-                if (_data->lineBuffers[i])
-                {
-                    EXRFreeAligned (_data->lineBuffers[i]->buffer);
-                    _data->lineBuffers[i]->buffer = nullptr;
-                }
-            }
-        }
-
         delete _data;
         throw;
     }
@@ -1264,8 +1320,9 @@ ScanLineInputFile::ScanLineInputFile (
     int                                      numThreads)
     : _data (new Data (numThreads)), _streamData (new InputStreamMutex ())
 {
-    _streamData->is     = is;
-    _data->memoryMapped = is->isMemoryMapped ();
+    _streamData->is      = is;
+    _data->memoryMapped  = is->isMemoryMapped ();
+    _data->statelessStream = _streamData->statelessStream ();
 
     try
     {
@@ -1287,44 +1344,29 @@ ScanLineInputFile::ScanLineInputFile (
     }
     catch (...)
     {
-        if (_data)
-        {
-            if (!_data->memoryMapped)
-            {
-                for (size_t i = 0; i < _data->lineBuffers.size (); i++)
-                {
-                    if (_data->lineBuffers[i])
-                    {
-                        EXRFreeAligned (_data->lineBuffers[i]->buffer);
-                        _data->lineBuffers[i]->buffer = nullptr;
-                    }
-                }
-            }
-        }
-        delete _streamData;
         delete _data;
+        delete _streamData;
         throw;
     }
 }
 
 ScanLineInputFile::~ScanLineInputFile ()
 {
-    if (!_data->memoryMapped)
-    {
-        for (size_t i = 0; i < _data->lineBuffers.size (); i++)
-        {
-            EXRFreeAligned (_data->lineBuffers[i]->buffer);
-        }
-    }
+    //
+    // The line buffers' decode pipelines refer to the stream's
+    // OpenEXRCore context, so they go first.
+    //
+
+    bool ownsStreamData = _data->partNumber == -1;
+
+    delete _data;
 
     //
     // ScanLineInputFile should never delete the stream,
     // because it does not own the stream.
     // We just delete the Mutex here.
     //
-    if (_data->partNumber == -1) delete _streamData;
-
-    delete _data;
+    if (ownsStreamData) delete _streamData;
 }
 
 const char*
@@ -1634,9 +1676,15 @@ ScanLineInputFile::readPixels (int scanLine1, int scanLine2)
 {
     try
     {
-#if ILMTHREAD_THREADING_ENABLED
-        std::lock_guard<std::mutex> lock (*_streamData);
-#endif
+        //
+        // The stream is not locked here: the line buffer tasks read
+        // their chunks through the stream's OpenEXRCore context,
+        // which reads at explicit offsets and locks the stream only
+        // for streams without stateless reads.  Concurrent calls
+        // share nothing but the line buffers, which are handed out
+        // one at a time.
+        //
+
         if (_data->slices.size () == 0)
             throw IEX_NAMESPACE::ArgExc (
                 "No frame buffer specified as pixel data destination.");
@@ -1678,6 +1726,8 @@ ScanLineInputFile::readPixels (int scanLine1, int scanLine2)
         // all tasks are complete.
         //
 
+        LineBufferErrors errors;
+
         {
             TaskGroup taskGroup;
 
@@ -1688,15 +1738,22 @@ ScanLineInputFile::readPixels (int scanLine1, int scanLine2)
             // because we lock the line buffers during construction and the
             // constructors are called by the main thread.  Hence, in order
             // for a successive task to execute the previous task which
-            // used that line buffer must have completed already.
+            // used that line buffer must have completed already.  The
+            // tasks are added to the pool in batches of at most one task
+            // per line buffer, so that no task waits for a buffer used
+            // by a task of its own batch.
             //
 
+            TaskBatch batch (
+                ThreadPool::globalThreadPool (), _data->lineBuffers.size ());
+
             for (int l = start; l != stop; l += dl)
             {
-                ThreadPool::addGlobalTask (newLineBufferTask (
+                batch.add (newLineBufferTask (
                     &taskGroup,
                     _streamData,
                     _data,
+                    &errors,
                     l,
                     scanLineMin,
                     scanLineMax,
@@ -1715,27 +1772,13 @@ ScanLineInputFile::readPixels (int scanLine1, int scanLine2)
         // those exceptions occurred in another thread, not in the thread
         // that is executing this call to ScanLineInputFile::readPixels().
         // LineBufferTask::execute() has caught all exceptions and stored
-        // the exceptions' what() strings in the line buffers.
-        // Now we check if any line buffer contains a stored exception; if
-        // this is the case then we re-throw the exception in this thread.
-        // (It is possible that multiple line buffers contain stored
-        // exceptions.  We re-throw the first exception we find and
-        // ignore all others.)
+        // the first exception's what() string in errors.  Now we check
+        // if there was an exception; if this is the case then we re-throw
+        // it in this thread.
         //
 
-        const string* exception = 0;
-
-        for (size_t i = 0; i < _data->lineBuffers.size (); ++i)
-        {
-            LineBuffer* lineBuffer = _data->lineBuffers[i];
-
-            if (lineBuffer->hasException && !exception)
-                exception = &lineBuffer->exception;
-
-            lineBuffer->hasException = false;
-        }
-
-        if (exception) throw IEX_NAMESPACE::IoExc (*exception);
+        if (errors.hasException)
+            throw IEX_NAMESPACE::IoExc (errors.exception);
     }
     catch (IEX_NAMESPACE::BaseExc& e)
     {
@@ -1761,7 +1804,13 @@ ScanLineInputFile::rawPixelData (
     try
     {
 #if ILMTHREAD_THREADING_ENABLED
-        std::lock_guard<std::mutex> lock (*_streamData);
+        //
+        // Without a memory-mapped stream the data are copied into
+        // rawPixelDataBuffer, which the lock protects, too
+        //
+
+        std::unique_lock<std::mutex> lock (*_streamData, std::defer_lock);
+        if (!_data->statelessStream || !_data->memoryMapped) lock.lock ();
 #endif
         if (firstScanLine < _data->minY || firstScanLine > _data->maxY)
         {
@@ -1772,14 +1821,17 @@ ScanLineInputFile::rawPixelData (
         int minY =
             lineBufferMinY (firstScanLine, _data->minY, _data->linesInBuffer);
 
-        readPixelData (
-            _streamData,
-            _data,
-            minY,
-            _data->lineBuffers[0]->buffer,
-            pixelDataSize);
+        char* buffer = 0;
+
+        if (!_data->memoryMapped)
+        {
+            _data->rawPixelDataBuffer.resize (_data->lineBufferSize);
+            buffer = _data->rawPixelDataBuffer.data ();
+        }
+
+        readPixelData (_streamData, _data, minY, buffer, pixelDataSize);
 
-        pixelData = _data->lineBuffers[0]->buffer;
+        pixelData = buffer;
     }
     catch (IEX_NAMESPACE::BaseExc& e)
     {
@@ -1806,7 +1858,8 @@ ScanLineInputFile::rawPixelDataToBuffer (
     try
     {
 #if ILMTHREAD_THREADING_ENABLED
-        std::lock_guard<std::mutex> lock (*_streamData);
+        std::unique_lock<std::mutex> lock (*_streamData, std::defer_lock);
+        if (!_data->statelessStream) lock.lock ();
 #endif
         if (scanLine < _data->minY || scanLine > _data->maxY)
         {
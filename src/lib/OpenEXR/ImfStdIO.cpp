@@ -24,7 +24,14 @@
 #    include <sys/stat.h>
 #    include <sys/types.h>
 #    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
 #endif
+#include <algorithm>
+#include <string.h>
 
 using namespace std;
 #include "ImfNamespace.h"
@@ -167,6 +174,236 @@ make_ofstream (const char* filename)
 }
 #endif
 
+//
+// A second, read-only handle to the file for stateless
+// reads.  Failing to open it is not an error, the stream
+// then just doesn't support stateless reads.
+//
+
+#ifdef _WIN32
+void*
+open_stateless_handle (const char* filename)
+{
+    wstring wfn = WidenFilename (filename);
+    HANDLE  h   = CreateFileW (
+        wfn.c_str (),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL);
+    return h == INVALID_HANDLE_VALUE ? nullptr : h;
+}
+
+void
+close_stateless_handle (void* h)
+{
+    if (h) CloseHandle (h);
+}
+
+int64_t
+read_stateless (void* h, void* buf, uint64_t sz, uint64_t offset)
+{
+    char*   out   = static_cast<char*> (buf);
+    int64_t total = 0;
+
+    while (sz > 0)
+    {
+        OVERLAPPED ov = {0};
+        ov.Offset     = static_cast<DWORD> (offset & 0xFFFFFFFF);
+        ov.OffsetHigh = static_cast<DWORD> (offset >> 32);
+
+        DWORD n     = 0;
+        DWORD chunk = sz > 0x40000000 ? 0x40000000 : static_cast<DWORD> (sz);
+
+        if (!ReadFile (h, out, chunk, &n, &ov))
+        {
+            if (GetLastError () == ERROR_HANDLE_EOF) break;
+            throw IEX_NAMESPACE::InputExc ("Stateless read failed.");
+        }
+
+        if (n == 0) break;
+
+        out += n;
+        offset += n;
+        total += n;
+        sz -= n;
+    }
+
+    return total;
+}
+#else
+int
+open_stateless_handle (const char* filename)
+{
+    int flags = O_RDONLY;
+#    ifdef O_CLOEXEC
+    flags |= O_CLOEXEC;
+#    endif
+    return ::open (filename, flags);
+}
+
+void
+close_stateless_handle (int fd)
+{
+    if (fd >= 0) ::close (fd);
+}
+
+int64_t
+read_stateless (int fd, void* buf, uint64_t sz, uint64_t offset)
+{
+    char*   out   = static_cast<char*> (buf);
+    int64_t total = 0;
+
+    while (sz > 0)
+    {
+        ssize_t n = ::pread (fd, out, sz, static_cast<off_t> (offset));
+
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            IEX_NAMESPACE::throwErrnoExc ();
+        }
+
+        if (n == 0) break;
+
+        out += n;
+        offset += n;
+        total += n;
+        sz -= n;
+    }
+
+    return total;
+}
+#endif
+
+//
+// Maps a whole file into memory, read-only.  An empty file
+// maps to a null pointer.
+//
+
+#ifdef _WIN32
+const char*
+map_file (const char* filename, uint64_t& size, void*& mapping)
+{
+    wstring wfn = WidenFilename (filename);
+    HANDLE  h   = CreateFileW (
+        wfn.c_str (),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL);
+
+    if (h == INVALID_HANDLE_VALUE)
+        THROW (
+            IEX_NAMESPACE::InputExc,
+            "Cannot open file \"" << filename << "\" for mapping.");
+
+    LARGE_INTEGER fsize;
+    if (!GetFileSizeEx (h, &fsize))
+    {
+        CloseHandle (h);
+        THROW (
+            IEX_NAMESPACE::InputExc,
+            "Cannot determine the size of file \"" << filename << "\".");
+    }
+
+    size    = static_cast<uint64_t> (fsize.QuadPart);
+    mapping = nullptr;
+
+    const char* data = nullptr;
+
+    if (size > 0)
+    {
+        //
+        // The view keeps the file open; the file handle
+        // itself is not needed after mapping.
+        //
+
+        mapping = CreateFileMappingW (h, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping)
+        {
+            data = static_cast<const char*> (
+                MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0));
+
+            if (!data)
+            {
+                CloseHandle (mapping);
+                mapping = nullptr;
+            }
+        }
+    }
+
+    CloseHandle (h);
+
+    if (size > 0 && !data)
+        THROW (
+            IEX_NAMESPACE::InputExc,
+            "Cannot map file \"" << filename << "\" into memory.");
+
+    return data;
+}
+
+void
+unmap_file (const char* data, uint64_t size, void* mapping)
+{
+    if (data) UnmapViewOfFile (data);
+    if (mapping) CloseHandle (mapping);
+}
+#else
+const char*
+map_file (const char* filename, uint64_t& size)
+{
+    int fd = open_stateless_handle (filename);
+    if (fd < 0) IEX_NAMESPACE::throwErrnoExc ();
+
+    struct stat st;
+    if (::fstat (fd, &st) != 0)
+    {
+        int e = errno;
+        ::close (fd);
+        errno = e;
+        IEX_NAMESPACE::throwErrnoExc ();
+    }
+
+    size = static_cast<uint64_t> (st.st_size);
+
+    const char* data = nullptr;
+
+    if (size > 0)
+    {
+        //
+        // The mapping keeps the file open; the descriptor
+        // itself is not needed after mapping.
+        //
+
+        void* p = ::mmap (nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+        if (p == MAP_FAILED)
+        {
+            int e = errno;
+            ::close (fd);
+            errno = e;
+            IEX_NAMESPACE::throwErrnoExc ();
+        }
+
+        data = static_cast<const char*> (p);
+    }
+
+    ::close (fd);
+    return data;
+}
+
+void
+unmap_file (const char* data, uint64_t size)
+{
+    if (data) ::munmap (const_cast<char*> (data), size);
+}
+#endif
+
 void
 clearError ()
 {
@@ -260,6 +497,51 @@ StdIFStream::clear ()
     _is->clear ();
 }
 
+StdStatelessIFStream::StdStatelessIFStream (const char fileName[])
+    : StdIFStream (fileName)
+#ifdef _WIN32
+    , _handle (open_stateless_handle (fileName))
+#else
+    , _fd (open_stateless_handle (fileName))
+#endif
+{
+    // empty
+}
+
+StdStatelessIFStream::~StdStatelessIFStream ()
+{
+#ifdef _WIN32
+    close_stateless_handle (_handle);
+#else
+    close_stateless_handle (_fd);
+#endif
+}
+
+bool
+StdStatelessIFStream::isStatelessRead () const
+{
+#ifdef _WIN32
+    return _handle != nullptr;
+#else
+    return _fd >= 0;
+#endif
+}
+
+int64_t
+StdStatelessIFStream::read (void* buf, uint64_t sz, uint64_t offset)
+{
+    if (!isStatelessRead ())
+        throw IEX_NAMESPACE::InputExc (
+            "Attempt to perform a stateless read "
+            "on a stream that does not support it.");
+
+#ifdef _WIN32
+    return read_stateless (_handle, buf, sz, offset);
+#else
+    return read_stateless (_fd, buf, sz, offset);
+#endif
+}
+
 StdISStream::StdISStream ()
     : OPENEXR_IMF_INTERNAL_NAMESPACE::IStream ("(string)")
 {
@@ -310,6 +592,122 @@ StdISStream::str (const std::string& s)
     _is.str (s);
 }
 
+StdIMemStream::StdIMemStream (
+    const char data[/*size*/], uint64_t size, const char fileName[])
+    : OPENEXR_IMF_INTERNAL_NAMESPACE::IStream (fileName)
+    , _data (data)
+    , _size (size)
+    , _pos (0)
+{
+    // empty
+}
+
+StdIMemStream::~StdIMemStream ()
+{}
+
+bool
+StdIMemStream::isMemoryMapped () const
+{
+    return true;
+}
+
+bool
+StdIMemStream::read (char c[/*n*/], int n)
+{
+    if (_pos >= _size && n > 0)
+        throw IEX_NAMESPACE::InputExc ("Unexpected end of file.");
+
+    uint64_t n2 = min<uint64_t> (n, _size - _pos);
+
+    memcpy (c, _data + _pos, n2);
+    _pos += n2;
+
+    if (n2 < static_cast<uint64_t> (n))
+    {
+        THROW (
+            IEX_NAMESPACE::InputExc,
+            "Early end of file: read " << n2 << " out of " << n
+                                       << " requested bytes.");
+    }
+
+    return _pos < _size;
+}
+
+char*
+StdIMemStream::readMemoryMapped (int n)
+{
+    if (n < 0 || _pos > _size || static_cast<uint64_t> (n) > _size - _pos)
+        throw IEX_NAMESPACE::InputExc ("Unexpected end of file.");
+
+    //
+    // The buffer is only ever read through the returned
+    // pointer, so casting away const is safe.
+    //
+
+    char* retVal = const_cast<char*> (_data + _pos);
+    _pos += n;
+    return retVal;
+}
+
+uint64_t
+StdIMemStream::tellg ()
+{
+    return _pos;
+}
+
+void
+StdIMemStream::seekg (uint64_t pos)
+{
+    _pos = pos;
+}
+
+bool
+StdIMemStream::isStatelessRead () const
+{
+    return true;
+}
+
+int64_t
+StdIMemStream::read (void* buf, uint64_t sz, uint64_t offset)
+{
+    if (offset >= _size) return 0;
+
+    uint64_t n = min (sz, _size - offset);
+    memcpy (buf, _data + offset, n);
+    return static_cast<int64_t> (n);
+}
+
+char*
+StdIMemStream::readMemoryMapped (uint64_t sz, uint64_t offset)
+{
+    if (offset > _size || sz > _size - offset)
+        throw IEX_NAMESPACE::InputExc ("Unexpected end of file.");
+
+    return const_cast<char*> (_data + offset);
+}
+
+StdMMapIFStream::StdMMapIFStream (const char fileName[])
+    : StdIMemStream (nullptr, 0, fileName)
+#ifdef _WIN32
+    , _mapping (nullptr)
+#endif
+{
+#ifdef _WIN32
+    _data = map_file (fileName, _size, _mapping);
+#else
+    _data = map_file (fileName, _size);
+#endif
+}
+
+StdMMapIFStream::~StdMMapIFStream ()
+{
+#ifdef _WIN32
+    unmap_file (_data, _size, _mapping);
+#else
+    unmap_file (_data, _size);
+#endif
+}
+
 StdOFStream::StdOFStream (const char fileName[])
     : OPENEXR_IMF_INTERNAL_NAMESPACE::OStream (fileName)
     , _os (make_ofstream (fileName))
@@ -63,6 +63,46 @@ private:
     bool           _deleteStream;
 };
 
+//-------------------------------------------
+// class StdStatelessIFStream -- a StdIFStream that opens
+// the file with the given name and also implements
+// OPENEXR_IMF_INTERNAL_NAMESPACE::StatelessIStream.
+//
+// Stateless reads go through a second, read-only handle
+// to the file using positional reads, so they neither
+// move nor depend on the std::ifstream's reading
+// position.  If the second handle cannot be opened,
+// isStatelessRead() returns false.  The input files use
+// this stream when they are given a file name.
+//-------------------------------------------
+
+class IMF_EXPORT_TYPE StdStatelessIFStream
+    : public OPENEXR_IMF_INTERNAL_NAMESPACE::StdIFStream
+    , public OPENEXR_IMF_INTERNAL_NAMESPACE::StatelessIStream
+{
+public:
+    IMF_EXPORT StdStatelessIFStream (const char fileName[]);
+
+    IMF_EXPORT virtual ~StdStatelessIFStream ();
+    StdStatelessIFStream (const StdStatelessIFStream&) = delete;
+    StdStatelessIFStream (StdStatelessIFStream&&)      = delete;
+    StdStatelessIFStream& operator= (const StdStatelessIFStream&) = delete;
+    StdStatelessIFStream& operator= (StdStatelessIFStream&&) = delete;
+
+    using StdIFStream::read;
+
+    IMF_EXPORT virtual bool isStatelessRead () const;
+    IMF_EXPORT virtual int64_t
+    read (void* buf, uint64_t sz, uint64_t offset);
+
+private:
+#ifdef _WIN32
+    void* _handle;
+#else
+    int _fd;
+#endif
+};
+
 //------------------------------------------------
 // class StdISStream -- an implementation of class
 // OPENEXR_IMF_INTERNAL_NAMESPACE::IStream, based on class std::istringstream
@@ -92,6 +132,78 @@ private:
     std::istringstream _is;
 };
 
+//------------------------------------------------
+// class StdIMemStream -- an implementation of class
+// OPENEXR_IMF_INTERNAL_NAMESPACE::IStream that reads from a
+// buffer in memory.  The stream does not copy the buffer and
+// does not own it; the buffer must stay valid and unchanged
+// for as long as the stream is in use.
+//
+// The stream is memory mapped: readMemoryMapped() returns
+// pointers into the buffer, and the file readers uncompress
+// pixel data straight from there.  The pointers must only be
+// read from.  The stream also supports stateless reads.
+//------------------------------------------------
+
+class IMF_EXPORT_TYPE StdIMemStream
+    : public OPENEXR_IMF_INTERNAL_NAMESPACE::IStream
+    , public OPENEXR_IMF_INTERNAL_NAMESPACE::StatelessIStream
+{
+public:
+    IMF_EXPORT StdIMemStream (
+        const char data[/*size*/],
+        uint64_t   size,
+        const char fileName[] = "(memory)");
+
+    IMF_EXPORT virtual ~StdIMemStream ();
+    StdIMemStream (const StdIMemStream&) = delete;
+    StdIMemStream (StdIMemStream&&)      = delete;
+    StdIMemStream& operator= (const StdIMemStream&) = delete;
+    StdIMemStream& operator= (StdIMemStream&&) = delete;
+
+    IMF_EXPORT virtual bool     isMemoryMapped () const;
+    IMF_EXPORT virtual bool     read (char c[/*n*/], int n);
+    IMF_EXPORT virtual char*    readMemoryMapped (int n);
+    IMF_EXPORT virtual uint64_t tellg ();
+    IMF_EXPORT virtual void     seekg (uint64_t pos);
+
+    IMF_EXPORT virtual bool isStatelessRead () const;
+    IMF_EXPORT virtual int64_t
+    read (void* buf, uint64_t sz, uint64_t offset);
+    IMF_EXPORT virtual char* readMemoryMapped (uint64_t sz, uint64_t offset);
+
+protected:
+    const char* _data;
+    uint64_t    _size;
+    uint64_t    _pos;
+};
+
+//------------------------------------------------
+// class StdMMapIFStream -- an implementation of class
+// OPENEXR_IMF_INTERNAL_NAMESPACE::IStream that maps a whole
+// file into memory, read-only, and reads from the mapping
+// like StdIMemStream.  The destructor unmaps and closes the
+// file.
+//------------------------------------------------
+
+class IMF_EXPORT_TYPE StdMMapIFStream
+    : public OPENEXR_IMF_INTERNAL_NAMESPACE::StdIMemStream
+{
+public:
+    IMF_EXPORT StdMMapIFStream (const char fileName[]);
+
+    IMF_EXPORT virtual ~StdMMapIFStream ();
+    StdMMapIFStream (const StdMMapIFStream&) = delete;
+    StdMMapIFStream (StdMMapIFStream&&)      = delete;
+    StdMMapIFStream& operator= (const StdMMapIFStream&) = delete;
+    StdMMapIFStream& operator= (StdMMapIFStream&&) = delete;
+
+private:
+#ifdef _WIN32
+    void* _mapping;
+#endif
+};
+
 //-------------------------------------------
 // class StdOFStream -- an implementation of
 // class OPENEXR_IMF_INTERNAL_NAMESPACE::OStream based on class std::ofstream
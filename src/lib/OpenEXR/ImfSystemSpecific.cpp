@@ -25,7 +25,7 @@ cpuid (int n, int& eax, int& ebx, int& ecx, int& edx)
     __asm__ __volatile__(
         "cpuid"
         : /* Output  */ "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
-        : /* Input   */ "a"(n)
+        : /* Input   */ "a"(n), "c"(0)
         : /* Clobber */);
 }
 
@@ -36,7 +36,7 @@ void
 cpuid (int n, int& eax, int& ebx, int& ecx, int& edx)
 {
     int cpuInfo[4] = { -1 };
-    __cpuid (cpuInfo, n);
+    __cpuidex (cpuInfo, n, 0);
     eax = cpuInfo[0];
     ebx = cpuInfo[1];
     ecx = cpuInfo[2];
@@ -85,6 +85,7 @@ CpuId::CpuId ()
     , sse4_2 (false)
     , avx (false)
     , f16c (false)
+    , bmi2 (false)
 {
 #if defined(__e2k__) // e2k - MCST Elbrus 2000 architecture
     // Use IMF_HAVE definitions to determine e2k CPU features
@@ -135,6 +136,12 @@ CpuId::CpuId ()
             if ((eax & 6) != 6) { avx = f16c = false; }
         }
     }
+    if (max >= 7)
+    {
+        // sub-leaf 0 of the structured extended feature flags
+        cpuid (7, eax, ebx, ecx, edx);
+        bmi2 = (ebx & (1 << 8));
+    }
 #endif
 }
 
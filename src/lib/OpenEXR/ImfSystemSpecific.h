@@ -102,6 +102,7 @@ public:
     bool sse4_2;
     bool avx;
     bool f16c;
+    bool bmi2;
 };
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
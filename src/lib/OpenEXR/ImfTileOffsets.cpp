@@ -12,6 +12,8 @@
 #include "Iex.h"
 #include "ImfNamespace.h"
 #include <ImfIO.h>
+#include <ImfMisc.h>
+#include <ImfPartType.h>
 #include <ImfTileOffsets.h>
 #include <ImfXdr.h>
 #include <algorithm>
@@ -185,6 +187,19 @@ TileOffsets::reconstructFromFile (
 
     try
     {
+        //
+        // Multi-part files are reconstructed by MultiPartInputFile,
+        // which knows the types of all parts.
+        //
+
+        if (!isMultiPart)
+        {
+            skipHeaderPadding (
+                is,
+                false,
+                std::vector<std::string> (1, isDeep ? DEEPTILE : TILEDIMAGE));
+        }
+
         findTiles (is, isMultiPart, isDeep, false);
     }
     catch (...) //NOSONAR - suppress vulnerability reports from SonarCloud.
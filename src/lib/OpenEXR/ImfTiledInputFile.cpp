@@ -33,6 +33,9 @@
 #include "ImfTiledMisc.h"
 #include "ImfVersion.h"
 #include "ImfXdr.h"
+
+#include "openexr.h"
+
 #include <algorithm>
 #include <assert.h>
 #include <string>
@@ -40,8 +43,10 @@
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
+using ILMTHREAD_NAMESPACE::RecycledTask;
 using ILMTHREAD_NAMESPACE::Semaphore;
 using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskBatch;
 using ILMTHREAD_NAMESPACE::TaskGroup;
 using ILMTHREAD_NAMESPACE::ThreadPool;
 using IMATH_NAMESPACE::Box2i;
@@ -105,19 +110,21 @@ TInSliceInfo::TInSliceInfo (
     // empty
 }
 
+//
+// A tile buffer holds the OpenEXRCore decode pipeline for one
+// tile.  The pipeline keeps its packed and unpacked buffers
+// from tile to tile.  For compression methods that OpenEXRCore
+// cannot uncompress, the tile buffer also has a Compressor.
+//
+
 struct TileBuffer
 {
-    const char*        uncompressedData;
-    char*              buffer;
-    int                dataSize;
-    Compressor*        compressor;
-    Compressor::Format format;
-    int                dx;
-    int                dy;
-    int                lx;
-    int                ly;
-    bool               hasException;
-    string             exception;
+    exr_decode_pipeline_t decoder;
+    Compressor*           compressor;
+    int                   dx;
+    int                   dy;
+    int                   lx;
+    int                   ly;
 
     TileBuffer (Compressor* const comp);
     ~TileBuffer ();
@@ -127,7 +134,7 @@ struct TileBuffer
     TileBuffer (TileBuffer&& other)                 = delete;
     TileBuffer& operator= (TileBuffer&& other) = delete;
 
-    inline void wait () { _sem.wait (); }
+    inline void wait (TaskGroup* group) { group->waitFor (_sem); }
     inline void post () { _sem.post (); }
 
 protected:
@@ -135,17 +142,12 @@ protected:
 };
 
 TileBuffer::TileBuffer (Compressor* comp)
-    : uncompressedData (0)
-    , buffer (0)
-    , dataSize (0)
+    : decoder ()
     , compressor (comp)
-    , format (defaultFormat (compressor))
     , dx (-1)
     , dy (-1)
     , lx (-1)
     , ly (-1)
-    , hasException (false)
-    , exception ()
     , _sem (1)
 {
     // empty
@@ -153,9 +155,41 @@ TileBuffer::TileBuffer (Compressor* comp)
 
 TileBuffer::~TileBuffer ()
 {
+    if (decoder.context) exr_decoding_destroy (decoder.context, &decoder);
     delete compressor;
 }
 
+//
+// The first exception raised by the tasks of one readTiles()
+// call.  The tile buffers are shared between concurrent calls,
+// so each call collects its errors here instead.
+//
+
+struct TileBufferErrors
+{
+    bool   hasException;
+    string exception;
+
+    TileBufferErrors () : hasException (false) {}
+
+    void set (const char* what)
+    {
+#if ILMTHREAD_THREADING_ENABLED
+        std::lock_guard<std::mutex> lock (_mutex);
+#endif
+        if (!hasException)
+        {
+            exception    = what;
+            hasException = true;
+        }
+    }
+
+private:
+#if ILMTHREAD_THREADING_ENABLED
+    std::mutex _mutex;
+#endif
+};
+
 } // namespace
 
 class MultiPartInputFile;
@@ -211,7 +245,8 @@ struct TiledInputFile::Data
     vector<TileBuffer*> tileBuffers;    // each holds a single tile
     size_t              tileBufferSize; // size of the tile buffers
 
-    bool memoryMapped; // if the stream is memory mapped
+    vector<char> rawTileDataBuffer; // holds the tile returned
+                                    // by rawTileData()
 
     InputStreamMutex* _streamData;
     bool              _deleteStream;
@@ -241,7 +276,6 @@ TiledInputFile::Data::Data (int numThreads)
     , multiPartBackwardSupport (false)
     , numThreads (numThreads)
     , multiPartFile (nullptr)
-    , memoryMapped (false)
     , _streamData (NULL)
     , _deleteStream (false)
 {
@@ -329,127 +363,6 @@ TiledInputFile::Data::validateStreamSize ()
 namespace
 {
 
-void
-readTileData (
-    InputStreamMutex*     streamData,
-    TiledInputFile::Data* ifd,
-    int                   dx,
-    int                   dy,
-    int                   lx,
-    int                   ly,
-    char*&                buffer,
-    int&                  dataSize)
-{
-    //
-    // Read a single tile block from the file and into the array pointed
-    // to by buffer.  If the file is memory-mapped, then we change where
-    // buffer points instead of writing into the array (hence buffer needs
-    // to be a reference to a char *).
-    //
-
-    //
-    // Look up the location for this tile in the Index and
-    // seek to that position if necessary
-    //
-
-    uint64_t tileOffset = ifd->tileOffsets (dx, dy, lx, ly);
-
-    if (tileOffset == 0)
-    {
-        THROW (
-            IEX_NAMESPACE::InputExc,
-            "Tile (" << dx << ", " << dy << ", " << lx << ", " << ly
-                     << ") is missing.");
-    }
-
-    //
-    // In a multi-part file, the next chunk does not need to
-    // belong to the same part, so we have to compare the
-    // offset here.
-    //
-
-    if (!isMultiPart (ifd->version))
-    {
-        if (streamData->currentPosition != tileOffset)
-            streamData->is->seekg (tileOffset);
-    }
-    else
-    {
-        //
-        // In a multi-part file, the file pointer may be moved by other
-        // parts, so we have to ask tellg() where we are.
-        //
-        if (streamData->is->tellg () != tileOffset)
-            streamData->is->seekg (tileOffset);
-    }
-
-    //
-    // Read the first few bytes of the tile (the header).
-    // Verify that the tile coordinates and the level number
-    // are correct.
-    //
-
-    int tileXCoord, tileYCoord, levelX, levelY;
-
-    if (isMultiPart (ifd->version))
-    {
-        int partNumber;
-        Xdr::read<StreamIO> (*streamData->is, partNumber);
-        if (partNumber != ifd->partNumber)
-        {
-            THROW (
-                IEX_NAMESPACE::ArgExc,
-                "Unexpected part number " << partNumber << ", should be "
-                                          << ifd->partNumber << ".");
-        }
-    }
-
-    OPENEXR_IMF_INTERNAL_NAMESPACE::Xdr::read<
-        OPENEXR_IMF_INTERNAL_NAMESPACE::StreamIO> (*streamData->is, tileXCoord);
-    OPENEXR_IMF_INTERNAL_NAMESPACE::Xdr::read<
-        OPENEXR_IMF_INTERNAL_NAMESPACE::StreamIO> (*streamData->is, tileYCoord);
-    OPENEXR_IMF_INTERNAL_NAMESPACE::Xdr::read<
-        OPENEXR_IMF_INTERNAL_NAMESPACE::StreamIO> (*streamData->is, levelX);
-    OPENEXR_IMF_INTERNAL_NAMESPACE::Xdr::read<
-        OPENEXR_IMF_INTERNAL_NAMESPACE::StreamIO> (*streamData->is, levelY);
-    OPENEXR_IMF_INTERNAL_NAMESPACE::Xdr::read<
-        OPENEXR_IMF_INTERNAL_NAMESPACE::StreamIO> (*streamData->is, dataSize);
-
-    if (tileXCoord != dx)
-        throw IEX_NAMESPACE::InputExc ("Unexpected tile x coordinate.");
-
-    if (tileYCoord != dy)
-        throw IEX_NAMESPACE::InputExc ("Unexpected tile y coordinate.");
-
-    if (levelX != lx)
-        throw IEX_NAMESPACE::InputExc (
-            "Unexpected tile x level number coordinate.");
-
-    if (levelY != ly)
-        throw IEX_NAMESPACE::InputExc (
-            "Unexpected tile y level number coordinate.");
-
-    if (dataSize < 0 || dataSize > static_cast<int> (ifd->tileBufferSize))
-        throw IEX_NAMESPACE::InputExc ("Unexpected tile block length.");
-
-    //
-    // Read the pixel data.
-    //
-
-    if (streamData->is->isMemoryMapped ())
-        buffer = streamData->is->readMemoryMapped (dataSize);
-    else
-        streamData->is->read (buffer, dataSize);
-
-    //
-    // Keep track of which tile is the next one in
-    // the file, so that we can avoid redundant seekg()
-    // operations (seekg() can be fairly expensive).
-    //
-
-    streamData->currentPosition = tileOffset + 5 * Xdr::size<int> () + dataSize;
-}
-
 void
 readNextTileData (
     InputStreamMutex*     streamData,
@@ -509,24 +422,38 @@ readNextTileData (
 // a single tile and copying it into the frame buffer.
 //
 
-class TileBufferTask : public Task
+class TileBufferTask : public RecycledTask
 {
 public:
     TileBufferTask (
-        TaskGroup* group, TiledInputFile::Data* ifd, TileBuffer* tileBuffer);
+        TaskGroup*            group,
+        exr_const_context_t   ctxt,
+        TiledInputFile::Data* ifd,
+        TileBuffer*           tileBuffer,
+        TileBufferErrors*     errors);
 
     virtual ~TileBufferTask ();
 
     virtual void execute ();
 
 private:
+    exr_const_context_t   _ctxt;
     TiledInputFile::Data* _ifd;
     TileBuffer*           _tileBuffer;
+    TileBufferErrors*     _errors;
 };
 
 TileBufferTask::TileBufferTask (
-    TaskGroup* group, TiledInputFile::Data* ifd, TileBuffer* tileBuffer)
-    : Task (group), _ifd (ifd), _tileBuffer (tileBuffer)
+    TaskGroup*            group,
+    exr_const_context_t   ctxt,
+    TiledInputFile::Data* ifd,
+    TileBuffer*           tileBuffer,
+    TileBufferErrors*     errors)
+    : RecycledTask (group)
+    , _ctxt (ctxt)
+    , _ifd (ifd)
+    , _tileBuffer (tileBuffer)
+    , _errors (errors)
 {
     // empty
 }
@@ -562,34 +489,83 @@ TileBufferTask::execute ()
 
         int numPixelsPerScanLine = tileRange.max.x - tileRange.min.x + 1;
 
-        int numPixelsInTile =
-            numPixelsPerScanLine * (tileRange.max.y - tileRange.min.y + 1);
-
-        int sizeOfTile = _ifd->bytesPerPixel * numPixelsInTile;
-
         //
-        // Uncompress the data, if necessary
+        // Read and uncompress the tile through the tile buffer's
+        // OpenEXRCore decode pipeline.  The uncompressed data are
+        // in XDR format.
         //
 
-        if (_tileBuffer->compressor && _tileBuffer->dataSize < sizeOfTile)
+        int              partIndex = max (0, _ifd->partNumber);
+        exr_chunk_info_t cinfo;
+
+        exr_result_t rv = exr_read_tile_chunk_info (
+            _ctxt,
+            partIndex,
+            _tileBuffer->dx,
+            _tileBuffer->dy,
+            _tileBuffer->lx,
+            _tileBuffer->ly,
+            &cinfo);
+
+        if (rv == EXR_ERR_SUCCESS)
         {
-            _tileBuffer->format = _tileBuffer->compressor->format ();
+            if (_tileBuffer->decoder.context)
+                rv = exr_decoding_update (
+                    _ctxt, partIndex, &cinfo, &_tileBuffer->decoder);
+            else
+            {
+                rv = exr_decoding_initialize (
+                    _ctxt, partIndex, &cinfo, &_tileBuffer->decoder);
 
-            _tileBuffer->dataSize = _tileBuffer->compressor->uncompressTile (
-                _tileBuffer->buffer,
-                _tileBuffer->dataSize,
-                tileRange,
-                _tileBuffer->uncompressedData);
+                if (rv == EXR_ERR_SUCCESS)
+                    InputStreamMutex::useMemoryMappedChunks (
+                        _tileBuffer->decoder);
+
+                if (_tileBuffer->compressor)
+                    _tileBuffer->decoder.decompress_fn = nullptr;
+            }
         }
-        else
+
+        if (rv == EXR_ERR_SUCCESS)
+            rv = exr_decoding_run (_ctxt, partIndex, &_tileBuffer->decoder);
+
+        if (rv != EXR_ERR_SUCCESS)
+        {
+            THROW (
+                IEX_NAMESPACE::InputExc,
+                "Cannot read tile (" << _tileBuffer->dx << ", "
+                                     << _tileBuffer->dy << ", "
+                                     << _tileBuffer->lx << ", "
+                                     << _tileBuffer->ly << "): "
+                                     << exr_get_default_error_message (rv)
+                                     << ".");
+        }
+
+        const exr_chunk_info_t& chunk = _tileBuffer->decoder.chunk;
+
+        // points to where we read from in the tile block
+        const char*        readPtr;
+        Compressor::Format format;
+
+        if (_tileBuffer->compressor && chunk.packed_size < chunk.unpacked_size)
         {
             //
-            // If the line is uncompressed, it's in XDR format,
-            // regardless of the compressor's output format.
+            // OpenEXRCore has only read the tile.
             //
 
-            _tileBuffer->format           = Compressor::XDR;
-            _tileBuffer->uncompressedData = _tileBuffer->buffer;
+            format = _tileBuffer->compressor->format ();
+
+            _tileBuffer->compressor->uncompressTile (
+                static_cast<const char*> (_tileBuffer->decoder.packed_buffer),
+                static_cast<int> (chunk.packed_size),
+                tileRange,
+                readPtr);
+        }
+        else
+        {
+            format = Compressor::XDR;
+            readPtr =
+                static_cast<const char*> (_tileBuffer->decoder.unpacked_buffer);
         }
 
         //
@@ -597,11 +573,6 @@ TileBufferTask::execute ()
         // representation, and store the result in the frame buffer.
         //
 
-        const char* readPtr = _tileBuffer->uncompressedData;
-        // points to where we
-        // read from in the
-        // tile block
-
         //
         // Iterate over the scan lines in the tile.
         //
@@ -659,7 +630,7 @@ TileBufferTask::execute ()
                         slice.xStride,
                         slice.fill,
                         slice.fillValue,
-                        _tileBuffer->format,
+                        format,
                         slice.typeInFrameBuffer,
                         slice.typeInFile);
                 }
@@ -668,19 +639,11 @@ TileBufferTask::execute ()
     }
     catch (std::exception& e)
     {
-        if (!_tileBuffer->hasException)
-        {
-            _tileBuffer->exception    = e.what ();
-            _tileBuffer->hasException = true;
-        }
+        _errors->set (e.what ());
     }
     catch (...)
     {
-        if (!_tileBuffer->hasException)
-        {
-            _tileBuffer->exception    = "unrecognized exception";
-            _tileBuffer->hasException = true;
-        }
+        _errors->set ("unrecognized exception");
     }
 }
 
@@ -689,6 +652,7 @@ newTileBufferTask (
     TaskGroup*            group,
     InputStreamMutex*     streamData,
     TiledInputFile::Data* ifd,
+    TileBufferErrors*     errors,
     int                   number,
     int                   dx,
     int                   dy,
@@ -696,49 +660,33 @@ newTileBufferTask (
     int                   ly)
 {
     //
-    // Wait for a tile buffer to become available,
-    // fill the buffer with raw data from the file,
-    // and create a new TileBufferTask whose execute()
-    // method will uncompress the tile and copy the
-    // tile's pixels into the frame buffer.
+    // Wait for a tile buffer to become available, and create
+    // a new TileBufferTask whose execute() method will read and
+    // uncompress the tile and copy the tile's pixels into the
+    // frame buffer.  Reading the tile in the task lets several
+    // tasks read at the same time.
     //
 
-    TileBuffer* tileBuffer = ifd->getTileBuffer (number);
-
-    try
+    if (ifd->tileOffsets (dx, dy, lx, ly) == 0)
     {
-        tileBuffer->wait ();
+        THROW (
+            IEX_NAMESPACE::InputExc,
+            "Tile (" << dx << ", " << dy << ", " << lx << ", " << ly
+                     << ") is missing.");
+    }
 
-        tileBuffer->dx = dx;
-        tileBuffer->dy = dy;
-        tileBuffer->lx = lx;
-        tileBuffer->ly = ly;
+    exr_const_context_t ctxt = streamData->coreContext ();
 
-        tileBuffer->uncompressedData = 0;
+    TileBuffer* tileBuffer = ifd->getTileBuffer (number);
 
-        readTileData (
-            streamData,
-            ifd,
-            dx,
-            dy,
-            lx,
-            ly,
-            tileBuffer->buffer,
-            tileBuffer->dataSize);
-    }
-    catch (...)
-    {
-        //
-        // Reading from the file caused an exception.
-        // Signal that the tile buffer is free, and
-        // re-throw the exception.
-        //
+    tileBuffer->wait (group);
 
-        tileBuffer->post ();
-        throw;
-    }
+    tileBuffer->dx = dx;
+    tileBuffer->dy = dy;
+    tileBuffer->lx = lx;
+    tileBuffer->ly = ly;
 
-    return new TileBufferTask (group, ifd, tileBuffer);
+    return new TileBufferTask (group, ctxt, ifd, tileBuffer, errors);
 }
 
 } // namespace
@@ -759,7 +707,7 @@ TiledInputFile::TiledInputFile (const char fileName[], int numThreads)
     {
         try
         {
-            is = new StdIFStream (fileName);
+            is = new StdStatelessIFStream (fileName);
             readMagicNumberAndVersionField (*is, _data->version);
 
             //
@@ -794,16 +742,6 @@ TiledInputFile::TiledInputFile (const char fileName[], int numThreads)
     }
     catch (...)
     {
-        if (!_data->memoryMapped)
-        {
-            for (size_t i = 0; i < _data->tileBuffers.size (); i++)
-            {
-                if (_data->tileBuffers[i])
-                {
-                    delete[] _data->tileBuffers[i]->buffer;
-                }
-            }
-        }
         if (_data->_streamData != 0 && !isMultiPart (_data->version))
         {
             delete _data->_streamData->is;
@@ -852,7 +790,6 @@ TiledInputFile::TiledInputFile (
             // file is guaranteed to be single part, regular image
             _data->tileOffsets.readFrom (
                 *(_data->_streamData->is), _data->fileIsComplete, false, false);
-            _data->memoryMapped = _data->_streamData->is->isMemoryMapped ();
             _data->_streamData->currentPosition =
                 _data->_streamData->is->tellg ();
         }
@@ -868,16 +805,6 @@ TiledInputFile::TiledInputFile (
     }
     catch (...)
     {
-        if (!_data->memoryMapped)
-        {
-            for (size_t i = 0; i < _data->tileBuffers.size (); i++)
-            {
-                if (_data->tileBuffers[i])
-                {
-                    delete[] _data->tileBuffers[i]->buffer;
-                }
-            }
-        }
         if (streamDataCreated) delete _data->_streamData;
         delete _data;
         throw;
@@ -909,21 +836,10 @@ TiledInputFile::TiledInputFile (
         initialize ();
         _data->tileOffsets.readFrom (
             *(_data->_streamData->is), _data->fileIsComplete, false, false);
-        _data->memoryMapped                 = is->isMemoryMapped ();
         _data->_streamData->currentPosition = _data->_streamData->is->tellg ();
     }
     catch (...)
     {
-        if (!_data->memoryMapped)
-        {
-            for (size_t i = 0; i < _data->tileBuffers.size (); i++)
-            {
-                if (_data->tileBuffers[i])
-                {
-                    delete[] _data->tileBuffers[i]->buffer;
-                }
-            }
-        }
         delete _data->_streamData;
         delete _data;
         throw;
@@ -940,20 +856,7 @@ TiledInputFile::TiledInputFile (InputPartData* part)
     }
     catch (...)
     {
-        if (_data)
-        {
-            if (!_data->memoryMapped)
-            {
-                for (size_t i = 0; i < _data->tileBuffers.size (); i++)
-                {
-                    if (_data->tileBuffers[i])
-                    {
-                        delete[] _data->tileBuffers[i]->buffer;
-                    }
-                }
-            }
-            delete _data;
-        }
+        delete _data;
         throw;
     }
 }
@@ -982,11 +885,10 @@ TiledInputFile::multiPartInitialize (InputPartData* part)
         throw IEX_NAMESPACE::ArgExc (
             "Can't build a TiledInputFile from a type-mismatched part.");
 
-    _data->_streamData  = part->mutex;
-    _data->header       = part->header;
-    _data->version      = part->version;
-    _data->partNumber   = part->partNumber;
-    _data->memoryMapped = _data->_streamData->is->isMemoryMapped ();
+    _data->_streamData = part->mutex;
+    _data->header      = part->header;
+    _data->version     = part->version;
+    _data->partNumber  = part->partNumber;
     initialize ();
     _data->tileOffsets.readFrom (part->chunkOffsets, _data->fileIsComplete);
     _data->_streamData->currentPosition = _data->_streamData->is->tellg ();
@@ -1075,19 +977,20 @@ TiledInputFile::initialize ()
     }
 
     //
-    // Create all the TileBuffers and allocate their internal buffers
+    // Create all the TileBuffers
     //
 
+    Compression comp = _data->header.compression ();
+
     for (size_t i = 0; i < _data->tileBuffers.size (); i++)
     {
-        _data->tileBuffers[i] = new TileBuffer (newTileCompressor (
-            _data->header.compression (),
-            _data->maxBytesPerTileLine,
-            _data->tileDesc.ySize,
-            _data->header));
-
-        if (!_data->_streamData->is->isMemoryMapped ())
-            _data->tileBuffers[i]->buffer = new char[_data->tileBufferSize];
+        _data->tileBuffers[i] = new TileBuffer (
+            coreCanUncompress (comp) ? 0
+                                     : newTileCompressor (
+                                           comp,
+                                           _data->maxBytesPerTileLine,
+                                           _data->tileDesc.ySize,
+                                           _data->header));
     }
 
     _data->tileOffsets = TileOffsets (
@@ -1100,15 +1003,20 @@ TiledInputFile::initialize ()
 
 TiledInputFile::~TiledInputFile ()
 {
-    if (!_data->memoryMapped)
-        for (size_t i = 0; i < _data->tileBuffers.size (); i++)
-            delete[] _data->tileBuffers[i]->buffer;
-
-    if (_data->_deleteStream) delete _data->_streamData->is;
+    //
+    // The tile buffers' decode pipelines refer to the stream's
+    // OpenEXRCore context, so they go first.
+    //
 
-    if (_data->partNumber == -1) delete _data->_streamData;
+    InputStreamMutex* streamData = _data->_streamData;
+    IStream*          is         = _data->_deleteStream ? streamData->is : 0;
+    bool              ownsStreamData = _data->partNumber == -1;
 
     delete _data;
+
+    if (ownsStreamData) delete streamData;
+
+    delete is;
 }
 
 const char*
@@ -1279,9 +1187,13 @@ TiledInputFile::readTiles (int dx1, int dx2, int dy1, int dy2, int lx, int ly)
 
     try
     {
-#if ILMTHREAD_THREADING_ENABLED
-        std::lock_guard<std::mutex> lock (*_data->_streamData);
-#endif
+        //
+        // The stream is not locked here: the tile buffer tasks read
+        // their tiles through the stream's OpenEXRCore context,
+        // which reads at explicit offsets and locks the stream only
+        // for streams without stateless reads.
+        //
+
         if (_data->slices.size () == 0)
             throw IEX_NAMESPACE::ArgExc ("No frame buffer specified "
                                          "as pixel data destination.");
@@ -1322,10 +1234,20 @@ TiledInputFile::readTiles (int dx1, int dx2, int dy1, int dy2, int lx, int ly)
         // all tasks are complete.
         //
 
+        TileBufferErrors errors;
+
         {
             TaskGroup taskGroup;
             int       tileNumber = 0;
 
+            //
+            // Add the tasks in batches of at most one task per tile
+            // buffer, as creating a task waits for the buffer to be free
+            //
+
+            TaskBatch batch (
+                ThreadPool::globalThreadPool (), _data->tileBuffers.size ());
+
             for (int dy = dyStart; dy != dyStop; dy += dY)
             {
                 for (int dx = dx1; dx <= dx2; dx++)
@@ -1336,10 +1258,11 @@ TiledInputFile::readTiles (int dx1, int dx2, int dy1, int dy2, int lx, int ly)
                             "Tile (" << dx << ", " << dy << ", " << lx << ","
                                      << ly << ") is not a valid tile.");
 
-                    ThreadPool::addGlobalTask (newTileBufferTask (
+                    batch.add (newTileBufferTask (
                         &taskGroup,
                         _data->_streamData,
                         _data,
+                        &errors,
                         tileNumber++,
                         dx,
                         dy,
@@ -1360,27 +1283,13 @@ TiledInputFile::readTiles (int dx1, int dx2, int dy1, int dy2, int lx, int ly)
         // those exceptions occurred in another thread, not in the thread
         // that is executing this call to TiledInputFile::readTiles().
         // TileBufferTask::execute() has caught all exceptions and stored
-        // the exceptions' what() strings in the tile buffers.
-        // Now we check if any tile buffer contains a stored exception; if
-        // this is the case then we re-throw the exception in this thread.
-        // (It is possible that multiple tile buffers contain stored
-        // exceptions.  We re-throw the first exception we find and
-        // ignore all others.)
+        // the first exception's what() string in errors.  Now we check
+        // if there was an exception; if this is the case then we re-throw
+        // it in this thread.
         //
 
-        const string* exception = 0;
-
-        for (size_t i = 0; i < _data->tileBuffers.size (); ++i)
-        {
-            TileBuffer* tileBuffer = _data->tileBuffers[i];
-
-            if (tileBuffer->hasException && !exception)
-                exception = &tileBuffer->exception;
-
-            tileBuffer->hasException = false;
-        }
-
-        if (exception) throw IEX_NAMESPACE::IoExc (*exception);
+        if (errors.hasException)
+            throw IEX_NAMESPACE::IoExc (errors.exception);
     }
     catch (IEX_NAMESPACE::BaseExc& e)
     {
@@ -1429,7 +1338,8 @@ TiledInputFile::rawTileData (
             throw IEX_NAMESPACE::ArgExc ("Tried to read a tile outside "
                                          "the image file's data window.");
 
-        TileBuffer* tileBuffer = _data->getTileBuffer (0);
+        _data->rawTileDataBuffer.resize (_data->tileBufferSize);
+        char* buffer = _data->rawTileDataBuffer.data ();
 
         //
         // if file is a multipart file, we have to seek to the required tile
@@ -1450,7 +1360,7 @@ TiledInputFile::rawTileData (
             dy,
             lx,
             ly,
-            tileBuffer->buffer,
+            buffer,
             pixelDataSize);
 
         if (!isValidLevel (lx, ly) || !isValidTile (dx, dy, lx, ly))
@@ -1470,7 +1380,7 @@ TiledInputFile::rawTileData (
                 throw IEX_NAMESPACE::IoExc ("rawTileData read an invalid tile");
             }
         }
-        pixelData = tileBuffer->buffer;
+        pixelData = buffer;
     }
     catch (IEX_NAMESPACE::BaseExc& e)
     {
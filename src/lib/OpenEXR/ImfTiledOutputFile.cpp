@@ -38,7 +38,10 @@
 #include <algorithm>
 #include <assert.h>
 #include <fstream>
+#include <limits>
 #include <map>
+#include <stdio.h>
+#include <string.h>
 #include <string>
 #include <vector>
 
@@ -50,8 +53,10 @@
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
+using ILMTHREAD_NAMESPACE::RecycledTask;
 using ILMTHREAD_NAMESPACE::Semaphore;
 using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskBatch;
 using ILMTHREAD_NAMESPACE::TaskGroup;
 using ILMTHREAD_NAMESPACE::ThreadPool;
 using IMATH_NAMESPACE::Box2i;
@@ -128,16 +133,23 @@ struct TileCoord
 
 struct BufferedTile
 {
-    char* pixelData;
-    int   pixelDataSize;
+    char*    pixelData; // 0 if the tile is in the spill file
+    int      pixelDataSize;
+    uint64_t spillOffset; // position in the spill file
 
     BufferedTile (const char* data, int size)
-        : pixelData (0), pixelDataSize (size)
+        : pixelData (0), pixelDataSize (size), spillOffset (0)
     {
         pixelData = new char[pixelDataSize];
         memcpy (pixelData, data, pixelDataSize);
     }
 
+    BufferedTile (uint64_t offset, int size)
+        : pixelData (0), pixelDataSize (size), spillOffset (offset)
+    {
+        // empty
+    }
+
     ~BufferedTile () { delete[] pixelData; }
 
     BufferedTile (const BufferedTile& other) = delete;
@@ -148,6 +160,89 @@ struct BufferedTile
 
 typedef map<TileCoord, BufferedTile*> TileMap;
 
+//
+// A temporary file for out-of-order tiles that exceed the
+// memory limit set with setOutOfOrderTileLimit().  Tiles are
+// appended, and the file is deleted when it is closed.
+//
+
+class TileSpillFile
+{
+public:
+    TileSpillFile () : _file (0), _size (0) {}
+    ~TileSpillFile ()
+    {
+        if (_file) fclose (_file);
+    }
+
+    TileSpillFile (const TileSpillFile& other)            = delete;
+    TileSpillFile& operator= (const TileSpillFile& other) = delete;
+    TileSpillFile (TileSpillFile&& other)                 = delete;
+    TileSpillFile& operator= (TileSpillFile&& other)      = delete;
+
+    //
+    // Stores size bytes and returns their position in the file
+    //
+
+    uint64_t write (const char data[], int size);
+
+    void read (uint64_t offset, char data[], int size);
+
+private:
+    void seek (uint64_t offset);
+
+    FILE*    _file;
+    uint64_t _size;
+};
+
+void
+TileSpillFile::seek (uint64_t offset)
+{
+#ifdef _WIN32
+    int result = _fseeki64 (_file, static_cast<__int64> (offset), SEEK_SET);
+#else
+    int result = fseeko (_file, static_cast<off_t> (offset), SEEK_SET);
+#endif
+
+    if (result != 0)
+        IEX_NAMESPACE::throwErrnoExc (
+            "Cannot seek in the temporary file for out-of-order tiles (%T).");
+}
+
+uint64_t
+TileSpillFile::write (const char data[], int size)
+{
+    if (!_file)
+    {
+        _file = tmpfile ();
+
+        if (!_file)
+            IEX_NAMESPACE::throwErrnoExc (
+                "Cannot create a temporary file for out-of-order tiles (%T).");
+    }
+
+    uint64_t offset = _size;
+
+    seek (offset);
+
+    if (fwrite (data, 1, size, _file) != static_cast<size_t> (size))
+        IEX_NAMESPACE::throwErrnoExc (
+            "Cannot write to the temporary file for out-of-order tiles (%T).");
+
+    _size += size;
+    return offset;
+}
+
+void
+TileSpillFile::read (uint64_t offset, char data[], int size)
+{
+    seek (offset);
+
+    if (fread (data, 1, size, _file) != static_cast<size_t> (size))
+        IEX_NAMESPACE::throwErrnoExc (
+            "Cannot read from the temporary file for out-of-order tiles (%T).");
+}
+
 struct TileBuffer
 {
     Array<char> buffer;
@@ -161,7 +256,7 @@ struct TileBuffer
     TileBuffer (Compressor* comp);
     ~TileBuffer ();
 
-    inline void wait () { _sem.wait (); }
+    inline void wait (TaskGroup* group) { group->waitFor (_sem); }
     inline void post () { _sem.post (); }
 
 protected:
@@ -184,6 +279,34 @@ TileBuffer::~TileBuffer ()
     delete compressor;
 }
 
+//
+// The position of the value of header's lineOrder attribute
+// relative to the start of the header, as Header::writeTo()
+// lays it out: the name, the type name, the size and the value
+// of every attribute, in the order of the header's iterator.
+//
+
+uint64_t
+lineOrderValueOffset (const Header& header)
+{
+    uint64_t offset = 0;
+
+    for (Header::ConstIterator i = header.begin (); i != header.end (); ++i)
+    {
+        offset += strlen (i.name ()) + 1;
+        offset += strlen (i.attribute ().typeName ()) + 1;
+        offset += Xdr::size<int> ();
+
+        if (!strcmp (i.name (), "lineOrder")) return offset;
+
+        StdOSStream oss;
+        i.attribute ().writeValueTo (oss, EXR_VERSION);
+        offset += oss.str ().length ();
+    }
+
+    throw IEX_NAMESPACE::ArgExc ("Header has no line order attribute.");
+}
+
 } // namespace
 
 struct TiledOutputFile::Data
@@ -194,6 +317,8 @@ struct TiledOutputFile::Data
     TileDescription tileDesc;    // describes the tile layout
     FrameBuffer     frameBuffer; // framebuffer to write into
     uint64_t        previewPosition;
+    uint64_t        lineOrderPosition; // where the header's line order
+                                       // value is stored in the file
     LineOrder       lineOrder; // the file's lineorder
     int             minX;      // data window's min x coord
     int             maxX;      // data window's max x coord
@@ -222,6 +347,17 @@ struct TiledOutputFile::Data
     TileMap   tileMap;
     TileCoord nextTileToWrite;
 
+    //
+    // Limits the memory used by tileMap, see setOutOfOrderTileLimit()
+    //
+
+    size_t                           tileMapBytes; // pixel data in memory
+    size_t                           maxTileMapBytes;
+    TiledOutputFile::OutOfOrderTiles outOfOrderTiles;
+    bool                             tilesInAnyOrder; // gave up sorting
+    TileSpillFile                    spillFile;
+    vector<char>                     spillBuffer;
+
     int partNumber; // the output part number
 
     Data (int numThreads);
@@ -242,9 +378,14 @@ struct TiledOutputFile::Data
 
 TiledOutputFile::Data::Data (int numThreads)
     : multipart (false)
+    , lineOrderPosition (0)
     , numXTiles (0)
     , numYTiles (0)
     , tileOffsetsPosition (0)
+    , tileMapBytes (0)
+    , maxTileMapBytes (std::numeric_limits<size_t>::max ())
+    , outOfOrderTiles (TiledOutputFile::SPILL_OUT_OF_ORDER_TILES)
+    , tilesInAnyOrder (false)
     , partNumber (-1)
 {
     //
@@ -438,6 +579,98 @@ writeTileData (
     if (ofd->multipart) { streamData->currentPosition += Xdr::size<int> (); }
 }
 
+//
+// Writes a tile kept in ofd->tileMap to the file and removes it
+//
+
+void
+writeBufferedTile (
+    OutputStreamMutex*     streamData,
+    TiledOutputFile::Data* ofd,
+    TileMap::iterator      i)
+{
+    BufferedTile* tile      = i->second;
+    const char*   pixelData = tile->pixelData;
+
+    if (!pixelData)
+    {
+        if (ofd->spillBuffer.size () < static_cast<size_t> (tile->pixelDataSize))
+            ofd->spillBuffer.resize (tile->pixelDataSize);
+
+        ofd->spillFile.read (
+            tile->spillOffset, ofd->spillBuffer.data (), tile->pixelDataSize);
+
+        pixelData = ofd->spillBuffer.data ();
+    }
+
+    writeTileData (
+        streamData,
+        ofd,
+        i->first.dx,
+        i->first.dy,
+        i->first.lx,
+        i->first.ly,
+        pixelData,
+        tile->pixelDataSize);
+
+    if (tile->pixelData) ofd->tileMapBytes -= tile->pixelDataSize;
+
+    delete tile;
+    ofd->tileMap.erase (i);
+}
+
+//
+// Keeps a tile that cannot be written yet in ofd->tileMap, in
+// memory if it fits under the limit, else in the spill file.
+// Or, if the limit says so, stops sorting the tiles and writes
+// the kept tiles and this one right away.
+//
+
+void
+bufferTile (
+    OutputStreamMutex*     streamData,
+    TiledOutputFile::Data* ofd,
+    const TileCoord&       tile,
+    const char             pixelData[],
+    int                    pixelDataSize)
+{
+    if (ofd->tileMapBytes <= ofd->maxTileMapBytes &&
+        static_cast<size_t> (pixelDataSize) <=
+            ofd->maxTileMapBytes - ofd->tileMapBytes)
+    {
+        ofd->tileMap[tile] = new BufferedTile (pixelData, pixelDataSize);
+        ofd->tileMapBytes += pixelDataSize;
+    }
+    else if (ofd->outOfOrderTiles == TiledOutputFile::SPILL_OUT_OF_ORDER_TILES)
+    {
+        uint64_t offset = ofd->spillFile.write (pixelData, pixelDataSize);
+        ofd->tileMap[tile] = new BufferedTile (offset, pixelDataSize);
+    }
+    else
+    {
+        //
+        // The file is closed with RANDOM_Y in its header,
+        // see ~TiledOutputFile ()
+        //
+
+        ofd->tilesInAnyOrder     = true;
+        ofd->header.lineOrder () = RANDOM_Y;
+
+        while (!ofd->tileMap.empty ())
+            writeBufferedTile (streamData, ofd, ofd->tileMap.begin ());
+
+        writeTileData (
+            streamData,
+            ofd,
+            tile.dx,
+            tile.dy,
+            tile.lx,
+            tile.ly,
+            pixelData,
+            pixelDataSize);
+    }
+}
+
 void
 bufferedTileWrite (
     OutputStreamMutex*     streamData,
@@ -466,9 +699,11 @@ bufferedTileWrite (
 
     //
     // If tiles can be written in random order, then don't buffer anything.
+    // This is also the case once the memory limit for out-of-order tiles
+    // has made the file give up sorting them.
     //
 
-    if (ofd->lineOrder == RANDOM_Y)
+    if (ofd->lineOrder == RANDOM_Y || ofd->tilesInAnyOrder)
     {
         writeTileData (
             streamData, ofd, dx, dy, lx, ly, pixelData, pixelDataSize);
@@ -520,18 +755,7 @@ bufferedTileWrite (
             // Write the tile, and then delete the tile's buffered data
             //
 
-            writeTileData (
-                streamData,
-                ofd,
-                i->first.dx,
-                i->first.dy,
-                i->first.lx,
-                i->first.ly,
-                i->second->pixelData,
-                i->second->pixelDataSize);
-
-            delete i->second;
-            ofd->tileMap.erase (i);
+            writeBufferedTile (streamData, ofd, i);
 
             //
             // Proceed to the next tile
@@ -548,8 +772,7 @@ bufferedTileWrite (
         // insert it into the tileMap.
         //
 
-        ofd->tileMap[currentTile] =
-            new BufferedTile ((const char*) pixelData, pixelDataSize);
+        bufferTile (streamData, ofd, currentTile, pixelData, pixelDataSize);
     }
 }
 
@@ -617,7 +840,7 @@ convertToXdr (
 // if necessary.
 //
 
-class TileBufferTask : public Task
+class TileBufferTask : public RecycledTask
 {
 public:
     TileBufferTask (
@@ -646,13 +869,15 @@ TileBufferTask::TileBufferTask (
     int                    dy,
     int                    lx,
     int                    ly)
-    : Task (group), _ofd (ofd), _tileBuffer (_ofd->getTileBuffer (number))
+    : RecycledTask (group)
+    , _ofd (ofd)
+    , _tileBuffer (_ofd->getTileBuffer (number))
 {
     //
     // Wait for the tileBuffer to become available
     //
 
-    _tileBuffer->wait ();
+    _tileBuffer->wait (group);
     _tileBuffer->tileCoord = TileCoord (dx, dy, lx, ly);
 }
 
@@ -835,6 +1060,8 @@ TiledOutputFile::TiledOutputFile (
 
         // Write header and empty offset table to the file.
         writeMagicNumberAndVersionField (*_streamData->os, _data->header);
+        _data->lineOrderPosition = _streamData->os->tellp () +
+                                   lineOrderValueOffset (_data->header);
         _data->previewPosition = _data->header.writeTo (*_streamData->os, true);
         _data->tileOffsetsPosition =
             _data->tileOffsets.writeTo (*_streamData->os);
@@ -882,6 +1109,8 @@ TiledOutputFile::TiledOutputFile (
 
         // Write header and empty offset table to the file.
         writeMagicNumberAndVersionField (*_streamData->os, _data->header);
+        _data->lineOrderPosition = _streamData->os->tellp () +
+                                   lineOrderValueOffset (_data->header);
         _data->previewPosition = _data->header.writeTo (*_streamData->os, true);
         _data->tileOffsetsPosition =
             _data->tileOffsets.writeTo (*_streamData->os);
@@ -922,6 +1151,8 @@ TiledOutputFile::TiledOutputFile (const OutputPartData* part)
         _data->partNumber          = part->partNumber;
         _data->tileOffsetsPosition = part->chunkOffsetTablePosition;
         _data->previewPosition     = part->previewPosition;
+        _data->lineOrderPosition =
+            part->headerPosition + lineOrderValueOffset (part->header);
     }
     catch (IEX_NAMESPACE::BaseExc& e)
     {
@@ -1049,6 +1280,20 @@ TiledOutputFile::~TiledOutputFile ()
                     _streamData->os->seekp (_data->tileOffsetsPosition);
                     _data->tileOffsets.writeTo (*_streamData->os);
 
+                    //
+                    // If the tiles were not written in the header's
+                    // line order, say so in the header.  The line
+                    // order is a one byte value, so it can be
+                    // changed in place.
+                    //
+
+                    if (_data->tilesInAnyOrder && _data->lineOrderPosition > 0)
+                    {
+                        _streamData->os->seekp (_data->lineOrderPosition);
+                        Xdr::write<StreamIO> (
+                            *_streamData->os, (unsigned char) RANDOM_Y);
+                    }
+
                     //
                     // Restore the original position.
                     //
@@ -1238,16 +1483,18 @@ TiledOutputFile::writeTiles (int dx1, int dx2, int dy1, int dy2, int lx, int ly)
             TaskGroup taskGroup;
 
             //
-            // Add in the initial compression tasks to the thread pool
+            // Add in the initial compression tasks to the thread pool,
+            // all at once
             //
 
-            int nextCompBuffer = 0;
-            int dxComp         = dx1;
-            int dyComp         = dyStart;
+            int       nextCompBuffer = 0;
+            int       dxComp         = dx1;
+            int       dyComp         = dyStart;
+            TaskBatch batch (ThreadPool::globalThreadPool (), numTasks);
 
             while (nextCompBuffer < numTasks)
             {
-                ThreadPool::addGlobalTask (new TileBufferTask (
+                batch.add (new TileBufferTask (
                     &taskGroup,
                     _data,
                     nextCompBuffer++,
@@ -1264,6 +1511,8 @@ TiledOutputFile::writeTiles (int dx1, int dx2, int dy1, int dy2, int lx, int ly)
                 }
             }
 
+            batch.flush ();
+
             //
             // Write the compressed buffers and add in more compression
             // tasks until done
@@ -1282,7 +1531,7 @@ TiledOutputFile::writeTiles (int dx1, int dx2, int dy1, int dy2, int lx, int ly)
                 TileBuffer* writeBuffer =
                     _data->getTileBuffer (nextWriteBuffer);
 
-                writeBuffer->wait ();
+                writeBuffer->wait (&taskGroup);
 
                 //
                 // Write the tilebuffer
@@ -1408,6 +1657,25 @@ TiledOutputFile::writeTile (int dx, int dy, int l)
     writeTile (dx, dy, l, l);
 }
 
+void
+TiledOutputFile::setOutOfOrderTileLimit (size_t maxBytes, OutOfOrderTiles mode)
+{
+#if ILMTHREAD_THREADING_ENABLED
+    std::lock_guard<std::mutex> lock (*_streamData);
+#endif
+    _data->maxTileMapBytes = maxBytes;
+    _data->outOfOrderTiles = mode;
+}
+
+size_t
+TiledOutputFile::outOfOrderTileBytes () const
+{
+#if ILMTHREAD_THREADING_ENABLED
+    std::lock_guard<std::mutex> lock (*_streamData);
+#endif
+    return _data->tileMapBytes;
+}
+
 void
 TiledOutputFile::copyPixels (TiledInputFile& in)
 {
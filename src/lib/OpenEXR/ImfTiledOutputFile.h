@@ -368,6 +368,55 @@ public:
     IMF_EXPORT
     void writeTiles (int dx1, int dx2, int dy1, int dy2, int l = 0);
 
+    //------------------------------------------------------------------
+    // Limiting the memory used by tiles written out of order:
+    //
+    // If the line order is INCREASING_Y or DECREASING_Y, writeTile()
+    // keeps a tile that is written before the tiles that precede it
+    // in the file until those have been written.  When the tiles are
+    // written in a very different order, for example in a spiral from
+    // the center of the image, most of the image may be kept.
+    //
+    // setOutOfOrderTileLimit(maxBytes,mode) limits the compressed
+    // pixel data of the tiles kept in memory to maxBytes.  A tile that
+    // does not fit is handled according to mode:
+    //
+    //   SPILL_OUT_OF_ORDER_TILES	The tile is kept in a temporary
+    //				file instead, and copied from there
+    //				to this file when its turn comes.
+    //				The tiles in the file stay in order.
+    //
+    //   WRITE_OUT_OF_ORDER_TILES	The tiles are no longer sorted: the
+    //				kept tiles, the new one and all tiles
+    //				written after it are written to the
+    //				file right away, as if the line order
+    //				was RANDOM_Y.  From then on header()
+    //				returns RANDOM_Y as the line order,
+    //				and when the file is closed, the line
+    //				order in the file's header is changed
+    //				to RANDOM_Y, too.  Readers find the
+    //				tiles through the tile offset table.
+    //
+    // By default, there is no limit.  With a limit of 0, no tiles are
+    // kept in memory.  The limit does not apply to RANDOM_Y files.
+    //
+    // outOfOrderTileBytes() returns the size of the pixel data of the
+    // tiles that are currently kept in memory.
+    //------------------------------------------------------------------
+
+    enum IMF_EXPORT_ENUM OutOfOrderTiles
+    {
+        SPILL_OUT_OF_ORDER_TILES,
+        WRITE_OUT_OF_ORDER_TILES
+    };
+
+    IMF_EXPORT
+    void setOutOfOrderTileLimit (
+        size_t maxBytes, OutOfOrderTiles mode = SPILL_OUT_OF_ORDER_TILES);
+
+    IMF_EXPORT
+    size_t outOfOrderTileBytes () const;
+
     //------------------------------------------------------------------
     // Shortcut to copy all pixels from a TiledInputFile into this file,
     // without uncompressing and then recompressing the pixel data.
@@ -160,6 +160,19 @@ TiledOutputPart::writeTiles (int dx1, int dx2, int dy1, int dy2, int l)
     file->writeTiles (dx1, dx2, dy1, dy2, l);
 }
 
+void
+TiledOutputPart::setOutOfOrderTileLimit (
+    size_t maxBytes, TiledOutputFile::OutOfOrderTiles mode)
+{
+    file->setOutOfOrderTileLimit (maxBytes, mode);
+}
+
+size_t
+TiledOutputPart::outOfOrderTileBytes () const
+{
+    return file->outOfOrderTileBytes ();
+}
+
 void
 TiledOutputPart::copyPixels (TiledInputFile& in)
 {
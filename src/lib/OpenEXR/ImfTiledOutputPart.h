@@ -9,6 +9,7 @@
 #include "ImfForward.h"
 
 #include "ImfTileDescription.h"
+#include "ImfTiledOutputFile.h"
 #include <ImathBox.h>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
@@ -75,6 +76,13 @@ public:
     IMF_EXPORT
     void writeTiles (int dx1, int dx2, int dy1, int dy2, int l = 0);
     IMF_EXPORT
+    void setOutOfOrderTileLimit (
+        size_t                           maxBytes,
+        TiledOutputFile::OutOfOrderTiles mode =
+            TiledOutputFile::SPILL_OUT_OF_ORDER_TILES);
+    IMF_EXPORT
+    size_t outOfOrderTileBytes () const;
+    IMF_EXPORT
     void copyPixels (TiledInputFile& in);
     IMF_EXPORT
     void copyPixels (InputFile& in);
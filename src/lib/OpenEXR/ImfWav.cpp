@@ -14,6 +14,7 @@
 //-----------------------------------------------------------------------------
 
 #include "ImfNamespace.h"
+#include "ImfSimd.h"
 #include <ImfWav.h>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
@@ -97,6 +98,225 @@ wdec16 (
     a      = aa;
 }
 
+#ifdef IMF_HAVE_SSE2
+
+//
+// Vectorized rows of the finest levels of the transform, where the
+// 2x2 blocks are close in memory (x offset of 2 or 4 between blocks,
+// i.e. the first two levels of 16-bit channels, or the first of
+// 32-bit ones). Each iteration handles 8 blocks of a row pair,
+// splitting the interleaved pairs into separate registers, and
+// applies the same basis functions as above in 16-bit lanes. All the
+// scalar integer math reduces modulo 2^16, so the results are bit
+// exact.
+//
+
+inline void
+wavLoadSse2 (const unsigned short* p, __m128i& even, __m128i& odd)
+{
+    __m128i v0 = _mm_loadu_si128 ((const __m128i*) p);
+    __m128i v1 = _mm_loadu_si128 ((const __m128i*) (p + 8));
+
+    even = _mm_packs_epi32 (
+        _mm_srai_epi32 (_mm_slli_epi32 (v0, 16), 16),
+        _mm_srai_epi32 (_mm_slli_epi32 (v1, 16), 16));
+    odd = _mm_packs_epi32 (_mm_srai_epi32 (v0, 16), _mm_srai_epi32 (v1, 16));
+}
+
+inline void
+wavStoreSse2 (unsigned short* p, __m128i even, __m128i odd)
+{
+    _mm_storeu_si128 ((__m128i*) p, _mm_unpacklo_epi16 (even, odd));
+    _mm_storeu_si128 ((__m128i*) (p + 8), _mm_unpackhi_epi16 (even, odd));
+}
+
+inline void
+wenc14Sse2 (__m128i a, __m128i b, __m128i& l, __m128i& h)
+{
+    // (a + b) >> 1 without the 17th bit
+    const __m128i one = _mm_set1_epi16 (1);
+
+    l = _mm_add_epi16 (
+        _mm_add_epi16 (_mm_srai_epi16 (a, 1), _mm_srai_epi16 (b, 1)),
+        _mm_and_si128 (_mm_and_si128 (a, b), one));
+    h = _mm_sub_epi16 (a, b);
+}
+
+inline void
+wdec14Sse2 (__m128i l, __m128i h, __m128i& a, __m128i& b)
+{
+    const __m128i one = _mm_set1_epi16 (1);
+    __m128i       ai  = _mm_add_epi16 (
+        _mm_add_epi16 (l, _mm_and_si128 (h, one)), _mm_srai_epi16 (h, 1));
+
+    a = ai;
+    b = _mm_sub_epi16 (ai, h);
+}
+
+inline void
+wenc16Sse2 (__m128i a, __m128i b, __m128i& l, __m128i& h)
+{
+    const __m128i off = _mm_set1_epi16 ((short) A_OFFSET);
+    const __m128i one = _mm_set1_epi16 (1);
+    __m128i       ao  = _mm_xor_si128 (a, off);
+
+    // unsigned (ao + b) >> 1, avg rounds up so take off the carry
+    __m128i m = _mm_sub_epi16 (
+        _mm_avg_epu16 (ao, b), _mm_and_si128 (_mm_xor_si128 (ao, b), one));
+
+    // ao < b unsigned, i.e. d < 0
+    __m128i neg = _mm_cmplt_epi16 (a, _mm_xor_si128 (b, off));
+
+    l = _mm_xor_si128 (m, _mm_and_si128 (neg, off));
+    h = _mm_sub_epi16 (ao, b);
+}
+
+inline void
+wdec16Sse2 (__m128i l, __m128i h, __m128i& a, __m128i& b)
+{
+    const __m128i off = _mm_set1_epi16 ((short) A_OFFSET);
+    __m128i       bb  = _mm_sub_epi16 (l, _mm_srli_epi16 (h, 1));
+
+    b = bb;
+    a = _mm_sub_epi16 (_mm_add_epi16 (h, bb), off);
+}
+
+inline void
+wavLoad2Sse2 (const unsigned short* p, __m128i& even, __m128i& odd)
+{
+    // every other value belongs to another level or interleaved
+    // component, drop those and handle as above
+    __m128i v0 = _mm_loadu_si128 ((const __m128i*) p);
+    __m128i v1 = _mm_loadu_si128 ((const __m128i*) (p + 8));
+    __m128i v2 = _mm_loadu_si128 ((const __m128i*) (p + 16));
+    __m128i v3 = _mm_loadu_si128 ((const __m128i*) (p + 24));
+    __m128i w0 = _mm_packs_epi32 (
+        _mm_srai_epi32 (_mm_slli_epi32 (v0, 16), 16),
+        _mm_srai_epi32 (_mm_slli_epi32 (v1, 16), 16));
+    __m128i w1 = _mm_packs_epi32 (
+        _mm_srai_epi32 (_mm_slli_epi32 (v2, 16), 16),
+        _mm_srai_epi32 (_mm_slli_epi32 (v3, 16), 16));
+
+    even = _mm_packs_epi32 (
+        _mm_srai_epi32 (_mm_slli_epi32 (w0, 16), 16),
+        _mm_srai_epi32 (_mm_slli_epi32 (w1, 16), 16));
+    odd = _mm_packs_epi32 (_mm_srai_epi32 (w0, 16), _mm_srai_epi32 (w1, 16));
+}
+
+inline void
+wavStore2Sse2 (unsigned short* p, __m128i even, __m128i odd)
+{
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128i keep = _mm_set1_epi32 ((int) 0xffff0000);
+    __m128i       w0   = _mm_unpacklo_epi16 (even, odd);
+    __m128i       w1   = _mm_unpackhi_epi16 (even, odd);
+    __m128i       v[4];
+
+    v[0] = _mm_unpacklo_epi16 (w0, zero);
+    v[1] = _mm_unpackhi_epi16 (w0, zero);
+    v[2] = _mm_unpacklo_epi16 (w1, zero);
+    v[3] = _mm_unpackhi_epi16 (w1, zero);
+    for (int i = 0; i < 4; ++i)
+    {
+        __m128i* dst = (__m128i*) (p + 8 * i);
+        _mm_storeu_si128 (
+            dst,
+            _mm_or_si128 (
+                v[i], _mm_and_si128 (_mm_loadu_si128 (dst), keep)));
+    }
+}
+
+inline void
+wav2Encode8Sse2 (__m128i& a, __m128i& b, __m128i& c, __m128i& d, bool w14)
+{
+    __m128i i00, i01, i10, i11;
+
+    if (w14)
+    {
+        wenc14Sse2 (a, b, i00, i01);
+        wenc14Sse2 (c, d, i10, i11);
+        wenc14Sse2 (i00, i10, a, c);
+        wenc14Sse2 (i01, i11, b, d);
+    }
+    else
+    {
+        wenc16Sse2 (a, b, i00, i01);
+        wenc16Sse2 (c, d, i10, i11);
+        wenc16Sse2 (i00, i10, a, c);
+        wenc16Sse2 (i01, i11, b, d);
+    }
+}
+
+inline void
+wav2Decode8Sse2 (__m128i& a, __m128i& b, __m128i& c, __m128i& d, bool w14)
+{
+    __m128i i00, i01, i10, i11;
+
+    if (w14)
+    {
+        wdec14Sse2 (a, c, i00, i10);
+        wdec14Sse2 (b, d, i01, i11);
+        wdec14Sse2 (i00, i01, a, b);
+        wdec14Sse2 (i10, i11, c, d);
+    }
+    else
+    {
+        wdec16Sse2 (a, c, i00, i10);
+        wdec16Sse2 (b, d, i01, i11);
+        wdec16Sse2 (i00, i01, a, b);
+        wdec16Sse2 (i10, i11, c, d);
+    }
+}
+
+//
+// Handles blocks from px while there are 8 left, returns where the
+// scalar code should continue
+//
+
+unsigned short*
+wav2RowSse2 (
+    unsigned short*       px,
+    const unsigned short* ex,
+    int                   ox2,
+    int                   oy1,
+    bool                  w14,
+    bool                  enc)
+{
+    __m128i a, b, c, d;
+
+    if (ox2 == 2)
+    {
+        for (; px + 14 <= ex; px += 16)
+        {
+            wavLoadSse2 (px, a, b);
+            wavLoadSse2 (px + oy1, c, d);
+            if (enc)
+                wav2Encode8Sse2 (a, b, c, d, w14);
+            else
+                wav2Decode8Sse2 (a, b, c, d, w14);
+            wavStoreSse2 (px, a, b);
+            wavStoreSse2 (px + oy1, c, d);
+        }
+    }
+    else if (ox2 == 4)
+    {
+        for (; px + 28 <= ex; px += 32)
+        {
+            wavLoad2Sse2 (px, a, b);
+            wavLoad2Sse2 (px + oy1, c, d);
+            if (enc)
+                wav2Encode8Sse2 (a, b, c, d, w14);
+            else
+                wav2Decode8Sse2 (a, b, c, d, w14);
+            wavStore2Sse2 (px, a, b);
+            wavStore2Sse2 (px + oy1, c, d);
+        }
+    }
+    return px;
+}
+
+#endif // IMF_HAVE_SSE2
+
 } // namespace
 
 //
@@ -144,6 +364,10 @@ wav2Encode (
             // X loop
             //
 
+#ifdef IMF_HAVE_SSE2
+            px = wav2RowSse2 (px, ex, ox2, oy1, w14, true);
+#endif
+
             for (; px <= ex; px += ox2)
             {
                 unsigned short* p01 = px + ox1;
@@ -274,6 +498,10 @@ wav2Decode (
             // X loop
             //
 
+#ifdef IMF_HAVE_SSE2
+            px = wav2RowSse2 (px, ex, ox2, oy1, w14, false);
+#endif
+
             for (; px <= ex; px += ox2)
             {
                 unsigned short* p01 = px + ox1;
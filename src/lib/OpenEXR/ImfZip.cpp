@@ -16,13 +16,21 @@
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
 Zip::Zip (size_t maxRawSize, int level)
-    : _maxRawSize (maxRawSize), _tmpBuffer (0), _zipLevel (level)
+    : _maxRawSize (maxRawSize)
+    , _tmpBuffer (0)
+    , _zipLevel (level)
+    , _deflateStream (0)
+    , _inflateStream (0)
 {
     _tmpBuffer = new char[_maxRawSize];
 }
 
 Zip::Zip (size_t maxScanLineSize, size_t numScanLines, int level)
-    : _maxRawSize (0), _tmpBuffer (0), _zipLevel (level)
+    : _maxRawSize (0)
+    , _tmpBuffer (0)
+    , _zipLevel (level)
+    , _deflateStream (0)
+    , _inflateStream (0)
 {
     _maxRawSize = uiMult (maxScanLineSize, numScanLines);
     _tmpBuffer  = new char[_maxRawSize];
@@ -30,6 +38,18 @@ Zip::Zip (size_t maxScanLineSize, size_t numScanLines, int level)
 
 Zip::~Zip ()
 {
+    if (_deflateStream)
+    {
+        deflateEnd (_deflateStream);
+        delete _deflateStream;
+    }
+
+    if (_inflateStream)
+    {
+        inflateEnd (_inflateStream);
+        delete _inflateStream;
+    }
+
     if (_tmpBuffer) delete[] _tmpBuffer;
 }
 
@@ -46,16 +66,16 @@ Zip::maxCompressedSize ()
         uiAdd (_maxRawSize, size_t (ceil (_maxRawSize * 0.01))), size_t (100));
 }
 
-int
-Zip::compress (const char* raw, int rawSize, char* compressed)
+void
+Zip::predict (const char* raw, size_t rawSize, char* out)
 {
     //
     // Reorder the pixel data.
     //
 
     {
-        char*       t1   = _tmpBuffer;
-        char*       t2   = _tmpBuffer + (rawSize + 1) / 2;
+        char*       t1   = out;
+        char*       t2   = out + (rawSize + 1) / 2;
         const char* stop = raw + rawSize;
 
         while (true)
@@ -77,8 +97,8 @@ Zip::compress (const char* raw, int rawSize, char* compressed)
     //
 
     {
-        unsigned char* t    = (unsigned char*) _tmpBuffer + 1;
-        unsigned char* stop = (unsigned char*) _tmpBuffer + rawSize;
+        unsigned char* t    = (unsigned char*) out + 1;
+        unsigned char* stop = (unsigned char*) out + rawSize;
         int            p    = t[-1];
 
         while (t < stop)
@@ -89,25 +109,47 @@ Zip::compress (const char* raw, int rawSize, char* compressed)
             ++t;
         }
     }
+}
+
+int
+Zip::compress (const char* raw, int rawSize, char* compressed)
+{
+    predict (raw, rawSize, _tmpBuffer);
 
     //
-    // Compress the data using zlib
+    // Compress the data using zlib, this produces the same
+    // stream as compress2 ()
     //
 
-    uLong inSize = static_cast<uLong> (rawSize);
-    uLong outSize = compressBound (inSize);
+    if (!_deflateStream)
+    {
+        z_stream* strm = new z_stream ();
+
+        if (Z_OK != deflateInit (strm, _zipLevel))
+        {
+            delete strm;
+            throw IEX_NAMESPACE::BaseExc ("Data compression (zlib) failed.");
+        }
 
-    if (Z_OK != ::compress2 (
-                    reinterpret_cast<Bytef*> (compressed),
-                    &outSize,
-                    reinterpret_cast<const Bytef*> (_tmpBuffer),
-                    inSize,
-                    _zipLevel))
+        _deflateStream = strm;
+    }
+    else if (Z_OK != deflateReset (_deflateStream))
     {
         throw IEX_NAMESPACE::BaseExc ("Data compression (zlib) failed.");
     }
 
-    return outSize;
+    _deflateStream->next_in   = reinterpret_cast<Bytef*> (_tmpBuffer);
+    _deflateStream->avail_in  = static_cast<uInt> (rawSize);
+    _deflateStream->next_out  = reinterpret_cast<Bytef*> (compressed);
+    _deflateStream->avail_out = static_cast<uInt> (
+        compressBound (static_cast<uLong> (rawSize)));
+
+    if (Z_STREAM_END != deflate (_deflateStream, Z_FINISH))
+    {
+        throw IEX_NAMESPACE::BaseExc ("Data compression (zlib) failed.");
+    }
+
+    return static_cast<int> (_deflateStream->total_out);
 }
 
 namespace
@@ -239,6 +281,20 @@ auto interleave = interleave_scalar;
 
 } // namespace
 
+void
+Zip::unpredict (char* buf, size_t size, char* raw)
+{
+    //
+    // Predictor.
+    //
+    reconstruct (buf, size);
+
+    //
+    // Reorder the pixel data.
+    //
+    interleave (buf, size, raw);
+}
+
 int
 Zip::uncompress (const char* compressed, int compressedSize, char* raw)
 {
@@ -246,29 +302,40 @@ Zip::uncompress (const char* compressed, int compressedSize, char* raw)
     // Decompress the data using zlib
     //
 
-    uLong outSize = static_cast<uLong> (_maxRawSize);
-    uLong inSize = static_cast<uLong> (compressedSize);
+    if (!_inflateStream)
+    {
+        z_stream* strm = new z_stream ();
 
-    if (Z_OK != ::uncompress (
-                    reinterpret_cast<Bytef*> (_tmpBuffer),
-                    &outSize,
-                    reinterpret_cast<const Bytef*> (compressed),
-                    inSize))
+        if (Z_OK != inflateInit (strm))
+        {
+            delete strm;
+            throw IEX_NAMESPACE::InputExc (
+                "Data decompression (zlib) failed.");
+        }
+
+        _inflateStream = strm;
+    }
+    else if (Z_OK != inflateReset (_inflateStream))
     {
         throw IEX_NAMESPACE::InputExc ("Data decompression (zlib) failed.");
     }
 
-    if (outSize == 0) { return outSize; }
+    _inflateStream->next_in =
+        reinterpret_cast<Bytef*> (const_cast<char*> (compressed));
+    _inflateStream->avail_in  = static_cast<uInt> (compressedSize);
+    _inflateStream->next_out  = reinterpret_cast<Bytef*> (_tmpBuffer);
+    _inflateStream->avail_out = static_cast<uInt> (_maxRawSize);
 
-    //
-    // Predictor.
-    //
-    reconstruct (_tmpBuffer, outSize);
+    if (Z_STREAM_END != inflate (_inflateStream, Z_FINISH))
+    {
+        throw IEX_NAMESPACE::InputExc ("Data decompression (zlib) failed.");
+    }
 
-    //
-    // Reorder the pixel data.
-    //
-    interleave (_tmpBuffer, outSize, raw);
+    uLong outSize = _inflateStream->total_out;
+
+    if (outSize == 0) { return outSize; }
+
+    unpredict (_tmpBuffer, outSize, raw);
 
     return outSize;
 }
@@ -11,6 +11,8 @@
 
 #include <cstddef>
 
+struct z_stream_s;
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
 
 class Zip
@@ -32,6 +34,12 @@ public:
     // Compress the raw data into the provided buffer.
     // Returns the amount of compressed data.
     //
+    // The deflate and inflate streams are created on first use
+    // and reset for each call after that, rather than setting up
+    // the zlib state (window, hash tables) again for every chunk.
+    // A Zip object must therefore not be used by several threads
+    // at once, which the compressors holding one never do.
+    //
     int compress (const char* raw, int rawSize, char* compressed);
 
     //
@@ -40,12 +48,24 @@ public:
     //
     int uncompress (const char* compressed, int compressedSize, char* raw);
 
+    //
+    // The byte reordering and delta predictor applied to the data
+    // before deflate, also used by the other lossless codecs built
+    // on the same pre-pass. predict() writes rawSize bytes to out,
+    // unpredict() undoes it in place in buf, then writes the size
+    // reordered bytes to raw.
+    //
+    static void predict (const char* raw, size_t rawSize, char* out);
+    static void unpredict (char* buf, size_t size, char* raw);
+
     static void initializeFuncs ();
 
 private:
-    size_t _maxRawSize;
-    char*  _tmpBuffer;
-    int    _zipLevel;
+    size_t      _maxRawSize;
+    char*       _tmpBuffer;
+    int         _zipLevel;
+    z_stream_s* _deflateStream;
+    z_stream_s* _inflateStream;
 };
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
@@ -14,6 +14,7 @@
 #include "ImfCheckedArithmetic.h"
 #include "ImfHeader.h"
 #include "ImfNamespace.h"
+#include "ImfProbe.h"
 #include <zlib.h>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
@@ -46,6 +47,12 @@ int
 ZipCompressor::compress (
     const char* inPtr, int inSize, int minY, const char*& outPtr)
 {
+    IMF_PROBE_SCOPE (
+        compressor_compress,
+        _numScanLines == 1 ? ZIPS_COMPRESSION : ZIP_COMPRESSION,
+        inSize,
+        minY);
+
     //
     // Special case �- empty input buffer
     //
@@ -66,6 +73,12 @@ int
 ZipCompressor::uncompress (
     const char* inPtr, int inSize, int minY, const char*& outPtr)
 {
+    IMF_PROBE_SCOPE (
+        compressor_uncompress,
+        _numScanLines == 1 ? ZIPS_COMPRESSION : ZIP_COMPRESSION,
+        inSize,
+        minY);
+
     //
     // Special case �- empty input buffer
     //
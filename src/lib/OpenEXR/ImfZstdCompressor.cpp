@@ -0,0 +1,166 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+//-----------------------------------------------------------------------------
+//
+//	class ZstdCompressor
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfZstdCompressor.h"
+#include "Iex.h"
+#include "ImfCheckedArithmetic.h"
+#include "ImfHeader.h"
+#include "ImfNamespace.h"
+#include "ImfProbe.h"
+#include "ImfZip.h"
+
+#include "OpenEXRConfigInternal.h"
+
+#ifdef OPENEXR_HAVE_ZSTD
+#    include <zstd.h>
+#endif
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+ZstdCompressor::ZstdCompressor (
+    const Header& hdr, size_t maxScanLineSize, size_t numScanLines)
+    : Compressor (hdr)
+    , _numScanLines (numScanLines)
+    , _level (hdr.zstdCompressionLevel ())
+    , _maxRawSize (uiMult (maxScanLineSize, numScanLines))
+    , _maxCompressedSize (0)
+    , _tmpBuffer (0)
+    , _outBuffer (0)
+    , _cctx (0)
+    , _dctx (0)
+{
+#ifdef OPENEXR_HAVE_ZSTD
+    if (_level < 1) _level = 1;
+    if (_level > ZSTD_maxCLevel ()) _level = ZSTD_maxCLevel ();
+
+    _maxCompressedSize = ZSTD_compressBound (_maxRawSize);
+    _tmpBuffer         = new char[_maxRawSize];
+    _outBuffer         = new char[_maxCompressedSize];
+#else
+    throw IEX_NAMESPACE::ArgExc (
+        "ZSTD compression is not supported by this build of the library.");
+#endif
+}
+
+ZstdCompressor::~ZstdCompressor ()
+{
+#ifdef OPENEXR_HAVE_ZSTD
+    ZSTD_freeCCtx (_cctx);
+    ZSTD_freeDCtx (_dctx);
+#endif
+    delete[] _tmpBuffer;
+    delete[] _outBuffer;
+}
+
+int
+ZstdCompressor::numScanLines () const
+{
+    return _numScanLines;
+}
+
+int
+ZstdCompressor::compress (
+    const char* inPtr, int inSize, int minY, const char*& outPtr)
+{
+    IMF_PROBE_SCOPE (compressor_compress, ZSTD_COMPRESSION, inSize, minY);
+
+    //
+    // Special case - empty input buffer
+    //
+
+    if (inSize == 0)
+    {
+        outPtr = _outBuffer;
+        return 0;
+    }
+
+#ifdef OPENEXR_HAVE_ZSTD
+    Zip::predict (inPtr, inSize, _tmpBuffer);
+
+    //
+    // The compression context is kept for the lifetime of the
+    // compressor, zstd resets it for each chunk
+    //
+
+    if (!_cctx)
+    {
+        _cctx = ZSTD_createCCtx ();
+
+        if (!_cctx)
+            throw IEX_NAMESPACE::BaseExc ("Data compression (zstd) failed.");
+    }
+
+    size_t outSize = ZSTD_compressCCtx (
+        _cctx, _outBuffer, _maxCompressedSize, _tmpBuffer, inSize, _level);
+
+    if (ZSTD_isError (outSize))
+    {
+        THROW (
+            IEX_NAMESPACE::BaseExc,
+            "Data compression (zstd) failed: "
+                << ZSTD_getErrorName (outSize));
+    }
+
+    outPtr = _outBuffer;
+    return static_cast<int> (outSize);
+#else
+    (void) inPtr;
+    throw IEX_NAMESPACE::ArgExc (
+        "ZSTD compression is not supported by this build of the library.");
+#endif
+}
+
+int
+ZstdCompressor::uncompress (
+    const char* inPtr, int inSize, int minY, const char*& outPtr)
+{
+    IMF_PROBE_SCOPE (compressor_uncompress, ZSTD_COMPRESSION, inSize, minY);
+
+    //
+    // Special case - empty input buffer
+    //
+
+    if (inSize == 0)
+    {
+        outPtr = _outBuffer;
+        return 0;
+    }
+
+#ifdef OPENEXR_HAVE_ZSTD
+    if (!_dctx)
+    {
+        _dctx = ZSTD_createDCtx ();
+
+        if (!_dctx)
+            throw IEX_NAMESPACE::InputExc (
+                "Data decompression (zstd) failed.");
+    }
+
+    size_t outSize =
+        ZSTD_decompressDCtx (_dctx, _tmpBuffer, _maxRawSize, inPtr, inSize);
+
+    if (ZSTD_isError (outSize))
+    {
+        throw IEX_NAMESPACE::InputExc ("Data decompression (zstd) failed.");
+    }
+
+    if (outSize > 0) Zip::unpredict (_tmpBuffer, outSize, _outBuffer);
+
+    outPtr = _outBuffer;
+    return static_cast<int> (outSize);
+#else
+    (void) inPtr;
+    throw IEX_NAMESPACE::ArgExc (
+        "ZSTD compression is not supported by this build of the library.");
+#endif
+}
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
@@ -0,0 +1,62 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_ZSTD_COMPRESSOR_H
+#define INCLUDED_IMF_ZSTD_COMPRESSOR_H
+
+//-----------------------------------------------------------------------------
+//
+//	class ZstdCompressor -- applies the same byte reordering and
+//	predictor as ZipCompressor, then compresses with zstd
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfNamespace.h"
+
+#include "ImfCompressor.h"
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+class ZstdCompressor : public Compressor
+{
+public:
+    //
+    // Throws an ArgExc if the library was built without zstd
+    //
+    ZstdCompressor (
+        const Header& hdr, size_t maxScanLineSize, size_t numScanLines);
+
+    virtual ~ZstdCompressor ();
+
+    ZstdCompressor (const ZstdCompressor& other)            = delete;
+    ZstdCompressor& operator= (const ZstdCompressor& other) = delete;
+    ZstdCompressor (ZstdCompressor&& other)                 = delete;
+    ZstdCompressor& operator= (ZstdCompressor&& other)      = delete;
+
+    virtual int numScanLines () const;
+
+    virtual int
+    compress (const char* inPtr, int inSize, int minY, const char*& outPtr);
+
+    virtual int
+    uncompress (const char* inPtr, int inSize, int minY, const char*& outPtr);
+
+private:
+    int          _numScanLines;
+    int          _level;
+    size_t       _maxRawSize;
+    size_t       _maxCompressedSize;
+    char*        _tmpBuffer;
+    char*        _outBuffer;
+    ZSTD_CCtx_s* _cctx;
+    ZSTD_DCtx_s* _dctx;
+};
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
@@ -190,6 +190,26 @@ exr_get_default_zip_compression_level (int* l)
 
 /**************************************/
 
+static int sDefaultZstdLevel = 3;
+
+void
+exr_set_default_zstd_compression_level (int l)
+{
+    if (l < 1) l = 1;
+    if (l > 22) l = 22;
+    sDefaultZstdLevel = l;
+}
+
+/**************************************/
+
+void
+exr_get_default_zstd_compression_level (int* l)
+{
+    if (l) *l = sDefaultZstdLevel;
+}
+
+/**************************************/
+
 static float sDefaultDwaLevel = 45.f;
 
 void
@@ -6,6 +6,7 @@
 #include "openexr_chunkio.h"
 
 #include "internal_coding.h"
+#include "internal_stats.h"
 #include "internal_structs.h"
 #include "internal_util.h"
 #include "internal_xdr.h"
@@ -187,9 +188,10 @@ validate_and_compute_tile_chunk_off (
                     numy);
             }
 
+            /* rip levels are stored a row of x levels at a time */
             for (int ly = 0; ly < levely; ++ly)
             {
-                for (int lx = 0; lx < levelx; ++lx)
+                for (int lx = 0; lx < part->num_tile_levels_x; ++lx)
                 {
                     chunkoff +=
                         ((int64_t) part->tile_level_tile_count_x[lx] *
@@ -351,7 +353,17 @@ extract_chunk_leader (
                 "Invalid chunk size reconstructing chunk table: found out of range %ld",
                 leaderdata->deep_data[1]);
         }
+        if (leaderdata->deep_data[0] < 0 || leaderdata->deep_data[0] > maxval)
+        {
+            return ctxt->print_error (
+                ctxt,
+                EXR_ERR_BAD_CHUNK_LEADER,
+                "Invalid sample table size reconstructing chunk table: found out of range %ld",
+                leaderdata->deep_data[0]);
+        }
         leaderdata->packed_size = leaderdata->deep_packed_size;
+        /* the packed sample count table comes before the packed data */
+        nextoffset += leaderdata->deep_samples;
         nextoffset += leaderdata->deep_packed_size;
     }
     else
@@ -374,20 +386,6 @@ extract_chunk_leader (
     return rv;
 }
 
-static exr_result_t
-extract_chunk_size (
-    const struct _internal_exr_context* ctxt,
-    const struct _internal_exr_part*    part,
-    int                                 partnum,
-    uint64_t                            offset,
-    uint64_t*                           next_offset)
-{
-    struct priv_chunk_leader leader;
-
-    return extract_chunk_leader (
-        ctxt, part, partnum, offset, next_offset, &leader);
-}
-
 /**************************************/
 
 static exr_result_t
@@ -445,7 +443,265 @@ read_and_validate_chunk_leader (
     return rv;
 }
 
+/* the longest chunk leader: part number, tile coordinates and levels,
+ * and the three sizes of a deep chunk */
+#define MAX_CHUNK_LEADER_SIZE 44
+
+// quietly check whether a plausible chunk leader starts at offset,
+// and if so, where the chunk after it starts
+static int
+probe_chunk_leader (
+    const struct _internal_exr_context* ctxt,
+    uint64_t                            offset,
+    uint64_t                            max_offset,
+    uint64_t*                           next_offset)
+{
+    const struct _internal_exr_part* part;
+    uint8_t                          buf[MAX_CHUNK_LEADER_SIZE];
+    int32_t                          vals[5];
+    int64_t                          deep[3];
+    int64_t                          nread = 0;
+    int64_t                          maxval = (int64_t) INT_MAX;
+    uint64_t                         rdoff = offset, leadersz = 0, size;
+    int                              ncoords, partnum = 0;
+
+    if (ctxt->file_size > 0) maxval = ctxt->file_size;
+
+    if (ctxt->do_read (
+            ctxt, buf, sizeof (buf), &rdoff, &nread, EXR_ALLOW_SHORT_READ) !=
+        EXR_ERR_SUCCESS)
+        return 0;
+
+    if (ctxt->is_multipart)
+    {
+        if (nread < (int64_t) sizeof (int32_t)) return 0;
+        memcpy (&partnum, buf, sizeof (int32_t));
+        priv_to_native32 (&partnum, 1);
+        if (partnum < 0 || partnum >= ctxt->num_parts) return 0;
+        leadersz = sizeof (int32_t);
+    }
+
+    part = ctxt->parts[partnum];
+    if (part->storage_mode == EXR_STORAGE_SCANLINE ||
+        part->storage_mode == EXR_STORAGE_DEEP_SCANLINE)
+        ncoords = 1;
+    else if (
+        part->storage_mode == EXR_STORAGE_TILED ||
+        part->storage_mode == EXR_STORAGE_DEEP_TILED)
+        ncoords = 4;
+    else
+        return 0;
+
+    if (part->storage_mode == EXR_STORAGE_SCANLINE ||
+        part->storage_mode == EXR_STORAGE_TILED)
+    {
+        if (nread < (int64_t) (leadersz + (ncoords + 1) * sizeof (int32_t)))
+            return 0;
+        memcpy (vals, buf + leadersz, (ncoords + 1) * sizeof (int32_t));
+        priv_to_native32 (vals, ncoords + 1);
+        leadersz += (ncoords + 1) * sizeof (int32_t);
+
+        if (vals[ncoords] <= 0 || vals[ncoords] > maxval) return 0;
+        size = (uint64_t) vals[ncoords];
+    }
+    else
+    {
+        if (nread < (int64_t) (leadersz + ncoords * sizeof (int32_t) +
+                               3 * sizeof (int64_t)))
+            return 0;
+        memcpy (vals, buf + leadersz, ncoords * sizeof (int32_t));
+        priv_to_native32 (vals, ncoords);
+        leadersz += ncoords * sizeof (int32_t);
+        memcpy (deep, buf + leadersz, 3 * sizeof (int64_t));
+        priv_to_native64 (deep, 3);
+        leadersz += 3 * sizeof (int64_t);
+
+        if (deep[0] <= 0 || deep[0] > maxval || deep[1] < 0 ||
+            deep[1] > maxval)
+            return 0;
+        size = (uint64_t) deep[0] + (uint64_t) deep[1];
+    }
+
+    if (ncoords == 1)
+    {
+        if (vals[0] < part->data_window.min.y ||
+            vals[0] > part->data_window.max.y)
+            return 0;
+    }
+    else
+    {
+        if (vals[2] < 0 || vals[2] >= part->num_tile_levels_x ||
+            vals[3] < 0 || vals[3] >= part->num_tile_levels_y)
+            return 0;
+        if (vals[0] < 0 || vals[0] >= part->tile_level_tile_count_x[vals[2]] ||
+            vals[1] < 0 || vals[1] >= part->tile_level_tile_count_y[vals[3]])
+            return 0;
+    }
+
+    if (offset + leadersz + size > max_offset) return 0;
+
+    *next_offset = offset + leadersz + size;
+    return 1;
+}
+
+/* how many chunks to follow from a candidate first chunk before
+ * trusting it */
+#define PADDING_CHUNK_CHAIN 8
+
+// count the plausible chunks in a row from offset, up to
+// PADDING_CHUNK_CHAIN, which also counts for reaching the end
+// of the file
+static int
+count_chunk_chain (
+    const struct _internal_exr_context* ctxt,
+    uint64_t                            offset,
+    uint64_t                            max_offset)
+{
+    int      n = 0;
+    uint64_t next;
+
+    while (n < PADDING_CHUNK_CHAIN)
+    {
+        if (!probe_chunk_leader (ctxt, offset, max_offset, &next)) break;
+        ++n;
+        if (next == max_offset) return PADDING_CHUNK_CHAIN;
+        offset = next;
+    }
+    return n;
+}
+
+// writers may leave zeros between the chunk tables and the first
+// chunk, so the header can grow later (see exr_set_header_padding).
+// The first chunk then starts at most a chunk leader before the first
+// non-zero byte; of the places there where a chunk leader could start,
+// take the one followed by the longest run of plausible chunks.
+static uint64_t
+skip_header_padding (
+    const struct _internal_exr_context* ctxt,
+    uint64_t                            offset_start,
+    uint64_t                            max_offset)
+{
+    uint8_t  buf[4096];
+    uint64_t rdoff = offset_start, nonzero = offset_start;
+    uint64_t first, best = offset_start;
+    int64_t  nread;
+    int      found = 0, bestchain = 0;
+
+    while (!found && rdoff < max_offset)
+    {
+        uint64_t blockstart = rdoff;
+
+        nread = 0;
+        if (ctxt->do_read (
+                ctxt,
+                buf,
+                sizeof (buf),
+                &rdoff,
+                &nread,
+                EXR_ALLOW_SHORT_READ) != EXR_ERR_SUCCESS ||
+            nread <= 0)
+            return offset_start;
+
+        for (int64_t i = 0; i < nread; ++i)
+        {
+            if (buf[i] != 0)
+            {
+                nonzero = blockstart + (uint64_t) i;
+                found   = 1;
+                break;
+            }
+        }
+    }
+
+    if (!found || nonzero == offset_start) return offset_start;
+
+    first = offset_start;
+    if (nonzero - offset_start > MAX_CHUNK_LEADER_SIZE - 1)
+        first = nonzero - (MAX_CHUNK_LEADER_SIZE - 1);
+
+    for (uint64_t c = first; c <= nonzero; ++c)
+    {
+        int chain = count_chunk_chain (ctxt, c, max_offset);
+        if (chain > bestchain)
+        {
+            best      = c;
+            bestchain = chain;
+            if (chain == PADDING_CHUNK_CHAIN) break;
+        }
+    }
+
+    return best;
+}
+
 // this should behave the same as the old ImfMultiPartInputFile
+// the parts of a multi-part file may have their chunks interleaved
+// in any order, so walk every chunk after the offset tables (as the
+// c++ library does), reading the part number from each leader
+static exr_result_t
+reconstruct_multipart_chunk_table (
+    const struct _internal_exr_context* ctxt,
+    const struct _internal_exr_part*    part,
+    int                                 partnum,
+    uint64_t                            offset_start,
+    uint64_t                            max_offset,
+    uint64_t*                           chunktable)
+{
+    exr_result_t rv = EXR_ERR_SUCCESS;
+    uint64_t     chunk_start = offset_start, next_offset;
+    int64_t      total_chunks = 0;
+    int          found_ci;
+
+    for (int p = 0; p < ctxt->num_parts; ++p)
+        total_chunks += ctxt->parts[p]->chunk_count;
+
+    for (int64_t c = 0; c < total_chunks && chunk_start < max_offset; ++c)
+    {
+        const struct _internal_exr_part* curpart;
+        int32_t                          curpartnum;
+        uint64_t                         pnoff = chunk_start;
+
+        rv = ctxt->do_read (
+            ctxt,
+            &curpartnum,
+            sizeof (int32_t),
+            &pnoff,
+            NULL,
+            EXR_MUST_READ_ALL);
+        if (rv != EXR_ERR_SUCCESS) return rv;
+        priv_to_native32 (&curpartnum, 1);
+
+        if (curpartnum < 0 || curpartnum >= ctxt->num_parts)
+            return ctxt->print_error (
+                ctxt,
+                EXR_ERR_BAD_CHUNK_LEADER,
+                "Invalid part number reconstructing chunk table: found %d",
+                curpartnum);
+
+        curpart = ctxt->parts[curpartnum];
+        if (curpart->storage_mode == EXR_STORAGE_LAST_TYPE)
+            return ctxt->print_error (
+                ctxt,
+                EXR_ERR_BAD_CHUNK_LEADER,
+                "Unable to reconstruct chunk table past chunk of part %d of unknown type",
+                curpartnum);
+
+        found_ci = 0;
+        rv       = read_and_validate_chunk_leader (
+            ctxt, curpart, curpartnum, chunk_start, &found_ci, &next_offset);
+        if (rv != EXR_ERR_SUCCESS) return rv;
+
+        if (curpartnum == partnum && found_ci >= 0 &&
+            found_ci < part->chunk_count &&
+            (chunktable[found_ci] < offset_start ||
+             chunktable[found_ci] >= max_offset))
+            chunktable[found_ci] = chunk_start;
+
+        chunk_start = next_offset;
+    }
+
+    return rv;
+}
+
 static exr_result_t
 reconstruct_chunk_table (
     const struct _internal_exr_context* ctxt,
@@ -454,9 +710,8 @@ reconstruct_chunk_table (
 {
     exr_result_t                     rv = EXR_ERR_SUCCESS;
     uint64_t                         offset_start, chunk_start, max_offset;
-    uint64_t*                        curctable;
     const struct _internal_exr_part* curpart = NULL;
-    int                              maxidx, found_ci, computed_ci, partnum = 0;
+    int                              found_ci, computed_ci, partnum = 0;
 
     curpart      = ctxt->parts[ctxt->num_parts - 1];
     offset_start = curpart->chunk_table_offset;
@@ -472,29 +727,11 @@ reconstruct_chunk_table (
     max_offset = (uint64_t) -1;
     if (ctxt->file_size > 0) max_offset = (uint64_t) ctxt->file_size;
 
-    // for multi-part, need to start at the first part and extract everything, then
-    // work our way back up to this one, then grab the end of the previous part
-    if (partnum > 0)
-    {
-        curpart = ctxt->parts[partnum - 1];
-        rv      = extract_chunk_table (ctxt, curpart, &curctable, &chunk_start);
-        if (rv != EXR_ERR_SUCCESS) return rv;
-
-        chunk_start = curctable[0];
-        maxidx      = 0;
-        for (int ci = 1; ci < curpart->chunk_count; ++ci)
-        {
-            if (curctable[ci] > chunk_start)
-            {
-                maxidx      = ci;
-                chunk_start = curctable[ci];
-            }
-        }
+    offset_start = skip_header_padding (ctxt, offset_start, max_offset);
 
-        rv = extract_chunk_size (
-            ctxt, curpart, partnum - 1, chunk_start, &offset_start);
-        if (rv != EXR_ERR_SUCCESS) return rv;
-    }
+    if (ctxt->is_multipart)
+        return reconstruct_multipart_chunk_table (
+            ctxt, part, partnum, offset_start, max_offset, chunktable);
 
     for (int ci = 0; ci < part->chunk_count; ++ci)
     {
@@ -594,6 +831,7 @@ extract_chunk_table (
                 // something similar, except when in strict mode, we
                 // will fail with a corrupt chunk immediately.
                 rv = reconstruct_chunk_table (ctxt, part, ctable);
+                EXR_STATS_ADD (ctxt, part, chunk_table_reconstructions, 1);
                 if (rv != EXR_ERR_SUCCESS && ctxt->strict_header)
                 {
                     ctxt->free_fn (ctable);
@@ -4,6 +4,7 @@
 */
 
 #include "internal_coding.h"
+#include "internal_stats.h"
 #include "internal_util.h"
 
 #include <string.h>
@@ -197,6 +198,14 @@ internal_encode_alloc_buffer (
 
         *buf   = curbuf;
         *cursz = newsz;
+
+        {
+            EXR_PROMOTE_CONST_CONTEXT_AND_PART_OR_ERROR_NO_LOCK (
+                encode->context, encode->part_index);
+
+            EXR_STATS_ADD (pctxt, part, buffer_allocations, 1);
+            EXR_STATS_ADD (pctxt, part, buffer_allocated_bytes, newsz);
+        }
     }
     return EXR_ERR_SUCCESS;
 }
@@ -275,6 +284,14 @@ internal_decode_alloc_buffer (
 
         *buf   = curbuf;
         *cursz = newsz;
+
+        {
+            EXR_PROMOTE_CONST_CONTEXT_AND_PART_OR_ERROR_NO_LOCK (
+                decode->context, decode->part_index);
+
+            EXR_STATS_ADD (pctxt, part, buffer_allocations, 1);
+            EXR_STATS_ADD (pctxt, part, buffer_allocated_bytes, newsz);
+        }
     }
     return EXR_ERR_SUCCESS;
 }
@@ -377,11 +377,72 @@ exr_start_inplace_header_update (
     const char*                      filename,
     const exr_context_initializer_t* ctxtdata)
 {
-    /* TODO: not yet implemented */
-    (void) ctxt;
-    (void) filename;
-    (void) ctxtdata;
-    return EXR_ERR_INVALID_ARGUMENT;
+    exr_result_t                  rv    = EXR_ERR_UNKNOWN;
+    struct _internal_exr_context* ret   = NULL;
+    exr_context_initializer_t     inits = fill_context_data (ctxtdata);
+
+    if (!ctxt)
+    {
+        inits.error_handler_fn (
+            NULL,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Invalid context handle passed to start_inplace_header_update function");
+        return EXR_ERR_INVALID_ARGUMENT;
+    }
+
+    if ((inits.read_fn == NULL) != (inits.write_fn == NULL))
+    {
+        inits.error_handler_fn (
+            NULL,
+            EXR_ERR_INVALID_ARGUMENT,
+            "In-place header update requires both a read and write function for custom streams");
+        *ctxt = NULL;
+        return EXR_ERR_INVALID_ARGUMENT;
+    }
+
+    if (filename && filename[0] != '\0')
+    {
+        rv = internal_exr_alloc_context (
+            &ret,
+            &inits,
+            EXR_CONTEXT_UPDATE_HEADER,
+            sizeof (struct _internal_exr_filehandle));
+        if (rv == EXR_ERR_SUCCESS)
+        {
+            ret->do_read  = &dispatch_read;
+            ret->do_write = &dispatch_write;
+
+            rv = exr_attr_string_create (
+                (exr_context_t) ret, &(ret->filename), filename);
+            if (rv == EXR_ERR_SUCCESS)
+            {
+                if (!inits.read_fn)
+                {
+                    inits.size_fn = &default_query_size_func;
+                    rv            = default_init_update_file (ret);
+                }
+
+                if (rv == EXR_ERR_SUCCESS)
+                    rv = process_query_size (ret, &inits);
+                if (rv == EXR_ERR_SUCCESS) rv = internal_exr_parse_header (ret);
+            }
+
+            if (rv != EXR_ERR_SUCCESS) exr_finish ((exr_context_t*) &ret);
+        }
+        else
+            rv = EXR_ERR_OUT_OF_MEMORY;
+    }
+    else
+    {
+        inits.error_handler_fn (
+            NULL,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Invalid filename passed to start_inplace_header_update function");
+        rv = EXR_ERR_INVALID_ARGUMENT;
+    }
+
+    *ctxt = (exr_context_t) ret;
+    return rv;
 }
 
 /**************************************/
@@ -628,12 +689,31 @@ exr_set_longname_support (exr_context_t ctxt, int onoff)
 
 /**************************************/
 
+exr_result_t
+exr_set_header_padding (exr_context_t ctxt, uint32_t padbytes)
+{
+    EXR_PROMOTE_LOCKED_CONTEXT_OR_ERROR (ctxt);
+
+    if (pctxt->mode != EXR_CONTEXT_WRITE)
+        return EXR_UNLOCK_AND_RETURN_PCTXT (
+            pctxt->standard_error (pctxt, EXR_ERR_NOT_OPEN_WRITE));
+
+    pctxt->header_padding = padbytes;
+    return EXR_UNLOCK_AND_RETURN_PCTXT (EXR_ERR_SUCCESS);
+}
+
+/**************************************/
+
 exr_result_t
 exr_write_header (exr_context_t ctxt)
 {
     exr_result_t rv = EXR_ERR_SUCCESS;
     EXR_PROMOTE_LOCKED_CONTEXT_OR_ERROR (ctxt);
 
+    if (pctxt->mode == EXR_CONTEXT_UPDATE_HEADER)
+        return EXR_UNLOCK_AND_RETURN_PCTXT (
+            internal_exr_update_header_inplace (pctxt));
+
     if (pctxt->mode != EXR_CONTEXT_WRITE)
         return EXR_UNLOCK_AND_RETURN_PCTXT (
             pctxt->standard_error (pctxt, EXR_ERR_NOT_OPEN_WRITE));
@@ -692,6 +772,24 @@ exr_write_header (exr_context_t ctxt)
             pctxt->output_file_offset +=
                 (uint64_t) (curp->chunk_count) * sizeof (uint64_t);
         }
+
+        /* the reserved space sits between the chunk tables and the
+         * first chunk, so readers never see it, but an in-place
+         * update can grow the header into it */
+        if (pctxt->header_padding > 0)
+        {
+            uint8_t  zeros[1024] = {0};
+            uint64_t padstart    = pctxt->output_file_offset;
+            uint64_t left        = pctxt->header_padding;
+
+            while (rv == EXR_ERR_SUCCESS && left > 0)
+            {
+                uint64_t nb = left > sizeof (zeros) ? sizeof (zeros) : left;
+                rv          = pctxt->do_write (pctxt, zeros, nb, &padstart);
+                left -= nb;
+            }
+            pctxt->output_file_offset += pctxt->header_padding;
+        }
     }
 
     return EXR_UNLOCK_AND_RETURN_PCTXT (rv);
@@ -7,6 +7,7 @@
 
 #include "internal_coding.h"
 #include "internal_decompress.h"
+#include "internal_stats.h"
 #include "internal_structs.h"
 #include "internal_xdr.h"
 
@@ -217,8 +218,8 @@ decompress_data (
 
     if (packsz == 0) return EXR_ERR_SUCCESS;
 
-    if (packsz == unpacksz && ctype != EXR_COMPRESSION_B44 &&
-        ctype != EXR_COMPRESSION_B44A)
+    /* writers store a chunk raw whenever compressing it saves nothing */
+    if (packsz == unpacksz)
     {
         if (unpackbufptr != packbufptr)
             memcpy (unpackbufptr, packbufptr, unpacksz);
@@ -266,6 +267,14 @@ decompress_data (
             rv = internal_exr_undo_dwab (
                 decode, packbufptr, packsz, unpackbufptr, unpacksz);
             break;
+        case EXR_COMPRESSION_ZSTD:
+            rv = internal_exr_undo_zstd (
+                decode, packbufptr, packsz, unpackbufptr, unpacksz);
+            break;
+        case EXR_COMPRESSION_LZ4:
+            rv = internal_exr_undo_lz4 (
+                decode, packbufptr, packsz, unpackbufptr, unpacksz);
+            break;
         case EXR_COMPRESSION_LAST_TYPE:
         default:
             return pctxt->print_error (
@@ -424,6 +433,9 @@ exr_decoding_initialize (
         decode->part_index = part_index;
         decode->context    = ctxt;
         decode->chunk      = *cinfo;
+        decode->read_fn    = &default_read_chunk;
+        if (part->comp_type != EXR_COMPRESSION_NONE)
+            decode->decompress_fn = &default_decompress_chunk;
     }
     return rv;
 }
@@ -624,6 +636,7 @@ exr_decoding_run (
     exr_const_context_t ctxt, int part_index, exr_decode_pipeline_t* decode)
 {
     exr_result_t rv;
+    uint64_t     tstart;
     EXR_PROMOTE_READ_CONST_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
 
     if (!decode) return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
@@ -638,10 +651,27 @@ exr_decoding_run (
             pctxt,
             EXR_ERR_INVALID_ARGUMENT,
             "Decode pipeline has no read_fn declared");
-    rv = decode->read_fn (decode);
+    EXR_TRACE_BEGIN (
+        pctxt, part_index, EXR_TRACE_STAGE_READ, &(decode->chunk));
+    tstart = EXR_STATS_NOW (pctxt);
+    rv     = decode->read_fn (decode);
+    EXR_TRACE_END (
+        pctxt, part_index, EXR_TRACE_STAGE_READ, &(decode->chunk), rv);
     if (rv != EXR_ERR_SUCCESS)
         return pctxt->report_error (
             pctxt, rv, "Unable to read pixel data block from context");
+    EXR_STATS_ELAPSED (pctxt, part, read_ns, tstart);
+    EXR_STATS_ADD (pctxt, part, chunks_read, 1);
+    EXR_PROBE (
+        chunk__read,
+        part_index,
+        decode->chunk.idx,
+        decode->chunk.packed_size + decode->chunk.sample_count_table_size);
+    EXR_STATS_ADD (
+        pctxt,
+        part,
+        bytes_read,
+        decode->chunk.packed_size + decode->chunk.sample_count_table_size);
 
     if (rv == EXR_ERR_SUCCESS) rv = update_pack_unpack_ptrs (decode);
     if (rv != EXR_ERR_SUCCESS)
@@ -651,7 +681,29 @@ exr_decoding_run (
             "Decode pipeline unable to update pack / unpack pointers");
 
     if (rv == EXR_ERR_SUCCESS && decode->decompress_fn)
-        rv = decode->decompress_fn (decode);
+    {
+        EXR_TRACE_BEGIN (
+            pctxt, part_index, EXR_TRACE_STAGE_DECOMPRESS, &(decode->chunk));
+        tstart = EXR_STATS_NOW (pctxt);
+        rv     = decode->decompress_fn (decode);
+        EXR_TRACE_END (
+            pctxt,
+            part_index,
+            EXR_TRACE_STAGE_DECOMPRESS,
+            &(decode->chunk),
+            rv);
+        if (pctxt->collect_stats && rv == EXR_ERR_SUCCESS)
+        {
+            uint64_t el = internal_exr_stats_now () - tstart;
+            EXR_STATS_ADD (pctxt, part, decompress_ns, el);
+            if (decode->chunk.compression < EXR_COMPRESSION_LAST_TYPE)
+                EXR_STATS_ADD (
+                    pctxt,
+                    part,
+                    decompress_ns_by_codec[decode->chunk.compression],
+                    el);
+        }
+    }
     if (rv != EXR_ERR_SUCCESS)
         return pctxt->report_error (
             pctxt, rv, "Decode pipeline unable to decompress data");
@@ -678,7 +730,16 @@ exr_decoding_run (
             "Decode pipeline unable to realloc deep sample table info");
 
     if (rv == EXR_ERR_SUCCESS && decode->unpack_and_convert_fn)
-        rv = decode->unpack_and_convert_fn (decode);
+    {
+        EXR_TRACE_BEGIN (
+            pctxt, part_index, EXR_TRACE_STAGE_UNPACK, &(decode->chunk));
+        tstart = EXR_STATS_NOW (pctxt);
+        rv     = decode->unpack_and_convert_fn (decode);
+        EXR_TRACE_END (
+            pctxt, part_index, EXR_TRACE_STAGE_UNPACK, &(decode->chunk), rv);
+        if (rv == EXR_ERR_SUCCESS)
+            EXR_STATS_ELAPSED (pctxt, part, unpack_ns, tstart);
+    }
     if (rv != EXR_ERR_SUCCESS)
         return pctxt->report_error (
             pctxt, rv, "Decode pipeline unable to unpack and convert data");
@@ -688,6 +749,93 @@ exr_decoding_run (
 
 /**************************************/
 
+exr_result_t
+exr_decoding_reduced_size (
+    exr_const_context_t          ctxt,
+    int                          part_index,
+    const exr_decode_pipeline_t* decode,
+    int                          level,
+    uint64_t*                    size)
+{
+    EXR_PROMOTE_READ_CONST_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
+
+    if (!decode || !size)
+        return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
+    if (level < 1 || level > 3)
+        return pctxt->print_error (
+            pctxt,
+            EXR_ERR_ARGUMENT_OUT_OF_RANGE,
+            "Invalid reduced resolution level %d, must be 1, 2 or 3",
+            level);
+
+    *size = internal_exr_piz_reduced_size (decode, level);
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
+exr_result_t
+exr_decoding_run_reduced (
+    exr_const_context_t    ctxt,
+    int                    part_index,
+    exr_decode_pipeline_t* decode,
+    int                    level,
+    void*                  out,
+    uint64_t               outsz)
+{
+    exr_result_t rv;
+    EXR_PROMOTE_READ_CONST_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
+
+    if (!decode || !out)
+        return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
+    if (decode->context != ctxt || decode->part_index != part_index)
+        return pctxt->report_error (
+            pctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Invalid request for reduced decoding from different context / part");
+    if (part->comp_type != EXR_COMPRESSION_PIZ)
+        return pctxt->report_error (
+            pctxt,
+            EXR_ERR_FEATURE_NOT_IMPLEMENTED,
+            "Reduced resolution decoding is only available for PIZ compression");
+    if (level < 1 || level > 3)
+        return pctxt->print_error (
+            pctxt,
+            EXR_ERR_ARGUMENT_OUT_OF_RANGE,
+            "Invalid reduced resolution level %d, must be 1, 2 or 3",
+            level);
+    if (outsz < internal_exr_piz_reduced_size (decode, level))
+        return pctxt->print_error (
+            pctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Reduced resolution buffer too small, need %" PRIu64 " bytes",
+            internal_exr_piz_reduced_size (decode, level));
+
+    rv = default_read_chunk (decode);
+    if (rv != EXR_ERR_SUCCESS)
+        return pctxt->report_error (
+            pctxt, rv, "Unable to read pixel data block from context");
+
+    rv = internal_exr_undo_piz_reduced (
+        decode,
+        decode->packed_buffer,
+        decode->chunk.packed_size,
+        level,
+        out,
+        outsz);
+    if (rv != EXR_ERR_SUCCESS)
+        return pctxt->print_error (
+            pctxt,
+            rv,
+            "Unable to decompress image data at reduced resolution %" PRIu64
+            " -> %" PRIu64,
+            decode->chunk.packed_size,
+            outsz);
+    return rv;
+}
+
+/**************************************/
+
 exr_result_t
 exr_decoding_destroy (exr_const_context_t ctxt, exr_decode_pipeline_t* decode)
 {
@@ -7,6 +7,7 @@
 
 #include "internal_coding.h"
 #include "internal_compress.h"
+#include "internal_stats.h"
 #include "internal_structs.h"
 #include "internal_xdr.h"
 
@@ -47,6 +48,8 @@ default_compress_chunk (exr_encode_pipeline_t* encode)
         case EXR_COMPRESSION_B44A: rv = internal_exr_apply_b44a (encode); break;
         case EXR_COMPRESSION_DWAA: rv = internal_exr_apply_dwaa (encode); break;
         case EXR_COMPRESSION_DWAB: rv = internal_exr_apply_dwab (encode); break;
+        case EXR_COMPRESSION_ZSTD: rv = internal_exr_apply_zstd (encode); break;
+        case EXR_COMPRESSION_LZ4: rv = internal_exr_apply_lz4 (encode); break;
         case EXR_COMPRESSION_LAST_TYPE:
         default:
             return pctxt->print_error (
@@ -260,6 +263,7 @@ exr_encoding_run (
 {
     exr_result_t rv           = EXR_ERR_SUCCESS;
     uint64_t     packed_bytes = 0;
+    uint64_t     tstart;
     EXR_PROMOTE_CONST_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
 
     if (!encode)
@@ -348,7 +352,22 @@ exr_encoding_run (
                 packed_bytes);
 
             if (rv == EXR_ERR_SUCCESS)
-                rv = encode->convert_and_pack_fn (encode);
+            {
+                EXR_TRACE_BEGIN (
+                    pctxt,
+                    part_index,
+                    EXR_TRACE_STAGE_PACK,
+                    &(encode->chunk));
+                tstart = EXR_STATS_NOW (pctxt);
+                rv     = encode->convert_and_pack_fn (encode);
+                EXR_TRACE_END (
+                    pctxt,
+                    part_index,
+                    EXR_TRACE_STAGE_PACK,
+                    &(encode->chunk),
+                    rv);
+                EXR_STATS_ELAPSED (pctxt, part, pack_ns, tstart);
+            }
         }
     }
     else if (!encode->packed_buffer || packed_bytes != encode->compressed_bytes)
@@ -373,7 +392,30 @@ exr_encoding_run (
     {
         if (encode->compress_fn && encode->packed_bytes > 0)
         {
-            rv = encode->compress_fn (encode);
+            EXR_TRACE_BEGIN (
+                pctxt,
+                part_index,
+                EXR_TRACE_STAGE_COMPRESS,
+                &(encode->chunk));
+            tstart = EXR_STATS_NOW (pctxt);
+            rv     = encode->compress_fn (encode);
+            EXR_TRACE_END (
+                pctxt,
+                part_index,
+                EXR_TRACE_STAGE_COMPRESS,
+                &(encode->chunk),
+                rv);
+            if (pctxt->collect_stats && rv == EXR_ERR_SUCCESS)
+            {
+                uint64_t el = internal_exr_stats_now () - tstart;
+                EXR_STATS_ADD (pctxt, part, compress_ns, el);
+                if (encode->chunk.compression < EXR_COMPRESSION_LAST_TYPE)
+                    EXR_STATS_ADD (
+                        pctxt,
+                        part,
+                        compress_ns_by_codec[encode->chunk.compression],
+                        el);
+            }
         }
         else
         {
@@ -405,7 +447,32 @@ exr_encoding_run (
         rv = encode->yield_until_ready_fn (encode);
 
     if (rv == EXR_ERR_SUCCESS && encode->write_fn)
-        rv = encode->write_fn (encode);
+    {
+        EXR_TRACE_BEGIN (
+            pctxt, part_index, EXR_TRACE_STAGE_WRITE, &(encode->chunk));
+        tstart = EXR_STATS_NOW (pctxt);
+        rv     = encode->write_fn (encode);
+        EXR_TRACE_END (
+            pctxt, part_index, EXR_TRACE_STAGE_WRITE, &(encode->chunk), rv);
+        if (rv == EXR_ERR_SUCCESS)
+        {
+            EXR_STATS_ELAPSED (pctxt, part, write_ns, tstart);
+            EXR_PROBE (
+                chunk__write,
+                part_index,
+                encode->chunk.idx,
+                encode->compressed_bytes);
+            EXR_STATS_ADD (pctxt, part, chunks_written, 1);
+            EXR_STATS_ADD (pctxt, part, bytes_written, encode->compressed_bytes);
+            if (part->storage_mode == EXR_STORAGE_DEEP_SCANLINE ||
+                part->storage_mode == EXR_STORAGE_DEEP_TILED)
+                EXR_STATS_ADD (
+                    pctxt,
+                    part,
+                    bytes_written,
+                    encode->packed_sample_count_bytes);
+        }
+    }
 
     if ((part->storage_mode == EXR_STORAGE_DEEP_SCANLINE ||
          part->storage_mode == EXR_STORAGE_DEEP_TILED) &&
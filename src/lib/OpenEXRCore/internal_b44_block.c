@@ -0,0 +1,922 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#include "internal_b44_block.h"
+
+#include "internal_xdr.h"
+
+#include <string.h>
+
+#if defined __SSE2__ || (_MSC_VER >= 1300 && (_M_IX86 || _M_X64))
+#    define IMF_HAVE_SSE2 1
+#    include <emmintrin.h>
+#endif
+
+/**************************************/
+
+extern const uint16_t* exrcore_expTable;
+extern const uint16_t* exrcore_logTable;
+
+static inline void
+convertFromLinear (uint16_t s[16])
+{
+    for (int i = 0; i < 16; ++i)
+        s[i] = exrcore_expTable[s[i]];
+}
+
+static inline void
+convertToLinear (uint16_t s[16])
+{
+    for (int i = 0; i < 16; ++i)
+        s[i] = exrcore_logTable[s[i]];
+}
+
+/**************************************/
+
+static inline int
+shiftAndRound (int x, int shift)
+{
+    //
+    // Compute
+    //
+    //     y = x * pow (2, -shift),
+    //
+    // then round y to the nearest integer.
+    // In case of a tie, where y is exactly
+    // halfway between two integers, round
+    // to the even one.
+    //
+
+    x <<= 1;
+    int a = (1 << shift) - 1;
+    shift += 1;
+    int b = (x >> shift) & 1;
+    return (x + a + b) >> shift;
+}
+
+/*
+ * Pack a block of 4 by 4 16-bit pixels (32 bytes) into
+ * either 14 or 3 bytes.
+ *
+ *
+ * Integers s[0] ... s[15] represent floating-point numbers
+ * in what is essentially a sign-magnitude format.  Convert
+ * s[0] .. s[15] into a new set of integers, t[0] ... t[15],
+ * such that if t[i] is greater than t[j], the floating-point
+ * number that corresponds to s[i] is always greater than
+ * the floating-point number that corresponds to s[j].
+ *
+ * Also, replace any bit patterns that represent NaNs or
+ * infinities with bit patterns that represent floating-point
+ * zeroes.
+ *
+ *	bit pattern	floating-point		bit pattern
+ *	in s[i]		value			in t[i]
+ *
+ *  0x7fff		NAN			0x8000
+ *  0x7ffe		NAN			0x8000
+ *	  ...					  ...
+ *  0x7c01		NAN			0x8000
+ *  0x7c00		+infinity		0x8000
+ *  0x7bff		+HALF_MAX		0xfbff
+ *  0x7bfe					0xfbfe
+ *  0x7bfd					0xfbfd
+ *	  ...					  ...
+ *  0x0002		+2 * HALF_MIN		0x8002
+ *  0x0001		+HALF_MIN		0x8001
+ *  0x0000		+0.0			0x8000
+ *  0x8000		-0.0			0x7fff
+ *  0x8001		-HALF_MIN		0x7ffe
+ *  0x8002		-2 * HALF_MIN		0x7ffd
+ *	  ...					  ...
+ *  0xfbfd					0x0f02
+ *  0xfbfe					0x0401
+ *  0xfbff		-HALF_MAX		0x0400
+ *  0xfc00		-infinity		0x8000
+ *  0xfc01		NAN			0x8000
+ *	  ...					  ...
+ *  0xfffe		NAN			0x8000
+ *  0xffff		NAN			0x8000
+ */
+static int
+pack (const uint16_t s[16], uint8_t b[14], int flatfields, int exactmax)
+{
+    int      d[16];
+    int      r[15];
+    int      rMin;
+    int      rMax;
+    uint16_t t[16];
+    uint16_t tMax;
+    int      shift = -1;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        if ((s[i] & 0x7c00) == 0x7c00)
+            t[i] = 0x8000;
+        else if (s[i] & 0x8000)
+            t[i] = ~s[i];
+        else
+            t[i] = s[i] | 0x8000;
+    }
+
+    // find max
+    tMax = 0;
+    for (int i = 0; i < 16; ++i)
+        if (tMax < t[i]) tMax = t[i];
+
+    //
+    // Compute a set of running differences, r[0] ... r[14]:
+    // Find a shift value such that after rounding off the
+    // rightmost bits and shifting all differences are between
+    // -32 and +31.  Then bias the differences so that they
+    // end up between 0 and 63.
+    //
+
+    const int bias = 0x20;
+
+    do
+    {
+        shift += 1;
+
+        //
+        // Compute absolute differences, d[0] ... d[15],
+        // between tMax and t[0] ... t[15].
+        //
+        // Shift and round the absolute differences.
+        //
+
+        for (int i = 0; i < 16; ++i)
+            d[i] = shiftAndRound (tMax - t[i], shift);
+
+        //
+        // Convert d[0] .. d[15] into running differences
+        //
+
+        r[0] = d[0] - d[4] + bias;
+        r[1] = d[4] - d[8] + bias;
+        r[2] = d[8] - d[12] + bias;
+
+        r[3] = d[0] - d[1] + bias;
+        r[4] = d[4] - d[5] + bias;
+        r[5] = d[8] - d[9] + bias;
+        r[6] = d[12] - d[13] + bias;
+
+        r[7]  = d[1] - d[2] + bias;
+        r[8]  = d[5] - d[6] + bias;
+        r[9]  = d[9] - d[10] + bias;
+        r[10] = d[13] - d[14] + bias;
+
+        r[11] = d[2] - d[3] + bias;
+        r[12] = d[6] - d[7] + bias;
+        r[13] = d[10] - d[11] + bias;
+        r[14] = d[14] - d[15] + bias;
+
+        rMin = r[0];
+        rMax = r[0];
+
+        for (int i = 1; i < 15; ++i)
+        {
+            if (rMin > r[i]) rMin = r[i];
+
+            if (rMax < r[i]) rMax = r[i];
+        }
+    } while (rMin < 0 || rMax > 0x3f);
+
+    if (rMin == bias && rMax == bias && flatfields)
+    {
+        //
+        // Special case - all pixels have the same value.
+        // We encode this in 3 instead of 14 bytes by
+        // storing the value 0xfc in the third output byte,
+        // which cannot occur in the 14-byte encoding.
+        //
+
+        b[0] = (uint8_t) (t[0] >> 8);
+        b[1] = (uint8_t) t[0];
+        b[2] = 0xfc;
+
+        return 3;
+    }
+
+    if (exactmax)
+    {
+        //
+        // Adjust t[0] so that the pixel whose value is equal
+        // to tMax gets represented as accurately as possible.
+        //
+
+        t[0] = tMax - (uint16_t) (d[0] << shift);
+    }
+
+    //
+    // Pack t[0], shift and r[0] ... r[14] into 14 bytes:
+    //
+
+    b[0]  = (uint8_t) (t[0] >> 8);
+    b[1]  = (uint8_t) t[0];
+    b[2]  = (uint8_t) ((shift << 2) | (r[0] >> 4));
+    b[3]  = (uint8_t) ((r[0] << 4) | (r[1] >> 2));
+    b[4]  = (uint8_t) ((r[1] << 6) | r[2]);
+    b[5]  = (uint8_t) ((r[3] << 2) | (r[4] >> 4));
+    b[6]  = (uint8_t) ((r[4] << 4) | (r[5] >> 2));
+    b[7]  = (uint8_t) ((r[5] << 6) | r[6]);
+    b[8]  = (uint8_t) ((r[7] << 2) | (r[8] >> 4));
+    b[9]  = (uint8_t) ((r[8] << 4) | (r[9] >> 2));
+    b[10] = (uint8_t) ((r[9] << 6) | r[10]);
+    b[11] = (uint8_t) ((r[11] << 2) | (r[12] >> 4));
+    b[12] = (uint8_t) ((r[12] << 4) | (r[13] >> 2));
+    b[13] = (uint8_t) ((r[13] << 6) | r[14]);
+
+    return 14;
+}
+
+/**************************************/
+
+static inline void
+unpack14 (const uint8_t b[14], uint16_t s[16])
+{
+    s[0] = ((uint16_t) (b[0] << 8)) | ((uint16_t) b[1]);
+
+    uint16_t shift = (b[2] >> 2);
+    uint16_t bias  = (uint16_t) (0x20u << shift);
+
+    s[4] =
+        (uint16_t) ((uint32_t) s[0] + (uint32_t) ((((uint32_t) (b[2] << 4) | (uint32_t) (b[3] >> 4)) & 0x3fu) << shift) - bias);
+    s[8] =
+        (uint16_t) ((uint32_t) s[4] + (uint32_t) ((((uint32_t) (b[3] << 2) | (uint32_t) (b[4] >> 6)) & 0x3fu) << shift) - bias);
+    s[12] =
+        (uint16_t) ((uint32_t) s[8] + (uint32_t) ((uint32_t) (b[4] & 0x3fu) << shift) - bias);
+
+    s[1] =
+        (uint16_t) ((uint32_t) s[0] + (uint32_t) ((uint32_t) (b[5] >> 2) << shift) - bias);
+    s[5] =
+        (uint16_t) ((uint32_t) s[4] + (uint32_t) ((((uint32_t) (b[5] << 4) | (uint32_t) (b[6] >> 4)) & 0x3fu) << shift) - bias);
+    s[9] =
+        (uint16_t) ((uint32_t) s[8] + (uint32_t) ((((uint32_t) (b[6] << 2) | (uint32_t) (b[7] >> 6)) & 0x3fu) << shift) - bias);
+    s[13] =
+        (uint16_t) ((uint32_t) s[12] + (uint32_t) ((uint32_t) (b[7] & 0x3fu) << shift) - bias);
+
+    s[2] =
+        (uint16_t) ((uint32_t) s[1] + (uint32_t) ((uint32_t) (b[8] >> 2) << shift) - bias);
+    s[6] =
+        (uint16_t) ((uint32_t) s[5] + (uint32_t) ((((uint32_t) (b[8] << 4) | (uint32_t) (b[9] >> 4)) & 0x3fu) << shift) - bias);
+    s[10] =
+        (uint16_t) ((uint32_t) s[9] + (uint32_t) ((((uint32_t) (b[9] << 2) | (uint32_t) (b[10] >> 6)) & 0x3fu) << shift) - bias);
+    s[14] =
+        (uint16_t) ((uint32_t) s[13] + (uint32_t) ((uint32_t) (b[10] & 0x3fu) << shift) - bias);
+
+    s[3] =
+        (uint16_t) ((uint32_t) s[2] + (uint32_t) ((uint32_t) (b[11] >> 2) << shift) - bias);
+    s[7] =
+        (uint16_t) ((uint32_t) s[6] + (uint32_t) ((((uint32_t) (b[11] << 4) | (uint32_t) (b[12] >> 4)) & 0x3fu) << shift) - bias);
+    s[11] =
+        (uint16_t) ((uint32_t) s[10] + (uint32_t) ((((uint32_t) (b[12] << 2) | (uint32_t) (b[13] >> 6)) & 0x3fu) << shift) - bias);
+    s[15] =
+        (uint16_t) ((uint32_t) s[14] + (uint32_t) ((uint32_t) (b[13] & 0x3fu) << shift) - bias);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        if (s[i] & 0x8000)
+            s[i] &= 0x7fff;
+        else
+            s[i] = ~s[i];
+    }
+}
+
+static inline void
+unpack3 (const uint8_t b[3], uint16_t s[16])
+{
+    s[0] = ((uint16_t) (b[0] << 8)) | ((uint16_t) b[1]);
+
+    if (s[0] & 0x8000)
+        s[0] &= 0x7fff;
+    else
+        s[0] = ~s[0];
+
+    for (int i = 1; i < 16; ++i)
+        s[i] = s[0];
+}
+
+
+/**************************************/
+
+uint64_t
+internal_b44_pack_blocks_scalar (
+    const uint16_t* rows[4],
+    int             nblocks,
+    int             linear,
+    int             flatfields,
+    uint8_t*        out)
+{
+    uint8_t* b = out;
+    uint16_t s[16];
+
+    for (int i = 0; i < nblocks; ++i)
+    {
+        memcpy (&s[0], rows[0] + 4 * i, 4 * sizeof (uint16_t));
+        memcpy (&s[4], rows[1] + 4 * i, 4 * sizeof (uint16_t));
+        memcpy (&s[8], rows[2] + 4 * i, 4 * sizeof (uint16_t));
+        memcpy (&s[12], rows[3] + 4 * i, 4 * sizeof (uint16_t));
+
+        if (linear) convertFromLinear (s);
+
+        b += pack (s, b, flatfields, !linear);
+    }
+    return (uint64_t) (b - out);
+}
+
+uint64_t
+internal_b44_unpack_blocks_scalar (
+    const uint8_t* in,
+    uint64_t       nin,
+    int            nblocks,
+    int            linear,
+    uint16_t*      rows[4])
+{
+    uint64_t bIn = 0;
+    uint16_t s[16];
+
+    for (int i = 0; i < nblocks; ++i)
+    {
+        if (bIn + 3 > nin) return 0;
+
+        /* check if 3-byte encoded flat field */
+        if (in[bIn + 2] >= (13 << 2))
+        {
+            unpack3 (in + bIn, s);
+            bIn += 3;
+        }
+        else
+        {
+            if (bIn + 14 > nin) return 0;
+            unpack14 (in + bIn, s);
+            bIn += 14;
+        }
+
+        if (linear) convertToLinear (s);
+
+        priv_from_native16 (s, 16);
+
+        memcpy (rows[0] + 4 * i, &s[0], 4 * sizeof (uint16_t));
+        memcpy (rows[1] + 4 * i, &s[4], 4 * sizeof (uint16_t));
+        memcpy (rows[2] + 4 * i, &s[8], 4 * sizeof (uint16_t));
+        memcpy (rows[3] + 4 * i, &s[12], 4 * sizeof (uint16_t));
+    }
+    return bIn;
+}
+
+/**************************************/
+
+#ifdef IMF_HAVE_SSE2
+
+//
+// The vector code processes 8 blocks side by side: the 16 pixels of
+// the blocks are held in 16 vectors, with lane j of vector i being
+// s[i] of block j, so that all the arithmetic above is done for 8
+// blocks at once. Only the (variable length) input or output of each
+// block, and the log / exp table lookups, which have no gather
+// instruction in SSE2, are done a block or a value at a time.
+//
+
+#    define B44_SIMD_BLOCKS 8
+
+/* 4 values from each of 8 blocks in a row to s[0..3] */
+static inline void
+b44_load_row_sse2 (const uint16_t* p, __m128i* s)
+{
+    __m128i v0 = _mm_loadu_si128 ((const __m128i*) p);
+    __m128i v1 = _mm_loadu_si128 ((const __m128i*) (p + 8));
+    __m128i v2 = _mm_loadu_si128 ((const __m128i*) (p + 16));
+    __m128i v3 = _mm_loadu_si128 ((const __m128i*) (p + 24));
+    __m128i a0 = _mm_unpacklo_epi16 (v0, v1);
+    __m128i a1 = _mm_unpackhi_epi16 (v0, v1);
+    __m128i a2 = _mm_unpacklo_epi16 (v2, v3);
+    __m128i a3 = _mm_unpackhi_epi16 (v2, v3);
+    __m128i b0 = _mm_unpacklo_epi16 (a0, a1);
+    __m128i b1 = _mm_unpackhi_epi16 (a0, a1);
+    __m128i b2 = _mm_unpacklo_epi16 (a2, a3);
+    __m128i b3 = _mm_unpackhi_epi16 (a2, a3);
+
+    s[0] = _mm_unpacklo_epi64 (b0, b2);
+    s[1] = _mm_unpackhi_epi64 (b0, b2);
+    s[2] = _mm_unpacklo_epi64 (b1, b3);
+    s[3] = _mm_unpackhi_epi64 (b1, b3);
+}
+
+/* inverse of b44_load_row_sse2 */
+static inline void
+b44_store_row_sse2 (uint16_t* p, const __m128i* s)
+{
+    __m128i a0 = _mm_unpacklo_epi16 (s[0], s[1]);
+    __m128i a1 = _mm_unpacklo_epi16 (s[2], s[3]);
+    __m128i a2 = _mm_unpackhi_epi16 (s[0], s[1]);
+    __m128i a3 = _mm_unpackhi_epi16 (s[2], s[3]);
+
+    _mm_storeu_si128 ((__m128i*) p, _mm_unpacklo_epi32 (a0, a1));
+    _mm_storeu_si128 ((__m128i*) (p + 8), _mm_unpackhi_epi32 (a0, a1));
+    _mm_storeu_si128 ((__m128i*) (p + 16), _mm_unpacklo_epi32 (a2, a3));
+    _mm_storeu_si128 ((__m128i*) (p + 24), _mm_unpackhi_epi32 (a2, a3));
+}
+
+/* lane j of w[k] holds bytes 2k, 2k+1 of block j; returns block j in o[j] */
+static inline void
+b44_transpose8_sse2 (const __m128i* w, __m128i* o)
+{
+    __m128i a0 = _mm_unpacklo_epi16 (w[0], w[1]);
+    __m128i a1 = _mm_unpackhi_epi16 (w[0], w[1]);
+    __m128i a2 = _mm_unpacklo_epi16 (w[2], w[3]);
+    __m128i a3 = _mm_unpackhi_epi16 (w[2], w[3]);
+    __m128i a4 = _mm_unpacklo_epi16 (w[4], w[5]);
+    __m128i a5 = _mm_unpackhi_epi16 (w[4], w[5]);
+    __m128i a6 = _mm_unpacklo_epi16 (w[6], w[7]);
+    __m128i a7 = _mm_unpackhi_epi16 (w[6], w[7]);
+    __m128i b0 = _mm_unpacklo_epi32 (a0, a2);
+    __m128i b1 = _mm_unpackhi_epi32 (a0, a2);
+    __m128i b2 = _mm_unpacklo_epi32 (a1, a3);
+    __m128i b3 = _mm_unpackhi_epi32 (a1, a3);
+    __m128i b4 = _mm_unpacklo_epi32 (a4, a6);
+    __m128i b5 = _mm_unpackhi_epi32 (a4, a6);
+    __m128i b6 = _mm_unpacklo_epi32 (a5, a7);
+    __m128i b7 = _mm_unpackhi_epi32 (a5, a7);
+
+    o[0] = _mm_unpacklo_epi64 (b0, b4);
+    o[1] = _mm_unpackhi_epi64 (b0, b4);
+    o[2] = _mm_unpacklo_epi64 (b1, b5);
+    o[3] = _mm_unpackhi_epi64 (b1, b5);
+    o[4] = _mm_unpacklo_epi64 (b2, b6);
+    o[5] = _mm_unpackhi_epi64 (b2, b6);
+    o[6] = _mm_unpacklo_epi64 (b3, b7);
+    o[7] = _mm_unpackhi_epi64 (b3, b7);
+}
+
+static inline __m128i
+b44_select_sse2 (__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128 (_mm_and_si128 (mask, a), _mm_andnot_si128 (mask, b));
+}
+
+/* b[k] = ((hi << lshift) | (lo >> rshift)) & 0xff */
+#    define B44_FIELD_BYTE(hi, lshift, lo, rshift)                             \
+        _mm_and_si128 (                                                        \
+            _mm_or_si128 (                                                     \
+                _mm_slli_epi16 (hi, lshift), _mm_srli_epi16 (lo, rshift)),     \
+            _mm_set1_epi16 (0xff))
+
+static uint64_t
+b44_pack8_sse2 (
+    const uint16_t* rows[4], int linear, int flatfields, uint8_t* out)
+{
+    const __m128i zero  = _mm_setzero_si128 ();
+    const __m128i one   = _mm_set1_epi16 (1);
+    const __m128i sign  = _mm_set1_epi16 ((short) 0x8000);
+    const __m128i exp   = _mm_set1_epi16 (0x7c00);
+    const __m128i bias  = _mm_set1_epi16 (0x20);
+    const __m128i range = _mm_set1_epi16 ((short) 0xffc0);
+    __m128i       t[16], x[16], d[16], r[15], rs[15];
+    __m128i       tMax, done, ds0, shifts, muls, flat, t0, w[8], o[8];
+    uint16_t      lin[4][4 * B44_SIMD_BLOCKS];
+    uint8_t       blk[B44_SIMD_BLOCKS][16];
+    uint8_t*      b = out;
+    int           flatmask;
+
+    if (linear)
+    {
+        for (int y = 0; y < 4; ++y)
+        {
+            for (int i = 0; i < 4 * B44_SIMD_BLOCKS; ++i)
+                lin[y][i] = exrcore_expTable[rows[y][i]];
+            b44_load_row_sse2 (lin[y], t + 4 * y);
+        }
+    }
+    else
+    {
+        for (int y = 0; y < 4; ++y)
+            b44_load_row_sse2 (rows[y], t + 4 * y);
+    }
+
+    //
+    // Map to the ordered t[i] as in pack, and find the maximum. There
+    // is no unsigned 16-bit max in SSE2, so flip the sign bit to use
+    // the signed one.
+    //
+
+    tMax = _mm_set1_epi16 ((short) 0x8000);
+    for (int i = 0; i < 16; ++i)
+    {
+        __m128i s      = t[i];
+        __m128i infnan = _mm_cmpeq_epi16 (_mm_and_si128 (s, exp), exp);
+
+        s    = _mm_xor_si128 (s, _mm_or_si128 (_mm_srai_epi16 (s, 15), sign));
+        t[i] = b44_select_sse2 (infnan, sign, s);
+        tMax = _mm_max_epi16 (tMax, _mm_xor_si128 (t[i], sign));
+    }
+    tMax = _mm_xor_si128 (tMax, sign);
+
+    for (int i = 0; i < 16; ++i)
+        x[i] = _mm_sub_epi16 (tMax, t[i]);
+
+    //
+    // Search the shift for all blocks together, recording the
+    // differences of each block at the first shift that fits it, until
+    // all blocks fit, which they do by a shift of 11, as the absolute
+    // differences are at most 0xf7ff. The differences are computed
+    // modulo 2^16, which can't alias a value that is out of range to
+    // one in range, as they are between -0xf7ff and 0xf7ff.
+    //
+
+    done   = zero;
+    ds0    = zero;
+    shifts = zero;
+    muls   = zero;
+    for (int i = 0; i < 15; ++i)
+        rs[i] = zero;
+
+    for (int shift = 0;; ++shift)
+    {
+        __m128i ok, fits;
+
+        if (shift == 0)
+        {
+            for (int i = 0; i < 16; ++i)
+                d[i] = x[i];
+        }
+        else
+        {
+            //
+            // shiftAndRound, rearranged to not overflow 16 bits:
+            //
+            //     (x + 2^(shift-1) - 1 + ((x >> shift) & 1)) >> shift
+            //
+
+            __m128i cnt  = _mm_cvtsi32_si128 (shift);
+            __m128i mask = _mm_set1_epi16 ((short) ((1 << shift) - 1));
+            __m128i half = _mm_set1_epi16 ((short) ((1 << (shift - 1)) - 1));
+
+            for (int i = 0; i < 16; ++i)
+            {
+                __m128i q   = _mm_srl_epi16 (x[i], cnt);
+                __m128i rem = _mm_add_epi16 (
+                    _mm_add_epi16 (_mm_and_si128 (x[i], mask), half),
+                    _mm_and_si128 (q, one));
+                d[i] = _mm_add_epi16 (q, _mm_srl_epi16 (rem, cnt));
+            }
+        }
+
+        r[0] = _mm_add_epi16 (_mm_sub_epi16 (d[0], d[4]), bias);
+        r[1] = _mm_add_epi16 (_mm_sub_epi16 (d[4], d[8]), bias);
+        r[2] = _mm_add_epi16 (_mm_sub_epi16 (d[8], d[12]), bias);
+
+        r[3] = _mm_add_epi16 (_mm_sub_epi16 (d[0], d[1]), bias);
+        r[4] = _mm_add_epi16 (_mm_sub_epi16 (d[4], d[5]), bias);
+        r[5] = _mm_add_epi16 (_mm_sub_epi16 (d[8], d[9]), bias);
+        r[6] = _mm_add_epi16 (_mm_sub_epi16 (d[12], d[13]), bias);
+
+        r[7]  = _mm_add_epi16 (_mm_sub_epi16 (d[1], d[2]), bias);
+        r[8]  = _mm_add_epi16 (_mm_sub_epi16 (d[5], d[6]), bias);
+        r[9]  = _mm_add_epi16 (_mm_sub_epi16 (d[9], d[10]), bias);
+        r[10] = _mm_add_epi16 (_mm_sub_epi16 (d[13], d[14]), bias);
+
+        r[11] = _mm_add_epi16 (_mm_sub_epi16 (d[2], d[3]), bias);
+        r[12] = _mm_add_epi16 (_mm_sub_epi16 (d[6], d[7]), bias);
+        r[13] = _mm_add_epi16 (_mm_sub_epi16 (d[10], d[11]), bias);
+        r[14] = _mm_add_epi16 (_mm_sub_epi16 (d[14], d[15]), bias);
+
+        ok = r[0];
+        for (int i = 1; i < 15; ++i)
+            ok = _mm_or_si128 (ok, r[i]);
+        ok = _mm_cmpeq_epi16 (_mm_and_si128 (ok, range), zero);
+
+        fits = _mm_andnot_si128 (done, ok);
+        if (_mm_movemask_epi8 (fits))
+        {
+            for (int i = 0; i < 15; ++i)
+                rs[i] = b44_select_sse2 (fits, r[i], rs[i]);
+            ds0    = b44_select_sse2 (fits, d[0], ds0);
+            shifts = b44_select_sse2 (
+                fits, _mm_set1_epi16 ((short) shift), shifts);
+            muls   = b44_select_sse2 (
+                fits, _mm_set1_epi16 ((short) (1 << shift)), muls);
+            done = _mm_or_si128 (done, fits);
+        }
+
+        if (_mm_movemask_epi8 (done) == 0xffff) break;
+    }
+
+    //
+    // Flat blocks keep the original t[0], the others may adjust it,
+    // as in pack.
+    //
+
+    flat = zero;
+    if (flatfields)
+    {
+        flat = _mm_cmpeq_epi16 (rs[0], bias);
+        for (int i = 1; i < 15; ++i)
+            flat = _mm_and_si128 (flat, _mm_cmpeq_epi16 (rs[i], bias));
+    }
+
+    t0 = t[0];
+    if (!linear)
+    {
+        t0 = b44_select_sse2 (
+            flat, t0, _mm_sub_epi16 (tMax, _mm_mullo_epi16 (ds0, muls)));
+    }
+
+    //
+    // Pack into bytes, two per 16-bit lane, then transpose so each
+    // vector holds the (up to) 14 bytes of one block.
+    //
+
+    w[0] = _mm_or_si128 (_mm_srli_epi16 (t0, 8), _mm_slli_epi16 (t0, 8));
+    w[1] = _mm_or_si128 (
+        b44_select_sse2 (
+            flat,
+            _mm_set1_epi16 (0xfc),
+            _mm_or_si128 (
+                _mm_slli_epi16 (shifts, 2), _mm_srli_epi16 (rs[0], 4))),
+        _mm_slli_epi16 (
+            _mm_or_si128 (_mm_slli_epi16 (rs[0], 4), _mm_srli_epi16 (rs[1], 2)),
+            8));
+    w[2] = _mm_or_si128 (
+        B44_FIELD_BYTE (rs[1], 6, rs[2], 0),
+        _mm_slli_epi16 (
+            _mm_or_si128 (_mm_slli_epi16 (rs[3], 2), _mm_srli_epi16 (rs[4], 4)),
+            8));
+    w[3] = _mm_or_si128 (
+        B44_FIELD_BYTE (rs[4], 4, rs[5], 2),
+        _mm_slli_epi16 (
+            _mm_or_si128 (_mm_slli_epi16 (rs[5], 6), rs[6]), 8));
+    w[4] = _mm_or_si128 (
+        B44_FIELD_BYTE (rs[7], 2, rs[8], 4),
+        _mm_slli_epi16 (
+            _mm_or_si128 (_mm_slli_epi16 (rs[8], 4), _mm_srli_epi16 (rs[9], 2)),
+            8));
+    w[5] = _mm_or_si128 (
+        B44_FIELD_BYTE (rs[9], 6, rs[10], 0),
+        _mm_slli_epi16 (
+            _mm_or_si128 (
+                _mm_slli_epi16 (rs[11], 2), _mm_srli_epi16 (rs[12], 4)),
+            8));
+    w[6] = _mm_or_si128 (
+        B44_FIELD_BYTE (rs[12], 4, rs[13], 2),
+        _mm_slli_epi16 (
+            _mm_or_si128 (_mm_slli_epi16 (rs[13], 6), rs[14]), 8));
+    w[7] = zero;
+
+    b44_transpose8_sse2 (w, o);
+
+    flatmask = _mm_movemask_epi8 (flat);
+    for (int j = 0; j < B44_SIMD_BLOCKS; ++j)
+    {
+        int n = (flatmask & (1 << (2 * j))) ? 3 : 14;
+
+        _mm_storeu_si128 ((__m128i*) blk[j], o[j]);
+        memcpy (b, blk[j], (size_t) n);
+        b += n;
+    }
+
+    return (uint64_t) (b - out);
+}
+
+static uint64_t
+b44_unpack8_sse2 (
+    const uint8_t* in, uint64_t nin, int linear, uint16_t* rows[4])
+{
+    //
+    // Flat (3-byte) blocks are expanded to the equivalent 14-byte
+    // block, with a shift of 0 and all differences 0, so they take
+    // the same path. Bytes 14 and 15 of each block hold 1 << shift.
+    //
+
+    static const uint8_t flat_block[14] = {
+        0x02, 0x08, 0x20, 0x82, 0x08, 0x20, 0x82,
+        0x08, 0x20, 0x82, 0x08, 0x20, 0x00, 0x01};
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128i m6   = _mm_set1_epi16 (0x3f);
+    uint8_t       blk[B44_SIMD_BLOCKS][16];
+    __m128i       a[8], c[8], e[8], bt[16], f[16], s[16];
+    __m128i       mul, bias;
+    uint64_t      bIn = 0;
+
+    for (int j = 0; j < B44_SIMD_BLOCKS; ++j)
+    {
+        const uint8_t* b = in + bIn;
+
+        if (bIn + 3 > nin) return 0;
+
+        blk[j][0] = b[0];
+        blk[j][1] = b[1];
+        if (b[2] >= (13 << 2))
+        {
+            memcpy (blk[j] + 2, flat_block, sizeof (flat_block));
+            bIn += 3;
+        }
+        else
+        {
+            unsigned m = 1u << (b[2] >> 2);
+
+            if (bIn + 14 > nin) return 0;
+            memcpy (blk[j] + 2, b + 2, 12);
+            blk[j][14] = (uint8_t) (m >> 8);
+            blk[j][15] = (uint8_t) m;
+            bIn += 14;
+        }
+    }
+
+    //
+    // Transpose the 8 x 16 bytes so bt[k] holds byte k of each block.
+    //
+
+    for (int j = 0; j < 8; j += 2)
+    {
+        __m128i r0 = _mm_loadu_si128 ((const __m128i*) blk[j]);
+        __m128i r1 = _mm_loadu_si128 ((const __m128i*) blk[j + 1]);
+
+        a[j]     = _mm_unpacklo_epi8 (r0, r1);
+        a[j + 1] = _mm_unpackhi_epi8 (r0, r1);
+    }
+    for (int j = 0; j < 8; j += 4)
+    {
+        c[j]     = _mm_unpacklo_epi16 (a[j], a[j + 2]);
+        c[j + 1] = _mm_unpackhi_epi16 (a[j], a[j + 2]);
+        c[j + 2] = _mm_unpacklo_epi16 (a[j + 1], a[j + 3]);
+        c[j + 3] = _mm_unpackhi_epi16 (a[j + 1], a[j + 3]);
+    }
+    for (int j = 0; j < 4; ++j)
+    {
+        e[2 * j]     = _mm_unpacklo_epi32 (c[j], c[j + 4]);
+        e[2 * j + 1] = _mm_unpackhi_epi32 (c[j], c[j + 4]);
+    }
+    for (int j = 0; j < 8; ++j)
+    {
+        bt[2 * j]     = _mm_unpacklo_epi8 (e[j], zero);
+        bt[2 * j + 1] = _mm_unpackhi_epi8 (e[j], zero);
+    }
+
+    mul  = _mm_or_si128 (_mm_slli_epi16 (bt[14], 8), bt[15]);
+    bias = _mm_slli_epi16 (mul, 5);
+
+#    define B44_FIELD(hi, lshift, lo, rshift)                                  \
+        _mm_and_si128 (                                                        \
+            _mm_or_si128 (                                                     \
+                _mm_slli_epi16 (hi, lshift), _mm_srli_epi16 (lo, rshift)),     \
+            m6)
+
+    //
+    // The 6-bit differences, indexed like s, then shifted by
+    // multiplying with 1 << shift, as SSE2 has no per lane shifts.
+    //
+
+    f[4]  = B44_FIELD (bt[2], 4, bt[3], 4);
+    f[8]  = B44_FIELD (bt[3], 2, bt[4], 6);
+    f[12] = _mm_and_si128 (bt[4], m6);
+
+    f[1]  = _mm_srli_epi16 (bt[5], 2);
+    f[5]  = B44_FIELD (bt[5], 4, bt[6], 4);
+    f[9]  = B44_FIELD (bt[6], 2, bt[7], 6);
+    f[13] = _mm_and_si128 (bt[7], m6);
+
+    f[2]  = _mm_srli_epi16 (bt[8], 2);
+    f[6]  = B44_FIELD (bt[8], 4, bt[9], 4);
+    f[10] = B44_FIELD (bt[9], 2, bt[10], 6);
+    f[14] = _mm_and_si128 (bt[10], m6);
+
+    f[3]  = _mm_srli_epi16 (bt[11], 2);
+    f[7]  = B44_FIELD (bt[11], 4, bt[12], 4);
+    f[11] = B44_FIELD (bt[12], 2, bt[13], 6);
+    f[15] = _mm_and_si128 (bt[13], m6);
+
+    for (int i = 1; i < 16; ++i)
+        f[i] = _mm_sub_epi16 (_mm_mullo_epi16 (f[i], mul), bias);
+
+    //
+    // Accumulate as in unpack14: down the first column, then
+    // along the rows.
+    //
+
+    s[0]  = _mm_or_si128 (_mm_slli_epi16 (bt[0], 8), bt[1]);
+    s[4]  = _mm_add_epi16 (s[0], f[4]);
+    s[8]  = _mm_add_epi16 (s[4], f[8]);
+    s[12] = _mm_add_epi16 (s[8], f[12]);
+
+    for (int i = 1; i < 4; ++i)
+    {
+        s[i]      = _mm_add_epi16 (s[i - 1], f[i]);
+        s[i + 4]  = _mm_add_epi16 (s[i + 3], f[i + 4]);
+        s[i + 8]  = _mm_add_epi16 (s[i + 7], f[i + 8]);
+        s[i + 12] = _mm_add_epi16 (s[i + 11], f[i + 12]);
+    }
+
+#    undef B44_FIELD
+
+    //
+    // if (s & 0x8000) s &= 0x7fff; else s = ~s;
+    //
+
+    for (int i = 0; i < 16; ++i)
+    {
+        __m128i pos = _mm_cmpgt_epi16 (s[i], _mm_set1_epi16 (-1));
+
+        s[i] = _mm_xor_si128 (
+            s[i], _mm_or_si128 (pos, _mm_set1_epi16 ((short) 0x8000)));
+    }
+
+    for (int y = 0; y < 4; ++y)
+    {
+        b44_store_row_sse2 (rows[y], s + 4 * y);
+
+        if (linear)
+        {
+            for (int i = 0; i < 4 * B44_SIMD_BLOCKS; ++i)
+                rows[y][i] = exrcore_logTable[rows[y][i]];
+        }
+    }
+
+    return bIn;
+}
+
+#    undef B44_FIELD_BYTE
+
+#endif /* IMF_HAVE_SSE2 */
+
+/**************************************/
+
+uint64_t
+internal_b44_pack_blocks (
+    const uint16_t* rows[4],
+    int             nblocks,
+    int             linear,
+    int             flatfields,
+    uint8_t*        out)
+{
+    uint8_t* b = out;
+    int      i = 0;
+
+#ifdef IMF_HAVE_SSE2
+    for (; i + B44_SIMD_BLOCKS <= nblocks; i += B44_SIMD_BLOCKS)
+    {
+        const uint16_t* cur[4] = {
+            rows[0] + 4 * i, rows[1] + 4 * i, rows[2] + 4 * i, rows[3] + 4 * i};
+
+        b += b44_pack8_sse2 (cur, linear, flatfields, b);
+    }
+#endif
+
+    if (i < nblocks)
+    {
+        const uint16_t* cur[4] = {
+            rows[0] + 4 * i, rows[1] + 4 * i, rows[2] + 4 * i, rows[3] + 4 * i};
+
+        b += internal_b44_pack_blocks_scalar (
+            cur, nblocks - i, linear, flatfields, b);
+    }
+    return (uint64_t) (b - out);
+}
+
+uint64_t
+internal_b44_unpack_blocks (
+    const uint8_t* in,
+    uint64_t       nin,
+    int            nblocks,
+    int            linear,
+    uint16_t*      rows[4])
+{
+    uint64_t bIn = 0, n;
+    int      i   = 0;
+
+#ifdef IMF_HAVE_SSE2
+    for (; i + B44_SIMD_BLOCKS <= nblocks; i += B44_SIMD_BLOCKS)
+    {
+        uint16_t* cur[4] = {
+            rows[0] + 4 * i, rows[1] + 4 * i, rows[2] + 4 * i, rows[3] + 4 * i};
+
+        n = b44_unpack8_sse2 (in + bIn, nin - bIn, linear, cur);
+        if (n == 0) return 0;
+        bIn += n;
+    }
+#endif
+
+    if (i < nblocks)
+    {
+        uint16_t* cur[4] = {
+            rows[0] + 4 * i, rows[1] + 4 * i, rows[2] + 4 * i, rows[3] + 4 * i};
+
+        n = internal_b44_unpack_blocks_scalar (
+            in + bIn, nin - bIn, nblocks - i, linear, cur);
+        if (n == 0) return 0;
+        bIn += n;
+    }
+    return bIn;
+}
+
+int
+internal_b44_has_simd (void)
+{
+#ifdef IMF_HAVE_SSE2
+    return 1;
+#else
+    return 0;
+#endif
+}
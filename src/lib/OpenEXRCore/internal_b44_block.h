@@ -0,0 +1,52 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#ifndef OPENEXR_CORE_B44_BLOCK_H
+#define OPENEXR_CORE_B44_BLOCK_H
+
+#include <stdint.h>
+
+/* B44 coding of a horizontal run of nblocks 4x4 blocks of half
+ * values, the 4 rows of which start at rows[0] ... rows[3]. linear
+ * selects the p_linear log / exp mapping. These use vector
+ * instructions where available to code several blocks at once, and
+ * are bit exact with the _scalar variants, which are provided for
+ * testing */
+
+/* reads native values, writes at most 14 * nblocks bytes to out and
+ * returns the number written */
+uint64_t internal_b44_pack_blocks (
+    const uint16_t* rows[4],
+    int             nblocks,
+    int             linear,
+    int             flatfields,
+    uint8_t*        out);
+
+/* writes little endian values, returns the number of bytes consumed
+ * from in, or 0 if nin bytes are not enough for nblocks */
+uint64_t internal_b44_unpack_blocks (
+    const uint8_t* in,
+    uint64_t       nin,
+    int            nblocks,
+    int            linear,
+    uint16_t*      rows[4]);
+
+uint64_t internal_b44_pack_blocks_scalar (
+    const uint16_t* rows[4],
+    int             nblocks,
+    int             linear,
+    int             flatfields,
+    uint8_t*        out);
+uint64_t internal_b44_unpack_blocks_scalar (
+    const uint8_t* in,
+    uint64_t       nin,
+    int            nblocks,
+    int            linear,
+    uint16_t*      rows[4]);
+
+/* non-zero if internal_b44_pack_blocks / unpack_blocks use vector code */
+int internal_b44_has_simd (void);
+
+#endif /* OPENEXR_CORE_B44_BLOCK_H */
@@ -15,6 +15,11 @@ exr_result_t internal_exr_apply_rle (exr_encode_pipeline_t* encode);
 
 exr_result_t internal_exr_apply_zip (exr_encode_pipeline_t* encode);
 
+/* the byte reordering and predictor zip applies before deflate, also
+ * used by the other lossless codecs built on the same pre-pass */
+void internal_zip_deconstruct_bytes (
+    uint8_t* scratch, const uint8_t* source, uint64_t count);
+
 exr_result_t internal_exr_apply_piz (exr_encode_pipeline_t* encode);
 
 exr_result_t internal_exr_apply_pxr24 (exr_encode_pipeline_t* encode);
@@ -27,4 +32,8 @@ exr_result_t internal_exr_apply_dwaa (exr_encode_pipeline_t* encode);
 
 exr_result_t internal_exr_apply_dwab (exr_encode_pipeline_t* encode);
 
+exr_result_t internal_exr_apply_zstd (exr_encode_pipeline_t* encode);
+
+exr_result_t internal_exr_apply_lz4 (exr_encode_pipeline_t* encode);
+
 #endif /* OPENEXR_CORE_COMPRESS_H */
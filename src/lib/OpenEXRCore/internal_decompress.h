@@ -31,6 +31,11 @@ exr_result_t internal_exr_undo_zip (
     void*                  uncompressed_data,
     uint64_t               uncompressed_size);
 
+/* undoes internal_zip_deconstruct_bytes, the predictor is undone in
+ * place in scratch, then the bytes are interleaved into out */
+void internal_zip_reconstruct_bytes (
+    uint8_t* out, uint8_t* scratch, uint64_t count);
+
 exr_result_t internal_exr_undo_piz (
     exr_decode_pipeline_t* decode,
     const void*            compressed_data,
@@ -38,6 +43,24 @@ exr_result_t internal_exr_undo_piz (
     void*                  uncompressed_data,
     uint64_t               uncompressed_size);
 
+/*
+ * reduced resolution PIZ decode, for level 1, 2 or 3: writes every
+ * (1 << level)th sample in x and y of each channel, as a separate
+ * plane per channel of ceil (height / s) rows of ceil (width / s)
+ * samples, where s = (1 << level), skipping the finer levels of the
+ * wavelet reconstruction for all other samples
+ */
+uint64_t internal_exr_piz_reduced_size (
+    const exr_decode_pipeline_t* decode, int level);
+
+exr_result_t internal_exr_undo_piz_reduced (
+    exr_decode_pipeline_t* decode,
+    const void*            compressed_data,
+    uint64_t               comp_buf_size,
+    int                    level,
+    void*                  reduced_data,
+    uint64_t               reduced_size);
+
 exr_result_t internal_exr_undo_pxr24 (
     exr_decode_pipeline_t* decode,
     const void*            compressed_data,
@@ -73,4 +96,18 @@ exr_result_t internal_exr_undo_dwab (
     void*                  uncompressed_data,
     uint64_t               uncompressed_size);
 
+exr_result_t internal_exr_undo_zstd (
+    exr_decode_pipeline_t* decode,
+    const void*            compressed_data,
+    uint64_t               comp_buf_size,
+    void*                  uncompressed_data,
+    uint64_t               uncompressed_size);
+
+exr_result_t internal_exr_undo_lz4 (
+    exr_decode_pipeline_t* decode,
+    const void*            compressed_data,
+    uint64_t               comp_buf_size,
+    void*                  uncompressed_data,
+    uint64_t               uncompressed_size);
+
 #endif /* OPENEXR_CORE_DECOMPRESS_H */
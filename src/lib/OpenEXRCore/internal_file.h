@@ -30,6 +30,10 @@ int32_t
 internal_exr_compute_chunk_offset_size (struct _internal_exr_part* curpart);
 
 exr_result_t internal_exr_write_header (struct _internal_exr_context* ctxt);
+/* in write_header.c, rewrites the header of an existing file if the
+ * new header still fits in front of the first chunk */
+exr_result_t
+internal_exr_update_header_inplace (struct _internal_exr_context* ctxt);
 
 /* in openexr_validate.c, functions to validate the header during read / pre-write */
 exr_result_t internal_exr_validate_read_part (
@@ -110,7 +110,14 @@ hufCanonicalCodeTable (uint64_t* hcode)
         n[i] = 0;
 
     for (int i = 0; i < HUF_ENCSIZE; ++i)
-        n[hcode[i]] += 1;
+    {
+        //
+        // Most symbols are usually unused, skip rather than count
+        // them, so the increments of n[0] don't serialize the loop.
+        //
+
+        if (hcode[i] > 0) n[hcode[i]] += 1;
+    }
 
     //
     // For each i from 58 through 1, compute the
@@ -150,97 +157,31 @@ hufCanonicalCodeTable (uint64_t* hcode)
 //	- original frequencies are destroyed;
 //	- encoding tables are used by hufEncode() and hufBuildDecTable();
 //
-// NB: The following code "(*a == *b) && (a > b))" was added to ensure
-//     elements in the heap with the same value are sorted by index.
-//     This is to ensure, the STL make_heap()/pop_heap()/push_heap() methods
-//     produced a resultant sorted heap that is identical across OSes.
+// NB: The heap orders equal frequencies by symbol index, so that the
+//     resulting code is identical across OSes (and identical to the
+//     original pointer-based STL heap implementation this replaced).
+//     To make that a single integer comparison, the heap holds keys
+//     of the form (frequency << HUF_KEY_SHIFT) | index, which leaves
+//     47 bits for the frequency: far more than the number of values
+//     in any chunk.
 //
 
-static inline int
-FHeapCompare (uint64_t* a, uint64_t* b)
-{
-    return ((*a > *b) || ((*a == *b) && (a > b)));
-}
-
-static inline void
-intern_push_heap (
-    uint64_t** first, size_t holeIndex, size_t topIndex, uint64_t* value)
-{
-    size_t parent = (holeIndex - 1) / 2;
-    while (holeIndex > topIndex && FHeapCompare (*(first + parent), value))
-    {
-        *(first + holeIndex) = *(first + parent);
-        holeIndex            = parent;
-        parent               = (holeIndex - 1) / 2;
-    }
-    *(first + holeIndex) = value;
-}
-
-static inline void
-adjust_heap (uint64_t** first, size_t holeIndex, size_t len, uint64_t* value)
-{
-    const size_t topIndex    = holeIndex;
-    size_t       secondChild = holeIndex;
-
-    while (secondChild < (len - 1) / 2)
-    {
-        secondChild = 2 * (secondChild + 1);
-        if (FHeapCompare (*(first + secondChild), *(first + (secondChild - 1))))
-            --secondChild;
-        *(first + holeIndex) = *(first + secondChild);
-        holeIndex            = secondChild;
-    }
-
-    if ((len & 1) == 0 && secondChild == (len - 2) / 2)
-    {
-        secondChild          = 2 * (secondChild + 1);
-        *(first + holeIndex) = *(first + (secondChild - 1));
-        holeIndex            = secondChild - 1;
-    }
-
-    intern_push_heap (first, holeIndex, topIndex, value);
-}
-
-static inline void
-push_heap (uint64_t** first, uint64_t** last)
-{
-    uint64_t* value = *(last - 1);
-    intern_push_heap (first, (size_t) (last - first) - 1, 0, value);
-}
-
-static inline void
-intern_pop_heap (uint64_t** first, uint64_t** last, uint64_t** result)
-{
-    uint64_t* value = *result;
-    *result         = *first;
-    adjust_heap (first, 0, (size_t) (last - first), value);
-}
+#define HUF_KEY_SHIFT 17
+#define HUF_KEY_MASK ((((uint64_t) 1) << HUF_KEY_SHIFT) - 1)
 
 static inline void
-pop_heap (uint64_t** first, uint64_t** last)
-{
-    if (last - first > 1)
-    {
-        --last;
-        intern_pop_heap (first, last, last);
-    }
-}
-
-static void
-make_heap (uint64_t** first, uint64_t len)
+hufHeapSiftDown (uint64_t* heap, uint32_t n, uint32_t i, uint64_t key)
 {
-    size_t parent;
-
-    if (len < 2) return;
-    parent = (len - 2) / 2;
-
-    while (1)
+    for (;;)
     {
-        uint64_t* value = *(first + parent);
-        adjust_heap (first, parent, len, value);
-        if (parent == 0) return;
-        --parent;
+        uint32_t c = 2 * i + 1;
+        if (c >= n) break;
+        if (c + 1 < n && heap[c + 1] < heap[c]) ++c;
+        if (key <= heap[c]) break;
+        heap[i] = heap[c];
+        i       = c;
     }
+    heap[i] = key;
 }
 
 static void
@@ -258,56 +199,47 @@ hufBuildEncTable (
     // that are to be Huffman-encoded.  (frq[i] contains the number
     // of occurrences of symbol i in the data.)
     //
-    // The loop below does three things:
-    //
-    // 1) Finds the minimum and maximum indices that point
-    //    to non-zero entries in frq:
+    // The loop below finds the minimum and maximum indices that point
+    // to non-zero entries in frq:
     //
     //     frq[im] != 0, and frq[i] == 0 for all i < im
     //     frq[iM] != 0, and frq[i] == 0 for all i > iM
     //
-    // 2) Fills array fHeap with pointers to all non-zero
-    //    entries in frq.
-    //
-    // 3) Initializes array hlink such that hlink[i] == i
-    //    for all array entries.
+    // and fills the heap with the keys of all non-zero entries in
+    // frq.  The heap is built in place at the start of frq, each key
+    // is written at or before the entry it is computed from.
     //
 
+    uint64_t* heap = frq;
+    uint32_t  nf   = 0;
+
     *im = 0;
 
     while (!frq[*im])
         (*im)++;
 
-    uint32_t nf = 0;
-
     for (uint32_t i = *im; i < HUF_ENCSIZE; i++)
     {
-        hlink[i] = i;
-
         if (frq[i])
         {
-            fHeap[nf] = &frq[i];
-            ++nf;
-            *iM = i;
+            heap[nf++] = (frq[i] << HUF_KEY_SHIFT) | i;
+            *iM        = i;
         }
     }
 
     //
-    // Add a pseudo-symbol, with a frequency count of 1, to frq;
-    // adjust the fHeap and hlink array accordingly.  Function
-    // hufEncode() uses the pseudo-symbol for run-length encoding.
+    // Add a pseudo-symbol, with a frequency count of 1, to the heap.
+    // Function hufEncode() uses the pseudo-symbol for run-length
+    // encoding.
     //
 
     (*iM)++;
-    frq[*iM]  = 1;
-    fHeap[nf] = &frq[*iM];
-    ++nf;
+    heap[nf++] = (((uint64_t) 1) << HUF_KEY_SHIFT) | *iM;
 
     //
-    // Build an array, scode, such that scode[i] contains the number
-    // of bits assigned to symbol i.  Conceptually this is done by
-    // constructing a tree whose leaves are the symbols with non-zero
-    // frequency:
+    // Compute the number of bits assigned to each symbol.
+    // Conceptually this is done by constructing a tree whose leaves
+    // are the symbols with non-zero frequency:
     //
     //     Make a heap that contains all symbols with a non-zero frequency,
     //     with the least frequent symbol on top.
@@ -323,90 +255,96 @@ hufBuildEncTable (
     // leaf node, the distance between the root and the leaf is the length
     // of the code for the corresponding symbol.
     //
-    // The loop below doesn't actually build the tree; instead we compute
-    // the distances of the leaves from the root on the fly.  When a new
-    // node is added to the heap, then that node's descendants are linked
-    // into a single linear list that starts at the new node, and the code
-    // lengths of the descendants (that is, their distance from the root
-    // of the tree) are incremented by one.
+    // The new node takes the heap slot (index) of the second smallest
+    // entry, so the heap keys stay unique.  Rather than incrementing
+    // the lengths of all the descendants of each new node, the tree
+    // is recorded as parent links, and the depths are computed in a
+    // single pass at the end:
+    //
+    //     node[i]   - the tree node currently stored in heap slot i
+    //                 (i for a leaf, HUF_ENCSIZE + k for the k-th
+    //                 internal node)
+    //     lparent   - the internal node parent of each leaf
+    //     iparent   - the internal node parent of each internal node
+    //
+    // These all live in the spare memory (fHeap and scode are only
+    // used as scratch space).
     //
 
-    make_heap (fHeap, nf);
+    uint32_t* node    = hlink;
+    uint32_t* iparent = (uint32_t*) fHeap;
+    uint32_t* lparent = (uint32_t*) scode;
+    uint32_t* leaves  = lparent + HUF_ENCSIZE;
+    uint32_t  nleaves = nf;
+    uint32_t  nint    = 0;
 
-    memset (scode, 0, sizeof (uint64_t) * HUF_ENCSIZE);
+    for (uint32_t i = 0; i < nf; ++i)
+    {
+        uint32_t s = (uint32_t) (heap[i] & HUF_KEY_MASK);
+        leaves[i]  = s;
+        node[s]    = s;
+    }
+
+    for (uint32_t i = nf / 2; i-- > 0;)
+        hufHeapSiftDown (heap, nf, i, heap[i]);
 
     while (nf > 1)
     {
         //
-        // Find the indices, mm and m, of the two smallest non-zero frq
-        // values in fHeap, add the smallest frq to the second-smallest
-        // frq, and remove the smallest frq value from fHeap.
+        // Find the keys of the two smallest frequencies, remove the
+        // smallest, and replace the second smallest with the new node
+        // holding their sum.
         //
 
-        uint32_t mm = (uint32_t) (fHeap[0] - frq);
-        pop_heap (&fHeap[0], &fHeap[nf]);
+        uint64_t mm = heap[0];
         --nf;
+        hufHeapSiftDown (heap, nf, 0, heap[nf]);
 
-        uint32_t m = (uint32_t) (fHeap[0] - frq);
-        pop_heap (&fHeap[0], &fHeap[nf]);
+        uint64_t m = heap[0];
+        uint32_t a = node[mm & HUF_KEY_MASK];
+        uint32_t b = node[m & HUF_KEY_MASK];
 
-        frq[m] += frq[mm];
-        push_heap (&fHeap[0], &fHeap[nf]);
-
-        //
-        // The entries in scode are linked into lists with the
-        // entries in hlink serving as "next" pointers and with
-        // the end of a list marked by hlink[j] == j.
-        //
-        // Traverse the lists that start at scode[m] and scode[mm].
-        // For each element visited, increment the length of the
-        // corresponding code by one bit. (If we visit scode[j]
-        // during the traversal, then the code for symbol j becomes
-        // one bit longer.)
-        //
-        // Merge the lists that start at scode[m] and scode[mm]
-        // into a single list that starts at scode[m].
-        //
-
-        //
-        // Add a bit to all codes in the first list.
-        //
-
-        for (uint32_t j = m;; j = hlink[j])
-        {
-            scode[j]++;
+        if (a < HUF_ENCSIZE)
+            lparent[a] = nint;
+        else
+            iparent[a - HUF_ENCSIZE] = nint;
+        if (b < HUF_ENCSIZE)
+            lparent[b] = nint;
+        else
+            iparent[b - HUF_ENCSIZE] = nint;
 
-            if (hlink[j] == j)
-            {
-                //
-                // Merge the two lists.
-                //
+        node[m & HUF_KEY_MASK] = HUF_ENCSIZE + nint++;
 
-                hlink[j] = mm;
-                break;
-            }
-        }
+        hufHeapSiftDown (
+            heap,
+            nf,
+            0,
+            (((m >> HUF_KEY_SHIFT) + (mm >> HUF_KEY_SHIFT)) << HUF_KEY_SHIFT) |
+                (m & HUF_KEY_MASK));
+    }
 
-        //
-        // Add a bit to all codes in the second list
-        //
+    //
+    // Internal nodes are created after their children, so walking
+    // them from the root down, a node's parent has its depth computed
+    // before the node itself: replace the parent links with depths in
+    // place.  The length of the code for a symbol is then one more
+    // than the depth of its parent.
+    //
 
-        for (uint32_t j = mm;; j = hlink[j])
-        {
-            scode[j]++;
+    iparent[nint - 1] = 0;
+    for (uint32_t k = nint - 1; k-- > 0;)
+        iparent[k] = iparent[iparent[k]] + 1;
 
-            if (hlink[j] == j) break;
-        }
-    }
+    memset (frq, 0, sizeof (uint64_t) * HUF_ENCSIZE);
+    for (uint32_t i = 0; i < nleaves; ++i)
+        frq[leaves[i]] = iparent[lparent[leaves[i]]] + 1;
 
     //
     // Build a canonical Huffman code table, replacing the code
-    // lengths in scode with (code, code length) pairs.  Copy the
-    // code table from scode into frq.
+    // lengths in frq with (code, code length) pairs.
     //
 
-    hufCanonicalCodeTable (scode);
-    memcpy (frq, scode, sizeof (uint64_t) * HUF_ENCSIZE);
+    hufCanonicalCodeTable (frq);
 }
 
 //
@@ -672,32 +610,78 @@ hufFreeDecTable (HufDec* hdecod) // io: Decoding table
 // ENCODING
 //
 
+//
+// The encoder buffers the output bits in a 64-bit word, most
+// significant bit first, and stores a whole word at a time
+// (big-endian).  This produces the same byte stream as outputBits()
+// but avoids a shift and a test per output byte.
+//
+
+typedef struct _HufBitWriter
+{
+    uint64_t buf;   // pending bits, left aligned
+    int      avail; // unused (low) bits in buf
+    uint8_t* out;
+} HufBitWriter;
+
+static inline void
+storeBE64 (uint8_t* out, uint64_t v)
+{
+    out[0] = (uint8_t) (v >> 56);
+    out[1] = (uint8_t) (v >> 48);
+    out[2] = (uint8_t) (v >> 40);
+    out[3] = (uint8_t) (v >> 32);
+    out[4] = (uint8_t) (v >> 24);
+    out[5] = (uint8_t) (v >> 16);
+    out[6] = (uint8_t) (v >> 8);
+    out[7] = (uint8_t) (v);
+}
+
+//
+// Append the low nBits (<= 58) of bits, which must be zero above
+// that, to the output.
+//
+
+static inline void
+writeBits (HufBitWriter* w, int nBits, uint64_t bits)
+{
+    if (nBits < w->avail)
+    {
+        w->avail -= nBits;
+        w->buf |= bits << w->avail;
+    }
+    else
+    {
+        int rem = nBits - w->avail;
+
+        storeBE64 (w->out, w->buf | (bits >> rem));
+        w->out += 8;
+        // shift in two steps, rem may be 0
+        w->avail = 64 - rem;
+        w->buf   = (bits << 1) << (w->avail - 1);
+    }
+}
+
 static inline void
-outputCode (uint64_t code, uint64_t* c, int* lc, uint8_t** out)
+writeCode (HufBitWriter* w, uint64_t code)
 {
-    outputBits (hufLength (code), hufCode (code), c, lc, out);
+    writeBits (w, hufLength (code), hufCode (code));
 }
 
 static inline void
-sendCode (
-    uint64_t  sCode,
-    int       runCount,
-    uint64_t  runCode,
-    uint64_t* c,
-    int*      lc,
-    uint8_t** out)
+sendCode (HufBitWriter* w, uint64_t sCode, int runCount, uint64_t runCode)
 {
     if (hufLength (sCode) + hufLength (runCode) + 8 <
         hufLength (sCode) * runCount)
     {
-        outputCode (sCode, c, lc, out);
-        outputCode (runCode, c, lc, out);
-        outputBits (8, (uint64_t) runCount, c, lc, out);
+        writeCode (w, sCode);
+        writeCode (w, runCode);
+        writeBits (w, 8, (uint64_t) runCount);
     }
     else
     {
         while (runCount-- >= 0)
-            outputCode (sCode, c, lc, out);
+            writeCode (w, sCode);
     }
 }
 
@@ -713,11 +697,15 @@ hufEncode (
     uint32_t        rlc,
     uint8_t*        out)
 {
-    uint8_t* outStart = out;
-    uint64_t c        = 0; // bits not yet written to out
-    int      lc       = 0; // number of valid bits in c (LSB)
-    uint16_t s        = in[0];
-    int      cs       = 0;
+    HufBitWriter w;
+    uint64_t     runCode = hcode[rlc];
+    uint16_t     s       = in[0];
+    int          cs      = 0;
+    int          lc;
+
+    w.buf   = 0;
+    w.avail = 64;
+    w.out   = out;
 
     //
     // Loop on input values
@@ -732,7 +720,7 @@ hufEncode (
         if (s == in[i] && cs < 255) { cs++; }
         else
         {
-            sendCode (hcode[s], cs, hcode[rlc], &c, &lc, &out);
+            sendCode (&w, hcode[s], cs, runCode);
             cs = 0;
         }
 
@@ -740,14 +728,22 @@ hufEncode (
     }
 
     //
-    // Send remaining code
+    // Send remaining code, and flush the whole bytes left in the
+    // buffer, the final partial byte (if any) is zero padded
     //
 
-    sendCode (hcode[s], cs, hcode[rlc], &c, &lc, &out);
+    sendCode (&w, hcode[s], cs, runCode);
 
-    if (lc) *out = (c << (8 - lc)) & 0xff;
+    lc = 64 - w.avail;
+    while (lc >= 8)
+    {
+        *w.out++ = (uint8_t) (w.buf >> 56);
+        w.buf <<= 8;
+        lc -= 8;
+    }
+    if (lc) *w.out = (uint8_t) (w.buf >> 56);
 
-    return (((uintptr_t) out) - ((uintptr_t) outStart)) * 8 + (uint64_t) (lc);
+    return (((uintptr_t) w.out) - ((uintptr_t) out)) * 8 + (uint64_t) (lc);
 }
 
 //
@@ -909,12 +905,55 @@ hufDecode (
     return EXR_ERR_SUCCESS;
 }
 
+//
+// Count the occurrences of each value.  Incrementing a single table,
+// a run of equal values (which is common after the wavelet transform)
+// makes each increment wait for the previous one to store, so for
+// larger inputs, four interleaved 32-bit sub-tables are counted and
+// summed at the end.  The sub-tables (4 * 65536 counts) are placed in
+// the spare memory which is otherwise unused at this point.
+//
+
+#define HUF_NSUBTABLES 4
+#define HUF_SUBTABLE_MIN_COUNT 16384
+
 static inline void
-countFrequencies (uint64_t* freq, const uint16_t* data, uint64_t n)
+countFrequencies (
+    uint64_t*       freq,
+    uint32_t*       sub[HUF_NSUBTABLES],
+    const uint16_t* data,
+    uint64_t        n)
 {
     memset (freq, 0, HUF_ENCSIZE * sizeof (uint64_t));
-    for (uint64_t i = 0; i < n; ++i)
-        ++freq[data[i]];
+
+    if (n < HUF_SUBTABLE_MIN_COUNT || n > (uint64_t) UINT32_MAX)
+    {
+        for (uint64_t i = 0; i < n; ++i)
+            ++freq[data[i]];
+        return;
+    }
+
+    for (int t = 0; t < HUF_NSUBTABLES; ++t)
+        memset (sub[t], 0, 65536 * sizeof (uint32_t));
+
+    uint32_t* c0 = sub[0];
+    uint32_t* c1 = sub[1];
+    uint32_t* c2 = sub[2];
+    uint32_t* c3 = sub[3];
+    uint64_t  i  = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        ++c0[data[i]];
+        ++c1[data[i + 1]];
+        ++c2[data[i + 2]];
+        ++c3[data[i + 3]];
+    }
+    for (; i < n; ++i)
+        ++c0[data[i]];
+
+    for (int v = 0; v < 65536; ++v)
+        freq[v] = (uint64_t) c0[v] + c1[v] + c2[v] + c3[v];
 }
 
 static inline void
@@ -943,6 +982,15 @@ readUInt (const uint8_t* b)
 // codes up to TABLE_LOOKUP_BITS in length.
 #define TABLE_LOOKUP_BITS 14
 
+// Number of bits, and maximum number of symbols, of the multi-symbol
+// lookup table. Fewer bits than the single symbol table, so it's
+// quick to build and stays in the L1 cache.
+#define FASTHUF_MULTI_BITS 11
+#define FASTHUF_MULTI_SYMBOLS 3
+
+// Minimum number of output values to build the multi-symbol table for.
+#define FASTHUF_MULTI_MIN_ELEMS 16384
+
 #include <inttypes.h>
 
 #ifdef __APPLE__
@@ -1002,6 +1050,20 @@ typedef struct FastHufDecoder
     int _lookupSymbol
         [1 << TABLE_LOOKUP_BITS]; /* value = (codeLen << 24) | symbol */
 
+    //
+    // For the common case of short codes, the top FASTHUF_MULTI_BITS
+    // often hold several complete codes. This table holds, for each
+    // value of those bits, up to FASTHUF_MULTI_SYMBOLS symbols
+    // decoded from them, so they can be output with a single lookup.
+    // The RLE symbol is never included, and a count of 0 means the
+    // first code is not short (or is the RLE symbol), so must take
+    // the regular path.
+    //
+    uint64_t _lookupMulti[1 << FASTHUF_MULTI_BITS]; /* value = (count << 56) |
+                                                      (codeLen << 48) |
+                                                      symbols (16 bits each,
+                                                      first in the low bits) */
+
     uint64_t _tableMin;
 } FastHufDecoder;
 
@@ -1102,9 +1164,50 @@ FastHufDecoder_buildTables (
         fhd->_tableMin = 0xffffffffffffffffULL;
     }
     else { fhd->_tableMin = fhd->_ljBase[minIdx]; }
+
     return EXR_ERR_SUCCESS;
 }
 
+//
+// Build the multi-symbol table from the single symbol one: decode as
+// many codes as fit entirely in the top FASTHUF_MULTI_BITS. The bits
+// following a code are shifted up, and the (unknown) bits shifted in
+// are zero, so a code is only accepted if it is completely contained
+// in the known bits, in which case the unknown bits can't change its
+// decoding.
+//
+
+static void
+FastHufDecoder_buildMultiTable (FastHufDecoder* fhd)
+{
+    for (int i = 0; i < 1 << FASTHUF_MULTI_BITS; ++i)
+    {
+        uint64_t symbols = 0;
+        int      count   = 0;
+        int      len     = 0;
+
+        while (count < FASTHUF_MULTI_SYMBOLS)
+        {
+            int idx = (i << (len + TABLE_LOOKUP_BITS - FASTHUF_MULTI_BITS)) &
+                      ((1 << TABLE_LOOKUP_BITS) - 1);
+            int tableIdx = fhd->_lookupSymbol[idx];
+            int codeLen  = tableIdx >> 24;
+            int symbol   = tableIdx & 0xffffff;
+
+            if (codeLen == 0 || codeLen > FASTHUF_MULTI_BITS - len ||
+                symbol == fhd->_rleSymbol || symbol > 0xffff)
+                break;
+
+            symbols |= ((uint64_t) symbol) << (16 * count);
+            len += codeLen;
+            ++count;
+        }
+
+        fhd->_lookupMulti[i] =
+            (((uint64_t) count) << 56) | (((uint64_t) len) << 48) | symbols;
+    }
+}
+
 static inline void
 FastHufDecoder_refill (
     uint64_t*       buffer,
@@ -1442,8 +1545,25 @@ fasthuf_decode_enabled ()
 #endif
 }
 
-static exr_result_t
-fasthuf_decode (
+//
+// On x86-64 with GCC / clang, the decoder is also compiled for BMI2,
+// which provides flag-less variable shifts (shlx / shrx) and bzhi,
+// used throughout the bit buffer handling, and selected at runtime.
+//
+
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(__BMI2__) &&         \
+    (defined(__GNUC__) || defined(__clang__))
+#    define FASTHUF_DISPATCH_BMI2 1
+#    define FASTHUF_DECODE_INLINE static inline __attribute__ ((always_inline))
+#    ifndef _WIN32
+#        include <cpuid.h>
+#    endif
+#else
+#    define FASTHUF_DECODE_INLINE static inline
+#endif
+
+FASTHUF_DECODE_INLINE exr_result_t
+fasthuf_decode_impl (
     const struct _internal_exr_context* pctxt,
     FastHufDecoder*                     fhd,
     const uint8_t*                      src,
@@ -1476,11 +1596,68 @@ fasthuf_decode (
 
     int dstIdx = 0;
 
+    //
+    // The multi-symbol table only pays for itself with enough output,
+    // and when at least two codes fit in its bits (which is not the
+    // case for noisy data).
+    //
+
+    int useMulti = numDstElems >= FASTHUF_MULTI_MIN_ELEMS &&
+                   2 * fhd->_minCodeLength <= FASTHUF_MULTI_BITS;
+
+    if (useMulti) FastHufDecoder_buildMultiTable (fhd);
+
     while (dstIdx < numDstElems)
     {
         int codeLen;
         int symbol;
 
+        //
+        // Output several symbols per lookup while the top bits
+        // hold short codes. The buffer only needs TABLE_LOOKUP_BITS
+        // valid bits for this, so it is refilled once it runs low,
+        // rather than after every code. The bits below the valid ones
+        // are zero, so comparing against _tableMin is conservative.
+        //
+
+        if (useMulti)
+        {
+            while (bufferNumBits >= FASTHUF_MULTI_BITS &&
+                   fhd->_tableMin <= buffer &&
+                   dstIdx + FASTHUF_MULTI_SYMBOLS <= numDstElems)
+            {
+                uint64_t multi =
+                    fhd->_lookupMulti[buffer >> (64 - FASTHUF_MULTI_BITS)];
+                int count = (int) (multi >> 56);
+
+                if (count == 0) break;
+
+                dst[dstIdx]     = (uint16_t) multi;
+                dst[dstIdx + 1] = (uint16_t) (multi >> 16);
+                dst[dstIdx + 2] = (uint16_t) (multi >> 32);
+                dstIdx += count;
+
+                codeLen = (int) (multi >> 48) & 0xff;
+                buffer  = buffer << codeLen;
+                bufferNumBits -= codeLen;
+            }
+
+            if (bufferNumBits < 64)
+            {
+                FastHufDecoder_refill (
+                    &buffer,
+                    64 - bufferNumBits,
+                    &bufferBack,
+                    &bufferBackNumBits,
+                    &currByte,
+                    &numSrcBits);
+
+                bufferNumBits = 64;
+            }
+
+            if (dstIdx >= numDstElems) break;
+        }
+
         //
         // Test if we can be table accelerated. If so, directly
         // lookup the output symbol. Otherwise, we need to fall
@@ -1655,6 +1832,76 @@ fasthuf_decode (
     return EXR_ERR_SUCCESS;
 }
 
+static exr_result_t
+fasthuf_decode_generic (
+    const struct _internal_exr_context* pctxt,
+    FastHufDecoder*                     fhd,
+    const uint8_t*                      src,
+    int                                 numSrcBits,
+    uint16_t*                           dst,
+    int                                 numDstElems)
+{
+    return fasthuf_decode_impl (
+        pctxt, fhd, src, numSrcBits, dst, numDstElems);
+}
+
+#ifdef FASTHUF_DISPATCH_BMI2
+
+__attribute__ ((target ("bmi2"))) static exr_result_t
+fasthuf_decode_bmi2 (
+    const struct _internal_exr_context* pctxt,
+    FastHufDecoder*                     fhd,
+    const uint8_t*                      src,
+    int                                 numSrcBits,
+    uint16_t*                           dst,
+    int                                 numDstElems)
+{
+    return fasthuf_decode_impl (
+        pctxt, fhd, src, numSrcBits, dst, numDstElems);
+}
+
+static int
+fasthuf_has_bmi2 (void)
+{
+    // BMI2 is indicated by bit 8 of EBX in leaf 7, sub-leaf 0
+#    ifdef _WIN32
+    int regs[4];
+
+    __cpuid (regs, 0);
+    if (regs[0] >= 7) { __cpuidex (regs, 7, 0); }
+    else
+        regs[1] = 0;
+#    else
+    unsigned int regs[4] = {0, 0, 0, 0};
+    __get_cpuid (0, &regs[0], &regs[1], &regs[2], &regs[3]);
+    if (regs[0] >= 7)
+    {
+        __cpuid_count (7, 0, regs[0], regs[1], regs[2], regs[3]);
+    }
+    else
+        regs[1] = 0;
+#    endif
+    return (regs[1] & (1 << 8)) ? 1 : 0;
+}
+
+#endif /* FASTHUF_DISPATCH_BMI2 */
+
+static exr_result_t (*fasthuf_decode) (
+    const struct _internal_exr_context*,
+    FastHufDecoder*,
+    const uint8_t*,
+    int,
+    uint16_t*,
+    int) = &fasthuf_decode_generic;
+
+static void
+choose_fasthuf_decode_impl (void)
+{
+#ifdef FASTHUF_DISPATCH_BMI2
+    if (fasthuf_has_bmi2 ()) fasthuf_decode = &fasthuf_decode_bmi2;
+#endif
+}
+
 /**************************************/
 
 uint64_t
@@ -1694,6 +1941,7 @@ internal_huf_compress (
     uint32_t*  hlink;
     uint64_t** fHeap;
     uint64_t*  scode;
+    uint32_t*  sub[HUF_NSUBTABLES];
     uint32_t   im = 0;
     uint32_t   iM = 0;
     uint32_t   tableLength, nBits, dataLength;
@@ -1717,7 +1965,11 @@ internal_huf_compress (
     fHeap = (uint64_t**) (scode + HUF_ENCSIZE);
     hlink = (uint32_t*) (fHeap + HUF_ENCSIZE);
 
-    countFrequencies (freq, raw, nRaw);
+    sub[0] = (uint32_t*) scode;
+    sub[1] = sub[0] + 65536;
+    sub[2] = hlink;
+    sub[3] = (uint32_t*) fHeap;
+    countFrequencies (freq, sub, raw, nRaw);
 
     hufBuildEncTable (freq, &im, &iM, hlink, fHeap, scode);
 
@@ -1791,7 +2043,14 @@ internal_huf_decompress (
     //
     if (fasthuf_decode_enabled () && nBits > 128)
     {
-        FastHufDecoder* fhd = (FastHufDecoder*) spare;
+        FastHufDecoder* fhd            = (FastHufDecoder*) spare;
+        static int      init_cpu_check = 1;
+
+        if (init_cpu_check)
+        {
+            choose_fasthuf_decode_impl ();
+            init_cpu_check = 0;
+        }
 
         // must be nBytes remaining in buffer
         if (ptr - compressed + nBytes > (uint64_t) nCompressed)
@@ -0,0 +1,130 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#include "internal_compress.h"
+#include "internal_decompress.h"
+
+#include "internal_coding.h"
+#include "internal_structs.h"
+
+#include "OpenEXRConfigInternal.h"
+
+#include <string.h>
+
+#ifdef OPENEXR_HAVE_LZ4
+#    include <lz4.h>
+#endif
+
+/* LZ4 uses the same byte reordering and predictor as ZIP, only
+ * replacing deflate with lz4, which compresses less but codes at
+ * close to memory bandwidth, for scratch and intermediate files.
+ */
+
+/**************************************/
+
+exr_result_t
+internal_exr_apply_lz4 (exr_encode_pipeline_t* encode)
+{
+#ifdef OPENEXR_HAVE_LZ4
+    exr_result_t rv;
+    int          compbufsz, maxsz;
+
+    if (encode->packed_bytes > (uint64_t) LZ4_MAX_INPUT_SIZE)
+        return EXR_ERR_OUT_OF_MEMORY;
+
+    rv = internal_encode_alloc_buffer (
+        encode,
+        EXR_TRANSCODE_BUFFER_SCRATCH1,
+        &(encode->scratch_buffer_1),
+        &(encode->scratch_alloc_size_1),
+        encode->packed_bytes);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    internal_zip_deconstruct_bytes (
+        encode->scratch_buffer_1, encode->packed_buffer, encode->packed_bytes);
+
+    maxsz = (encode->compressed_alloc_size > (uint64_t) LZ4_MAX_INPUT_SIZE)
+                ? LZ4_MAX_INPUT_SIZE
+                : (int) encode->compressed_alloc_size;
+
+    /* if it does not fit, it did not compress, so store it raw */
+    compbufsz = LZ4_compress_default (
+        (const char*) encode->scratch_buffer_1,
+        (char*) encode->compressed_buffer,
+        (int) encode->packed_bytes,
+        maxsz);
+
+    if (compbufsz <= 0 || (uint64_t) compbufsz >= encode->packed_bytes)
+    {
+        memcpy (
+            encode->compressed_buffer,
+            encode->packed_buffer,
+            encode->packed_bytes);
+        encode->compressed_bytes = encode->packed_bytes;
+    }
+    else
+        encode->compressed_bytes = (uint64_t) compbufsz;
+    return EXR_ERR_SUCCESS;
+#else
+    EXR_PROMOTE_CONST_CONTEXT_AND_PART_OR_ERROR_NO_LOCK (
+        encode->context, encode->part_index);
+    return pctxt->report_error (
+        pctxt,
+        EXR_ERR_FEATURE_NOT_IMPLEMENTED,
+        "LZ4 compression not available in this build");
+#endif
+}
+
+/**************************************/
+
+exr_result_t
+internal_exr_undo_lz4 (
+    exr_decode_pipeline_t* decode,
+    const void*            compressed_data,
+    uint64_t               comp_buf_size,
+    void*                  uncompressed_data,
+    uint64_t               uncompressed_size)
+{
+#ifdef OPENEXR_HAVE_LZ4
+    exr_result_t rv;
+    int          outsz;
+
+    if (comp_buf_size > (uint64_t) LZ4_MAX_INPUT_SIZE ||
+        uncompressed_size > (uint64_t) LZ4_MAX_INPUT_SIZE)
+        return EXR_ERR_CORRUPT_CHUNK;
+
+    rv = internal_decode_alloc_buffer (
+        decode,
+        EXR_TRANSCODE_BUFFER_SCRATCH1,
+        &(decode->scratch_buffer_1),
+        &(decode->scratch_alloc_size_1),
+        uncompressed_size);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    outsz = LZ4_decompress_safe (
+        (const char*) compressed_data,
+        (char*) decode->scratch_buffer_1,
+        (int) comp_buf_size,
+        (int) uncompressed_size);
+    if (outsz < 0 || (uint64_t) outsz != uncompressed_size)
+        return EXR_ERR_CORRUPT_CHUNK;
+
+    if (outsz > 0)
+        internal_zip_reconstruct_bytes (
+            uncompressed_data, decode->scratch_buffer_1, (uint64_t) outsz);
+    return EXR_ERR_SUCCESS;
+#else
+    (void) compressed_data;
+    (void) comp_buf_size;
+    (void) uncompressed_data;
+    (void) uncompressed_size;
+    EXR_PROMOTE_CONST_CONTEXT_AND_PART_OR_ERROR_NO_LOCK (
+        decode->context, decode->part_index);
+    return pctxt->report_error (
+        pctxt,
+        EXR_ERR_FEATURE_NOT_IMPLEMENTED,
+        "LZ4 decompression not available in this build");
+#endif
+}
@@ -8,6 +8,7 @@
 
 #include "internal_coding.h"
 #include "internal_huf.h"
+#include "internal_wav.h"
 #include "internal_xdr.h"
 
 #include <string.h>
@@ -93,311 +94,6 @@ applyLut (const uint16_t* lut, uint16_t* data, uint64_t nData)
 }
 
 /**************************************/
-//
-// Wavelet basis functions without modulo arithmetic; they produce
-// the best compression ratios when the wavelet-transformed data are
-// Huffman-encoded, but the wavelet transform works only for 14-bit
-// data (untransformed data values must be less than (1 << 14)).
-//
-
-static inline void
-wenc14 (uint16_t a, uint16_t b, uint16_t* l, uint16_t* h)
-{
-    int16_t as = (int16_t) a;
-    int16_t bs = (int16_t) b;
-
-    int16_t ms = (as + bs) >> 1;
-    int16_t ds = as - bs;
-
-    *l = (uint16_t) ms;
-    *h = (uint16_t) ds;
-}
-
-static inline void
-wdec14 (uint16_t l, uint16_t h, uint16_t* a, uint16_t* b)
-{
-    int16_t ls = (int16_t) l;
-    int16_t hs = (int16_t) h;
-
-    int hi = hs;
-    int ai = ls + (hi & 1) + (hi >> 1);
-
-    int16_t as = (int16_t) ai;
-    int16_t bs = (int16_t) (ai - hi);
-
-    *a = (uint16_t) as;
-    *b = (uint16_t) bs;
-}
-
-//
-// Wavelet basis functions with modulo arithmetic; they work with full
-// 16-bit data, but Huffman-encoding the wavelet-transformed data doesn't
-// compress the data quite as well.
-//
-
-#define NBITS ((int) 16)
-#define A_OFFSET ((int) 1 << (NBITS - 1))
-#define M_OFFSET ((int) 1 << (NBITS - 1))
-#define MOD_MASK ((int) (1 << NBITS) - 1)
-
-static inline void
-wenc16 (uint16_t a, uint16_t b, uint16_t* l, uint16_t* h)
-{
-    int ao = (((int) a) + A_OFFSET) & MOD_MASK;
-    int m  = ((ao + ((int) b)) >> 1);
-    int d  = ao - ((int) b);
-
-    if (d < 0) m = (m + M_OFFSET) & MOD_MASK;
-
-    d &= MOD_MASK;
-
-    *l = (uint16_t) m;
-    *h = (uint16_t) d;
-}
-
-static inline void
-wdec16 (uint16_t l, uint16_t h, uint16_t* a, uint16_t* b)
-{
-    int m  = (int) l;
-    int d  = (int) h;
-    int bb = (m - (d >> 1)) & MOD_MASK;
-    int aa = (d + bb - A_OFFSET) & MOD_MASK;
-    *b     = (uint16_t) bb;
-    *a     = (uint16_t) aa;
-}
-
-/**************************************/
-
-static void
-wav_2D_encode (uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx)
-{
-    int w14 = (mx < (1 << 14)) ? 1 : 0;
-    int n   = (nx > ny) ? ny : nx;
-    int p   = 1; // == 1 <<  level
-    int p2  = 2; // == 1 << (level+1)
-
-    //
-    // Hierarchical loop on smaller dimension n
-    //
-
-    while (p2 <= n)
-    {
-        uint16_t* py  = in;
-        uint16_t* ey  = in + oy * (ny - p2);
-        int       oy1 = oy * p;
-        int       oy2 = oy * p2;
-        int       ox1 = ox * p;
-        int       ox2 = ox * p2;
-        uint16_t  i00, i01, i10, i11;
-
-        //
-        // Y loop
-        //
-
-        for (; py <= ey; py += oy2)
-        {
-            uint16_t* px = py;
-            uint16_t* ex = py + ox * (nx - p2);
-
-            //
-            // X loop
-            //
-
-            for (; px <= ex; px += ox2)
-            {
-                uint16_t* p01 = px + ox1;
-                uint16_t* p10 = px + oy1;
-                uint16_t* p11 = p10 + ox1;
-
-                //
-                // 2D wavelet encoding
-                //
-
-                if (w14)
-                {
-                    wenc14 (*px, *p01, &i00, &i01);
-                    wenc14 (*p10, *p11, &i10, &i11);
-                    wenc14 (i00, i10, px, p10);
-                    wenc14 (i01, i11, p01, p11);
-                }
-                else
-                {
-                    wenc16 (*px, *p01, &i00, &i01);
-                    wenc16 (*p10, *p11, &i10, &i11);
-                    wenc16 (i00, i10, px, p10);
-                    wenc16 (i01, i11, p01, p11);
-                }
-            }
-
-            //
-            // Encode (1D) odd column (still in Y loop)
-            //
-
-            if (nx & p)
-            {
-                uint16_t* p10 = px + oy1;
-
-                if (w14)
-                    wenc14 (*px, *p10, px, p10);
-                else
-                    wenc16 (*px, *p10, px, p10);
-            }
-        }
-
-        //
-        // Encode (1D) odd line (must loop in X)
-        //
-
-        if (ny & p)
-        {
-            uint16_t* px = py;
-            uint16_t* ex = py + ox * (nx - p2);
-
-            for (; px <= ex; px += ox2)
-            {
-                uint16_t* p01 = px + ox1;
-
-                if (w14)
-                    wenc14 (*px, *p01, px, p01);
-                else
-                    wenc16 (*px, *p01, px, p01);
-            }
-        }
-
-        //
-        // Next level
-        //
-
-        p = p2;
-        p2 <<= 1;
-    }
-}
-
-/**************************************/
-
-static void
-wav_2D_decode (
-    uint16_t* in, // io: values are transformed in place
-    int       nx, // i : x size
-    int       ox, // i : x offset
-    int       ny, // i : y size
-    int       oy, // i : y offset
-    uint16_t  mx)  // i : maximum in[x][y] value
-{
-    int w14 = (mx < (1 << 14)) ? 1 : 0;
-    int n   = (nx > ny) ? ny : nx;
-    int p   = 1;
-    int p2;
-
-    //
-    // Search max level
-    //
-
-    while (p <= n)
-        p <<= 1;
-
-    p >>= 1;
-    p2 = p;
-    p >>= 1;
-
-    //
-    // Hierarchical loop on smaller dimension n
-    //
-
-    while (p >= 1)
-    {
-        uint16_t* py  = in;
-        uint16_t* ey  = in + oy * (ny - p2);
-        int       oy1 = oy * p;
-        int       oy2 = oy * p2;
-        int       ox1 = ox * p;
-        int       ox2 = ox * p2;
-        uint16_t  i00, i01, i10, i11;
-
-        //
-        // Y loop
-        //
-
-        for (; py <= ey; py += oy2)
-        {
-            uint16_t* px = py;
-            uint16_t* ex = py + ox * (nx - p2);
-
-            //
-            // X loop
-            //
-
-            for (; px <= ex; px += ox2)
-            {
-                uint16_t* p01 = px + ox1;
-                uint16_t* p10 = px + oy1;
-                uint16_t* p11 = p10 + ox1;
-
-                //
-                // 2D wavelet decoding
-                //
-
-                if (w14)
-                {
-                    wdec14 (*px, *p10, &i00, &i10);
-                    wdec14 (*p01, *p11, &i01, &i11);
-                    wdec14 (i00, i01, px, p01);
-                    wdec14 (i10, i11, p10, p11);
-                }
-                else
-                {
-                    wdec16 (*px, *p10, &i00, &i10);
-                    wdec16 (*p01, *p11, &i01, &i11);
-                    wdec16 (i00, i01, px, p01);
-                    wdec16 (i10, i11, p10, p11);
-                }
-            }
-
-            //
-            // Decode (1D) odd column (still in Y loop)
-            //
-
-            if (nx & p)
-            {
-                uint16_t* p10 = px + oy1;
-
-                if (w14)
-                    wdec14 (*px, *p10, &i00, p10);
-                else
-                    wdec16 (*px, *p10, &i00, p10);
-                *px = i00;
-            }
-        }
-
-        //
-        // Decode (1D) odd line (must loop in X)
-        //
-
-        if (ny & p)
-        {
-            uint16_t* px = py;
-            uint16_t* ex = py + ox * (nx - p2);
-
-            for (; px <= ex; px += ox2)
-            {
-                uint16_t* p01 = px + ox1;
-
-                if (w14)
-                    wdec14 (*px, *p01, &i00, p01);
-                else
-                    wdec16 (*px, *p01, &i00, p01);
-                *px = i00;
-            }
-        }
-
-        //
-        // Next level
-        //
-
-        p2 = p;
-        p >>= 1;
-    }
-}
 
 exr_result_t
 internal_exr_apply_piz (exr_encode_pipeline_t* encode)
@@ -504,7 +200,8 @@ internal_exr_apply_piz (exr_encode_pipeline_t* encode)
         wcount = (int) (curc->bytes_per_element / 2);
         for (int j = 0; j < wcount; ++j)
         {
-            wav_2D_encode (wavbuf + j, nx, wcount, ny, wcount * nx, maxValue);
+            internal_wav_2D_encode (
+                wavbuf + j, nx, wcount, ny, wcount * nx, maxValue);
         }
         wavbuf += nx * ny * wcount;
     }
@@ -538,17 +235,18 @@ internal_exr_apply_piz (exr_encode_pipeline_t* encode)
 
 /**************************************/
 
-exr_result_t
-internal_exr_undo_piz (
+/* reads the range compression and Huffman data to the first scratch
+ * buffer, of wavbytes, and undoes the wavelet transform there, at
+ * reduced resolution for level > 0, leaving the reverse lut in *lutp */
+static exr_result_t
+undo_piz_wavelets (
     exr_decode_pipeline_t* decode,
     const void*            src,
     uint64_t               packsz,
-    void*                  outptr,
-    uint64_t               outsz)
+    uint64_t               wavbytes,
+    int                    level,
+    uint16_t**             lutp)
 {
-    uint8_t*       out  = outptr;
-    uint64_t       nOut = 0;
-    uint8_t *      scratch, *tmp;
     const uint8_t* packed;
     int            nx, ny, wcount;
     uint64_t       nBytes;
@@ -566,7 +264,7 @@ internal_exr_undo_piz (
         EXR_TRANSCODE_BUFFER_SCRATCH1,
         &(decode->scratch_buffer_1),
         &(decode->scratch_alloc_size_1),
-        outsz);
+        wavbytes);
     if (rv != EXR_ERR_SUCCESS) return rv;
 
     rv = internal_decode_alloc_buffer (
@@ -626,7 +324,7 @@ internal_exr_undo_piz (
         packed + nBytes,
         hufbytes,
         wavbuf,
-        outsz / 2,
+        wavbytes / 2,
         hufspare,
         hufSpareBytes);
     if (rv != EXR_ERR_SUCCESS) return rv;
@@ -645,11 +343,40 @@ internal_exr_undo_piz (
         wcount = (int) (curc->bytes_per_element / 2);
         for (int j = 0; j < wcount; ++j)
         {
-            wav_2D_decode (wavbuf + j, nx, wcount, ny, wcount * nx, maxValue);
+            if (level > 0)
+                internal_wav_2D_decode_reduced (
+                    wavbuf + j, nx, wcount, ny, wcount * nx, maxValue, level);
+            else
+                internal_wav_2D_decode (
+                    wavbuf + j, nx, wcount, ny, wcount * nx, maxValue);
         }
         wavbuf += nx * ny * wcount;
     }
 
+    *lutp = lut;
+    return EXR_ERR_SUCCESS;
+}
+
+exr_result_t
+internal_exr_undo_piz (
+    exr_decode_pipeline_t* decode,
+    const void*            src,
+    uint64_t               packsz,
+    void*                  outptr,
+    uint64_t               outsz)
+{
+    uint8_t*     out  = outptr;
+    uint64_t     nOut = 0;
+    uint8_t *    scratch, *tmp;
+    int          nx, ny;
+    uint64_t     nBytes;
+    exr_result_t rv;
+    uint16_t*    lut;
+    uint16_t*    wavbuf;
+
+    rv = undo_piz_wavelets (decode, src, packsz, outsz, 0, &lut);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
     //
     // Expand the pixel data to their original range
     //
@@ -698,3 +425,133 @@ internal_exr_undo_piz (
     if (nOut != outsz) return EXR_ERR_CORRUPT_CHUNK;
     return EXR_ERR_SUCCESS;
 }
+
+/**************************************/
+
+uint64_t
+internal_exr_piz_reduced_size (const exr_decode_pipeline_t* decode, int level)
+{
+    uint64_t step = ((uint64_t) 1) << level;
+    uint64_t size = 0;
+
+    for (int c = 0; c < decode->channel_count; ++c)
+    {
+        const exr_coding_channel_info_t* curc = decode->channels + c;
+
+        size += ((((uint64_t) curc->width) + step - 1) / step) *
+                ((((uint64_t) curc->height) + step - 1) / step) *
+                ((uint64_t) curc->bytes_per_element);
+    }
+    return size;
+}
+
+/* chunks that did not compress are stored as is, pick the samples
+ * out of the scanline interleaved layout instead */
+static exr_result_t
+reduce_uncompressed (
+    exr_decode_pipeline_t* decode, const void* src, int step, void* outptr)
+{
+    const uint8_t* in    = src;
+    uint8_t*       plane = outptr;
+
+    for (int c = 0; c < decode->channel_count; ++c)
+    {
+        const exr_coding_channel_info_t* curc = decode->channels + c;
+        uint64_t bpe   = (uint64_t) curc->bytes_per_element;
+        uint64_t outnx = (((uint64_t) curc->width) + step - 1) / step;
+        uint64_t outny = (((uint64_t) curc->height) + step - 1) / step;
+        const uint8_t* row = in;
+        int            sy  = 0;
+
+        for (int y = 0; y < decode->chunk.height; ++y)
+        {
+            int cury = y + decode->chunk.start_y;
+
+            for (int oc = 0; oc < decode->channel_count; ++oc)
+            {
+                const exr_coding_channel_info_t* occ = decode->channels + oc;
+                uint64_t nBytes =
+                    ((uint64_t) occ->width) * ((uint64_t) occ->bytes_per_element);
+
+                if (occ->y_samples > 1 && (cury % occ->y_samples) != 0)
+                    continue;
+
+                if (oc == c)
+                {
+                    if (sy % step == 0 && sy < curc->height)
+                    {
+                        uint8_t* dst =
+                            plane + ((uint64_t) (sy / step)) * outnx * bpe;
+
+                        for (int x = 0; x < curc->width; x += step)
+                        {
+                            memcpy (dst, row + ((uint64_t) x) * bpe, bpe);
+                            dst += bpe;
+                        }
+                    }
+                    ++sy;
+                }
+                row += nBytes;
+            }
+        }
+
+        plane += outnx * outny * bpe;
+    }
+
+    return EXR_ERR_SUCCESS;
+}
+
+exr_result_t
+internal_exr_undo_piz_reduced (
+    exr_decode_pipeline_t* decode,
+    const void*            src,
+    uint64_t               packsz,
+    int                    level,
+    void*                  outptr,
+    uint64_t               outsz)
+{
+    uint16_t*       out = outptr;
+    const uint16_t* wavbuf;
+    uint16_t*       lut;
+    exr_result_t    rv;
+    int             step = 1 << level;
+
+    if (level < 1 || level > 3) return EXR_ERR_INVALID_ARGUMENT;
+    if (outsz < internal_exr_piz_reduced_size (decode, level))
+        return EXR_ERR_OUT_OF_MEMORY;
+
+    if (packsz == decode->chunk.unpacked_size)
+        return reduce_uncompressed (decode, src, step, outptr);
+
+    rv = undo_piz_wavelets (
+        decode, src, packsz, decode->chunk.unpacked_size, level, &lut);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    //
+    // Pick every step-th sample of each channel, expanding only those
+    // to their original range
+    //
+
+    wavbuf = decode->scratch_buffer_1;
+    for (int c = 0; c < decode->channel_count; ++c)
+    {
+        const exr_coding_channel_info_t* curc = decode->channels + c;
+        int                              nx   = curc->width;
+        int                              ny   = curc->height;
+        int wcount = (int) (curc->bytes_per_element / 2);
+
+        for (int y = 0; y < ny; y += step)
+        {
+            const uint16_t* row = wavbuf + ((uint64_t) y) * nx * wcount;
+
+            for (int x = 0; x < nx; x += step)
+            {
+                for (int j = 0; j < wcount; ++j)
+                    *out++ = one_from_native16 (lut[row[x * wcount + j]]);
+            }
+        }
+        wavbuf += ((uint64_t) nx) * ny * wcount;
+    }
+
+    return EXR_ERR_SUCCESS;
+}
@@ -7,85 +7,13 @@
 #include "internal_decompress.h"
 
 #include "internal_coding.h"
-#include "internal_xdr.h"
+#include "internal_pxr24_row.h"
 
 #include <string.h>
 #include <zlib.h>
 
 /**************************************/
 
-static inline uint32_t
-float_to_float24 (float f)
-{
-    union
-    {
-        float    f;
-        uint32_t i;
-    } u;
-
-    u.f = f;
-
-    //
-    // Disassemble the 32-bit floating point number, f,
-    // into sign, s, exponent, e, and significand, m.
-    //
-
-    uint32_t s = u.i & 0x80000000;
-    uint32_t e = u.i & 0x7f800000;
-    uint32_t m = u.i & 0x007fffff;
-    uint32_t i;
-
-    if (e == 0x7f800000)
-    {
-        if (m)
-        {
-            //
-            // F is a NAN; we preserve the sign bit and
-            // the 15 leftmost bits of the significand,
-            // with one exception: If the 15 leftmost
-            // bits are all zero, the NAN would turn
-            // into an infinity, so we have to set at
-            // least one bit in the significand.
-            //
-
-            m >>= 8;
-            i = (e >> 8) | m | (m == 0);
-        }
-        else
-        {
-            //
-            // F is an infinity.
-            //
-
-            i = e >> 8;
-        }
-    }
-    else
-    {
-        //
-        // F is finite, round the significand to 15 bits.
-        //
-
-        i = ((e | m) + (m & 0x00000080)) >> 8;
-
-        if (i >= 0x7f8000)
-        {
-            //
-            // F was close to FLT_MAX, and the significand was
-            // rounded up, resulting in an exponent overflow.
-            // Avoid the overflow by truncating the significand
-            // instead of rounding it.
-            //
-
-            i = (e | m) >> 8;
-        }
-    }
-
-    return (s >> 8) | i;
-}
-
-/**************************************/
-
 static exr_result_t
 apply_pxr24_impl (exr_encode_pipeline_t* encode)
 {
@@ -110,108 +38,22 @@ apply_pxr24_impl (exr_encode_pipeline_t* encode)
 
             switch (curc->data_type)
             {
-                case EXR_PIXEL_UINT: {
-                    uint8_t*        ptr[4];
-                    uint32_t        prevPixel = 0;
-                    const uint32_t* din       = (const uint32_t*) (lastIn);
-
-                    nBytes *= sizeof (uint32_t);
-                    if (nOut + nBytes > encode->scratch_alloc_size_1)
-                        return EXR_ERR_OUT_OF_MEMORY;
-                    nOut += nBytes;
-                    lastIn += nBytes;
-
-                    ptr[0] = out;
-                    out += w;
-                    ptr[1] = out;
-                    out += w;
-                    ptr[2] = out;
-                    out += w;
-                    ptr[3] = out;
-                    out += w;
-
-                    for (int x = 0; x < w; ++x)
-                    {
-                        uint32_t pixel = unaligned_load32 (din);
-                        uint32_t diff  = pixel - prevPixel;
-                        prevPixel      = pixel;
-
-                        ++din;
-                        *(ptr[0]++) = (uint8_t) (diff >> 24);
-                        *(ptr[1]++) = (uint8_t) (diff >> 16);
-                        *(ptr[2]++) = (uint8_t) (diff >> 8);
-                        *(ptr[3]++) = (uint8_t) (diff);
-                    }
-                    break;
-                }
-                case EXR_PIXEL_HALF: {
-                    uint8_t*        ptr[2];
-                    uint32_t        prevPixel = 0;
-                    const uint16_t* din       = (const uint16_t*) (lastIn);
-
-                    nBytes *= sizeof (uint16_t);
-                    if (nOut + nBytes > encode->scratch_alloc_size_1)
-                        return EXR_ERR_OUT_OF_MEMORY;
-                    nOut += nBytes;
-                    lastIn += nBytes;
-
-                    ptr[0] = out;
-                    out += w;
-                    ptr[1] = out;
-                    out += w;
-
-                    for (int x = 0; x < w; ++x)
-                    {
-                        uint32_t pixel = (uint32_t) unaligned_load16 (din);
-                        uint32_t diff  = pixel - prevPixel;
-                        prevPixel      = pixel;
-
-                        ++din;
-                        *(ptr[0]++) = (uint8_t) (diff >> 8);
-                        *(ptr[1]++) = (uint8_t) (diff);
-                    }
+                case EXR_PIXEL_UINT:
+                case EXR_PIXEL_HALF:
+                    nBytes *= (uint64_t) curc->bytes_per_element;
                     break;
-                }
-                case EXR_PIXEL_FLOAT: {
-                    uint8_t*     ptr[3];
-                    uint32_t     prevPixel = 0;
-                    const float* din       = (const float*) (lastIn);
-
-                    nBytes *= 3;
-                    if (nOut + nBytes > encode->scratch_alloc_size_1)
-                        return EXR_ERR_OUT_OF_MEMORY;
-                    nOut += nBytes;
-                    lastIn += w * 4;
+                case EXR_PIXEL_FLOAT: nBytes *= 3; break;
+                default: return EXR_ERR_INVALID_ARGUMENT;
+            }
 
-                    ptr[0] = out;
-                    out += w;
-                    ptr[1] = out;
-                    out += w;
-                    ptr[2] = out;
-                    out += w;
+            if (nOut + nBytes > encode->scratch_alloc_size_1)
+                return EXR_ERR_OUT_OF_MEMORY;
 
-                    for (int x = 0; x < w; ++x)
-                    {
-                        union
-                        {
-                            uint32_t i;
-                            float    f;
-                        } v;
-                        uint32_t pixel24, diff;
-                        v.i       = unaligned_load32 (din);
-                        pixel24   = float_to_float24 (v.f);
-                        diff      = pixel24 - prevPixel;
-                        prevPixel = pixel24;
+            internal_pxr24_split_row (curc->data_type, lastIn, w, out);
 
-                        ++din;
-                        *(ptr[0]++) = (uint8_t) (diff >> 16);
-                        *(ptr[1]++) = (uint8_t) (diff >> 8);
-                        *(ptr[2]++) = (uint8_t) (diff);
-                    }
-                    break;
-                }
-                default: return EXR_ERR_INVALID_ARGUMENT;
-            }
+            nOut += nBytes;
+            out += nBytes;
+            lastIn += (uint64_t) w * (uint64_t) curc->bytes_per_element;
         }
     }
 
@@ -289,6 +131,7 @@ undo_pxr24_impl (
             int                              w    = curc->width;
             uint64_t                         nBytes =
                 (uint64_t) (w) * (uint64_t) (curc->bytes_per_element);
+            uint64_t nPlanes;
 
             if (curc->height == 0 ||
                 (curc->y_samples > 1 && (cury % curc->y_samples) != 0))
@@ -298,90 +141,18 @@ undo_pxr24_impl (
 
             switch (curc->data_type)
             {
-                case EXR_PIXEL_UINT: {
-                    const uint8_t* ptr[4];
-                    uint32_t       pixel = 0;
-                    uint32_t*      dout  = (uint32_t*) (out);
-
-                    ptr[0] = lastIn;
-                    lastIn += w;
-                    ptr[1] = lastIn;
-                    lastIn += w;
-                    ptr[2] = lastIn;
-                    lastIn += w;
-                    ptr[3] = lastIn;
-                    lastIn += w;
-
-                    if (nDec + nBytes > outSize) return EXR_ERR_CORRUPT_CHUNK;
-
-                    for (int x = 0; x < w; ++x)
-                    {
-                        uint32_t diff =
-                            (((uint32_t) (*(ptr[0]++)) << 24) |
-                             ((uint32_t) (*(ptr[1]++)) << 16) |
-                             ((uint32_t) (*(ptr[2]++)) << 8) |
-                             ((uint32_t) (*(ptr[3]++))));
-                        pixel += diff;
-                        unaligned_store32 (dout, pixel);
-                        ++dout;
-                    }
-                    nDec += nBytes;
-                    break;
-                }
-                case EXR_PIXEL_HALF: {
-                    const uint8_t* ptr[2];
-                    uint32_t       pixel = 0;
-                    uint16_t*      dout  = (uint16_t*) (out);
-
-                    ptr[0] = lastIn;
-                    lastIn += w;
-                    ptr[1] = lastIn;
-                    lastIn += w;
-
-                    if (nDec + nBytes > outSize) return EXR_ERR_CORRUPT_CHUNK;
-
-                    for (int x = 0; x < w; ++x)
-                    {
-                        uint32_t diff =
-                            (((uint32_t) (*(ptr[0]++)) << 8) |
-                             ((uint32_t) (*(ptr[1]++))));
-                        pixel += diff;
-                        unaligned_store16 (dout, (uint16_t) pixel);
-                        ++dout;
-                    }
-                    nDec += nBytes;
-                    break;
-                }
-                case EXR_PIXEL_FLOAT: {
-                    const uint8_t* ptr[3];
-                    uint32_t       pixel = 0;
-                    uint32_t*      dout  = (uint32_t*) (out);
+                case EXR_PIXEL_UINT:
+                case EXR_PIXEL_HALF: nPlanes = nBytes; break;
+                case EXR_PIXEL_FLOAT: nPlanes = (uint64_t) w * 3; break;
+                default: return EXR_ERR_INVALID_ARGUMENT;
+            }
 
-                    ptr[0] = lastIn;
-                    lastIn += w;
-                    ptr[1] = lastIn;
-                    lastIn += w;
-                    ptr[2] = lastIn;
-                    lastIn += w;
+            if (nDec + nPlanes > outSize) return EXR_ERR_CORRUPT_CHUNK;
 
-                    if (nDec + (uint64_t) (w * 3) > outSize)
-                        return EXR_ERR_CORRUPT_CHUNK;
+            internal_pxr24_merge_row (curc->data_type, lastIn, w, out);
 
-                    for (int x = 0; x < w; ++x)
-                    {
-                        uint32_t diff =
-                            (((uint32_t) (*(ptr[0]++)) << 24) |
-                             ((uint32_t) (*(ptr[1]++)) << 16) |
-                             ((uint32_t) (*(ptr[2]++)) << 8));
-                        pixel += diff;
-                        unaligned_store32 (dout, pixel);
-                        ++dout;
-                    }
-                    nDec += (uint64_t) (w * 3);
-                    break;
-                }
-                default: return EXR_ERR_INVALID_ARGUMENT;
-            }
+            lastIn += nPlanes;
+            nDec += nPlanes;
             out += nBytes;
             nOut += nBytes;
         }
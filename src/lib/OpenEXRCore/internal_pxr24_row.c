@@ -0,0 +1,469 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#include "internal_pxr24_row.h"
+
+#include "internal_xdr.h"
+
+#include <string.h>
+
+#if defined __SSE2__ || (_MSC_VER >= 1300 && (_M_IX86 || _M_X64))
+#    define IMF_HAVE_SSE2 1
+#    include <emmintrin.h>
+#endif
+
+/**************************************/
+
+static inline uint32_t
+float_to_float24 (float f)
+{
+    union
+    {
+        float    f;
+        uint32_t i;
+    } u;
+
+    u.f = f;
+
+    //
+    // Disassemble the 32-bit floating point number, f,
+    // into sign, s, exponent, e, and significand, m.
+    //
+
+    uint32_t s = u.i & 0x80000000;
+    uint32_t e = u.i & 0x7f800000;
+    uint32_t m = u.i & 0x007fffff;
+    uint32_t i;
+
+    if (e == 0x7f800000)
+    {
+        if (m)
+        {
+            //
+            // F is a NAN; we preserve the sign bit and
+            // the 15 leftmost bits of the significand,
+            // with one exception: If the 15 leftmost
+            // bits are all zero, the NAN would turn
+            // into an infinity, so we have to set at
+            // least one bit in the significand.
+            //
+
+            m >>= 8;
+            i = (e >> 8) | m | (m == 0);
+        }
+        else
+        {
+            //
+            // F is an infinity.
+            //
+
+            i = e >> 8;
+        }
+    }
+    else
+    {
+        //
+        // F is finite, round the significand to 15 bits.
+        //
+
+        i = ((e | m) + (m & 0x00000080)) >> 8;
+
+        if (i >= 0x7f8000)
+        {
+            //
+            // F was close to FLT_MAX, and the significand was
+            // rounded up, resulting in an exponent overflow.
+            // Avoid the overflow by truncating the significand
+            // instead of rounding it.
+            //
+
+            i = (e | m) >> 8;
+        }
+    }
+
+    return (s >> 8) | i;
+}
+
+/**************************************/
+
+/* scalar coding of the values [x, w) of a row, picking up the
+ * prediction from the value at x - 1 */
+static void
+split_row_from (
+    exr_pixel_type_t type, const uint8_t* in, int x, int w, uint8_t* out)
+{
+    uint32_t prevPixel = 0;
+    size_t   sw        = (size_t) w;
+
+    switch (type)
+    {
+        case EXR_PIXEL_UINT:
+            if (x > 0) prevPixel = unaligned_load32 (in + (x - 1) * 4);
+            for (; x < w; ++x)
+            {
+                uint32_t pixel = unaligned_load32 (in + x * 4);
+                uint32_t diff  = pixel - prevPixel;
+                prevPixel      = pixel;
+
+                out[x]          = (uint8_t) (diff >> 24);
+                out[sw + x]     = (uint8_t) (diff >> 16);
+                out[2 * sw + x] = (uint8_t) (diff >> 8);
+                out[3 * sw + x] = (uint8_t) (diff);
+            }
+            break;
+        case EXR_PIXEL_HALF:
+            if (x > 0)
+                prevPixel = (uint32_t) unaligned_load16 (in + (x - 1) * 2);
+            for (; x < w; ++x)
+            {
+                uint32_t pixel = (uint32_t) unaligned_load16 (in + x * 2);
+                uint32_t diff  = pixel - prevPixel;
+                prevPixel      = pixel;
+
+                out[x]      = (uint8_t) (diff >> 8);
+                out[sw + x] = (uint8_t) (diff);
+            }
+            break;
+        case EXR_PIXEL_FLOAT:
+            for (int p = (x > 0 ? x - 1 : x); p < w; ++p)
+            {
+                union
+                {
+                    uint32_t i;
+                    float    f;
+                } v;
+                uint32_t pixel24, diff;
+                v.i       = unaligned_load32 (in + p * 4);
+                pixel24   = float_to_float24 (v.f);
+                diff      = pixel24 - prevPixel;
+                prevPixel = pixel24;
+
+                if (p < x) continue;
+                out[p]          = (uint8_t) (diff >> 16);
+                out[sw + p]     = (uint8_t) (diff >> 8);
+                out[2 * sw + p] = (uint8_t) (diff);
+            }
+            break;
+        default: break;
+    }
+}
+
+/* scalar decoding of the values [x, w) of a row, continuing the sum
+ * from the value already written at x - 1 */
+static void
+merge_row_from (
+    exr_pixel_type_t type, const uint8_t* in, int x, int w, uint8_t* out)
+{
+    uint32_t pixel = 0;
+    size_t   sw    = (size_t) w;
+
+    switch (type)
+    {
+        case EXR_PIXEL_UINT:
+        case EXR_PIXEL_FLOAT:
+            if (x > 0) pixel = unaligned_load32 (out + (x - 1) * 4);
+            for (; x < w; ++x)
+            {
+                uint32_t diff = (((uint32_t) in[x] << 24) |
+                                 ((uint32_t) in[sw + x] << 16) |
+                                 ((uint32_t) in[2 * sw + x] << 8));
+                if (type == EXR_PIXEL_UINT) diff |= (uint32_t) in[3 * sw + x];
+                pixel += diff;
+                unaligned_store32 (out + x * 4, pixel);
+            }
+            break;
+        case EXR_PIXEL_HALF:
+            if (x > 0) pixel = (uint32_t) unaligned_load16 (out + (x - 1) * 2);
+            for (; x < w; ++x)
+            {
+                uint32_t diff =
+                    (((uint32_t) in[x] << 8) | ((uint32_t) in[sw + x]));
+                pixel += diff;
+                unaligned_store16 (out + x * 2, (uint16_t) pixel);
+            }
+            break;
+        default: break;
+    }
+}
+
+#ifdef IMF_HAVE_SSE2
+
+/* float_to_float24 for 4 values */
+static inline __m128i
+float_to_float24_sse2 (__m128i v)
+{
+    const __m128i emask = _mm_set1_epi32 (0x7f800000);
+    const __m128i mmask = _mm_set1_epi32 (0x007fffff);
+
+    __m128i a = _mm_and_si128 (v, _mm_set1_epi32 (0x7fffffff));
+    __m128i s = _mm_srli_epi32 (_mm_andnot_si128 (a, v), 8);
+    __m128i i, isspecial;
+
+    // finite: round to 15 bits. Rounding up only overflows the
+    // exponent from 0x7f7fff80 on, where truncating gives one less
+    i = _mm_srli_epi32 (
+        _mm_add_epi32 (a, _mm_and_si128 (v, _mm_set1_epi32 (0x80))), 8);
+    i = _mm_add_epi32 (i, _mm_cmpgt_epi32 (i, _mm_set1_epi32 (0x7f7fff)));
+
+    isspecial = _mm_cmpeq_epi32 (_mm_and_si128 (v, emask), emask);
+    if (_mm_movemask_epi8 (isspecial))
+    {
+        // NAN or infinity: keep the top significand bits, making
+        // sure a NAN keeps at least one of them
+        const __m128i zero = _mm_setzero_si128 ();
+        __m128i       m    = _mm_and_si128 (v, mmask);
+        __m128i       m8   = _mm_srli_epi32 (m, 8);
+        __m128i       nan0 = _mm_andnot_si128 (
+            _mm_cmpeq_epi32 (m, zero), _mm_cmpeq_epi32 (m8, zero));
+        __m128i special = _mm_or_si128 (
+            _mm_or_si128 (_mm_srli_epi32 (emask, 8), m8),
+            _mm_and_si128 (nan0, _mm_set1_epi32 (1)));
+
+        i = _mm_or_si128 (
+            _mm_and_si128 (isspecial, special),
+            _mm_andnot_si128 (isspecial, i));
+    }
+    return _mm_or_si128 (s, i);
+}
+
+/* writes the bytes of 16 32 bit values d0 ... d3 as byte planes, most
+ * significant first, skipping the top byte if nplanes is 3 */
+static inline void
+store_planes32_sse2 (
+    __m128i  d0,
+    __m128i  d1,
+    __m128i  d2,
+    __m128i  d3,
+    int      nplanes,
+    uint8_t* out,
+    size_t   stride)
+{
+    const __m128i lo = _mm_set1_epi16 (0xff);
+
+    // split in the 16 bit halves first, sign extending so the
+    // saturating pack is exact
+    __m128i h01 =
+        _mm_packs_epi32 (_mm_srai_epi32 (d0, 16), _mm_srai_epi32 (d1, 16));
+    __m128i h23 =
+        _mm_packs_epi32 (_mm_srai_epi32 (d2, 16), _mm_srai_epi32 (d3, 16));
+    __m128i l01 = _mm_packs_epi32 (
+        _mm_srai_epi32 (_mm_slli_epi32 (d0, 16), 16),
+        _mm_srai_epi32 (_mm_slli_epi32 (d1, 16), 16));
+    __m128i l23 = _mm_packs_epi32 (
+        _mm_srai_epi32 (_mm_slli_epi32 (d2, 16), 16),
+        _mm_srai_epi32 (_mm_slli_epi32 (d3, 16), 16));
+
+    if (nplanes == 4)
+    {
+        _mm_storeu_si128 (
+            (__m128i*) out,
+            _mm_packus_epi16 (
+                _mm_srli_epi16 (h01, 8), _mm_srli_epi16 (h23, 8)));
+        out += stride;
+    }
+    _mm_storeu_si128 (
+        (__m128i*) out,
+        _mm_packus_epi16 (_mm_and_si128 (h01, lo), _mm_and_si128 (h23, lo)));
+    out += stride;
+    _mm_storeu_si128 (
+        (__m128i*) out,
+        _mm_packus_epi16 (_mm_srli_epi16 (l01, 8), _mm_srli_epi16 (l23, 8)));
+    out += stride;
+    _mm_storeu_si128 (
+        (__m128i*) out,
+        _mm_packus_epi16 (_mm_and_si128 (l01, lo), _mm_and_si128 (l23, lo)));
+}
+
+/* 16 values per iteration, returns the number of values coded */
+static int
+split_row_sse2 (exr_pixel_type_t type, const uint8_t* in, int w, uint8_t* out)
+{
+    size_t  sw   = (size_t) w;
+    int     nvec = w & ~15;
+    __m128i prev = _mm_setzero_si128 ();
+
+    if (type == EXR_PIXEL_HALF)
+    {
+        const __m128i lo = _mm_set1_epi16 (0xff);
+
+        for (int x = 0; x < nvec; x += 16)
+        {
+            __m128i v0 = _mm_loadu_si128 ((const __m128i*) (in + x * 2));
+            __m128i v1 = _mm_loadu_si128 ((const __m128i*) (in + x * 2 + 16));
+            __m128i d0 = _mm_sub_epi16 (
+                v0, _mm_or_si128 (
+                        _mm_slli_si128 (v0, 2), _mm_srli_si128 (prev, 14)));
+            __m128i d1 = _mm_sub_epi16 (
+                v1, _mm_or_si128 (
+                        _mm_slli_si128 (v1, 2), _mm_srli_si128 (v0, 14)));
+            prev = v1;
+
+            _mm_storeu_si128 (
+                (__m128i*) (out + x),
+                _mm_packus_epi16 (
+                    _mm_srli_epi16 (d0, 8), _mm_srli_epi16 (d1, 8)));
+            _mm_storeu_si128 (
+                (__m128i*) (out + sw + x),
+                _mm_packus_epi16 (
+                    _mm_and_si128 (d0, lo), _mm_and_si128 (d1, lo)));
+        }
+        return nvec;
+    }
+
+    for (int x = 0; x < nvec; x += 16)
+    {
+        const uint8_t* p  = in + x * 4;
+        __m128i        v0 = _mm_loadu_si128 ((const __m128i*) (p));
+        __m128i        v1 = _mm_loadu_si128 ((const __m128i*) (p + 16));
+        __m128i        v2 = _mm_loadu_si128 ((const __m128i*) (p + 32));
+        __m128i        v3 = _mm_loadu_si128 ((const __m128i*) (p + 48));
+        __m128i        d0, d1, d2, d3;
+
+        if (type == EXR_PIXEL_FLOAT)
+        {
+            v0 = float_to_float24_sse2 (v0);
+            v1 = float_to_float24_sse2 (v1);
+            v2 = float_to_float24_sse2 (v2);
+            v3 = float_to_float24_sse2 (v3);
+        }
+
+        d0 = _mm_or_si128 (_mm_slli_si128 (v0, 4), _mm_srli_si128 (prev, 12));
+        d1 = _mm_or_si128 (_mm_slli_si128 (v1, 4), _mm_srli_si128 (v0, 12));
+        d2 = _mm_or_si128 (_mm_slli_si128 (v2, 4), _mm_srli_si128 (v1, 12));
+        d3 = _mm_or_si128 (_mm_slli_si128 (v3, 4), _mm_srli_si128 (v2, 12));
+        prev = v3;
+
+        store_planes32_sse2 (
+            _mm_sub_epi32 (v0, d0),
+            _mm_sub_epi32 (v1, d1),
+            _mm_sub_epi32 (v2, d2),
+            _mm_sub_epi32 (v3, d3),
+            type == EXR_PIXEL_UINT ? 4 : 3,
+            out + x,
+            sw);
+    }
+    return nvec;
+}
+
+/* inclusive prefix sum of the 32 bit lanes, plus the last lane of prev */
+static inline __m128i
+prefix_sum32_sse2 (__m128i v, __m128i prev)
+{
+    v = _mm_add_epi32 (v, _mm_slli_si128 (v, 4));
+    v = _mm_add_epi32 (v, _mm_slli_si128 (v, 8));
+    return _mm_add_epi32 (v, _mm_shuffle_epi32 (prev, 0xff));
+}
+
+static inline __m128i
+prefix_sum16_sse2 (__m128i v, __m128i prev)
+{
+    v = _mm_add_epi16 (v, _mm_slli_si128 (v, 2));
+    v = _mm_add_epi16 (v, _mm_slli_si128 (v, 4));
+    v = _mm_add_epi16 (v, _mm_slli_si128 (v, 8));
+    prev = _mm_shufflehi_epi16 (prev, 0xff);
+    return _mm_add_epi16 (v, _mm_unpackhi_epi64 (prev, prev));
+}
+
+/* 16 values per iteration, returns the number of values decoded */
+static int
+merge_row_sse2 (exr_pixel_type_t type, const uint8_t* in, int w, uint8_t* out)
+{
+    size_t  sw   = (size_t) w;
+    int     nvec = w & ~15;
+    __m128i prev = _mm_setzero_si128 ();
+
+    if (type == EXR_PIXEL_HALF)
+    {
+        for (int x = 0; x < nvec; x += 16)
+        {
+            __m128i b0 = _mm_loadu_si128 ((const __m128i*) (in + x));
+            __m128i b1 = _mm_loadu_si128 ((const __m128i*) (in + sw + x));
+            __m128i v0 = prefix_sum16_sse2 (_mm_unpacklo_epi8 (b1, b0), prev);
+            __m128i v1 = prefix_sum16_sse2 (_mm_unpackhi_epi8 (b1, b0), v0);
+            prev       = v1;
+
+            _mm_storeu_si128 ((__m128i*) (out + x * 2), v0);
+            _mm_storeu_si128 ((__m128i*) (out + x * 2 + 16), v1);
+        }
+        return nvec;
+    }
+
+    for (int x = 0; x < nvec; x += 16)
+    {
+        __m128i b0 = _mm_loadu_si128 ((const __m128i*) (in + x));
+        __m128i b1 = _mm_loadu_si128 ((const __m128i*) (in + sw + x));
+        __m128i b2 = _mm_loadu_si128 ((const __m128i*) (in + 2 * sw + x));
+        __m128i b3 = _mm_setzero_si128 ();
+        __m128i lo, hi, v[4];
+
+        if (type == EXR_PIXEL_UINT)
+            b3 = _mm_loadu_si128 ((const __m128i*) (in + 3 * sw + x));
+
+        // little endian words b3 | b2 << 8 | b1 << 16 | b0 << 24
+        lo   = _mm_unpacklo_epi8 (b3, b2);
+        hi   = _mm_unpacklo_epi8 (b1, b0);
+        v[0] = _mm_unpacklo_epi16 (lo, hi);
+        v[1] = _mm_unpackhi_epi16 (lo, hi);
+        lo   = _mm_unpackhi_epi8 (b3, b2);
+        hi   = _mm_unpackhi_epi8 (b1, b0);
+        v[2] = _mm_unpacklo_epi16 (lo, hi);
+        v[3] = _mm_unpackhi_epi16 (lo, hi);
+
+        for (int k = 0; k < 4; ++k)
+        {
+            prev = prefix_sum32_sse2 (v[k], prev);
+            _mm_storeu_si128 ((__m128i*) (out + x * 4 + k * 16), prev);
+        }
+    }
+    return nvec;
+}
+
+#endif /* IMF_HAVE_SSE2 */
+
+void
+internal_pxr24_split_row (
+    exr_pixel_type_t type, const uint8_t* in, int w, uint8_t* out)
+{
+    int x = 0;
+#ifdef IMF_HAVE_SSE2
+    x = split_row_sse2 (type, in, w, out);
+#endif
+    split_row_from (type, in, x, w, out);
+}
+
+void
+internal_pxr24_merge_row (
+    exr_pixel_type_t type, const uint8_t* in, int w, uint8_t* out)
+{
+    int x = 0;
+#ifdef IMF_HAVE_SSE2
+    x = merge_row_sse2 (type, in, w, out);
+#endif
+    merge_row_from (type, in, x, w, out);
+}
+
+void
+internal_pxr24_split_row_scalar (
+    exr_pixel_type_t type, const uint8_t* in, int w, uint8_t* out)
+{
+    split_row_from (type, in, 0, w, out);
+}
+
+void
+internal_pxr24_merge_row_scalar (
+    exr_pixel_type_t type, const uint8_t* in, int w, uint8_t* out)
+{
+    merge_row_from (type, in, 0, w, out);
+}
+
+int
+internal_pxr24_has_simd (void)
+{
+#ifdef IMF_HAVE_SSE2
+    return 1;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,33 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#ifndef OPENEXR_CORE_PXR24_ROW_H
+#define OPENEXR_CORE_PXR24_ROW_H
+
+#include "openexr_attr.h"
+
+#include <stdint.h>
+
+/* PXR24 coding of one scanline of w values of a channel. The split
+ * rounds floats to 24 bits, takes the difference of each value to
+ * the previous one, and writes the differences as byte planes, most
+ * significant first, each w bytes long (4, 2 or 3 planes for uint,
+ * half and float). The merge undoes that, writing little endian
+ * values. These use vector instructions where available, and are bit
+ * exact with the _scalar variants, which are provided for testing */
+void internal_pxr24_split_row (
+    exr_pixel_type_t type, const uint8_t* in, int w, uint8_t* out);
+void internal_pxr24_merge_row (
+    exr_pixel_type_t type, const uint8_t* in, int w, uint8_t* out);
+
+void internal_pxr24_split_row_scalar (
+    exr_pixel_type_t type, const uint8_t* in, int w, uint8_t* out);
+void internal_pxr24_merge_row_scalar (
+    exr_pixel_type_t type, const uint8_t* in, int w, uint8_t* out);
+
+/* non-zero if internal_pxr24_split_row / merge_row use vector code */
+int internal_pxr24_has_simd (void);
+
+#endif /* OPENEXR_CORE_PXR24_ROW_H */
@@ -0,0 +1,87 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#ifndef OPENEXR_PRIVATE_STATS_H
+#define OPENEXR_PRIVATE_STATS_H
+
+#include "internal_structs.h"
+#include "openexr_chunkio.h"
+
+#include "OpenEXRConfigInternal.h"
+
+#if defined(_MSC_VER)
+#    include <windows.h>
+#endif
+
+/* monotonic clock in nanoseconds, in stats.c */
+uint64_t internal_exr_stats_now (void);
+
+static inline void
+internal_exr_stats_add (uint64_t* counter, uint64_t v)
+{
+#if defined(_MSC_VER)
+    InterlockedExchangeAdd64 ((volatile LONG64*) counter, (LONG64) v);
+#else
+    __atomic_fetch_add (counter, v, __ATOMIC_RELAXED);
+#endif
+}
+
+/* the counters are bookkeeping, so are updated through const parts */
+#define EXR_STATS_ADD(pctxt, part, field, v)                                   \
+    ((pctxt)->collect_stats                                                    \
+         ? internal_exr_stats_add (                                            \
+               &(EXR_CONST_CAST (struct _internal_exr_part*, part)             \
+                     ->stats.field),                                           \
+               (uint64_t) (v))                                                 \
+         : (void) 0)
+
+#define EXR_STATS_NOW(pctxt)                                                   \
+    ((pctxt)->collect_stats ? internal_exr_stats_now () : 0)
+
+#define EXR_STATS_ELAPSED(pctxt, part, field, t0)                              \
+    EXR_STATS_ADD (pctxt, part, field, internal_exr_stats_now () - (t0))
+
+/* in trace.c */
+void internal_exr_trace (
+    const struct _internal_exr_context* pctxt,
+    int                                 part_index,
+    exr_trace_stage_t                   stage,
+    const exr_chunk_info_t*             cinfo,
+    int                                 begin,
+    exr_result_t                        result);
+
+/* static (USDT) probes, only compiled in when configured with
+ * OPENEXR_ENABLE_SDT, the stage probes pass the exr_trace_stage_t
+ * value as the first argument */
+#ifdef OPENEXR_HAVE_SYS_SDT_H
+#    include <sys/sdt.h>
+#    define EXR_PROBE(name, ...) STAP_PROBEV (openexr, name, __VA_ARGS__)
+#else
+#    define EXR_PROBE(name, ...) ((void) 0)
+#endif
+
+#define EXR_TRACE_BEGIN(pctxt, pi, stage, cinfo)                               \
+    do                                                                         \
+    {                                                                          \
+        EXR_PROBE (                                                            \
+            stage__begin,                                                      \
+            (int) (stage),                                                     \
+            (int) (pi),                                                        \
+            (cinfo)->idx,                                                      \
+            (int) (cinfo)->compression);                                       \
+        if ((pctxt)->trace_fn)                                                 \
+            internal_exr_trace (pctxt, pi, stage, cinfo, 1, EXR_ERR_SUCCESS);  \
+    } while (0)
+
+#define EXR_TRACE_END(pctxt, pi, stage, cinfo, rv)                             \
+    do                                                                         \
+    {                                                                          \
+        EXR_PROBE (                                                            \
+            stage__end, (int) (stage), (int) (pi), (cinfo)->idx, (int) (rv));  \
+        if ((pctxt)->trace_fn)                                                 \
+            internal_exr_trace (pctxt, pi, stage, cinfo, 0, rv);               \
+    } while (0)
+
+#endif /* OPENEXR_PRIVATE_STATS_H */
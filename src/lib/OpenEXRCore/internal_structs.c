@@ -249,8 +249,9 @@ internal_exr_add_part (
     part->display_window.max.y = -1;
     part->chunk_count          = -1;
 
-    part->zip_compression_level = f->default_zip_level;
-    part->dwa_compression_level = f->default_dwa_quality;
+    part->zip_compression_level  = f->default_zip_level;
+    part->dwa_compression_level  = f->default_dwa_quality;
+    part->zstd_compression_level = f->default_zstd_level;
 
     /* put it into the part table */
     if (ncount > 1)
@@ -404,6 +405,7 @@ internal_exr_alloc_context (
 
         exr_get_default_zip_compression_level (&ret->default_zip_level);
         exr_get_default_dwa_compression_quality (&ret->default_dwa_quality);
+        exr_get_default_zstd_compression_level (&ret->default_zstd_level);
         if (initializers->zip_level >= 0)
             ret->default_zip_level = initializers->zip_level;
         if (initializers->dwa_quality >= 0.f)
@@ -416,6 +418,8 @@ internal_exr_alloc_context (
         ret->disable_chunk_reconstruct =
             (initializers->flags &
              EXR_CONTEXT_FLAG_DISABLE_CHUNK_RECONSTRUCTION);
+        ret->collect_stats =
+            (initializers->flags & EXR_CONTEXT_FLAG_COLLECT_STATS) ? 1 : 0;
 
         ret->file_size       = -1;
         ret->max_name_length = EXR_SHORTNAME_MAXLEN;
@@ -7,6 +7,7 @@
 #define OPENEXR_PRIVATE_STRUCTS_H
 
 #include "internal_attr.h"
+#include "openexr_stats.h"
 
 #include <IlmThreadConfig.h>
 
@@ -96,6 +97,7 @@ struct _internal_exr_part
 
     int32_t zip_compression_level;
     float   dwa_compression_level;
+    int32_t zstd_compression_level;
 
     int32_t  num_tile_levels_x;
     int32_t  num_tile_levels_y;
@@ -111,6 +113,9 @@ struct _internal_exr_part
     int32_t          chunk_count;
     uint64_t         chunk_table_offset;
     atomic_uintptr_t chunk_table;
+
+    /* only updated when the context collects stats */
+    exr_pipeline_stats_t stats;
 };
 
 enum _INTERNAL_EXR_READ_MODE
@@ -128,6 +133,12 @@ enum _INTERNAL_EXR_CONTEXT_MODE
     EXR_CONTEXT_WRITE_FINISHED
 };
 
+/* metadata edits which may change the size of the header are allowed
+ * while writing, or during an in-place update, where the result is
+ * checked against the available space by exr_write_header */
+#define EXR_CAN_RESIZE_HEADER(c)                                               \
+    ((c)->mode == EXR_CONTEXT_WRITE || (c)->mode == EXR_CONTEXT_UPDATE_HEADER)
+
 struct _internal_exr_context
 {
     uint8_t mode;
@@ -178,6 +189,7 @@ struct _internal_exr_context
 
     int   default_zip_level;
     float default_dwa_quality;
+    int   default_zstd_level;
 
     void*                         real_user_data;
     void*                         user_data;
@@ -192,6 +204,8 @@ struct _internal_exr_context
     int      cur_output_part;
     int      last_output_chunk;
     int      output_chunk_count;
+    /* bytes reserved after the chunk tables for later header growth */
+    uint32_t header_padding;
 
     /** all files have at least one part */
     int num_parts;
@@ -213,6 +227,10 @@ struct _internal_exr_context
 #    endif
 #endif
     uint8_t disable_chunk_reconstruct;
+    uint8_t collect_stats;
+
+    exr_trace_callback_t trace_fn;
+    void*                trace_userdata;
 };
 
 #define EXR_CTXT(c) ((struct _internal_exr_context*) (c))
@@ -0,0 +1,679 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#include "internal_wav.h"
+
+#if defined __SSE2__ || (_MSC_VER >= 1300 && (_M_IX86 || _M_X64))
+#    define IMF_HAVE_SSE2 1
+#    include <emmintrin.h>
+#endif
+
+//
+// Wavelet basis functions without modulo arithmetic; they produce
+// the best compression ratios when the wavelet-transformed data are
+// Huffman-encoded, but the wavelet transform works only for 14-bit
+// data (untransformed data values must be less than (1 << 14)).
+//
+
+static inline void
+wenc14 (uint16_t a, uint16_t b, uint16_t* l, uint16_t* h)
+{
+    int16_t as = (int16_t) a;
+    int16_t bs = (int16_t) b;
+
+    int16_t ms = (as + bs) >> 1;
+    int16_t ds = as - bs;
+
+    *l = (uint16_t) ms;
+    *h = (uint16_t) ds;
+}
+
+static inline void
+wdec14 (uint16_t l, uint16_t h, uint16_t* a, uint16_t* b)
+{
+    int16_t ls = (int16_t) l;
+    int16_t hs = (int16_t) h;
+
+    int hi = hs;
+    int ai = ls + (hi & 1) + (hi >> 1);
+
+    int16_t as = (int16_t) ai;
+    int16_t bs = (int16_t) (ai - hi);
+
+    *a = (uint16_t) as;
+    *b = (uint16_t) bs;
+}
+
+//
+// Wavelet basis functions with modulo arithmetic; they work with full
+// 16-bit data, but Huffman-encoding the wavelet-transformed data doesn't
+// compress the data quite as well.
+//
+
+#define NBITS ((int) 16)
+#define A_OFFSET ((int) 1 << (NBITS - 1))
+#define M_OFFSET ((int) 1 << (NBITS - 1))
+#define MOD_MASK ((int) (1 << NBITS) - 1)
+
+static inline void
+wenc16 (uint16_t a, uint16_t b, uint16_t* l, uint16_t* h)
+{
+    int ao = (((int) a) + A_OFFSET) & MOD_MASK;
+    int m  = ((ao + ((int) b)) >> 1);
+    int d  = ao - ((int) b);
+
+    if (d < 0) m = (m + M_OFFSET) & MOD_MASK;
+
+    d &= MOD_MASK;
+
+    *l = (uint16_t) m;
+    *h = (uint16_t) d;
+}
+
+static inline void
+wdec16 (uint16_t l, uint16_t h, uint16_t* a, uint16_t* b)
+{
+    int m  = (int) l;
+    int d  = (int) h;
+    int bb = (m - (d >> 1)) & MOD_MASK;
+    int aa = (d + bb - A_OFFSET) & MOD_MASK;
+    *b     = (uint16_t) bb;
+    *a     = (uint16_t) aa;
+}
+
+/**************************************/
+//
+// Vectorized rows of the finest levels of the transform, where the
+// 2x2 blocks are close in memory (x offset of 2 or 4 between blocks,
+// i.e. the first two levels of 16-bit channels, or the first of
+// 32-bit ones). Each iteration handles 8 blocks of a row pair,
+// splitting the interleaved pairs into separate registers, and
+// applies the same basis functions as above in 16-bit lanes. All the
+// scalar integer math reduces modulo 2^16, so the results are bit
+// exact.
+//
+
+#ifdef IMF_HAVE_SSE2
+
+static inline void
+wav_load_sse2 (const uint16_t* p, __m128i* even, __m128i* odd)
+{
+    __m128i v0 = _mm_loadu_si128 ((const __m128i*) p);
+    __m128i v1 = _mm_loadu_si128 ((const __m128i*) (p + 8));
+
+    *even = _mm_packs_epi32 (
+        _mm_srai_epi32 (_mm_slli_epi32 (v0, 16), 16),
+        _mm_srai_epi32 (_mm_slli_epi32 (v1, 16), 16));
+    *odd = _mm_packs_epi32 (_mm_srai_epi32 (v0, 16), _mm_srai_epi32 (v1, 16));
+}
+
+static inline void
+wav_store_sse2 (uint16_t* p, __m128i even, __m128i odd)
+{
+    _mm_storeu_si128 ((__m128i*) p, _mm_unpacklo_epi16 (even, odd));
+    _mm_storeu_si128 ((__m128i*) (p + 8), _mm_unpackhi_epi16 (even, odd));
+}
+
+static inline void
+wenc14_sse2 (__m128i a, __m128i b, __m128i* l, __m128i* h)
+{
+    // (a + b) >> 1 without the 17th bit
+    __m128i one = _mm_set1_epi16 (1);
+
+    *l = _mm_add_epi16 (
+        _mm_add_epi16 (_mm_srai_epi16 (a, 1), _mm_srai_epi16 (b, 1)),
+        _mm_and_si128 (_mm_and_si128 (a, b), one));
+    *h = _mm_sub_epi16 (a, b);
+}
+
+static inline void
+wdec14_sse2 (__m128i l, __m128i h, __m128i* a, __m128i* b)
+{
+    __m128i one = _mm_set1_epi16 (1);
+    __m128i ai  = _mm_add_epi16 (
+        _mm_add_epi16 (l, _mm_and_si128 (h, one)), _mm_srai_epi16 (h, 1));
+
+    *a = ai;
+    *b = _mm_sub_epi16 (ai, h);
+}
+
+static inline void
+wenc16_sse2 (__m128i a, __m128i b, __m128i* l, __m128i* h)
+{
+    __m128i off = _mm_set1_epi16 ((short) A_OFFSET);
+    __m128i one = _mm_set1_epi16 (1);
+    __m128i ao  = _mm_xor_si128 (a, off);
+
+    // unsigned (ao + b) >> 1, avg rounds up so take off the carry
+    __m128i m = _mm_sub_epi16 (
+        _mm_avg_epu16 (ao, b), _mm_and_si128 (_mm_xor_si128 (ao, b), one));
+
+    // ao < b unsigned, i.e. d < 0
+    __m128i neg = _mm_cmplt_epi16 (a, _mm_xor_si128 (b, off));
+
+    *l = _mm_xor_si128 (m, _mm_and_si128 (neg, off));
+    *h = _mm_sub_epi16 (ao, b);
+}
+
+static inline void
+wdec16_sse2 (__m128i l, __m128i h, __m128i* a, __m128i* b)
+{
+    __m128i off = _mm_set1_epi16 ((short) A_OFFSET);
+    __m128i bb  = _mm_sub_epi16 (l, _mm_srli_epi16 (h, 1));
+
+    *b = bb;
+    *a = _mm_sub_epi16 (_mm_add_epi16 (h, bb), off);
+}
+
+static inline void
+wav_load2_sse2 (const uint16_t* p, __m128i* even, __m128i* odd)
+{
+    // every other value belongs to another level or interleaved
+    // component, drop those and handle as above
+    __m128i v0 = _mm_loadu_si128 ((const __m128i*) p);
+    __m128i v1 = _mm_loadu_si128 ((const __m128i*) (p + 8));
+    __m128i v2 = _mm_loadu_si128 ((const __m128i*) (p + 16));
+    __m128i v3 = _mm_loadu_si128 ((const __m128i*) (p + 24));
+    __m128i w0 = _mm_packs_epi32 (
+        _mm_srai_epi32 (_mm_slli_epi32 (v0, 16), 16),
+        _mm_srai_epi32 (_mm_slli_epi32 (v1, 16), 16));
+    __m128i w1 = _mm_packs_epi32 (
+        _mm_srai_epi32 (_mm_slli_epi32 (v2, 16), 16),
+        _mm_srai_epi32 (_mm_slli_epi32 (v3, 16), 16));
+
+    *even = _mm_packs_epi32 (
+        _mm_srai_epi32 (_mm_slli_epi32 (w0, 16), 16),
+        _mm_srai_epi32 (_mm_slli_epi32 (w1, 16), 16));
+    *odd = _mm_packs_epi32 (_mm_srai_epi32 (w0, 16), _mm_srai_epi32 (w1, 16));
+}
+
+static inline void
+wav_store2_sse2 (uint16_t* p, __m128i even, __m128i odd)
+{
+    __m128i zero = _mm_setzero_si128 ();
+    __m128i keep = _mm_set1_epi32 ((int) 0xffff0000);
+    __m128i w0   = _mm_unpacklo_epi16 (even, odd);
+    __m128i w1   = _mm_unpackhi_epi16 (even, odd);
+    __m128i v[4];
+
+    v[0] = _mm_unpacklo_epi16 (w0, zero);
+    v[1] = _mm_unpackhi_epi16 (w0, zero);
+    v[2] = _mm_unpacklo_epi16 (w1, zero);
+    v[3] = _mm_unpackhi_epi16 (w1, zero);
+    for (int i = 0; i < 4; ++i)
+    {
+        __m128i* dst = (__m128i*) (p + 8 * i);
+        _mm_storeu_si128 (
+            dst,
+            _mm_or_si128 (
+                v[i], _mm_and_si128 (_mm_loadu_si128 (dst), keep)));
+    }
+}
+
+static inline void
+wav_encode8_sse2 (__m128i* a, __m128i* b, __m128i* c, __m128i* d, int w14)
+{
+    __m128i i00, i01, i10, i11;
+
+    if (w14)
+    {
+        wenc14_sse2 (*a, *b, &i00, &i01);
+        wenc14_sse2 (*c, *d, &i10, &i11);
+        wenc14_sse2 (i00, i10, a, c);
+        wenc14_sse2 (i01, i11, b, d);
+    }
+    else
+    {
+        wenc16_sse2 (*a, *b, &i00, &i01);
+        wenc16_sse2 (*c, *d, &i10, &i11);
+        wenc16_sse2 (i00, i10, a, c);
+        wenc16_sse2 (i01, i11, b, d);
+    }
+}
+
+static inline void
+wav_decode8_sse2 (__m128i* a, __m128i* b, __m128i* c, __m128i* d, int w14)
+{
+    __m128i i00, i01, i10, i11;
+
+    if (w14)
+    {
+        wdec14_sse2 (*a, *c, &i00, &i10);
+        wdec14_sse2 (*b, *d, &i01, &i11);
+        wdec14_sse2 (i00, i01, a, b);
+        wdec14_sse2 (i10, i11, c, d);
+    }
+    else
+    {
+        wdec16_sse2 (*a, *c, &i00, &i10);
+        wdec16_sse2 (*b, *d, &i01, &i11);
+        wdec16_sse2 (i00, i01, a, b);
+        wdec16_sse2 (i10, i11, c, d);
+    }
+}
+
+// handles blocks from px while there are 8 left, returns where the
+// scalar code should continue
+static uint16_t*
+wav_2D_row_sse2 (
+    uint16_t* px, const uint16_t* ex, int ox2, int oy1, int w14, int enc)
+{
+    __m128i a, b, c, d;
+
+    if (ox2 == 2)
+    {
+        for (; px + 14 <= ex; px += 16)
+        {
+            wav_load_sse2 (px, &a, &b);
+            wav_load_sse2 (px + oy1, &c, &d);
+            if (enc)
+                wav_encode8_sse2 (&a, &b, &c, &d, w14);
+            else
+                wav_decode8_sse2 (&a, &b, &c, &d, w14);
+            wav_store_sse2 (px, a, b);
+            wav_store_sse2 (px + oy1, c, d);
+        }
+    }
+    else if (ox2 == 4)
+    {
+        for (; px + 28 <= ex; px += 32)
+        {
+            wav_load2_sse2 (px, &a, &b);
+            wav_load2_sse2 (px + oy1, &c, &d);
+            if (enc)
+                wav_encode8_sse2 (&a, &b, &c, &d, w14);
+            else
+                wav_decode8_sse2 (&a, &b, &c, &d, w14);
+            wav_store2_sse2 (px, a, b);
+            wav_store2_sse2 (px + oy1, c, d);
+        }
+    }
+    return px;
+}
+
+#endif /* IMF_HAVE_SSE2 */
+
+/**************************************/
+
+static inline void
+wav_2D_encode (
+    uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx, int use_simd)
+{
+    int w14 = (mx < (1 << 14)) ? 1 : 0;
+    int n   = (nx > ny) ? ny : nx;
+    int p   = 1; // == 1 <<  level
+    int p2  = 2; // == 1 << (level+1)
+
+    (void) use_simd;
+
+    //
+    // Hierarchical loop on smaller dimension n
+    //
+
+    while (p2 <= n)
+    {
+        uint16_t* py  = in;
+        uint16_t* ey  = in + oy * (ny - p2);
+        int       oy1 = oy * p;
+        int       oy2 = oy * p2;
+        int       ox1 = ox * p;
+        int       ox2 = ox * p2;
+        uint16_t  i00, i01, i10, i11;
+
+        //
+        // Y loop
+        //
+
+        for (; py <= ey; py += oy2)
+        {
+            uint16_t* px = py;
+            uint16_t* ex = py + ox * (nx - p2);
+
+            //
+            // X loop
+            //
+
+#ifdef IMF_HAVE_SSE2
+            if (use_simd) px = wav_2D_row_sse2 (px, ex, ox2, oy1, w14, 1);
+#endif
+
+            for (; px <= ex; px += ox2)
+            {
+                uint16_t* p01 = px + ox1;
+                uint16_t* p10 = px + oy1;
+                uint16_t* p11 = p10 + ox1;
+
+                //
+                // 2D wavelet encoding
+                //
+
+                if (w14)
+                {
+                    wenc14 (*px, *p01, &i00, &i01);
+                    wenc14 (*p10, *p11, &i10, &i11);
+                    wenc14 (i00, i10, px, p10);
+                    wenc14 (i01, i11, p01, p11);
+                }
+                else
+                {
+                    wenc16 (*px, *p01, &i00, &i01);
+                    wenc16 (*p10, *p11, &i10, &i11);
+                    wenc16 (i00, i10, px, p10);
+                    wenc16 (i01, i11, p01, p11);
+                }
+            }
+
+            //
+            // Encode (1D) odd column (still in Y loop)
+            //
+
+            if (nx & p)
+            {
+                uint16_t* p10 = px + oy1;
+
+                if (w14)
+                    wenc14 (*px, *p10, px, p10);
+                else
+                    wenc16 (*px, *p10, px, p10);
+            }
+        }
+
+        //
+        // Encode (1D) odd line (must loop in X)
+        //
+
+        if (ny & p)
+        {
+            uint16_t* px = py;
+            uint16_t* ex = py + ox * (nx - p2);
+
+            for (; px <= ex; px += ox2)
+            {
+                uint16_t* p01 = px + ox1;
+
+                if (w14)
+                    wenc14 (*px, *p01, px, p01);
+                else
+                    wenc16 (*px, *p01, px, p01);
+            }
+        }
+
+        //
+        // Next level
+        //
+
+        p = p2;
+        p2 <<= 1;
+    }
+}
+
+/**************************************/
+
+/* one level of the decode computing only the values whose
+ * coordinates are multiples of step (step > p), which are all the
+ * finer levels of a reduced resolution decode read */
+static void
+wav_2D_decode_level_subsampled (
+    uint16_t* in,
+    int       nx,
+    int       ox,
+    int       ny,
+    int       oy,
+    int       p,
+    int       p2,
+    int       step,
+    int       w14)
+{
+    int      xo  = (nx / p2) * p2; /* first x past the last pair */
+    int      yo  = (ny / p2) * p2; /* first y past the last pair */
+    int      ox1 = ox * p;
+    int      oy1 = oy * p;
+    uint16_t i00, i01, i10, i11;
+
+    for (int y = 0; y < yo; y += step)
+    {
+        uint16_t* py = in + oy * y;
+
+        for (int x = 0; x < xo; x += step)
+        {
+            uint16_t* px  = py + ox * x;
+            uint16_t* p01 = px + ox1;
+            uint16_t* p10 = px + oy1;
+            uint16_t* p11 = p10 + ox1;
+
+            if (w14)
+            {
+                wdec14 (*px, *p10, &i00, &i10);
+                wdec14 (*p01, *p11, &i01, &i11);
+                wdec14 (i00, i01, px, &i01);
+            }
+            else
+            {
+                wdec16 (*px, *p10, &i00, &i10);
+                wdec16 (*p01, *p11, &i01, &i11);
+                wdec16 (i00, i01, px, &i01);
+            }
+        }
+
+        if ((nx & p) && xo % step == 0)
+        {
+            uint16_t* px = py + ox * xo;
+
+            if (w14)
+                wdec14 (*px, *(px + oy1), px, &i10);
+            else
+                wdec16 (*px, *(px + oy1), px, &i10);
+        }
+    }
+
+    if ((ny & p) && yo % step == 0)
+    {
+        uint16_t* py = in + oy * yo;
+
+        for (int x = 0; x < xo; x += step)
+        {
+            uint16_t* px = py + ox * x;
+
+            if (w14)
+                wdec14 (*px, *(px + ox1), px, &i01);
+            else
+                wdec16 (*px, *(px + ox1), px, &i01);
+        }
+    }
+}
+
+static inline void
+wav_2D_decode (
+    uint16_t* in,       // io: values are transformed in place
+    int       nx,       // i : x size
+    int       ox,       // i : x offset
+    int       ny,       // i : y size
+    int       oy,       // i : y offset
+    uint16_t  mx,       // i : maximum in[x][y] value
+    int       level,    // i : decode every (1 << level)th value
+    int       use_simd) // i : allow vector code
+{
+    int w14  = (mx < (1 << 14)) ? 1 : 0;
+    int n    = (nx > ny) ? ny : nx;
+    int step = 1 << level;
+    int p    = 1;
+    int p2;
+
+    (void) use_simd;
+
+    //
+    // Search max level
+    //
+
+    while (p <= n)
+        p <<= 1;
+
+    p >>= 1;
+    p2 = p;
+    p >>= 1;
+
+    //
+    // Hierarchical loop on smaller dimension n
+    //
+
+    while (p >= 1)
+    {
+        uint16_t* py;
+        uint16_t* ey;
+        int       oy1, oy2, ox1, ox2;
+        uint16_t  i00, i01, i10, i11;
+
+        if (p < step)
+        {
+            wav_2D_decode_level_subsampled (
+                in, nx, ox, ny, oy, p, p2, step, w14);
+
+            p2 = p;
+            p >>= 1;
+            continue;
+        }
+
+        py  = in;
+        ey  = in + oy * (ny - p2);
+        oy1 = oy * p;
+        oy2 = oy * p2;
+        ox1 = ox * p;
+        ox2 = ox * p2;
+
+        //
+        // Y loop
+        //
+
+        for (; py <= ey; py += oy2)
+        {
+            uint16_t* px = py;
+            uint16_t* ex = py + ox * (nx - p2);
+
+            //
+            // X loop
+            //
+
+#ifdef IMF_HAVE_SSE2
+            if (use_simd) px = wav_2D_row_sse2 (px, ex, ox2, oy1, w14, 0);
+#endif
+
+            for (; px <= ex; px += ox2)
+            {
+                uint16_t* p01 = px + ox1;
+                uint16_t* p10 = px + oy1;
+                uint16_t* p11 = p10 + ox1;
+
+                //
+                // 2D wavelet decoding
+                //
+
+                if (w14)
+                {
+                    wdec14 (*px, *p10, &i00, &i10);
+                    wdec14 (*p01, *p11, &i01, &i11);
+                    wdec14 (i00, i01, px, p01);
+                    wdec14 (i10, i11, p10, p11);
+                }
+                else
+                {
+                    wdec16 (*px, *p10, &i00, &i10);
+                    wdec16 (*p01, *p11, &i01, &i11);
+                    wdec16 (i00, i01, px, p01);
+                    wdec16 (i10, i11, p10, p11);
+                }
+            }
+
+            //
+            // Decode (1D) odd column (still in Y loop)
+            //
+
+            if (nx & p)
+            {
+                uint16_t* p10 = px + oy1;
+
+                if (w14)
+                    wdec14 (*px, *p10, &i00, p10);
+                else
+                    wdec16 (*px, *p10, &i00, p10);
+                *px = i00;
+            }
+        }
+
+        //
+        // Decode (1D) odd line (must loop in X)
+        //
+
+        if (ny & p)
+        {
+            uint16_t* px = py;
+            uint16_t* ex = py + ox * (nx - p2);
+
+            for (; px <= ex; px += ox2)
+            {
+                uint16_t* p01 = px + ox1;
+
+                if (w14)
+                    wdec14 (*px, *p01, &i00, p01);
+                else
+                    wdec16 (*px, *p01, &i00, p01);
+                *px = i00;
+            }
+        }
+
+        //
+        // Next level
+        //
+
+        p2 = p;
+        p >>= 1;
+    }
+}
+
+/**************************************/
+
+void
+internal_wav_2D_encode (
+    uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx)
+{
+    wav_2D_encode (in, nx, ox, ny, oy, mx, 1);
+}
+
+void
+internal_wav_2D_decode (
+    uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx)
+{
+    wav_2D_decode (in, nx, ox, ny, oy, mx, 0, 1);
+}
+
+void
+internal_wav_2D_decode_reduced (
+    uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx, int level)
+{
+    wav_2D_decode (in, nx, ox, ny, oy, mx, level, 1);
+}
+
+void
+internal_wav_2D_encode_scalar (
+    uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx)
+{
+    wav_2D_encode (in, nx, ox, ny, oy, mx, 0);
+}
+
+void
+internal_wav_2D_decode_scalar (
+    uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx)
+{
+    wav_2D_decode (in, nx, ox, ny, oy, mx, 0, 0);
+}
+
+int
+internal_wav_has_simd (void)
+{
+#ifdef IMF_HAVE_SSE2
+    return 1;
+#else
+    return 0;
+#endif
+}
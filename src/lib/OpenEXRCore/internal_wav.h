@@ -0,0 +1,33 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#ifndef OPENEXR_CORE_WAV_H
+#define OPENEXR_CORE_WAV_H
+
+#include <stdint.h>
+
+/* 2D Haar wavelet transform used by PIZ, in place. These use vector
+ * instructions where available, and are bit exact with the _scalar
+ * variants, which are provided for testing */
+void internal_wav_2D_encode (
+    uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx);
+void internal_wav_2D_decode (
+    uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx);
+
+/* only decodes the values in[y][x] where x and y are multiples of
+ * (1 << level), giving the same values there as the full decode, for
+ * reduced resolution reads; the others are left undefined */
+void internal_wav_2D_decode_reduced (
+    uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx, int level);
+
+void internal_wav_2D_encode_scalar (
+    uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx);
+void internal_wav_2D_decode_scalar (
+    uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx);
+
+/* non-zero if internal_wav_2D_encode / decode use vector code */
+int internal_wav_has_simd (void);
+
+#endif /* OPENEXR_CORE_WAV_H */
@@ -149,6 +149,179 @@ interleave (uint8_t* out, const uint8_t* source, uint64_t outSize)
 
 /**************************************/
 
+void
+internal_zip_reconstruct_bytes (
+    uint8_t* out, uint8_t* scratch, uint64_t count)
+{
+    reconstruct (scratch, count);
+    interleave (out, scratch, count);
+}
+
+/**************************************/
+
+/* The one shot compress2 / uncompress set up (and tear down) the
+ * whole zlib state for every call, which for ZIPS, where each chunk
+ * is a single scanline, costs more than the actual coding. Instead,
+ * the z_stream lives in scratch_buffer_2 of the pipeline along with
+ * an arena that zlib allocates its state from, so it is created on
+ * the first chunk, reset for each subsequent one, and released with
+ * the pipeline. Should the arena ever be too small (a different zlib
+ * build), this falls back to the one shot calls.
+ */
+
+#define ZIP_STREAM_MAGIC 0x6d61727473706970ULL
+#define ZIP_STREAM_ALIGN 64
+#define ZIP_INFLATE_LEVEL -100
+
+/* deflate needs about 64k each for the window, hash chains and
+ * pending buffer plus 6k of state, inflate 7k plus the 32k window */
+#define ZIP_DEFLATE_ARENA_SIZE (320 * 1024)
+#define ZIP_INFLATE_ARENA_SIZE (48 * 1024)
+
+typedef struct
+{
+    uint64_t magic;
+    void*    self;
+    int      level;
+    size_t   used;
+    size_t   avail;
+    z_stream strm;
+} zip_stream_arena_t;
+
+#define ZIP_STREAM_HEADER_SIZE                                                 \
+    ((sizeof (zip_stream_arena_t) + ZIP_STREAM_ALIGN - 1) &                    \
+     ~((size_t) ZIP_STREAM_ALIGN - 1))
+
+static voidpf
+zip_arena_alloc (voidpf opaque, uInt items, uInt size)
+{
+    zip_stream_arena_t* za     = (zip_stream_arena_t*) opaque;
+    size_t              nbytes = (size_t) items * (size_t) size;
+    size_t              off    = (za->used + ZIP_STREAM_ALIGN - 1) &
+                 ~((size_t) ZIP_STREAM_ALIGN - 1);
+
+    if (off > za->avail || nbytes > za->avail - off) return Z_NULL;
+
+    za->used = off + nbytes;
+    return ((uint8_t*) za) + ZIP_STREAM_HEADER_SIZE + off;
+}
+
+static void
+zip_arena_free (voidpf opaque, voidpf address)
+{
+    (void) opaque;
+    (void) address;
+}
+
+/* the pipeline allocates scratch_buffer_2 uninitialized, so clear the
+ * header whenever it was (re)allocated, lest zip_acquire_stream take
+ * stale bytes for a live stream */
+static void
+zip_clear_stream (void* buf, size_t bufsz)
+{
+    if (buf && bufsz >= sizeof (zip_stream_arena_t))
+        memset (buf, 0, sizeof (zip_stream_arena_t));
+}
+
+/* returns a reset stream ready for a new chunk, or NULL if the one
+ * shot path should be used */
+static z_stream*
+zip_acquire_stream (void* buf, size_t bufsz, int level)
+{
+    zip_stream_arena_t* za = (zip_stream_arena_t*) buf;
+    int                 zstat;
+
+    if (!buf || bufsz <= ZIP_STREAM_HEADER_SIZE) return NULL;
+
+    if (za->magic == ZIP_STREAM_MAGIC && za->self == buf &&
+        za->level == level)
+    {
+        if (level == ZIP_INFLATE_LEVEL)
+            zstat = inflateReset (&(za->strm));
+        else
+            zstat = deflateReset (&(za->strm));
+        if (zstat == Z_OK) return &(za->strm);
+    }
+
+    memset (za, 0, sizeof (zip_stream_arena_t));
+    za->self        = buf;
+    za->level       = level;
+    za->avail       = bufsz - ZIP_STREAM_HEADER_SIZE;
+    za->strm.zalloc = &zip_arena_alloc;
+    za->strm.zfree  = &zip_arena_free;
+    za->strm.opaque = za;
+
+    if (level == ZIP_INFLATE_LEVEL)
+        zstat = inflateInit (&(za->strm));
+    else
+        zstat = deflateInit (&(za->strm), level);
+    if (zstat != Z_OK) return NULL;
+
+    za->magic = ZIP_STREAM_MAGIC;
+    return &(za->strm);
+}
+
+static int
+zip_uncompress (
+    void*        streambuf,
+    size_t       streambufsz,
+    Bytef*       dest,
+    uLong*       destLen,
+    const Bytef* source,
+    uLong        sourceLen)
+{
+    z_stream* strm =
+        zip_acquire_stream (streambuf, streambufsz, ZIP_INFLATE_LEVEL);
+    int zstat;
+
+    if (!strm || sourceLen > UINT_MAX || *destLen > UINT_MAX)
+        return uncompress (dest, destLen, source, sourceLen);
+
+    strm->next_in   = (Bytef*) source;
+    strm->avail_in  = (uInt) sourceLen;
+    strm->next_out  = dest;
+    strm->avail_out = (uInt) *destLen;
+
+    zstat = inflate (strm, Z_FINISH);
+    if (zstat == Z_MEM_ERROR)
+        return uncompress (dest, destLen, source, sourceLen);
+
+    *destLen = strm->total_out;
+    return (zstat == Z_STREAM_END) ? Z_OK : Z_DATA_ERROR;
+}
+
+static int
+zip_compress (
+    void*        streambuf,
+    size_t       streambufsz,
+    Bytef*       dest,
+    uLong*       destLen,
+    const Bytef* source,
+    uLong        sourceLen,
+    int          level)
+{
+    z_stream* strm = zip_acquire_stream (streambuf, streambufsz, level);
+    int       zstat;
+
+    if (!strm || sourceLen > UINT_MAX || *destLen > UINT_MAX)
+        return compress2 (dest, destLen, source, sourceLen, level);
+
+    strm->next_in   = (Bytef*) source;
+    strm->avail_in  = (uInt) sourceLen;
+    strm->next_out  = dest;
+    strm->avail_out = (uInt) *destLen;
+
+    zstat = deflate (strm, Z_FINISH);
+    if (zstat == Z_MEM_ERROR)
+        return compress2 (dest, destLen, source, sourceLen, level);
+    if (zstat != Z_STREAM_END) return (zstat == Z_OK) ? Z_BUF_ERROR : zstat;
+
+    *destLen = strm->total_out;
+    return Z_OK;
+}
+
+/**************************************/
+
 static exr_result_t
 undo_zip_impl (
     const void* compressed_data,
@@ -156,14 +329,18 @@ undo_zip_impl (
     void*       uncompressed_data,
     uint64_t    uncompressed_size,
     void*       scratch_data,
-    uint64_t    scratch_size)
+    uint64_t    scratch_size,
+    void*       stream_data,
+    uint64_t    stream_size)
 {
     uLong  outSize = (uLong) scratch_size;
     int    rstat;
 
     if (scratch_size < uncompressed_size) return EXR_ERR_INVALID_ARGUMENT;
 
-    rstat = uncompress (
+    rstat = zip_uncompress (
+        stream_data,
+        stream_size,
         (Bytef*) scratch_data,
         &outSize,
         (const Bytef*) compressed_data,
@@ -172,8 +349,8 @@ undo_zip_impl (
     {
         if (outSize == uncompressed_size)
         {
-            reconstruct (scratch_data, outSize);
-            interleave (uncompressed_data, scratch_data, outSize);
+            internal_zip_reconstruct_bytes (
+                uncompressed_data, scratch_data, outSize);
             rstat = EXR_ERR_SUCCESS;
         }
         else
@@ -200,6 +377,7 @@ internal_exr_undo_zip (
     uint64_t               uncompressed_size)
 {
     exr_result_t rv;
+    size_t       streambufsz;
     uint64_t scratchbufsz = uncompressed_size;
     if ( comp_buf_size > scratchbufsz )
         scratchbufsz = comp_buf_size;
@@ -211,31 +389,41 @@ internal_exr_undo_zip (
         &(decode->scratch_alloc_size_1),
         scratchbufsz);
     if (rv != EXR_ERR_SUCCESS) return rv;
+
+    streambufsz = decode->scratch_alloc_size_2;
+    rv          = internal_decode_alloc_buffer (
+        decode,
+        EXR_TRANSCODE_BUFFER_SCRATCH2,
+        &(decode->scratch_buffer_2),
+        &(decode->scratch_alloc_size_2),
+        ZIP_STREAM_HEADER_SIZE + ZIP_INFLATE_ARENA_SIZE);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+    if (decode->scratch_alloc_size_2 != streambufsz)
+        zip_clear_stream (
+            decode->scratch_buffer_2, decode->scratch_alloc_size_2);
+
     return undo_zip_impl (
         compressed_data,
         comp_buf_size,
         uncompressed_data,
         uncompressed_size,
         decode->scratch_buffer_1,
-        decode->scratch_alloc_size_1);
+        decode->scratch_alloc_size_1,
+        decode->scratch_buffer_2,
+        decode->scratch_alloc_size_2);
 }
 
 /**************************************/
 
-static exr_result_t
-apply_zip_impl (exr_encode_pipeline_t* encode)
+void
+internal_zip_deconstruct_bytes (
+    uint8_t* scratch, const uint8_t* source, uint64_t count)
 {
-    uint8_t*       t1   = encode->scratch_buffer_1;
-    uint8_t*       t2   = t1 + (encode->packed_bytes + 1) / 2;
-    const uint8_t* raw  = encode->packed_buffer;
-    const uint8_t* stop = raw + encode->packed_bytes;
-    int            p, level;
-    uLong          compbufsz = (uLong) encode->compressed_alloc_size;
-    exr_result_t   rv        = EXR_ERR_SUCCESS;
-
-    rv = exr_get_zip_compression_level (
-        encode->context, encode->part_index, &level);
-    if (rv != EXR_ERR_SUCCESS) return rv;
+    uint8_t*       t1   = scratch;
+    uint8_t*       t2   = t1 + (count + 1) / 2;
+    const uint8_t* raw  = source;
+    const uint8_t* stop = raw + count;
+    int            p;
 
     /* reorder */
     while (raw < stop)
@@ -244,9 +432,9 @@ apply_zip_impl (exr_encode_pipeline_t* encode)
         if (raw < stop) *(t2++) = *(raw++);
     }
 
-    /* reorder */
-    t1 = encode->scratch_buffer_1;
-    t2 = t1 + encode->packed_bytes;
+    /* predictor */
+    t1 = scratch;
+    t2 = t1 + count;
     t1++;
     p = (int) t1[-1];
     while (t1 < t2)
@@ -256,8 +444,27 @@ apply_zip_impl (exr_encode_pipeline_t* encode)
         t1[0] = (uint8_t) d;
         ++t1;
     }
+}
+
+/**************************************/
+
+static exr_result_t
+apply_zip_impl (exr_encode_pipeline_t* encode)
+{
+    int          level;
+    uLong        compbufsz = (uLong) encode->compressed_alloc_size;
+    exr_result_t rv        = EXR_ERR_SUCCESS;
+
+    rv = exr_get_zip_compression_level (
+        encode->context, encode->part_index, &level);
+    if (rv != EXR_ERR_SUCCESS) return rv;
 
-    if (Z_OK != compress2 (
+    internal_zip_deconstruct_bytes (
+        encode->scratch_buffer_1, encode->packed_buffer, encode->packed_bytes);
+
+    if (Z_OK != zip_compress (
+                    encode->scratch_buffer_2,
+                    encode->scratch_alloc_size_2,
                     (Bytef*) encode->compressed_buffer,
                     &compbufsz,
                     (const Bytef*) encode->scratch_buffer_1,
@@ -282,6 +489,7 @@ exr_result_t
 internal_exr_apply_zip (exr_encode_pipeline_t* encode)
 {
     exr_result_t rv;
+    size_t       streambufsz;
 
     rv = internal_encode_alloc_buffer (
         encode,
@@ -291,5 +499,17 @@ internal_exr_apply_zip (exr_encode_pipeline_t* encode)
         encode->packed_bytes);
     if (rv != EXR_ERR_SUCCESS) return rv;
 
+    streambufsz = encode->scratch_alloc_size_2;
+    rv          = internal_encode_alloc_buffer (
+        encode,
+        EXR_TRANSCODE_BUFFER_SCRATCH2,
+        &(encode->scratch_buffer_2),
+        &(encode->scratch_alloc_size_2),
+        ZIP_STREAM_HEADER_SIZE + ZIP_DEFLATE_ARENA_SIZE);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+    if (encode->scratch_alloc_size_2 != streambufsz)
+        zip_clear_stream (
+            encode->scratch_buffer_2, encode->scratch_alloc_size_2);
+
     return apply_zip_impl (encode);
 }
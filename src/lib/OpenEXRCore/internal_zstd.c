@@ -0,0 +1,124 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#include "internal_compress.h"
+#include "internal_decompress.h"
+
+#include "internal_coding.h"
+#include "internal_structs.h"
+
+#include "OpenEXRConfigInternal.h"
+
+#include <string.h>
+
+#ifdef OPENEXR_HAVE_ZSTD
+#    include <zstd.h>
+#endif
+
+/* ZSTD uses the same byte reordering and predictor as ZIP, only
+ * replacing deflate with zstd, which is both faster to decode and
+ * compresses as well or better at the lower levels.
+ */
+
+/**************************************/
+
+exr_result_t
+internal_exr_apply_zstd (exr_encode_pipeline_t* encode)
+{
+#ifdef OPENEXR_HAVE_ZSTD
+    exr_result_t rv;
+    int          level;
+    size_t       compbufsz;
+
+    rv = exr_get_zstd_compression_level (
+        encode->context, encode->part_index, &level);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    rv = internal_encode_alloc_buffer (
+        encode,
+        EXR_TRANSCODE_BUFFER_SCRATCH1,
+        &(encode->scratch_buffer_1),
+        &(encode->scratch_alloc_size_1),
+        encode->packed_bytes);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    internal_zip_deconstruct_bytes (
+        encode->scratch_buffer_1, encode->packed_buffer, encode->packed_bytes);
+
+    compbufsz = ZSTD_compress (
+        encode->compressed_buffer,
+        encode->compressed_alloc_size,
+        encode->scratch_buffer_1,
+        encode->packed_bytes,
+        level);
+    if (ZSTD_isError (compbufsz)) return EXR_ERR_CORRUPT_CHUNK;
+
+    if (compbufsz >= encode->packed_bytes)
+    {
+        memcpy (
+            encode->compressed_buffer,
+            encode->packed_buffer,
+            encode->packed_bytes);
+        compbufsz = encode->packed_bytes;
+    }
+    encode->compressed_bytes = compbufsz;
+    return EXR_ERR_SUCCESS;
+#else
+    EXR_PROMOTE_CONST_CONTEXT_AND_PART_OR_ERROR_NO_LOCK (
+        encode->context, encode->part_index);
+    return pctxt->report_error (
+        pctxt,
+        EXR_ERR_FEATURE_NOT_IMPLEMENTED,
+        "ZSTD compression not available in this build");
+#endif
+}
+
+/**************************************/
+
+exr_result_t
+internal_exr_undo_zstd (
+    exr_decode_pipeline_t* decode,
+    const void*            compressed_data,
+    uint64_t               comp_buf_size,
+    void*                  uncompressed_data,
+    uint64_t               uncompressed_size)
+{
+#ifdef OPENEXR_HAVE_ZSTD
+    exr_result_t rv;
+    size_t       outsz;
+
+    rv = internal_decode_alloc_buffer (
+        decode,
+        EXR_TRANSCODE_BUFFER_SCRATCH1,
+        &(decode->scratch_buffer_1),
+        &(decode->scratch_alloc_size_1),
+        uncompressed_size);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    outsz = ZSTD_decompress (
+        decode->scratch_buffer_1,
+        decode->scratch_alloc_size_1,
+        compressed_data,
+        comp_buf_size);
+    if (ZSTD_isError (outsz) || outsz != uncompressed_size)
+        return EXR_ERR_CORRUPT_CHUNK;
+
+    if (outsz > 0)
+        internal_zip_reconstruct_bytes (
+            uncompressed_data, decode->scratch_buffer_1, outsz);
+    return EXR_ERR_SUCCESS;
+#else
+    (void) compressed_data;
+    (void) comp_buf_size;
+    (void) uncompressed_data;
+    (void) uncompressed_size;
+    EXR_PROMOTE_CONST_CONTEXT_AND_PART_OR_ERROR_NO_LOCK (
+        decode->context, decode->part_index);
+    return pctxt->report_error (
+        pctxt,
+        EXR_ERR_FEATURE_NOT_IMPLEMENTED,
+        "ZSTD decompression not available in this build");
+#endif
+}
@@ -24,5 +24,6 @@
 #include "openexr_encode.h"
 
 #include "openexr_debug.h"
+#include "openexr_stats.h"
 
 #endif /* OPENEXR_CORE_H */
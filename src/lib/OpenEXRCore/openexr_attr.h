@@ -45,6 +45,8 @@ typedef enum
     EXR_COMPRESSION_B44A  = 7,
     EXR_COMPRESSION_DWAA  = 8,
     EXR_COMPRESSION_DWAB  = 9,
+    EXR_COMPRESSION_ZSTD  = 10, /**< Optional, needs the zstd library. */
+    EXR_COMPRESSION_LZ4   = 11, /**< Optional, needs the lz4 library. */
     EXR_COMPRESSION_LAST_TYPE /**< Invalid value, provided for range checking. */
 } exr_compression_t;
 
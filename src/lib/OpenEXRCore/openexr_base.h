@@ -125,6 +125,17 @@ EXR_EXPORT void exr_set_default_zip_compression_level (int l);
  */
 EXR_EXPORT void exr_get_default_zip_compression_level (int* l);
 
+/** @brief Assigns a default zstd compression level, from 1 to 22.
+ *
+ * This value may be controlled separately on each part, but this
+ * global control determines the initial value.
+ */
+EXR_EXPORT void exr_set_default_zstd_compression_level (int l);
+
+/** @brief Retrieve the global default zstd compression level
+ */
+EXR_EXPORT void exr_get_default_zstd_compression_level (int* l);
+
 /** @brief Assigns a default DWA compression quality level.
  *
  * This value may be controlled separately on each part, but this
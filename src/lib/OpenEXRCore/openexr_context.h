@@ -340,6 +340,13 @@ typedef struct _exr_context_initializer_v3
  */
 #define EXR_CONTEXT_FLAG_DISABLE_CHUNK_RECONSTRUCTION (1 << 2)
 
+/** @brief Enables collection of pipeline timing and I/O counters
+ *
+ * This adds a clock query around each stage of the decode / encode
+ * pipelines, and so is off by default. See exr_get_pipeline_stats().
+ */
+#define EXR_CONTEXT_FLAG_COLLECT_STATS (1 << 3)
+
 /** @brief Simple macro to initialize the context initializer with default values. */
 #define EXR_DEFAULT_CONTEXT_INITIALIZER                                        \
     {                                                                          \
@@ -444,9 +451,19 @@ EXR_EXPORT exr_result_t exr_start_write (
 
 /** @brief Create a new context for updating an exr file in place.
  *
- * This is a custom mode that allows one to modify the value of a
- * metadata entry, although not to change the size of the header, or
- * any of the image data.
+ * This is a custom mode that allows one to modify the metadata of a
+ * file without touching any of the image data. Attributes may be
+ * changed, added, or resized, but the attributes which define the
+ * layout of the image data (channels, compression, data window, line
+ * order, tiles, version and chunk count) can not be modified.
+ *
+ * Once the changes are made, call exr_write_header() to rewrite the
+ * header and chunk offset tables in place. If the new header no
+ * longer fits in front of the first chunk of image data, that will
+ * return \c EXR_ERR_MODIFY_SIZE_CHANGE and leave the file untouched,
+ * in which case the file has to be rewritten. Files written with
+ * space reserved by exr_set_header_padding() can grow their header by
+ * up to that many bytes.
  *
  * If you have custom I/O requirements, see the initializer context
  * documentation \ref exr_context_initializer_t. The @p ctxtdata parameter
@@ -509,6 +526,18 @@ EXR_EXPORT exr_result_t exr_register_attr_type_handler (
 EXR_EXPORT exr_result_t
 exr_set_longname_support (exr_context_t ctxt, int onoff);
 
+/** @brief Reserve space after the header when writing.
+ *
+ * The @p padbytes of zeros are placed between the chunk offset
+ * tables and the first chunk, where readers ignore them. This allows
+ * a later exr_start_inplace_header_update() to grow the header by
+ * that much without rewriting the image data.
+ *
+ * Must be called prior to exr_write_header().
+ */
+EXR_EXPORT exr_result_t
+exr_set_header_padding (exr_context_t ctxt, uint32_t padbytes);
+
 /** @brief Write the header data.
  *
  * Opening a new output file has a small initialization state problem
@@ -522,6 +551,10 @@ exr_set_longname_support (exr_context_t ctxt, int onoff);
  * It will recompute the number of chunks that will be written, and
  * reset the chunk offsets. If you modify file attributes or part
  * information after a call to this, it will error.
+ *
+ * For a context created with exr_start_inplace_header_update(), this
+ * instead rewrites the header and chunk offset tables of the existing
+ * file, see there for details.
  */
 EXR_EXPORT exr_result_t exr_write_header (exr_context_t ctxt);
 
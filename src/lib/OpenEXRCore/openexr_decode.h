@@ -255,6 +255,10 @@ typedef struct _exr_decode_pipeline
 /** Initialize the decoding pipeline structure with the channel info
  * for the specified part, and the first block to be read.
  *
+ * The read and decompress stages are set to the default routines, so
+ * running the pipeline right after this reads and decompresses the
+ * chunk into decode->unpacked_buffer.
+ *
  * NB: The decode->unpack_and_convert_fn field will be `NULL` after this. If that
  * stage is desired, initialize the channel output information and
  * call exr_decoding_choose_default_routines().
@@ -297,6 +301,41 @@ EXR_EXPORT
 exr_result_t exr_decoding_run (
     exr_const_context_t ctxt, int part_index, exr_decode_pipeline_t* decode);
 
+/** Compute the size of the buffer needed by
+ * exr_decoding_run_reduced() for the current chunk at @p level.
+ */
+EXR_EXPORT
+exr_result_t exr_decoding_reduced_size (
+    exr_const_context_t          ctxt,
+    int                          part_index,
+    const exr_decode_pipeline_t* decode,
+    int                          level,
+    uint64_t*                    size);
+
+/** Read the current chunk and decompress it at reduced resolution,
+ * 1/2, 1/4 or 1/8 in x and y for @p level 1, 2 or 3.
+ *
+ * This is only supported for PIZ compressed parts, where the whole
+ * chunk is still Huffman decoded, but the finer levels of the wavelet
+ * reconstruction are only done for the samples that are returned,
+ * making this much cheaper than a full decode for proxies.
+ *
+ * Each channel is written to @p out as a separate plane, in channel
+ * order, of ceil (height / s) rows of ceil (width / s) samples, where
+ * s is (1 << level) and width and height are those of the channel in
+ * the decode pipeline, in the (little endian) on-disk format. Sample
+ * (x, y) of a plane is sample (s * x, s * y) of the full decode. The
+ * unpack_and_convert_fn is not used.
+ */
+EXR_EXPORT
+exr_result_t exr_decoding_run_reduced (
+    exr_const_context_t    ctxt,
+    int                    part_index,
+    exr_decode_pipeline_t* decode,
+    int                    level,
+    void*                  out,
+    uint64_t               outsz);
+
 /** Free any intermediate memory in the decoding pipeline.
  *
  * This does *not* free any pointers referred to in the channel info
@@ -0,0 +1,160 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#ifndef OPENEXR_STATS_H
+#define OPENEXR_STATS_H
+
+#include "openexr_attr.h"
+#include "openexr_context.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @file */
+
+/** @brief Capacity of the per codec arrays in \c exr_pipeline_stats_t.
+ *
+ * This is fixed, so that adding a compression method does not change
+ * the size or layout of the structure. Only the first \c codec_count
+ * entries are used.
+ */
+#define EXR_PIPELINE_STATS_MAX_CODECS 32
+
+/** @brief Counters collected by the decode and encode pipelines.
+ *
+ * These are only gathered when the context was created with
+ * \c EXR_CONTEXT_FLAG_COLLECT_STATS, otherwise they stay zero. All
+ * times are accumulated wall clock time in nanoseconds, summed over
+ * all the threads running pipelines, so may exceed the elapsed time
+ * when decoding in parallel.
+ */
+typedef struct
+{
+    uint64_t chunks_read;    /**< Chunks read by exr_decoding_run(). */
+    uint64_t bytes_read;     /**< Packed bytes read, incl. deep sample tables. */
+    uint64_t chunks_written; /**< Chunks written by exr_encoding_run(). */
+    uint64_t bytes_written;  /**< Compressed bytes written, incl. sample tables. */
+
+    uint64_t read_ns;       /**< Time spent in the read_fn stage. */
+    uint64_t decompress_ns; /**< Time spent in the decompress_fn stage. */
+    uint64_t unpack_ns;     /**< Time spent in the unpack_and_convert_fn stage. */
+    uint64_t pack_ns;       /**< Time spent in the convert_and_pack_fn stage. */
+    uint64_t compress_ns;   /**< Time spent in the compress_fn stage. */
+    uint64_t write_ns;      /**< Time spent in the write_fn stage. */
+
+    /** Number of entries used in the per codec arrays, which is the
+     * number of compression methods known to the library. */
+    uint64_t codec_count;
+    /** Time spent decompressing, indexed by \c exr_compression_t. */
+    uint64_t decompress_ns_by_codec[EXR_PIPELINE_STATS_MAX_CODECS];
+    /** Time spent compressing, indexed by \c exr_compression_t. */
+    uint64_t compress_ns_by_codec[EXR_PIPELINE_STATS_MAX_CODECS];
+
+    uint64_t buffer_allocations;     /**< Transcode buffer (re)allocations. */
+    uint64_t buffer_allocated_bytes; /**< Total bytes of those allocations. */
+
+    /** Corrupt chunk tables rebuilt by scanning the file. */
+    uint64_t chunk_table_reconstructions;
+} exr_pipeline_stats_t;
+
+/** @brief Retrieve the pipeline counters for a part.
+ *
+ * If @p part_index is -1, the counters for all parts are summed.
+ *
+ * The counters are updated concurrently by any threads running
+ * pipelines, each value is read atomically, but the set is not a
+ * snapshot as a whole.
+ */
+EXR_EXPORT exr_result_t exr_get_pipeline_stats (
+    exr_const_context_t ctxt, int part_index, exr_pipeline_stats_t* stats);
+
+/** @brief Reset the pipeline counters for a part to zero.
+ *
+ * If @p part_index is -1, the counters for all parts are reset.
+ */
+EXR_EXPORT exr_result_t
+exr_reset_pipeline_stats (exr_const_context_t ctxt, int part_index);
+
+/** @brief Pipeline stage reported to a trace callback. */
+typedef enum exr_trace_stage
+{
+    EXR_TRACE_STAGE_READ,       /**< decode read_fn */
+    EXR_TRACE_STAGE_DECOMPRESS, /**< decode decompress_fn */
+    EXR_TRACE_STAGE_UNPACK,     /**< decode unpack_and_convert_fn */
+    EXR_TRACE_STAGE_PACK,       /**< encode convert_and_pack_fn */
+    EXR_TRACE_STAGE_COMPRESS,   /**< encode compress_fn */
+    EXR_TRACE_STAGE_WRITE,      /**< encode write_fn */
+    EXR_TRACE_STAGE_LAST_TYPE /**< Invalid value, provided for range checking. */
+} exr_trace_stage_t;
+
+/** @brief Event passed to a trace callback at the begin and end of
+ * each pipeline stage.
+ */
+typedef struct
+{
+    const char*       filename;    /**< File name of the context. */
+    int               part_index;  /**< Part the chunk belongs to. */
+    int               chunk_index; /**< Index of the chunk in the chunk table. */
+    exr_trace_stage_t stage;       /**< Stage being run. */
+    exr_compression_t compression; /**< Compression of the chunk. */
+    int               begin;       /**< 1 when entering the stage, 0 on exit. */
+    exr_result_t      result;      /**< Result of the stage, for end events. */
+    uint64_t          thread_id;   /**< OS id of the calling thread. */
+    /** Monotonic time in nanoseconds, same clock as the statistics. */
+    uint64_t timestamp_ns;
+} exr_trace_event_t;
+
+/** @brief Callback invoked around each pipeline stage.
+ *
+ * This is called from whichever threads are running
+ * exr_decoding_run() or exr_encoding_run(), so must be thread safe,
+ * and should be cheap as it is timed as part of the stage.
+ */
+typedef void (*exr_trace_callback_t) (
+    exr_const_context_t ctxt, const exr_trace_event_t* event, void* userdata);
+
+/** @brief Install (or clear with NULL) a trace callback on a context.
+ *
+ * This should be set prior to running any pipelines, it is not
+ * synchronized with threads currently running them.
+ */
+EXR_EXPORT exr_result_t exr_set_trace_callback (
+    exr_context_t ctxt, exr_trace_callback_t cb, void* userdata);
+
+/** @brief Return a static string naming the stage, e.g. "decompress". */
+EXR_EXPORT const char* exr_get_trace_stage_name (exr_trace_stage_t stage);
+
+/** Opaque handle for the bundled Chrome trace writer. */
+typedef struct _exr_chrome_trace* exr_chrome_trace_t;
+
+/** @brief Open a file to write trace events in the Chrome trace event
+ * JSON format, viewable in chrome://tracing or Perfetto.
+ *
+ * Install with exr_set_trace_callback() passing
+ * exr_chrome_trace_callback() and the returned handle as the user
+ * data. A single trace may be shared by any number of contexts.
+ */
+EXR_EXPORT exr_result_t
+exr_chrome_trace_start (exr_chrome_trace_t* trace, const char* filename);
+
+/** @brief Trace callback writing events to an \c exr_chrome_trace_t
+ * passed as @p userdata.
+ */
+EXR_EXPORT void exr_chrome_trace_callback (
+    exr_const_context_t ctxt, const exr_trace_event_t* event, void* userdata);
+
+/** @brief Terminate and close the trace file.
+ *
+ * Any contexts using the trace must be finished (or have their
+ * callback cleared) first.
+ */
+EXR_EXPORT exr_result_t exr_chrome_trace_finish (exr_chrome_trace_t* trace);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* OPENEXR_STATS_H */
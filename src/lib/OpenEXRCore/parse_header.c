@@ -1617,7 +1617,15 @@ check_populate_type (
         return ctxt->report_error (ctxt, rv, "Unable to read 'name' data");
     }
 
-    if (strcmp ((const char*) outstr, "scanlineimage") == 0)
+    /* older versions of the C++ library sometimes wrote the wrong
+     * type for single part images: like the C++ library, trust the
+     * version flags for those unless the header must be strict */
+    if (!ctxt->strict_header && !ctxt->is_multipart &&
+        !ctxt->has_nonimage_data)
+    {
+        /* storage mode was already set from the version flags */
+    }
+    else if (strcmp ((const char*) outstr, "scanlineimage") == 0)
         curpart->storage_mode = EXR_STORAGE_SCANLINE;
     else if (strcmp ((const char*) outstr, "tiledimage") == 0)
         curpart->storage_mode = EXR_STORAGE_TILED;
@@ -1625,6 +1633,13 @@ check_populate_type (
         curpart->storage_mode = EXR_STORAGE_DEEP_SCANLINE;
     else if (strcmp ((const char*) outstr, "deeptile") == 0)
         curpart->storage_mode = EXR_STORAGE_DEEP_TILED;
+    else if (!ctxt->strict_header && ctxt->is_multipart)
+    {
+        /* a part type from a future version of the file format: keep
+         * the part so its chunk table can be skipped and the rest of
+         * the file can still be read, but none of its chunks */
+        curpart->storage_mode = EXR_STORAGE_LAST_TYPE;
+    }
     else
     {
         rv = ctxt->print_error (
@@ -1686,7 +1701,9 @@ check_populate_version (
         return ctxt->report_error (ctxt, rv, "Unable to read version data");
 
     attrsz = (int32_t) one_to_native32 ((uint32_t) attrsz);
-    if (attrsz != 1)
+    /* a future version of a deep part is kept in a multipart file,
+     * but validation marks it as unknown, the same as a future type */
+    if (attrsz != 1 && (ctxt->strict_header || !ctxt->is_multipart))
         return ctxt->print_error (
             ctxt, EXR_ERR_INVALID_ATTR, "Invalid version %d: expect 1", attrsz);
 
@@ -2356,11 +2373,13 @@ internal_exr_compute_chunk_offset_size (struct _internal_exr_part* curpart)
             case EXR_COMPRESSION_RLE:
             case EXR_COMPRESSION_ZIPS: linePerChunk = 1; break;
             case EXR_COMPRESSION_ZIP:
-            case EXR_COMPRESSION_PXR24: linePerChunk = 16; break;
+            case EXR_COMPRESSION_PXR24:
+            case EXR_COMPRESSION_LZ4: linePerChunk = 16; break;
             case EXR_COMPRESSION_PIZ:
             case EXR_COMPRESSION_B44:
             case EXR_COMPRESSION_B44A:
-            case EXR_COMPRESSION_DWAA: linePerChunk = 32; break;
+            case EXR_COMPRESSION_DWAA:
+            case EXR_COMPRESSION_ZSTD: linePerChunk = 32; break;
             case EXR_COMPRESSION_DWAB: linePerChunk = 256; break;
             case EXR_COMPRESSION_LAST_TYPE:
             default:
@@ -2418,35 +2437,51 @@ update_chunk_offsets (
     {
         curpart = ctxt->parts[p];
 
-        rv = internal_exr_compute_tile_information (ctxt, curpart, 0);
-        if (rv != EXR_ERR_SUCCESS) break;
-
-        int32_t ccount = internal_exr_compute_chunk_offset_size (curpart);
-        if (ccount < 0)
+        if (curpart->storage_mode == EXR_STORAGE_LAST_TYPE)
         {
-            rv = ctxt->print_error (
-                ctxt,
-                EXR_ERR_INVALID_ATTR,
-                "Invalid chunk count (%d) for part '%s'",
-                ccount,
-                (curpart->name ? curpart->name->string->str : "<first>"));
-            break;
+            /* unknown part types must say how big their chunk table is */
+            if (curpart->chunk_count < 0)
+            {
+                rv = ctxt->print_error (
+                    ctxt,
+                    EXR_ERR_MISSING_REQ_ATTR,
+                    "'chunkCount' attribute for part '%s' of unknown type not found",
+                    (curpart->name ? curpart->name->string->str : "<first>"));
+                break;
+            }
         }
-
-        if (curpart->chunk_count < 0)
-            curpart->chunk_count = ccount;
-        else if (curpart->chunk_count != ccount)
+        else
         {
-            /* fatal error or just ignore it? c++ seemed to just ignore it entirely, we can at least warn */
-            /* rv = */
-            ctxt->print_error (
-                ctxt,
-                EXR_ERR_INVALID_ATTR,
-                "Invalid chunk count (%d) for part '%s', expect (%d)",
-                curpart->chunk_count,
-                (curpart->name ? curpart->name->string->str : "<first>"),
-                ccount);
-            curpart->chunk_count = ccount;
+            rv = internal_exr_compute_tile_information (ctxt, curpart, 0);
+            if (rv != EXR_ERR_SUCCESS) break;
+
+            int32_t ccount = internal_exr_compute_chunk_offset_size (curpart);
+            if (ccount < 0)
+            {
+                rv = ctxt->print_error (
+                    ctxt,
+                    EXR_ERR_INVALID_ATTR,
+                    "Invalid chunk count (%d) for part '%s'",
+                    ccount,
+                    (curpart->name ? curpart->name->string->str : "<first>"));
+                break;
+            }
+
+            if (curpart->chunk_count < 0)
+                curpart->chunk_count = ccount;
+            else if (curpart->chunk_count != ccount)
+            {
+                /* fatal error or just ignore it? c++ seemed to just ignore it entirely, we can at least warn */
+                /* rv = */
+                ctxt->print_error (
+                    ctxt,
+                    EXR_ERR_INVALID_ATTR,
+                    "Invalid chunk count (%d) for part '%s', expect (%d)",
+                    curpart->chunk_count,
+                    (curpart->name ? curpart->name->string->str : "<first>"),
+                    ccount);
+                curpart->chunk_count = ccount;
+            }
         }
         if (prevpart != curpart)
             curpart->chunk_table_offset =
@@ -136,7 +136,7 @@ exr_attr_declare_by_type (
     exr_result_t rv;
     EXR_PROMOTE_LOCKED_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
 
-    if (pctxt->mode != EXR_CONTEXT_WRITE)
+    if (!EXR_CAN_RESIZE_HEADER (pctxt))
         return EXR_UNLOCK_AND_RETURN_PCTXT (
             pctxt->standard_error (pctxt, EXR_ERR_NOT_OPEN_WRITE));
 
@@ -158,7 +158,7 @@ exr_attr_declare (
     exr_result_t rv;
     EXR_PROMOTE_LOCKED_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
 
-    if (pctxt->mode != EXR_CONTEXT_WRITE)
+    if (!EXR_CAN_RESIZE_HEADER (pctxt))
         return EXR_UNLOCK_AND_RETURN_PCTXT (
             pctxt->standard_error (pctxt, EXR_ERR_NOT_OPEN_WRITE));
 
@@ -626,6 +626,15 @@ exr_copy_unset_attributes (
             #name));                                                           \
     attr = part->name
 
+/* the attributes which define the chunk layout of the image data can
+ * not change when only the header is being rewritten */
+#define REQ_LAYOUT_ATTR_CHECK(name)                                            \
+    if (ctxt && EXR_CTXT (ctxt)->mode == EXR_CONTEXT_UPDATE_HEADER)            \
+    return EXR_CTXT (ctxt)->report_error (                                     \
+        EXR_CTXT (ctxt),                                                       \
+        EXR_ERR_NOT_OPEN_WRITE,                                                \
+        "Unable to change '" #name "' during an in-place header update")
+
 /**************************************/
 
 exr_result_t
@@ -647,6 +656,7 @@ exr_add_channel (
     int32_t                    xsamp,
     int32_t                    ysamp)
 {
+    REQ_LAYOUT_ATTR_CHECK (channels);
     REQ_ATTR_FIND_CREATE (channels, EXR_ATTR_CHLIST);
     if (rv == EXR_ERR_SUCCESS)
     {
@@ -668,6 +678,7 @@ exr_set_channels (
             EXR_ERR_INVALID_ARGUMENT,
             "No channels provided for channel list");
 
+    REQ_LAYOUT_ATTR_CHECK (channels);
     REQ_ATTR_FIND_CREATE (channels, EXR_ATTR_CHLIST);
     if (rv == EXR_ERR_SUCCESS)
     {
@@ -697,6 +708,7 @@ exr_result_t
 exr_set_compression (
     exr_context_t ctxt, int part_index, exr_compression_t ctype)
 {
+    REQ_LAYOUT_ATTR_CHECK (compression);
     REQ_ATTR_FIND_CREATE (compression, EXR_ATTR_COMPRESSION);
     if (rv == EXR_ERR_SUCCESS)
     {
@@ -727,6 +739,7 @@ exr_set_data_window (
             EXR_ERR_INVALID_ARGUMENT,
             "Missing value for data window assignment");
 
+    REQ_LAYOUT_ATTR_CHECK (dataWindow);
     REQ_ATTR_FIND_CREATE (dataWindow, EXR_ATTR_BOX2I);
 
     if (rv == EXR_ERR_SUCCESS)
@@ -794,6 +807,7 @@ exr_set_lineorder (exr_context_t ctxt, int part_index, exr_lineorder_t lo)
             0,
             (int) EXR_LINEORDER_LAST_TYPE);
 
+    REQ_LAYOUT_ATTR_CHECK (lineOrder);
     REQ_ATTR_FIND_CREATE (lineOrder, EXR_ATTR_LINEORDER);
     if (rv == EXR_ERR_SUCCESS)
     {
@@ -916,6 +930,7 @@ exr_set_tile_descriptor (
 {
     exr_result_t     rv   = EXR_ERR_SUCCESS;
     exr_attribute_t* attr = NULL;
+    REQ_LAYOUT_ATTR_CHECK (tiles);
     EXR_PROMOTE_LOCKED_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
     if (pctxt->mode == EXR_CONTEXT_READ)
         return EXR_UNLOCK_AND_RETURN_PCTXT (
@@ -1019,7 +1034,7 @@ exr_set_name (exr_context_t ctxt, int part_index, const char* val)
             /* we own the string... */
             memcpy (EXR_CONST_CAST (void*, attr->string->str), val, bytes);
         }
-        else if (pctxt->mode != EXR_CONTEXT_WRITE)
+        else if (!EXR_CAN_RESIZE_HEADER (pctxt))
         {
             return EXR_UNLOCK_AND_RETURN_PCTXT (pctxt->print_error (
                 pctxt,
@@ -1054,6 +1069,7 @@ exr_set_version (exr_context_t ctxt, int part_index, int32_t val)
     /* version number for deep data, expect 1 */
     if (val <= 0 || val > 1) return EXR_ERR_ARGUMENT_OUT_OF_RANGE;
 
+    REQ_LAYOUT_ATTR_CHECK (version);
     REQ_ATTR_FIND_CREATE (version, EXR_ATTR_INT);
     if (rv == EXR_ERR_SUCCESS) { attr->i = val; }
     return EXR_UNLOCK_AND_RETURN_PCTXT (rv);
@@ -1064,6 +1080,7 @@ exr_set_version (exr_context_t ctxt, int part_index, int32_t val)
 exr_result_t
 exr_set_chunk_count (exr_context_t ctxt, int part_index, int32_t val)
 {
+    REQ_LAYOUT_ATTR_CHECK (chunkCount);
     REQ_ATTR_FIND_CREATE (chunkCount, EXR_ATTR_INT);
     if (rv == EXR_ERR_SUCCESS)
     {
@@ -1129,7 +1146,7 @@ exr_set_chunk_count (exr_context_t ctxt, int part_index, int32_t val)
         ctxt, (exr_attribute_list_t*) &(part->attributes), name, &attr);       \
     if (rv == EXR_ERR_NO_ATTR_BY_NAME)                                         \
     {                                                                          \
-        if (pctxt->mode != EXR_CONTEXT_WRITE)                                  \
+        if (!EXR_CAN_RESIZE_HEADER (pctxt))                                    \
             return EXR_UNLOCK_AND_RETURN_PCTXT (rv);                           \
                                                                                \
         rv = exr_attr_list_add (                                               \
@@ -1483,7 +1500,7 @@ exr_attr_set_float_vector (
 
     if (rv == EXR_ERR_NO_ATTR_BY_NAME)
     {
-        if (pctxt->mode != EXR_CONTEXT_WRITE)
+        if (!EXR_CAN_RESIZE_HEADER (pctxt))
             return EXR_UNLOCK_AND_RETURN_PCTXT (rv);
 
         rv = exr_attr_list_add (
@@ -1512,7 +1529,7 @@ exr_attr_set_float_vector (
         {
             memcpy (EXR_CONST_CAST (void*, attr->floatvector->arr), val, bytes);
         }
-        else if (pctxt->mode != EXR_CONTEXT_WRITE)
+        else if (!EXR_CAN_RESIZE_HEADER (pctxt))
         {
             return EXR_UNLOCK_AND_RETURN_PCTXT (pctxt->print_error (
                 pctxt,
@@ -1739,7 +1756,7 @@ exr_attr_set_preview (
 
     if (rv == EXR_ERR_NO_ATTR_BY_NAME)
     {
-        if (pctxt->mode != EXR_CONTEXT_WRITE)
+        if (!EXR_CAN_RESIZE_HEADER (pctxt))
             return EXR_UNLOCK_AND_RETURN_PCTXT (rv);
 
         rv = exr_attr_list_add (
@@ -1774,7 +1791,7 @@ exr_attr_set_preview (
                 val->rgba,
                 copybytes);
         }
-        else if (pctxt->mode != EXR_CONTEXT_WRITE)
+        else if (!EXR_CAN_RESIZE_HEADER (pctxt))
         {
             return EXR_UNLOCK_AND_RETURN_PCTXT (pctxt->print_error (
                 pctxt,
@@ -1843,7 +1860,7 @@ exr_attr_set_string (
     exr_result_t     rv   = EXR_ERR_SUCCESS;
 
     if (name && !strcmp (name, EXR_REQ_NAME_STR))
-        return exr_set_name (ctxt, part_index, name);
+        return exr_set_name (ctxt, part_index, val);
 
     EXR_PROMOTE_LOCKED_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
 
@@ -1875,7 +1892,7 @@ exr_attr_set_string (
 
     if (rv == EXR_ERR_NO_ATTR_BY_NAME)
     {
-        if (pctxt->mode != EXR_CONTEXT_WRITE)
+        if (!EXR_CAN_RESIZE_HEADER (pctxt))
             return EXR_UNLOCK_AND_RETURN_PCTXT (rv);
 
         rv = exr_attr_list_add (
@@ -1899,7 +1916,7 @@ exr_attr_set_string (
             if (val)
                 memcpy (EXR_CONST_CAST (void*, attr->string->str), val, bytes);
         }
-        else if (pctxt->mode != EXR_CONTEXT_WRITE)
+        else if (!EXR_CAN_RESIZE_HEADER (pctxt))
         {
             return EXR_UNLOCK_AND_RETURN_PCTXT (pctxt->print_error (
                 pctxt,
@@ -1989,7 +2006,7 @@ exr_attr_set_string_vector (
 
     if (rv == EXR_ERR_NO_ATTR_BY_NAME)
     {
-        if (pctxt->mode != EXR_CONTEXT_WRITE)
+        if (!EXR_CAN_RESIZE_HEADER (pctxt))
             return EXR_UNLOCK_AND_RETURN_PCTXT (rv);
 
         rv = exr_attr_list_add (
@@ -2018,7 +2035,7 @@ exr_attr_set_string_vector (
         if (attr->stringvector->n_strings == size &&
             attr->stringvector->alloc_size > 0)
         {
-            if (pctxt->mode != EXR_CONTEXT_WRITE)
+            if (!EXR_CAN_RESIZE_HEADER (pctxt))
             {
                 for (int32_t i = 0; rv == EXR_ERR_SUCCESS && i < size; ++i)
                 {
@@ -2053,7 +2070,7 @@ exr_attr_set_string_vector (
                         ctxt, attr->stringvector, i, val[i]);
             }
         }
-        else if (pctxt->mode != EXR_CONTEXT_WRITE)
+        else if (!EXR_CAN_RESIZE_HEADER (pctxt))
         {
             return EXR_UNLOCK_AND_RETURN_PCTXT (pctxt->print_error (
                 pctxt,
@@ -2319,7 +2336,7 @@ exr_attr_set_user (
         ctxt, (exr_attribute_list_t*) &(part->attributes), name, &attr);
     if (rv == EXR_ERR_NO_ATTR_BY_NAME)
     {
-        if (pctxt->mode != EXR_CONTEXT_WRITE)
+        if (!EXR_CAN_RESIZE_HEADER (pctxt))
             return EXR_UNLOCK_AND_RETURN_PCTXT (rv);
         rv = exr_attr_list_add_by_type (
             ctxt, &(part->attributes), name, type, 0, NULL, &(attr));
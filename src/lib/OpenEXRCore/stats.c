@@ -0,0 +1,135 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#    define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "openexr_stats.h"
+
+#include "internal_stats.h"
+
+#include <string.h>
+#if !defined(_WIN32)
+#    include <time.h>
+#endif
+
+#define EXR_STATS_COUNTER_COUNT                                                \
+    (sizeof (exr_pipeline_stats_t) / sizeof (uint64_t))
+
+/* fails to compile once there are more compression methods than the
+ * per codec arrays of the public structure have room for */
+typedef char exr_stats_codec_capacity_check
+    [(EXR_COMPRESSION_LAST_TYPE <= EXR_PIPELINE_STATS_MAX_CODECS) ? 1 : -1];
+
+/**************************************/
+
+uint64_t
+internal_exr_stats_now (void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER freq, cnt;
+    QueryPerformanceFrequency (&freq);
+    QueryPerformanceCounter (&cnt);
+    return (uint64_t) (cnt.QuadPart / freq.QuadPart) * 1000000000ULL +
+           (uint64_t) (cnt.QuadPart % freq.QuadPart) * 1000000000ULL /
+               (uint64_t) freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+/**************************************/
+
+static void
+accumulate_part_stats (
+    const struct _internal_exr_part* part, exr_pipeline_stats_t* stats)
+{
+    const uint64_t* src = (const uint64_t*) &(part->stats);
+    uint64_t*       dst = (uint64_t*) stats;
+
+    for (size_t i = 0; i < EXR_STATS_COUNTER_COUNT; ++i)
+    {
+#if defined(_MSC_VER)
+        dst[i] += (uint64_t) InterlockedOr64 (
+            (volatile LONG64*) EXR_CONST_CAST (uint64_t*, src + i), 0);
+#else
+        dst[i] += __atomic_load_n (src + i, __ATOMIC_RELAXED);
+#endif
+    }
+}
+
+/**************************************/
+
+static void
+reset_part_stats (const struct _internal_exr_part* part)
+{
+    uint64_t* dst = (uint64_t*) &(
+        EXR_CONST_CAST (struct _internal_exr_part*, part)->stats);
+
+    for (size_t i = 0; i < EXR_STATS_COUNTER_COUNT; ++i)
+    {
+#if defined(_MSC_VER)
+        InterlockedExchange64 ((volatile LONG64*) (dst + i), 0);
+#else
+        __atomic_store_n (dst + i, 0, __ATOMIC_RELAXED);
+#endif
+    }
+}
+
+/**************************************/
+
+exr_result_t
+exr_get_pipeline_stats (
+    exr_const_context_t ctxt, int part_index, exr_pipeline_stats_t* stats)
+{
+    EXR_PROMOTE_CONST_CONTEXT_OR_ERROR (ctxt);
+
+    if (!stats)
+        return EXR_UNLOCK_WRITE_AND_RETURN_PCTXT (
+            pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT));
+
+    if (part_index < -1 || part_index >= pctxt->num_parts)
+        return EXR_UNLOCK_WRITE_AND_RETURN_PCTXT (pctxt->print_error (
+            pctxt,
+            EXR_ERR_ARGUMENT_OUT_OF_RANGE,
+            "Part index (%d) out of range",
+            part_index));
+
+    memset (stats, 0, sizeof (exr_pipeline_stats_t));
+    for (int p = 0; p < pctxt->num_parts; ++p)
+    {
+        if (part_index == -1 || part_index == p)
+            accumulate_part_stats (pctxt->parts[p], stats);
+    }
+    stats->codec_count = EXR_COMPRESSION_LAST_TYPE;
+
+    return EXR_UNLOCK_WRITE_AND_RETURN_PCTXT (EXR_ERR_SUCCESS);
+}
+
+/**************************************/
+
+exr_result_t
+exr_reset_pipeline_stats (exr_const_context_t ctxt, int part_index)
+{
+    EXR_PROMOTE_CONST_CONTEXT_OR_ERROR (ctxt);
+
+    if (part_index < -1 || part_index >= pctxt->num_parts)
+        return EXR_UNLOCK_WRITE_AND_RETURN_PCTXT (pctxt->print_error (
+            pctxt,
+            EXR_ERR_ARGUMENT_OUT_OF_RANGE,
+            "Part index (%d) out of range",
+            part_index));
+
+    for (int p = 0; p < pctxt->num_parts; ++p)
+    {
+        if (part_index == -1 || part_index == p)
+            reset_part_stats (pctxt->parts[p]);
+    }
+
+    return EXR_UNLOCK_WRITE_AND_RETURN_PCTXT (EXR_ERR_SUCCESS);
+}
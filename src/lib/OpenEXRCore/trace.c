@@ -0,0 +1,255 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#    define _GNU_SOURCE
+#endif
+
+#include "openexr_stats.h"
+
+#include "internal_memory.h"
+#include "internal_stats.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#    include <process.h>
+#    define getpid _getpid
+#else
+#    include <pthread.h>
+#    include <unistd.h>
+#    if defined(__linux__)
+#        include <sys/syscall.h>
+#    endif
+#endif
+
+struct _exr_chrome_trace
+{
+    FILE*    fp;
+    uint64_t start_ns;
+    int      pid;
+};
+
+/**************************************/
+
+static uint64_t
+current_thread_id (void)
+{
+#if defined(_WIN32)
+    return (uint64_t) GetCurrentThreadId ();
+#elif defined(__linux__) && defined(SYS_gettid)
+    return (uint64_t) syscall (SYS_gettid);
+#elif defined(__APPLE__)
+    uint64_t tid = 0;
+    pthread_threadid_np (NULL, &tid);
+    return tid;
+#else
+    return (uint64_t) (uintptr_t) pthread_self ();
+#endif
+}
+
+/**************************************/
+
+void
+internal_exr_trace (
+    const struct _internal_exr_context* pctxt,
+    int                                 part_index,
+    exr_trace_stage_t                   stage,
+    const exr_chunk_info_t*             cinfo,
+    int                                 begin,
+    exr_result_t                        result)
+{
+    exr_trace_event_t ev;
+
+    ev.filename     = pctxt->filename.str;
+    ev.part_index   = part_index;
+    ev.chunk_index  = cinfo->idx;
+    ev.stage        = stage;
+    ev.compression  = (exr_compression_t) cinfo->compression;
+    ev.begin        = begin;
+    ev.result       = result;
+    ev.thread_id    = current_thread_id ();
+    ev.timestamp_ns = internal_exr_stats_now ();
+
+    pctxt->trace_fn ((exr_const_context_t) pctxt, &ev, pctxt->trace_userdata);
+}
+
+/**************************************/
+
+exr_result_t
+exr_set_trace_callback (
+    exr_context_t ctxt, exr_trace_callback_t cb, void* userdata)
+{
+    EXR_PROMOTE_LOCKED_CONTEXT_OR_ERROR (ctxt);
+
+    pctxt->trace_fn       = cb;
+    pctxt->trace_userdata = cb ? userdata : NULL;
+
+    return EXR_UNLOCK_AND_RETURN_PCTXT (EXR_ERR_SUCCESS);
+}
+
+/**************************************/
+
+const char*
+exr_get_trace_stage_name (exr_trace_stage_t stage)
+{
+    static const char* the_stage_names[] = {
+        "read", "decompress", "unpack", "pack", "compress", "write"};
+
+    if (stage >= EXR_TRACE_STAGE_READ && stage < EXR_TRACE_STAGE_LAST_TYPE)
+        return the_stage_names[stage];
+    return "<unknown>";
+}
+
+/**************************************/
+
+static const char*
+compression_name (exr_compression_t c)
+{
+    static const char* the_compression_names[] = {
+        "none",
+        "rle",
+        "zips",
+        "zip",
+        "piz",
+        "pxr24",
+        "b44",
+        "b44a",
+        "dwaa",
+        "dwab",
+        "zstd",
+        "lz4"};
+
+    if (c >= EXR_COMPRESSION_NONE && c < EXR_COMPRESSION_LAST_TYPE)
+        return the_compression_names[c];
+    return "<unknown>";
+}
+
+/**************************************/
+
+static void
+escape_json (char* out, size_t outsz, const char* in)
+{
+    size_t o = 0;
+
+    if (in)
+    {
+        for (; *in && o + 7 < outsz; ++in)
+        {
+            unsigned char ch = (unsigned char) *in;
+            if (ch == '"' || ch == '\\')
+            {
+                out[o++] = '\\';
+                out[o++] = (char) ch;
+            }
+            else if (ch < 0x20)
+                o += (size_t) snprintf (out + o, outsz - o, "\\u%04x", ch);
+            else
+                out[o++] = (char) ch;
+        }
+    }
+    out[o] = '\0';
+}
+
+/**************************************/
+
+exr_result_t
+exr_chrome_trace_start (exr_chrome_trace_t* trace, const char* filename)
+{
+    struct _exr_chrome_trace* t;
+
+    if (!trace || !filename) return EXR_ERR_INVALID_ARGUMENT;
+    *trace = NULL;
+
+    t = internal_exr_alloc (sizeof (struct _exr_chrome_trace));
+    if (!t) return EXR_ERR_OUT_OF_MEMORY;
+
+    t->fp = fopen (filename, "w");
+    if (!t->fp)
+    {
+        internal_exr_free (t);
+        return EXR_ERR_FILE_ACCESS;
+    }
+    t->start_ns = internal_exr_stats_now ();
+    t->pid      = (int) getpid ();
+
+    fputs ("[\n", t->fp);
+    *trace = t;
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
+void
+exr_chrome_trace_callback (
+    exr_const_context_t ctxt, const exr_trace_event_t* ev, void* userdata)
+{
+    struct _exr_chrome_trace* t = userdata;
+    char                      fn[1024];
+    double                    ts;
+
+    (void) ctxt;
+    if (!t || !ev) return;
+
+    ts = (double) (ev->timestamp_ns - t->start_ns) / 1000.0;
+
+    /* each event is terminated with a comma and written with a single
+     * call so lines from different threads do not interleave, the
+     * trailing metadata record added by finish closes the array */
+    if (ev->begin)
+    {
+        escape_json (fn, sizeof (fn), ev->filename);
+        fprintf (
+            t->fp,
+            "{\"name\":\"%s\",\"cat\":\"openexr\",\"ph\":\"B\",\"ts\":%.3f,"
+            "\"pid\":%d,\"tid\":%" PRIu64 ",\"args\":{\"file\":\"%s\","
+            "\"part\":%d,\"chunk\":%d,\"compression\":\"%s\"}},\n",
+            exr_get_trace_stage_name (ev->stage),
+            ts,
+            t->pid,
+            ev->thread_id,
+            fn,
+            ev->part_index,
+            ev->chunk_index,
+            compression_name (ev->compression));
+    }
+    else
+    {
+        fprintf (
+            t->fp,
+            "{\"name\":\"%s\",\"cat\":\"openexr\",\"ph\":\"E\",\"ts\":%.3f,"
+            "\"pid\":%d,\"tid\":%" PRIu64 ",\"args\":{\"result\":\"%s\"}},\n",
+            exr_get_trace_stage_name (ev->stage),
+            ts,
+            t->pid,
+            ev->thread_id,
+            exr_get_error_code_as_string (ev->result));
+    }
+}
+
+/**************************************/
+
+exr_result_t
+exr_chrome_trace_finish (exr_chrome_trace_t* trace)
+{
+    struct _exr_chrome_trace* t;
+    int                       rc;
+
+    if (!trace) return EXR_ERR_INVALID_ARGUMENT;
+    t = *trace;
+    if (!t) return EXR_ERR_SUCCESS;
+    *trace = NULL;
+
+    fprintf (
+        t->fp,
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+        "\"args\":{\"name\":\"OpenEXR\"}}\n]\n",
+        t->pid);
+    rc = fclose (t->fp);
+    internal_exr_free (t);
+
+    return rc == 0 ? EXR_ERR_SUCCESS : EXR_ERR_WRITE_IO;
+}
@@ -208,7 +208,10 @@ validate_req_attr (
                 f,
                 EXR_ERR_MISSING_REQ_ATTR,
                 "'type' attribute for v2+ file not found");
-        if (f->has_nonimage_data && !curpart->version)
+        /* the image parts of a file with deep data have no version */
+        if ((curpart->storage_mode == EXR_STORAGE_DEEP_SCANLINE ||
+             curpart->storage_mode == EXR_STORAGE_DEEP_TILED) &&
+            !curpart->version)
             return f->print_error (
                 f,
                 EXR_ERR_MISSING_REQ_ATTR,
@@ -411,6 +414,10 @@ static exr_result_t
 validate_part_type (
     struct _internal_exr_context* f, struct _internal_exr_part* curpart)
 {
+    // a future version of a known part type can't be read either
+    if (curpart->version && curpart->version->i != 1)
+        curpart->storage_mode = EXR_STORAGE_LAST_TYPE;
+
     // TODO: there are probably more tests to add here...
     if (curpart->type)
     {
@@ -658,3 +658,181 @@ internal_exr_write_header (struct _internal_exr_context* ctxt)
 
     return rv;
 }
+
+/**************************************/
+
+static exr_result_t
+measure_write (
+    struct _internal_exr_context* ctxt,
+    const void*                   buf,
+    uint64_t                      sz,
+    uint64_t*                     offsetp)
+{
+    (void) ctxt;
+    (void) buf;
+    *offsetp += sz;
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
+static uint8_t
+required_name_length (const struct _internal_exr_context* ctxt)
+{
+    for (int p = 0; p < ctxt->num_parts; ++p)
+    {
+        const struct _internal_exr_part* curp = ctxt->parts[p];
+        for (int a = 0; a < curp->attributes.num_attributes; ++a)
+        {
+            const exr_attribute_t* curattr = curp->attributes.entries[a];
+            if (curattr->name_length > EXR_SHORTNAME_MAXLEN ||
+                curattr->type_name_length > EXR_SHORTNAME_MAXLEN)
+                return EXR_LONGNAME_MAXLEN;
+            if (curattr->type == EXR_ATTR_CHLIST)
+            {
+                const exr_attr_chlist_t* chs = curattr->chlist;
+                for (int c = 0; c < chs->num_channels; ++c)
+                {
+                    if (chs->entries[c].name.length > EXR_SHORTNAME_MAXLEN)
+                        return EXR_LONGNAME_MAXLEN;
+                }
+            }
+        }
+    }
+    return EXR_SHORTNAME_MAXLEN;
+}
+
+/**************************************/
+
+exr_result_t
+internal_exr_update_header_inplace (struct _internal_exr_context* ctxt)
+{
+    exr_result_t rv = EXR_ERR_SUCCESS;
+    uint64_t     oldhdrsz, newhdrsz, tablebytes, tableend, firstchunk;
+    uint64_t     nchunks = 0, offset;
+    uint64_t*    table;
+    uint8_t      oldmaxlen;
+    exr_result_t (*savewrite) (
+        struct _internal_exr_context*, const void*, uint64_t, uint64_t*);
+
+    if (!ctxt->do_read || !ctxt->do_write)
+        return ctxt->standard_error (ctxt, EXR_ERR_NOT_OPEN_WRITE);
+
+    for (int p = 0; rv == EXR_ERR_SUCCESS && p < ctxt->num_parts; ++p)
+    {
+        struct _internal_exr_part* curp = ctxt->parts[p];
+        if (curp->chunk_count < 0)
+            return ctxt->print_error (
+                ctxt,
+                EXR_ERR_BAD_CHUNK_LEADER,
+                "Invalid chunk count (%d) for part %d",
+                curp->chunk_count,
+                p);
+        nchunks += (uint64_t) curp->chunk_count;
+        rv = internal_exr_validate_read_part (ctxt, curp);
+    }
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    /* the chunk tables for all parts are contiguous after the header */
+    oldhdrsz   = ctxt->parts[0]->chunk_table_offset;
+    tablebytes = nchunks * sizeof (uint64_t);
+    tableend   = oldhdrsz + tablebytes;
+
+    table = ctxt->alloc_fn (tablebytes > 0 ? tablebytes : 1);
+    if (!table) return ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
+
+    offset = oldhdrsz;
+    if (tablebytes > 0)
+        rv = ctxt->do_read (
+            ctxt, table, tablebytes, &offset, NULL, EXR_MUST_READ_ALL);
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        ctxt->free_fn (table);
+        return ctxt->report_error (
+            ctxt, rv, "Unable to read chunk offset tables for header update");
+    }
+
+    /* the space available for the header and tables extends to the
+     * first chunk, which may have been pushed further out by header
+     * padding when the file was written */
+    firstchunk = 0;
+    for (uint64_t c = 0; c < nchunks; ++c)
+    {
+        uint64_t off = table[c];
+        priv_to_native64 (&off, 1);
+        if (off < tableend) continue;
+        if (ctxt->file_size > 0 && off >= (uint64_t) ctxt->file_size)
+            continue;
+        if (firstchunk == 0 || off < firstchunk) firstchunk = off;
+    }
+    if (firstchunk == 0) firstchunk = tableend;
+
+    /* only flag long names if they are actually needed now */
+    oldmaxlen             = ctxt->max_name_length;
+    ctxt->max_name_length = required_name_length (ctxt);
+
+    savewrite                = ctxt->do_write;
+    ctxt->do_write           = &measure_write;
+    ctxt->output_file_offset = 0;
+    rv                       = internal_exr_write_header (ctxt);
+    newhdrsz                 = ctxt->output_file_offset;
+    ctxt->do_write           = savewrite;
+
+    if (rv == EXR_ERR_SUCCESS && newhdrsz + tablebytes > firstchunk)
+    {
+        rv = ctxt->print_error (
+            ctxt,
+            EXR_ERR_MODIFY_SIZE_CHANGE,
+            "Updated header (%" PRIu64
+            " bytes) and chunk tables (%" PRIu64
+            " bytes) do not fit in the %" PRIu64
+            " bytes available before the first chunk",
+            newhdrsz,
+            tablebytes,
+            firstchunk);
+    }
+
+    if (rv == EXR_ERR_SUCCESS)
+    {
+        ctxt->output_file_offset = 0;
+        rv                       = internal_exr_write_header (ctxt);
+    }
+
+    if (rv == EXR_ERR_SUCCESS && tablebytes > 0)
+        rv = ctxt->do_write (
+            ctxt, table, tablebytes, &(ctxt->output_file_offset));
+
+    /* clear out the stale tail of the old tables if the header shrank */
+    if (rv == EXR_ERR_SUCCESS && ctxt->output_file_offset < tableend)
+    {
+        uint64_t zbytes = tableend - ctxt->output_file_offset;
+        uint8_t* zeros  = ctxt->alloc_fn (zbytes);
+        if (zeros)
+        {
+            memset (zeros, 0, zbytes);
+            rv = ctxt->do_write (
+                ctxt, zeros, zbytes, &(ctxt->output_file_offset));
+            ctxt->free_fn (zeros);
+        }
+        else
+            rv = ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
+    }
+
+    ctxt->free_fn (table);
+
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        ctxt->max_name_length = oldmaxlen;
+        return rv;
+    }
+
+    offset = newhdrsz;
+    for (int p = 0; p < ctxt->num_parts; ++p)
+    {
+        struct _internal_exr_part* curp = ctxt->parts[p];
+        curp->chunk_table_offset        = offset;
+        offset += (uint64_t) (curp->chunk_count) * sizeof (uint64_t);
+    }
+
+    return rv;
+}
@@ -35,10 +35,15 @@
 #include <ImfInputFile.h>
 #include <ImfOutputFile.h>
 #include <ImfTiledOutputFile.h>
+#include <ImfWav.h>
 #include <half.h>
 
 #if defined(OPENEXR_ENABLE_API_VISIBILITY)
 #    include "../../lib/OpenEXRCore/internal_huf.c"
+#    include "../../lib/OpenEXRCore/internal_wav.c"
+#    include "../../lib/OpenEXRCore/internal_b44_block.c"
+#    include "../../lib/OpenEXRCore/internal_b44_table.c"
+#    include "../../lib/OpenEXRCore/internal_pxr24_row.c"
 
 void*
 internal_exr_alloc (size_t bytes)
@@ -53,6 +58,9 @@ internal_exr_free (void* p)
 
 #else
 #    include "../../lib/OpenEXRCore/internal_huf.h"
+#    include "../../lib/OpenEXRCore/internal_wav.h"
+#    include "../../lib/OpenEXRCore/internal_b44_block.h"
+#    include "../../lib/OpenEXRCore/internal_pxr24_row.h"
 #endif
 
 using namespace IMATH_NAMESPACE;
@@ -72,6 +80,8 @@ imath_half_to_float (uint16_t a)
 
 ////////////////////////////////////////
 
+#if !defined(OPENEXR_ENABLE_API_VISIBILITY)
+// otherwise the same function is included from internal_b44_block.c
 inline int
 shiftAndRound (int x, int shift)
 {
@@ -81,6 +91,7 @@ shiftAndRound (int x, int shift)
     int b = (x >> shift) & 1;
     return (x + a + b) >> shift;
 }
+#endif
 
 inline bool
 withinB44ErrorBounds (const uint16_t A[4][4], const uint16_t B[4][4])
@@ -1292,6 +1303,8 @@ doWriteRead (
         case EXR_COMPRESSION_RLE:
         case EXR_COMPRESSION_ZIP:
         case EXR_COMPRESSION_ZIPS:
+        case EXR_COMPRESSION_ZSTD:
+        case EXR_COMPRESSION_LZ4:
             restore.compareExact (p, "orig", "C loaded C");
             break;
         case EXR_COMPRESSION_PIZ:
@@ -1490,6 +1503,309 @@ testHUF (const std::string& tempdir)
     {
         EXRCORE_TEST (decode.h[i] == p.h[i]);
     }
+
+    // a large, run heavy buffer (like wavelet output), large enough
+    // to take the multi-table frequency count path. The hash is of
+    // the encoding produced by the original (bit at a time, STL heap)
+    // encoder, the output must stay byte identical
+    const size_t          nLarge = 1 << 18;
+    std::vector<uint16_t> large (nLarge), largeDecode (nLarge);
+    uint64_t              x = 1;
+    for (size_t i = 0; i < nLarge;)
+    {
+        x          = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint32_t r = (uint32_t) (x >> 33);
+        if (r % 4 == 0)
+        {
+            uint32_t run = (r >> 2) % 24;
+            while (run-- > 0 && i < nLarge)
+                large[i++] = 0;
+        }
+        else
+            large[i++] = (uint16_t) ((int) ((r >> 2) % 128) - 64);
+    }
+    encoded.resize (nLarge * 2 * 3 + 65536);
+    cppencoded.resize (nLarge * 2 * 3 + 65536);
+    EXRCORE_TEST_RVAL (internal_huf_compress (
+        &ebytes,
+        encoded.data (),
+        encoded.size (),
+        large.data (),
+        nLarge,
+        hspare.data (),
+        esize));
+    cppebytes = hufCompress (large.data (), nLarge, (char*) (&cppencoded[0]));
+    EXRCORE_TEST (ebytes == 74823);
+    EXRCORE_TEST (ebytes == cppebytes);
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < ebytes; ++i)
+    {
+        EXRCORE_TEST (encoded[i] == cppencoded[i]);
+        hash = (hash ^ encoded[i]) * 1099511628211ULL;
+    }
+    EXRCORE_TEST (hash == 0x669c75d9ef2e98ceULL);
+    EXRCORE_TEST_RVAL (internal_huf_decompress (
+        NULL,
+        encoded.data (),
+        ebytes,
+        largeDecode.data (),
+        nLarge,
+        hspare.data (),
+        dsize));
+    EXRCORE_TEST (largeDecode == large);
+}
+
+////////////////////////////////////////
+
+static void
+wavCompare (int nx, int ny, int ox, uint16_t mx, Rand48& rand)
+{
+    size_t                n = (size_t) nx * (size_t) ny * (size_t) ox;
+    std::vector<uint16_t> orig (n), vec, ref, imf;
+
+    for (size_t i = 0; i < n; ++i)
+        orig[i] = (uint16_t) (rand.nexti () % ((uint32_t) mx + 1));
+    orig[0] = mx;
+
+    vec = orig;
+    ref = orig;
+    imf = orig;
+    for (int j = 0; j < ox; ++j)
+    {
+        internal_wav_2D_encode (vec.data () + j, nx, ox, ny, nx * ox, mx);
+        internal_wav_2D_encode_scalar (
+            ref.data () + j, nx, ox, ny, nx * ox, mx);
+        wav2Encode (imf.data () + j, nx, ox, ny, nx * ox, mx);
+    }
+    EXRCORE_TEST (vec == ref);
+    EXRCORE_TEST (imf == ref);
+
+    for (int j = 0; j < ox; ++j)
+    {
+        internal_wav_2D_decode (vec.data () + j, nx, ox, ny, nx * ox, mx);
+        internal_wav_2D_decode_scalar (
+            ref.data () + j, nx, ox, ny, nx * ox, mx);
+        wav2Decode (imf.data () + j, nx, ox, ny, nx * ox, mx);
+    }
+    EXRCORE_TEST (vec == ref);
+    EXRCORE_TEST (imf == ref);
+    EXRCORE_TEST (vec == orig);
+
+    // the reduced resolution decode must match the full one at every
+    // (1 << level)th sample
+    for (int level = 1; level <= 3; ++level)
+    {
+        int step = 1 << level;
+
+        vec = orig;
+        for (int j = 0; j < ox; ++j)
+            internal_wav_2D_encode (vec.data () + j, nx, ox, ny, nx * ox, mx);
+        for (int j = 0; j < ox; ++j)
+            internal_wav_2D_decode_reduced (
+                vec.data () + j, nx, ox, ny, nx * ox, mx, level);
+
+        for (int y = 0; y < ny; y += step)
+        {
+            for (int x = 0; x < nx; x += step)
+            {
+                for (int j = 0; j < ox; ++j)
+                {
+                    size_t i = ((size_t) y * nx + x) * ox + j;
+                    EXRCORE_TEST (vec[i] == orig[i]);
+                }
+            }
+        }
+    }
+}
+
+void
+testWAV (const std::string& tempdir)
+{
+    // the vectorized wavelet must be bit exact with the scalar one,
+    // for both basis functions, odd sizes and the interleaved layout
+    // used for 32-bit channels
+    static const int sizes[][2] = {
+        {1, 1},
+        {2, 2},
+        {3, 5},
+        {17, 9},
+        {16, 16},
+        {31, 32},
+        {33, 32},
+        {64, 16},
+        {100, 33},
+        {257, 32},
+        {1920, 32}};
+    Rand48 rand (0);
+
+    std::cout << "  wavelet simd: "
+              << (internal_wav_has_simd () ? "yes" : "no") << std::endl;
+    for (auto& sz: sizes)
+    {
+        for (int ox = 1; ox <= 2; ++ox)
+        {
+            wavCompare (sz[0], sz[1], ox, (1 << 14) - 1, rand);
+            wavCompare (sz[0], sz[1], ox, 0xffff, rand);
+            wavCompare (sz[1], sz[0], ox, 0xffff, rand);
+        }
+    }
+}
+
+////////////////////////////////////////
+
+static void
+b44Compare (int nblocks, int pattern, Rand48& rand)
+{
+    size_t                w = (size_t) nblocks * 4;
+    std::vector<uint16_t> orig (4 * w), vec (4 * w), ref (4 * w);
+    std::vector<uint8_t>  vout (14 * w), rout (14 * w);
+
+    for (size_t i = 0; i < orig.size (); ++i)
+    {
+        uint16_t v = (uint16_t) rand.nexti ();
+        size_t   b = (i % w) / 4;
+
+        switch (pattern)
+        {
+            case 0: break;
+            // smooth, so small shifts
+            case 1: v = (uint16_t) (0x3c00 + (v % 64) + 3 * b); break;
+            // a mix of flat and noisy blocks
+            case 2:
+                v = (b % 3) ? (uint16_t) (0x3800 + v % 2048) : 0x3c00;
+                break;
+            // infinities and NaNs
+            default:
+                if (v % 8 == 0) v = (v & 1) ? 0x7c00 : 0xfe01;
+                break;
+        }
+        orig[i] = v;
+    }
+
+    const uint16_t* in[4] = {
+        orig.data (),
+        orig.data () + w,
+        orig.data () + 2 * w,
+        orig.data () + 3 * w};
+    uint16_t* vrows[4] = {
+        vec.data (), vec.data () + w, vec.data () + 2 * w, vec.data () + 3 * w};
+    uint16_t* rrows[4] = {
+        ref.data (), ref.data () + w, ref.data () + 2 * w, ref.data () + 3 * w};
+
+    for (int linear = 0; linear < 2; ++linear)
+    {
+        for (int flat = 0; flat < 2; ++flat)
+        {
+            uint64_t vn = internal_b44_pack_blocks (
+                in, nblocks, linear, flat, vout.data ());
+            uint64_t rn = internal_b44_pack_blocks_scalar (
+                in, nblocks, linear, flat, rout.data ());
+
+            EXRCORE_TEST (vn == rn);
+            EXRCORE_TEST (vout == rout);
+
+            EXRCORE_TEST (
+                internal_b44_unpack_blocks (
+                    vout.data (), vn, nblocks, linear, vrows) == vn);
+            EXRCORE_TEST (
+                internal_b44_unpack_blocks_scalar (
+                    rout.data (), rn, nblocks, linear, rrows) == rn);
+            EXRCORE_TEST (vec == ref);
+
+            // truncated input must be rejected
+            EXRCORE_TEST (
+                internal_b44_unpack_blocks (
+                    vout.data (), vn - 1, nblocks, linear, vrows) == 0);
+        }
+    }
+}
+
+void
+testB44Blocks (const std::string& tempdir)
+{
+    // the vectorized block coding must be bit exact with the scalar
+    // one, for run lengths around the vector width
+    static const int nblocks[] = {1, 7, 8, 9, 16, 23, 480};
+    Rand48           rand (0);
+
+    std::cout << "  b44 simd: " << (internal_b44_has_simd () ? "yes" : "no")
+              << std::endl;
+    for (int n: nblocks)
+    {
+        for (int pattern = 0; pattern < 4; ++pattern)
+        {
+            for (int i = 0; i < 8; ++i)
+                b44Compare (n, pattern, rand);
+        }
+    }
+}
+
+////////////////////////////////////////
+
+static void
+pxr24Compare (exr_pixel_type_t type, int w, Rand48& rand)
+{
+    size_t               bpe     = (type == EXR_PIXEL_HALF) ? 2 : 4;
+    size_t               nplanes = (type == EXR_PIXEL_FLOAT) ? 3 : bpe;
+    std::vector<uint8_t> orig (bpe * w), planes (nplanes * w);
+    std::vector<uint8_t> vout (nplanes * w), rout (nplanes * w);
+    std::vector<uint8_t> vec (bpe * w), ref (bpe * w);
+
+    for (int x = 0; x < w; ++x)
+    {
+        uint32_t v = (uint32_t) rand.nexti ();
+
+        if (type == EXR_PIXEL_FLOAT)
+        {
+            // NaNs, infinities, round ups near FLT_MAX and denormals
+            switch (rand.nexti () % 8)
+            {
+                case 0: v = (v & 0x80000000) | 0x7f800000; break;
+                case 1: v = (v & 0x80000000) | 0x7f800000 | (v & 0xff); break;
+                case 2: v = (v & 0x80000000) | 0x7f7fff80 | (v & 0x7f); break;
+                case 3: v &= 0x807fffff; break;
+                default: break;
+            }
+        }
+        memcpy (orig.data () + x * bpe, &v, bpe);
+    }
+
+    internal_pxr24_split_row (type, orig.data (), w, vout.data ());
+    internal_pxr24_split_row_scalar (type, orig.data (), w, rout.data ());
+    EXRCORE_TEST (vout == rout);
+
+    internal_pxr24_merge_row (type, vout.data (), w, vec.data ());
+    internal_pxr24_merge_row_scalar (type, rout.data (), w, ref.data ());
+    EXRCORE_TEST (vec == ref);
+
+    // random planes, so the carries of the sums are exercised
+    for (auto& b: planes)
+        b = (uint8_t) rand.nexti ();
+    internal_pxr24_merge_row (type, planes.data (), w, vec.data ());
+    internal_pxr24_merge_row_scalar (type, planes.data (), w, ref.data ());
+    EXRCORE_TEST (vec == ref);
+}
+
+void
+testPXR24Rows (const std::string& tempdir)
+{
+    // the vectorized row coding must be bit exact with the scalar
+    // one, for widths around the vector width
+    static const int widths[] = {1, 15, 16, 17, 31, 32, 33, 100, 1920};
+    static const exr_pixel_type_t types[] = {
+        EXR_PIXEL_UINT, EXR_PIXEL_HALF, EXR_PIXEL_FLOAT};
+    Rand48 rand (0);
+
+    std::cout << "  pxr24 simd: "
+              << (internal_pxr24_has_simd () ? "yes" : "no") << std::endl;
+    for (int w: widths)
+    {
+        for (exr_pixel_type_t t: types)
+        {
+            for (int i = 0; i < 8; ++i)
+                pxr24Compare (t, w, rand);
+        }
+    }
 }
 
 ////////////////////////////////////////
@@ -1524,6 +1840,173 @@ testPIZCompression (const std::string& tempdir)
     //testComp (tempdir, EXR_COMPRESSION_PIZ);
 }
 
+static uint32_t
+loadLE (const uint8_t* p, int bytes)
+{
+    uint32_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static void
+doPIZReduced (const std::string& filename, bool noisy)
+{
+    // H half, F float, U uint, S half at half resolution, written by
+    // the C++ library, read back in full with the C++ library and at
+    // reduced resolution with the core
+    const int  w = 202, h = 78, dx = -12, dy = 6;
+    Box2i      dw (V2i (dx, dy), V2i (dx + w - 1, dy + h - 1));
+    Header     hdr (Box2i (V2i (0, 0), V2i (w - 1, h - 1)), dw);
+    Rand48     rand (noisy ? 5 : 3);
+    Array2D<uint16_t> hpix (h, w), spix (h / 2 + 1, w / 2 + 1);
+    Array2D<float>    fpix (h, w);
+    Array2D<uint32_t> upix (h, w);
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            int n = noisy ? rand.nexti () % 4096 : 0;
+
+            hpix[y][x] = half (0.25f + 0.01f * (float) (x + y)).bits () + n;
+            fpix[y][x] = noisy ? (float) rand.nextf () : (float) (x * y);
+            upix[y][x] = (uint32_t) (noisy ? rand.nexti () : x + 1000 * y);
+            if (y % 2 == 0 && x % 2 == 0)
+                spix[y / 2][x / 2] =
+                    (uint16_t) (hpix[y][x] ^ (noisy ? 0x55 : 0));
+        }
+    }
+
+    hdr.compression () = PIZ_COMPRESSION;
+    hdr.channels ().insert ("H", Channel (IMF::HALF));
+    hdr.channels ().insert ("F", Channel (IMF::FLOAT));
+    hdr.channels ().insert ("U", Channel (IMF::UINT));
+    hdr.channels ().insert ("S", Channel (IMF::HALF, 2, 2));
+
+    FrameBuffer fb;
+    fb.insert (
+        "H",
+        Slice::Make (
+            IMF::HALF, &hpix[0][0], dw, sizeof (uint16_t), w * sizeof (uint16_t)));
+    fb.insert (
+        "F",
+        Slice::Make (
+            IMF::FLOAT, &fpix[0][0], dw, sizeof (float), w * sizeof (float)));
+    fb.insert (
+        "U",
+        Slice::Make (
+            IMF::UINT,
+            &upix[0][0],
+            dw,
+            sizeof (uint32_t),
+            w * sizeof (uint32_t)));
+    fb.insert (
+        "S",
+        Slice::Make (
+            IMF::HALF,
+            &spix[0][0],
+            dw,
+            sizeof (uint16_t),
+            (w / 2 + 1) * sizeof (uint16_t),
+            2,
+            2));
+    {
+        OutputFile out (filename.c_str (), hdr);
+        out.setFrameBuffer (fb);
+        out.writePixels (h);
+    }
+    {
+        InputFile in (filename.c_str ());
+        in.setFrameBuffer (fb);
+        in.readPixels (dw.min.y, dw.max.y);
+    }
+
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    exr_chunk_info_t          cinfo;
+    exr_decode_pipeline_t     decoder = EXR_DECODE_PIPELINE_INITIALIZER;
+    int32_t                   scansperchunk;
+    bool                      first = true;
+    std::vector<uint8_t>      reduced;
+
+    EXRCORE_TEST_RVAL (exr_start_read (&f, filename.c_str (), &cinit));
+    EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &scansperchunk));
+
+    for (int y = dw.min.y; y <= dw.max.y; y += scansperchunk)
+    {
+        EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+        if (first)
+        {
+            EXRCORE_TEST_RVAL (
+                exr_decoding_initialize (f, 0, &cinfo, &decoder));
+        }
+        else
+        {
+            EXRCORE_TEST_RVAL (exr_decoding_update (f, 0, &cinfo, &decoder));
+        }
+        first = false;
+
+        for (int level = 1; level <= 3; ++level)
+        {
+            int      step = 1 << level;
+            uint64_t size;
+
+            EXRCORE_TEST_RVAL (
+                exr_decoding_reduced_size (f, 0, &decoder, level, &size));
+            reduced.assign (size, 0);
+            EXRCORE_TEST_RVAL_FAIL (
+                EXR_ERR_INVALID_ARGUMENT,
+                exr_decoding_run_reduced (
+                    f, 0, &decoder, level, reduced.data (), size - 1));
+            EXRCORE_TEST_RVAL (exr_decoding_run_reduced (
+                f, 0, &decoder, level, reduced.data (), size));
+
+            const uint8_t* plane = reduced.data ();
+            for (int c = 0; c < decoder.channel_count; ++c)
+            {
+                const exr_coding_channel_info_t& curc = decoder.channels[c];
+                int  bpe  = curc.bytes_per_element;
+                char name = curc.channel_name[0];
+
+                // channels are stored sorted by name: F H S U
+                for (int sy = 0; sy < curc.height; sy += step)
+                {
+                    for (int sx = 0; sx < curc.width; sx += step)
+                    {
+                        int      py = cinfo.start_y - dy + sy * curc.y_samples;
+                        int      px = sx * curc.x_samples;
+                        uint32_t v  = loadLE (plane, bpe);
+                        uint32_t e  = 0;
+
+                        switch (name)
+                        {
+                            case 'F': memcpy (&e, &fpix[py][px], 4); break;
+                            case 'H': e = hpix[py][px]; break;
+                            case 'S': e = spix[py / 2][px / 2]; break;
+                            default: e = upix[py][px]; break;
+                        }
+                        EXRCORE_TEST (v == e);
+                        plane += bpe;
+                    }
+                }
+            }
+            EXRCORE_TEST (plane == reduced.data () + size);
+        }
+    }
+    EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+    remove (filename.c_str ());
+}
+
+void
+testPIZReduced (const std::string& tempdir)
+{
+    // smooth data compresses, the noisy chunks are stored as is
+    doPIZReduced (tempdir + "imf_test_piz_reduced.exr", false);
+    doPIZReduced (tempdir + "imf_test_piz_reduced_noisy.exr", true);
+}
+
 void
 testPXR24Compression (const std::string& tempdir)
 {
@@ -1542,6 +2025,88 @@ testB44ACompression (const std::string& tempdir)
     testComp (tempdir, EXR_COMPRESSION_B44A);
 }
 
+static void
+doB44FloatChannels (const std::string& filename, exr_compression_t comp)
+{
+    // B44 packs FLOAT channels losslessly, one channel after the
+    // other, so the chunk is exactly as large as the raw pixels and
+    // must not be mistaken for an uncompressed one
+    const int                 w = 16, h = 32;
+    exr_context_t             f;
+    int                       partidx;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    exr_chunk_info_t          cinfo;
+    exr_encode_pipeline_t     encoder;
+    exr_decode_pipeline_t     decoder;
+    std::vector<float>        orig[2], back[2];
+    Rand48                    rand (0);
+
+    for (int c = 0; c < 2; ++c)
+    {
+        orig[c].resize (w * h);
+        back[c].resize (w * h, -1.f);
+        for (auto& v: orig[c])
+            v = (float) rand.nextf (-1000.0, 1000.0);
+    }
+
+    EXRCORE_TEST_RVAL (exr_start_write (
+        &f, filename.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+    EXRCORE_TEST_RVAL (
+        exr_add_part (f, "scan", EXR_STORAGE_SCANLINE, &partidx));
+    EXRCORE_TEST_RVAL (
+        exr_initialize_required_attr_simple (f, partidx, w, h, comp));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        f, partidx, "F", EXR_PIXEL_FLOAT, EXR_PERCEPTUALLY_LINEAR, 1, 1));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        f, partidx, "G", EXR_PIXEL_FLOAT, EXR_PERCEPTUALLY_LINEAR, 1, 1));
+    EXRCORE_TEST_RVAL (exr_write_header (f));
+
+    EXRCORE_TEST_RVAL (exr_write_scanline_chunk_info (f, 0, 0, &cinfo));
+    EXRCORE_TEST (cinfo.height == h);
+    EXRCORE_TEST_RVAL (exr_encoding_initialize (f, 0, &cinfo, &encoder));
+    for (int c = 0; c < encoder.channel_count; ++c)
+    {
+        encoder.channels[c].encode_from_ptr =
+            (const uint8_t*) orig[c].data ();
+        encoder.channels[c].user_pixel_stride = 4;
+        encoder.channels[c].user_line_stride  = 4 * w;
+    }
+    EXRCORE_TEST_RVAL (exr_encoding_choose_default_routines (f, 0, &encoder));
+    EXRCORE_TEST_RVAL (exr_encoding_run (f, 0, &encoder));
+    EXRCORE_TEST (
+        encoder.packed_bytes == (uint64_t) (2 * w * h * sizeof (float)));
+    EXRCORE_TEST (encoder.compressed_bytes == encoder.packed_bytes);
+    EXRCORE_TEST_RVAL (exr_encoding_destroy (f, &encoder));
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+
+    EXRCORE_TEST_RVAL (exr_start_read (&f, filename.c_str (), &cinit));
+    EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, 0, &cinfo));
+    EXRCORE_TEST_RVAL (exr_decoding_initialize (f, 0, &cinfo, &decoder));
+    for (int c = 0; c < decoder.channel_count; ++c)
+    {
+        decoder.channels[c].decode_to_ptr     = (uint8_t*) back[c].data ();
+        decoder.channels[c].user_pixel_stride = 4;
+        decoder.channels[c].user_line_stride  = 4 * w;
+    }
+    EXRCORE_TEST_RVAL (exr_decoding_choose_default_routines (f, 0, &decoder));
+    EXRCORE_TEST_RVAL (exr_decoding_run (f, 0, &decoder));
+    EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+
+    EXRCORE_TEST (back[0] == orig[0]);
+    EXRCORE_TEST (back[1] == orig[1]);
+    remove (filename.c_str ());
+}
+
+void
+testB44FloatChannels (const std::string& tempdir)
+{
+    std::string filename = tempdir + std::string ("imf_test_b44_float.exr");
+
+    doB44FloatChannels (filename, EXR_COMPRESSION_B44);
+    doB44FloatChannels (filename, EXR_COMPRESSION_B44A);
+}
+
 void
 testDWAACompression (const std::string& tempdir)
 {
@@ -1554,6 +2119,30 @@ testDWABCompression (const std::string& tempdir)
     //testComp (tempdir, EXR_COMPRESSION_DWAB);
 }
 
+void
+testZSTDCompression (const std::string& tempdir)
+{
+    if (!isSupportedCompression (ZSTD_COMPRESSION))
+    {
+        std::cout << "  zstd not available in this build, skipping"
+                  << std::endl;
+        return;
+    }
+    testComp (tempdir, EXR_COMPRESSION_ZSTD);
+}
+
+void
+testLZ4Compression (const std::string& tempdir)
+{
+    if (!isSupportedCompression (LZ4_COMPRESSION))
+    {
+        std::cout << "  lz4 not available in this build, skipping"
+                  << std::endl;
+        return;
+    }
+    testComp (tempdir, EXR_COMPRESSION_LZ4);
+}
+
 void
 testDeepNoCompression (const std::string& tempdir)
 {}
@@ -7,17 +7,24 @@
 #include <string>
 
 void testHUF (const std::string& tempdir);
+void testWAV (const std::string& tempdir);
+void testB44Blocks (const std::string& tempdir);
+void testPXR24Rows (const std::string& tempdir);
 
 void testNoCompression (const std::string& tempdir);
 void testRLECompression (const std::string& tempdir);
 void testZIPCompression (const std::string& tempdir);
 void testZIPSCompression (const std::string& tempdir);
 void testPIZCompression (const std::string& tempdir);
+void testPIZReduced (const std::string& tempdir);
 void testPXR24Compression (const std::string& tempdir);
 void testB44Compression (const std::string& tempdir);
 void testB44ACompression (const std::string& tempdir);
+void testB44FloatChannels (const std::string& tempdir);
 void testDWAACompression (const std::string& tempdir);
 void testDWABCompression (const std::string& tempdir);
+void testZSTDCompression (const std::string& tempdir);
+void testLZ4Compression (const std::string& tempdir);
 
 void testDeepNoCompression (const std::string& tempdir);
 void testDeepZIPCompression (const std::string& tempdir);
@@ -172,10 +172,13 @@ main (int argc, char* argv[])
     TEST (testReadMultiPart, "core_read");
     TEST (testReadDeep, "core_read");
     TEST (testReadUnpack, "core_read");
+    TEST (testReadStats, "core_read");
+    TEST (testReadTrace, "core_read");
 
     TEST (testWriteBadArgs, "core_write");
     TEST (testWriteBadFiles, "core_write");
     TEST (testUpdateMeta, "core_write");
+    TEST (testPaddedChunkTableRecovery, "core_write");
     TEST (testWriteBaseHeader, "core_write");
     TEST (testWriteAttrs, "core_write");
     TEST (testStartWriteScan, "core_write");
@@ -188,16 +191,23 @@ main (int argc, char* argv[])
     TEST (testWriteDeep, "core_write");
 
     TEST (testHUF, "core_compression");
+    TEST (testWAV, "core_compression");
+    TEST (testB44Blocks, "core_compression");
+    TEST (testPXR24Rows, "core_compression");
     TEST (testNoCompression, "core_compression");
     TEST (testRLECompression, "core_compression");
     TEST (testZIPCompression, "core_compression");
     TEST (testZIPSCompression, "core_compression");
     TEST (testPIZCompression, "core_compression");
+    TEST (testPIZReduced, "core_compression");
     TEST (testPXR24Compression, "core_compression");
     TEST (testB44Compression, "core_compression");
     TEST (testB44ACompression, "core_compression");
+    TEST (testB44FloatChannels, "core_compression");
     TEST (testDWAACompression, "core_compression");
     TEST (testDWABCompression, "core_compression");
+    TEST (testZSTDCompression, "core_compression");
+    TEST (testLZ4Compression, "core_compression");
 
     TEST (testDeepNoCompression, "core_compression");
     TEST (testDeepZIPCompression, "core_compression");
@@ -8,9 +8,12 @@
 #include <string.h>
 #include <time.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <IlmThreadPool.h>
@@ -23,6 +26,17 @@
 #include <ImfThreading.h>
 #include <openexr.h>
 
+#if defined(OPENEXR_ENABLE_API_VISIBILITY)
+#    include "../../lib/OpenEXRCore/internal_wav.c"
+#    include "../../lib/OpenEXRCore/internal_b44_block.c"
+#    include "../../lib/OpenEXRCore/internal_b44_table.c"
+#    include "../../lib/OpenEXRCore/internal_pxr24_row.c"
+#else
+#    include "../../lib/OpenEXRCore/internal_wav.h"
+#    include "../../lib/OpenEXRCore/internal_b44_block.h"
+#    include "../../lib/OpenEXRCore/internal_pxr24_row.h"
+#endif
+
 using namespace OPENEXR_IMF_NAMESPACE;
 using namespace ILMTHREAD_NAMESPACE;
 
@@ -394,11 +408,417 @@ readImf (
     }
 }
 
+////////////////////////////////////////
+//
+// PIZ wavelet micro benchmark: times the wavelet transform of the
+// planes of a 32 scanline PIZ chunk, comparing the scalar reference
+// with the (vectorized) one used by the library
+//
+
+typedef void (*wavFunc) (uint16_t*, int, int, int, int, uint16_t);
+
+static uint64_t
+timeWavelet (
+    wavFunc                f,
+    std::vector<uint16_t>& buf,
+    int                    nx,
+    int                    ox,
+    int                    ny,
+    uint16_t               mx,
+    int                    iters)
+{
+    auto start = std::chrono::steady_clock::now ();
+    for (int i = 0; i < iters; ++i)
+    {
+        for (int j = 0; j < ox; ++j)
+            f (buf.data () + j, nx, ox, ny, nx * ox, mx);
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds> (
+               std::chrono::steady_clock::now () - start)
+        .count ();
+}
+
+static int
+benchmarkWavelet ()
+{
+    const int ny    = 32;
+    const int iters = 2000;
+    struct
+    {
+        const char* name;
+        int         nx, ox;
+        uint16_t    mx;
+    } cases[] = {
+        {"half 1920 14-bit", 1920, 1, (1 << 14) - 1},
+        {"half 1920 16-bit", 1920, 1, 0xffff},
+        {"half 4096 14-bit", 4096, 1, (1 << 14) - 1},
+        {"float 1920 14-bit", 1920, 2, (1 << 14) - 1}};
+
+    std::cout << "PIZ wavelet, " << ny << " scanline chunk planes, "
+              << iters << " iterations, simd "
+              << (internal_wav_has_simd () ? "on" : "off") << "\n\n";
+    std::cout << std::setw (20) << std::left << " Case" << std::setw (12)
+              << "enc scalar" << std::setw (12) << "enc simd"
+              << std::setw (12) << "dec scalar" << std::setw (12)
+              << "dec simd"
+              << "speedup (enc / dec), ns per plane\n";
+
+    for (auto& c: cases)
+    {
+        size_t                n = (size_t) c.nx * (size_t) ny * (size_t) c.ox;
+        std::vector<uint16_t> orig (n), buf;
+
+        // smooth gradient plus some noise, as after the PIZ lut
+        for (size_t i = 0; i < n; ++i)
+            orig[i] = (uint16_t) (((i % (size_t) c.nx) * 7 +
+                                   (i / (size_t) c.nx) * 3 + (rand () & 63)) &
+                                  c.mx);
+
+        buf         = orig;
+        uint64_t es = timeWavelet (
+            &internal_wav_2D_encode_scalar, buf, c.nx, c.ox, ny, c.mx, iters);
+        buf         = orig;
+        uint64_t ev = timeWavelet (
+            &internal_wav_2D_encode, buf, c.nx, c.ox, ny, c.mx, iters);
+        buf         = orig;
+        uint64_t ds = timeWavelet (
+            &internal_wav_2D_decode_scalar, buf, c.nx, c.ox, ny, c.mx, iters);
+        buf         = orig;
+        uint64_t dv = timeWavelet (
+            &internal_wav_2D_decode, buf, c.nx, c.ox, ny, c.mx, iters);
+
+        std::cout << " " << std::setw (19) << std::left << c.name
+                  << std::setw (12) << es / iters << std::setw (12)
+                  << ev / iters << std::setw (12) << ds / iters
+                  << std::setw (12) << dv / iters << std::setprecision (3)
+                  << double (es) / double (ev) << " / "
+                  << double (ds) / double (dv) << "\n";
+    }
+
+    //
+    // the whole pyramid of a chunk plane is traversed once per level,
+    // so the cost per pixel stays flat only while the plane stays in
+    // cache. Sweep the width from an L1 sized plane to one larger than
+    // L2 to show where (if anywhere) a cache blocked traversal pays
+    //
+
+    std::cout << "\n"
+              << std::setw (20) << std::left << " Width" << std::setw (12)
+              << "plane KiB" << std::setw (12) << "enc ps/px"
+              << "dec ps/px\n";
+
+    for (int nx = 256; nx <= 65536; nx *= 4)
+    {
+        size_t                n     = (size_t) nx * (size_t) ny;
+        int                   count = (int) (((size_t) iters * 1920) / nx);
+        std::vector<uint16_t> orig (n), buf;
+
+        for (size_t i = 0; i < n; ++i)
+            orig[i] = (uint16_t) (((i % (size_t) nx) * 7 +
+                                   (i / (size_t) nx) * 3 + (rand () & 63)) &
+                                  0x3fff);
+
+        buf        = orig;
+        uint64_t e = timeWavelet (
+            &internal_wav_2D_encode, buf, nx, 1, ny, 0x3fff, count);
+        buf        = orig;
+        uint64_t d = timeWavelet (
+            &internal_wav_2D_decode, buf, nx, 1, ny, 0x3fff, count);
+        double px = double (n) * double (count) / 1000.0;
+
+        std::cout << " " << std::setw (19) << std::left << nx << std::setw (12)
+                  << n * sizeof (uint16_t) / 1024 << std::setw (12)
+                  << std::fixed << std::setprecision (0) << double (e) / px
+                  << double (d) / px << std::defaultfloat << "\n";
+    }
+    return 0;
+}
+
+////////////////////////////////////////
+//
+// B44 block micro benchmark: times packing and unpacking a row of
+// 4x4 blocks, comparing the scalar reference with the (vectorized)
+// one used by the library
+//
+
+static int
+benchmarkB44 ()
+{
+    const int iters = 2000;
+    struct
+    {
+        const char* name;
+        int         nx;
+        int         linear;
+    } cases[] = {
+        {"half 1920", 1920, 0},
+        {"half 1920 linear", 1920, 1},
+        {"half 3840", 3840, 0},
+        {"half 3840 linear", 3840, 1}};
+
+    std::cout << "B44 blocks, 4 scanline rows, " << iters
+              << " iterations, simd "
+              << (internal_b44_has_simd () ? "on" : "off") << "\n\n";
+    std::cout << std::setw (20) << std::left << " Case" << std::setw (12)
+              << "enc scalar" << std::setw (12) << "enc simd"
+              << std::setw (12) << "dec scalar" << std::setw (12)
+              << "dec simd"
+              << "speedup (enc / dec), ns per row\n";
+
+    for (auto& c: cases)
+    {
+        int                   nb = c.nx / 4;
+        std::vector<uint16_t> img (4 * (size_t) c.nx), out (img.size ());
+        std::vector<uint8_t>  comp (14 * (size_t) nb);
+        const uint16_t*       in[4];
+        uint16_t*             rows[4];
+        uint64_t              n = 0, t[4];
+
+        // smooth gradient plus some noise, around 1.0
+        for (size_t i = 0; i < img.size (); ++i)
+            img[i] = (uint16_t) (0x3c00 + (i % (size_t) c.nx) / 8 +
+                                 (rand () & 31));
+        for (int y = 0; y < 4; ++y)
+        {
+            in[y]   = img.data () + y * c.nx;
+            rows[y] = out.data () + y * c.nx;
+        }
+
+        for (int pass = 0; pass < 4; ++pass)
+        {
+            auto start = std::chrono::steady_clock::now ();
+            for (int i = 0; i < iters; ++i)
+            {
+                switch (pass)
+                {
+                    case 0:
+                        n = internal_b44_pack_blocks_scalar (
+                            in, nb, c.linear, 1, comp.data ());
+                        break;
+                    case 1:
+                        n = internal_b44_pack_blocks (
+                            in, nb, c.linear, 1, comp.data ());
+                        break;
+                    case 2:
+                        internal_b44_unpack_blocks_scalar (
+                            comp.data (), n, nb, c.linear, rows);
+                        break;
+                    default:
+                        internal_b44_unpack_blocks (
+                            comp.data (), n, nb, c.linear, rows);
+                        break;
+                }
+            }
+            t[pass] = std::chrono::duration_cast<std::chrono::nanoseconds> (
+                          std::chrono::steady_clock::now () - start)
+                          .count ();
+        }
+
+        std::cout << " " << std::setw (19) << std::left << c.name
+                  << std::setw (12) << t[0] / iters << std::setw (12)
+                  << t[1] / iters << std::setw (12) << t[2] / iters
+                  << std::setw (12) << t[3] / iters << std::setprecision (3)
+                  << double (t[0]) / double (t[1]) << " / "
+                  << double (t[2]) / double (t[3]) << "\n";
+    }
+    return 0;
+}
+
+////////////////////////////////////////
+//
+// PXR24 row micro benchmark: times splitting a scanline into the
+// predicted byte planes and merging it back, comparing the scalar
+// reference with the (vectorized) one used by the library
+//
+
+static int
+benchmarkPxr24 ()
+{
+    const int iters = 20000;
+    struct
+    {
+        const char*      name;
+        exr_pixel_type_t type;
+        int              nx;
+    } cases[] = {
+        {"uint 1920", EXR_PIXEL_UINT, 1920},
+        {"half 1920", EXR_PIXEL_HALF, 1920},
+        {"float 1920", EXR_PIXEL_FLOAT, 1920},
+        {"float 3840", EXR_PIXEL_FLOAT, 3840}};
+
+    std::cout << "PXR24 rows, " << iters << " iterations, simd "
+              << (internal_pxr24_has_simd () ? "on" : "off") << "\n\n";
+    std::cout << std::setw (20) << std::left << " Case" << std::setw (12)
+              << "enc scalar" << std::setw (12) << "enc simd"
+              << std::setw (12) << "dec scalar" << std::setw (12)
+              << "dec simd"
+              << "speedup (enc / dec), ns per row\n";
+
+    for (auto& c: cases)
+    {
+        size_t               n = 4 * (size_t) c.nx;
+        std::vector<uint8_t> row (n), planes (n), out (n);
+        uint64_t             t[4];
+
+        // smooth gradient plus some noise, around 1.0
+        for (int x = 0; x < c.nx; ++x)
+        {
+            float    f = 1.f + (float) x / (float) c.nx +
+                      (float) (rand () & 255) / 65536.f;
+            uint16_t h = (uint16_t) (0x3c00 + x / 8 + (rand () & 31));
+            if (c.type == EXR_PIXEL_HALF)
+                memcpy (row.data () + 2 * x, &h, 2);
+            else
+                memcpy (row.data () + 4 * x, &f, 4);
+        }
+
+        for (int pass = 0; pass < 4; ++pass)
+        {
+            auto start = std::chrono::steady_clock::now ();
+            for (int i = 0; i < iters; ++i)
+            {
+                switch (pass)
+                {
+                    case 0:
+                        internal_pxr24_split_row_scalar (
+                            c.type, row.data (), c.nx, planes.data ());
+                        break;
+                    case 1:
+                        internal_pxr24_split_row (
+                            c.type, row.data (), c.nx, planes.data ());
+                        break;
+                    case 2:
+                        internal_pxr24_merge_row_scalar (
+                            c.type, planes.data (), c.nx, out.data ());
+                        break;
+                    default:
+                        internal_pxr24_merge_row (
+                            c.type, planes.data (), c.nx, out.data ());
+                        break;
+                }
+            }
+            t[pass] = std::chrono::duration_cast<std::chrono::nanoseconds> (
+                          std::chrono::steady_clock::now () - start)
+                          .count ();
+        }
+
+        std::cout << " " << std::setw (19) << std::left << c.name
+                  << std::setw (12) << t[0] / iters << std::setw (12)
+                  << t[1] / iters << std::setw (12) << t[2] / iters
+                  << std::setw (12) << t[3] / iters << std::setprecision (3)
+                  << double (t[0]) / double (t[1]) << " / "
+                  << double (t[2]) / double (t[3]) << "\n";
+    }
+    return 0;
+}
+
+////////////////////////////////////////
+//
+// Thread pool contention benchmark: several threads at once add
+// many small tasks to one pool, as when many files with small
+// chunks are read concurrently, comparing the default provider
+// with the work-stealing one
+//
+
+class SpinTask : public Task
+{
+public:
+    SpinTask (TaskGroup* g, int spins, std::atomic<uint64_t>* sink)
+        : Task (g), _spins (spins), _sink (sink)
+    {}
+    void execute () override
+    {
+        uint64_t v = 0;
+        for (int i = 0; i < _spins; ++i)
+            v = v * 31 + (uint64_t) i;
+        _sink->fetch_add (v & 1, std::memory_order_relaxed);
+    }
+
+private:
+    int                    _spins;
+    std::atomic<uint64_t>* _sink;
+};
+
+static uint64_t
+timeThreadPool (ThreadPool& pool, int readers, int tasksPerReader, int spins)
+{
+    const int             chunksPerFile = 256;
+    std::atomic<uint64_t> sink (0);
+
+    auto                     start = std::chrono::steady_clock::now ();
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r)
+    {
+        threads.emplace_back ([&] () {
+            // one task group per file, like readPixels
+            for (int done = 0; done < tasksPerReader; done += chunksPerFile)
+            {
+                TaskGroup group;
+                for (int c = 0; c < chunksPerFile; ++c)
+                    pool.addTask (new SpinTask (&group, spins, &sink));
+            }
+        });
+    }
+    for (auto& t: threads)
+        t.join ();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds> (
+               std::chrono::steady_clock::now () - start)
+        .count ();
+}
+
+static int
+benchmarkThreadPool ()
+{
+    const int tasksPerReader = 256 * 64;
+    int       nthreads =
+        std::max (2, (int) ThreadPool::estimateThreadCountForFileIO ());
+    struct
+    {
+        const char* name;
+        int         readers;
+        int         spins;
+    } cases[] = {
+        {"1 reader, tiny", 1, 50},
+        {"4 readers, tiny", 4, 50},
+        {"16 readers, tiny", 16, 50},
+        {"16 readers, small", 16, 5000}};
+
+    std::cout << "Thread pool, " << nthreads << " threads, "
+              << tasksPerReader << " tasks per reader\n\n";
+    std::cout << std::setw (20) << std::left << " Case" << std::setw (12)
+              << "default" << std::setw (12) << "stealing"
+              << "speedup, ns per task\n";
+
+    ThreadPool defaultPool (nthreads);
+    ThreadPool stealingPool (nthreads);
+    stealingPool.setThreadProvider (
+        new WorkStealingThreadPoolProvider (nthreads));
+
+    for (auto& c: cases)
+    {
+        uint64_t tasks = (uint64_t) c.readers * (uint64_t) tasksPerReader;
+        uint64_t td =
+            timeThreadPool (defaultPool, c.readers, tasksPerReader, c.spins);
+        uint64_t ts =
+            timeThreadPool (stealingPool, c.readers, tasksPerReader, c.spins);
+
+        std::cout << " " << std::setw (19) << std::left << c.name
+                  << std::setw (12) << td / tasks << std::setw (12)
+                  << ts / tasks << std::setprecision (3)
+                  << double (td) / double (ts) << "\n";
+    }
+    return 0;
+}
+
 static int
 usageAndExit (const char* argv0, int ec)
 {
-    std::cerr << "Usage: " << argv0 << "[--imf|--core] <file1> [<file2>...]"
-              << std::endl;
+    std::cerr << "Usage: " << argv0 << "[--imf|--core] <file1> [<file2>...]\n"
+              << "       " << argv0 << " --wavelet" << std::endl
+              << "       " << argv0 << " --b44" << std::endl
+              << "       " << argv0 << " --pxr24" << std::endl
+              << "       " << argv0 << " --pool" << std::endl;
     return ec;
 }
 
@@ -424,6 +844,22 @@ main (int argc, char* argv[])
                 return usageAndExit (argv[0], 1);
             }
         }
+        else if (!strcmp (argv[a], "--wavelet"))
+        {
+            return benchmarkWavelet ();
+        }
+        else if (!strcmp (argv[a], "--b44"))
+        {
+            return benchmarkB44 ();
+        }
+        else if (!strcmp (argv[a], "--pxr24"))
+        {
+            return benchmarkPxr24 ();
+        }
+        else if (!strcmp (argv[a], "--pool"))
+        {
+            return benchmarkThreadPool ();
+        }
         else if (!strcmp (argv[a], "--core"))
         {
             coreOnly = true;
@@ -12,9 +12,13 @@
 #include <math.h>
 #include <string.h>
 
+#include <atomic>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <sstream>
+#include <vector>
 
 static void
 err_cb (exr_const_context_t f, int code, const char* msg)
@@ -590,3 +594,183 @@ testReadUnpack (const std::string& tempdir)
 
     exr_finish (&f);
 }
+
+static void
+decodeAllScanlines (exr_context_t f, uint64_t& nchunks, uint64_t& nbytes)
+{
+    exr_attr_box2i_t dw;
+    int32_t          lpc;
+    EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+    EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &lpc));
+
+    nchunks = 0;
+    nbytes  = 0;
+    for (int y = dw.min.y; y <= dw.max.y; y += lpc)
+    {
+        exr_chunk_info_t      cinfo;
+        exr_decode_pipeline_t decoder;
+
+        EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+        EXRCORE_TEST_RVAL (exr_decoding_initialize (f, 0, &cinfo, &decoder));
+
+        std::vector<std::unique_ptr<uint8_t[]>> bufs;
+        for (int c = 0; c < decoder.channel_count; ++c)
+        {
+            exr_coding_channel_info_t& ch = decoder.channels[c];
+            bufs.emplace_back (new uint8_t
+                                   [(size_t) ch.width * (size_t) ch.height *
+                                    (size_t) ch.bytes_per_element]);
+            ch.decode_to_ptr     = bufs.back ().get ();
+            ch.user_pixel_stride = ch.bytes_per_element;
+            ch.user_line_stride  = ch.width * ch.bytes_per_element;
+        }
+
+        EXRCORE_TEST_RVAL (
+            exr_decoding_choose_default_routines (f, 0, &decoder));
+        EXRCORE_TEST_RVAL (exr_decoding_run (f, 0, &decoder));
+        EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
+
+        ++nchunks;
+        nbytes += cinfo.packed_size;
+    }
+}
+
+void
+testReadStats (const std::string& tempdir)
+{
+    exr_context_t             f;
+    std::string               fn    = ILM_IMF_TEST_IMAGEDIR;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    exr_pipeline_stats_t      stats;
+    cinit.error_handler_fn          = &err_cb;
+
+    fn += "comp_zip.exr";
+
+    /* off by default */
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_MISSING_CONTEXT_ARG, exr_get_pipeline_stats (NULL, 0, &stats));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_ARGUMENT_OUT_OF_RANGE, exr_get_pipeline_stats (f, 1, &stats));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_ARGUMENT_OUT_OF_RANGE, exr_get_pipeline_stats (f, -2, &stats));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT, exr_get_pipeline_stats (f, 0, NULL));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_ARGUMENT_OUT_OF_RANGE, exr_reset_pipeline_stats (f, 1));
+    exr_finish (&f);
+
+    cinit.flags |= EXR_CONTEXT_FLAG_COLLECT_STATS;
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+
+    uint64_t nchunks, nbytes;
+    decodeAllScanlines (f, nchunks, nbytes);
+
+    EXRCORE_TEST_RVAL (exr_get_pipeline_stats (f, 0, &stats));
+    EXRCORE_TEST (stats.chunks_read == nchunks);
+    EXRCORE_TEST (stats.bytes_read == nbytes);
+    EXRCORE_TEST (stats.chunks_written == 0);
+    EXRCORE_TEST (stats.bytes_written == 0);
+    EXRCORE_TEST (stats.buffer_allocations > 0);
+    EXRCORE_TEST (
+        stats.decompress_ns ==
+        stats.decompress_ns_by_codec[EXR_COMPRESSION_ZIP]);
+    EXRCORE_TEST (stats.compress_ns == 0);
+    EXRCORE_TEST (stats.chunk_table_reconstructions == 0);
+    EXRCORE_TEST (stats.codec_count == EXR_COMPRESSION_LAST_TYPE);
+
+    exr_pipeline_stats_t all;
+    EXRCORE_TEST_RVAL (exr_get_pipeline_stats (f, -1, &all));
+    EXRCORE_TEST (all.chunks_read == stats.chunks_read);
+
+    EXRCORE_TEST_RVAL (exr_reset_pipeline_stats (f, -1));
+    EXRCORE_TEST_RVAL (exr_get_pipeline_stats (f, 0, &stats));
+    EXRCORE_TEST (stats.chunks_read == 0);
+    EXRCORE_TEST (stats.bytes_read == 0);
+    EXRCORE_TEST (stats.decompress_ns == 0);
+    EXRCORE_TEST (stats.buffer_allocations == 0);
+
+    exr_finish (&f);
+}
+
+struct TraceCounts
+{
+    std::atomic<int> begins{0};
+    std::atomic<int> ends{0};
+    std::atomic<int> bad{0};
+};
+
+static void
+trace_cb (exr_const_context_t, const exr_trace_event_t* ev, void* ud)
+{
+    TraceCounts* tc = static_cast<TraceCounts*> (ud);
+    if (ev->begin)
+        ++tc->begins;
+    else
+        ++tc->ends;
+    if (ev->part_index != 0 || ev->compression != EXR_COMPRESSION_ZIP ||
+        ev->stage > EXR_TRACE_STAGE_UNPACK || ev->result != EXR_ERR_SUCCESS ||
+        ev->chunk_index < 0 || ev->thread_id == 0 || !ev->filename)
+        ++tc->bad;
+}
+
+void
+testReadTrace (const std::string& tempdir)
+{
+    exr_context_t             f;
+    std::string               fn    = ILM_IMF_TEST_IMAGEDIR;
+    std::string               tfn   = tempdir + "trace.json";
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    TraceCounts               counts;
+    exr_chrome_trace_t        trace;
+    uint64_t                  nchunks, nbytes;
+    cinit.error_handler_fn          = &err_cb;
+
+    fn += "comp_zip.exr";
+
+    EXRCORE_TEST (
+        std::string ("decompress") ==
+        exr_get_trace_stage_name (EXR_TRACE_STAGE_DECOMPRESS));
+    EXRCORE_TEST (
+        std::string ("<unknown>") ==
+        exr_get_trace_stage_name (EXR_TRACE_STAGE_LAST_TYPE));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_MISSING_CONTEXT_ARG,
+        exr_set_trace_callback (NULL, &trace_cb, &counts));
+
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+    EXRCORE_TEST_RVAL (exr_set_trace_callback (f, &trace_cb, &counts));
+    decodeAllScanlines (f, nchunks, nbytes);
+    EXRCORE_TEST (counts.begins == (int) nchunks * 3);
+    EXRCORE_TEST (counts.ends == counts.begins);
+    EXRCORE_TEST (counts.bad == 0);
+
+    EXRCORE_TEST_RVAL (exr_chrome_trace_start (&trace, tfn.c_str ()));
+    EXRCORE_TEST_RVAL (
+        exr_set_trace_callback (f, &exr_chrome_trace_callback, trace));
+    decodeAllScanlines (f, nchunks, nbytes);
+    EXRCORE_TEST_RVAL (exr_set_trace_callback (f, NULL, NULL));
+    decodeAllScanlines (f, nchunks, nbytes);
+    EXRCORE_TEST (counts.begins == (int) nchunks * 3);
+    exr_finish (&f);
+    EXRCORE_TEST_RVAL (exr_chrome_trace_finish (&trace));
+    EXRCORE_TEST (trace == NULL);
+
+    std::ifstream     tf (tfn);
+    std::stringstream ss;
+    ss << tf.rdbuf ();
+    std::string txt = ss.str ();
+    size_t      nb = 0, ne = 0;
+    for (size_t p = txt.find ("\"ph\":\"B\""); p != std::string::npos;
+         p        = txt.find ("\"ph\":\"B\"", p + 1))
+        ++nb;
+    for (size_t p = txt.find ("\"ph\":\"E\""); p != std::string::npos;
+         p        = txt.find ("\"ph\":\"E\"", p + 1))
+        ++ne;
+    EXRCORE_TEST (txt.compare (0, 2, "[\n") == 0);
+    EXRCORE_TEST (txt.compare (txt.size () - 2, 2, "]\n") == 0);
+    EXRCORE_TEST (nb == nchunks * 3);
+    EXRCORE_TEST (ne == nb);
+    EXRCORE_TEST (txt.find ("comp_zip.exr") != std::string::npos);
+    remove (tfn.c_str ());
+}
@@ -21,5 +21,7 @@ void testReadTiles (const std::string& tempdir);
 void testReadMultiPart (const std::string& tempdir);
 
 void testReadUnpack (const std::string& tempdir);
+void testReadStats (const std::string& tempdir);
+void testReadTrace (const std::string& tempdir);
 
 #endif // OPENEXR_CORE_TEST_READ_H
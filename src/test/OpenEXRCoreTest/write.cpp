@@ -10,11 +10,13 @@
 #include <float.h>
 #include <limits.h>
 #include <math.h>
+#include <stdio.h>
 #include <string.h>
 
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 static void
 err_cb (exr_const_context_t f, exr_result_t code, const char* msg)
@@ -1242,9 +1244,270 @@ testWriteAttrs (const std::string& tempdir)
     remove (outfn.c_str ());
 }
 
+static std::vector<uint8_t>
+readFirstChunk (const std::string& fn, exr_context_initializer_t& cinit)
+{
+    exr_context_t        f;
+    exr_chunk_info_t     cinfo;
+    std::vector<uint8_t> ret;
+
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+    EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, 0, &cinfo));
+    ret.resize (cinfo.packed_size);
+    EXRCORE_TEST_RVAL (exr_read_chunk (f, 0, &cinfo, ret.data ()));
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+    return ret;
+}
+
 void
 testUpdateMeta (const std::string& tempdir)
-{}
+{
+    exr_context_t outf;
+    std::string   outfn = tempdir + "testupdatemeta.exr";
+    int           partidx;
+    const char*   sval;
+
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &err_cb;
+
+    EXRCORE_TEST_RVAL (exr_start_write (
+        &outf, outfn.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+    EXRCORE_TEST_RVAL (
+        exr_add_part (outf, "tester", EXR_STORAGE_SCANLINE, &partidx));
+    EXRCORE_TEST_RVAL (exr_initialize_required_attr_simple (
+        outf, partidx, 1, 1, EXR_COMPRESSION_NONE));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        outf, partidx, "Y", EXR_PIXEL_HALF, EXR_PERCEPTUALLY_LOGARITHMIC, 1, 1));
+    EXRCORE_TEST_RVAL (exr_attr_set_string (outf, partidx, "owner", "me"));
+
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_MISSING_CONTEXT_ARG, exr_set_header_padding (NULL, 64));
+    EXRCORE_TEST_RVAL (exr_set_header_padding (outf, 64));
+    EXRCORE_TEST_RVAL (exr_write_header (outf));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_NOT_OPEN_WRITE, exr_set_header_padding (outf, 64));
+
+    exr_chunk_info_t cinfo;
+    EXRCORE_TEST_RVAL (exr_write_scanline_chunk_info (outf, 0, 0, &cinfo));
+    exr_encode_pipeline_t encoder;
+    EXRCORE_TEST_RVAL (exr_encoding_initialize (outf, 0, &cinfo, &encoder));
+    const uint16_t y                      = 0x3c00;
+    encoder.channels[0].encode_from_ptr   = (const uint8_t*) &y;
+    encoder.channels[0].user_pixel_stride = 2;
+    encoder.channels[0].user_line_stride  = 2;
+    EXRCORE_TEST_RVAL (
+        exr_encoding_choose_default_routines (outf, 0, &encoder));
+    EXRCORE_TEST_RVAL (exr_encoding_run (outf, 0, &encoder));
+    EXRCORE_TEST_RVAL (exr_encoding_destroy (outf, &encoder));
+    EXRCORE_TEST_RVAL (exr_finish (&outf));
+
+    std::vector<uint8_t> origchunk = readFirstChunk (outfn, cinit);
+
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_start_inplace_header_update (NULL, outfn.c_str (), &cinit));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_start_inplace_header_update (&outf, NULL, &cinit));
+
+    /* grow the header into the reserved space */
+    EXRCORE_TEST_RVAL (
+        exr_start_inplace_header_update (&outf, outfn.c_str (), &cinit));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_NOT_OPEN_WRITE,
+        exr_set_compression (outf, 0, EXR_COMPRESSION_ZIP));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_NOT_OPEN_WRITE,
+        exr_add_channel (
+            outf, 0, "A", EXR_PIXEL_HALF, EXR_PERCEPTUALLY_LINEAR, 1, 1));
+    EXRCORE_TEST_RVAL (exr_attr_set_string (outf, 0, "owner", "someone"));
+    EXRCORE_TEST_RVAL (exr_attr_set_int (outf, 0, "take", 42));
+    EXRCORE_TEST_RVAL (exr_write_header (outf));
+    EXRCORE_TEST_RVAL (exr_finish (&outf));
+
+    EXRCORE_TEST_RVAL (exr_start_read (&outf, outfn.c_str (), &cinit));
+    EXRCORE_TEST_RVAL (exr_attr_get_string (outf, 0, "owner", NULL, &sval));
+    EXRCORE_TEST (std::string (sval) == "someone");
+    int32_t ival = 0;
+    EXRCORE_TEST_RVAL (exr_attr_get_int (outf, 0, "take", &ival));
+    EXRCORE_TEST (ival == 42);
+    EXRCORE_TEST_RVAL (exr_finish (&outf));
+    EXRCORE_TEST (readFirstChunk (outfn, cinit) == origchunk);
+
+    /* too big for the reserved space, file must be untouched */
+    EXRCORE_TEST_RVAL (
+        exr_start_inplace_header_update (&outf, outfn.c_str (), &cinit));
+    EXRCORE_TEST_RVAL (exr_attr_set_string (
+        outf, 0, "owner", std::string (128, 'x').c_str ()));
+    EXRCORE_TEST_RVAL_FAIL (EXR_ERR_MODIFY_SIZE_CHANGE, exr_write_header (outf));
+    EXRCORE_TEST_RVAL (exr_finish (&outf));
+
+    /* and shrinking is always fine */
+    EXRCORE_TEST_RVAL (
+        exr_start_inplace_header_update (&outf, outfn.c_str (), &cinit));
+    EXRCORE_TEST_RVAL (exr_attr_get_string (outf, 0, "owner", NULL, &sval));
+    EXRCORE_TEST (std::string (sval) == "someone");
+    EXRCORE_TEST_RVAL (exr_attr_set_string (outf, 0, "owner", "us"));
+    EXRCORE_TEST_RVAL (exr_write_header (outf));
+    EXRCORE_TEST_RVAL (exr_finish (&outf));
+
+    EXRCORE_TEST_RVAL (exr_start_read (&outf, outfn.c_str (), &cinit));
+    EXRCORE_TEST_RVAL (exr_attr_get_string (outf, 0, "owner", NULL, &sval));
+    EXRCORE_TEST (std::string (sval) == "us");
+    EXRCORE_TEST_RVAL (exr_finish (&outf));
+    EXRCORE_TEST (readFirstChunk (outfn, cinit) == origchunk);
+
+    remove (outfn.c_str ());
+}
+
+/* an 8x8 image of scan lines, and for multi-part files a second part
+ * of 4x4 tiles, with one chunk per line or tile and nothing
+ * compressed */
+static void
+writePaddedFile (
+    const std::string&         fn,
+    exr_context_initializer_t& cinit,
+    bool                       multipart,
+    uint32_t                   padding)
+{
+    exr_context_t f;
+    int           partidx;
+    uint16_t      pixels[32];
+
+    EXRCORE_TEST_RVAL (
+        exr_start_write (&f, fn.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+    for (int p = 0; p < (multipart ? 2 : 1); ++p)
+    {
+        EXRCORE_TEST_RVAL (exr_add_part (
+            f,
+            p == 0 ? "scans" : "tiles",
+            p == 0 ? EXR_STORAGE_SCANLINE : EXR_STORAGE_TILED,
+            &partidx));
+        EXRCORE_TEST_RVAL (exr_initialize_required_attr_simple (
+            f, partidx, 8, 8, EXR_COMPRESSION_NONE));
+        EXRCORE_TEST_RVAL (exr_add_channel (
+            f,
+            partidx,
+            "Y",
+            EXR_PIXEL_HALF,
+            EXR_PERCEPTUALLY_LOGARITHMIC,
+            1,
+            1));
+        if (p == 1)
+        {
+            EXRCORE_TEST_RVAL (exr_set_tile_descriptor (
+                f, partidx, 4, 4, EXR_TILE_ONE_LEVEL, EXR_TILE_ROUND_DOWN));
+        }
+    }
+    EXRCORE_TEST_RVAL (exr_set_header_padding (f, padding));
+    EXRCORE_TEST_RVAL (exr_write_header (f));
+
+    for (int y = 0; y < 8; ++y)
+    {
+        for (int x = 0; x < 8; ++x)
+            pixels[x] = (uint16_t) (y * 8 + x);
+        EXRCORE_TEST_RVAL (exr_write_scanline_chunk (f, 0, y, pixels, 16));
+    }
+
+    if (multipart)
+    {
+        for (int t = 0; t < 4; ++t)
+        {
+            for (int i = 0; i < 16; ++i)
+                pixels[i] = (uint16_t) (100 + t * 16 + i);
+            EXRCORE_TEST_RVAL (
+                exr_write_tile_chunk (f, 1, t % 2, t / 2, 0, 0, pixels, 32));
+        }
+    }
+
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+}
+
+/* returns the packed data of every chunk, and where the first one
+ * starts, leader included */
+static std::vector<std::vector<uint8_t>>
+readAllChunks (
+    const std::string&         fn,
+    exr_context_initializer_t& cinit,
+    uint64_t*                  firstchunk)
+{
+    exr_context_t                     f;
+    exr_chunk_info_t                  cinfo;
+    int                               nparts;
+    std::vector<std::vector<uint8_t>> ret;
+
+    *firstchunk = UINT64_MAX;
+
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+    EXRCORE_TEST_RVAL (exr_get_count (f, &nparts));
+    for (int p = 0; p < nparts; ++p)
+    {
+        uint64_t leadersz = (nparts > 1 ? 4 : 0) + (p == 0 ? 8 : 20);
+        for (int c = 0; c < (p == 0 ? 8 : 4); ++c)
+        {
+            if (p == 0)
+            {
+                EXRCORE_TEST_RVAL (
+                    exr_read_scanline_chunk_info (f, p, c, &cinfo));
+            }
+            else
+            {
+                EXRCORE_TEST_RVAL (exr_read_tile_chunk_info (
+                    f, p, c % 2, c / 2, 0, 0, &cinfo));
+            }
+            if (cinfo.data_offset - leadersz < *firstchunk)
+                *firstchunk = cinfo.data_offset - leadersz;
+
+            ret.push_back (std::vector<uint8_t> (cinfo.packed_size));
+            EXRCORE_TEST_RVAL (
+                exr_read_chunk (f, p, &cinfo, ret.back ().data ()));
+        }
+    }
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+    return ret;
+}
+
+void
+testPaddedChunkTableRecovery (const std::string& tempdir)
+{
+    std::string fn = tempdir + "testpaddedrecovery.exr";
+
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &err_cb;
+
+    for (int multipart = 0; multipart <= 1; ++multipart)
+    {
+        /* an odd padding, so the first chunk is not aligned */
+        for (uint32_t padding: {0u, 37u, 5000u})
+        {
+            uint64_t firstchunk, recovered;
+            uint64_t tablebytes = 8 * (multipart ? 12 : 8);
+
+            writePaddedFile (fn, cinit, multipart != 0, padding);
+            std::vector<std::vector<uint8_t>> orig =
+                readAllChunks (fn, cinit, &firstchunk);
+
+            /* the offset tables end where the padding starts: lose them
+             * the way a writer that crashes before finishing does */
+            FILE* fp = fopen (fn.c_str (), "r+b");
+            EXRCORE_TEST (fp != NULL);
+            EXRCORE_TEST (
+                fseek (
+                    fp,
+                    (long) (firstchunk - padding - tablebytes),
+                    SEEK_SET) == 0);
+            std::vector<uint8_t> zeros (tablebytes, 0);
+            EXRCORE_TEST (
+                fwrite (zeros.data (), 1, tablebytes, fp) == tablebytes);
+            fclose (fp);
+
+            EXRCORE_TEST (readAllChunks (fn, cinit, &recovered) == orig);
+            EXRCORE_TEST (recovered == firstchunk);
+        }
+    }
+
+    remove (fn.c_str ());
+}
 
 void
 testWriteScans (const std::string& tempdir)
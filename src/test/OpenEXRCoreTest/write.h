@@ -18,6 +18,7 @@ void testStartWriteDeepScan (const std::string& tempdir);
 void testStartWriteDeepTile (const std::string& tempdir);
 
 void testUpdateMeta (const std::string& tempdir);
+void testPaddedChunkTableRecovery (const std::string& tempdir);
 
 void testWriteScans (const std::string& tempdir);
 void testWriteTiles (const std::string& tempdir);
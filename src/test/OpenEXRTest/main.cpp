@@ -30,6 +30,7 @@
 #include "testDeepTiledBasic.h"
 #include "testDwaCompressorSimd.h"
 #include "testDwaLookups.h"
+#include "testDwaProxy.h"
 #include "testExistingStreams.h"
 #include "testFutureProofing.h"
 #include "testHuf.h"
@@ -59,6 +60,7 @@
 #include "testScanLineApi.h"
 #include "testSharedFrameBuffer.h"
 #include "testStandardAttributes.h"
+#include "testTaskPriority.h"
 #include "testTiledCompression.h"
 #include "testTiledCopyPixels.h"
 #include "testTiledLineOrder.h"
@@ -184,6 +186,7 @@ main (int argc, char* argv[])
     TEST (testLargeDataWindowOffsets, "basic");
     TEST (testSharedFrameBuffer, "basic");
     TEST (testRgbaThreading, "basic");
+    TEST (testTaskPriority, "basic");
     TEST (testChannels, "basic");
     TEST (testAttributes, "core");
     TEST (testCustomAttributes, "core");
@@ -230,6 +233,7 @@ main (int argc, char* argv[])
     TEST (testRle, "core");
     TEST (testB44ExpLogTable, "core");
     TEST (testDwaLookups, "core");
+    TEST (testDwaProxy, "basic");
     TEST (testIDManifest, "core");
     TEST (testCpuId, "core");
 
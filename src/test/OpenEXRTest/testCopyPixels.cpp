@@ -9,6 +9,7 @@
 
 #include <ImfArray.h>
 #include <ImfChannelList.h>
+#include <ImfCompressor.h>
 #include <ImfFrameBuffer.h>
 #include <ImfHeader.h>
 #include <ImfInputFile.h>
@@ -177,6 +178,8 @@ writeCopyRead (
 
     for (int comp = 0; comp < NUM_COMPRESSION_METHODS; ++comp)
     {
+        if (!isSupportedCompression (Compression (comp))) { continue; }
+
         writeCopyRead (
             ph,
             filename1.c_str (),
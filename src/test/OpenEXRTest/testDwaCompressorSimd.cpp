@@ -252,12 +252,53 @@ testDct ()
             orig._buffer[i] = test._buffer[i] = rand48.nextf ();
         }
 
-        dctForward8x8 (test._buffer);
+        if (iter & 1)
+            dctForward8x8_scalar (test._buffer);
+        else
+            dctForward8x8_sse2 (test._buffer);
+
         dctInverse8x8_scalar<0> (test._buffer);
 
         compareBufferRelative (orig, test, .02, 1e-3);
     }
 
+    CpuId cpuid;
+    if (cpuid.avx)
+    {
+        //
+        // The forward transform determines the encoded output, so
+        // the AVX version needs to match the SSE2 version exactly
+        //
+
+        SimdAlignedBuffer64f testAvx;
+
+        cout << "      Forward, AVX" << endl;
+        for (int iter = 0; iter < numIter; ++iter)
+        {
+            float scale = (iter & 1) ? 65504.f : 1.f;
+
+            for (int i = 0; i < 64; ++i)
+            {
+                test._buffer[i] = testAvx._buffer[i] =
+                    scale * (rand48.nextf () - .5f);
+            }
+
+            dctForward8x8_sse2 (test._buffer);
+            dctForward8x8_avx (testAvx._buffer);
+
+            if (memcmp (test._buffer, testAvx._buffer, 64 * sizeof (float)))
+            {
+                cout << "Forward AVX DCT differs from SSE2" << endl;
+                cout << "Goal (sse2): " << scientific << endl;
+                dumpBuffer (test);
+                cout << "Test (avx): " << endl;
+                dumpBuffer (testAvx);
+
+                assert (false);
+            }
+        }
+    }
+
     cout << "      Inverse, DC Only" << endl;
     for (int iter = 0; iter < numIter; ++iter)
     {
@@ -303,7 +344,6 @@ testDct ()
     INVERSE_DCT_SCALAR_TEST_N (dctInverse8x8_scalar, 6, "2x8")
     INVERSE_DCT_SCALAR_TEST_N (dctInverse8x8_scalar, 7, "1x8")
 
-    CpuId cpuid;
     if (cpuid.sse2)
     {
         cout << "      Inverse, SSE2: " << endl;
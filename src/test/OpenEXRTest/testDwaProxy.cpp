@@ -0,0 +1,296 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include <ImathRandom.h>
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfInputFile.h>
+#include <ImfOutputFile.h>
+#include <assert.h>
+#include <half.h>
+#include <iostream>
+#include <stdio.h>
+#include <vector>
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace IMATH_NAMESPACE;
+using namespace std;
+
+namespace
+{
+
+//
+// A is RLE, R, G and B are a CSC set, Y is a single lossy
+// channel and Z is UNKNOWN
+//
+
+const int         numChans           = 6;
+const char* const chanNames[numChans] = {"A", "B", "G", "R", "Y", "Z"};
+const PixelType   chanTypes[numChans] = {HALF, HALF, HALF, HALF, FLOAT, HALF};
+
+struct Image
+{
+    vector<half>  h[numChans];
+    vector<float> f[numChans];
+
+    Image (int numPixels)
+    {
+        for (int c = 0; c < numChans; ++c)
+        {
+            if (chanTypes[c] == FLOAT)
+                f[c].resize (numPixels);
+            else
+                h[c].resize (numPixels);
+        }
+    }
+
+    //
+    // A frame buffer for the image, which has w pixels per
+    // row and its pixel (0, 0) at (x0, y0)
+    //
+
+    FrameBuffer frameBuffer (int w, int x0, int y0, int numChannels)
+    {
+        FrameBuffer fb;
+
+        for (int c = 0; c < numChannels; ++c)
+        {
+            if (chanTypes[c] == FLOAT)
+            {
+                fb.insert (
+                    chanNames[c],
+                    Slice (
+                        FLOAT,
+                        (char*) (&f[c][0] - x0 - y0 * w),
+                        sizeof (float),
+                        sizeof (float) * w));
+            }
+            else
+            {
+                fb.insert (
+                    chanNames[c],
+                    Slice (
+                        HALF,
+                        (char*) (&h[c][0] - x0 - y0 * w),
+                        sizeof (half),
+                        sizeof (half) * w));
+            }
+        }
+
+        return fb;
+    }
+
+    float value (int c, int i) const
+    {
+        return chanTypes[c] == FLOAT ? f[c][i] : (float) h[c][i];
+    }
+};
+
+//
+// Write an image made of 8x8 blocks of constant values, so the
+// lossy channels decode from their DC components only.  The proxy
+// image must then match every 8th pixel of the full decode
+// exactly, for lossy and lossless channels alike.  With noise, the
+// image only has channel A, filled with random values, so that the
+// chunks do not compress and are stored as they are.
+//
+// Partial blocks at the edges are mirrored when encoding, so they
+// need at least 5 pixels to stay constant.
+//
+
+void
+testProxy (
+    const string& fileName,
+    Compression   comp,
+    int           width,
+    int           height,
+    bool          noise)
+{
+    cout << "compression " << comp << ", " << width << " x " << height
+         << (noise ? ", noise" : "") << endl;
+
+    Box2i dw (V2i (-3, 11), V2i (width - 4, height + 10));
+    int   numChannels = noise ? 1 : numChans;
+
+    Header hdr (width, height);
+    hdr.dataWindow ()  = dw;
+    hdr.compression () = comp;
+
+    for (int c = 0; c < numChannels; ++c)
+        hdr.channels ().insert (chanNames[c], Channel (chanTypes[c]));
+
+    Image  orig (width * height);
+    Rand48 rand48 (height);
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                int   i = y * width + x;
+                float v;
+
+                if (noise)
+                    v = rand48.nextf (0.0, 4.0);
+                else if (x % 8 == 0 && y % 8 == 0)
+                    v = rand48.nextf (0.0, 4.0);
+                else
+                    v = orig.value (c, (y & ~7) * width + (x & ~7));
+
+                if (chanTypes[c] == FLOAT)
+                    orig.f[c][i] = v;
+                else
+                    orig.h[c][i] = v;
+            }
+        }
+    }
+
+    {
+        OutputFile out (fileName.c_str (), hdr);
+        out.setFrameBuffer (
+            orig.frameBuffer (width, dw.min.x, dw.min.y, numChannels));
+        out.writePixels (height);
+    }
+
+    InputFile in (fileName.c_str ());
+
+    Image full (width * height);
+    in.setFrameBuffer (
+        full.frameBuffer (width, dw.min.x, dw.min.y, numChannels));
+    in.readPixels (dw.min.y, dw.max.y);
+
+    int proxyWidth  = (width + 7) / 8;
+    int proxyHeight = (height + 7) / 8;
+
+    //
+    // Also read G as FLOAT, and a channel the file does not have
+    //
+
+    Image         proxy (proxyWidth * proxyHeight);
+    FrameBuffer   fb = proxy.frameBuffer (proxyWidth, 0, 0, numChannels);
+    vector<float> g (proxyWidth * proxyHeight);
+    vector<float> missing (proxyWidth * proxyHeight);
+
+    if (!noise)
+    {
+        fb.insert (
+            "G",
+            Slice (
+                FLOAT,
+                (char*) &g[0],
+                sizeof (float),
+                sizeof (float) * proxyWidth));
+    }
+
+    fb.insert (
+        "missing",
+        Slice (
+            FLOAT,
+            (char*) &missing[0],
+            sizeof (float),
+            sizeof (float) * proxyWidth,
+            1,
+            1,
+            0.5));
+
+    in.readProxyPixels (fb);
+
+    for (int y = 0; y < proxyHeight; ++y)
+    {
+        for (int x = 0; x < proxyWidth; ++x)
+        {
+            int i = y * proxyWidth + x;
+            int j = 8 * y * width + 8 * x;
+
+            for (int c = 0; c < numChannels; ++c)
+            {
+                float v = (!noise && c == 2) ? g[i] : proxy.value (c, i);
+
+                if (v != full.value (c, j))
+                {
+                    cout << "proxy pixel " << x << ", " << y << " of channel "
+                         << chanNames[c] << " differs from the full decode"
+                         << endl;
+                    assert (false);
+                }
+            }
+
+            assert (missing[i] == 0.5);
+        }
+    }
+
+    remove (fileName.c_str ());
+}
+
+void
+testUnsupported (const string& fileName)
+{
+    cout << "unsupported compression" << endl;
+
+    Header hdr (16, 16);
+    hdr.compression () = ZIP_COMPRESSION;
+    hdr.channels ().insert ("Y", Channel (HALF));
+
+    vector<half> pixels (16 * 16);
+    FrameBuffer  fb;
+    fb.insert (
+        "Y",
+        Slice (HALF, (char*) &pixels[0], sizeof (half), sizeof (half) * 16));
+
+    {
+        OutputFile out (fileName.c_str (), hdr);
+        out.setFrameBuffer (fb);
+        out.writePixels (16);
+    }
+
+    InputFile in (fileName.c_str ());
+    bool      caught = false;
+
+    try
+    {
+        in.readProxyPixels (fb);
+    }
+    catch (const IEX_NAMESPACE::ArgExc&)
+    {
+        caught = true;
+    }
+
+    assert (caught);
+    remove (fileName.c_str ());
+}
+
+} // namespace
+
+void
+testDwaProxy (const std::string& tempDir)
+{
+    try
+    {
+        cout << "Testing DWA DC only proxy decoding" << endl;
+
+        string fileName = tempDir + "imf_test_dwa_proxy.exr";
+
+        testProxy (fileName, DWAA_COMPRESSION, 77, 32, false);
+        testProxy (fileName, DWAA_COMPRESSION, 64, 21, false);
+        testProxy (fileName, DWAA_COMPRESSION, 45, 85, false);
+        testProxy (fileName, DWAB_COMPRESSION, 205, 256, false);
+        testProxy (fileName, DWAB_COMPRESSION, 22, 301, false);
+        testProxy (fileName, DWAA_COMPRESSION, 61, 70, true);
+        testUnsupported (fileName);
+
+        cout << "ok\n" << endl;
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "ERROR -- caught exception: " << e.what () << endl;
+        assert (false);
+    }
+}
@@ -0,0 +1,12 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef TESTDWAPROXY_H_
+#define TESTDWAPROXY_H_
+
+#include <string>
+void testDwaProxy (const std::string&);
+
+#endif /* TESTDWAPROXY_H_ */
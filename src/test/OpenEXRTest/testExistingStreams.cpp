@@ -18,13 +18,20 @@
 #include <ImfTiledRgbaFile.h>
 
 #include "Iex.h"
+#include "IlmThreadConfig.h"
 #include <assert.h>
 #include <errno.h>
 #include <stdio.h>
 
 #include <ImfChannelList.h>
+#include <iterator>
+#include <memory>
 #include <vector>
 
+#if ILMTHREAD_THREADING_ENABLED
+#    include <thread>
+#endif
+
 #include "TestUtilFStream.h"
 
 using namespace OPENEXR_IMF_NAMESPACE;
@@ -572,6 +579,238 @@ writeReadTiles (
     remove (fileName);
 }
 
+void
+readConcurrently (
+    const char fileName[], int width, int height, const Array2D<Rgba>& p1)
+{
+    //
+    // Save a ZIP compressed scanline-based RGBA image, and
+    // read it back with several threads sharing one input
+    // file, each reading its own range of scan lines a few
+    // lines at a time.  The input file opens the file with a
+    // StdStatelessIFStream, so the threads fetch the pixel
+    // data without holding the stream's mutex.
+    //
+
+    cout << "concurrent reads:" << endl;
+
+    {
+        cout << "writing";
+        remove (fileName);
+        Header header (width, height);
+        header.compression () = ZIP_COMPRESSION;
+        RgbaOutputFile out (fileName, header, WRITE_RGBA);
+        out.setFrameBuffer (&p1[0][0], 1, width);
+        out.writePixels (height);
+    }
+
+    {
+        cout << ", checking stateless reads";
+
+        StdStatelessIFStream ifs (fileName);
+        assert (ifs.isStatelessRead ());
+
+        char magic[4];
+        ifs.seekg (8);
+        assert (ifs.read (magic, 4, 0) == 4);
+        assert (ifs.tellg () == 8);
+        assert (magic[0] == 0x76 && magic[1] == 0x2f);
+
+        std::ifstream is;
+        testutil::OpenStreamWithUTF8Name (
+            is, fileName, ios::in | ios_base::binary);
+        StdIFStream ifs2 (is, fileName);
+        IStream*    is2 = &ifs2;
+        assert (dynamic_cast<StatelessIStream*> (is2) == nullptr);
+    }
+
+#if ILMTHREAD_THREADING_ENABLED
+    for (int mapped = 0; mapped < 2; ++mapped)
+    {
+        //
+        // Read once through the file name and once through a
+        // StdMMapIFStream, whose chunks are found in the mapping
+        // without holding the stream's mutex
+        //
+
+        cout << (mapped ? ", reading (mmap)" : ", reading");
+
+        std::unique_ptr<StdMMapIFStream> ifs;
+        std::unique_ptr<RgbaInputFile>   file;
+
+        if (mapped)
+        {
+            ifs.reset (new StdMMapIFStream (fileName));
+            file.reset (new RgbaInputFile (*ifs));
+        }
+        else
+            file.reset (new RgbaInputFile (fileName));
+
+        RgbaInputFile& in = *file;
+
+        const Box2i& dw = in.dataWindow ();
+        int          w  = dw.max.x - dw.min.x + 1;
+        int          h  = dw.max.y - dw.min.y + 1;
+        int          dx = dw.min.x;
+        int          dy = dw.min.y;
+
+        Array2D<Rgba> p2 (h, w);
+        in.setFrameBuffer (&p2[-dy][-dx], 1, w);
+
+        const int           numThreads = 4;
+        vector<std::thread> threads;
+
+        for (int t = 0; t < numThreads; ++t)
+        {
+            int y1 = dw.min.y + h * t / numThreads;
+            int y2 = dw.min.y + h * (t + 1) / numThreads - 1;
+
+            threads.emplace_back ([&in, y1, y2] () {
+                for (int y = y1; y <= y2; y += 5)
+                    in.readPixels (y, min (y + 4, y2));
+            });
+        }
+
+        for (size_t t = 0; t < threads.size (); ++t)
+            threads[t].join ();
+
+        cout << ", comparing";
+        for (int y = 0; y < h; ++y)
+        {
+            for (int x = 0; x < w; ++x)
+            {
+                assert (p2[y][x].r == p1[y][x].r);
+                assert (p2[y][x].g == p1[y][x].g);
+                assert (p2[y][x].b == p1[y][x].b);
+                assert (p2[y][x].a == p1[y][x].a);
+            }
+        }
+    }
+#endif
+
+    cout << endl;
+
+    remove (fileName);
+}
+
+void
+readMemoryStreams (
+    const char fileName[], int width, int height, const Array2D<Rgba>& p1)
+{
+    //
+    // Save a ZIP compressed scanline-based RGBA image and a
+    // PIZ compressed tiled one.  Read the scanline image back
+    // through a StdMMapIFStream, and the tiled one through a
+    // StdIMemStream over a copy of the file in memory.  Both
+    // streams are memory mapped, so the pixel data are
+    // uncompressed straight from the mapping.
+    //
+
+    cout << "memory streams:" << endl;
+
+    {
+        cout << "writing";
+        remove (fileName);
+        Header header (width, height);
+        header.compression () = ZIP_COMPRESSION;
+        RgbaOutputFile out (fileName, header, WRITE_RGBA);
+        out.setFrameBuffer (&p1[0][0], 1, width);
+        out.writePixels (height);
+    }
+
+    {
+        cout << ", reading (mmap)";
+        StdMMapIFStream ifs (fileName);
+        assert (ifs.isMemoryMapped ());
+
+        ifs.seekg (4);
+        const char* p = ifs.readMemoryMapped (4);
+        assert (ifs.tellg () == 8);
+        assert (p[0] == 2);
+
+        assert (ifs.isStatelessRead ());
+        const char* q = ifs.readMemoryMapped (uint64_t (4), uint64_t (0));
+        assert (ifs.tellg () == 8);
+        assert (q + 4 == p && q[0] == 0x76);
+        ifs.seekg (0);
+
+        RgbaInputFile in (ifs);
+
+        const Box2i& dw = in.dataWindow ();
+        int          w  = dw.max.x - dw.min.x + 1;
+        int          h  = dw.max.y - dw.min.y + 1;
+        int          dx = dw.min.x;
+        int          dy = dw.min.y;
+
+        Array2D<Rgba> p2 (h, w);
+        in.setFrameBuffer (&p2[-dy][-dx], 1, w);
+        in.readPixels (dw.min.y, dw.max.y);
+
+        cout << ", comparing";
+        for (int y = 0; y < h; ++y)
+        {
+            for (int x = 0; x < w; ++x)
+            {
+                assert (p2[y][x].r == p1[y][x].r);
+                assert (p2[y][x].g == p1[y][x].g);
+                assert (p2[y][x].b == p1[y][x].b);
+                assert (p2[y][x].a == p1[y][x].a);
+            }
+        }
+    }
+
+    {
+        cout << ", writing tiled";
+        remove (fileName);
+        Header header (width, height);
+        header.compression () = PIZ_COMPRESSION;
+        TiledRgbaOutputFile out (
+            fileName, header, WRITE_RGBA, 20, 20, ONE_LEVEL);
+        out.setFrameBuffer (&p1[0][0], 1, width);
+        out.writeTiles (0, out.numXTiles () - 1, 0, out.numYTiles () - 1);
+    }
+
+    {
+        cout << ", reading (memory)";
+
+        std::ifstream is;
+        testutil::OpenStreamWithUTF8Name (
+            is, fileName, ios::in | ios_base::binary);
+        std::string data (
+            (std::istreambuf_iterator<char> (is)),
+            std::istreambuf_iterator<char> ());
+
+        StdIMemStream      ims (data.data (), data.size ());
+        TiledRgbaInputFile in (ims);
+
+        const Box2i& dw = in.dataWindow ();
+        int          w  = dw.max.x - dw.min.x + 1;
+        int          h  = dw.max.y - dw.min.y + 1;
+        int          dx = dw.min.x;
+        int          dy = dw.min.y;
+
+        Array2D<Rgba> p2 (h, w);
+        in.setFrameBuffer (&p2[-dy][-dx], 1, w);
+        in.readTiles (0, in.numXTiles () - 1, 0, in.numYTiles () - 1);
+
+        cout << ", comparing";
+        for (int y = 0; y < h; ++y)
+        {
+            for (int x = 0; x < w; ++x)
+            {
+                assert (p2[y][x].r == p1[y][x].r);
+                assert (p2[y][x].g == p1[y][x].g);
+                assert (p2[y][x].b == p1[y][x].b);
+                assert (p2[y][x].a == p1[y][x].a);
+            }
+        }
+    }
+
+    cout << endl;
+
+    remove (fileName);
+}
+
 //
 // stringstream version
 //
@@ -871,6 +1110,14 @@ testExistingStreams (const std::string& tempDir)
             (tempDir + "imf_test_streams3.exr").c_str (), W, H, p1);
         writeReadMultiPart (W, H, p1);
 
+        fillPixels2 (p1, W, H);
+        readConcurrently (
+            (tempDir + "imf_test_streams4.exr").c_str (), W, H, p1);
+
+        fillPixels1 (p1, W, H);
+        readMemoryStreams (
+            (tempDir + "imf_test_streams5.exr").c_str (), W, H, p1);
+
         cout << "ok\n" << endl;
     }
     catch (const std::exception& e)
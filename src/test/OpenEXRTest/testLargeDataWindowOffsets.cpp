@@ -5,6 +5,7 @@
 
 #include "ImfChannelList.h"
 #include "ImfCompression.h"
+#include "ImfCompressor.h"
 #include "ImfFrameBuffer.h"
 #include "ImfHeader.h"
 #include "ImfInputFile.h"
@@ -253,8 +254,11 @@ writefile (
         pixelCount / ((long long) (hdr.dataWindow ().max.y) -
                       (long long) (hdr.dataWindow ().min.y));
 
-    hdr.compression () =
-        Compression (random_int (static_cast<int> (NUM_COMPRESSION_METHODS)));
+    do
+    {
+        hdr.compression () = Compression (
+            random_int (static_cast<int> (NUM_COMPRESSION_METHODS)));
+    } while (!isSupportedCompression (hdr.compression ()));
     hdr.channels () = setupBuffer (hdr, channels, pt, buf, true);
 
     remove (filename.c_str ());
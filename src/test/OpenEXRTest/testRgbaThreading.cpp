@@ -11,17 +11,30 @@
 #include "compareDwa.h"
 
 #include <IlmThread.h>
+#include <IlmThreadPool.h>
+#include <IlmThreadSemaphore.h>
 #include <ImathRandom.h>
 #include <ImfArray.h>
+#include <ImfCompressor.h>
 #include <ImfRgbaFile.h>
 #include <ImfThreading.h>
 #include <assert.h>
+#include <atomic>
 #include <stdio.h>
 #include <string>
+#include <vector>
 
 using namespace OPENEXR_IMF_NAMESPACE;
 using namespace std;
 using namespace IMATH_NAMESPACE;
+using ILMTHREAD_NAMESPACE::PriorityThreadPoolProvider;
+using ILMTHREAD_NAMESPACE::RecycledTask;
+using ILMTHREAD_NAMESPACE::Semaphore;
+using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskBatch;
+using ILMTHREAD_NAMESPACE::TaskGroup;
+using ILMTHREAD_NAMESPACE::ThreadPool;
+using ILMTHREAD_NAMESPACE::WorkStealingThreadPoolProvider;
 
 namespace
 {
@@ -157,6 +170,127 @@ writeReadRGBA (
     remove (fileName);
 }
 
+//
+// Writes and reads an image from inside a task, so that the
+// files add their own tasks to the pool the task runs on
+//
+class WriteReadTask : public Task
+{
+public:
+    WriteReadTask (
+        TaskGroup*           group,
+        Semaphore&           started,
+        const string&        fileName,
+        int                  width,
+        int                  height,
+        const Array2D<Rgba>& pixels,
+        Compression          comp)
+        : Task (group)
+        , _started (started)
+        , _fileName (fileName)
+        , _width (width)
+        , _height (height)
+        , _pixels (pixels)
+        , _comp (comp)
+    {}
+
+    virtual void execute ()
+    {
+        _started.post ();
+
+        writeReadRGBA (
+            _fileName.c_str (),
+            _width,
+            _height,
+            _pixels,
+            WRITE_RGBA,
+            INCREASING_Y,
+            _comp);
+    }
+
+private:
+    Semaphore&           _started;
+    string               _fileName;
+    int                  _width;
+    int                  _height;
+    const Array2D<Rgba>& _pixels;
+    Compression          _comp;
+};
+
+//
+// Counts how many times it ran.  Size bytes of padding make
+// the tasks use different sizes of recycled blocks, or the
+// heap when size is large.
+//
+template <size_t size> class CountTask : public RecycledTask
+{
+public:
+    CountTask (TaskGroup* group, std::atomic<int>& count)
+        : RecycledTask (group), _count (count)
+    {
+        _padding[0] = 0;
+    }
+
+    virtual void execute () { _count++; }
+
+private:
+    std::atomic<int>& _count;
+    char              _padding[size];
+};
+
+//
+// Adds more tasks in a batch, from inside the pool
+//
+class SpawnTask : public RecycledTask
+{
+public:
+    SpawnTask (TaskGroup* group, ThreadPool& pool, std::atomic<int>& count)
+        : RecycledTask (group), _pool (pool), _count (count)
+    {}
+
+    virtual void execute ()
+    {
+        TaskBatch batch (_pool, 5);
+
+        for (int i = 0; i < 12; ++i)
+            batch.add (new CountTask<8> (group (), _count));
+    }
+
+private:
+    ThreadPool&       _pool;
+    std::atomic<int>& _count;
+};
+
+void
+addTasksInBatches (ThreadPool& pool)
+{
+    std::atomic<int> count (0);
+
+    {
+        TaskGroup     group;
+        vector<Task*> tasks;
+
+        for (int i = 0; i < 300; ++i)
+        {
+            if (i % 3 == 0)
+                tasks.push_back (new CountTask<8> (&group, count));
+            else if (i % 3 == 1)
+                tasks.push_back (new CountTask<200> (&group, count));
+            else
+                tasks.push_back (new CountTask<2000> (&group, count));
+        }
+
+        pool.addTasks (tasks.data (), static_cast<int> (tasks.size ()));
+
+        TaskBatch batch (pool, 7);
+
+        for (int i = 0; i < 50; ++i)
+            batch.add (new SpawnTask (&group, pool, count));
+    }
+
+    assert (count == 300 + 50 * 12);
+}
+
 } // namespace
 
 void
@@ -201,6 +335,8 @@ testRgbaThreading (const std::string& tempDir)
 
             for (int comp = 0; comp < NUM_COMPRESSION_METHODS; ++comp)
             {
+                if (!isSupportedCompression (Compression (comp))) { continue; }
+
                 for (int lorder = 0; lorder < RANDOM_Y; ++lorder)
                 {
                     writeReadRGBA (
@@ -243,6 +379,132 @@ testRgbaThreading (const std::string& tempDir)
         }
 
         cout << "ok\n" << endl;
+
+        cout << "Testing multi-threaded writing and reading with\n"
+                "a work-stealing thread pool"
+             << endl;
+
+        for (int numThreads = 1; numThreads <= 8; numThreads *= 2)
+        {
+            ThreadPool::globalThreadPool ().setThreadProvider (
+                new WorkStealingThreadPoolProvider (numThreads));
+            cout << "number of threads: " << globalThreadCount () << endl;
+
+            for (int comp = 0; comp < NUM_COMPRESSION_METHODS; ++comp)
+            {
+                if (!isSupportedCompression (Compression (comp))) { continue; }
+
+                writeReadRGBA (
+                    (tempDir + "imf_test_rgba.exr").c_str (),
+                    W,
+                    H,
+                    p1,
+                    WRITE_RGBA,
+                    INCREASING_Y,
+                    Compression (comp));
+            }
+        }
+
+        setGlobalThreadCount (0);
+
+        cout << "ok\n" << endl;
+
+        cout << "Testing writing and reading from inside\n"
+                "a thread pool task"
+             << endl;
+
+        for (int stealing = 0; stealing < 2; ++stealing)
+        {
+            for (int numThreads = 1; numThreads <= 2; ++numThreads)
+            {
+                if (stealing)
+                {
+                    ThreadPool::globalThreadPool ().setThreadProvider (
+                        new WorkStealingThreadPoolProvider (numThreads));
+                }
+                else
+                {
+                    setGlobalThreadCount (numThreads);
+                }
+
+                cout << "number of threads: " << globalThreadCount () << endl;
+
+                for (int comp = 0; comp < NUM_COMPRESSION_METHODS; ++comp)
+                {
+                    if (!isSupportedCompression (Compression (comp)))
+                    {
+                        continue;
+                    }
+
+                    //
+                    // Wait until a worker has started the task before
+                    // waiting on its group, so that the files' tasks
+                    // are added from the worker.  With one thread,
+                    // only the waiting worker can run them.
+                    //
+
+                    Semaphore started;
+
+                    {
+                        TaskGroup group;
+
+                        ThreadPool::addGlobalTask (new WriteReadTask (
+                            &group,
+                            started,
+                            tempDir + "imf_test_rgba.exr",
+                            W,
+                            H,
+                            p1,
+                            Compression (comp)));
+
+                        started.wait ();
+                    }
+                }
+            }
+        }
+
+        setGlobalThreadCount (0);
+
+        cout << "ok\n" << endl;
+
+        cout << "Testing adding recycled tasks in batches" << endl;
+
+        {
+            //
+            // The memory of a deleted task is reused
+            // for the next task of a similar size
+            //
+
+            std::atomic<int> count (0);
+
+            Task* t1 = new CountTask<100> (nullptr, count);
+            void* p1 = t1;
+            delete t1;
+
+            Task* t2 = new CountTask<90> (nullptr, count);
+            assert (static_cast<void*> (t2) == p1);
+            delete t2;
+        }
+
+        for (int provider = 0; provider < 3; ++provider)
+        {
+            for (int numThreads = 0; numThreads <= 3; numThreads += 3)
+            {
+                ThreadPool pool (numThreads);
+
+                if (provider == 1)
+                    pool.setThreadProvider (
+                        new WorkStealingThreadPoolProvider (numThreads));
+                else if (provider == 2)
+                    pool.setThreadProvider (
+                        new PriorityThreadPoolProvider (numThreads));
+
+                for (int i = 0; i < 20; ++i)
+                    addTasksInBatches (pool);
+            }
+        }
+
+        cout << "ok\n" << endl;
     }
     catch (const std::exception& e)
     {
@@ -0,0 +1,415 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include <IlmThread.h>
+#include <IlmThreadPool.h>
+#include <IlmThreadSemaphore.h>
+#include <ImfArray.h>
+#include <ImfInputFile.h>
+#include <ImfRgbaFile.h>
+#include <ImfThreading.h>
+
+#include <assert.h>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace std;
+using namespace IMATH_NAMESPACE;
+using namespace ILMTHREAD_NAMESPACE;
+
+#if ILMTHREAD_THREADING_ENABLED
+namespace
+{
+
+//
+// Blocks the pool's only worker until released, so that
+// the tasks added in the meantime are all queued
+//
+class GateTask : public Task
+{
+public:
+    GateTask (TaskGroup* group, Semaphore& started, Semaphore& release)
+        : Task (group), _started (started), _release (release)
+    {}
+
+    virtual void execute ()
+    {
+        _started.post ();
+        _release.wait ();
+    }
+
+private:
+    Semaphore& _started;
+    Semaphore& _release;
+};
+
+//
+// Appends its id to a list shared by all tasks
+//
+class RecordTask : public Task
+{
+public:
+    RecordTask (
+        TaskGroup*   group,
+        int          id,
+        vector<int>& order,
+        std::mutex&  mutex,
+        Semaphore&   done)
+        : Task (group), _id (id), _order (order), _mutex (mutex), _done (done)
+    {}
+
+    virtual void execute ()
+    {
+        {
+            std::lock_guard<std::mutex> lock (_mutex);
+            _order.push_back (_id);
+        }
+
+        _done.post ();
+    }
+
+private:
+    int          _id;
+    vector<int>& _order;
+    std::mutex&  _mutex;
+    Semaphore&   _done;
+};
+
+//
+// Queues the tasks of groups a and b behind a gate on a pool with one
+// worker, and returns the ids, 0 for a and 1 for b, in the order the
+// tasks ran.  The groups are not destroyed until all tasks have run,
+// as a waiting TaskGroup would run its own tasks.
+//
+vector<int>
+runOrder (
+    ThreadPool& pool,
+    int         priorityA,
+    int         weightA,
+    int         numA,
+    int         priorityB,
+    int         weightB,
+    int         numB)
+{
+    vector<int> order;
+    std::mutex  mutex;
+    Semaphore   started;
+    Semaphore   release;
+    Semaphore   done;
+
+    TaskGroup gate;
+    TaskGroup a;
+    TaskGroup b;
+
+    a.setPriority (priorityA, weightA);
+    b.setPriority (priorityB, weightB);
+
+    pool.addTask (new GateTask (&gate, started, release));
+    started.wait ();
+
+    for (int i = 0; i < numA; ++i)
+        pool.addTask (new RecordTask (&a, 0, order, mutex, done));
+
+    for (int i = 0; i < numB; ++i)
+        pool.addTask (new RecordTask (&b, 1, order, mutex, done));
+
+    release.post ();
+
+    for (int i = 0; i < numA + numB; ++i)
+        done.wait ();
+
+    return order;
+}
+
+void
+testScheduling ()
+{
+    cout << "scheduling by priority" << endl;
+
+    {
+        //
+        // Twelve background tasks are queued before four foreground
+        // tasks.  The foreground tasks run first, but every fourth
+        // task is the one that has waited longest.
+        //
+
+        ThreadPool pool (0);
+        pool.setThreadProvider (new PriorityThreadPoolProvider (1, 4));
+
+        vector<int> order = runOrder (pool, 0, 1, 12, 5, 1, 4);
+        assert (order.size () == 16);
+
+        int highInFirstFive = 0;
+        int lastHigh        = 0;
+        int firstLow        = -1;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            if (order[i] == 1)
+            {
+                if (i < 5) ++highInFirstFive;
+                lastHigh = i;
+            }
+            else if (firstLow < 0)
+            {
+                firstLow = i;
+            }
+        }
+
+        assert (highInFirstFive == 4);
+        assert (firstLow < lastHigh);
+    }
+
+    cout << "sharing by weight" << endl;
+
+    {
+        //
+        // With the same priority, a group with three times
+        // the weight gets about three times as many turns
+        //
+
+        ThreadPool pool (0);
+        pool.setThreadProvider (new PriorityThreadPoolProvider (1, 1000));
+
+        vector<int> order = runOrder (pool, 0, 3, 8, 0, 1, 8);
+        assert (order.size () == 16);
+
+        int aInFirstEight = 0;
+        for (int i = 0; i < 8; ++i)
+            if (order[i] == 0) ++aInFirstEight;
+
+        assert (aInFirstEight >= 5 && aInFirstEight <= 7);
+    }
+
+    cout << "fairness interval 1 runs tasks in order" << endl;
+
+    {
+        ThreadPool pool (0);
+        pool.setThreadProvider (new PriorityThreadPoolProvider (1, 1));
+
+        vector<int> order = runOrder (pool, 0, 1, 4, 5, 1, 4);
+
+        for (int i = 0; i < 8; ++i)
+            assert (order[i] == (i < 4 ? 0 : 1));
+    }
+}
+
+//
+// A provider that runs tasks right away and
+// records the priority and weight of their groups
+//
+class RecordingProvider : public ThreadPoolProvider
+{
+public:
+    RecordingProvider (vector<int>& priorities, vector<int>& weights)
+        : _priorities (priorities), _weights (weights)
+    {}
+
+    virtual int  numThreads () const { return 1; }
+    virtual void setNumThreads (int count) {}
+
+    virtual void addTask (Task* task)
+    {
+        _priorities.push_back (task->group ()->priority ());
+        _weights.push_back (task->group ()->weight ());
+
+        TaskGroup* group = task->group ();
+        task->execute ();
+        delete task;
+        group->finishOneTask ();
+    }
+
+    virtual void finish () {}
+
+private:
+    vector<int>& _priorities;
+    vector<int>& _weights;
+};
+
+void
+testFilePriority (const std::string& tempDir)
+{
+    cout << "priority of the tasks of a file" << endl;
+
+    const int   W        = 97;
+    const int   H        = 61;
+    std::string fileName = tempDir + "imf_test_task_priority.exr";
+
+    Array2D<Rgba> p1 (H, W);
+    for (int y = 0; y < H; ++y)
+        for (int x = 0; x < W; ++x)
+            p1[y][x] = Rgba (x, y, x + y, 1);
+
+    {
+        Header header (W, H);
+        header.compression () = ZIP_COMPRESSION;
+
+        RgbaOutputFile out (fileName.c_str (), header, WRITE_RGBA);
+        out.setFrameBuffer (&p1[0][0], 1, W);
+        out.writePixels (H);
+    }
+
+    vector<int> priorities;
+    vector<int> weights;
+
+    ThreadPool::globalThreadPool ().setThreadProvider (
+        new RecordingProvider (priorities, weights));
+
+    Array2D<Rgba> p2 (H, W);
+
+    {
+        RgbaInputFile in (fileName.c_str ());
+        in.setFrameBuffer (&p2[0][0], 1, W);
+
+        //
+        // The calling thread's priority
+        //
+
+        {
+            TaskPriorityScope scope (2, 3);
+            in.readPixels (0, H - 1);
+        }
+
+        assert (!priorities.empty ());
+        for (size_t i = 0; i < priorities.size (); ++i)
+            assert (priorities[i] == 2 && weights[i] == 3);
+
+        priorities.clear ();
+        weights.clear ();
+
+        in.readPixels (0, H - 1);
+
+        for (size_t i = 0; i < priorities.size (); ++i)
+            assert (priorities[i] == 0 && weights[i] == 1);
+    }
+
+    {
+        //
+        // The file's priority overrides the thread's
+        //
+
+        InputFile in (fileName.c_str ());
+
+        FrameBuffer fb;
+        fb.insert (
+            "R",
+            Slice (
+                HALF, (char*) &p2[0][0].r, sizeof (Rgba), sizeof (Rgba) * W));
+        in.setFrameBuffer (fb);
+        in.setTaskPriority (7, 2);
+
+        priorities.clear ();
+        weights.clear ();
+
+        {
+            TaskPriorityScope scope (-1);
+            in.readPixels (0, H - 1);
+        }
+
+        assert (!priorities.empty ());
+        for (size_t i = 0; i < priorities.size (); ++i)
+            assert (priorities[i] == 7 && weights[i] == 2);
+    }
+
+    //
+    // setGlobalThreadCount (0) only replaces providers it knows
+    //
+
+    ThreadPool::globalThreadPool ().setThreadProvider (
+        new PriorityThreadPoolProvider (1));
+    setGlobalThreadCount (0);
+
+    for (int y = 0; y < H; ++y)
+        for (int x = 0; x < W; ++x)
+            assert (p2[y][x].r == p1[y][x].r && p2[y][x].b == p1[y][x].b);
+
+    remove (fileName.c_str ());
+}
+
+void
+testPriorityReads (const std::string& tempDir)
+{
+    cout << "reading files with a priority thread pool" << endl;
+
+    const int   W        = 311;
+    const int   H        = 247;
+    std::string fileName = tempDir + "imf_test_task_priority.exr";
+
+    Array2D<Rgba> p1 (H, W);
+    for (int y = 0; y < H; ++y)
+        for (int x = 0; x < W; ++x)
+            p1[y][x] = Rgba (x % 71, y % 53, (x * y) % 89, 1);
+
+    for (int numThreads = 1; numThreads <= 4; numThreads *= 2)
+    {
+        ThreadPool::globalThreadPool ().setThreadProvider (
+            new PriorityThreadPoolProvider (numThreads));
+
+        {
+            Header header (W, H);
+            header.compression () = PIZ_COMPRESSION;
+
+            RgbaOutputFile out (fileName.c_str (), header, WRITE_RGBA);
+            out.setFrameBuffer (&p1[0][0], 1, W);
+            out.writePixels (H);
+        }
+
+        for (int priority = -1; priority <= 1; ++priority)
+        {
+            TaskPriorityScope scope (priority, priority + 2);
+
+            RgbaInputFile in (fileName.c_str ());
+            Array2D<Rgba> p2 (H, W);
+            in.setFrameBuffer (&p2[0][0], 1, W);
+            in.readPixels (0, H - 1);
+
+            for (int y = 0; y < H; ++y)
+                for (int x = 0; x < W; ++x)
+                    assert (
+                        p2[y][x].r == p1[y][x].r && p2[y][x].g == p1[y][x].g &&
+                        p2[y][x].b == p1[y][x].b);
+        }
+    }
+
+    setGlobalThreadCount (0);
+    remove (fileName.c_str ());
+}
+
+} // namespace
+#endif
+
+void
+testTaskPriority (const std::string& tempDir)
+{
+    try
+    {
+        cout << "Testing task priorities" << endl;
+
+        if (!ILMTHREAD_NAMESPACE::supportsThreads ())
+        {
+            cout << "   Threading not supported!" << endl << endl;
+            return;
+        }
+
+#if ILMTHREAD_THREADING_ENABLED
+        testScheduling ();
+        testFilePriority (tempDir);
+        testPriorityReads (tempDir);
+#endif
+        cout << "ok\n" << endl;
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "ERROR -- caught exception: " << e.what () << endl;
+        assert (false);
+    }
+}
@@ -0,0 +1,12 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef TESTTASKPRIORITY_H_
+#define TESTTASKPRIORITY_H_
+
+#include <string>
+void testTaskPriority (const std::string&);
+
+#endif /* TESTTASKPRIORITY_H_ */
@@ -14,6 +14,7 @@
 #include <ImathRandom.h>
 #include <ImfArray.h>
 #include <ImfChannelList.h>
+#include <ImfCompressor.h>
 #include <ImfFrameBuffer.h>
 #include <ImfHeader.h>
 #include <ImfInputFile.h>
@@ -474,6 +475,8 @@ writeRead (
 
     for (int comp = 0; comp < NUM_COMPRESSION_METHODS; ++comp)
     {
+        if (!isSupportedCompression (Compression (comp))) { continue; }
+
         writeRead (
             pi,
             ph,
@@ -9,6 +9,7 @@
 
 #include <ImfArray.h>
 #include <ImfChannelList.h>
+#include <ImfCompressor.h>
 #include <ImfFrameBuffer.h>
 #include <ImfHeader.h>
 #include <ImfInputFile.h>
@@ -510,6 +511,8 @@ writeCopyRead (
 
     for (int comp = 0; comp < NUM_COMPRESSION_METHODS; ++comp)
     {
+        if (!isSupportedCompression (Compression (comp))) { continue; }
+
         for (int rmode = 0; rmode < NUM_ROUNDINGMODES; ++rmode)
         {
             writeCopyReadONE (
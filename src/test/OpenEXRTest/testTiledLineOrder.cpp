@@ -11,6 +11,7 @@
 #include <ImathRandom.h>
 #include <ImfArray.h>
 #include <ImfChannelList.h>
+#include <ImfCompressor.h>
 #include <ImfFrameBuffer.h>
 #include <ImfHeader.h>
 #include <ImfInputFile.h>
@@ -20,6 +21,8 @@
 #include <half.h>
 
 #include <assert.h>
+#include <limits.h>
+#include <limits>
 #include <stdio.h>
 #include <vector>
 
@@ -626,6 +629,8 @@ writeCopyRead (const std::string& tempDir, int w, int h, int xs, int ys)
 
     for (int comp = 0; comp < NUM_COMPRESSION_METHODS; ++comp)
     {
+        if (!isSupportedCompression (Compression (comp))) { continue; }
+
         if (comp == B44_COMPRESSION || comp == B44A_COMPRESSION) { continue; }
 
         for (int lorder = 0; lorder < RANDOM_Y; ++lorder)
@@ -678,6 +683,193 @@ writeCopyRead (const std::string& tempDir, int w, int h, int xs, int ys)
     }
 }
 
+//
+// Writes the tiles of a file with line order INCREASING_Y starting
+// with the tile nearest to the center of the image, so that most
+// tiles are written before the ones that precede them in the file,
+// with a limit on the memory used by the tiles kept until their
+// turn comes, and reads the file back
+//
+void
+writeReadOutOfOrder (
+    const char*                      fileName,
+    int                              width,
+    int                              height,
+    int                              xSize,
+    int                              ySize,
+    size_t                           limit,
+    TiledOutputFile::OutOfOrderTiles mode)
+{
+    cout << "limit " << limit << ", "
+         << (mode == TiledOutputFile::SPILL_OUT_OF_ORDER_TILES ? "spill"
+                                                                : "write")
+         << flush;
+
+    Array2D<half> ph1 (height, width);
+    fillPixels (ph1, width, height);
+
+    Header hdr (width, height);
+    hdr.compression () = ZIP_COMPRESSION;
+    hdr.lineOrder ()   = INCREASING_Y;
+    hdr.setTileDescription (TileDescription (xSize, ySize, ONE_LEVEL));
+    hdr.channels ().insert ("H", Channel (HALF));
+
+    LineOrder lineOrder;
+
+    {
+        FrameBuffer fb;
+
+        fb.insert (
+            "H",
+            Slice (
+                HALF,
+                (char*) &ph1[0][0],
+                sizeof (ph1[0][0]),
+                sizeof (ph1[0][0]) * width));
+
+        remove (fileName);
+        TiledOutputFile out (fileName, hdr);
+        out.setFrameBuffer (fb);
+        out.setOutOfOrderTileLimit (limit, mode);
+
+        vector<pair<int, int>> tiles;
+
+        for (int tileY = 0; tileY < out.numYTiles (); ++tileY)
+            for (int tileX = 0; tileX < out.numXTiles (); ++tileX)
+                tiles.push_back (make_pair (tileX, tileY));
+
+        int cx = out.numXTiles () / 2;
+        int cy = out.numYTiles () / 2;
+
+        for (size_t i = 0; i < tiles.size (); ++i)
+        {
+            //
+            // Selection sort by distance from the center tile
+            //
+
+            size_t nearest         = i;
+            int    nearestDistance = INT_MAX;
+
+            for (size_t j = i; j < tiles.size (); ++j)
+            {
+                int dx = tiles[j].first - cx;
+                int dy = tiles[j].second - cy;
+                int d  = dx * dx + dy * dy;
+
+                if (d < nearestDistance)
+                {
+                    nearest         = j;
+                    nearestDistance = d;
+                }
+            }
+
+            std::swap (tiles[i], tiles[nearest]);
+        }
+
+        for (size_t i = 0; i < tiles.size (); ++i)
+        {
+            out.writeTile (tiles[i].first, tiles[i].second);
+            assert (out.outOfOrderTileBytes () <= limit);
+        }
+
+        lineOrder = out.header ().lineOrder ();
+    }
+
+    //
+    // Once tiles are written out of order, the header says
+    // RANDOM_Y; without a limit, or when spilling, the tiles
+    // stay in order
+    //
+
+    if (mode == TiledOutputFile::SPILL_OUT_OF_ORDER_TILES ||
+        limit == std::numeric_limits<size_t>::max ())
+        assert (lineOrder == INCREASING_Y);
+    else if (limit == 0)
+        assert (lineOrder == RANDOM_Y);
+
+    cout << ", reading" << flush;
+
+    {
+        TiledInputFile in (fileName);
+        assert (in.header ().lineOrder () == lineOrder);
+        assert (in.isComplete ());
+
+        Array2D<half> ph2 (height, width);
+
+        FrameBuffer fb;
+
+        fb.insert (
+            "H",
+            Slice (
+                HALF,
+                (char*) &ph2[0][0],
+                sizeof (ph2[0][0]),
+                sizeof (ph2[0][0]) * width));
+
+        in.setFrameBuffer (fb);
+        in.readTiles (0, in.numXTiles () - 1, 0, in.numYTiles () - 1);
+
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x)
+                assert (ph1[y][x] == ph2[y][x]);
+    }
+
+    {
+        InputFile in (fileName);
+
+        Array2D<half> ph2 (height, width);
+
+        FrameBuffer fb;
+
+        fb.insert (
+            "H",
+            Slice (
+                HALF,
+                (char*) &ph2[0][0],
+                sizeof (ph2[0][0]),
+                sizeof (ph2[0][0]) * width));
+
+        in.setFrameBuffer (fb);
+        in.readPixels (0, height - 1);
+
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x)
+                assert (ph1[y][x] == ph2[y][x]);
+    }
+
+    remove (fileName);
+    cout << endl;
+}
+
+void
+writeReadOutOfOrder (const std::string& tempDir, int w, int h, int xs, int ys)
+{
+    std::string filename = tempDir + "imf_test_out_of_order.exr";
+
+    size_t limits[] = {std::numeric_limits<size_t>::max (), 4096, 0};
+
+    for (int i = 0; i < 3; ++i)
+    {
+        writeReadOutOfOrder (
+            filename.c_str (),
+            w,
+            h,
+            xs,
+            ys,
+            limits[i],
+            TiledOutputFile::SPILL_OUT_OF_ORDER_TILES);
+
+        writeReadOutOfOrder (
+            filename.c_str (),
+            w,
+            h,
+            xs,
+            ys,
+            limits[i],
+            TiledOutputFile::WRITE_OUT_OF_ORDER_TILES);
+    }
+}
+
 } // namespace
 
 void
@@ -705,6 +897,9 @@ testTiledLineOrder (const std::string& tempDir)
             }
 
             writeCopyRead (tempDir, W, H, XS, YS);
+
+            cout << "\nlimiting the memory of out-of-order tiles" << endl;
+            writeReadOutOfOrder (tempDir, W, H, 16, 16);
         }
 
         cout << "ok\n" << endl;